@@ -662,6 +662,21 @@ class FpClassify(Dependence):
                 env['CCFLAGS'].remove('-ffast-math')
         return env.Object('util/fpclassify.cpp')
 
+class SampleKernels(Dependence):
+
+    # The AVX2 and AVX-512 versions of the SampleKernels are selected at
+    # runtime depending on the CPU. Only these files are compiled with the
+    # corresponding instruction sets enabled, so the rest of Mixxx still
+    # runs on CPUs without them.
+    def sources(self, build):
+        avx2_env = build.env.Clone()
+        avx512_env = build.env.Clone()
+        if build.architecture_is_x86 and build.toolchain_is_gnu:
+            avx2_env.Append(CCFLAGS='-mavx2')
+            avx512_env.Append(CCFLAGS='-mavx512f')
+        return [avx2_env.Object('util/samplekernels_avx2.cpp'),
+                avx512_env.Object('util/samplekernels_avx512.cpp')]
+
 class QtScriptByteArray(Dependence):
     def configure(self, build, conf):
         build.env.Append(CPPPATH='#lib/qtscript-bytearray')
@@ -707,6 +722,7 @@ class MixxxCore(Feature):
         sources = ["control/control.cpp",
                    "control/controlaudiotaperpot.cpp",
                    "control/controlbehavior.cpp",
+                   "control/controlchangebus.cpp",
                    "control/controleffectknob.cpp",
                    "control/controlindicator.cpp",
                    "control/controllinpotmeter.cpp",
@@ -717,6 +733,7 @@ class MixxxCore(Feature):
                    "control/controlpotmeter.cpp",
                    "control/controlproxy.cpp",
                    "control/controlpushbutton.cpp",
+                   "control/controlregistry.cpp",
                    "control/controlttrotary.cpp",
                    "control/controlencoder.cpp",
 
@@ -783,6 +800,9 @@ class MixxxCore(Feature):
                    "effects/builtin/filtereffect.cpp",
                    "effects/builtin/moogladder4filtereffect.cpp",
                    "effects/builtin/reverbeffect.cpp",
+                   "effects/builtin/partitionedconvolver.cpp",
+                   "effects/builtin/convolutionworker.cpp",
+                   "effects/builtin/convolutionreverbeffect.cpp",
                    "effects/builtin/echoeffect.cpp",
                    "effects/builtin/autopaneffect.cpp",
                    "effects/builtin/phasereffect.cpp",
@@ -801,6 +821,7 @@ class MixxxCore(Feature):
 
                    "engine/engineworker.cpp",
                    "engine/engineworkerscheduler.cpp",
+                   "engine/enginechannelworkerpool.cpp",
                    "engine/enginebuffer.cpp",
                    "engine/enginebufferscale.cpp",
                    "engine/enginebufferscalelinear.cpp",
@@ -844,8 +865,12 @@ class MixxxCore(Feature):
                    "engine/cachingreader.cpp",
                    "engine/cachingreaderchunk.cpp",
                    "engine/cachingreaderworker.cpp",
+                   "engine/decodedsamplecache.cpp",
 
+                   "analyzer/analyzerblockbus.cpp",
                    "analyzer/analyzerqueue.cpp",
+                   "analyzer/analyzerstoragewriter.cpp",
+                   "analyzer/analyzerworker.cpp",
                    "analyzer/analyzerwaveform.cpp",
                    "analyzer/analyzergain.cpp",
                    "analyzer/analyzerebur128.cpp",
@@ -964,6 +989,7 @@ class MixxxCore(Feature):
                    "database/schemamanager.cpp",
 
                    "library/trackcollection.cpp",
+                   "library/trackcolumnstore.cpp",
                    "library/basesqltablemodel.cpp",
                    "library/basetrackcache.cpp",
                    "library/columncache.cpp",
@@ -1033,6 +1059,7 @@ class MixxxCore(Feature):
                    "library/library.cpp",
 
                    "library/scanner/libraryscanner.cpp",
+                   "library/scanner/librarywatcher.cpp",
                    "library/scanner/libraryscannerdlg.cpp",
                    "library/scanner/scannertask.cpp",
                    "library/scanner/importfilestask.cpp",
@@ -1072,6 +1099,7 @@ class MixxxCore(Feature):
                    "waveform/waveformfactory.cpp",
                    "waveform/waveformwidgetfactory.cpp",
                    "waveform/vsyncthread.cpp",
+                   "waveform/waveformrenderthread.cpp",
                    "waveform/guitick.cpp",
                    "waveform/visualplayposition.cpp",
                    "waveform/renderers/waveformwidgetrenderer.cpp",
@@ -1099,6 +1127,7 @@ class MixxxCore(Feature):
                    "waveform/renderers/glwaveformrenderersimplesignal.cpp",
                    "waveform/renderers/glwaveformrendererrgb.cpp",
                    "waveform/renderers/glwaveformrendererfilteredsignal.cpp",
+                   "waveform/renderers/glwaveformvertexbuffer.cpp",
                    "waveform/renderers/glslwaveformrenderersignal.cpp",
                    "waveform/renderers/glvsynctestrenderer.cpp",
 
@@ -1125,6 +1154,8 @@ class MixxxCore(Feature):
                    "skin/colorschemeparser.cpp",
                    "skin/tooltips.cpp",
                    "skin/skincontext.cpp",
+                   "skin/skincache.cpp",
+                   "skin/skinimageprefetcher.cpp",
                    "skin/svgparser.cpp",
                    "skin/pixmapsource.cpp",
                    "skin/launchimage.cpp",
@@ -1213,7 +1244,11 @@ class MixxxCore(Feature):
                    "util/db/sqlstringformatter.cpp",
                    "util/db/sqltransaction.cpp",
                    "util/sample.cpp",
+                   "util/samplekernels.cpp",
+                   "util/samplekernels_sse2.cpp",
+                   "util/samplekernels_neon.cpp",
                    "util/samplebuffer.cpp",
+                   "util/fft.cpp",
                    "util/readaheadsamplebuffer.cpp",
                    "util/rotary.cpp",
                    "util/logger.cpp",
@@ -1505,7 +1540,8 @@ class MixxxCore(Feature):
         return [SoundTouch, ReplayGain, Ebur128Mit, PortAudio, PortMIDI, Qt, TestHeaders,
                 FidLib, SndFile, FLAC, OggVorbis, OpenGL, TagLib, ProtoBuf,
                 Chromaprint, RubberBand, SecurityFramework, CoreServices, IOKit,
-                QtScriptByteArray, Reverb, FpClassify, PortAudioRingBuffer, LAME]
+                QtScriptByteArray, Reverb, FpClassify, SampleKernels,
+                PortAudioRingBuffer, LAME]
 
     def post_dependency_check_configure(self, build, conf):
         """Sets up additional things in the Environment that must happen
@@ -210,7 +210,8 @@ class Mad(Feature):
         build.env.Append(CPPDEFINES='__MAD__')
 
     def sources(self, build):
-        return ['sources/soundsourcemp3.cpp']
+        return ['sources/soundsourcemp3.cpp',
+                'sources/mp3seekindexcache.cpp']
 
 
 class CoreAudio(Feature):
@@ -362,6 +363,7 @@ class VinylControl(Feature):
                    'vinylcontrol/vinylcontrolmanager.cpp',
                    'vinylcontrol/vinylcontrolprocessor.cpp',
                    'vinylcontrol/steadypitch.cpp',
+                   'vinylcontrol/timecodelutcache.cpp',
                    'engine/vinylcontrolcontrol.cpp', ]
         if build.platform_is_windows:
             sources.append("#lib/xwax/timecoder_win32.cpp")
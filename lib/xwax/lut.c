@@ -22,13 +22,10 @@
 
 #include "lut.h"
 
-/* The number of bits to form the hash, which governs the overall size
- * of the hash lookup table, and hence the amount of chaining */
-
-#define HASH_BITS 16
+#define HASH_BITS LUT_HASH_BITS
 
 #define HASH(timecode) ((timecode) & ((1 << HASH_BITS) - 1))
-#define NO_SLOT ((unsigned)-1)
+#define NO_SLOT LUT_NO_SLOT
 
 
 /* Initialise an empty hash lookup table to store the given number
@@ -62,13 +59,31 @@ int lut_init(struct lut *lut, int nslots)
         lut->table[n] = NO_SLOT;
 
     lut->avail = 0;
+    lut->shared = 0;
 
     return 0;
 }
 
 
+/* Initialise a lookup table from tables which were built before, for
+ * example by a previous run that saved them to disk. The tables are
+ * not copied, and are not freed by lut_clear() */
+
+void lut_init_shared(struct lut *lut, struct slot *slot, slot_no_t *table,
+                     int nslots)
+{
+    lut->slot = slot;
+    lut->table = table;
+    lut->avail = nslots;
+    lut->shared = 1;
+}
+
+
 void lut_clear(struct lut *lut)
 {
+    if (lut->shared)
+        return;
+
     free(lut->table);
     free(lut->slot);
 }
@@ -20,6 +20,12 @@
 #ifndef LUT_H
 #define LUT_H
 
+/* The number of bits to form the hash, which governs the overall size
+ * of the hash lookup table, and hence the amount of chaining */
+
+#define LUT_HASH_BITS 16
+#define LUT_NO_SLOT ((unsigned)-1)
+
 typedef unsigned int slot_no_t;
 
 struct slot {
@@ -31,9 +37,12 @@ struct lut {
     struct slot *slot;
     slot_no_t *table, /* hash -> slot lookup */
         avail; /* next available slot */
+    int shared; /* tables are owned by the caller, and read-only */
 };
 
 int lut_init(struct lut *lut, int nslots);
+void lut_init_shared(struct lut *lut, struct slot *slot, slot_no_t *table,
+                     int nslots);
 void lut_clear(struct lut *lut);
 
 void lut_push(struct lut *lut, unsigned int timecode);
@@ -228,12 +228,13 @@ static int build_lookup(struct timecode_def *def)
 }
 
 /*
- * Find a timecode definition by name
+ * Find a timecode definition by name, without building its lookup
+ * table
  *
  * Return: pointer to timecode definition, or NULL if not found
  */
 
-struct timecode_def* timecoder_find_definition(const char *name)
+struct timecode_def* timecoder_match_definition(const char *name)
 {
     struct timecode_def *def, *end;
 
@@ -250,12 +251,45 @@ struct timecode_def* timecoder_find_definition(const char *name)
             return NULL;
     }
 
+    return def;
+}
+
+/*
+ * Find a timecode definition by name
+ *
+ * Return: pointer to timecode definition, or NULL if not found
+ */
+
+struct timecode_def* timecoder_find_definition(const char *name)
+{
+    struct timecode_def *def;
+
+    def = timecoder_match_definition(name);
+    if (def == NULL)
+        return NULL;
+
     if (build_lookup(def) == -1)
         return NULL;
 
     return def;
 }
 
+/*
+ * Use a lookup table for this timecode which was built before, eg. by
+ * a previous run which has saved it. The table has def->length slots
+ * and 1 << LUT_HASH_BITS hashes, and must outlive the definition's
+ * use or the next timecoder_free_lookup()
+ */
+
+void timecoder_share_lookup(struct timecode_def *def,
+                            struct slot *slot, slot_no_t *table)
+{
+    assert(!def->lookup);
+
+    lut_init_shared(&def->lut, slot, table, def->length);
+    def->lookup = true;
+}
+
 /*
  * Free the timecoder lookup tables when they are no longer needed
  */
@@ -267,8 +301,10 @@ void timecoder_free_lookup(void) {
     end = def + ARRAY_SIZE(timecodes);
 
     while (def < end) {
-        if (def->lookup)
+        if (def->lookup) {
             lut_clear(&def->lut);
+            def->lookup = false;
+        }
         def++;
     }
 }
@@ -84,7 +84,10 @@ struct timecoder {
     int mon_size, mon_counter;
 };
 
+struct timecode_def* timecoder_match_definition(const char *name);
 struct timecode_def* timecoder_find_definition(const char *name);
+void timecoder_share_lookup(struct timecode_def *def,
+                            struct slot *slot, slot_no_t *table);
 void timecoder_free_lookup(void);
 
 void timecoder_init(struct timecoder *tc, struct timecode_def *def,
@@ -0,0 +1,7 @@
+#version 120
+
+varying vec4 color;
+
+void main(void) {
+    gl_FragColor = color;
+}
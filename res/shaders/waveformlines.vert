@@ -0,0 +1,58 @@
+#version 120
+#extension GL_ARB_draw_instanced : require
+
+// Draws the lines of the waveform from the vertex buffers of
+// GLWaveformVertexBuffer. The data of the track is uploaded once and only
+// the uniforms and the projection change from frame to frame. Each instance
+// is the line of a block of frames.
+
+uniform vec3 bandGains;
+uniform vec4 lowColor;
+uniform vec4 midColor;
+uniform vec4 highColor;
+uniform float alpha;
+// Use the maximum of both channels for top or bottom aligned waveforms
+uniform bool mergeChannels;
+// Selects the band of a single colored line, or all bands mixed to an RGB
+// color if it is zero.
+uniform vec3 bandMask;
+
+// The visual index of the first drawn block and the visual samples of a
+// block
+uniform float firstX;
+uniform float blockWidth;
+// 1 for the left and -1 for the right channel
+uniform float direction;
+
+// 0 on the axis, 1 at the tip of the line
+attribute float extent;
+// The maxima of the block in the channel of the line and the other channel,
+// one per instance
+attribute vec4 bands;
+attribute vec4 otherBands;
+
+varying vec4 color;
+
+void main(void) {
+    vec3 data = mergeChannels ? max(bands.xyz, otherBands.xyz) : bands.xyz;
+    vec3 gained = 255.0 * data * bandGains;
+
+    float height;
+    if (bandMask == vec3(0.0)) {
+        vec3 rgb = gained.x * lowColor.rgb + gained.y * midColor.rgb +
+                gained.z * highColor.rgb;
+        float maxComponent = max(rgb.r, max(rgb.g, rgb.b));
+        // Lines without a color are not drawn
+        color = maxComponent > 0.0 ?
+                vec4(rgb / maxComponent, alpha) : vec4(0.0);
+        height = length(gained) / sqrt(3.0);
+    } else {
+        color = vec4(lowColor.rgb * bandMask.x + midColor.rgb * bandMask.y +
+                highColor.rgb * bandMask.z, alpha);
+        height = dot(gained, bandMask);
+    }
+
+    float x = firstX + float(gl_InstanceIDARB) * blockWidth;
+    gl_Position = gl_ModelViewProjectionMatrix *
+            vec4(x, direction * extent * height, 0.0, 1.0);
+}
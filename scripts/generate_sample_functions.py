@@ -7,6 +7,14 @@ import sys
 
 BASIC_INDENT = 4
 
+# The copy functions for this range of channels call into the hand-vectorized
+# SampleKernels. See src/util/samplekernels.h.
+MIN_KERNEL_CHANNELS = 3
+MAX_KERNEL_CHANNELS = 8
+
+def uses_sample_kernels(num_channels):
+    return MIN_KERNEL_CHANNELS <= num_channels <= MAX_KERNEL_CHANNELS
+
 COPY_WITH_GAIN_METHOD_PATTERN = 'copy%(i)dWithGain'
 def copy_with_gain_method_name(i):
     return COPY_WITH_GAIN_METHOD_PATTERN % {'i' : i}
@@ -186,6 +194,15 @@ def copy_with_gain(output, base_indent_depth, num_channels):
         write('return;', depth=2)
         write('}', depth=1)
 
+    if uses_sample_kernels(num_channels):
+        write('const CSAMPLE* const pSrc[] = {%s};' % ', '.join(
+            'pSrc%(i)d' % {'i': i} for i in xrange(num_channels)), depth=1)
+        write('const CSAMPLE_GAIN gain[] = {%s};' % ', '.join(
+            'gain%(i)d' % {'i': i} for i in xrange(num_channels)), depth=1)
+        write('SampleKernels::active().copyWithGain[%(n)d](pDest, pSrc, gain, iNumSamples);' % {'n': num_channels}, depth=1)
+        write('}')
+        return
+
     write('// note: LOOP VECTORIZED.', depth=1)
     write('for (int i = 0; i < iNumSamples; ++i) {', depth=1)
     terms = ['pSrc%(i)d[i] * gain%(i)d' % {'i': i} for i in xrange(num_channels)]
@@ -224,6 +241,17 @@ def copy_with_ramping_gain(output, base_indent_depth, num_channels):
         write('const CSAMPLE_GAIN gain_delta%(i)d = (gain%(i)dout - gain%(i)din) / (iNumSamples / 2);' % {'i': i}, depth=1)
         write('const CSAMPLE_GAIN start_gain%(i)d = gain%(i)din + gain_delta%(i)d;' % {'i': i}, depth=1)
 
+    if uses_sample_kernels(num_channels):
+        write('const CSAMPLE* const pSrc[] = {%s};' % ', '.join(
+            'pSrc%(i)d' % {'i': i} for i in xrange(num_channels)), depth=1)
+        write('const CSAMPLE_GAIN startGain[] = {%s};' % ', '.join(
+            'start_gain%(i)d' % {'i': i} for i in xrange(num_channels)), depth=1)
+        write('const CSAMPLE_GAIN gainDelta[] = {%s};' % ', '.join(
+            'gain_delta%(i)d' % {'i': i} for i in xrange(num_channels)), depth=1)
+        write('SampleKernels::active().copyWithRampingGain[%(n)d](pDest, pSrc, startGain, gainDelta, iNumSamples);' % {'n': num_channels}, depth=1)
+        write('}')
+        return
+
     write('// note: LOOP VECTORIZED.', depth=1)
     write('for (int i = 0; i < iNumSamples / 2; ++i) {', depth=1)
 
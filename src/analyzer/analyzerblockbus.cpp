@@ -0,0 +1,150 @@
+#include "analyzer/analyzerblockbus.h"
+
+#include <QQueue>
+#include <QThread>
+
+#include "analyzer/analyzer.h"
+#include "util/timer.h"
+
+// Processes the blocks of an AnalyzerBlockBus with a single analyzer.
+// The queue and the current block are guarded by the mutex of the bus.
+class AnalyzerBlockConsumer : public QThread {
+  public:
+    AnalyzerBlockConsumer(
+            AnalyzerBlockBus* pBus,
+            Analyzer* pAnalyzer,
+            const QString& name)
+            : m_pBus(pBus),
+              m_pAnalyzer(pAnalyzer),
+              m_name(name) {
+    }
+
+    bool isIdle() const {
+        return m_queuedBlocks.isEmpty() && !m_pCurrentBlock;
+    }
+
+    void enqueue(ConstAnalyzerBlockPointer pBlock) {
+        m_queuedBlocks.enqueue(std::move(pBlock));
+    }
+
+    void discardQueuedBlocks() {
+        m_queuedBlocks.clear();
+    }
+
+  protected:
+    void run() override {
+        QThread::currentThread()->setObjectName(
+                QString("AnalyzerBlockConsumer %1").arg(m_name));
+
+        QMutexLocker locked(&m_pBus->m_mutex);
+        while (true) {
+            while (m_queuedBlocks.isEmpty() && !m_pBus->m_exit) {
+                m_pBus->m_blockPublished.wait(&m_pBus->m_mutex);
+            }
+            if (m_pBus->m_exit) {
+                break;
+            }
+            m_pCurrentBlock = m_queuedBlocks.dequeue();
+            locked.unlock();
+
+            {
+                ScopedTimer t("AnalyzerBlockConsumer %1 process", m_name);
+                m_pAnalyzer->process(
+                        m_pCurrentBlock->data(),
+                        m_pCurrentBlock->sampleCount());
+            }
+
+            locked.relock();
+            // Releasing the reference while holding the mutex guarantees
+            // that the decoder doesn't reuse the block before we are done.
+            m_pCurrentBlock.reset();
+            m_pBus->m_blockReleased.wakeAll();
+        }
+    }
+
+  private:
+    AnalyzerBlockBus* const m_pBus;
+    Analyzer* const m_pAnalyzer;
+    const QString m_name;
+
+    QQueue<ConstAnalyzerBlockPointer> m_queuedBlocks;
+    ConstAnalyzerBlockPointer m_pCurrentBlock;
+};
+
+AnalyzerBlockBus::AnalyzerBlockBus(SINT samplesPerBlock, int blockCount)
+        : m_exit(false) {
+    DEBUG_ASSERT(blockCount > 0);
+    m_blocks.reserve(blockCount);
+    for (int i = 0; i < blockCount; ++i) {
+        m_blocks.push_back(std::make_shared<AnalyzerBlock>(samplesPerBlock));
+    }
+}
+
+AnalyzerBlockBus::~AnalyzerBlockBus() {
+    {
+        QMutexLocker locked(&m_mutex);
+        m_exit = true;
+        m_blockPublished.wakeAll();
+    }
+    for (auto const& pConsumer: m_consumers) {
+        pConsumer->wait();
+    }
+}
+
+void AnalyzerBlockBus::addConsumer(Analyzer* pAnalyzer, const QString& name) {
+    auto pConsumer = std::make_unique<AnalyzerBlockConsumer>(this, pAnalyzer, name);
+    pConsumer->start(QThread::LowPriority);
+    m_consumers.push_back(std::move(pConsumer));
+}
+
+AnalyzerBlockPointer AnalyzerBlockBus::acquireBlock() {
+    ScopedTimer t("AnalyzerBlockBus::acquireBlock");
+    QMutexLocker locked(&m_mutex);
+    while (true) {
+        for (auto const& pBlock: m_blocks) {
+            // All other references are owned by the consumers and are
+            // only released while holding the mutex.
+            if (pBlock.use_count() == 1) {
+                return pBlock;
+            }
+        }
+        m_blockReleased.wait(&m_mutex);
+    }
+}
+
+void AnalyzerBlockBus::publishBlock(ConstAnalyzerBlockPointer pBlock) {
+    QMutexLocker locked(&m_mutex);
+    for (auto const& pConsumer: m_consumers) {
+        pConsumer->enqueue(pBlock);
+    }
+    // The reference of the caller must be released while holding the mutex
+    pBlock.reset();
+    m_blockPublished.wakeAll();
+}
+
+void AnalyzerBlockBus::waitForConsumers() {
+    ScopedTimer t("AnalyzerBlockBus::waitForConsumers");
+    QMutexLocker locked(&m_mutex);
+    while (!isIdle()) {
+        m_blockReleased.wait(&m_mutex);
+    }
+}
+
+void AnalyzerBlockBus::discardPendingBlocks() {
+    QMutexLocker locked(&m_mutex);
+    for (auto const& pConsumer: m_consumers) {
+        pConsumer->discardQueuedBlocks();
+    }
+    while (!isIdle()) {
+        m_blockReleased.wait(&m_mutex);
+    }
+}
+
+bool AnalyzerBlockBus::isIdle() const {
+    for (auto const& pConsumer: m_consumers) {
+        if (!pConsumer->isIdle()) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,111 @@
+#ifndef ANALYZER_ANALYZERBLOCKBUS_H
+#define ANALYZER_ANALYZERBLOCKBUS_H
+
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <vector>
+
+#include "util/class.h"
+#include "util/memory.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+class Analyzer;
+class AnalyzerBlockConsumer;
+
+// A block of decoded audio samples. Once published on the AnalyzerBlockBus
+// the block is only read by the consumers until all of them have released
+// their reference.
+class AnalyzerBlock {
+  public:
+    explicit AnalyzerBlock(SINT capacity)
+            : m_sampleBuffer(capacity),
+              m_sampleCount(0) {
+    }
+
+    const CSAMPLE* data() const {
+        return m_sampleBuffer.data();
+    }
+    SINT sampleCount() const {
+        return m_sampleCount;
+    }
+
+    mixxx::SampleBuffer::WritableSlice writableSlice() {
+        return mixxx::SampleBuffer::WritableSlice(m_sampleBuffer);
+    }
+    void setSampleCount(SINT sampleCount) {
+        DEBUG_ASSERT(sampleCount <= m_sampleBuffer.size());
+        m_sampleCount = sampleCount;
+    }
+
+  private:
+    mixxx::SampleBuffer m_sampleBuffer;
+    SINT m_sampleCount;
+
+    DISALLOW_COPY_AND_ASSIGN(AnalyzerBlock);
+};
+
+typedef std::shared_ptr<AnalyzerBlock> AnalyzerBlockPointer;
+typedef std::shared_ptr<const AnalyzerBlock> ConstAnalyzerBlockPointer;
+
+// The AnalyzerBlockBus passes each decoded block to all analyzers of an
+// AnalyzerWorker. Every analyzer processes the blocks in order on its own
+// consumer thread, so the analysis of a track takes as long as the slowest
+// analyzer instead of the sum of all analyzers.
+//
+// The blocks are taken from a fixed pool and are reused as soon as all
+// consumers have released them. If the pool is exhausted the decoder waits
+// for the slowest consumer (back-pressure).
+//
+// All functions except the constructor and destructor must be called from
+// the decoding thread. While blocks are pending, the consumer threads are
+// the only ones that invoke the analyzers. The decoding thread and the
+// AnalyzerQueue must not invoke any analyzer of a busy bus, not even for
+// loading the stored analyses of other tracks.
+class AnalyzerBlockBus {
+  public:
+    AnalyzerBlockBus(SINT samplesPerBlock, int blockCount);
+    virtual ~AnalyzerBlockBus();
+
+    // Starts a new consumer thread for the analyzer. The analyzer must
+    // outlive the bus. All functions of the analyzer except process()
+    // must only be invoked while the bus is idle, i.e. after
+    // waitForConsumers() or discardPendingBlocks() have returned.
+    void addConsumer(Analyzer* pAnalyzer, const QString& name);
+
+    // Returns a block that is not referenced by any consumer. Blocks
+    // until one of the consumers has released a block.
+    AnalyzerBlockPointer acquireBlock();
+
+    // Passes the block to all consumers. The caller must not modify
+    // the block afterwards.
+    void publishBlock(ConstAnalyzerBlockPointer pBlock);
+
+    // Waits until all published blocks have been processed.
+    void waitForConsumers();
+
+    // Drops all blocks that have not been processed yet and waits
+    // until the consumers are idle.
+    void discardPendingBlocks();
+
+  private:
+    friend class AnalyzerBlockConsumer;
+
+    bool isIdle() const;
+
+    std::vector<AnalyzerBlockPointer> m_blocks;
+    std::vector<std::unique_ptr<AnalyzerBlockConsumer>> m_consumers;
+
+    // Guards the queues of the consumers, the references to the blocks
+    // in these queues and m_exit.
+    QMutex m_mutex;
+    QWaitCondition m_blockPublished;
+    QWaitCondition m_blockReleased;
+    bool m_exit;
+
+    DISALLOW_COPY_AND_ASSIGN(AnalyzerBlockBus);
+};
+
+#endif // ANALYZER_ANALYZERBLOCKBUS_H
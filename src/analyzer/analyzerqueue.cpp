@@ -1,142 +1,240 @@
 #include "analyzer/analyzerqueue.h"
 
-#ifdef __VAMP__
-#include "analyzer/analyzerbeats.h"
-#include "analyzer/analyzerkey.h"
-#endif
-#include "analyzer/analyzergain.h"
-#include "analyzer/analyzerebur128.h"
-#include "analyzer/analyzerwaveform.h"
+#include "analyzer/analyzer.h"
+#include "analyzer/analyzerstoragewriter.h"
+#include "analyzer/analyzerworker.h"
 #include "library/dao/analysisdao.h"
-#include "engine/engine.h"
 #include "mixer/playerinfo.h"
-#include "sources/soundsourceproxy.h"
-#include "sources/audiosourcestereoproxy.h"
 #include "track/track.h"
 #include "util/compatibility.h"
 #include "util/db/dbconnectionpooler.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/event.h"
-#include "util/timer.h"
-#include "util/trace.h"
 #include "util/logger.h"
-
-// Measured in 0.1%,
-// 0 for no progress during finalize
-// 1 to display the text "finalizing"
-// 100 for 10% step after finalize
-#define FINALIZE_PROMILLE 1
+#include "util/math.h"
 
 namespace {
 
 mixxx::Logger kLogger("AnalyzerQueue");
 
-// Analysis is done in blocks.
-// We need to use a smaller block size, because on Linux the AnalyzerQueue
-// can starve the CPU of its resources, resulting in xruns. A block size
-// of 4096 frames per block seems to do fine.
-const mixxx::AudioSignal::ChannelCount kAnalysisChannels(mixxx::kEngineChannelCount);
-const SINT kAnalysisFramesPerBlock = 4096;
-const SINT kAnalysisSamplesPerBlock =
-        kAnalysisFramesPerBlock * kAnalysisChannels;
-
-QAtomicInt s_instanceCounter(0);
-
 } // anonymous namespace
 
 AnalyzerQueue::AnalyzerQueue(
         mixxx::DbConnectionPoolPtr pDbConnectionPool,
         const UserSettingsPointer& pConfig,
-        Mode mode)
+        Mode mode,
+        int workerCount)
         : m_pDbConnectionPool(std::move(pDbConnectionPool)),
           m_exit(false),
-          m_aiCheckPriorities(false),
-          m_sampleBuffer(kAnalysisSamplesPerBlock),
-          m_queue_size(0) {
+          m_aiCheckPriorities(false) {
+    if (workerCount <= 0) {
+        workerCount = defaultWorkerCount();
+    }
+    kLogger.debug() << "Starting" << workerCount << "analyzer workers";
 
     if (mode != Mode::WithoutWaveform) {
+        m_pStorageWriter = std::make_unique<AnalyzerStorageWriter>(
+                m_pDbConnectionPool, pConfig);
         m_pAnalysisDao = std::make_unique<AnalysisDao>(pConfig);
-        m_pAnalyzers.push_back(std::make_unique<AnalyzerWaveform>(m_pAnalysisDao.get()));
     }
-    m_pAnalyzers.push_back(std::make_unique<AnalyzerGain>(pConfig));
-    m_pAnalyzers.push_back(std::make_unique<AnalyzerEbur128>(pConfig));
-#ifdef __VAMP__
-    m_pAnalyzers.push_back(std::make_unique<AnalyzerBeats>(pConfig));
-    m_pAnalyzers.push_back(std::make_unique<AnalyzerKey>(pConfig));
-#endif
 
-    connect(this, SIGNAL(updateProgress()),
-            this, SLOT(slotUpdateProgress()));
+    // The analyzers of the queue are never processing any samples, they
+    // only load the stored analyses. Nothing needs to be saved.
+    for (auto& analyzer: AnalyzerWorker::createAnalyzers(
+            pConfig, mode, m_pAnalysisDao.get(), nullptr)) {
+        m_storedAnalysisLoaders.push_back(std::move(analyzer.pAnalyzer));
+    }
+
+    for (int i = 0; i < workerCount; ++i) {
+        addWorker(std::make_unique<AnalyzerWorker>(
+                this, m_pDbConnectionPool, pConfig, mode, m_pStorageWriter.get()));
+    }
+
+    connect(this, SIGNAL(storedAnalysesChecked(TrackPointer, bool, int)),
+            this, SLOT(slotStoredAnalysesChecked(TrackPointer, bool, int)));
 
     start(QThread::LowPriority);
 }
 
+AnalyzerQueue::AnalyzerQueue()
+        : m_exit(false),
+          m_aiCheckPriorities(false) {
+    connect(this, SIGNAL(storedAnalysesChecked(TrackPointer, bool, int)),
+            this, SLOT(slotStoredAnalysesChecked(TrackPointer, bool, int)));
+}
+
 AnalyzerQueue::~AnalyzerQueue() {
     stop();
-    m_progressInfo.sema.release();
-    wait(); //Wait until thread has actually stopped before proceeding.
+    wait();
+    for (auto const& pWorker: m_workers) {
+        pWorker->releaseProgress();
+    }
+    // Wait until all workers have actually stopped before the storage
+    // writer flushes the remaining analyses.
+    m_workers.clear();
+    m_pStorageWriter.reset();
+}
+
+// static
+int AnalyzerQueue::defaultWorkerCount() {
+    // Leave one core for the engine and the GUI
+    return math_max(1, QThread::idealThreadCount() - 1);
+}
+
+void AnalyzerQueue::addWorker(std::unique_ptr<AnalyzerWorker> pWorker) {
+    connect(pWorker.get(), SIGNAL(trackProgress(TrackPointer, int)),
+            this, SLOT(slotTrackProgress(TrackPointer, int)));
+    connect(pWorker.get(), SIGNAL(trackDone(TrackPointer)),
+            this, SIGNAL(trackDone(TrackPointer)));
+    connect(pWorker.get(), SIGNAL(trackFinished(TrackPointer, int)),
+            this, SLOT(slotTrackFinished(TrackPointer, int)));
+    pWorker->start(QThread::LowPriority);
+    m_workers.push_back(std::move(pWorker));
+}
+
+void AnalyzerQueue::addStoredAnalysisLoader(std::unique_ptr<Analyzer> pAnalyzer) {
+    DEBUG_ASSERT(!isRunning());
+    m_storedAnalysisLoaders.push_back(std::move(pAnalyzer));
+}
+
+void AnalyzerQueue::run() {
+    QThread::currentThread()->setObjectName("AnalyzerQueue");
+
+    // The thread-local database connection for loading the stored
+    // waveforms must not be closed before returning from this function.
+    mixxx::DbConnectionPooler dbConnectionPooler;
+    if (m_pAnalysisDao) {
+        dbConnectionPooler = mixxx::DbConnectionPooler(m_pDbConnectionPool); // move assignment
+        if (!dbConnectionPooler.isPooling()) {
+            kLogger.warning()
+                    << "Failed to obtain database connection for analyzer queue thread";
+            // The workers load the stored analyses when initializing their
+            // analyzers
+            m_pAnalysisDao.reset();
+            m_storedAnalysisLoaders.clear();
+        } else {
+            QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+            DEBUG_ASSERT(dbConnection.isOpen());
+            m_pAnalysisDao->initialize(dbConnection);
+        }
+    }
+
+    while (true) {
+        TrackPointer pTrack = takeUncheckedTrack();
+        if (!pTrack) {
+            break;
+        }
+        if (loadStoredAnalyses(pTrack)) {
+            int size;
+            {
+                QMutexLocker locked(&m_qm);
+                m_checkingTrack.reset();
+                size = pendingTrackCount();
+            }
+            emit(storedAnalysesChecked(pTrack, true, size));
+            continue;
+        }
+
+        // Emitted before the track can be taken by a worker, so that the
+        // progress of the worker is delivered after it
+        emit(storedAnalysesChecked(pTrack, false, 0));
+        const PlayerInfo& info = PlayerInfo::instance();
+        QMutexLocker locked(&m_qm);
+        m_checkingTrack.reset();
+        if (!m_queuedTracks.contains(pTrack) &&
+                !m_analyzingTracks.contains(pTrack)) {
+            m_queuedTracks.enqueue(pTrack);
+            if (info.isTrackLoaded(pTrack)) {
+                m_aiCheckPriorities = true;
+            }
+            m_qwait.wakeAll();
+        }
+    }
+
+    if (m_pAnalysisDao) {
+        // Invalidate reference to the thread-local database connection
+        // that will be closed soon.
+        m_pAnalysisDao->initialize(QSqlDatabase());
+    }
 }
 
 // This is called from the AnalyzerQueue thread
+TrackPointer AnalyzerQueue::takeUncheckedTrack() {
+    QMutexLocker locked(&m_qm);
+    while (m_uncheckedTracks.isEmpty() && !m_exit) {
+        m_uncheckedWait.wait(&m_qm);
+    }
+    if (m_exit) {
+        return TrackPointer();
+    }
+
+    const PlayerInfo& info = PlayerInfo::instance();
+    QMutableListIterator<TrackPointer> it(m_uncheckedTracks);
+    while (it.hasNext()) {
+        const TrackPointer& pTrack = it.next();
+        // Check tracks that are loaded first
+        if (info.isTrackLoaded(pTrack)) {
+            m_checkingTrack = pTrack;
+            it.remove();
+            return m_checkingTrack;
+        }
+    }
+    m_checkingTrack = m_uncheckedTracks.dequeue();
+    return m_checkingTrack;
+}
+
+// This is called from the AnalyzerQueue thread
+bool AnalyzerQueue::loadStoredAnalyses(const TrackPointer& pTrack) {
+    if (m_storedAnalysisLoaders.empty()) {
+        return false;
+    }
+    bool analysed = true;
+    for (auto const& pAnalyzer: m_storedAnalysisLoaders) {
+        // Make sure not to short-circuit the loading of the other analyses
+        if (!pAnalyzer->isDisabledOrLoadStoredSuccess(pTrack)) {
+            analysed = false;
+        }
+    }
+    return analysed;
+}
+
+// This is called from the AnalyzerWorker threads while their analyzers
+// are processing blocks on the AnalyzerBlockBus. It must not invoke any
+// analyzer of the calling worker.
 bool AnalyzerQueue::isLoadedTrackWaiting(TrackPointer analysingTrack) {
     const PlayerInfo& info = PlayerInfo::instance();
-    TrackPointer pTrack;
     bool trackWaiting = false;
-    QList<TrackPointer> progress100List;
-    QList<TrackPointer> progress0List;
 
     QMutexLocker locked(&m_qm);
     QMutableListIterator<TrackPointer> it(m_queuedTracks);
     while (it.hasNext()) {
-        TrackPointer& pTrack = it.next();
-        if (!pTrack) {
+        const TrackPointer& pTrack = it.next();
+        if (!pTrack || (pTrack->getAnalyzerProgress() == 1000)) {
+            // Deleted or analysed in the meantime
             it.remove();
             continue;
         }
         if (!trackWaiting) {
             trackWaiting = info.isTrackLoaded(pTrack);
         }
-        // try to load waveforms for all new tracks first
-        // and remove them from queue if already analysed
-        // This avoids waiting for a running analysis for those tracks.
-        int progress = pTrack->getAnalyzerProgress();
-        if (progress < 0) {
-            // Load stored analysis
-            bool processTrack = false;
-            for (auto const& pAnalyzer: m_pAnalyzers) {
-                if (!pAnalyzer->isDisabledOrLoadStoredSuccess(pTrack)) {
-                    processTrack = true;
-                }
-            }
-            if (!processTrack) {
-                progress100List.append(pTrack);
-                it.remove(); // since pTrack is a reference it is invalid now.
-            } else {
-                progress0List.append(pTrack);
-            }
-        } else if (progress == 1000) {
-            it.remove();
-        }
     }
-
+    // A free worker takes the loaded track without interrupting another one
+    const bool workerFree = m_analyzingTracks.size() <
+            static_cast<int>(m_workers.size());
     locked.unlock();
 
-    // update progress after unlock to avoid a deadlock
-    foreach (TrackPointer pTrack, progress100List) {
-        emitUpdateProgress(pTrack, 1000);
-    }
-    foreach (TrackPointer pTrack, progress0List) {
-        emitUpdateProgress(pTrack, 0);
-    }
-
-    if (info.isTrackLoaded(analysingTrack)) {
+    if (workerFree || info.isTrackLoaded(analysingTrack)) {
         return false;
     }
     return trackWaiting;
 }
 
-// This is called from the AnalyzerQueue thread
-// The returned track might be NULL, up to the caller to check.
+// This is called from the AnalyzerWorker threads
+bool AnalyzerQueue::checkPriorities() {
+    return m_aiCheckPriorities.fetchAndStoreAcquire(false);
+}
+
+// This is called from the AnalyzerWorker threads
 TrackPointer AnalyzerQueue::dequeueNextBlocking() {
     QMutexLocker locked(&m_qm);
     if (m_queuedTracks.isEmpty()) {
@@ -169,300 +267,130 @@ TrackPointer AnalyzerQueue::dequeueNextBlocking() {
         pLoadTrack = m_queuedTracks.dequeue();
     }
 
+    if (pLoadTrack) {
+        m_analyzingTracks.append(pLoadTrack);
+    }
     return pLoadTrack;
 }
 
-// This is called from the AnalyzerQueue thread
-bool AnalyzerQueue::doAnalysis(
-        TrackPointer pTrack,
-        mixxx::AudioSourcePointer pAudioSource) {
-
-    QTime progressUpdateInhibitTimer;
-    progressUpdateInhibitTimer.start(); // Inhibit Updates for 60 milliseconds
-
-    mixxx::AudioSourceStereoProxy audioSourceProxy(
-            pAudioSource,
-            kAnalysisFramesPerBlock);
-    DEBUG_ASSERT(audioSourceProxy.channelCount() == kAnalysisChannels);
-
-    mixxx::IndexRange remainingFrames = pAudioSource->frameIndexRange();
-    bool dieflag = false;
-    bool cancelled = false;
-    while (!dieflag && !remainingFrames.empty()) {
-        ScopedTimer t("AnalyzerQueue::doAnalysis block");
-
-        const auto inputFrameIndexRange =
-                remainingFrames.splitAndShrinkFront(
-                        math_min(kAnalysisFramesPerBlock, remainingFrames.length()));
-        DEBUG_ASSERT(!inputFrameIndexRange.empty());
-        const auto readableSampleFrames =
-                audioSourceProxy.readSampleFrames(
-                        mixxx::WritableSampleFrames(
-                                inputFrameIndexRange,
-                                mixxx::SampleBuffer::WritableSlice(m_sampleBuffer)));
-        // To compare apples to apples, let's only look at blocks that are
-        // the full block size.
-        if (readableSampleFrames.frameLength() == kAnalysisFramesPerBlock) {
-            // Complete analysis block of audio samples has been read.
-            for (auto const& pAnalyzer: m_pAnalyzers) {
-                pAnalyzer->process(
-                        readableSampleFrames.readableData(),
-                        readableSampleFrames.readableLength());
-            }
-        } else {
-            // Partial analysis block of audio samples has been read.
-            // This should only happen at the end of an audio stream,
-            // otherwise a decoding error must have occurred.
-            if (!remainingFrames.empty()) {
-                // EOF not reached -> Maybe a corrupt file?
-                kLogger.warning()
-                        << "Aborting analysis after failed to read sample data from"
-                        << pTrack->getLocation()
-                        << ": expected frames =" << inputFrameIndexRange
-                        << ", actual frames =" << readableSampleFrames.frameIndexRange();
-                dieflag = true; // abort
-                cancelled = false; // completed, no retry
-            }
-        }
-
-        // emit progress updates
-        // During the doAnalysis function it goes only to 100% - FINALIZE_PERCENT
-        // because the finalize functions will take also some time
-        //fp div here prevents insane signed overflow
-        const double frameProgress =
-                double(pAudioSource->frameLength() - remainingFrames.length()) /
-                double(pAudioSource->frameLength());
-        int progressPromille = frameProgress * (1000 - FINALIZE_PROMILLE);
-
-        if (m_progressInfo.track_progress != progressPromille) {
-            if (progressUpdateInhibitTimer.elapsed() > 60) {
-                // Inhibit Updates for 60 milliseconds
-                emitUpdateProgress(pTrack, progressPromille);
-                progressUpdateInhibitTimer.start();
-            }
-        }
+// This is called from the AnalyzerWorker threads
+void AnalyzerQueue::finishTrack(const TrackPointer& pTrack, bool requeue) {
+    QMutexLocker locked(&m_qm);
+    const bool removed = m_analyzingTracks.removeOne(pTrack);
+    DEBUG_ASSERT(removed);
+    Q_UNUSED(removed);
+    if (requeue && !m_queuedTracks.contains(pTrack)) {
+        m_queuedTracks.enqueue(pTrack);
+        m_qwait.wakeAll();
+    }
+}
 
-        // Since this is a background analysis queue, we should co-operatively
-        // yield every now and then to try and reduce CPU contention. The
-        // analyzer queue is CPU intensive so we want to get out of the way of
-        // the audio callback thread.
-        //QThread::yieldCurrentThread();
-        //QThread::usleep(10);
-
-        // has something new entered the queue?
-        if (m_aiCheckPriorities.fetchAndStoreAcquire(false)) {
-            if (isLoadedTrackWaiting(pTrack)) {
-                kLogger.debug() << "Interrupting analysis to give preference to a loaded track.";
-                dieflag = true;
-                cancelled = true;
-            }
-        }
+// This is called while holding m_qm
+int AnalyzerQueue::pendingTrackCount() const {
+    return m_uncheckedTracks.size() + (m_checkingTrack ? 1 : 0) +
+            m_queuedTracks.size() + m_analyzingTracks.size();
+}
 
-        if (m_exit) {
-            dieflag = true;
-            cancelled = true;
-        }
+// This is called from the AnalyzerWorker threads
+int AnalyzerQueue::pendingTrackCountOfOtherWorkers() {
+    QMutexLocker locked(&m_qm);
+    // Exclude the track of the calling worker
+    return math_max(0, pendingTrackCount() - 1);
+}
 
-        // Ignore blocks in which we decided to bail for stats purposes.
-        if (dieflag || cancelled) {
-            t.cancel();
-        }
+void AnalyzerQueue::emptyCheck() {
+    QMutexLocker locked(&m_qm);
+    if (m_uncheckedTracks.isEmpty() && !m_checkingTrack &&
+            m_queuedTracks.isEmpty() && m_analyzingTracks.isEmpty()) {
+        locked.unlock();
+        emit(queueEmpty()); // emit asynchrony for no deadlock
     }
-
-    return !cancelled; //don't return !dieflag or we might reanalyze over and over
 }
 
 void AnalyzerQueue::stop() {
     m_exit = true;
     QMutexLocker locked(&m_qm);
     m_qwait.wakeAll();
+    m_uncheckedWait.wakeAll();
 }
 
-void AnalyzerQueue::run() {
-    // If there are no analyzers, don't waste time running.
-    if (m_pAnalyzers.empty()) {
-        return;
-    }
-
-    const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
-    QThread::currentThread()->setObjectName(QString("AnalyzerQueue %1").arg(instanceId));
-
-    kLogger.debug() << "Entering thread";
-
-    execThread();
-
-    kLogger.debug() << "Exiting thread";
+void AnalyzerQueue::slotAnalyseTrack(TrackPointer pTrack) {
+    // This slot is called from the decks and and samplers when the track was loaded.
+    // The workers are asked to check their priorities as soon as the stored
+    // analyses of the track have been loaded.
+    queueAnalyseTrack(pTrack);
 }
 
-void AnalyzerQueue::execThread() {
-    // The thread-local database connection for waveform analysis must not
-    // be closed before returning from this function. Therefore the
-    // DbConnectionPooler is defined at this outer function scope,
-    // independent of whether a database connection will be opened
-    // or not.
-    mixxx::DbConnectionPooler dbConnectionPooler;
-    // m_pAnalysisDao remains null if no analyzer needs database access.
-    // Currently only waveform analyses makes use of it.
-    if (m_pAnalysisDao) {
-        dbConnectionPooler = mixxx::DbConnectionPooler(m_pDbConnectionPool); // move assignment
-        if (!dbConnectionPooler.isPooling()) {
-            kLogger.warning()
-                    << "Failed to obtain database connection for analyzer queue thread";
-            return;
+// This is called from the GUI thread
+void AnalyzerQueue::queueAnalyseTrack(TrackPointer pTrack) {
+    if (pTrack) {
+        QMutexLocker locked(&m_qm);
+        // A track that is analysed right now would only be analysed twice
+        if (!m_uncheckedTracks.contains(pTrack) &&
+                (m_checkingTrack != pTrack) &&
+                !m_queuedTracks.contains(pTrack) &&
+                !m_analyzingTracks.contains(pTrack)) {
+            m_uncheckedTracks.enqueue(pTrack);
+            m_uncheckedWait.wakeAll();
         }
-        // Obtain and use the newly created database connection within this thread
-        QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
-        DEBUG_ASSERT(dbConnection.isOpen());
-        m_pAnalysisDao->initialize(dbConnection);
     }
+}
 
-    m_progressInfo.current_track.reset();
-    m_progressInfo.track_progress = 0;
-    m_progressInfo.queue_size = 0;
-    m_progressInfo.sema.release(); // Initialize with one
-
-    while (!m_exit) {
-        TrackPointer nextTrack = dequeueNextBlocking();
-
-        // It's important to check for m_exit here in case we decided to exit
-        // while blocking for a new track.
-        if (m_exit) {
-            break;
-        }
-
-        // If the track is NULL, try to get the next one.
-        // Could happen if the track was queued but then deleted.
-        // Or if dequeueNextBlocking is unblocked by exit == true
-        if (!nextTrack) {
-            emptyCheck();
-            continue;
-        }
-
-        kLogger.debug() << "Analyzing" << nextTrack->getTitle() << nextTrack->getLocation();
-
-        Trace trace("AnalyzerQueue analyzing track");
-
-        // Get the audio
-        mixxx::AudioSource::OpenParams openParams;
-        openParams.setChannelCount(kAnalysisChannels);
-        auto pAudioSource = SoundSourceProxy(nextTrack).openAudioSource(openParams);
-        if (!pAudioSource) {
-            kLogger.warning()
-                    << "Failed to open file for analyzing:"
-                    << nextTrack->getLocation();
-            emptyCheck();
-            continue;
-        }
-
-        bool processTrack = false;
-        for (auto const& pAnalyzer: m_pAnalyzers) {
-            // Make sure not to short-circuit initialize(...)
-            if (pAnalyzer->initialize(
-                    nextTrack,
-                    pAudioSource->sampleRate(),
-                    pAudioSource->frameLength() * kAnalysisChannels)) {
-                processTrack = true;
-            }
-        }
-
-        updateSize();
-
-        if (processTrack) {
-            emitUpdateProgress(nextTrack, 0);
-            bool completed = doAnalysis(nextTrack, pAudioSource);
-            if (!completed) {
-                // This track was cancelled
-                for (auto const& pAnalyzer: m_pAnalyzers) {
-                    pAnalyzer->cleanup(nextTrack);
-                }
-                queueAnalyseTrack(nextTrack);
-                emitUpdateProgress(nextTrack, 0);
-            } else {
-                // 100% - FINALIZE_PERCENT finished
-                emitUpdateProgress(nextTrack, 1000 - FINALIZE_PROMILLE);
-                // This takes around 3 sec on a Atom Netbook
-                for (auto const& pAnalyzer: m_pAnalyzers) {
-                    pAnalyzer->finalize(nextTrack);
-                }
-                emit(trackDone(nextTrack));
-                emitUpdateProgress(nextTrack, 1000); // 100%
-            }
-        } else {
-            emitUpdateProgress(nextTrack, 1000); // 100%
-            kLogger.debug() << "Skipping track analysis because no analyzer initialized.";
-        }
+void AnalyzerQueue::slotStoredAnalysesChecked(
+        TrackPointer pTrack, bool analysed, int size) {
+    if (analysed) {
+        pTrack->setAnalyzerProgress(1000);
+        emit(trackFinished(size));
         emptyCheck();
+    } else {
+        // Waiting for a worker
+        pTrack->setAnalyzerProgress(0);
     }
-
-    if (m_pAnalysisDao) {
-        // Invalidate reference to the thread-local database connection
-        // that will be closed soon. Not necessary, just in case ;)
-        m_pAnalysisDao->initialize(QSqlDatabase());
-    }
-
-    emit(queueEmpty()); // emit in case of exit;
 }
 
-void AnalyzerQueue::emptyCheck() {
-    updateSize();
-    if (m_queue_size == 0) {
-        emit(queueEmpty()); // emit asynchrony for no deadlock
+void AnalyzerQueue::slotTrackProgress(TrackPointer pTrack, int progress) {
+    bool interrupted = false;
+    if (progress < 100) {
+        // The worker resets the progress of a track after it has been
+        // queued again. The progress of a finished track is removed
+        // by slotTrackFinished().
+        QMutexLocker locked(&m_qm);
+        interrupted = !m_analyzingTracks.contains(pTrack);
     }
-}
-
-void AnalyzerQueue::updateSize() {
-    QMutexLocker locked(&m_qm);
-    m_queue_size = m_queuedTracks.size();
-}
-
-// This is called from the AnalyzerQueue thread
-void AnalyzerQueue::emitUpdateProgress(TrackPointer track, int progress) {
-    if (!m_exit) {
-        // First tryAcqire will have always success because sema is initialized with on
-        // The following tries will success if the previous signal was processed in the GUI Thread
-        // This prevent the AnalysisQueue from filling up the GUI Thread event Queue
-        // 100 % is emitted in any case
-        if (progress < 1000 - FINALIZE_PROMILLE && progress > 0) {
-            // Signals during processing are not required in any case
-            if (!m_progressInfo.sema.tryAcquire()) {
-               return;
+    bool found = false;
+    QMutableListIterator<TrackProgress> it(m_trackProgress);
+    while (it.hasNext()) {
+        TrackProgress& trackProgress = it.next();
+        if (trackProgress.pTrack == pTrack) {
+            found = true;
+            if (interrupted) {
+                // Starts again at the end of the list
+                it.remove();
+            } else {
+                trackProgress.progress = progress;
             }
-        } else {
-            m_progressInfo.sema.acquire();
         }
-        m_progressInfo.current_track = track;
-        m_progressInfo.track_progress = progress;
-        m_progressInfo.queue_size = m_queue_size;
-        emit(updateProgress());
     }
-}
-
-//slot
-void AnalyzerQueue::slotUpdateProgress() {
-    if (m_progressInfo.current_track) {
-        m_progressInfo.current_track->setAnalyzerProgress(m_progressInfo.track_progress);
-        m_progressInfo.current_track.reset();
+    if (!found && !interrupted) {
+        TrackProgress trackProgress;
+        trackProgress.pTrack = pTrack;
+        trackProgress.progress = progress;
+        m_trackProgress.append(trackProgress);
     }
-    emit(trackProgress(m_progressInfo.track_progress / 10));
-    if (m_progressInfo.track_progress == 1000) {
-        emit(trackFinished(m_progressInfo.queue_size));
+    if (!m_trackProgress.isEmpty()) {
+        emit(trackProgress(m_trackProgress.first().progress));
     }
-    m_progressInfo.sema.release();
-}
-
-void AnalyzerQueue::slotAnalyseTrack(TrackPointer pTrack) {
-    // This slot is called from the decks and and samplers when the track was loaded.
-    queueAnalyseTrack(pTrack);
-    m_aiCheckPriorities = true;
 }
 
-// This is called from the GUI and from the AnalyzerQueue thread
-void AnalyzerQueue::queueAnalyseTrack(TrackPointer pTrack) {
-    if (pTrack) {
-        QMutexLocker locked(&m_qm);
-        if (!m_queuedTracks.contains(pTrack)) {
-            m_queuedTracks.enqueue(pTrack);
-            m_qwait.wakeAll();
+void AnalyzerQueue::slotTrackFinished(TrackPointer pTrack, int size) {
+    QMutableListIterator<TrackProgress> it(m_trackProgress);
+    while (it.hasNext()) {
+        if (it.next().pTrack == pTrack) {
+            it.remove();
         }
     }
+    emit(trackFinished(size));
+    if (!m_trackProgress.isEmpty()) {
+        emit(trackProgress(m_trackProgress.first().progress));
+    }
 }
@@ -1,23 +1,33 @@
 #ifndef ANALYZER_ANALYZERQUEUE_H
 #define ANALYZER_ANALYZERQUEUE_H
 
-#include <QThread>
+#include <QList>
 #include <QQueue>
+#include <QMutex>
+#include <QThread>
 #include <QWaitCondition>
-#include <QSemaphore>
 
 #include <vector>
 
 #include "preferences/usersettings.h"
-#include "sources/audiosource.h"
 #include "track/track.h"
 #include "util/db/dbconnectionpool.h"
-#include "util/samplebuffer.h"
 #include "util/memory.h"
 
 class Analyzer;
 class AnalysisDao;
-
+class AnalyzerStorageWriter;
+class AnalyzerWorker;
+
+// The AnalyzerQueue distributes the queued tracks among a pool of
+// AnalyzerWorker threads. Each worker decodes one track at a time and
+// feeds the decoded audio into its own set of analyzers. Tracks that are
+// loaded into a player are analyzed first. The analyses of all workers
+// are written to the database by a single AnalyzerStorageWriter.
+//
+// The thread of the queue loads the stored analyses of newly queued tracks
+// with a separate set of analyzers. Tracks that have already been analysed
+// are finished right away and never reach the workers.
 class AnalyzerQueue : public QThread {
     Q_OBJECT
 
@@ -27,65 +37,124 @@ class AnalyzerQueue : public QThread {
         WithoutWaveform,
     };
 
+    // Passing a worker count of 0 sizes the pool according to the
+    // number of available cores.
     AnalyzerQueue(
             mixxx::DbConnectionPoolPtr pDbConnectionPool,
             const UserSettingsPointer& pConfig,
-            Mode mode = Mode::Default);
+            Mode mode = Mode::Default,
+            int workerCount = 0);
     ~AnalyzerQueue() override;
 
+    static int defaultWorkerCount();
+
     void stop();
     void queueAnalyseTrack(TrackPointer tio);
 
   public slots:
     void slotAnalyseTrack(TrackPointer tio);
-    void slotUpdateProgress();
 
   signals:
+    // The progress of the track that has been analysed for the longest
+    // time. The other tracks are analysed in parallel.
     void trackProgress(int progress);
     void trackDone(TrackPointer track);
+    // Emitted once for every finished track with the number of tracks
+    // that are still queued or analysed
     void trackFinished(int size);
-    // Signals from AnalyzerQueue Thread:
+    // Signals from AnalyzerWorker threads:
     void queueEmpty();
-    void updateProgress();
+    // Signals from the AnalyzerQueue thread:
+    // size is the number of pending tracks if the track has been analysed
+    void storedAnalysesChecked(TrackPointer track, bool analysed, int size);
 
   protected:
-    void run();
+    // Without any workers and without loading stored analyses, for tests.
+    // The workers are added with addWorker() and the stored analyses are
+    // only loaded if the analyzers for this are added before start().
+    AnalyzerQueue();
 
-  private:
-    struct progress_info {
-        TrackPointer current_track;
-        int track_progress; // in 0.1 %
-        int queue_size;
-        QSemaphore sema;
-    };
+    // Connects and starts the worker
+    void addWorker(std::unique_ptr<AnalyzerWorker> pWorker);
+    void addStoredAnalysisLoader(std::unique_ptr<Analyzer> pAnalyzer);
 
-    mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    void run() override;
 
-    std::unique_ptr<AnalysisDao> m_pAnalysisDao;
+  private slots:
+    void slotStoredAnalysesChecked(TrackPointer track, bool analysed, int size);
+    void slotTrackProgress(TrackPointer track, int progress);
+    void slotTrackFinished(TrackPointer track, int size);
+
+  private:
+    friend class AnalyzerWorker;
 
-    typedef std::unique_ptr<Analyzer> AnalyzerPtr;
-    std::vector<AnalyzerPtr> m_pAnalyzers;
+    // The following functions are called from the AnalyzerWorker threads
 
-    void execThread();
+    bool isExiting() const {
+        return m_exit;
+    }
 
+    // Returns true if a track that is loaded into a player is waiting
+    // in the queue and the track that is analysed by the calling worker
+    // should be interrupted. A worker is only interrupted if no other
+    // worker is free to pick up the loaded track.
     bool isLoadedTrackWaiting(TrackPointer analysingTrack);
+    // Checks and resets the flag that a new loaded track has been queued.
+    // Only one of the workers will receive true.
+    bool checkPriorities();
+    // The returned track might be NULL, up to the caller to check. If a track
+    // is returned the caller must call finishTrack() afterwards.
     TrackPointer dequeueNextBlocking();
-    bool doAnalysis(TrackPointer tio, mixxx::AudioSourcePointer pAudioSource);
-    void emitUpdateProgress(TrackPointer tio, int progress);
+    // Queues the track again if its analysis has been interrupted
+    void finishTrack(const TrackPointer& pTrack, bool requeue);
+    // The number of tracks that are waiting or are analysed by another worker
+    int pendingTrackCountOfOtherWorkers();
     void emptyCheck();
-    void updateSize();
+
+    // The number of tracks that are waiting or are analysed. The caller
+    // must hold m_qm.
+    int pendingTrackCount() const;
+
+    // Called from the AnalyzerQueue thread. Returns true if no analyzer
+    // needs to process the track.
+    bool loadStoredAnalyses(const TrackPointer& pTrack);
+    // Removes and returns the next track that has not been checked yet,
+    // tracks that are loaded into a player first. Blocks until a track is
+    // queued or the queue is stopped.
+    TrackPointer takeUncheckedTrack();
+
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+
+    std::vector<std::unique_ptr<AnalyzerWorker>> m_workers;
+    std::unique_ptr<AnalyzerStorageWriter> m_pStorageWriter;
+
+    // Only invoked by the thread of the queue
+    std::unique_ptr<AnalysisDao> m_pAnalysisDao;
+    std::vector<std::unique_ptr<Analyzer>> m_storedAnalysisLoaders;
 
     bool m_exit;
     QAtomicInt m_aiCheckPriorities;
 
-    mixxx::SampleBuffer m_sampleBuffer;
-
+    // The tracks whose stored analyses have not been loaded yet
+    QQueue<TrackPointer> m_uncheckedTracks;
+    // The track whose stored analyses are loaded right now
+    TrackPointer m_checkingTrack;
+    QWaitCondition m_uncheckedWait;
     // The processing queue and associated mutex
     QQueue<TrackPointer> m_queuedTracks;
+    // The tracks between dequeueNextBlocking() and finishTrack(). They are
+    // not queued again while they are analysed.
+    QList<TrackPointer> m_analyzingTracks;
     QMutex m_qm;
     QWaitCondition m_qwait;
-    struct progress_info m_progressInfo;
-    int m_queue_size;
+
+    // The progress of the tracks that are analysed by the workers, ordered
+    // by the start of their analysis. Only accessed by the GUI thread.
+    struct TrackProgress {
+        TrackPointer pTrack;
+        int progress;
+    };
+    QList<TrackProgress> m_trackProgress;
 };
 
 #endif /* ANALYZER_ANALYZERQUEUE_H */
@@ -0,0 +1,108 @@
+#include "analyzer/analyzerstoragewriter.h"
+
+#include "library/dao/analysisdao.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/db/dbconnectionpooled.h"
+#include "util/db/sqltransaction.h"
+#include "util/logger.h"
+
+namespace {
+
+mixxx::Logger kLogger("AnalyzerStorageWriter");
+
+// Pending tracks are collected for this time span before writing them
+// to the database, unless the batch is already full.
+const unsigned long kBatchIntervalMillis = 2000;
+const int kMaxBatchSize = 64;
+
+} // anonymous namespace
+
+AnalyzerStorageWriter::AnalyzerStorageWriter(
+        mixxx::DbConnectionPoolPtr pDbConnectionPool,
+        const UserSettingsPointer& pConfig)
+        : m_pDbConnectionPool(std::move(pDbConnectionPool)),
+          m_pAnalysisDao(std::make_unique<AnalysisDao>(pConfig)),
+          m_exit(false) {
+    start(QThread::LowPriority);
+}
+
+AnalyzerStorageWriter::~AnalyzerStorageWriter() {
+    stop();
+    wait();
+}
+
+void AnalyzerStorageWriter::saveTrackAnalyses(TrackPointer pTrack) {
+    if (!pTrack) {
+        return;
+    }
+    QMutexLocker locked(&m_mutex);
+    m_pendingTracks.append(pTrack);
+    if (m_pendingTracks.size() >= kMaxBatchSize) {
+        m_waitCondition.wakeAll();
+    }
+}
+
+void AnalyzerStorageWriter::stop() {
+    QMutexLocker locked(&m_mutex);
+    m_exit = true;
+    m_waitCondition.wakeAll();
+}
+
+void AnalyzerStorageWriter::run() {
+    QThread::currentThread()->setObjectName("AnalyzerStorageWriter");
+
+    // The thread-local database connection must not be closed before
+    // returning from this function.
+    mixxx::DbConnectionPooler dbConnectionPooler(m_pDbConnectionPool);
+    if (!dbConnectionPooler.isPooling()) {
+        kLogger.warning()
+                << "Failed to obtain database connection for analyzer storage writer";
+        return;
+    }
+    QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+    DEBUG_ASSERT(dbConnection.isOpen());
+    m_pAnalysisDao->initialize(dbConnection);
+
+    bool exit = false;
+    while (!exit) {
+        QList<TrackPointer> batch;
+        {
+            QMutexLocker locked(&m_mutex);
+            if (!m_exit && (m_pendingTracks.size() < kMaxBatchSize)) {
+                m_waitCondition.wait(&m_mutex, kBatchIntervalMillis);
+            }
+            exit = m_exit;
+            while (!m_pendingTracks.isEmpty() && (batch.size() < kMaxBatchSize)) {
+                batch.append(m_pendingTracks.takeFirst());
+            }
+            if (!m_pendingTracks.isEmpty()) {
+                // Continue with the next batch before exiting
+                exit = false;
+            }
+        }
+        if (!batch.isEmpty()) {
+            writeBatch(dbConnection, batch);
+        }
+    }
+
+    // Invalidate reference to the thread-local database connection
+    // that will be closed soon.
+    m_pAnalysisDao->initialize(QSqlDatabase());
+}
+
+void AnalyzerStorageWriter::writeBatch(
+        const QSqlDatabase& database,
+        const QList<TrackPointer>& tracks) {
+    SqlTransaction transaction(database);
+    for (const auto& pTrack: tracks) {
+        m_pAnalysisDao->saveTrackAnalyses(
+                pTrack->getId(),
+                pTrack->getWaveform(),
+                pTrack->getWaveformSummary());
+    }
+    if (transaction) {
+        transaction.commit();
+    }
+    kLogger.debug() << "Saved analyses of" << tracks.size() << "tracks";
+    emit(batchWritten(tracks.size()));
+}
@@ -0,0 +1,63 @@
+#ifndef ANALYZER_ANALYZERSTORAGEWRITER_H
+#define ANALYZER_ANALYZERSTORAGEWRITER_H
+
+#include <QThread>
+#include <QList>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QWaitCondition>
+
+#include "preferences/usersettings.h"
+#include "track/track.h"
+#include "util/db/dbconnectionpool.h"
+#include "util/memory.h"
+
+class AnalysisDao;
+
+// Stores the results of the analyzers of all AnalyzerWorkers in the
+// database. SQLite only allows a single writer at a time. Instead of
+// letting multiple analyzer threads compete for the database lock each
+// track is queued and written by this thread. Pending tracks are collected
+// and written in batches within a single transaction.
+//
+// Only the waveform analyses are written here. The results of the other
+// analyzers (beats, key, ReplayGain) are stored in the Track objects and
+// written by TrackDAO when the GlobalTrackCache evicts the track, which
+// happens on the main thread and never on the analyzer threads.
+class AnalyzerStorageWriter : public QThread {
+    Q_OBJECT
+
+  public:
+    AnalyzerStorageWriter(
+            mixxx::DbConnectionPoolPtr pDbConnectionPool,
+            const UserSettingsPointer& pConfig);
+    ~AnalyzerStorageWriter() override;
+
+    // Queues the waveform analyses of the track for saving. Thread-safe.
+    void saveTrackAnalyses(TrackPointer pTrack);
+
+    // Writes all pending tracks and exits the thread.
+    void stop();
+
+  signals:
+    // Emitted from the thread of the writer after each transaction
+    void batchWritten(int trackCount);
+
+  protected:
+    void run() override;
+
+  private:
+    void writeBatch(
+            const QSqlDatabase& database,
+            const QList<TrackPointer>& tracks);
+
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+    const std::unique_ptr<AnalysisDao> m_pAnalysisDao;
+
+    QMutex m_mutex;
+    QWaitCondition m_waitCondition;
+    QList<TrackPointer> m_pendingTracks;
+    bool m_exit;
+};
+
+#endif // ANALYZER_ANALYZERSTORAGEWRITER_H
@@ -1,5 +1,6 @@
 #include "analyzer/analyzerwaveform.h"
 
+#include "analyzer/analyzerstoragewriter.h"
 #include "engine/engineobject.h"
 #include "engine/enginefilterbutterworth8.h"
 #include "engine/enginefilterbessel4.h"
@@ -16,8 +17,10 @@ mixxx::Logger kLogger("AnalyzerWaveform");
 } // anonymous
 
 AnalyzerWaveform::AnalyzerWaveform(
-        AnalysisDao* pAnalysisDao) :
+        AnalysisDao* pAnalysisDao,
+        AnalyzerStorageWriter* pStorageWriter) :
         m_pAnalysisDao(pAnalysisDao),
+        m_pStorageWriter(pStorageWriter),
         m_skipProcessing(false),
         m_waveformData(nullptr),
         m_waveformSummaryData(nullptr),
@@ -115,7 +118,10 @@ bool AnalyzerWaveform::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
                 if (missingWaveform && vc == WaveformFactory::VC_USE) {
                     pLoadedTrackWaveform = ConstWaveformPointer(
                             WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWaveform = false;
+                    missingWaveform = !pLoadedTrackWaveform->isValid();
+                } else if (missingWaveform && vc == WaveformFactory::VC_MIGRATE) {
+                    pLoadedTrackWaveform = loadAndMigrate(analysis);
+                    missingWaveform = !pLoadedTrackWaveform;
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
                     m_pAnalysisDao->deleteAnalysis(analysis.analysisId);
@@ -125,7 +131,10 @@ bool AnalyzerWaveform::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
                 if (missingWavesummary && vc == WaveformFactory::VC_USE) {
                     pLoadedTrackWaveformSummary = ConstWaveformPointer(
                             WaveformFactory::loadWaveformFromAnalysis(analysis));
-                    missingWavesummary = false;
+                    missingWavesummary = !pLoadedTrackWaveformSummary->isValid();
+                } else if (missingWavesummary && vc == WaveformFactory::VC_MIGRATE) {
+                    pLoadedTrackWaveformSummary = loadAndMigrate(analysis);
+                    missingWavesummary = !pLoadedTrackWaveformSummary;
                 } else if (vc != WaveformFactory::VC_KEEP) {
                     // remove all other Analysis except that one we should keep
                     m_pAnalysisDao->deleteAnalysis(analysis.analysisId);
@@ -148,6 +157,29 @@ bool AnalyzerWaveform::isDisabledOrLoadStoredSuccess(TrackPointer tio) const {
     return false;
 }
 
+ConstWaveformPointer AnalyzerWaveform::loadAndMigrate(
+        AnalysisDao::AnalysisInfo analysis) const {
+    if (!m_pAnalysisDao->loadAnalysisData(&analysis)) {
+        return ConstWaveformPointer();
+    }
+    ConstWaveformPointer pWaveform(
+            WaveformFactory::loadWaveformFromAnalysis(analysis));
+    if (!pWaveform->isValid()) {
+        return ConstWaveformPointer();
+    }
+    // Replace the stored analysis with the current format, which is mapped
+    // into memory on the next load instead of being parsed. The waveform
+    // that has been parsed now is used until then.
+    AnalysisDao::AnalysisInfo migrated =
+            WaveformFactory::migrateWaveformAnalysis(analysis, *pWaveform);
+    if (m_pAnalysisDao->saveAnalysis(
+                &migrated, AnalysisDao::DataFormat::Uncompressed)) {
+        kLogger.debug() << "Migrated analysis" << analysis.analysisId
+                        << "from" << analysis.version << "to" << migrated.version;
+    }
+    return pWaveform;
+}
+
 void AnalyzerWaveform::createFilters(int sampleRate) {
     // m_filter[Low] = new EngineFilterButterworth8(FILTER_LOWPASS, sampleRate, 200);
     // m_filter[Mid] = new EngineFilterButterworth8(FILTER_BANDPASS, sampleRate, 200, 2000);
@@ -310,10 +342,14 @@ void AnalyzerWaveform::finalize(TrackPointer tio) {
     // waveforms (i.e. if the config setting was disabled in a previous scan)
     // and then it is not called. The other analyzers have signals which control
     // the update of their data.
-    m_pAnalysisDao->saveTrackAnalyses(
-            tio->getId(),
-            tio->getWaveform(),
-            tio->getWaveformSummary());
+    if (m_pStorageWriter) {
+        m_pStorageWriter->saveTrackAnalyses(tio);
+    } else {
+        m_pAnalysisDao->saveTrackAnalyses(
+                tio->getId(),
+                tio->getWaveform(),
+                tio->getWaveformSummary());
+    }
 
     kLogger.debug() << "Waveform generation for track" << tio->getId() << "done"
              << m_timer.elapsed().debugSecondsWithUnit();
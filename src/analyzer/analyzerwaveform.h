@@ -6,6 +6,7 @@
 #include <limits>
 
 #include "analyzer/analyzer.h"
+#include "library/dao/analysisdao.h"
 #include "waveform/waveform.h"
 #include "util/math.h"
 #include "util/performancetimer.h"
@@ -14,7 +15,7 @@
 //#define TEST_HEAT_MAP
 
 class EngineFilterIIRBase;
-class AnalysisDao;
+class AnalyzerStorageWriter;
 
 inline CSAMPLE scaleSignal(CSAMPLE invalue, FilterIndex index = FilterCount) {
     if (invalue == 0.0) {
@@ -136,8 +137,11 @@ struct WaveformStride {
 
 class AnalyzerWaveform : public Analyzer {
   public:
+    // The analyses are saved through the storage writer if available
+    // or otherwise directly through the DAO.
     explicit AnalyzerWaveform(
-            AnalysisDao* pAnalysisDao);
+            AnalysisDao* pAnalysisDao,
+            AnalyzerStorageWriter* pStorageWriter = nullptr);
     ~AnalyzerWaveform() override;
 
     bool initialize(TrackPointer tio, int sampleRate, int totalSamples) override;
@@ -147,6 +151,11 @@ class AnalyzerWaveform : public Analyzer {
     void finalize(TrackPointer tio) override;
 
   private:
+    // Loads a waveform that is stored in an older format and saves it
+    // again in the current format. Returns null if it can not be loaded.
+    ConstWaveformPointer loadAndMigrate(
+            AnalysisDao::AnalysisInfo analysis) const;
+
     void storeCurrentStridePower();
     void resetCurrentStride();
 
@@ -155,6 +164,7 @@ class AnalyzerWaveform : public Analyzer {
     void storeIfGreater(float* pDest, float source);
 
     AnalysisDao* m_pAnalysisDao;
+    AnalyzerStorageWriter* m_pStorageWriter;
 
     bool m_skipProcessing;
 
@@ -0,0 +1,398 @@
+#include "analyzer/analyzerworker.h"
+
+#ifdef __VAMP__
+#include "analyzer/analyzerbeats.h"
+#include "analyzer/analyzerkey.h"
+#endif
+#include "analyzer/analyzergain.h"
+#include "analyzer/analyzerebur128.h"
+#include "analyzer/analyzerwaveform.h"
+#include "library/dao/analysisdao.h"
+#include "engine/engine.h"
+#include "sources/soundsourceproxy.h"
+#include "sources/audiosourcestereoproxy.h"
+#include "track/track.h"
+#include "util/compatibility.h"
+#include "util/db/dbconnectionpooler.h"
+#include "util/db/dbconnectionpooled.h"
+#include "util/event.h"
+#include "util/sample.h"
+#include "util/timer.h"
+#include "util/trace.h"
+#include "util/logger.h"
+
+// Measured in 0.1%,
+// 0 for no progress during finalize
+// 1 to display the text "finalizing"
+// 100 for 10% step after finalize
+#define FINALIZE_PROMILLE 1
+
+namespace {
+
+mixxx::Logger kLogger("AnalyzerWorker");
+
+// Analysis is done in blocks.
+// We need to use a smaller block size, because on Linux the AnalyzerWorker
+// can starve the CPU of its resources, resulting in xruns. A block size
+// of 4096 frames per block seems to do fine.
+const mixxx::AudioSignal::ChannelCount kAnalysisChannels(mixxx::kEngineChannelCount);
+const SINT kAnalysisFramesPerBlock = 4096;
+const SINT kAnalysisSamplesPerBlock =
+        kAnalysisFramesPerBlock * kAnalysisChannels;
+// The number of blocks the decoder may run ahead of the slowest analyzer
+const int kAnalysisBlockCount = 16;
+
+QAtomicInt s_instanceCounter(0);
+
+} // anonymous namespace
+
+AnalyzerWorker::AnalyzerWorker(
+        AnalyzerQueue* pQueue,
+        mixxx::DbConnectionPoolPtr pDbConnectionPool,
+        const UserSettingsPointer& pConfig,
+        AnalyzerQueue::Mode mode,
+        AnalyzerStorageWriter* pStorageWriter)
+        : m_pQueue(pQueue),
+          m_pDbConnectionPool(std::move(pDbConnectionPool)),
+          m_blockBus(kAnalysisSamplesPerBlock, kAnalysisBlockCount) {
+    if (mode != AnalyzerQueue::Mode::WithoutWaveform) {
+        m_pAnalysisDao = std::make_unique<AnalysisDao>(pConfig);
+    }
+    for (auto& analyzer: createAnalyzers(
+            pConfig, mode, m_pAnalysisDao.get(), pStorageWriter)) {
+        addAnalyzer(std::move(analyzer.pAnalyzer), analyzer.name);
+    }
+
+    connect(this, SIGNAL(updateProgress()),
+            this, SLOT(slotUpdateProgress()));
+}
+
+AnalyzerWorker::AnalyzerWorker(AnalyzerQueue* pQueue)
+        : m_pQueue(pQueue),
+          m_blockBus(kAnalysisSamplesPerBlock, kAnalysisBlockCount) {
+    connect(this, SIGNAL(updateProgress()),
+            this, SLOT(slotUpdateProgress()));
+}
+
+// static
+std::vector<AnalyzerWorker::AnalyzerInfo> AnalyzerWorker::createAnalyzers(
+        const UserSettingsPointer& pConfig,
+        AnalyzerQueue::Mode mode,
+        AnalysisDao* pAnalysisDao,
+        AnalyzerStorageWriter* pStorageWriter) {
+    std::vector<AnalyzerInfo> analyzers;
+    auto add = [&analyzers](Analyzer* pAnalyzer, const QString& name) {
+        AnalyzerInfo analyzer;
+        analyzer.pAnalyzer.reset(pAnalyzer);
+        analyzer.name = name;
+        analyzers.push_back(std::move(analyzer));
+    };
+    if (mode != AnalyzerQueue::Mode::WithoutWaveform) {
+        DEBUG_ASSERT(pAnalysisDao);
+        add(new AnalyzerWaveform(pAnalysisDao, pStorageWriter), "Waveform");
+    }
+    add(new AnalyzerGain(pConfig), "Gain");
+    add(new AnalyzerEbur128(pConfig), "Ebur128");
+#ifdef __VAMP__
+    add(new AnalyzerBeats(pConfig), "Beats");
+    add(new AnalyzerKey(pConfig), "Key");
+#endif
+    return analyzers;
+}
+
+AnalyzerWorker::~AnalyzerWorker() {
+    releaseProgress();
+    wait(); //Wait until thread has actually stopped before proceeding.
+}
+
+void AnalyzerWorker::addAnalyzer(
+        std::unique_ptr<Analyzer> pAnalyzer,
+        const QString& name) {
+    m_blockBus.addConsumer(pAnalyzer.get(), name);
+    AnalyzerInfo analyzer;
+    analyzer.pAnalyzer = std::move(pAnalyzer);
+    analyzer.name = name;
+    m_analyzers.push_back(std::move(analyzer));
+}
+
+void AnalyzerWorker::releaseProgress() {
+    m_progressInfo.sema.release();
+}
+
+// This is called from the AnalyzerWorker thread
+bool AnalyzerWorker::doAnalysis(
+        TrackPointer pTrack,
+        mixxx::AudioSourcePointer pAudioSource) {
+
+    QTime progressUpdateInhibitTimer;
+    progressUpdateInhibitTimer.start(); // Inhibit Updates for 60 milliseconds
+
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            pAudioSource,
+            kAnalysisFramesPerBlock);
+    DEBUG_ASSERT(audioSourceProxy.channelCount() == kAnalysisChannels);
+
+    mixxx::IndexRange remainingFrames = pAudioSource->frameIndexRange();
+    bool dieflag = false;
+    bool cancelled = false;
+    while (!dieflag && !remainingFrames.empty()) {
+        ScopedTimer t("AnalyzerWorker::doAnalysis block");
+
+        const auto inputFrameIndexRange =
+                remainingFrames.splitAndShrinkFront(
+                        math_min(kAnalysisFramesPerBlock, remainingFrames.length()));
+        DEBUG_ASSERT(!inputFrameIndexRange.empty());
+        // Blocks while the slowest analyzer is too far behind
+        AnalyzerBlockPointer pBlock = m_blockBus.acquireBlock();
+        const auto readableSampleFrames =
+                audioSourceProxy.readSampleFrames(
+                        mixxx::WritableSampleFrames(
+                                inputFrameIndexRange,
+                                pBlock->writableSlice()));
+        // To compare apples to apples, let's only look at blocks that are
+        // the full block size.
+        if (readableSampleFrames.frameLength() == kAnalysisFramesPerBlock) {
+            // Complete analysis block of audio samples has been read.
+            if (readableSampleFrames.readableData() != pBlock->data()) {
+                SampleUtil::copy(
+                        pBlock->writableSlice().data(),
+                        readableSampleFrames.readableData(),
+                        readableSampleFrames.readableLength());
+            }
+            pBlock->setSampleCount(readableSampleFrames.readableLength());
+            // The analyzers process the block concurrently
+            m_blockBus.publishBlock(std::move(pBlock));
+        } else {
+            // Partial analysis block of audio samples has been read.
+            // This should only happen at the end of an audio stream,
+            // otherwise a decoding error must have occurred.
+            if (!remainingFrames.empty()) {
+                // EOF not reached -> Maybe a corrupt file?
+                kLogger.warning()
+                        << "Aborting analysis after failed to read sample data from"
+                        << pTrack->getLocation()
+                        << ": expected frames =" << inputFrameIndexRange
+                        << ", actual frames =" << readableSampleFrames.frameIndexRange();
+                dieflag = true; // abort
+                cancelled = false; // completed, no retry
+            }
+        }
+
+        // emit progress updates
+        // During the doAnalysis function it goes only to 100% - FINALIZE_PERCENT
+        // because the finalize functions will take also some time
+        //fp div here prevents insane signed overflow
+        const double frameProgress =
+                double(pAudioSource->frameLength() - remainingFrames.length()) /
+                double(pAudioSource->frameLength());
+        int progressPromille = frameProgress * (1000 - FINALIZE_PROMILLE);
+
+        if (m_progressInfo.track_progress != progressPromille) {
+            if (progressUpdateInhibitTimer.elapsed() > 60) {
+                // Inhibit Updates for 60 milliseconds
+                emitUpdateProgress(pTrack, progressPromille);
+                progressUpdateInhibitTimer.start();
+            }
+        }
+
+        // has something new entered the queue?
+        if (m_pQueue->checkPriorities()) {
+            if (m_pQueue->isLoadedTrackWaiting(pTrack)) {
+                kLogger.debug() << "Interrupting analysis to give preference to a loaded track.";
+                dieflag = true;
+                cancelled = true;
+            }
+        }
+
+        if (m_pQueue->isExiting()) {
+            dieflag = true;
+            cancelled = true;
+        }
+
+        // Ignore blocks in which we decided to bail for stats purposes.
+        if (dieflag || cancelled) {
+            t.cancel();
+        }
+    }
+
+    if (cancelled) {
+        m_blockBus.discardPendingBlocks();
+    } else {
+        m_blockBus.waitForConsumers();
+    }
+
+    return !cancelled; //don't return !dieflag or we might reanalyze over and over
+}
+
+void AnalyzerWorker::run() {
+    // If there are no analyzers, don't waste time running.
+    if (m_analyzers.empty()) {
+        return;
+    }
+
+    const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
+    QThread::currentThread()->setObjectName(QString("AnalyzerWorker %1").arg(instanceId));
+
+    kLogger.debug() << "Entering thread";
+
+    execThread();
+
+    kLogger.debug() << "Exiting thread";
+}
+
+void AnalyzerWorker::execThread() {
+    // The thread-local database connection for waveform analysis must not
+    // be closed before returning from this function. Therefore the
+    // DbConnectionPooler is defined at this outer function scope,
+    // independent of whether a database connection will be opened
+    // or not.
+    mixxx::DbConnectionPooler dbConnectionPooler;
+    // m_pAnalysisDao remains null if no analyzer needs database access.
+    // Currently only waveform analyses makes use of it.
+    if (m_pAnalysisDao) {
+        dbConnectionPooler = mixxx::DbConnectionPooler(m_pDbConnectionPool); // move assignment
+        if (!dbConnectionPooler.isPooling()) {
+            kLogger.warning()
+                    << "Failed to obtain database connection for analyzer worker thread";
+            return;
+        }
+        // Obtain and use the newly created database connection within this thread
+        QSqlDatabase dbConnection = mixxx::DbConnectionPooled(m_pDbConnectionPool);
+        DEBUG_ASSERT(dbConnection.isOpen());
+        m_pAnalysisDao->initialize(dbConnection);
+    }
+
+    m_progressInfo.current_track.reset();
+    m_progressInfo.track_progress = 0;
+    m_progressInfo.queue_size = 0;
+    m_progressInfo.sema.release(); // Initialize with one
+
+    while (!m_pQueue->isExiting()) {
+        TrackPointer nextTrack = m_pQueue->dequeueNextBlocking();
+
+        // It's important to check for m_exit here in case we decided to exit
+        // while blocking for a new track.
+        if (m_pQueue->isExiting()) {
+            if (nextTrack) {
+                m_pQueue->finishTrack(nextTrack, false);
+            }
+            break;
+        }
+
+        // If the track is NULL, try to get the next one.
+        // Could happen if the track was queued but then deleted.
+        // Or if dequeueNextBlocking is unblocked by exit == true
+        if (!nextTrack) {
+            m_pQueue->emptyCheck();
+            continue;
+        }
+
+        const bool completed = analyzeTrack(nextTrack);
+
+        m_pQueue->finishTrack(nextTrack, !completed);
+        if (!completed) {
+            emitUpdateProgress(nextTrack, 0);
+        }
+        m_pQueue->emptyCheck();
+    }
+
+    if (m_pAnalysisDao) {
+        // Invalidate reference to the thread-local database connection
+        // that will be closed soon. Not necessary, just in case ;)
+        m_pAnalysisDao->initialize(QSqlDatabase());
+    }
+
+    emit(m_pQueue->queueEmpty()); // emit in case of exit;
+}
+
+bool AnalyzerWorker::analyzeTrack(TrackPointer nextTrack) {
+    kLogger.debug() << "Analyzing" << nextTrack->getTitle() << nextTrack->getLocation();
+
+    Trace trace("AnalyzerWorker analyzing track");
+
+    // Get the audio
+    mixxx::AudioSource::OpenParams openParams;
+    openParams.setChannelCount(kAnalysisChannels);
+    auto pAudioSource = SoundSourceProxy(nextTrack).openAudioSource(openParams);
+    if (!pAudioSource) {
+        kLogger.warning()
+                << "Failed to open file for analyzing:"
+                << nextTrack->getLocation();
+        return true;
+    }
+
+    bool processTrack = false;
+    for (auto const& analyzer: m_analyzers) {
+        // Make sure not to short-circuit initialize(...)
+        if (analyzer.pAnalyzer->initialize(
+                nextTrack,
+                pAudioSource->sampleRate(),
+                pAudioSource->frameLength() * kAnalysisChannels)) {
+            processTrack = true;
+        }
+    }
+
+    if (processTrack) {
+        emitUpdateProgress(nextTrack, 0);
+        bool completed = doAnalysis(nextTrack, pAudioSource);
+        if (!completed) {
+            // This track was cancelled
+            for (auto const& analyzer: m_analyzers) {
+                analyzer.pAnalyzer->cleanup(nextTrack);
+            }
+            return false;
+        } else {
+            // 100% - FINALIZE_PERCENT finished
+            emitUpdateProgress(nextTrack, 1000 - FINALIZE_PROMILLE);
+            // This takes around 3 sec on a Atom Netbook
+            for (auto const& analyzer: m_analyzers) {
+                ScopedTimer t("AnalyzerWorker finalize %1", analyzer.name);
+                analyzer.pAnalyzer->finalize(nextTrack);
+            }
+            emit(trackDone(nextTrack));
+            emitUpdateProgress(nextTrack, 1000); // 100%
+        }
+    } else {
+        emitUpdateProgress(nextTrack, 1000); // 100%
+        kLogger.debug() << "Skipping track analysis because no analyzer initialized.";
+    }
+    return true;
+}
+
+void AnalyzerWorker::emitUpdateProgress(TrackPointer track, int progress) {
+    if (!m_pQueue->isExiting()) {
+        // First tryAcqire will have always success because sema is initialized with on
+        // The following tries will success if the previous signal was processed in the GUI Thread
+        // This prevent the AnalysisQueue from filling up the GUI Thread event Queue
+        // 100 % is emitted in any case
+        if (progress < 1000 - FINALIZE_PROMILLE && progress > 0) {
+            // Signals during processing are not required in any case
+            if (!m_progressInfo.sema.tryAcquire()) {
+               return;
+            }
+        } else {
+            m_progressInfo.sema.acquire();
+        }
+        m_progressInfo.current_track = track;
+        m_progressInfo.track_progress = progress;
+        m_progressInfo.queue_size = m_pQueue->pendingTrackCountOfOtherWorkers();
+        emit(updateProgress());
+    }
+}
+
+//slot
+void AnalyzerWorker::slotUpdateProgress() {
+    const TrackPointer pTrack = m_progressInfo.current_track;
+    const int progress = m_progressInfo.track_progress;
+    const int queueSize = m_progressInfo.queue_size;
+    m_progressInfo.current_track.reset();
+    m_progressInfo.sema.release();
+
+    if (pTrack) {
+        pTrack->setAnalyzerProgress(progress);
+        emit(trackProgress(pTrack, progress / 10));
+        if (progress == 1000) {
+            emit(trackFinished(pTrack, queueSize));
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef ANALYZER_ANALYZERWORKER_H
+#define ANALYZER_ANALYZERWORKER_H
+
+#include <QThread>
+#include <QSemaphore>
+
+#include <vector>
+
+#include "analyzer/analyzerblockbus.h"
+#include "analyzer/analyzerqueue.h"
+#include "preferences/usersettings.h"
+#include "sources/audiosource.h"
+#include "track/track.h"
+#include "util/db/dbconnectionpool.h"
+#include "util/memory.h"
+
+class Analyzer;
+class AnalysisDao;
+class AnalyzerStorageWriter;
+
+// An AnalyzerWorker takes tracks from the AnalyzerQueue one after
+// another. Each track is decoded only once and every decoded block is
+// published on an AnalyzerBlockBus that runs all analyzers of the worker
+// concurrently. Every worker owns a separate set
+// of analyzers and a thread-local database connection for loading stored
+// analyses, which allows to run multiple workers in parallel.
+class AnalyzerWorker : public QThread {
+    Q_OBJECT
+
+  public:
+    // The thread is started by the AnalyzerQueue
+    AnalyzerWorker(
+            AnalyzerQueue* pQueue,
+            mixxx::DbConnectionPoolPtr pDbConnectionPool,
+            const UserSettingsPointer& pConfig,
+            AnalyzerQueue::Mode mode,
+            AnalyzerStorageWriter* pStorageWriter);
+    ~AnalyzerWorker() override;
+
+    struct AnalyzerInfo {
+        std::unique_ptr<Analyzer> pAnalyzer;
+        QString name;
+    };
+    // The analyzers of a worker in the given mode. pStorageWriter may be
+    // null if the analyses are not saved.
+    static std::vector<AnalyzerInfo> createAnalyzers(
+            const UserSettingsPointer& pConfig,
+            AnalyzerQueue::Mode mode,
+            AnalysisDao* pAnalysisDao,
+            AnalyzerStorageWriter* pStorageWriter);
+
+    // Unblocks a pending progress update before stopping the thread
+    void releaseProgress();
+
+  public slots:
+    void slotUpdateProgress();
+
+  signals:
+    // Progress in percent
+    void trackProgress(TrackPointer track, int progress);
+    void trackDone(TrackPointer track);
+    // size is the number of tracks that are still queued or analysed
+    void trackFinished(TrackPointer track, int size);
+    // Signals from AnalyzerWorker Thread:
+    void updateProgress();
+
+  protected:
+    // Without any analyzers, for tests. They are added with addAnalyzer()
+    // before the worker is added to the queue.
+    explicit AnalyzerWorker(AnalyzerQueue* pQueue);
+
+    void addAnalyzer(std::unique_ptr<Analyzer> pAnalyzer, const QString& name);
+
+    void run() override;
+
+  private:
+    struct progress_info {
+        TrackPointer current_track;
+        int track_progress; // in 0.1 %
+        int queue_size;
+        QSemaphore sema;
+    };
+
+    // Called from this worker thread
+    void emitUpdateProgress(TrackPointer tio, int progress);
+
+    void execThread();
+    // Returns false if the analysis has been interrupted
+    bool analyzeTrack(TrackPointer pTrack);
+    bool doAnalysis(TrackPointer tio, mixxx::AudioSourcePointer pAudioSource);
+
+    AnalyzerQueue* const m_pQueue;
+    const mixxx::DbConnectionPoolPtr m_pDbConnectionPool;
+
+    std::unique_ptr<AnalysisDao> m_pAnalysisDao;
+
+    std::vector<AnalyzerInfo> m_analyzers;
+
+    // Must be declared after the analyzers to stop the consumer threads
+    // before the analyzers are destroyed.
+    AnalyzerBlockBus m_blockBus;
+
+    struct progress_info m_progressInfo;
+};
+
+#endif /* ANALYZER_ANALYZERWORKER_H */
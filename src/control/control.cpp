@@ -8,13 +8,9 @@
 // Static member variable definition
 UserSettingsPointer ControlDoublePrivate::s_pUserConfig;
 
-QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> > ControlDoublePrivate::s_qCOHash
-GUARDED_BY(ControlDoublePrivate::s_qCOHashMutex);
+ControlRegistry ControlDoublePrivate::s_registry;
 
-QHash<ConfigKey, ConfigKey> ControlDoublePrivate::s_qCOAliasHash
-GUARDED_BY(ControlDoublePrivate::s_qCOHashMutex);
-
-MMutex ControlDoublePrivate::s_qCOHashMutex;
+ControlChangeBus ControlDoublePrivate::s_changeBus;
 
 /*
 ControlDoublePrivate::ControlDoublePrivate()
@@ -40,7 +36,8 @@ ControlDoublePrivate::ControlDoublePrivate(ConfigKey key,
           m_trackFlags(Stat::COUNT | Stat::SUM | Stat::AVERAGE |
                        Stat::SAMPLE_VARIANCE | Stat::MIN | Stat::MAX),
           m_confirmRequired(false),
-          m_pCreatorCO(pCreatorCO) {
+          m_pCreatorCO(pCreatorCO),
+          m_changeBusSlot(-1) {
     initialize(defaultValue);
 }
 
@@ -67,10 +64,12 @@ void ControlDoublePrivate::initialize(double defaultValue) {
 }
 
 ControlDoublePrivate::~ControlDoublePrivate() {
-    s_qCOHashMutex.lock();
-    //qDebug() << "ControlDoublePrivate::s_qCOHash.remove(" << m_key.group << "," << m_key.item << ")";
-    s_qCOHash.remove(m_key);
-    s_qCOHashMutex.unlock();
+    //qDebug() << "ControlDoublePrivate::s_registry.remove(" << m_key.group << "," << m_key.item << ")";
+    s_registry.remove(m_key);
+    const int changeBusSlot = m_changeBusSlot.load();
+    if (changeBusSlot >= 0) {
+        s_changeBus.unsubscribe(changeBusSlot);
+    }
 
     if (m_bPersistInConfiguration) {
         UserSettingsPointer pConfig = ControlDoublePrivate::s_pUserConfig;
@@ -82,23 +81,9 @@ ControlDoublePrivate::~ControlDoublePrivate() {
 
 // static
 void ControlDoublePrivate::insertAlias(const ConfigKey& alias, const ConfigKey& key) {
-    MMutexLocker locker(&s_qCOHashMutex);
-
-    QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> >::const_iterator it =
-            s_qCOHash.find(key);
-    if (it == s_qCOHash.end()) {
+    if (!s_registry.insertAlias(alias, key)) {
         qWarning() << "WARNING: ControlDoublePrivate::insertAlias called for null control" << key;
-        return;
     }
-
-    QSharedPointer<ControlDoublePrivate> pControl = it.value();
-    if (pControl.isNull()) {
-        qWarning() << "WARNING: ControlDoublePrivate::insertAlias called for expired control" << key;
-        return;
-    }
-
-    s_qCOAliasHash.insert(key, alias);
-    s_qCOHash.insert(alias, pControl);
 }
 
 // static
@@ -113,33 +98,20 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
         return QSharedPointer<ControlDoublePrivate>();
     }
 
-
     QSharedPointer<ControlDoublePrivate> pControl;
-    // Scope for MMutexLocker.
-    {
-        MMutexLocker locker(&s_qCOHashMutex);
-        QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> >::const_iterator it = s_qCOHash.find(key);
-
-        if (it != s_qCOHash.end()) {
-            if (pCreatorCO) {
-                if (warn) {
-                    qDebug() << "ControlObject" << key.group << key.item << "already created";
-                }
-            } else {
-                pControl = it.value();
-            }
+    if (pCreatorCO) {
+        if (warn && s_registry.contains(key)) {
+            qDebug() << "ControlObject" << key.group << key.item << "already created";
         }
-    }
-
-    if (pControl == NULL) {
-        if (pCreatorCO) {
-            pControl = QSharedPointer<ControlDoublePrivate>(
-                    new ControlDoublePrivate(key, pCreatorCO, bIgnoreNops,
-                                             bTrack, bPersist, defaultValue));
-            MMutexLocker locker(&s_qCOHashMutex);
-            //qDebug() << "ControlDoublePrivate::s_qCOHash.insert(" << key.group << "," << key.item << ")";
-            s_qCOHash.insert(key, pControl);
-        } else if (warn) {
+        pControl = QSharedPointer<ControlDoublePrivate>(
+                new ControlDoublePrivate(key, pCreatorCO, bIgnoreNops,
+                                         bTrack, bPersist, defaultValue));
+        //qDebug() << "ControlDoublePrivate::s_registry.insert(" << key.group << "," << key.item << ")";
+        s_registry.insert(key, pControl);
+    } else {
+        // Lock-free unless the control has just been created
+        pControl = s_registry.lookup(key);
+        if (pControl.isNull() && warn) {
             qWarning() << "ControlDoublePrivate::getControl returning NULL for ("
                        << key.group << "," << key.item << ")";
         }
@@ -150,22 +122,12 @@ QSharedPointer<ControlDoublePrivate> ControlDoublePrivate::getControl(
 // static
 void ControlDoublePrivate::getControls(
         QList<QSharedPointer<ControlDoublePrivate> >* pControlList) {
-    s_qCOHashMutex.lock();
-    pControlList->clear();
-    for (QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> >::const_iterator it = s_qCOHash.begin();
-             it != s_qCOHash.end(); ++it) {
-        QSharedPointer<ControlDoublePrivate> pControl = it.value();
-        if (!pControl.isNull()) {
-            pControlList->push_back(pControl);
-        }
-    }
-    s_qCOHashMutex.unlock();
+    *pControlList = s_registry.controls();
 }
 
 // static
 QHash<ConfigKey, ConfigKey> ControlDoublePrivate::getControlAliases() {
-    MMutexLocker locker(&s_qCOHashMutex);
-    return s_qCOAliasHash;
+    return s_registry.aliases();
 }
 
 void ControlDoublePrivate::reset() {
@@ -199,6 +161,10 @@ void ControlDoublePrivate::setInner(double value, QObject* pSender) {
     }
     m_value.setValue(value);
     emit(valueChanged(value, pSender));
+    const int changeBusSlot = m_changeBusSlot.load(std::memory_order_relaxed);
+    if (changeBusSlot >= 0) {
+        s_changeBus.markChanged(changeBusSlot);
+    }
 
     if (m_bTrack) {
         Stat::track(m_trackKey, static_cast<Stat::StatType>(m_trackType),
@@ -6,7 +6,11 @@
 #include <QObject>
 #include <QAtomicPointer>
 
+#include <atomic>
+
 #include "control/controlbehavior.h"
+#include "control/controlchangebus.h"
+#include "control/controlregistry.h"
 #include "control/controlvalue.h"
 #include "preferences/usersettings.h"
 #include "util/mutex.h"
@@ -43,6 +47,12 @@ class ControlDoublePrivate : public QObject {
 
     static QHash<ConfigKey, ConfigKey> getControlAliases();
 
+    // The bus that delivers the changes of subscribed controls once per
+    // GUI frame.
+    static ControlChangeBus* changeBus() {
+        return &s_changeBus;
+    }
+
     const QString& name() const {
         return m_name;
     }
@@ -118,11 +128,19 @@ class ControlDoublePrivate : public QObject {
     bool connectValueChangeRequest(const QObject* receiver,
                                    const char* method, Qt::ConnectionType type);
 
+    // Called from ControlChangeBus::deliverChanges()
+    void emitCoalescedValueChanged() {
+        emit(coalescedValueChanged(get()));
+    }
+
   signals:
     // Emitted when the ControlDoublePrivate value changes. pSender is a
     // pointer to the setter of the value (potentially NULL).
     void valueChanged(double value, QObject* pSender);
     void valueChangeRequest(double value);
+    // Emitted in the GUI thread at most once per frame if the control is
+    // subscribed to the change bus and its value has changed.
+    void coalescedValueChanged(double value);
 
   private:
     ControlDoublePrivate(ConfigKey key, ControlObject* pCreatorCO,
@@ -163,6 +181,10 @@ class ControlDoublePrivate : public QObject {
 
     ControlObject* m_pCreatorCO;
 
+    // The slot in s_changeBus or -1 if the control is not subscribed.
+    std::atomic<int> m_changeBusSlot;
+    friend class ControlChangeBus;
+
     // Hack to implement persistent controls. This is a pointer to the current
     // user configuration object (if one exists). In general, we do not want the
     // user configuration to be a singleton -- objects that need access to it
@@ -171,14 +193,10 @@ class ControlDoublePrivate : public QObject {
     // configuration object would be arduous.
     static UserSettingsPointer s_pUserConfig;
 
-    // Hash of ControlDoublePrivate instantiations.
-    static QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> > s_qCOHash;
-    // Hash of aliases between ConfigKeys. Solely used for looking up the first
-    // alias associated with a key.
-    static QHash<ConfigKey, ConfigKey> s_qCOAliasHash;
+    // Index of ControlDoublePrivate instantiations and their aliases.
+    static ControlRegistry s_registry;
 
-    // Mutex guarding access to s_qCOHash and s_qCOAliasHash.
-    static MMutex s_qCOHashMutex;
+    static ControlChangeBus s_changeBus;
 };
 
 
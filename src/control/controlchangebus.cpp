@@ -0,0 +1,71 @@
+#include "control/controlchangebus.h"
+
+#include "control/control.h"
+
+ControlChangeBus::ControlChangeBus()
+        : m_enabled(false),
+          m_controls(kMaxControls) {
+    for (int i = 0; i < kNumWords; ++i) {
+        m_changed[i].store(0);
+    }
+    // Hand out the lowest slots first, so the changed bits are dense.
+    m_freeSlots.reserve(kMaxControls);
+    for (int slot = kMaxControls - 1; slot >= 0; --slot) {
+        m_freeSlots.append(slot);
+    }
+    m_deliveries.reserve(kMaxControls);
+}
+
+bool ControlChangeBus::subscribe(
+        const QSharedPointer<ControlDoublePrivate>& pControl) {
+    MMutexLocker locker(&m_mutex);
+    if (pControl->m_changeBusSlot.load() >= 0) {
+        return true;
+    }
+    if (m_freeSlots.isEmpty()) {
+        return false;
+    }
+    const int slot = m_freeSlots.last();
+    m_freeSlots.removeLast();
+    m_controls[slot] = pControl;
+    pControl->m_changeBusSlot.store(slot);
+    return true;
+}
+
+void ControlChangeBus::unsubscribe(int slot) {
+    MMutexLocker locker(&m_mutex);
+    // A pending change bit is harmless: the slot is either empty or a
+    // subscriber receives its current value once more.
+    m_controls[slot].clear();
+    m_freeSlots.append(slot);
+}
+
+int ControlChangeBus::deliverChanges() {
+    {
+        MMutexLocker locker(&m_mutex);
+        for (int word = 0; word < kNumWords; ++word) {
+            if (m_changed[word].load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            quint64 bits = m_changed[word].exchange(0, std::memory_order_acquire);
+            for (int slot = word * kBitsPerWord; bits != 0; ++slot, bits >>= 1) {
+                if (bits & 1) {
+                    QSharedPointer<ControlDoublePrivate> pControl =
+                            m_controls[slot].toStrongRef();
+                    if (pControl) {
+                        m_deliveries.push_back(pControl);
+                    }
+                }
+            }
+        }
+    }
+
+    // Emit without holding the lock, the receivers may create or delete
+    // controls.
+    for (const auto& pControl : m_deliveries) {
+        pControl->emitCoalescedValueChanged();
+    }
+    const int delivered = static_cast<int>(m_deliveries.size());
+    m_deliveries.clear();
+    return delivered;
+}
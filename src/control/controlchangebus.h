@@ -0,0 +1,74 @@
+#ifndef CONTROL_CONTROLCHANGEBUS_H
+#define CONTROL_CONTROLCHANGEBUS_H
+
+#include <QSharedPointer>
+#include <QVector>
+#include <QWeakPointer>
+
+#include <atomic>
+#include <vector>
+
+#include "util/mutex.h"
+
+class ControlDoublePrivate;
+
+// Delivers value changes of subscribed controls to the GUI thread at most
+// once per frame.
+//
+// Delivering every change through a queued signal posts one event per
+// change to the GUI thread. Controls like the play position, the VU meters
+// or a jog wheel change at the rate of the audio callback or faster, which
+// floods the GUI event queue. Instead, setting a subscribed control only
+// marks it as changed in a bitmap, which is lock-free and allocation-free.
+// The GUI thread calls deliverChanges() once per frame and emits
+// ControlDoublePrivate::coalescedValueChanged() with the latest value of
+// each changed control.
+class ControlChangeBus {
+  public:
+    // The maximum number of subscribed controls.
+    static const int kMaxControls = 8192;
+
+    ControlChangeBus();
+
+    // Deliveries only happen while enabled, i.e. while there is a GUI
+    // thread that calls deliverChanges() on every frame.
+    void setEnabled(bool enabled) {
+        m_enabled.store(enabled);
+    }
+    bool isEnabled() const {
+        return m_enabled.load();
+    }
+
+    // Subscribes the control to the bus. Returns true if the control is
+    // subscribed, false if the bus is full.
+    bool subscribe(const QSharedPointer<ControlDoublePrivate>& pControl);
+    void unsubscribe(int slot);
+
+    // Marks the control in slot as changed. Real-time safe.
+    void markChanged(int slot) {
+        m_changed[slot / kBitsPerWord].fetch_or(
+                quint64(1) << (slot % kBitsPerWord),
+                std::memory_order_release);
+    }
+
+    // Emits the latest value of all controls that have changed since the
+    // last call. Must only be called from the GUI thread. Returns the
+    // number of delivered changes.
+    int deliverChanges();
+
+  private:
+    static const int kBitsPerWord = 64;
+    static const int kNumWords = kMaxControls / kBitsPerWord;
+
+    std::atomic<quint64> m_changed[kNumWords];
+    std::atomic<bool> m_enabled;
+
+    MMutex m_mutex;
+    QVector<QWeakPointer<ControlDoublePrivate> > m_controls GUARDED_BY(m_mutex);
+    QVector<int> m_freeSlots GUARDED_BY(m_mutex);
+
+    // Reused by deliverChanges() to avoid allocations after startup.
+    std::vector<QSharedPointer<ControlDoublePrivate> > m_deliveries;
+};
+
+#endif /* CONTROL_CONTROLCHANGEBUS_H */
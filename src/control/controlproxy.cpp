@@ -104,3 +104,33 @@ bool ControlProxy::connectValueChanged(
     DEBUG_ASSERT(parent() != NULL);
     return connectValueChanged(parent(), method, type);
 }
+
+bool ControlProxy::connectValueChangedCoalesced(const QObject* receiver,
+        const char* method) {
+    if (!m_pControl) {
+        return false;
+    }
+
+    ControlChangeBus* pChangeBus = ControlDoublePrivate::changeBus();
+    if (!pChangeBus->isEnabled() || !pChangeBus->subscribe(m_pControl)) {
+        return connectValueChanged(receiver, method, Qt::AutoConnection);
+    }
+
+    if (!connect((QObject*)this, SIGNAL(valueChanged(double)),
+                      receiver, method, Qt::AutoConnection)) {
+        return false;
+    }
+
+    // The bus emits in the GUI thread, so this is a direct connection
+    connect(m_pControl.data(), SIGNAL(coalescedValueChanged(double)),
+            this, SLOT(slotValueChangedCoalesced(double)),
+            static_cast<Qt::ConnectionType>(
+                    Qt::AutoConnection | Qt::UniqueConnection));
+    return true;
+}
+
+// connect to parent object
+bool ControlProxy::connectValueChangedCoalesced(const char* method) {
+    DEBUG_ASSERT(parent() != NULL);
+    return connectValueChangedCoalesced(parent(), method);
+}
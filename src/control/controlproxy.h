@@ -35,6 +35,16 @@ class ControlProxy : public QObject {
     bool connectValueChanged(
             const char* method, Qt::ConnectionType type = Qt::AutoConnection);
 
+    // Like connectValueChanged(), but the receiver gets at most one change
+    // per GUI frame with the latest value, delivered by the ControlChangeBus.
+    // Use it for widgets that display fast changing controls. The receiver
+    // must live in the GUI thread. Unlike connectValueChanged(), changes set
+    // by this proxy are delivered as well. Falls back to a
+    // Qt::AutoConnection if the bus is not enabled or full.
+    bool connectValueChangedCoalesced(const QObject* receiver,
+            const char* method);
+    bool connectValueChangedCoalesced(const char* method);
+
     // Called from update();
     virtual void emitValueChanged() {
         emit(valueChanged(get()));
@@ -118,6 +128,11 @@ class ControlProxy : public QObject {
         }
     }
 
+    // Receives the value from the ControlChangeBus once per frame
+    void slotValueChangedCoalesced(double v) {
+        emit(valueChanged(v));
+    }
+
     // Receives the value from the master control by a unique Queued connection
     void slotValueChangedQueued(double v, QObject* pSetter) {
         if (pSetter != this) {
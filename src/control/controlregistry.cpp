@@ -0,0 +1,226 @@
+#include "control/controlregistry.h"
+
+#include <QtDebug>
+
+#include "control/control.h"
+#include "util/math.h"
+
+namespace {
+
+// Publishing a snapshot copies the whole hash, so we wait for at least
+// this many changes or misses, or an eighth of the number of controls,
+// whichever is more.
+const int kMinChangesPerSnapshot = 32;
+const int kSnapshotSizeDivisor = 8;
+
+} // anonymous namespace
+
+// Owns the hazard pointer slot of a thread and gives it back when the
+// thread exits.
+class ControlRegistry::ReaderSlot {
+  public:
+    ReaderSlot(ControlRegistry* pRegistry, int index)
+            : m_pRegistry(pRegistry),
+              m_index(index) {
+    }
+
+    ~ReaderSlot() {
+        if (m_index >= 0) {
+            m_pRegistry->releaseReaderSlot(m_index);
+        }
+    }
+
+    int index() const {
+        return m_index;
+    }
+
+  private:
+    ControlRegistry* const m_pRegistry;
+    const int m_index;
+};
+
+ControlRegistry::ControlRegistry()
+        : m_pendingChanges(0),
+          m_snapshotMisses(0),
+          m_pSnapshot(new ControlHash()) {
+    for (int i = 0; i < kMaxReaders; ++i) {
+        m_hazards[i].store(nullptr);
+        m_readerSlotUsed[i].store(false);
+    }
+}
+
+ControlRegistry::~ControlRegistry() {
+    MMutexLocker locker(&m_mutex);
+    delete m_pSnapshot.load();
+    for (const ControlHash* pSnapshot : m_retiredSnapshots) {
+        delete pSnapshot;
+    }
+}
+
+int ControlRegistry::readerSlotIndex() {
+    if (m_readerSlots.hasLocalData()) {
+        return m_readerSlots.localData()->index();
+    }
+    int index = -1;
+    for (int i = 0; i < kMaxReaders; ++i) {
+        bool used = false;
+        if (m_readerSlotUsed[i].compare_exchange_strong(used, true)) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        qWarning() << "ControlRegistry: More than" << kMaxReaders
+                   << "threads look up controls, falling back to locking";
+    }
+    m_readerSlots.setLocalData(new ReaderSlot(this, index));
+    return index;
+}
+
+void ControlRegistry::releaseReaderSlot(int index) {
+    m_hazards[index].store(nullptr);
+    m_readerSlotUsed[index].store(false);
+}
+
+QSharedPointer<ControlDoublePrivate> ControlRegistry::lookup(
+        const ConfigKey& key) {
+    const int slot = readerSlotIndex();
+    if (slot >= 0) {
+        std::atomic<const ControlHash*>& hazard = m_hazards[slot];
+        // Announce the snapshot before using it. If it has been replaced in
+        // the meantime, the writer may have missed our announcement and we
+        // have to try again with the new one.
+        const ControlHash* pSnapshot = m_pSnapshot.load();
+        for (;;) {
+            hazard.store(pSnapshot);
+            const ControlHash* pCurrent = m_pSnapshot.load();
+            if (pCurrent == pSnapshot) {
+                break;
+            }
+            pSnapshot = pCurrent;
+        }
+        QSharedPointer<ControlDoublePrivate> pControl =
+                pSnapshot->value(key).toStrongRef();
+        hazard.store(nullptr);
+        if (!pControl.isNull()) {
+            return pControl;
+        }
+    }
+    return lookupSlow(key);
+}
+
+QSharedPointer<ControlDoublePrivate> ControlRegistry::lookupSlow(
+        const ConfigKey& key) {
+    MMutexLocker locker(&m_mutex);
+    QSharedPointer<ControlDoublePrivate> pControl =
+            m_controls.value(key).toStrongRef();
+    if (!pControl.isNull()) {
+        // The snapshot is outdated. Lookups of controls that don't exist
+        // are not counted, since a new snapshot wouldn't help them.
+        ++m_snapshotMisses;
+        maybePublishSnapshotLocked();
+    }
+    return pControl;
+}
+
+bool ControlRegistry::contains(const ConfigKey& key) {
+    MMutexLocker locker(&m_mutex);
+    return m_controls.contains(key);
+}
+
+void ControlRegistry::insert(const ConfigKey& key,
+        const QSharedPointer<ControlDoublePrivate>& pControl) {
+    MMutexLocker locker(&m_mutex);
+    const bool replaced = m_controls.contains(key);
+    m_controls.insert(key, pControl);
+    ++m_pendingChanges;
+    if (replaced) {
+        // The snapshot may still return the replaced control.
+        publishSnapshotLocked();
+    } else {
+        maybePublishSnapshotLocked();
+    }
+}
+
+void ControlRegistry::remove(const ConfigKey& key) {
+    MMutexLocker locker(&m_mutex);
+    if (m_controls.remove(key) > 0) {
+        ++m_pendingChanges;
+        maybePublishSnapshotLocked();
+    }
+}
+
+bool ControlRegistry::insertAlias(const ConfigKey& alias,
+        const ConfigKey& key) {
+    MMutexLocker locker(&m_mutex);
+    QSharedPointer<ControlDoublePrivate> pControl =
+            m_controls.value(key).toStrongRef();
+    if (pControl.isNull()) {
+        return false;
+    }
+    const bool replaced = m_controls.contains(alias);
+    m_aliases.insert(key, alias);
+    m_controls.insert(alias, pControl);
+    ++m_pendingChanges;
+    if (replaced) {
+        publishSnapshotLocked();
+    } else {
+        maybePublishSnapshotLocked();
+    }
+    return true;
+}
+
+QList<QSharedPointer<ControlDoublePrivate> > ControlRegistry::controls() {
+    MMutexLocker locker(&m_mutex);
+    QList<QSharedPointer<ControlDoublePrivate> > controls;
+    for (ControlHash::const_iterator it = m_controls.constBegin();
+             it != m_controls.constEnd(); ++it) {
+        QSharedPointer<ControlDoublePrivate> pControl = it.value();
+        if (!pControl.isNull()) {
+            controls.push_back(pControl);
+        }
+    }
+    return controls;
+}
+
+QHash<ConfigKey, ConfigKey> ControlRegistry::aliases() {
+    MMutexLocker locker(&m_mutex);
+    return m_aliases;
+}
+
+void ControlRegistry::maybePublishSnapshotLocked() {
+    const int threshold = math_max(kMinChangesPerSnapshot,
+            m_controls.size() / kSnapshotSizeDivisor);
+    if (m_pendingChanges + m_snapshotMisses >= threshold) {
+        publishSnapshotLocked();
+    }
+}
+
+void ControlRegistry::publishSnapshotLocked() {
+    // The copy shares its data with m_controls until the next change.
+    const ControlHash* pOldSnapshot =
+            m_pSnapshot.exchange(new ControlHash(m_controls));
+    m_retiredSnapshots.append(pOldSnapshot);
+    m_pendingChanges = 0;
+    m_snapshotMisses = 0;
+    reclaimSnapshotsLocked();
+}
+
+void ControlRegistry::reclaimSnapshotsLocked() {
+    QList<const ControlHash*>::iterator it = m_retiredSnapshots.begin();
+    while (it != m_retiredSnapshots.end()) {
+        bool inUse = false;
+        for (int i = 0; i < kMaxReaders; ++i) {
+            if (m_hazards[i].load() == *it) {
+                inUse = true;
+                break;
+            }
+        }
+        if (inUse) {
+            ++it;
+        } else {
+            delete *it;
+            it = m_retiredSnapshots.erase(it);
+        }
+    }
+}
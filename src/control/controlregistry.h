@@ -0,0 +1,91 @@
+#ifndef CONTROL_CONTROLREGISTRY_H
+#define CONTROL_CONTROLREGISTRY_H
+
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QThreadStorage>
+#include <QWeakPointer>
+
+#include <atomic>
+
+#include "preferences/configobject.h"
+#include "util/mutex.h"
+
+class ControlDoublePrivate;
+
+// The index of all ControlDoublePrivate instances by ConfigKey.
+//
+// Lookups vastly outnumber the creation and deletion of controls, e.g. a
+// skin looks up tens of thousands of controls while it is loaded. The
+// registry therefore keeps the authoritative hash behind a mutex, but
+// serves lookups from an immutable snapshot of it without taking any lock.
+//
+// The snapshot is replaced (read-copy-update) after enough changes to the
+// authoritative hash have accumulated or enough lookups had to fall back
+// to it because the snapshot was outdated. The cost of copying is thus
+// amortized over the changes and lookups. After startup the snapshot
+// contains all controls and lookups no longer touch the mutex.
+//
+// Readers announce the snapshot they are using in a hazard pointer. A
+// replaced snapshot is only deleted once no reader announces it anymore.
+// Threads that can't get a hazard pointer slot fall back to the mutex.
+class ControlRegistry {
+  public:
+    typedef QHash<ConfigKey, QWeakPointer<ControlDoublePrivate> > ControlHash;
+
+    ControlRegistry();
+    ~ControlRegistry();
+
+    // Returns the control for key or a null pointer if there is none.
+    QSharedPointer<ControlDoublePrivate> lookup(const ConfigKey& key);
+
+    // Returns true if there is an entry for key, even if the control has
+    // been deleted already.
+    bool contains(const ConfigKey& key);
+
+    void insert(const ConfigKey& key,
+            const QSharedPointer<ControlDoublePrivate>& pControl);
+    void remove(const ConfigKey& key);
+
+    // Makes the control for key also available as alias. Returns false if
+    // there is no control for key.
+    bool insertAlias(const ConfigKey& alias, const ConfigKey& key);
+
+    QList<QSharedPointer<ControlDoublePrivate> > controls();
+    QHash<ConfigKey, ConfigKey> aliases();
+
+  private:
+    class ReaderSlot;
+
+    // The maximum number of threads that can read concurrently without
+    // locking.
+    static const int kMaxReaders = 64;
+
+    // Returns the hazard pointer slot of the calling thread or -1 if all
+    // slots are taken.
+    int readerSlotIndex();
+    void releaseReaderSlot(int index);
+
+    QSharedPointer<ControlDoublePrivate> lookupSlow(const ConfigKey& key);
+    void publishSnapshotLocked() REQUIRES(m_mutex);
+    void maybePublishSnapshotLocked() REQUIRES(m_mutex);
+    void reclaimSnapshotsLocked() REQUIRES(m_mutex);
+
+    MMutex m_mutex;
+    ControlHash m_controls GUARDED_BY(m_mutex);
+    // Solely used for looking up the first alias associated with a key.
+    QHash<ConfigKey, ConfigKey> m_aliases GUARDED_BY(m_mutex);
+    // The number of changes to m_controls and lookups that missed the
+    // snapshot since the last snapshot was published.
+    int m_pendingChanges GUARDED_BY(m_mutex);
+    int m_snapshotMisses GUARDED_BY(m_mutex);
+    QList<const ControlHash*> m_retiredSnapshots GUARDED_BY(m_mutex);
+
+    std::atomic<const ControlHash*> m_pSnapshot;
+    std::atomic<const ControlHash*> m_hazards[kMaxReaders];
+    std::atomic<bool> m_readerSlotUsed[kMaxReaders];
+    QThreadStorage<ReaderSlot*> m_readerSlots;
+};
+
+#endif /* CONTROL_CONTROLREGISTRY_H */
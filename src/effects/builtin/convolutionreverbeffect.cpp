@@ -0,0 +1,380 @@
+#include "effects/builtin/convolutionreverbeffect.h"
+
+#include <algorithm>
+
+#include <QtDebug>
+
+#include "util/math.h"
+#include "util/sample.h"
+
+namespace {
+
+constexpr quint32 kLeftSeed = 0x2545F491;
+constexpr quint32 kRightSeed = 0x9E3779B9;
+
+// Feeds both convolvers with the same input and fades from the output of
+// pFrom to the output of pTo over the buffer. The convolvers only take
+// whole partitions from the stack at a time.
+bool processCrossfade(PartitionedConvolver* pFrom, PartitionedConvolver* pTo,
+        const CSAMPLE* pInput, CSAMPLE* pOutput, SINT numFrames,
+        CSAMPLE_GAIN sendStart, CSAMPLE_GAIN sendEnd) {
+    constexpr SINT kChunkFrames = PartitionedConvolver::kPartitionFrames;
+    CSAMPLE send[kChunkFrames * 2];
+    CSAMPLE fading[kChunkFrames * 2];
+    bool queued = false;
+    for (SINT frame = 0; frame < numFrames; frame += kChunkFrames) {
+        const SINT chunkFrames = math_min(kChunkFrames, numFrames - frame);
+        const CSAMPLE_GAIN fadeStart =
+                static_cast<CSAMPLE_GAIN>(frame) / numFrames;
+        const CSAMPLE_GAIN fadeEnd =
+                static_cast<CSAMPLE_GAIN>(frame + chunkFrames) / numFrames;
+        CSAMPLE* pChunkOutput = &pOutput[frame * 2];
+
+        SampleUtil::copyWithRampingGain(send, &pInput[frame * 2],
+                sendStart + (sendEnd - sendStart) * fadeStart,
+                sendStart + (sendEnd - sendStart) * fadeEnd,
+                chunkFrames * 2);
+        queued |= pFrom->process(send, fading, chunkFrames);
+        queued |= pTo->process(send, pChunkOutput, chunkFrames);
+        SampleUtil::applyRampingGain(pChunkOutput, fadeStart, fadeEnd,
+                chunkFrames * 2);
+        SampleUtil::addWithRampingGain(pChunkOutput, fading,
+                1 - fadeStart, 1 - fadeEnd, chunkFrames * 2);
+    }
+    return queued;
+}
+
+} // anonymous namespace
+
+ConvolutionReverbGroupState::ConvolutionReverbGroupState(
+        const mixxx::EngineParameters& bufferParameters)
+        : EffectState(bufferParameters),
+          pTailWorker(ConvolutionWorker::acquireTailWorker()),
+          pBuildWorker(ConvolutionWorker::acquireBuildWorker()),
+          pConvolver(nullptr),
+          convolverGeneration(-1),
+          generation(0),
+          sendPrevious(0),
+          pReadyConvolver(nullptr),
+          readyGeneration(-1),
+          pRetiredConvolver(nullptr),
+          m_tailClient(this),
+          m_buildClient(this),
+          m_requested{0, 0, 0, 0, -1},
+          m_requestedLength(0),
+          m_requestedDamping(0),
+          m_requestedSampleRate(0),
+          m_requestedMaxBufferFrames(0),
+          m_requestedGeneration(-1),
+          m_pBuiltConvolver(nullptr),
+          m_builtGeneration(-1),
+          m_pDeletedConvolver(nullptr),
+          m_built{0, 0, 0, 0, -1} {
+    pTailWorker->addClient(&m_tailClient);
+    pBuildWorker->addClient(&m_buildClient);
+}
+
+ConvolutionReverbGroupState::~ConvolutionReverbGroupState() {
+    pTailWorker->removeClient(&m_tailClient);
+    pBuildWorker->removeClient(&m_buildClient);
+    // The convolvers of the engine thread are owned by the tail worker
+    for (PartitionedConvolver* pConvolver : m_convolvers) {
+        delete pConvolver;
+    }
+    for (PartitionedConvolver* pConvolver : m_retiredConvolvers) {
+        delete pConvolver;
+    }
+    delete m_pBuiltConvolver.load();
+    delete m_pDeletedConvolver.load();
+}
+
+bool ConvolutionReverbGroupState::requestImpulseResponse(double length,
+        double damping, int sampleRate, SINT maxBufferFrames, int generation) {
+    const ImpulseResponseParameters requested{
+            static_cast<float>(length), static_cast<float>(damping),
+            sampleRate, maxBufferFrames, generation};
+    if (requested == m_requested) {
+        return false;
+    }
+    m_requested = requested;
+    m_requestedLength.store(requested.length, std::memory_order_relaxed);
+    m_requestedDamping.store(requested.damping, std::memory_order_relaxed);
+    m_requestedSampleRate.store(requested.sampleRate, std::memory_order_relaxed);
+    m_requestedMaxBufferFrames.store(requested.maxBufferFrames,
+            std::memory_order_relaxed);
+    m_requestedGeneration.store(requested.generation, std::memory_order_release);
+    return true;
+}
+
+void ConvolutionReverbGroupState::processTailWork() {
+    // The tail blocks have a deadline, so they are processed before the
+    // convolvers are handed over.
+    for (PartitionedConvolver* pConvolver : m_convolvers) {
+        pConvolver->processTail();
+    }
+
+    PartitionedConvolver* pRetired =
+            pRetiredConvolver.exchange(nullptr, std::memory_order_acquire);
+    if (pRetired) {
+        m_convolvers.erase(std::remove(m_convolvers.begin(),
+                m_convolvers.end(), pRetired), m_convolvers.end());
+        m_retiredConvolvers.push_back(pRetired);
+    }
+    bool wakeBuildWorker = false;
+    if (!m_retiredConvolvers.empty() &&
+            m_pDeletedConvolver.load(std::memory_order_acquire) == nullptr) {
+        m_pDeletedConvolver.store(m_retiredConvolvers.back(),
+                std::memory_order_release);
+        m_retiredConvolvers.pop_back();
+        wakeBuildWorker = true;
+    }
+
+    // Only one convolver is handed over to the engine thread at a time
+    if (pReadyConvolver.load(std::memory_order_acquire) == nullptr) {
+        PartitionedConvolver* pBuilt =
+                m_pBuiltConvolver.exchange(nullptr, std::memory_order_acquire);
+        if (pBuilt) {
+            m_convolvers.push_back(pBuilt);
+            readyGeneration.store(
+                    m_builtGeneration.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+            pReadyConvolver.store(pBuilt, std::memory_order_release);
+            // The build worker may build the next one
+            wakeBuildWorker = true;
+        }
+    }
+    if (wakeBuildWorker) {
+        pBuildWorker->wake();
+    }
+}
+
+void ConvolutionReverbGroupState::processBuildWork() {
+    PartitionedConvolver* pDeleted =
+            m_pDeletedConvolver.exchange(nullptr, std::memory_order_acquire);
+    if (pDeleted) {
+        delete pDeleted;
+        // More convolvers may be waiting for deletion
+        pTailWorker->wake();
+    }
+
+    const int requestedGeneration =
+            m_requestedGeneration.load(std::memory_order_acquire);
+    const ImpulseResponseParameters requested{
+            m_requestedLength.load(std::memory_order_relaxed),
+            m_requestedDamping.load(std::memory_order_relaxed),
+            m_requestedSampleRate.load(std::memory_order_relaxed),
+            m_requestedMaxBufferFrames.load(std::memory_order_relaxed),
+            requestedGeneration};
+    if (requested.sampleRate <= 0 || requested == m_built ||
+            m_pBuiltConvolver.load(std::memory_order_acquire) != nullptr) {
+        return;
+    }
+    PartitionedConvolver* pConvolver = new PartitionedConvolver(
+            ConvolutionReverbEffect::makeImpulseResponse(requested.length,
+                    requested.damping, requested.sampleRate, kLeftSeed),
+            ConvolutionReverbEffect::makeImpulseResponse(requested.length,
+                    requested.damping, requested.sampleRate, kRightSeed),
+            requested.maxBufferFrames);
+    m_built = requested;
+    m_builtGeneration.store(requested.generation, std::memory_order_relaxed);
+    m_pBuiltConvolver.store(pConvolver, std::memory_order_release);
+    pTailWorker->wake();
+}
+
+// static
+QString ConvolutionReverbEffect::getId() {
+    return "org.mixxx.effects.convolutionreverb";
+}
+
+// static
+EffectManifestPointer ConvolutionReverbEffect::getManifest() {
+    EffectManifestPointer pManifest(new EffectManifest());
+    pManifest->setAddDryToWet(true);
+    pManifest->setEffectRampsFromDry(true);
+
+    pManifest->setId(getId());
+    pManifest->setName(QObject::tr("Convolution Reverb"));
+    pManifest->setShortName(QObject::tr("Conv Reverb"));
+    pManifest->setAuthor("The Mixxx Team");
+    pManifest->setVersion("1.0");
+    pManifest->setDescription(QObject::tr(
+        "Convolves the signal with the impulse response of a large room.\n"
+        "Long reverberation times don't increase the CPU load of the audio "
+        "thread."));
+
+    EffectManifestParameterPointer length = pManifest->addParameter();
+    length->setId("length");
+    length->setName(QObject::tr("Length"));
+    length->setShortName(QObject::tr("Length"));
+    length->setDescription(QObject::tr(
+        "Reverberation time in seconds, until the reverberation has decayed "
+        "by 60 dB"));
+    length->setControlHint(EffectManifestParameter::ControlHint::KNOB_LINEAR);
+    length->setSemanticHint(EffectManifestParameter::SemanticHint::UNKNOWN);
+    length->setUnitsHint(EffectManifestParameter::UnitsHint::TIME);
+    length->setMinimum(0.5);
+    length->setDefault(2.0);
+    length->setMaximum(10.0);
+
+    EffectManifestParameterPointer damping = pManifest->addParameter();
+    damping->setId("damping");
+    damping->setName(QObject::tr("Damping"));
+    damping->setShortName(QObject::tr("Damping"));
+    damping->setDescription(QObject::tr(
+        "Higher damping values cause high frequencies to decay more quickly "
+        "than low frequencies."));
+    damping->setControlHint(EffectManifestParameter::ControlHint::KNOB_LINEAR);
+    damping->setSemanticHint(EffectManifestParameter::SemanticHint::UNKNOWN);
+    damping->setUnitsHint(EffectManifestParameter::UnitsHint::UNKNOWN);
+    damping->setMinimum(0);
+    damping->setDefault(0.5);
+    damping->setMaximum(1);
+
+    EffectManifestParameterPointer send = pManifest->addParameter();
+    send->setId("send_amount");
+    send->setName(QObject::tr("Send"));
+    send->setShortName(QObject::tr("Send"));
+    send->setDescription(QObject::tr(
+        "How much of the signal to send in to the effect"));
+    send->setControlHint(EffectManifestParameter::ControlHint::KNOB_LINEAR);
+    send->setSemanticHint(EffectManifestParameter::SemanticHint::UNKNOWN);
+    send->setUnitsHint(EffectManifestParameter::UnitsHint::UNKNOWN);
+    send->setDefaultLinkType(EffectManifestParameter::LinkType::LINKED);
+    send->setDefaultLinkInversion(EffectManifestParameter::LinkInversion::NOT_INVERTED);
+    send->setMinimum(0);
+    send->setDefault(0);
+    send->setMaximum(1);
+
+    return pManifest;
+}
+
+// static
+std::vector<CSAMPLE> ConvolutionReverbEffect::makeImpulseResponse(
+        double length, double damping, int sampleRate, quint32 seed) {
+    const SINT frames = math_max<SINT>(1,
+            static_cast<SINT>(length * sampleRate));
+    std::vector<CSAMPLE> impulse(frames);
+
+    // White noise that decays by 60 dB over length and is low pass filtered
+    // with a corner that falls over time.
+    const double decay = exp(log(db2ratio(-60.0)) / frames);
+    quint32 noise = seed ? seed : 1;
+    double gain = 1.0;
+    double filtered = 0.0;
+    double energy = 0.0;
+    for (SINT i = 0; i < frames; ++i) {
+        // xorshift32
+        noise ^= noise << 13;
+        noise ^= noise >> 17;
+        noise ^= noise << 5;
+        const double white = static_cast<double>(noise) / 2147483648.0 - 1.0;
+        const double coefficient = 1.0 - 0.95 * damping * i / frames;
+        filtered += coefficient * (white - filtered);
+        const double sample = filtered * gain;
+        impulse[i] = static_cast<CSAMPLE>(sample);
+        energy += sample * sample;
+        gain *= decay;
+    }
+
+    // The output has about the same loudness as the input for all lengths
+    const CSAMPLE_GAIN normalize =
+            static_cast<CSAMPLE_GAIN>(1.0 / sqrt(math_max(energy, 1e-12)));
+    for (CSAMPLE& sample : impulse) {
+        sample *= normalize;
+    }
+    return impulse;
+}
+
+ConvolutionReverbEffect::ConvolutionReverbEffect(EngineEffect* pEffect)
+        : m_pLengthParameter(pEffect->getParameterById("length")),
+          m_pDampingParameter(pEffect->getParameterById("damping")),
+          m_pSendParameter(pEffect->getParameterById("send_amount")) {
+}
+
+ConvolutionReverbEffect::~ConvolutionReverbEffect() {
+    //qDebug() << debugString() << "destroyed";
+}
+
+void ConvolutionReverbEffect::processChannel(const ChannelHandle& handle,
+        ConvolutionReverbGroupState* pState,
+        const CSAMPLE* pInput, CSAMPLE* pOutput,
+        const mixxx::EngineParameters& bufferParameters,
+        const EffectEnableState enableState,
+        const GroupFeatureState& groupFeatures) {
+    Q_UNUSED(handle);
+    Q_UNUSED(groupFeatures);
+
+    const CSAMPLE_GAIN sendCurrent = m_pSendParameter->value();
+    const SINT numFrames = bufferParameters.framesPerBuffer();
+    const SINT numSamples = bufferParameters.samplesPerBuffer();
+
+    // Prevent replaying the old reverberation from the last time the effect
+    // was enabled by requesting a fresh convolver.
+    if (enableState == EffectEnableState::Enabling) {
+        ++pState->generation;
+    }
+    // A new impulse response is built for a changed buffer size, because
+    // the length of the head of the convolver depends on it.
+    if (pState->requestImpulseResponse(
+            m_pLengthParameter->value(), m_pDampingParameter->value(),
+            static_cast<int>(bufferParameters.sampleRate()),
+            numFrames, pState->generation)) {
+        pState->pBuildWorker->wake();
+    }
+    bool wakeWorker = false;
+
+    // Take over a new convolver from the tail worker. The replaced one is
+    // handed back at the end of this callback, so this waits until the
+    // worker has taken back the previous one.
+    PartitionedConvolver* pReplaced = nullptr;
+    if (pState->pRetiredConvolver.load(std::memory_order_acquire) == nullptr) {
+        PartitionedConvolver* pReady = pState->pReadyConvolver.exchange(
+                nullptr, std::memory_order_acq_rel);
+        if (pReady) {
+            pReplaced = pState->pConvolver;
+            // Fade over to the new impulse response, unless the old one
+            // still holds the reverberation of the last time the effect was
+            // enabled.
+            if (pState->convolverGeneration != pState->generation) {
+                pReplaced = nullptr;
+                if (pState->pConvolver) {
+                    pState->pRetiredConvolver.store(pState->pConvolver,
+                            std::memory_order_release);
+                }
+            }
+            pState->pConvolver = pReady;
+            pState->convolverGeneration =
+                    pState->readyGeneration.load(std::memory_order_relaxed);
+            // The worker may hand over the next one
+            wakeWorker = true;
+        }
+    }
+
+    if (pState->pConvolver == nullptr ||
+            pState->convolverGeneration != pState->generation) {
+        // The worker is still building the impulse response
+        SampleUtil::clear(pOutput, numSamples);
+    } else if (pReplaced) {
+        wakeWorker |= processCrossfade(pReplaced, pState->pConvolver,
+                pInput, pOutput, numFrames,
+                pState->sendPrevious, sendCurrent);
+        pState->pRetiredConvolver.store(pReplaced, std::memory_order_release);
+    } else {
+        SampleUtil::copyWithRampingGain(pOutput, pInput,
+                pState->sendPrevious, sendCurrent, numSamples);
+        wakeWorker |= pState->pConvolver->process(pOutput, pOutput, numFrames);
+    }
+    if (wakeWorker) {
+        pState->pTailWorker->wake();
+    }
+
+    // The ramping of the send parameter handles ramping when enabling, so
+    // this effect must handle ramping to dry when disabling itself (instead
+    // of being handled by EngineEffect::process).
+    if (enableState == EffectEnableState::Disabling) {
+        SampleUtil::applyRampingGain(pOutput, 1.0, 0.0, numSamples);
+        pState->sendPrevious = 0;
+    } else {
+        pState->sendPrevious = sendCurrent;
+    }
+}
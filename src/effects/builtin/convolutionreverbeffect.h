@@ -0,0 +1,160 @@
+#ifndef CONVOLUTIONREVERBEFFECT_H
+#define CONVOLUTIONREVERBEFFECT_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "effects/builtin/convolutionworker.h"
+#include "effects/builtin/partitionedconvolver.h"
+#include "effects/effectprocessor.h"
+#include "engine/effects/engineeffect.h"
+#include "engine/effects/engineeffectparameter.h"
+#include "util/class.h"
+#include "util/types.h"
+
+// The impulse responses are built and deleted by the build worker and
+// handed over to the engine thread by the tail worker, which owns all
+// convolvers that the engine thread may use. The engine thread only swaps
+// the pointers that are handed over between the threads.
+class ConvolutionReverbGroupState : public EffectState {
+  public:
+    ConvolutionReverbGroupState(const mixxx::EngineParameters& bufferParameters);
+    ~ConvolutionReverbGroupState() override;
+
+    // Called from the engine thread. Returns true if the parameters have
+    // changed since the last request.
+    bool requestImpulseResponse(double length, double damping,
+            int sampleRate, SINT maxBufferFrames, int generation);
+
+    std::shared_ptr<ConvolutionWorker> pTailWorker;
+    std::shared_ptr<ConvolutionWorker> pBuildWorker;
+
+    // Engine thread
+    PartitionedConvolver* pConvolver;
+    int convolverGeneration;
+    // Incremented whenever the effect is enabled to drop the reverberation
+    // of the last time the effect was enabled.
+    int generation;
+    CSAMPLE_GAIN sendPrevious;
+
+    // Handed from the tail worker to the engine thread
+    std::atomic<PartitionedConvolver*> pReadyConvolver;
+    std::atomic<int> readyGeneration;
+    // Handed from the engine thread to the tail worker
+    std::atomic<PartitionedConvolver*> pRetiredConvolver;
+
+  private:
+    class TailClient : public ConvolutionWorker::Client {
+      public:
+        explicit TailClient(ConvolutionReverbGroupState* pState)
+                : m_pState(pState) {
+        }
+        void processConvolutionWork() override {
+            m_pState->processTailWork();
+        }
+
+      private:
+        ConvolutionReverbGroupState* const m_pState;
+    };
+
+    class BuildClient : public ConvolutionWorker::Client {
+      public:
+        explicit BuildClient(ConvolutionReverbGroupState* pState)
+                : m_pState(pState) {
+        }
+        void processConvolutionWork() override {
+            m_pState->processBuildWork();
+        }
+
+      private:
+        ConvolutionReverbGroupState* const m_pState;
+    };
+
+    struct ImpulseResponseParameters {
+        float length;
+        float damping;
+        int sampleRate;
+        SINT maxBufferFrames;
+        int generation;
+
+        bool operator==(const ImpulseResponseParameters& other) const {
+            return length == other.length &&
+                    damping == other.damping &&
+                    sampleRate == other.sampleRate &&
+                    maxBufferFrames == other.maxBufferFrames &&
+                    generation == other.generation;
+        }
+    };
+
+    // Called from the tail worker
+    void processTailWork();
+    // Called from the build worker
+    void processBuildWork();
+
+    TailClient m_tailClient;
+    BuildClient m_buildClient;
+
+    // Engine thread
+    ImpulseResponseParameters m_requested;
+
+    std::atomic<float> m_requestedLength;
+    std::atomic<float> m_requestedDamping;
+    std::atomic<int> m_requestedSampleRate;
+    std::atomic<SINT> m_requestedMaxBufferFrames;
+    std::atomic<int> m_requestedGeneration;
+
+    // Handed from the build worker to the tail worker
+    std::atomic<PartitionedConvolver*> m_pBuiltConvolver;
+    std::atomic<int> m_builtGeneration;
+    // Handed from the tail worker to the build worker for deletion
+    std::atomic<PartitionedConvolver*> m_pDeletedConvolver;
+
+    // Tail worker, all convolvers that the engine thread may use
+    std::vector<PartitionedConvolver*> m_convolvers;
+    // Retired, but not handed to the build worker yet
+    std::vector<PartitionedConvolver*> m_retiredConvolvers;
+
+    // Build worker
+    ImpulseResponseParameters m_built;
+};
+
+// A reverb that convolves the signal with the impulse response of a room,
+// which is modeled by exponentially decaying noise. The length of the
+// impulse response doesn't affect the CPU load of the audio callback,
+// because its tail is convolved by the ConvolutionWorker.
+class ConvolutionReverbEffect
+        : public EffectProcessorImpl<ConvolutionReverbGroupState> {
+  public:
+    ConvolutionReverbEffect(EngineEffect* pEffect);
+    virtual ~ConvolutionReverbEffect();
+
+    static QString getId();
+    static EffectManifestPointer getManifest();
+
+    // Returns the impulse response of one channel with the reverberation
+    // time length in seconds. The channels are decorrelated by the seed.
+    static std::vector<CSAMPLE> makeImpulseResponse(double length,
+            double damping, int sampleRate, quint32 seed);
+
+    // See effectprocessor.h
+    void processChannel(const ChannelHandle& handle,
+                        ConvolutionReverbGroupState* pState,
+                        const CSAMPLE* pInput, CSAMPLE* pOutput,
+                        const mixxx::EngineParameters& bufferParameters,
+                        const EffectEnableState enableState,
+                        const GroupFeatureState& groupFeatures);
+
+  private:
+    QString debugString() const {
+        return getId();
+    }
+
+    EngineEffectParameter* m_pLengthParameter;
+    EngineEffectParameter* m_pDampingParameter;
+    EngineEffectParameter* m_pSendParameter;
+
+    DISALLOW_COPY_AND_ASSIGN(ConvolutionReverbEffect);
+};
+
+#endif /* CONVOLUTIONREVERBEFFECT_H */
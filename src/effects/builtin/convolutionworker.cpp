@@ -0,0 +1,87 @@
+#include "effects/builtin/convolutionworker.h"
+
+#include <QMutexLocker>
+
+#include "util/assert.h"
+#include "util/denormalsarezero.h"
+
+namespace {
+
+QMutex s_instanceMutex;
+std::weak_ptr<ConvolutionWorker> s_pTailWorker;
+std::weak_ptr<ConvolutionWorker> s_pBuildWorker;
+
+std::shared_ptr<ConvolutionWorker> acquireWorker(
+        std::weak_ptr<ConvolutionWorker>* pInstance, const QString& name,
+        QThread::Priority priority) {
+    QMutexLocker locker(&s_instanceMutex);
+    std::shared_ptr<ConvolutionWorker> pWorker = pInstance->lock();
+    if (!pWorker) {
+        pWorker = std::make_shared<ConvolutionWorker>(name);
+        pWorker->start(priority);
+        *pInstance = pWorker;
+    }
+    return pWorker;
+}
+
+} // anonymous namespace
+
+// static
+std::shared_ptr<ConvolutionWorker> ConvolutionWorker::acquireTailWorker() {
+    // The tail blocks have a deadline, like the audio callback
+    return acquireWorker(&s_pTailWorker, "ConvolutionTailWorker",
+            QThread::HighPriority);
+}
+
+// static
+std::shared_ptr<ConvolutionWorker> ConvolutionWorker::acquireBuildWorker() {
+    return acquireWorker(&s_pBuildWorker, "ConvolutionBuildWorker",
+            QThread::LowPriority);
+}
+
+ConvolutionWorker::ConvolutionWorker(const QString& name)
+        : m_name(name),
+          m_stop(false) {
+}
+
+ConvolutionWorker::~ConvolutionWorker() {
+    m_stop = true;
+    m_semaRun.release();
+    wait();
+    DEBUG_ASSERT(m_clients.isEmpty());
+}
+
+void ConvolutionWorker::addClient(Client* pClient) {
+    QMutexLocker locker(&m_clientsMutex);
+    m_clients.append(pClient);
+}
+
+void ConvolutionWorker::removeClient(Client* pClient) {
+    QMutexLocker locker(&m_clientsMutex);
+    m_clients.removeAll(pClient);
+}
+
+void ConvolutionWorker::wake() {
+    m_semaRun.release();
+}
+
+void ConvolutionWorker::run() {
+    QThread::currentThread()->setObjectName(m_name);
+#ifdef __SSE__
+    // The decaying impulse responses end in denormals. They are disabled
+    // like in the engine thread, see SoundDevicePortAudio.
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+#endif
+
+    while (!m_stop.load()) {
+        m_semaRun.acquire();
+        // All pending wakes are handled by one pass over the clients
+        m_semaRun.tryAcquire(m_semaRun.available());
+
+        QMutexLocker locker(&m_clientsMutex);
+        for (Client* pClient : m_clients) {
+            pClient->processConvolutionWork();
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef CONVOLUTIONWORKER_H
+#define CONVOLUTIONWORKER_H
+
+#include <atomic>
+#include <memory>
+
+#include <QList>
+#include <QMutex>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+
+// ConvolutionWorker runs the work of the convolution effects that doesn't
+// fit into the audio callback. Like an EngineWorker it sleeps until new
+// work has been queued, but it is woken by the effects directly, because
+// they can't reach the EngineWorkerScheduler of EngineMaster.
+//
+// There are two workers that are shared by all convolution effects. The
+// tail worker computes the tails of the PartitionedConvolvers, which have
+// a deadline. The build worker builds new impulse responses and deletes
+// replaced ones, which may take much longer than a tail block. Each worker
+// is started with the first effect that acquires it and stopped with the
+// last one.
+class ConvolutionWorker : public QThread {
+    Q_OBJECT
+  public:
+    class Client {
+      public:
+        virtual ~Client() {}
+        // Called from the worker thread after the worker has been woken.
+        virtual void processConvolutionWork() = 0;
+    };
+
+    static std::shared_ptr<ConvolutionWorker> acquireTailWorker();
+    static std::shared_ptr<ConvolutionWorker> acquireBuildWorker();
+
+    explicit ConvolutionWorker(const QString& name);
+    ~ConvolutionWorker() override;
+
+    // Called from the main thread. removeClient() waits until the worker
+    // is done with the client, after that the client may be deleted.
+    void addClient(Client* pClient);
+    void removeClient(Client* pClient);
+
+    // Called from any thread, including the engine thread. Doesn't block.
+    void wake();
+
+  protected:
+    void run() override;
+
+  private:
+    const QString m_name;
+    QSemaphore m_semaRun;
+    std::atomic<bool> m_stop;
+    QMutex m_clientsMutex;
+    QList<Client*> m_clients;
+};
+
+#endif /* CONVOLUTIONWORKER_H */
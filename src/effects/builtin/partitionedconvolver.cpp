@@ -0,0 +1,254 @@
+#include "effects/builtin/partitionedconvolver.h"
+
+#include <algorithm>
+
+#include "util/math.h"
+
+constexpr int PartitionedConvolver::kPartitionFrames;
+constexpr int PartitionedConvolver::kMinEnginePartitions;
+
+namespace {
+
+int partitionsForFrames(SINT frames) {
+    return math_max(1, static_cast<int>(
+            (frames + PartitionedConvolver::kPartitionFrames - 1) /
+            PartitionedConvolver::kPartitionFrames));
+}
+
+// A buffer completes at most partitionsForFrames(maxBufferFrames) input
+// blocks. The tail block that is queued when an input block is complete is
+// needed enginePartitions - 1 blocks later, i.e. in a later buffer.
+int enginePartitionsForBuffer(SINT maxBufferFrames) {
+    return math_max(PartitionedConvolver::kMinEnginePartitions,
+            partitionsForFrames(maxBufferFrames) + 1);
+}
+
+} // anonymous namespace
+
+PartitionedConvolver::PartitionedConvolver(
+        const std::vector<CSAMPLE>& impulseLeft,
+        const std::vector<CSAMPLE>& impulseRight,
+        SINT maxBufferFrames)
+        : m_impulseFrames(math_max(impulseLeft.size(), impulseRight.size())),
+          m_partitions(partitionsForFrames(m_impulseFrames)),
+          m_enginePartitions(enginePartitionsForBuffer(maxBufferFrames)),
+          m_inputBlocks(m_partitions + m_enginePartitions),
+          m_bins(kPartitionFrames + 1),
+          m_fft(2 * kPartitionFrames),
+          m_framePosition(0),
+          m_block(0),
+          m_spectrumReal(m_bins),
+          m_spectrumImag(m_bins),
+          m_timeBuffer(2 * kPartitionFrames),
+          m_queuedTailBlocks(0),
+          m_droppedTailBlocks(0) {
+    const std::vector<CSAMPLE>* impulses[2] = { &impulseLeft, &impulseRight };
+    for (int c = 0; c < 2; ++c) {
+        Channel& channel = m_channels[c];
+        std::vector<CSAMPLE> impulse(*impulses[c]);
+        impulse.resize(m_partitions * kPartitionFrames, 0);
+
+        channel.headReversed.assign(impulse.rend() - kPartitionFrames,
+                impulse.rend());
+        channel.impulseReal.resize(m_partitions * m_bins);
+        channel.impulseImag.resize(m_partitions * m_bins);
+        for (int p = 0; p < m_partitions; ++p) {
+            // Each partition is padded with zeros to the size of the FFT
+            std::fill(m_timeBuffer.begin(), m_timeBuffer.end(), 0);
+            std::copy(impulse.begin() + p * kPartitionFrames,
+                    impulse.begin() + (p + 1) * kPartitionFrames,
+                    m_timeBuffer.begin());
+            m_fft.forward(m_timeBuffer.data(),
+                    &channel.impulseReal[p * m_bins],
+                    &channel.impulseImag[p * m_bins]);
+        }
+        channel.inputReal.assign(m_inputBlocks * m_bins, 0);
+        channel.inputImag.assign(m_inputBlocks * m_bins, 0);
+        channel.input.assign(2 * kPartitionFrames, 0);
+        channel.blockOutput.assign(kPartitionFrames, 0);
+    }
+
+    if (m_partitions > m_enginePartitions) {
+        m_tailBlocks.reset(new TailBlock[m_enginePartitions]);
+        for (int i = 0; i < m_enginePartitions; ++i) {
+            for (int c = 0; c < 2; ++c) {
+                m_tailBlocks[i].real[c].resize(m_bins);
+                m_tailBlocks[i].imag[c].resize(m_bins);
+            }
+        }
+    }
+}
+
+bool PartitionedConvolver::process(const CSAMPLE* pInput, CSAMPLE* pOutput,
+        SINT numFrames) {
+    bool queued = false;
+    for (SINT frame = 0; frame < numFrames; ++frame) {
+        for (int c = 0; c < 2; ++c) {
+            Channel& channel = m_channels[c];
+            channel.input[kPartitionFrames + m_framePosition] =
+                    pInput[frame * 2 + c];
+            // The direct convolution with the first partition
+            const CSAMPLE* pHistory = &channel.input[m_framePosition + 1];
+            const CSAMPLE* pHead = channel.headReversed.data();
+            CSAMPLE sum = 0;
+            for (int i = 0; i < kPartitionFrames; ++i) {
+                sum += pHead[i] * pHistory[i];
+            }
+            pOutput[frame * 2 + c] = sum + channel.blockOutput[m_framePosition];
+        }
+        if (++m_framePosition == kPartitionFrames) {
+            finishInputBlock();
+            queued |= m_tailBlocks != nullptr;
+            m_framePosition = 0;
+        }
+    }
+    return queued;
+}
+
+void PartitionedConvolver::finishInputBlock() {
+    const qint64 block = m_block;
+    const int inputOffset = (block % m_inputBlocks) * m_bins;
+    for (Channel& channel : m_channels) {
+        m_fft.forward(channel.input.data(),
+                &channel.inputReal[inputOffset],
+                &channel.inputImag[inputOffset]);
+        std::copy(channel.input.begin() + kPartitionFrames,
+                channel.input.end(), channel.input.begin());
+    }
+    m_block = block + 1;
+
+    if (m_tailBlocks) {
+        // The spectrum of this block is the last one that the tail of the
+        // output block m_enginePartitions blocks ahead depends on.
+        const qint64 tailBlock = block + m_enginePartitions;
+        TailBlock& queuedTail = m_tailBlocks[tailBlock % m_enginePartitions];
+        // The slot is still owned by the worker if it has abandoned the
+        // previous block in it. Then this block is not queued and dropped
+        // when it is needed.
+        if (queuedTail.state.load(std::memory_order_acquire) ==
+                TAIL_BLOCK_IDLE) {
+            queuedTail.block = tailBlock;
+            queuedTail.state.store(TAIL_BLOCK_QUEUED, std::memory_order_release);
+        }
+        m_queuedTailBlocks.store(tailBlock + 1, std::memory_order_release);
+    }
+
+    // Compute the output of the next block from the spectra of this and the
+    // previous blocks.
+    const qint64 outputBlock = m_block;
+    TailBlock* pTail = takeTailBlock(outputBlock);
+    for (int c = 0; c < 2; ++c) {
+        Channel& channel = m_channels[c];
+        if (pTail) {
+            std::copy(pTail->real[c].begin(), pTail->real[c].end(),
+                    m_spectrumReal.begin());
+            std::copy(pTail->imag[c].begin(), pTail->imag[c].end(),
+                    m_spectrumImag.begin());
+        } else {
+            std::fill(m_spectrumReal.begin(), m_spectrumReal.end(), 0);
+            std::fill(m_spectrumImag.begin(), m_spectrumImag.end(), 0);
+        }
+        multiplyAccumulate(channel, outputBlock, 1,
+                math_min(m_partitions, m_enginePartitions),
+                m_spectrumReal.data(), m_spectrumImag.data());
+        m_fft.inverse(m_spectrumReal.data(), m_spectrumImag.data(),
+                m_timeBuffer.data());
+        // Overlap-save: The first half is the aliased part of the circular
+        // convolution.
+        std::copy(m_timeBuffer.begin() + kPartitionFrames, m_timeBuffer.end(),
+                channel.blockOutput.begin());
+    }
+    if (pTail) {
+        pTail->state.store(TAIL_BLOCK_IDLE, std::memory_order_release);
+    }
+}
+
+PartitionedConvolver::TailBlock* PartitionedConvolver::takeTailBlock(
+        qint64 outputBlock) {
+    if (!m_tailBlocks || outputBlock < m_enginePartitions) {
+        // The first blocks are not reached by the tail
+        return nullptr;
+    }
+    TailBlock* pTail = &m_tailBlocks[outputBlock % m_enginePartitions];
+    int state = pTail->state.load(std::memory_order_acquire);
+    if (state == TAIL_BLOCK_DONE && pTail->block == outputBlock) {
+        return pTail;
+    }
+    if (pTail->block == outputBlock) {
+        // The worker is late. A queued block is taken back, a block that
+        // the worker is computing right now is left to the worker.
+        if (state == TAIL_BLOCK_QUEUED &&
+                !pTail->state.compare_exchange_strong(state,
+                        TAIL_BLOCK_IDLE, std::memory_order_acq_rel)) {
+            // The worker has started it in the meantime
+            DEBUG_ASSERT(state == TAIL_BLOCK_PROCESSING);
+        }
+        if (state == TAIL_BLOCK_PROCESSING &&
+                !pTail->state.compare_exchange_strong(state,
+                        TAIL_BLOCK_ABANDONED, std::memory_order_acq_rel)) {
+            // The worker has finished it in the meantime
+            DEBUG_ASSERT(state == TAIL_BLOCK_DONE);
+            return pTail;
+        }
+    }
+    m_droppedTailBlocks.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void PartitionedConvolver::processTail() {
+    if (!m_tailBlocks) {
+        return;
+    }
+    const qint64 queuedTailBlocks =
+            m_queuedTailBlocks.load(std::memory_order_acquire);
+    // Oldest block first, it is the first one that is needed
+    for (qint64 block = math_max<qint64>(0, queuedTailBlocks - m_enginePartitions);
+            block < queuedTailBlocks; ++block) {
+        TailBlock* pTail = &m_tailBlocks[block % m_enginePartitions];
+        int expected = TAIL_BLOCK_QUEUED;
+        if (!pTail->state.compare_exchange_strong(expected,
+                TAIL_BLOCK_PROCESSING, std::memory_order_acquire)) {
+            continue;
+        }
+        computeTailBlock(pTail);
+        expected = TAIL_BLOCK_PROCESSING;
+        if (!pTail->state.compare_exchange_strong(expected,
+                TAIL_BLOCK_DONE, std::memory_order_acq_rel)) {
+            // Dropped by the engine thread, the slot may be reused now
+            DEBUG_ASSERT(expected == TAIL_BLOCK_ABANDONED);
+            pTail->state.store(TAIL_BLOCK_IDLE, std::memory_order_release);
+        }
+    }
+}
+
+void PartitionedConvolver::computeTailBlock(TailBlock* pTail) const {
+    for (int c = 0; c < 2; ++c) {
+        std::fill(pTail->real[c].begin(), pTail->real[c].end(), 0);
+        std::fill(pTail->imag[c].begin(), pTail->imag[c].end(), 0);
+        multiplyAccumulate(m_channels[c], pTail->block,
+                m_enginePartitions, m_partitions,
+                pTail->real[c].data(), pTail->imag[c].data());
+    }
+}
+
+void PartitionedConvolver::multiplyAccumulate(const Channel& channel,
+        qint64 block, int firstPartition, int lastPartition,
+        CSAMPLE* pReal, CSAMPLE* pImag) const {
+    for (int p = firstPartition; p < lastPartition; ++p) {
+        const qint64 inputBlock = block - p;
+        if (inputBlock < 0) {
+            break;
+        }
+        const int inputOffset = (inputBlock % m_inputBlocks) * m_bins;
+        const CSAMPLE* pInputReal = &channel.inputReal[inputOffset];
+        const CSAMPLE* pInputImag = &channel.inputImag[inputOffset];
+        const CSAMPLE* pImpulseReal = &channel.impulseReal[p * m_bins];
+        const CSAMPLE* pImpulseImag = &channel.impulseImag[p * m_bins];
+        for (int bin = 0; bin < m_bins; ++bin) {
+            pReal[bin] += pInputReal[bin] * pImpulseReal[bin] -
+                    pInputImag[bin] * pImpulseImag[bin];
+            pImag[bin] += pInputReal[bin] * pImpulseImag[bin] +
+                    pInputImag[bin] * pImpulseReal[bin];
+        }
+    }
+}
@@ -0,0 +1,155 @@
+#ifndef PARTITIONEDCONVOLVER_H
+#define PARTITIONEDCONVOLVER_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QtGlobal>
+
+#include "util/class.h"
+#include "util/fft.h"
+#include "util/types.h"
+
+// Convolves a stereo signal with a stereo impulse response of any length
+// without adding latency, using uniformly partitioned overlap-save FFT
+// convolution with partitions of kPartitionFrames.
+//
+// The work is split in three parts:
+//  * The first partition of the impulse response is applied directly to
+//    every sample, so the output of a frame depends on its own input.
+//  * The next enginePartitions() - 1 partitions, the head, are applied in
+//    the engine thread whenever a partition of the input is complete.
+//  * The remaining partitions, the tail, are queued for processTail(),
+//    which is called by a worker thread. The result of a tail block is
+//    needed enginePartitions() partitions after it has been queued.
+//
+// The head is long enough that a tail block queued in one audio buffer is
+// needed in a later buffer at the earliest, so the worker has at least the
+// time between two callbacks for it, even for large buffers. The cost of
+// process() per frame is therefore bounded independent of the length of
+// the impulse response.
+//
+// process() never waits for the worker and never computes a tail block
+// itself. A tail block that is not done when it is needed is dropped, i.e.
+// the output of this block lacks the tail of the impulse response, and
+// counted in droppedTailBlocks().
+//
+// All memory is allocated by the constructor. Neither process() nor
+// processTail() allocate.
+class PartitionedConvolver {
+  public:
+    static constexpr int kPartitionFrames = 128;
+    // The minimum number of partitions that are applied in the engine
+    // thread, including the first one
+    static constexpr int kMinEnginePartitions = 32;
+
+    // maxBufferFrames is the largest number of frames that is passed to
+    // process() at once.
+    PartitionedConvolver(const std::vector<CSAMPLE>& impulseLeft,
+            const std::vector<CSAMPLE>& impulseRight,
+            SINT maxBufferFrames);
+
+    SINT impulseFrames() const {
+        return m_impulseFrames;
+    }
+
+    int enginePartitions() const {
+        return m_enginePartitions;
+    }
+
+    // Called from the engine thread with interleaved stereo samples.
+    // pInput may be the same buffer as pOutput. If numFrames exceeds
+    // maxBufferFrames, the worker can't finish all tail blocks in time.
+    // Returns true if tail blocks have been queued for processTail().
+    bool process(const CSAMPLE* pInput, CSAMPLE* pOutput, SINT numFrames);
+
+    // Called from the worker thread. Computes all queued tail blocks.
+    void processTail();
+
+    // The number of tail blocks that the worker didn't finish in time.
+    int droppedTailBlocks() const {
+        return m_droppedTailBlocks.load(std::memory_order_relaxed);
+    }
+
+  private:
+    enum TailBlockState {
+        TAIL_BLOCK_IDLE,
+        TAIL_BLOCK_QUEUED,
+        TAIL_BLOCK_PROCESSING,
+        TAIL_BLOCK_DONE,
+        // Dropped by the engine thread while the worker is processing it.
+        // The worker sets it back to idle when it is done.
+        TAIL_BLOCK_ABANDONED,
+    };
+
+    struct Channel {
+        // The first partition of the impulse response in reverse order
+        std::vector<CSAMPLE> headReversed;
+        // The spectra of all partitions of the impulse response
+        std::vector<CSAMPLE> impulseReal;
+        std::vector<CSAMPLE> impulseImag;
+        // The spectra of the last input blocks, indexed by block modulo
+        // m_inputBlocks
+        std::vector<CSAMPLE> inputReal;
+        std::vector<CSAMPLE> inputImag;
+        // The previous and the current input partition
+        std::vector<CSAMPLE> input;
+        // The convolution with all but the first partition for the current
+        // output partition
+        std::vector<CSAMPLE> blockOutput;
+    };
+
+    struct TailBlock {
+        TailBlock()
+                : state(TAIL_BLOCK_IDLE),
+                  block(-1) {
+        }
+        std::atomic<int> state;
+        // The output block. Only written by the engine thread while the
+        // block is idle.
+        qint64 block;
+        // The spectrum of the tail for both channels
+        std::vector<CSAMPLE> real[2];
+        std::vector<CSAMPLE> imag[2];
+    };
+
+    void finishInputBlock();
+    // Returns the tail of the output block or nullptr if there is none
+    TailBlock* takeTailBlock(qint64 outputBlock);
+    void computeTailBlock(TailBlock* pTailBlock) const;
+    // Adds the products of the spectra of the input blocks before block
+    // and the partitions [firstPartition, lastPartition) to the spectrum.
+    void multiplyAccumulate(const Channel& channel, qint64 block,
+            int firstPartition, int lastPartition,
+            CSAMPLE* pReal, CSAMPLE* pImag) const;
+
+    const SINT m_impulseFrames;
+    const int m_partitions;
+    const int m_enginePartitions;
+    // The input spectra are kept a bit longer than the impulse response
+    // needs them, so a worker that is late for a block doesn't read input
+    // spectra that are overwritten in the meantime.
+    const int m_inputBlocks;
+    const int m_bins;
+    mixxx::RealFft m_fft;
+    Channel m_channels[2];
+
+    // Engine thread
+    int m_framePosition;
+    // The block that is currently being filled
+    qint64 m_block;
+    std::vector<CSAMPLE> m_spectrumReal;
+    std::vector<CSAMPLE> m_spectrumImag;
+    std::vector<CSAMPLE> m_timeBuffer;
+
+    // The tail blocks in flight, indexed by block modulo m_enginePartitions
+    std::unique_ptr<TailBlock[]> m_tailBlocks;
+    // One past the last output block that has been queued
+    std::atomic<qint64> m_queuedTailBlocks;
+    std::atomic<int> m_droppedTailBlocks;
+
+    DISALLOW_COPY_AND_ASSIGN(PartitionedConvolver);
+};
+
+#endif /* PARTITIONEDCONVOLVER_H */
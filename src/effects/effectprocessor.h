@@ -8,6 +8,7 @@
 #include <QPair>
 
 #include "util/types.h"
+#include "util/sample.h"
 #include "engine/engine.h"
 #include "effects/defs.h"
 #include "engine/effects/groupfeaturestate.h"
@@ -38,6 +39,12 @@ class EngineEffect;
 // EffectStates are only allocated for input signals that are enabled at that
 // time. This allows for scaling up to an arbitrary number of input signals
 // without wasting a lot of memory.
+//
+// The audio engine thread never allocates or deletes EffectStates. It only
+// swaps pointers between the EffectStatesMap of a request and the state
+// matrix of the EffectProcessor, which is sized for all registered channels
+// in the main thread. States that are left in the request are deleted by
+// EffectsManager in the main thread.
 class EffectState {
   public:
     EffectState(const mixxx::EngineParameters& bufferParameters) {
@@ -60,8 +67,10 @@ class EffectProcessor {
             EffectsManager* pEffectsManager,
             const mixxx::EngineParameters& bufferParameters) = 0;
     virtual EffectState* createState(const mixxx::EngineParameters& bufferParameters) = 0;
+    // Called from the audio engine thread. Takes the states of pStatesMap and
+    // puts the states that were loaded before, if any, into pStatesMap.
     virtual bool loadStatesForInputChannel(const ChannelHandle* inputChannel,
-          const EffectStatesMap* pStatesMap) = 0;
+          EffectStatesMap* pStatesMap) = 0;
     // Called from main thread for garbage collection after the last audio thread
     // callback executes process() with EffectEnableState::Disabling
     virtual void deleteStatesForInputChannel(const ChannelHandle* inputChannel) = 0;
@@ -104,7 +113,10 @@ class EffectProcessorImpl : public EffectProcessor {
         for (ChannelHandleMap<EffectSpecificState*>& outputsMap : m_channelStateMatrix) {
             int outputChannelHandleNumber = 0;
             for (EffectSpecificState* pState : outputsMap) {
-                VERIFY_OR_DEBUG_ASSERT(pState != nullptr) {
+                // The matrix is sized for all registered channels, not only
+                // for those that have states.
+                if (pState == nullptr) {
+                    outputChannelHandleNumber++;
                     continue;
                 }
                 if (kEffectDebugOutput) {
@@ -151,8 +163,13 @@ class EffectProcessorImpl : public EffectProcessor {
                            << "EffectState should have been preallocated in the"
                               "main thread.";
             }
-            pState = createSpecificState(bufferParameters);
-            m_channelStateMatrix[inputHandle][outputHandle] = pState;
+            // Allocating the state here would block the audio engine
+            // thread, so the signal passes through unprocessed.
+            if (pInput != pOutput) {
+                SampleUtil::copy(pOutput, pInput,
+                        bufferParameters.samplesPerBuffer());
+            }
+            return;
         }
         processChannel(inputHandle, pState, pInput, pOutput, bufferParameters,
                        enableState, groupFeatures);
@@ -161,6 +178,17 @@ class EffectProcessorImpl : public EffectProcessor {
     void initialize(const QSet<ChannelHandleAndGroup>& activeInputChannels,
             EffectsManager* pEffectsManager,
             const mixxx::EngineParameters& bufferParameters) final {
+        // Size the matrix for all registered channels, so the audio engine
+        // thread only ever replaces the pointers in it.
+        for (const ChannelHandleAndGroup& inputChannel :
+                pEffectsManager->registeredInputChannels()) {
+            ChannelHandleMap<EffectSpecificState*>& outputChannelMap =
+                    m_channelStateMatrix[inputChannel.handle()];
+            for (const ChannelHandleAndGroup& outputChannel :
+                    pEffectsManager->registeredOutputChannels()) {
+                outputChannelMap.insert(outputChannel.handle(), nullptr);
+            }
+        }
         for (const ChannelHandleAndGroup& inputChannel : activeInputChannels) {
             if (kEffectDebugOutput) {
                 qDebug() << this << "EffectProcessorImpl::initialize allocating "
@@ -187,7 +215,7 @@ class EffectProcessorImpl : public EffectProcessor {
     };
 
     bool loadStatesForInputChannel(const ChannelHandle* inputChannel,
-              const EffectStatesMap* pStatesMap) final {
+              EffectStatesMap* pStatesMap) final {
           if (kEffectDebugOutput) {
               qDebug() << "EffectProcessorImpl::loadStatesForInputChannel" << this
                        << "input" << *inputChannel;
@@ -201,22 +229,10 @@ class EffectProcessorImpl : public EffectProcessor {
 
           // Can't directly cast a ChannelHandleMap from containing the base
           // EffectState* type to EffectSpecificState* type, so iterate through
-          // pStatesMap to build a new ChannelHandleMap with
-          // dynamic_cast'ed states.
+          // pStatesMap and swap the dynamic_cast'ed states into the matrix.
           ChannelHandleMap<EffectSpecificState*>& effectSpecificStatesMap =
                   m_channelStateMatrix[*inputChannel];
 
-          // deleteStatesForInputChannel should have been called before a new
-          // map of EffectStates was sent to this function, or this is the first
-          // time states are being loaded for this input channel, so
-          // effectSpecificStatesMap should be empty and this loop should
-          // not go through any iterations.
-          for (EffectSpecificState* pState : effectSpecificStatesMap) {
-              VERIFY_OR_DEBUG_ASSERT(pState == nullptr) {
-                  delete pState;
-              }
-          }
-
           for (const ChannelHandleAndGroup& outputChannel :
                   m_pEffectsManager->registeredOutputChannels()) {
               if (kEffectDebugOutput) {
@@ -224,12 +240,21 @@ class EffectProcessorImpl : public EffectProcessor {
                            << this << "output" << outputChannel;
               }
 
-              auto pState = dynamic_cast<EffectSpecificState*>(
-                        pStatesMap->at(outputChannel.handle()));
+              EffectState*& pRequestState = (*pStatesMap)[outputChannel.handle()];
+              auto pState = dynamic_cast<EffectSpecificState*>(pRequestState);
               VERIFY_OR_DEBUG_ASSERT(pState != nullptr) {
                     return false;
               }
-              effectSpecificStatesMap.insert(outputChannel.handle(), pState);
+              // deleteStatesForInputChannel should have been called before a
+              // new map of EffectStates was sent to this function, or this is
+              // the first time states are being loaded for this input channel,
+              // so there should be no previous state. Otherwise it is handed
+              // back with the request to be deleted in the main thread.
+              EffectSpecificState*& pLoadedState =
+                      effectSpecificStatesMap[outputChannel.handle()];
+              DEBUG_ASSERT(pLoadedState == nullptr);
+              pRequestState = pLoadedState;
+              pLoadedState = pState;
           }
           return true;
     };
@@ -249,8 +274,8 @@ class EffectProcessorImpl : public EffectProcessor {
 
           ChannelHandleMap<EffectSpecificState*>& stateMap =
                   m_channelStateMatrix[*inputChannel];
-          for (EffectSpecificState* pState : stateMap) {
-                VERIFY_OR_DEBUG_ASSERT(pState != nullptr) {
+          for (EffectSpecificState*& pState : stateMap) {
+                if (pState == nullptr) {
                       continue;
                 }
                 if (kEffectDebugOutput) {
@@ -258,8 +283,10 @@ class EffectProcessorImpl : public EffectProcessor {
                                << this << "deleting state" << pState;
                 }
                 delete pState;
+                // Keep the slot, so loading states again does not need to
+                // resize the map in the audio engine thread.
+                pState = nullptr;
           }
-          stateMap.clear();
     };
 
   private:
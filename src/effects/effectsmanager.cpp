@@ -490,5 +490,24 @@ void EffectsManager::collectGarbage(const EffectsRequest* pRequest) {
         }
         pRequest->pTargetChain->deleteStatesForInputChannel(
                 pRequest->DisableInputChannelForChain.pChannelHandle);
+    } else if (pRequest->type == EffectsRequest::ENABLE_EFFECT_CHAIN_FOR_INPUT_CHANNEL) {
+        // The audio engine thread does not delete EffectStates. It leaves the
+        // states that it did not load, or that were replaced, in the request.
+        EffectStatesMapArray* pEffectStatesMapArray =
+                pRequest->EnableInputChannelForChain.pEffectStatesMapArray;
+        if (pEffectStatesMapArray == nullptr) {
+            return;
+        }
+        for (EffectStatesMap& statesMap : *pEffectStatesMapArray) {
+            for (EffectState*& pState : statesMap) {
+                if (pState != nullptr) {
+                    if (kEffectDebugOutput) {
+                        qDebug() << debugString() << "delete unused EffectState" << pState;
+                    }
+                    delete pState;
+                    pState = nullptr;
+                }
+            }
+        }
     }
 }
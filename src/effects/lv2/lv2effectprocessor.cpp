@@ -36,7 +36,10 @@ LV2EffectProcessor::~LV2EffectProcessor() {
     for (auto& outputsMap : m_channelStateMatrix) {
         int outputChannelHandleNumber = 0;
         for (LV2EffectGroupState* pState : outputsMap) {
-              VERIFY_OR_DEBUG_ASSERT(pState != nullptr) {
+              // The matrix is sized for all registered channels, not only for
+              // those that have states.
+              if (pState == nullptr) {
+                    outputChannelHandleNumber++;
                     continue;
               }
               if (kEffectDebugOutput) {
@@ -65,6 +68,17 @@ void LV2EffectProcessor::initialize(
     Q_UNUSED(pEffectsManager);
     Q_UNUSED(bufferParameters);
 
+    // Size the matrix for all registered channels, so the audio engine thread
+    // only ever replaces the pointers in it.
+    for (const ChannelHandleAndGroup& inputChannel :
+            pEffectsManager->registeredInputChannels()) {
+        ChannelHandleMap<LV2EffectGroupState*>& outputChannelMap =
+                m_channelStateMatrix[inputChannel.handle()];
+        for (const ChannelHandleAndGroup& outputChannel :
+                pEffectsManager->registeredOutputChannels()) {
+            outputChannelMap.insert(outputChannel.handle(), nullptr);
+        }
+    }
 
     for (const ChannelHandleAndGroup& inputChannel : activeInputChannels) {
         if (kEffectDebugOutput) {
@@ -107,10 +121,10 @@ void LV2EffectProcessor::process(const ChannelHandle& inputHandle,
                        << "Handle should have been preallocated in the"
                           "main thread.";
         }
-        pState = createGroupState(bufferParameters);
-        m_channelStateMatrix[inputHandle][outputHandle] = pState;
     }
 
+    // Allocating the state here would block the audio engine thread, so the
+    // signal passes through unprocessed.
     if (!pState) {
         SampleUtil::copyWithGain(pOutput, pInput, 1.0, bufferParameters.samplesPerBuffer());
         return;
@@ -166,7 +180,7 @@ EffectState* LV2EffectProcessor::createState(const mixxx::EngineParameters& buff
 };
 
 bool LV2EffectProcessor::loadStatesForInputChannel(const ChannelHandle* inputChannel,
-      const EffectStatesMap* pStatesMap) {
+      EffectStatesMap* pStatesMap) {
     if (kEffectDebugOutput) {
         qDebug() << "LV2EffectProcessor::loadStatesForInputChannel" << this
                  << "input" << *inputChannel;
@@ -180,23 +194,10 @@ bool LV2EffectProcessor::loadStatesForInputChannel(const ChannelHandle* inputCha
 
     // Can't directly cast a ChannelHandleMap from containing the base
     // EffectState* type to EffectSpecificState* type, so iterate through
-    // pStatesMap to build a new ChannelHandleMap with
-    // dynamic_cast'ed states.
+    // pStatesMap and swap the dynamic_cast'ed states into the matrix.
     ChannelHandleMap<LV2EffectGroupState*>& effectSpecificStatesMap =
             m_channelStateMatrix[*inputChannel];
 
-    // deleteStatesForInputChannel should have been called before a new
-    // map of EffectStates was sent to this function, or this is the first
-    // time states are being loaded for this input channel, so
-    // effectSpecificStatesMap should be empty and this loop should
-    // not go through any iterations.
-    for (LV2EffectGroupState* pState : effectSpecificStatesMap) {
-        VERIFY_OR_DEBUG_ASSERT(pState == nullptr) {
-            delete pState;
-            qDebug() << "for effectSpecificStatesMap";
-        }
-    }
-
     for (const ChannelHandleAndGroup& outputChannel :
             m_pEffectsManager->registeredOutputChannels()) {
         if (kEffectDebugOutput) {
@@ -204,12 +205,20 @@ bool LV2EffectProcessor::loadStatesForInputChannel(const ChannelHandle* inputCha
                      << this << "output" << outputChannel;
         }
 
-        auto pState = dynamic_cast<LV2EffectGroupState*>(
-                  pStatesMap->at(outputChannel.handle()));
+        EffectState*& pRequestState = (*pStatesMap)[outputChannel.handle()];
+        auto pState = dynamic_cast<LV2EffectGroupState*>(pRequestState);
         VERIFY_OR_DEBUG_ASSERT(pState != nullptr) {
               return false;
         }
-        effectSpecificStatesMap.insert(outputChannel.handle(), pState);
+        // deleteStatesForInputChannel should have been called before a new
+        // map of EffectStates was sent to this function, so there should be
+        // no previous state. Otherwise it is handed back with the request to
+        // be deleted in the main thread.
+        LV2EffectGroupState*& pLoadedState =
+                effectSpecificStatesMap[outputChannel.handle()];
+        DEBUG_ASSERT(pLoadedState == nullptr);
+        pRequestState = pLoadedState;
+        pLoadedState = pState;
     }
     return true;
 }
@@ -230,8 +239,8 @@ void LV2EffectProcessor::deleteStatesForInputChannel(const ChannelHandle* inputC
 
     ChannelHandleMap<LV2EffectGroupState*>& stateMap =
             m_channelStateMatrix[*inputChannel];
-    for (LV2EffectGroupState* pState : stateMap) {
-          VERIFY_OR_DEBUG_ASSERT(pState != nullptr) {
+    for (LV2EffectGroupState*& pState : stateMap) {
+          if (pState == nullptr) {
                 continue;
           }
           if (kEffectDebugOutput) {
@@ -239,7 +248,8 @@ void LV2EffectProcessor::deleteStatesForInputChannel(const ChannelHandle* inputC
                          << this << "deleting state" << pState;
           }
           delete pState;
-          qDebug() << "inputChannel" << inputChannel;
+          // Keep the slot, so loading states again does not need to resize
+          // the map in the audio engine thread.
+          pState = nullptr;
     }
-    stateMap.clear();
 }
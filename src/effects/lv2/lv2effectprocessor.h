@@ -41,7 +41,7 @@ class LV2EffectProcessor : public EffectProcessor {
             const mixxx::EngineParameters& bufferParameters) override;
     EffectState* createState(const mixxx::EngineParameters& bufferParameters) final;
     bool loadStatesForInputChannel(const ChannelHandle* inputChannel,
-          const EffectStatesMap* pStatesMap) override;
+          EffectStatesMap* pStatesMap) override;
     // Called from main thread for garbage collection after the last audio thread
     // callback executes process() with EffectEnableState::Disabling
     void deleteStatesForInputChannel(const ChannelHandle* inputChannel) override;
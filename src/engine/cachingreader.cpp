@@ -3,9 +3,10 @@
 
 #include "engine/cachingreader.h"
 #include "control/controlobject.h"
+#include "engine/decodedsamplecache.h"
 #include "track/track.h"
 #include "util/assert.h"
-#include "util/counter.h"
+#include "util/compatibility.h"
 #include "util/math.h"
 #include "util/sample.h"
 #include "util/logger.h"
@@ -20,13 +21,81 @@ mixxx::Logger kLogger("CachingReader");
 // TODO() Do we suffer cache misses if we use an audio buffer of above 23 ms?
 const SINT kDefaultHintFrames = 1024;
 
-// currently CachingReaderWorker::kCachingReaderChunkLength is 65536 (0x10000);
-// For 80 chunks we need 5242880 (0x500000) bytes (5 MiB) of Memory
-//static
-const SINT kNumberOfCachedChunksInMemory = 80;
+// currently CachingReaderChunk::kSamples * sizeof(CSAMPLE) is 65536 (0x10000);
+// For 256 chunks we need 16777216 (0x1000000) bytes (16 MiB) of Memory
+const SINT kMaxNumberOfCachedChunksInMemory = 256;
+
+// The number of chunks an idle reader keeps in memory (2 MiB)
+const SINT kMinNumberOfCachedChunksInMemory = 32;
+
+// Additional chunks on top of the read-ahead chunks that are needed for
+// reading ahead without evicting the read-ahead chunks.
+const SINT kNumberOfSpareChunks = 8;
+
+// The budget that is shared by all active readers. 768 chunks (48 MiB) allow
+// 3 decks to play with the maximum number of chunks each.
+const int kDefaultMemoryBudgetMiB = 48;
+
+const ConfigKey kMemoryBudgetConfigKey("[Master]", "caching_reader_memory_budget_mb");
+
+SINT chunksForMiB(int mib) {
+    const SINT bytesPerChunk = CachingReaderChunk::kSamples * sizeof(CSAMPLE);
+    return static_cast<SINT>((static_cast<qint64>(mib) << 20) / bytesPerChunk);
+}
+
+// The number of chunks shared by all active readers
+QAtomicInt s_chunkBudget(chunksForMiB(kDefaultMemoryBudgetMiB));
+
+// The sum of the activity weights of all readers
+QAtomicInt s_totalActivityWeight(0);
+
+// Replaces the special frame counts of a hint
+Hint normalizeHint(Hint hint) {
+    if (hint.frameCount == Hint::kFrameCountForward) {
+        hint.frameCount = kDefaultHintFrames;
+    } else if (hint.frameCount == Hint::kFrameCountBackward) {
+        hint.frame -= kDefaultHintFrames;
+        hint.frameCount = kDefaultHintFrames;
+        if (hint.frame < 0) {
+            hint.frameCount += hint.frame;
+            hint.frame = 0;
+        }
+    }
+    return hint;
+}
+
+int weightForActivity(CachingReader::Activity activity) {
+    switch (activity) {
+    case CachingReader::Activity::PLAYING:
+        return 1;
+    case CachingReader::Activity::SCRATCHING:
+        // Scratching jumps back and forth and touches more chunks
+        return 2;
+    case CachingReader::Activity::IDLE:
+    default:
+        return 0;
+    }
+}
 
 } // anonymous namespace
 
+//static
+void CachingReader::setChunkBudget(SINT chunkBudget) {
+    s_chunkBudget.fetchAndStoreRelaxed(
+            static_cast<int>(math_max(chunkBudget, SINT(0))));
+}
+
+//static
+void CachingReader::setChunkBudgetFromConfig(UserSettingsPointer pConfig) {
+    setChunkBudget(chunksForMiB(pConfig->getValue(
+            kMemoryBudgetConfigKey, kDefaultMemoryBudgetMiB)));
+}
+
+//static
+SINT CachingReader::getChunkBudget() {
+    return load_atomic(s_chunkBudget);
+}
+
 
 CachingReader::CachingReader(QString group,
                              UserSettingsPointer config)
@@ -34,16 +103,31 @@ CachingReader::CachingReader(QString group,
           m_chunkReadRequestFIFO(1024),
           m_readerStatusFIFO(1024),
           m_readerStatus(INVALID),
+          m_allocatedCachingReaderChunks(kMaxNumberOfCachedChunksInMemory),
+          m_activity(Activity::IDLE),
+          m_activityWeight(0),
+          m_readAheadChunkCount(0),
+          m_targetChunkCount(kMinNumberOfCachedChunksInMemory),
+          m_cacheHits(0),
+          m_cacheMisses(0),
+          m_cacheEvictions(0),
+          m_cacheHitCounter(QString("CachingReader %1 cache hits").arg(group)),
+          m_cacheMissCounter(QString("CachingReader %1 cache misses").arg(group)),
+          m_cacheEvictionCounter(QString("CachingReader %1 cache evictions").arg(group)),
           m_mruCachingReaderChunk(nullptr),
           m_lruCachingReaderChunk(nullptr),
-          m_sampleBuffer(CachingReaderChunk::kSamples * kNumberOfCachedChunksInMemory),
+          m_sampleBuffer(CachingReaderChunk::kSamples * kMaxNumberOfCachedChunksInMemory),
+          m_pDecodedSample(nullptr),
           m_worker(group, &m_chunkReadRequestFIFO, &m_readerStatusFIFO) {
 
-    m_allocatedCachingReaderChunks.reserve(kNumberOfCachedChunksInMemory);
+    m_chunks.reserve(kMaxNumberOfCachedChunksInMemory);
+    m_freeChunks.reserve(kMaxNumberOfCachedChunksInMemory);
     // Divide up the allocated raw memory buffer into total_chunks
     // chunks. Initialize each chunk to hold nothing and add it to the free
-    // list.
-    for (SINT i = 0; i < kNumberOfCachedChunksInMemory; ++i) {
+    // list. The sample buffer is not initialized and memory pages only
+    // become resident when the corresponding chunk is filled for the
+    // first time.
+    for (SINT i = 0; i < kMaxNumberOfCachedChunksInMemory; ++i) {
         CachingReaderChunkForOwner* c =
                 new CachingReaderChunkForOwner(
                         mixxx::SampleBuffer::WritableSlice(
@@ -70,7 +154,67 @@ CachingReader::CachingReader(QString group,
 
 CachingReader::~CachingReader() {
     m_worker.quitWait();
+    // Release the pins of all decoded samples that are still in the FIFO
+    process();
+    setDecodedSample(nullptr);
     qDeleteAll(m_chunks);
+    s_totalActivityWeight.fetchAndAddOrdered(-m_activityWeight);
+}
+
+void CachingReader::setActivity(Activity activity) {
+    if (m_activity == activity) {
+        return;
+    }
+    m_activity = activity;
+    updateActivityWeight();
+}
+
+void CachingReader::updateActivityWeight() {
+    // Tracks that are read from memory don't need any chunks
+    const int activityWeight =
+            m_pDecodedSample ? 0 : weightForActivity(m_activity);
+    s_totalActivityWeight.fetchAndAddOrdered(activityWeight - m_activityWeight);
+    m_activityWeight = activityWeight;
+}
+
+void CachingReader::setDecodedSample(const DecodedSample* pDecodedSample) {
+    if (m_pDecodedSample) {
+        m_pDecodedSample->unpin();
+    }
+    m_pDecodedSample = pDecodedSample;
+    updateActivityWeight();
+}
+
+void CachingReader::updateTargetChunkCount() {
+    SINT targetChunkCount = kMinNumberOfCachedChunksInMemory;
+    if (m_activityWeight > 0) {
+        const int totalActivityWeight =
+                math_max(load_atomic(s_totalActivityWeight), m_activityWeight);
+        targetChunkCount = math_max(targetChunkCount,
+                getChunkBudget() * m_activityWeight / totalActivityWeight);
+    }
+    // Never shrink below the number of read-ahead chunks. Otherwise we would
+    // evict them and read them again in every callback. Prefetch hints don't
+    // enlarge the cache.
+    targetChunkCount = math_max(targetChunkCount,
+            m_readAheadChunkCount + kNumberOfSpareChunks);
+    m_targetChunkCount = math_min(targetChunkCount,
+            kMaxNumberOfCachedChunksInMemory);
+}
+
+void CachingReader::reportCounters() {
+    if (m_cacheHits > 0) {
+        m_cacheHitCounter += m_cacheHits;
+        m_cacheHits = 0;
+    }
+    if (m_cacheMisses > 0) {
+        m_cacheMissCounter += m_cacheMisses;
+        m_cacheMisses = 0;
+    }
+    if (m_cacheEvictions > 0) {
+        m_cacheEvictionCounter += m_cacheEvictions;
+        m_cacheEvictions = 0;
+    }
 }
 
 void CachingReader::freeChunk(CachingReaderChunkForOwner* pChunk) {
@@ -109,10 +253,11 @@ void CachingReader::freeAllChunks() {
 }
 
 CachingReaderChunkForOwner* CachingReader::allocateChunk(SINT chunkIndex) {
-    if (m_freeChunks.isEmpty()) {
+    if (m_freeChunks.empty()) {
         return nullptr;
     }
-    CachingReaderChunkForOwner* pChunk = m_freeChunks.takeFirst();
+    CachingReaderChunkForOwner* pChunk = m_freeChunks.back();
+    m_freeChunks.pop_back();
     pChunk->init(chunkIndex);
 
     //kLogger.debug() << "Allocating chunk" << pChunk << pChunk->getIndex();
@@ -122,22 +267,55 @@ CachingReaderChunkForOwner* CachingReader::allocateChunk(SINT chunkIndex) {
 }
 
 CachingReaderChunkForOwner* CachingReader::allocateChunkExpireLRU(SINT chunkIndex) {
-    CachingReaderChunkForOwner* pChunk = allocateChunk(chunkIndex);
+    CachingReaderChunkForOwner* pChunk = nullptr;
+    if (m_allocatedCachingReaderChunks.size() < m_targetChunkCount) {
+        pChunk = allocateChunk(chunkIndex);
+    }
     if (!pChunk) {
         if (m_lruCachingReaderChunk == nullptr) {
-            kLogger.warning() << "ERROR: No LRU chunk to free in allocateChunkExpireLRU.";
-            return nullptr;
+            // All allocated chunks are pending. Exceed the target number
+            // of chunks instead of failing if there are still free chunks.
+            pChunk = allocateChunk(chunkIndex);
+            if (!pChunk) {
+                kLogger.warning() << "ERROR: No LRU chunk to free in allocateChunkExpireLRU.";
+            }
+            return pChunk;
         }
         freeChunk(m_lruCachingReaderChunk);
+        ++m_cacheEvictions;
         pChunk = allocateChunk(chunkIndex);
     }
     //kLogger.debug() << "allocateChunkExpireLRU" << chunk << pChunk;
     return pChunk;
 }
 
+bool CachingReader::expireLRUChunksAboveTarget() {
+    bool releaseRequested = false;
+    while ((m_allocatedCachingReaderChunks.size() > m_targetChunkCount) &&
+            (m_lruCachingReaderChunk != nullptr)) {
+        CachingReaderChunkForOwner* pChunk = m_lruCachingReaderChunk;
+        ++m_cacheEvictions;
+        // Releasing the memory is a system call, which must not be done
+        // in the engine callback
+        m_allocatedCachingReaderChunks.remove(pChunk->getIndex());
+        pChunk->removeFromList(
+                &m_mruCachingReaderChunk, &m_lruCachingReaderChunk);
+        CachingReaderChunkReadRequest request;
+        request.giveToWorkerForRelease(pChunk);
+        if (m_chunkReadRequestFIFO.write(&request, 1) == 1) {
+            releaseRequested = true;
+        } else {
+            // Keep the memory and free the chunk right away
+            pChunk->takeFromWorker();
+            freeChunk(pChunk);
+        }
+    }
+    return releaseRequested;
+}
+
 CachingReaderChunkForOwner* CachingReader::lookupChunk(SINT chunkIndex) {
-    // Defaults to nullptr if it's not in the hash.
-    CachingReaderChunkForOwner* chunk = m_allocatedCachingReaderChunks.value(chunkIndex, nullptr);
+    // Defaults to nullptr if it's not in the index.
+    CachingReaderChunkForOwner* chunk = m_allocatedCachingReaderChunks.value(chunkIndex);
 
     // Make sure the allocated number matches the indexed chunk number.
     DEBUG_ASSERT(chunk == nullptr || chunkIndex == chunk->getIndex());
@@ -201,8 +379,10 @@ void CachingReader::process() {
         }
         if (status.status == TRACK_NOT_LOADED) {
             m_readerStatus = status.status;
+            setDecodedSample(nullptr);
         } else if (status.status == TRACK_LOADED) {
             m_readerStatus = status.status;
+            setDecodedSample(status.decodedSample);
             // Reset the max. readable frame index
             m_readableFrameIndexRange = status.readableFrameIndexRange();
             // Free all chunks with sample data from a previous track
@@ -263,6 +443,10 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
     // the first chunk and to update m_readableFrameIndexRange
     process();
 
+    if (m_pDecodedSample) {
+        return readDecodedSample(startSample, numSamples, reverse, buffer);
+    }
+
     auto remainingFrameIndexRange =
             mixxx::IndexRange::forward(
                     CachingReaderChunk::samples2frames(sample),
@@ -348,6 +532,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
                 mixxx::IndexRange bufferedFrameIndexRange;
                 const CachingReaderChunkForOwner* const pChunk = lookupChunkAndFreshen(chunkIndex);
                 if (pChunk && (pChunk->getState() == CachingReaderChunkForOwner::READY)) {
+                    ++m_cacheHits;
                     if (reverse) {
                         bufferedFrameIndexRange =
                                 pChunk->readBufferedSampleFramesReverse(
@@ -365,7 +550,7 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
                     // pending.
                     DEBUG_ASSERT(!pChunk ||
                             (pChunk->getState() == CachingReaderChunkForOwner::READ_PENDING));
-                    Counter("CachingReader::read(): Failed to read chunk on cache miss")++;
+                    ++m_cacheMisses;
                     if (kLogger.traceEnabled()) {
                         kLogger.trace()
                                 << "Cache miss for chunk with index"
@@ -431,40 +616,101 @@ CachingReader::ReadResult CachingReader::read(SINT startSample, SINT numSamples,
     return result;
 }
 
+CachingReader::ReadResult CachingReader::readDecodedSample(
+        SINT startSample, SINT numSamples, bool reverse, CSAMPLE* buffer) {
+    DEBUG_ASSERT(m_pDecodedSample);
+    const SINT firstSample = reverse ? startSample - numSamples : startSample;
+    const auto frameIndexRange =
+            mixxx::IndexRange::forward(
+                    CachingReaderChunk::samples2frames(firstSample),
+                    CachingReaderChunk::samples2frames(numSamples));
+    const auto decodedFrameIndexRange = m_pDecodedSample->frameIndexRange();
+    const auto copyableFrameIndexRange =
+            intersect(frameIndexRange, decodedFrameIndexRange);
+    auto result = ReadResult::AVAILABLE;
+    if (copyableFrameIndexRange != frameIndexRange) {
+        // Preroll or beyond the end of the track
+        SampleUtil::clear(buffer, numSamples);
+        result = ReadResult::PARTIALLY_AVAILABLE;
+    }
+    if (copyableFrameIndexRange.empty()) {
+        return result;
+    }
+    ++m_cacheHits;
+    const SINT dstSampleOffset = CachingReaderChunk::frames2samples(
+            copyableFrameIndexRange.start() - frameIndexRange.start());
+    const SINT srcSampleOffset = CachingReaderChunk::frames2samples(
+            copyableFrameIndexRange.start() - decodedFrameIndexRange.start());
+    const SINT sampleCount =
+            CachingReaderChunk::frames2samples(copyableFrameIndexRange.length());
+    if (reverse) {
+        SampleUtil::copyReverse(
+                buffer + numSamples - dstSampleOffset - sampleCount,
+                m_pDecodedSample->data() + srcSampleOffset,
+                sampleCount);
+    } else {
+        SampleUtil::copy(
+                buffer + dstSampleOffset,
+                m_pDecodedSample->data() + srcSampleOffset,
+                sampleCount);
+    }
+    return result;
+}
+
 void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
     // If no file is loaded, skip.
     if (m_readerStatus != TRACK_LOADED) {
+        reportCounters();
         return;
     }
 
-    // For every chunk that the hints indicated, check if it is in the cache. If
-    // any are not, then wake.
-    bool shouldWake = false;
+    // Everything is in memory, nothing to read
+    if (m_pDecodedSample) {
+        reportCounters();
+        return;
+    }
 
+    // The readable frames of the normalized hints, empty for invalid hints
+    // and for hints that are not readable. Preallocated like the HintVector,
+    // so it doesn't allocate.
+    QVarLengthArray<mixxx::IndexRange, 512> hintedFrameIndexRanges;
+    SINT readAheadChunkCount = 0;
     for (const auto& hint: hintList) {
-        SINT hintFrame = hint.frame;
-        SINT hintFrameCount = hint.frameCount;
-
-        // Handle some special length values
-        if (hintFrameCount == Hint::kFrameCountForward) {
-        	hintFrameCount = kDefaultHintFrames;
-        } else if (hintFrameCount == Hint::kFrameCountBackward) {
-        	hintFrame -= kDefaultHintFrames;
-        	hintFrameCount = kDefaultHintFrames;
-            if (hintFrame < 0) {
-            	hintFrameCount += hintFrame;
-                hintFrame = 0;
-            }
-        }
-
-        VERIFY_OR_DEBUG_ASSERT(hintFrameCount > 0) {
+        const Hint normalizedHint = normalizeHint(hint);
+        VERIFY_OR_DEBUG_ASSERT(normalizedHint.frameCount > 0) {
             kLogger.warning() << "ERROR: Negative hint length. Ignoring.";
+            hintedFrameIndexRanges.append(mixxx::IndexRange());
             continue;
         }
-
         const auto readableFrameIndexRange = intersect(
                 m_readableFrameIndexRange,
-                mixxx::IndexRange::forward(hintFrame, hintFrameCount));
+                mixxx::IndexRange::forward(
+                        normalizedHint.frame, normalizedHint.frameCount));
+        hintedFrameIndexRanges.append(readableFrameIndexRange);
+        if (!readableFrameIndexRange.empty() &&
+                (hint.priority < Hint::kPriorityPrefetch)) {
+            // Overlapping hints are counted multiple times. This is
+            // acceptable because the count is only used as a lower bound
+            // for the cache size.
+            readAheadChunkCount +=
+                    CachingReaderChunk::indexForFrame(readableFrameIndexRange.end() - 1) -
+                    CachingReaderChunk::indexForFrame(readableFrameIndexRange.start()) + 1;
+        }
+    }
+    m_readAheadChunkCount = readAheadChunkCount;
+
+    // Adjust the size of the cache before allocating new chunks
+    updateTargetChunkCount();
+    bool shouldWake = expireLRUChunksAboveTarget();
+
+    // The room in the cache that is left for prefetching
+    SINT prefetchChunksLeft = m_targetChunkCount - m_readAheadChunkCount;
+
+    // For every chunk that the hints indicated, check if it is in the cache. If
+    // any are not, then wake.
+    for (int i = 0; i < hintList.size(); ++i) {
+        const Hint& hint = hintList[i];
+        const auto& readableFrameIndexRange = hintedFrameIndexRanges[i];
         if (readableFrameIndexRange.empty()) {
             continue;
         }
@@ -472,8 +718,21 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
         const int firstChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.start());
         const int lastChunkIndex = CachingReaderChunk::indexForFrame(readableFrameIndexRange.end() - 1);
         for (int chunkIndex = firstChunkIndex; chunkIndex <= lastChunkIndex; ++chunkIndex) {
+            if (hint.priority >= Hint::kPriorityPrefetch) {
+                // Prefetch hints must not evict the read-ahead chunks or
+                // the chunks of preceding prefetch hints from the cache.
+                if (prefetchChunksLeft <= 0) {
+                    break;
+                }
+                --prefetchChunksLeft;
+            }
             CachingReaderChunkForOwner* pChunk = lookupChunk(chunkIndex);
             if (pChunk == nullptr) {
+                if ((hint.priority >= Hint::kPriorityPrefetch) &&
+                        (m_allocatedCachingReaderChunks.size() >= m_targetChunkCount)) {
+                    // Only read-ahead chunks may evict other chunks
+                    continue;
+                }
                 shouldWake = true;
                 pChunk = allocateChunkExpireLRU(chunkIndex);
                 if (pChunk == nullptr) {
@@ -506,4 +765,6 @@ void CachingReader::hintAndMaybeWake(const HintVector& hintList) {
     if (shouldWake) {
         m_worker.workReady();
     }
+
+    reportCounters();
 }
@@ -7,15 +7,17 @@
 #include <QtDebug>
 #include <QList>
 #include <QVector>
-#include <QLinkedList>
-#include <QHash>
 #include <QVarLengthArray>
 
+#include <vector>
+
 #include "util/types.h"
 #include "preferences/usersettings.h"
 #include "track/track.h"
 #include "engine/engineworker.h"
+#include "util/counter.h"
 #include "util/fifo.h"
+#include "engine/cachingreaderchunkindex.h"
 #include "engine/cachingreaderworker.h"
 
 // A Hint is an indication to the CachingReader that a certain section of a
@@ -27,17 +29,20 @@ typedef struct Hint {
     // If a range of frames should be present, use frameCount to indicate that the
     // range (frame, frame + frameCount) should be present in memory.
     SINT frameCount;
-    // Currently unused -- but in the future could be used to prioritize certain
-    // hints over others. A priority of 1 is the highest priority and should be
-    // used for samples that will be read imminently. Hints for samples that
-    // have the potential to be read (i.e. a cue point) should be issued with
-    // priority >10.
+    // A priority of 1 is the highest priority and should be used for samples
+    // that will be read imminently. Hints for samples that have the potential
+    // to be read (i.e. a cue point) should be issued with priority
+    // kPriorityPrefetch or above. Prefetch hints never evict other chunks
+    // from the cache, they are only served while the cache has room for them.
     int priority;
 
     // for the default frame count in forward direction
     static constexpr SINT kFrameCountForward = 0;
     static constexpr SINT kFrameCountBackward = -1;
 
+    static constexpr int kPriorityImmediate = 1;
+    static constexpr int kPriorityPrefetch = 10;
+
 } Hint;
 
 // Note that we use a QVarLengthArray here instead of a QVector. Since this list
@@ -71,6 +76,21 @@ typedef QVarLengthArray<Hint, 512> HintVector;
 // least-recently-used list. When a chunk needs to be allocated and there are no
 // free chunks then the least recently used chunk is free'd (see
 // allocateChunkExpireLRU).
+//
+// The number of chunks that a reader keeps in memory is not fixed. All
+// readers share a global memory budget that is divided among the readers
+// that are currently playing or scratching (see setActivity). Idle readers
+// shrink their cache down to a small minimum. The cache always covers the
+// chunks of the read-ahead hints around the play position, prefetch hints
+// like hotcues only use the room that is left. The memory for the maximum number of chunks is
+// allocated upfront and left uninitialized, i.e. it only becomes resident
+// when a chunk is actually used.
+//
+// Short tracks can be decoded completely into memory when they are loaded
+// (see setDecodeToMemory), which is used for samplers. The decoded samples
+// are shared with all readers that load the same file through the
+// DecodedSampleCache. Reads are then served from memory, no chunks are
+// allocated and the worker is never woken up for hints.
 class CachingReader : public QObject {
     Q_OBJECT
 
@@ -112,6 +132,45 @@ class CachingReader : public QObject {
         m_worker.setScheduler(pScheduler);
     }
 
+    // Tracks that are not longer than maxDuration are decoded completely
+    // into memory when they are loaded, as long as they fit into the budget
+    // of the DecodedSampleCache. Takes effect with the next track.
+    void setDecodeToMemory(mixxx::Duration maxDuration) {
+        m_worker.setDecodeToMemory(maxDuration);
+    }
+
+    // Whether the loaded track is read from memory
+    bool isDecodedToMemory() const {
+        return m_pDecodedSample != nullptr;
+    }
+
+    enum class Activity {
+        IDLE,
+        PLAYING,
+        SCRATCHING,
+    };
+
+    // Informs the reader about the playback state of its deck. Readers of
+    // decks that are playing or scratching get a larger share of the global
+    // chunk budget than idle readers. Must only be called from the engine
+    // callback.
+    void setActivity(Activity activity);
+
+    // The number of chunks that this reader currently tries to keep in
+    // memory.
+    SINT getTargetChunkCount() const {
+        return m_targetChunkCount;
+    }
+
+    // Sets the total number of chunks that all active readers share. The
+    // budget is a soft limit that is applied by each reader when allocating
+    // new chunks.
+    static void setChunkBudget(SINT chunkBudget);
+    // Sets the budget from [Master] caching_reader_memory_budget_mb. This is
+    // done once by the owner of the config and not by each reader.
+    static void setChunkBudgetFromConfig(UserSettingsPointer pConfig);
+    static SINT getChunkBudget();
+
   signals:
     // Emitted once a new track is loaded and ready to be read from.
     void trackLoading();
@@ -119,6 +178,8 @@ class CachingReader : public QObject {
     void trackLoadFailed(TrackPointer pTrack, QString reason);
 
   private:
+    friend class CachingReaderTest;
+
     const UserSettingsPointer m_pConfig;
 
     // Thread-safe FIFOs for communication between the engine callback and
@@ -147,21 +208,63 @@ class CachingReader : public QObject {
     // Gets a chunk from the free list. Returns nullptr if none available.
     CachingReaderChunkForOwner* allocateChunk(SINT chunkIndex);
 
-    // Gets a chunk from the free list, frees the LRU CachingReaderChunk if none available.
+    // Gets a chunk from the free list, frees the LRU CachingReaderChunk if none
+    // available or if the target number of chunks has been reached.
     CachingReaderChunkForOwner* allocateChunkExpireLRU(SINT chunkIndex);
 
+    // Frees LRU chunks until the number of allocated chunks does not exceed
+    // the target number of chunks anymore. The worker releases the memory
+    // of these chunks before they are returned to the free list, so a reader
+    // that became idle doesn't keep the pages of its former target resident.
+    // Returns true if the worker needs to be woken up.
+    bool expireLRUChunksAboveTarget();
+
+    // Recalculates m_targetChunkCount from the global budget, the activity
+    // of this reader and the number of read-ahead chunks.
+    void updateTargetChunkCount();
+
+    // Reports the hit/miss/eviction counters that have been accumulated
+    // since the last call to the StatsManager.
+    void reportCounters();
+
+    // Replaces the samples of the previously loaded track, takes over the
+    // pin of pDecodedSample.
+    void setDecodedSample(const DecodedSample* pDecodedSample);
+
+    // Adjusts the weight of this reader in the global budget
+    void updateActivityWeight();
+
+    ReadResult readDecodedSample(SINT startSample, SINT numSamples,
+            bool reverse, CSAMPLE* buffer);
+
     ReaderStatus m_readerStatus;
 
     // Keeps track of all CachingReaderChunks we've allocated.
     QVector<CachingReaderChunkForOwner*> m_chunks;
 
-    // List of free chunks. Linked list so that we have constant time insertions
-    // and deletions. Iteration is not necessary.
-    QLinkedList<CachingReaderChunkForOwner*> m_freeChunks;
+    // Stack of free chunks. The capacity is reserved upfront for all chunks
+    // so that neither push_back() nor pop_back() will ever allocate.
+    std::vector<CachingReaderChunkForOwner*> m_freeChunks;
 
     // Keeps track of what CachingReaderChunks we've allocated and indexes them based on what
     // chunk number they are allocated to.
-    QHash<int, CachingReaderChunkForOwner*> m_allocatedCachingReaderChunks;
+    CachingReaderChunkIndex m_allocatedCachingReaderChunks;
+
+    Activity m_activity;
+    // The weight of this reader in the global budget, depends on m_activity
+    int m_activityWeight;
+    // The number of chunks of the read-ahead hints of the current callback,
+    // i.e. of all hints with a higher priority than Hint::kPriorityPrefetch
+    SINT m_readAheadChunkCount;
+    SINT m_targetChunkCount;
+
+    // Accumulated counters that are reported once per callback
+    int m_cacheHits;
+    int m_cacheMisses;
+    int m_cacheEvictions;
+    Counter m_cacheHitCounter;
+    Counter m_cacheMissCounter;
+    Counter m_cacheEvictionCounter;
 
     // The linked list of recently-used chunks.
     CachingReaderChunkForOwner* m_mruCachingReaderChunk;
@@ -173,6 +276,10 @@ class CachingReader : public QObject {
     // The readable frame index range as reported by the worker.
     mixxx::IndexRange m_readableFrameIndexRange;
 
+    // The pinned samples of the loaded track if it has been decoded into
+    // memory, otherwise nullptr.
+    const DecodedSample* m_pDecodedSample;
+
     CachingReaderWorker m_worker;
 };
 
@@ -2,6 +2,11 @@
 
 #include <QtDebug>
 
+#if defined(__LINUX__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include "sources/audiosourcestereoproxy.h"
 #include "engine/engine.h"
 #include "util/math.h"
@@ -76,6 +81,29 @@ mixxx::IndexRange CachingReaderChunk::bufferSampleFrames(
     return m_bufferedSampleFrames.frameIndexRange();
 }
 
+void CachingReaderChunk::releaseMemory() {
+#if defined(__LINUX__) || defined(__APPLE__)
+    // Only the pages that are completely inside of the sample buffer
+    const quintptr pageSize = sysconf(_SC_PAGESIZE);
+    const quintptr begin =
+            (reinterpret_cast<quintptr>(m_sampleBuffer.data()) + pageSize - 1) &
+            ~(pageSize - 1);
+    const quintptr end =
+            reinterpret_cast<quintptr>(m_sampleBuffer.data() + m_sampleBuffer.length()) &
+            ~(pageSize - 1);
+    if (begin < end) {
+#if defined(__LINUX__)
+        const int advice = MADV_DONTNEED;
+#else
+        const int advice = MADV_FREE;
+#endif
+        if (madvise(reinterpret_cast<void*>(begin), end - begin, advice) != 0) {
+            kLogger.warning() << "Failed to release the memory of a chunk";
+        }
+    }
+#endif
+}
+
 mixxx::IndexRange CachingReaderChunk::readBufferedSampleFrames(
         CSAMPLE* sampleBuffer,
         const mixxx::IndexRange& frameIndexRange) const {
@@ -131,6 +159,12 @@ void CachingReaderChunkForOwner::init(SINT index) {
     m_state = READY;
 }
 
+void CachingReaderChunkForOwner::giveToWorkerForRelease() {
+    DEBUG_ASSERT(READY == m_state);
+    CachingReaderChunk::init(kInvalidChunkIndex);
+    m_state = READ_PENDING;
+}
+
 void CachingReaderChunkForOwner::free() {
     DEBUG_ASSERT(READ_PENDING != m_state);
     CachingReaderChunk::init(kInvalidChunkIndex);
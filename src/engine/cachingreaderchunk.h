@@ -57,6 +57,11 @@ public:
             const mixxx::AudioSourcePointer& pAudioSource,
             mixxx::SampleBuffer::WritableSlice tempOutputBuffer);
 
+    // Returns the memory pages of the sample buffer to the operating
+    // system. They are zero-filled when the chunk is used again. Only
+    // called by the worker thread, because it may block.
+    void releaseMemory();
+
     mixxx::IndexRange readBufferedSampleFrames(
             CSAMPLE* sampleBuffer,
             const mixxx::IndexRange& frameIndexRange) const;
@@ -111,6 +116,9 @@ public:
         DEBUG_ASSERT(READY == m_state);
         m_state = READ_PENDING;
     }
+    // Gives a chunk that is neither indexed nor in the MRU/LRU list to the
+    // worker for releasing its memory. It is returned without an index.
+    void giveToWorkerForRelease();
     void takeFromWorker() {
         DEBUG_ASSERT(READ_PENDING == m_state);
         m_state = READY;
@@ -0,0 +1,147 @@
+#ifndef ENGINE_CACHINGREADERCHUNKINDEX_H
+#define ENGINE_CACHINGREADERCHUNKINDEX_H
+
+#include <vector>
+
+#include "engine/cachingreaderchunk.h"
+#include "util/assert.h"
+
+// Maps chunk indices onto the in-memory chunks of a CachingReader.
+//
+// The index has a fixed capacity that is allocated upfront in the constructor.
+// Lookups, insertions and removals never allocate memory and are safe to be
+// used from the engine callback thread. Keys are stored in an open-addressed
+// table with linear probing. Removals use backward shift deletion instead of
+// tombstones so probe sequences stay short even after many evictions.
+class CachingReaderChunkIndex {
+  public:
+    explicit CachingReaderChunkIndex(int maxSize)
+            : m_mask(slotCountForMaxSize(maxSize) - 1),
+              m_shift(32 - log2(m_mask + 1)),
+              m_size(0),
+              m_maxSize(maxSize) {
+        m_slots.resize(m_mask + 1);
+    }
+
+    int size() const {
+        return m_size;
+    }
+
+    int maxSize() const {
+        return m_maxSize;
+    }
+
+    bool isEmpty() const {
+        return m_size == 0;
+    }
+
+    // Returns nullptr if no chunk is stored for the given index.
+    CachingReaderChunkForOwner* value(SINT chunkIndex) const {
+        const int slot = findSlot(chunkIndex);
+        return m_slots[slot].pChunk;
+    }
+
+    // The chunk must not already be present in the index.
+    void insert(SINT chunkIndex, CachingReaderChunkForOwner* pChunk) {
+        DEBUG_ASSERT(chunkIndex >= 0);
+        DEBUG_ASSERT(pChunk != nullptr);
+        VERIFY_OR_DEBUG_ASSERT(m_size < m_maxSize) {
+            return;
+        }
+        const int slot = findSlot(chunkIndex);
+        DEBUG_ASSERT(m_slots[slot].pChunk == nullptr);
+        m_slots[slot].chunkIndex = chunkIndex;
+        m_slots[slot].pChunk = pChunk;
+        ++m_size;
+    }
+
+    // Returns the number of removed entries, i.e. 0 or 1.
+    int remove(SINT chunkIndex) {
+        int slot = findSlot(chunkIndex);
+        if (m_slots[slot].pChunk == nullptr) {
+            return 0;
+        }
+        // Backward shift deletion: Move all following entries of the
+        // cluster that are not located in their home slot one slot
+        // towards it until an empty slot is reached.
+        int next = (slot + 1) & m_mask;
+        while (m_slots[next].pChunk != nullptr) {
+            const int home = homeSlot(m_slots[next].chunkIndex);
+            // Move the entry unless its home slot is located cyclically
+            // in the range (slot, next].
+            const bool keep = (slot <= next) ?
+                    ((slot < home) && (home <= next)) :
+                    ((slot < home) || (home <= next));
+            if (!keep) {
+                m_slots[slot] = m_slots[next];
+                slot = next;
+            }
+            next = (next + 1) & m_mask;
+        }
+        m_slots[slot] = Slot();
+        --m_size;
+        return 1;
+    }
+
+    void clear() {
+        for (auto& slot: m_slots) {
+            slot = Slot();
+        }
+        m_size = 0;
+    }
+
+  private:
+    struct Slot {
+        Slot()
+                : chunkIndex(-1),
+                  pChunk(nullptr) {
+        }
+        SINT chunkIndex;
+        CachingReaderChunkForOwner* pChunk;
+    };
+
+    // Keep the load factor at or below 0.5
+    static int slotCountForMaxSize(int maxSize) {
+        int slotCount = 2;
+        while (slotCount < 2 * maxSize) {
+            slotCount *= 2;
+        }
+        return slotCount;
+    }
+
+    static int log2(int slotCount) {
+        int bits = 0;
+        while ((1 << bits) < slotCount) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    int homeSlot(SINT chunkIndex) const {
+        // Fibonacci hashing spreads the consecutive chunk indices of
+        // a playing region evenly across the table. The top bits of the
+        // product are the well-mixed ones.
+        return static_cast<int>(
+                (static_cast<quint32>(chunkIndex) * 2654435769u) >> m_shift);
+    }
+
+    // Returns either the slot that contains the given chunk index or
+    // the empty slot where it would be inserted.
+    int findSlot(SINT chunkIndex) const {
+        int slot = homeSlot(chunkIndex);
+        while ((m_slots[slot].pChunk != nullptr) &&
+                (m_slots[slot].chunkIndex != chunkIndex)) {
+            slot = (slot + 1) & m_mask;
+        }
+        return slot;
+    }
+
+    std::vector<Slot> m_slots;
+    const int m_mask;
+    // 32 - log2(slot count)
+    const int m_shift;
+    int m_size;
+    const int m_maxSize;
+};
+
+#endif // ENGINE_CACHINGREADERCHUNKINDEX_H
@@ -1,14 +1,21 @@
 #include <QtDebug>
+#include <QDateTime>
 #include <QFileInfo>
 #include <QMutexLocker>
 
+#include <limits>
+
 #include "control/controlobject.h"
 
 #include "engine/cachingreaderworker.h"
+#include "engine/decodedsamplecache.h"
+#include "sources/audiosourcestereoproxy.h"
 #include "sources/soundsourceproxy.h"
 #include "util/compatibility.h"
 #include "util/event.h"
 #include "util/logger.h"
+#include "util/math.h"
+#include "util/memory.h"
 
 
 namespace {
@@ -26,6 +33,7 @@ CachingReaderWorker::CachingReaderWorker(
           m_pChunkReadRequestFIFO(pChunkReadRequestFIFO),
           m_pReaderStatusFIFO(pReaderStatusFIFO),
           m_newTrackAvailable(false),
+          m_decodeToMemoryMaxMillis(0),
           m_stop(0) {
 }
 
@@ -37,6 +45,13 @@ ReaderStatusUpdate CachingReaderWorker::processReadRequest(
     CachingReaderChunk* pChunk = request.chunk;
     DEBUG_ASSERT(pChunk);
 
+    if (request.release) {
+        pChunk->releaseMemory();
+        ReaderStatusUpdate result;
+        result.init(CHUNK_RELEASED, pChunk, m_readableFrameIndexRange);
+        return result;
+    }
+
     // Before trying to read any data we need to check if the audio source
     // is available and if any audio data that is needed by the chunk is
     // actually available.
@@ -91,6 +106,71 @@ void CachingReaderWorker::newTrack(TrackPointer pTrack) {
     m_newTrackAvailable = true;
 }
 
+void CachingReaderWorker::setDecodeToMemory(mixxx::Duration maxDuration) {
+    m_decodeToMemoryMaxMillis.fetchAndStoreRelaxed(static_cast<int>(
+            math_min(maxDuration.toIntegerMillis(),
+                    static_cast<qint64>(std::numeric_limits<int>::max()))));
+}
+
+const DecodedSample* CachingReaderWorker::decodeToMemory(const QString& location) {
+    const qint64 maxMillis = load_atomic(m_decodeToMemoryMaxMillis);
+    const auto frameIndexRange = m_pAudioSource->frameIndexRange();
+    if ((maxMillis <= 0) || frameIndexRange.empty() ||
+            (frameIndexRange.length() >
+                    maxMillis * m_pAudioSource->sampleRate() / 1000)) {
+        return nullptr;
+    }
+
+    // Loaded by another sampler before
+    const DecodedSample* pCachedSample = DecodedSampleCache::acquire(location);
+    if (pCachedSample) {
+        return pCachedSample;
+    }
+
+    const qint64 sizeInBytes =
+            CachingReaderChunk::frames2samples(frameIndexRange.length()) *
+            static_cast<qint64>(sizeof(CSAMPLE));
+    if (!DecodedSampleCache::fitsIntoMemoryBudget(sizeInBytes)) {
+        return nullptr;
+    }
+
+    const QFileInfo fileInfo(location);
+    auto pSample = std::make_unique<DecodedSample>(
+            location,
+            fileInfo.size(),
+            fileInfo.lastModified().toMSecsSinceEpoch(),
+            frameIndexRange);
+    mixxx::AudioSourceStereoProxy audioSourceProxy(
+            m_pAudioSource,
+            mixxx::SampleBuffer::WritableSlice(m_tempReadBuffer));
+    for (SINT frameIndex = frameIndexRange.start();
+            frameIndex < frameIndexRange.end();
+            frameIndex += CachingReaderChunk::kFrames) {
+        const auto readFrameIndexRange = intersect(
+                mixxx::IndexRange::forward(frameIndex, CachingReaderChunk::kFrames),
+                frameIndexRange);
+        const auto readableSampleFrames = audioSourceProxy.readSampleFrames(
+                mixxx::WritableSampleFrames(
+                        readFrameIndexRange,
+                        mixxx::SampleBuffer::WritableSlice(
+                                pSample->writableData(
+                                        CachingReaderChunk::frames2samples(
+                                                frameIndex - frameIndexRange.start())),
+                                CachingReaderChunk::frames2samples(
+                                        readFrameIndexRange.length()))));
+        if (readableSampleFrames.frameIndexRange() != readFrameIndexRange) {
+            // Reading chunks copes with decoding errors
+            kLogger.warning()
+                    << "Failed to decode"
+                    << location
+                    << "into memory at frame index range"
+                    << readFrameIndexRange;
+            return nullptr;
+        }
+    }
+    return DecodedSampleCache::insert(std::move(pSample));
+}
+
 void CachingReaderWorker::run() {
     unsigned static id = 0; //the id of this thread, for debugging purposes
     QThread::currentThread()->setObjectName(QString("CachingReaderWorker %1").arg(++id));
@@ -183,10 +263,25 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     // be decreased to avoid repeated reading of corrupt audio data.
     m_readableFrameIndexRange = m_pAudioSource->frameIndexRange();
 
+    const SINT sampleRate = m_pAudioSource->sampleRate();
+    const SINT sampleCount =
+            CachingReaderChunk::frames2samples(
+                    m_pAudioSource->frameLength());
+
+    const DecodedSample* pDecodedSample = decodeToMemory(filename);
+    if (pDecodedSample) {
+        m_readableFrameIndexRange = pDecodedSample->frameIndexRange();
+        // All samples are read from memory. The file is not needed anymore
+        // and the reader won't send any read requests.
+        m_pAudioSource.reset();
+    }
+
     status.status = TRACK_LOADED;
     status.readableFrameIndexRangeStart = m_readableFrameIndexRange.start();
     status.readableFrameIndexRangeEnd = m_readableFrameIndexRange.end();
+    status.decodedSample = pDecodedSample;
     m_pReaderStatusFIFO->writeBlocking(&status, 1);
+    status.decodedSample = nullptr;
 
     // Clear the chunks to read list.
     CachingReaderChunkReadRequest request;
@@ -198,10 +293,7 @@ void CachingReaderWorker::loadTrack(const TrackPointer& pTrack) {
     }
 
     // Emit that the track is loaded.
-    const SINT sampleCount =
-            CachingReaderChunk::frames2samples(
-                    m_pAudioSource->frameLength());
-    emit(trackLoaded(pTrack, m_pAudioSource->sampleRate(), sampleCount));
+    emit(trackLoaded(pTrack, sampleRate, sampleCount));
 }
 
 void CachingReaderWorker::quitWait() {
@@ -11,18 +11,31 @@
 #include "track/track.h"
 #include "engine/engineworker.h"
 #include "sources/audiosource.h"
+#include "util/duration.h"
 #include "util/fifo.h"
 
+class DecodedSample;
+
 
 // POD with trivial ctor/dtor/copy for passing through FIFO
 typedef struct CachingReaderChunkReadRequest {
     CachingReaderChunk* chunk;
+    // Instead of reading the chunk the worker releases its memory
+    bool release;
 
     void giveToWorker(CachingReaderChunkForOwner* chunkForOwner) {
         DEBUG_ASSERT(chunkForOwner);
         chunk = chunkForOwner;
+        release = false;
         chunkForOwner->giveToWorker();
     }
+
+    void giveToWorkerForRelease(CachingReaderChunkForOwner* chunkForOwner) {
+        DEBUG_ASSERT(chunkForOwner);
+        chunk = chunkForOwner;
+        release = true;
+        chunkForOwner->giveToWorkerForRelease();
+    }
 } CachingReaderChunkReadRequest;
 
 enum ReaderStatus {
@@ -31,7 +44,8 @@ enum ReaderStatus {
     TRACK_LOADED,
     CHUNK_READ_SUCCESS,
     CHUNK_READ_EOF,
-    CHUNK_READ_INVALID
+    CHUNK_READ_INVALID,
+    CHUNK_RELEASED
 };
 
 // POD with trivial ctor/dtor/copy for passing through FIFO
@@ -40,6 +54,9 @@ typedef struct ReaderStatusUpdate {
     CachingReaderChunk* chunk;
     SINT readableFrameIndexRangeStart;
     SINT readableFrameIndexRangeEnd;
+    // Only for TRACK_LOADED: The pinned samples of the whole track if it has
+    // been decoded into memory. The receiver takes over the pin.
+    const DecodedSample* decodedSample;
 
     void init(
             ReaderStatus statusArg = INVALID,
@@ -49,6 +66,7 @@ typedef struct ReaderStatusUpdate {
         chunk = chunkArg;
         readableFrameIndexRangeStart = readableFrameIndexRangeArg.start();
         readableFrameIndexRangeEnd = readableFrameIndexRangeArg.end();
+        decodedSample = nullptr;
     }
 
     mixxx::IndexRange readableFrameIndexRange() const {
@@ -71,6 +89,11 @@ class CachingReaderWorker : public EngineWorker {
     // Request to load a new track. wake() must be called afterwards.
     virtual void newTrack(TrackPointer pTrack);
 
+    // Tracks that are not longer than maxDuration are decoded completely
+    // into the DecodedSampleCache when they are loaded. An empty duration
+    // disables decoding into memory. Takes effect with the next track.
+    void setDecodeToMemory(mixxx::Duration maxDuration);
+
     // Run upkeep operations like loading tracks and reading from file. Run by a
     // thread pool via the EngineWorkerScheduler.
     virtual void run();
@@ -104,6 +127,10 @@ class CachingReaderWorker : public EngineWorker {
     ReaderStatusUpdate processReadRequest(
             const CachingReaderChunkReadRequest& request);
 
+    // Returns the pinned samples of the loaded track if it is short enough
+    // and fits into the memory budget, otherwise nullptr.
+    const DecodedSample* decodeToMemory(const QString& location);
+
     // The current audio source of the track loaded
     mixxx::AudioSourcePointer m_pAudioSource;
 
@@ -118,6 +145,9 @@ class CachingReaderWorker : public EngineWorker {
     // last frame with readable sample data.
     mixxx::IndexRange m_readableFrameIndexRange;
 
+    // The maximum duration of tracks that are decoded into memory
+    QAtomicInt m_decodeToMemoryMaxMillis;
+
     QAtomicInt m_stop;
 };
 
@@ -6,6 +6,7 @@
 
 #include "engine/enginebuffer.h"
 #include "engine/cuecontrol.h"
+#include "engine/readaheadmanager.h"
 
 #include "control/controlobject.h"
 #include "control/controlpushbutton.h"
@@ -544,13 +545,13 @@ void CueControl::hotcuePositionChanged(HotcueControl* pControl, double newPositi
 }
 
 void CueControl::hintReader(HintVector* pHintList) {
-    Hint cue_hint;
+    // The cue point and the hotcues are the most likely jump targets. Keep
+    // the whole read-ahead window after them in the cache to avoid cache
+    // misses right after a jump.
     double cuePoint = m_pCuePoint->get();
     if (cuePoint >= 0) {
-        cue_hint.frame = SampleUtil::floorPlayPosToFrame(m_pCuePoint->get());
-        cue_hint.frameCount = Hint::kFrameCountForward;
-        cue_hint.priority = 10;
-        pHintList->append(cue_hint);
+        ReadAheadManager::hintJumpTarget(
+                cuePoint, false, Hint::kPriorityPrefetch, pHintList);
     }
 
     // this is called from the engine thread
@@ -559,10 +560,8 @@ void CueControl::hintReader(HintVector* pHintList) {
     for (const auto& pControl: m_hotcueControls) {
         double position = pControl->getPosition();
         if (position != -1) {
-            cue_hint.frame = SampleUtil::floorPlayPosToFrame(position);
-            cue_hint.frameCount = Hint::kFrameCountForward;
-            cue_hint.priority = 10;
-            pHintList->append(cue_hint);
+            ReadAheadManager::hintJumpTarget(
+                    position, false, Hint::kPriorityPrefetch, pHintList);
         }
     }
 }
@@ -0,0 +1,168 @@
+#include "engine/decodedsamplecache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <list>
+
+#include "engine/cachingreaderchunk.h"
+#include "util/logger.h"
+#include "util/math.h"
+
+namespace {
+
+const mixxx::Logger kLogger("DecodedSampleCache");
+
+typedef std::list<std::unique_ptr<DecodedSample>> DecodedSampleList;
+
+// Guards all of the following
+QMutex s_mutex;
+qint64 s_memoryBudget = 0;
+qint64 s_memoryUsage = 0;
+// Ordered from the least to the most recently used sample
+DecodedSampleList s_samples;
+
+bool isCurrent(const DecodedSample& sample, const QFileInfo& fileInfo) {
+    return sample.getLocation() == fileInfo.filePath() &&
+            sample.getFileSize() == fileInfo.size() &&
+            sample.getFileModified() == fileInfo.lastModified().toMSecsSinceEpoch();
+}
+
+DecodedSampleList::iterator evict(DecodedSampleList::iterator it) {
+    DEBUG_ASSERT(!(*it)->isPinned());
+    s_memoryUsage -= (*it)->sizeInBytes();
+    return s_samples.erase(it);
+}
+
+// Evicts unpinned samples in LRU order until the usage is within the budget
+void evictAboveBudget(qint64 budget) {
+    auto it = s_samples.begin();
+    while ((s_memoryUsage > budget) && (it != s_samples.end())) {
+        if ((*it)->isPinned()) {
+            ++it;
+        } else {
+            it = evict(it);
+        }
+    }
+}
+
+qint64 pinnedMemoryUsage() {
+    qint64 pinnedBytes = 0;
+    for (const auto& pSample : s_samples) {
+        if (pSample->isPinned()) {
+            pinnedBytes += pSample->sizeInBytes();
+        }
+    }
+    return pinnedBytes;
+}
+
+} // anonymous namespace
+
+DecodedSample::DecodedSample(QString location,
+        qint64 fileSize,
+        qint64 fileModified,
+        mixxx::IndexRange frameIndexRange)
+        : m_location(std::move(location)),
+          m_fileSize(fileSize),
+          m_fileModified(fileModified),
+          m_frameIndexRange(frameIndexRange),
+          m_sampleBuffer(CachingReaderChunk::frames2samples(
+                  frameIndexRange.length())),
+          m_pinCount(0) {
+}
+
+// static
+void DecodedSampleCache::setMemoryBudget(qint64 bytes) {
+    QMutexLocker locker(&s_mutex);
+    s_memoryBudget = math_max(bytes, qint64(0));
+    evictAboveBudget(s_memoryBudget);
+}
+
+// static
+qint64 DecodedSampleCache::memoryBudget() {
+    QMutexLocker locker(&s_mutex);
+    return s_memoryBudget;
+}
+
+// static
+qint64 DecodedSampleCache::memoryUsage() {
+    QMutexLocker locker(&s_mutex);
+    return s_memoryUsage;
+}
+
+// static
+bool DecodedSampleCache::fitsIntoMemoryBudget(qint64 bytes) {
+    QMutexLocker locker(&s_mutex);
+    return bytes <= s_memoryBudget - pinnedMemoryUsage();
+}
+
+// static
+const DecodedSample* DecodedSampleCache::acquire(const QString& location) {
+    const QFileInfo fileInfo(location);
+    QMutexLocker locker(&s_mutex);
+    for (auto it = s_samples.begin(); it != s_samples.end(); ++it) {
+        if (!isCurrent(**it, fileInfo)) {
+            continue;
+        }
+        // Move to the most recently used position
+        s_samples.splice(s_samples.end(), s_samples, it);
+        const DecodedSample* pSample = s_samples.back().get();
+        pSample->pin();
+        return pSample;
+    }
+    return nullptr;
+}
+
+// static
+const DecodedSample* DecodedSampleCache::insert(
+        std::unique_ptr<DecodedSample> pSample) {
+    DEBUG_ASSERT(pSample);
+    DEBUG_ASSERT(!pSample->isPinned());
+    const QFileInfo fileInfo(pSample->getLocation());
+    QMutexLocker locker(&s_mutex);
+    auto it = s_samples.begin();
+    while (it != s_samples.end()) {
+        if ((*it)->getLocation() != pSample->getLocation()) {
+            ++it;
+        } else if (isCurrent(**it, fileInfo)) {
+            // Decoded concurrently by another reader
+            s_samples.splice(s_samples.end(), s_samples, it);
+            const DecodedSample* pCachedSample = s_samples.back().get();
+            pCachedSample->pin();
+            return pCachedSample;
+        } else if ((*it)->isPinned()) {
+            // Still played by a reader that loaded the file before it has
+            // been modified
+            ++it;
+        } else {
+            it = evict(it);
+        }
+    }
+
+    evictAboveBudget(s_memoryBudget - pSample->sizeInBytes());
+    if (s_memoryUsage + pSample->sizeInBytes() > s_memoryBudget) {
+        kLogger.debug()
+                << "Not caching"
+                << pSample->getLocation()
+                << "with"
+                << pSample->sizeInBytes()
+                << "bytes, because"
+                << pinnedMemoryUsage()
+                << "of"
+                << s_memoryBudget
+                << "bytes are in use";
+        return nullptr;
+    }
+    s_memoryUsage += pSample->sizeInBytes();
+    pSample->pin();
+    s_samples.push_back(std::move(pSample));
+    return s_samples.back().get();
+}
+
+// static
+void DecodedSampleCache::clear() {
+    QMutexLocker locker(&s_mutex);
+    evictAboveBudget(0);
+}
@@ -0,0 +1,121 @@
+#ifndef ENGINE_DECODEDSAMPLECACHE_H
+#define ENGINE_DECODEDSAMPLECACHE_H
+
+#include <QAtomicInt>
+#include <QString>
+
+#include <memory>
+
+#include "util/compatibility.h"
+#include "util/indexrange.h"
+#include "util/samplebuffer.h"
+#include "util/types.h"
+
+// The stereo samples of a completely decoded track. The samples are written
+// once by the CachingReaderWorker before the sample is inserted into the
+// DecodedSampleCache and are immutable afterwards, so any number of readers
+// can read them concurrently without locking.
+class DecodedSample {
+  public:
+    DecodedSample(QString location,
+            qint64 fileSize,
+            qint64 fileModified,
+            mixxx::IndexRange frameIndexRange);
+
+    const QString& getLocation() const {
+        return m_location;
+    }
+
+    mixxx::IndexRange frameIndexRange() const {
+        return m_frameIndexRange;
+    }
+
+    // The interleaved stereo samples of frameIndexRange()
+    const CSAMPLE* data() const {
+        return m_sampleBuffer.data();
+    }
+    CSAMPLE* writableData(SINT offset = 0) {
+        return m_sampleBuffer.data(offset);
+    }
+
+    qint64 getFileSize() const {
+        return m_fileSize;
+    }
+    qint64 getFileModified() const {
+        return m_fileModified;
+    }
+
+    qint64 sizeInBytes() const {
+        return m_sampleBuffer.size() * sizeof(CSAMPLE);
+    }
+
+    bool isPinned() const {
+        return load_atomic(m_pinCount) > 0;
+    }
+
+    // Releases a pin that has been obtained from DecodedSampleCache. Lock-free
+    // and never frees any memory, so it may be called from the engine
+    // callback.
+    void unpin() const {
+        m_pinCount.deref();
+    }
+
+  private:
+    friend class DecodedSampleCache;
+
+    void pin() const {
+        m_pinCount.ref();
+    }
+
+    const QString m_location;
+    // Of the file the samples have been decoded from
+    const qint64 m_fileSize;
+    // In ms since the epoch
+    const qint64 m_fileModified;
+    const mixxx::IndexRange m_frameIndexRange;
+    mixxx::SampleBuffer m_sampleBuffer;
+
+    // The number of readers that are using the samples. Pins are only added
+    // while holding the cache mutex, so a sample that is found unpinned
+    // while holding the mutex can safely be deleted.
+    mutable QAtomicInt m_pinCount;
+};
+
+// A process-wide cache of completely decoded tracks with a total memory
+// budget. Samplers decode short tracks into this cache when loading them
+// and then play them without reading from the file again. Sampler slots
+// that load the same file share its samples.
+//
+// Samples are pinned while they are loaded into a reader. Unpinned samples
+// are kept until the budget is needed for another sample and are evicted in
+// least-recently-used order, so reloading a recently used sample costs
+// nothing. Pinned samples are never evicted: A new sample that doesn't fit
+// into the budget beside the pinned samples is not cached and the reader
+// falls back to reading chunks from the file.
+class DecodedSampleCache {
+  public:
+    // Thread-safe. The default budget is 0, i.e. nothing is cached.
+    static void setMemoryBudget(qint64 bytes);
+    static qint64 memoryBudget();
+    static qint64 memoryUsage();
+
+    // Returns the pinned samples of the file in its current state, or
+    // nullptr if they are not cached.
+    static const DecodedSample* acquire(const QString& location);
+
+    // Caches the samples of a file and returns them pinned. Returns the
+    // samples that are already cached if another reader has decoded the
+    // same file in the meantime, or nullptr if they don't fit into the
+    // budget.
+    static const DecodedSample* insert(
+            std::unique_ptr<DecodedSample> pSample);
+
+    // Whether samples of this size could be cached at all. Checked before
+    // decoding a file.
+    static bool fitsIntoMemoryBudget(qint64 bytes);
+
+    // Evicts all unpinned samples.
+    static void clear();
+};
+
+#endif // ENGINE_DECODEDSAMPLECACHE_H
@@ -154,11 +154,8 @@ bool EngineEffectChain::enableForInputChannel(const ChannelHandle* inputHandle,
     for (auto&& outputChannelStatus : outputMap) {
         VERIFY_OR_DEBUG_ASSERT(outputChannelStatus.enableState !=
                 EffectEnableState::Enabled) {
-            for (auto&& pStatesMap : *statesForEffectsInChain) {
-                for (auto&& pState : pStatesMap) {
-                    delete pState;
-                }
-            }
+            // The unused states are deleted by EffectsManager in the main
+            // thread together with the request.
             return false;
         }
         outputChannelStatus.enableState = EffectEnableState::Enabling;
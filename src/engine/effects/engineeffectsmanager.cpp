@@ -14,6 +14,9 @@ EngineEffectsManager::EngineEffectsManager(EffectsResponsePipe* pResponsePipe)
     // Try to prevent memory allocation.
     m_chains.reserve(256);
     m_effects.reserve(256);
+    // Adding a rack in the engine thread must not insert into the hash.
+    m_racksByStage[SignalProcessingStage::Prefader].reserve(256);
+    m_racksByStage[SignalProcessingStage::Postfader].reserve(256);
 }
 
 EngineEffectsManager::~EngineEffectsManager() {
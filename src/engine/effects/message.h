@@ -75,7 +75,8 @@ struct EffectsRequest {
             }
             // This only deletes the container used to passed the EffectStates
             // to EffectProcessorImpl. The EffectStates are managed by
-            // EffectProcessorImpl.
+            // EffectProcessorImpl, the states that are left in the container
+            // are deleted by EffectsManager::collectGarbage.
             delete EnableInputChannelForChain.pEffectStatesMapArray;
         }
     }
@@ -85,6 +85,7 @@ EngineBuffer::EngineBuffer(QString group, UserSettingsPointer pConfig,
           m_iSeekPhaseQueued(0),
           m_iEnableSyncQueued(SYNC_REQUEST_NONE),
           m_iSyncModeQueued(SYNC_INVALID),
+          m_bSyncRequestsDeferred(false),
           m_iTrackLoading(0),
           m_bPlayAfterLoading(false),
           m_iSampleRate(0),
@@ -781,7 +782,9 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
 
         // Update the slipped position and seek if it was disabled.
         processSlip(iBufferSize);
-        processSyncRequests();
+        if (!m_bSyncRequestsDeferred) {
+            processSyncRequests();
+        }
 
         // Note: This may effects the m_filepos_play, play, scaler and crossfade buffer
         processSeek(paused);
@@ -1050,6 +1053,15 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
             }
         }
 
+        // Moving decks get a larger share of the chunk cache than idle ones
+        if (is_scratching) {
+            m_pReader->setActivity(CachingReader::Activity::SCRATCHING);
+        } else if (speed != 0.0) {
+            m_pReader->setActivity(CachingReader::Activity::PLAYING);
+        } else {
+            m_pReader->setActivity(CachingReader::Activity::IDLE);
+        }
+
         // Give the Reader hints as to which chunks of the current song we
         // really care about. It will try very hard to keep these in memory
         hintReader(rate);
@@ -1097,6 +1109,12 @@ void EngineBuffer::process(CSAMPLE* pOutput, const int iBufferSize) {
     m_bCrossfadeReady = false;
 }
 
+bool EngineBuffer::isSyncEngaged() const {
+    return m_pSyncControl->getSyncMode() != SYNC_NONE ||
+            load_atomic(m_iEnableSyncQueued) != SYNC_REQUEST_NONE ||
+            load_atomic(m_iSyncModeQueued) != SYNC_INVALID;
+}
+
 void EngineBuffer::processSlip(int iBufferSize) {
     // Do a single read from m_bSlipEnabled so we don't run in to race conditions.
     bool enabled = static_cast<bool>(load_atomic(m_slipEnabled));
@@ -1311,6 +1329,10 @@ void EngineBuffer::bindWorkers(EngineWorkerScheduler* pWorkerScheduler) {
     m_pReader->setScheduler(pWorkerScheduler);
 }
 
+void EngineBuffer::setDecodeToMemory(mixxx::Duration maxDuration) {
+    m_pReader->setDecodeToMemory(maxDuration);
+}
+
 bool EngineBuffer::isTrackLoaded() {
     if (m_pCurrentTrack) {
         return true;
@@ -119,6 +119,10 @@ class EngineBuffer : public EngineObject {
 
     void bindWorkers(EngineWorkerScheduler* pWorkerScheduler);
 
+    // Tracks up to maxDuration are decoded completely into memory when
+    // loaded (see CachingReader::setDecodeToMemory).
+    void setDecodeToMemory(mixxx::Duration maxDuration);
+
     // Return the current rate (not thread-safe)
     double getSpeed();
     bool getScratching();
@@ -135,6 +139,15 @@ class EngineBuffer : public EngineObject {
     void requestEnableSync(bool enabled);
     void requestSyncMode(SyncMode mode);
 
+    // Returns true if sync is enabled or a sync request is queued. Processing
+    // the buffer then accesses the EngineSync state shared by all decks.
+    bool isSyncEngaged() const;
+    // Queued sync requests are kept for a later callback while the buffer is
+    // processed on a worker thread in parallel to other channels.
+    void setSyncRequestsDeferred(bool deferred) {
+        m_bSyncRequestsDeferred = deferred;
+    }
+
     // The process methods all run in the audio callback.
     void process(CSAMPLE* pOut, const int iBufferSize);
     void processSlip(int iBufferSize);
@@ -386,6 +399,8 @@ class EngineBuffer : public EngineObject {
     QAtomicInt m_iSeekPhaseQueued;
     QAtomicInt m_iEnableSyncQueued;
     QAtomicInt m_iSyncModeQueued;
+    // Only used by the engine processing thread
+    bool m_bSyncRequestsDeferred;
     ControlValueAtomic<double> m_queuedSeekPosition;
 
     // Is true if the previous buffer was silent due to pausing
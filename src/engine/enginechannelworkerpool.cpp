@@ -0,0 +1,140 @@
+#include "engine/enginechannelworkerpool.h"
+
+#include <QThread>
+
+#include "engine/effects/groupfeaturestate.h"
+#include "engine/enginechannel.h"
+#include "util/assert.h"
+
+namespace {
+
+// The number of times an idle worker polls for the next callback before
+// it goes to sleep. Each poll yields the CPU, so this is in the order of
+// a millisecond on a loaded system.
+const int kIdleSpinCount = 2000;
+
+} // anonymous namespace
+
+class EngineChannelWorkerPool::Worker : public QThread {
+  public:
+    Worker(EngineChannelWorkerPool* pPool, int threadIndex)
+            : m_pPool(pPool),
+              m_threadIndex(threadIndex) {
+        setObjectName(QString("EngineChannelWorker %1").arg(threadIndex));
+    }
+
+    QAtomicInt& finishedGeneration() {
+        return m_finishedGeneration;
+    }
+
+  protected:
+    void run() override {
+        m_pPool->workerLoop(m_threadIndex, &m_finishedGeneration);
+    }
+
+  private:
+    EngineChannelWorkerPool* const m_pPool;
+    const int m_threadIndex;
+    QAtomicInt m_finishedGeneration;
+};
+
+EngineChannelWorkerPool::EngineChannelWorkerPool(int numWorkers)
+        : m_pJobs(nullptr),
+          m_numJobs(0),
+          m_iBufferSize(0) {
+    DEBUG_ASSERT(numWorkers > 0);
+    for (int i = 0; i < numWorkers; ++i) {
+        m_workers.push_back(std::make_unique<Worker>(this, i + 1));
+    }
+    for (const auto& pWorker : m_workers) {
+        pWorker->start(QThread::TimeCriticalPriority);
+    }
+}
+
+EngineChannelWorkerPool::~EngineChannelWorkerPool() {
+    m_quit.storeRelease(1);
+    m_generation.fetchAndAddOrdered(1);
+    // Superfluous tokens don't matter when shutting down
+    m_wakeUp.release(numWorkers());
+    for (const auto& pWorker : m_workers) {
+        pWorker->wait();
+    }
+}
+
+void EngineChannelWorkerPool::process(const Job* pJobs, int numJobs,
+        int iBufferSize) {
+    m_pJobs = pJobs;
+    m_numJobs = numJobs;
+    m_iBufferSize = iBufferSize;
+    const int generation = m_generation.fetchAndAddOrdered(1) + 1;
+    wakeSleepingWorkers();
+
+    runJobs(0);
+
+    for (const auto& pWorker : m_workers) {
+        while (pWorker->finishedGeneration().loadAcquire() != generation) {
+            QThread::yieldCurrentThread();
+        }
+    }
+}
+
+void EngineChannelWorkerPool::runJobs(int threadIndex) {
+    const int stride = numWorkers() + 1;
+    for (int i = threadIndex; i < m_numJobs; i += stride) {
+        const Job& job = m_pJobs[i];
+        job.pChannel->process(job.pBuffer, m_iBufferSize);
+        if (job.pFeatures) {
+            GroupFeatureState features;
+            job.pChannel->collectFeatures(&features);
+            *job.pFeatures = features;
+        }
+    }
+}
+
+void EngineChannelWorkerPool::workerLoop(int threadIndex,
+        QAtomicInt* pFinishedGeneration) {
+    int generation = 0;
+    while (waitForGeneration(&generation)) {
+        runJobs(threadIndex);
+        pFinishedGeneration->storeRelease(generation);
+    }
+}
+
+bool EngineChannelWorkerPool::waitForGeneration(int* pGeneration) {
+    for (;;) {
+        for (int i = 0; i < kIdleSpinCount; ++i) {
+            const int generation = m_generation.loadAcquire();
+            if (generation != *pGeneration) {
+                *pGeneration = generation;
+                return !m_quit.loadAcquire();
+            }
+            QThread::yieldCurrentThread();
+        }
+
+        // Announce that we are going to sleep. If the callback thread has
+        // published a new generation in the meantime, try to take back the
+        // announcement. If the callback thread has already collected it,
+        // a wake-up token has been released for us.
+        m_sleepingWorkers.fetchAndAddOrdered(1);
+        if (m_generation.loadAcquire() != *pGeneration) {
+            int sleeping = m_sleepingWorkers.loadAcquire();
+            while (sleeping > 0) {
+                if (m_sleepingWorkers.testAndSetOrdered(sleeping, sleeping - 1)) {
+                    break;
+                }
+                sleeping = m_sleepingWorkers.loadAcquire();
+            }
+            if (sleeping > 0) {
+                continue;
+            }
+        }
+        m_wakeUp.acquire();
+    }
+}
+
+void EngineChannelWorkerPool::wakeSleepingWorkers() {
+    const int sleeping = m_sleepingWorkers.fetchAndStoreOrdered(0);
+    if (sleeping > 0) {
+        m_wakeUp.release(sleeping);
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef ENGINECHANNELWORKERPOOL_H
+#define ENGINECHANNELWORKERPOOL_H
+
+#include <QAtomicInt>
+#include <QSemaphore>
+
+#include <memory>
+#include <vector>
+
+#include "util/types.h"
+
+class EngineChannel;
+struct GroupFeatureState;
+
+// Processes the EngineChannels of a callback on a pool of worker threads
+// that are spawned up front with real-time priority. The callback thread
+// calls process(), takes its own share of the channels and returns after
+// all workers have finished theirs. The mix-down of the channel buffers
+// stays on the callback thread.
+//
+// Forking and joining does not take any locks: the callback thread
+// publishes the jobs with an atomic generation counter and spins until
+// every worker has acknowledged that generation. Idle workers spin for a
+// short while before they go to sleep on a semaphore, so with typical
+// buffer sizes they are still awake when the next callback starts. Only
+// waking a sleeping worker involves the semaphore's mutex.
+//
+// The jobs are distributed round robin, i.e. thread t processes the jobs
+// t, t + n, t + 2n, ... where n is the number of workers plus the callback
+// thread. Each job writes only to the buffer and features of its own
+// channel, so the result does not depend on the number of threads.
+class EngineChannelWorkerPool {
+  public:
+    struct Job {
+        EngineChannel* pChannel;
+        CSAMPLE* pBuffer;
+        // Null if the features are not needed
+        GroupFeatureState* pFeatures;
+    };
+
+    explicit EngineChannelWorkerPool(int numWorkers);
+    ~EngineChannelWorkerPool();
+
+    int numWorkers() const {
+        return static_cast<int>(m_workers.size());
+    }
+
+    // Processes all jobs and returns when they are done. Must only be
+    // called from the callback thread.
+    void process(const Job* pJobs, int numJobs, int iBufferSize);
+
+  private:
+    class Worker;
+
+    // Runs the jobs of thread index threadIndex. The callback thread has
+    // index 0, the workers 1 to n.
+    void runJobs(int threadIndex);
+    void workerLoop(int threadIndex, QAtomicInt* pFinishedGeneration);
+    // Waits until the generation differs from *pGeneration and updates it.
+    // Returns false if the pool is shutting down.
+    bool waitForGeneration(int* pGeneration);
+    void wakeSleepingWorkers();
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    // Published by the callback thread before m_generation is incremented.
+    const Job* m_pJobs;
+    int m_numJobs;
+    int m_iBufferSize;
+
+    QAtomicInt m_generation;
+    QAtomicInt m_quit;
+    QAtomicInt m_sleepingWorkers;
+    QSemaphore m_wakeUp;
+};
+
+#endif /* ENGINECHANNELWORKERPOOL_H */
@@ -5,6 +5,12 @@
 #include <cstdio>
 #include <fidlib.h>
 
+// SSE2 is part of every x86-64 CPU and of the portable 32-bit builds
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIXXX_IIR_SSE2
+#include <emmintrin.h>
+#endif
+
 #include "engine/engineobject.h"
 #include "util/sample.h"
 
@@ -25,6 +31,114 @@ enum IIRPass {
 };
 
 
+// A frame of a stereo signal, with the left and right channel in the two
+// lanes of an SSE2 register. The IIR filters run their recursion for both
+// channels at once with it. Each lane computes exactly the same double
+// operations as the scalar code did for its channel.
+class IIRStereoSample {
+  public:
+#ifdef MIXXX_IIR_SSE2
+    IIRStereoSample()
+            : m_lanes(_mm_setzero_pd()) {
+    }
+    IIRStereoSample(double left, double right)
+            : m_lanes(_mm_set_pd(right, left)) {
+    }
+
+    // Loads the interleaved frame pFrame[0], pFrame[1]
+    static IIRStereoSample load(const CSAMPLE* pFrame) {
+        return IIRStereoSample(_mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(
+                reinterpret_cast<const __m128i*>(pFrame)))));
+    }
+    void store(CSAMPLE* pFrame) const {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pFrame),
+                _mm_castps_si128(_mm_cvtpd_ps(m_lanes)));
+    }
+
+    double left() const {
+        return _mm_cvtsd_f64(m_lanes);
+    }
+    double right() const {
+        return _mm_cvtsd_f64(_mm_unpackhi_pd(m_lanes, m_lanes));
+    }
+
+    IIRStereoSample operator+(const IIRStereoSample& other) const {
+        return IIRStereoSample(_mm_add_pd(m_lanes, other.m_lanes));
+    }
+    IIRStereoSample operator-(const IIRStereoSample& other) const {
+        return IIRStereoSample(_mm_sub_pd(m_lanes, other.m_lanes));
+    }
+    IIRStereoSample operator-() const {
+        // Flips the sign bit like the scalar negation, also of zeros
+        return IIRStereoSample(_mm_xor_pd(m_lanes, _mm_set1_pd(-0.0)));
+    }
+    IIRStereoSample operator*(double factor) const {
+        return IIRStereoSample(_mm_mul_pd(m_lanes, _mm_set1_pd(factor)));
+    }
+
+  private:
+    explicit IIRStereoSample(__m128d lanes)
+            : m_lanes(lanes) {
+    }
+
+    __m128d m_lanes;
+#else
+    IIRStereoSample()
+            : m_left(0.0),
+              m_right(0.0) {
+    }
+    IIRStereoSample(double left, double right)
+            : m_left(left),
+              m_right(right) {
+    }
+
+    // Loads the interleaved frame pFrame[0], pFrame[1]
+    static IIRStereoSample load(const CSAMPLE* pFrame) {
+        return IIRStereoSample(pFrame[0], pFrame[1]);
+    }
+    void store(CSAMPLE* pFrame) const {
+        pFrame[0] = static_cast<CSAMPLE>(m_left);
+        pFrame[1] = static_cast<CSAMPLE>(m_right);
+    }
+
+    double left() const {
+        return m_left;
+    }
+    double right() const {
+        return m_right;
+    }
+
+    IIRStereoSample operator+(const IIRStereoSample& other) const {
+        return IIRStereoSample(m_left + other.m_left, m_right + other.m_right);
+    }
+    IIRStereoSample operator-(const IIRStereoSample& other) const {
+        return IIRStereoSample(m_left - other.m_left, m_right - other.m_right);
+    }
+    IIRStereoSample operator-() const {
+        return IIRStereoSample(-m_left, -m_right);
+    }
+    IIRStereoSample operator*(double factor) const {
+        return IIRStereoSample(m_left * factor, m_right * factor);
+    }
+
+  private:
+    double m_left;
+    double m_right;
+#endif
+
+  public:
+    IIRStereoSample& operator+=(const IIRStereoSample& other) {
+        return *this = *this + other;
+    }
+    IIRStereoSample& operator-=(const IIRStereoSample& other) {
+        return *this = *this - other;
+    }
+};
+
+inline IIRStereoSample operator*(double factor, const IIRStereoSample& sample) {
+    return sample * factor;
+}
+
 class EngineFilterIIRBase : public EngineObjectConstIn {
   public:
     virtual void assumeSettled() = 0;
@@ -42,6 +156,9 @@ class EngineFilterIIR : public EngineFilterIIRBase {
               m_doStart(false),
               m_startFromDry(false) {
         memset(m_coef, 0, sizeof(m_coef));
+        memset(m_oldCoef, 0, sizeof(m_oldCoef));
+        memset(m_oldBuf1, 0, sizeof(m_oldBuf1));
+        memset(m_oldBuf2, 0, sizeof(m_oldBuf2));
         pauseFilter();
     }
 
@@ -195,12 +312,17 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 
     virtual void process(const CSAMPLE* pIn, CSAMPLE* pOutput,
                          const int iBufferSize) {
+        // The state of both channels stays in the lanes for the whole block.
+        IIRStereoSample buf[SIZE];
+        loadLanes(buf, m_buf1, m_buf2);
         if (!m_doRamping) {
             for (int i = 0; i < iBufferSize; i += 2) {
-                pOutput[i] = processSample(m_coef, m_buf1, pIn[i]);
-                pOutput[i+1] = processSample(m_coef, m_buf2, pIn[i + 1]);
+                processSample(m_coef, buf, IIRStereoSample::load(&pIn[i]))
+                        .store(&pOutput[i]);
             }
         } else {
+            IIRStereoSample oldBuf[SIZE];
+            loadLanes(oldBuf, m_oldBuf1, m_oldBuf2);
             double cross_mix = 0.0;
             double cross_inc = 4.0 / static_cast<double>(iBufferSize);
             for (int i = 0; i < iBufferSize; i += 2) {
@@ -215,42 +337,51 @@ class EngineFilterIIR : public EngineFilterIIRBase {
                 // of the new filter but it turns out that this produces
                 // a gain drop due to the filter delay which is more
                 // conspicuous than the settling noise.
-                double old1;
-                double old2;
+                const IIRStereoSample in = IIRStereoSample::load(&pIn[i]);
+                IIRStereoSample old;
                 if (!m_doStart) {
                     // Process old filter, but only if we do not do a fresh start
-                    old1 = processSample(m_oldCoef, m_oldBuf1, pIn[i]);
-                    old2 = processSample(m_oldCoef, m_oldBuf2, pIn[i + 1]);
-                } else {
-                    if (m_startFromDry) {
-                        old1 = pIn[i];
-                        old2 = pIn[i + 1];
-                    } else {
-                        old1 = 0;
-                        old2 = 0;
-                    }
+                    old = processSample(m_oldCoef, oldBuf, in);
+                } else if (m_startFromDry) {
+                    old = in;
                 }
-                double new1 = processSample(m_coef, m_buf1, pIn[i]);
-                double new2 = processSample(m_coef, m_buf2, pIn[i + 1]);
+                const IIRStereoSample next = processSample(m_coef, buf, in);
 
                 if (i < iBufferSize / 2) {
-                    pOutput[i] = old1;
-                    pOutput[i + 1] = old2;
+                    old.store(&pOutput[i]);
                 } else {
-                    pOutput[i] = new1 * cross_mix +
-                                 old1 * (1.0 - cross_mix);
-                    pOutput[i + 1] = new2  * cross_mix +
-                                     old2 * (1.0 - cross_mix);
+                    (next * cross_mix + old * (1.0 - cross_mix))
+                            .store(&pOutput[i]);
                     cross_mix += cross_inc;
                 }
             }
+            storeLanes(m_oldBuf1, m_oldBuf2, oldBuf);
             m_doRamping = false;
             m_doStart = false;
         }
+        storeLanes(m_buf1, m_buf2, buf);
     }
 
   protected:
-    inline double processSample(double* coef, double* buf, double val);
+    // Runs one sample through the sections of the filter. T is double for a
+    // single channel or IIRStereoSample for both channels.
+    template<typename T>
+    inline T processSample(const double* coef, T* buf, T val);
+
+    static void loadLanes(IIRStereoSample* lanes,
+            const double* buf1, const double* buf2) {
+        for (unsigned int i = 0; i < SIZE; ++i) {
+            lanes[i] = IIRStereoSample(buf1[i], buf2[i]);
+        }
+    }
+    static void storeLanes(double* buf1, double* buf2,
+            const IIRStereoSample* lanes) {
+        for (unsigned int i = 0; i < SIZE; ++i) {
+            buf1[i] = lanes[i].left();
+            buf2[i] = lanes[i].right();
+        }
+    }
+
     inline void pauseFilterInner() {
         // Set the current buffers to 0
         memset(m_buf1, 0, sizeof(m_buf1));
@@ -282,10 +413,10 @@ class EngineFilterIIR : public EngineFilterIIRBase {
 };
 
 template<>
-inline double EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_LP>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -296,10 +427,10 @@ inline double EngineFilterIIR<2, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_BP>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = -tmp;
@@ -310,10 +441,10 @@ inline double EngineFilterIIR<2, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_HP>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -324,10 +455,10 @@ inline double EngineFilterIIR<2, IIR_HP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_LP>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -343,10 +474,10 @@ inline double EngineFilterIIR<4, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<8, IIR_BP>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -373,10 +504,10 @@ inline double EngineFilterIIR<8, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_HP>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     iir= val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -392,10 +523,10 @@ inline double EngineFilterIIR<4, IIR_HP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<8, IIR_LP>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -422,10 +553,10 @@ inline double EngineFilterIIR<8, IIR_LP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
-                                                         double* buf,
-                                                         double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<16, IIR_BP>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     buf[7] = buf[8]; buf[8] = buf[9]; buf[9] = buf[10]; buf[10] = buf[11];
@@ -474,10 +605,10 @@ inline double EngineFilterIIR<16, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<8, IIR_HP>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
     buf[3] = buf[4]; buf[4] = buf[5]; buf[5] = buf[6]; buf[6] = buf[7];
     iir = val * coef[0];
@@ -505,10 +636,10 @@ inline double EngineFilterIIR<8, IIR_HP>::processSample(double* coef,
 
 // IIR_LP and IIR_HP use the same processSample routine
 template<>
-inline double EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<5, IIR_BP>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0]; buf[0] = buf[1];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = coef[2] * tmp;
@@ -519,10 +650,10 @@ inline double EngineFilterIIR<5, IIR_BP>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-   double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_LPMO>::processSample(
+        const double* coef, T* buf, T val) {
+   T tmp, fir, iir;
    tmp= buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
    iir= val * coef[0];
    iir -= coef[1]*tmp; fir= tmp;
@@ -545,10 +676,10 @@ inline double EngineFilterIIR<4, IIR_LPMO>::processSample(double* coef,
 
 
 template<>
-inline double EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-   double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<4, IIR_HPMO>::processSample(
+        const double* coef, T* buf, T val) {
+   T tmp, fir, iir;
    tmp= buf[0]; buf[0] = buf[1]; buf[1] = buf[2]; buf[2] = buf[3];
    iir= val * coef[0];
    iir -= coef[1]*tmp; fir= -tmp;
@@ -570,10 +701,10 @@ inline double EngineFilterIIR<4, IIR_HPMO>::processSample(double* coef,
 }
 
 template<>
-inline double EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_LP2>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0];
     iir = val * coef[0];
     iir -= coef[1] * tmp; fir = tmp;
@@ -591,10 +722,10 @@ inline double EngineFilterIIR<2, IIR_LP2>::processSample(double* coef,
 
 
 template<>
-inline double EngineFilterIIR<2, IIR_HP2>::processSample(double* coef,
-                                                        double* buf,
-                                                        double val) {
-    double tmp, fir, iir;
+template<typename T>
+inline T EngineFilterIIR<2, IIR_HP2>::processSample(
+        const double* coef, T* buf, T val) {
+    T tmp, fir, iir;
     tmp = buf[0];
     iir = val * -coef[0]; // swap gain to be in phase with LP2
     iir -= coef[1] * tmp; fir = -tmp;
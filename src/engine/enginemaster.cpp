@@ -25,6 +25,7 @@
 #include "engine/sync/enginesync.h"
 #include "mixer/playermanager.h"
 #include "util/defs.h"
+#include "util/memory.h"
 #include "util/sample.h"
 #include "util/timer.h"
 #include "util/trace.h"
@@ -188,6 +189,10 @@ EngineMaster::EngineMaster(UserSettingsPointer pConfig,
     m_pHeadphoneEnabled = new ControlObject(ConfigKey(group, "headEnabled"));
     m_pHeadphoneEnabled->setReadOnly();
 
+    // Processing the channels in parallel is opt-in for now
+    setChannelWorkerCount(pConfig->getValue(
+            ConfigKey(group, "channel_worker_threads"), 0));
+
     // Note: the EQ Rack is set in EffectsManager::setupDefaults();
 }
 
@@ -239,6 +244,7 @@ EngineMaster::~EngineMaster() {
     }
 
     delete m_pWorkerScheduler;
+    m_pChannelWorkerPool.reset();
 
     for (int i = 0; i < m_channels.size(); ++i) {
         ChannelInfo* pChannelInfo = m_channels[i];
@@ -346,17 +352,49 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 
     // Now that the list is built and ordered, do the processing.
-    for (int i = activeChannelsStartIndex;
-             i < m_activeChannels.size(); ++i) {
-        ChannelInfo* pChannelInfo = m_activeChannels[i];
-        EngineChannel* pChannel = pChannelInfo->m_pChannel;
-        pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
-
-        // Collect metadata for effects
-        if (m_pEngineEffectsManager) {
-            GroupFeatureState features;
-            pChannel->collectFeatures(&features);
-            pChannelInfo->m_features = features;
+    if (m_pChannelWorkerPool) {
+        // The sync master is processed before all other channels, because
+        // the sync followers pick up its state while they are processed.
+        // The followers and the decks with queued sync requests access the
+        // shared EngineSync state, so they are processed one after another
+        // on this thread as well. Only the remaining channels are processed
+        // in parallel.
+        int i = activeChannelsStartIndex;
+        if (i == 0) {
+            processChannel(m_activeChannels[0], iBufferSize);
+            ++i;
+        }
+        m_channelJobs.clear();
+        for (; i < m_activeChannels.size(); ++i) {
+            ChannelInfo* pChannelInfo = m_activeChannels[i];
+            EngineBuffer* pBuffer = pChannelInfo->m_pChannel->getEngineBuffer();
+            if (pBuffer) {
+                if (pBuffer->isSyncEngaged()) {
+                    processChannel(pChannelInfo, iBufferSize);
+                    continue;
+                }
+                // A sync request that is queued from now on is processed
+                // during the next callback.
+                pBuffer->setSyncRequestsDeferred(true);
+            }
+            EngineChannelWorkerPool::Job job;
+            job.pChannel = pChannelInfo->m_pChannel;
+            job.pBuffer = pChannelInfo->m_pBuffer;
+            job.pFeatures = m_pEngineEffectsManager ? &pChannelInfo->m_features : nullptr;
+            m_channelJobs.append(job);
+        }
+        m_pChannelWorkerPool->process(
+                m_channelJobs.constData(), m_channelJobs.size(), iBufferSize);
+        for (const auto& job: m_channelJobs) {
+            EngineBuffer* pBuffer = job.pChannel->getEngineBuffer();
+            if (pBuffer) {
+                pBuffer->setSyncRequestsDeferred(false);
+            }
+        }
+    } else {
+        for (int i = activeChannelsStartIndex;
+                 i < m_activeChannels.size(); ++i) {
+            processChannel(m_activeChannels[i], iBufferSize);
         }
     }
 
@@ -370,6 +408,32 @@ void EngineMaster::processChannels(int iBufferSize) {
     }
 }
 
+void EngineMaster::processChannel(ChannelInfo* pChannelInfo, int iBufferSize) {
+    EngineChannel* pChannel = pChannelInfo->m_pChannel;
+    pChannel->process(pChannelInfo->m_pBuffer, iBufferSize);
+
+    // Collect metadata for effects
+    if (m_pEngineEffectsManager) {
+        GroupFeatureState features;
+        pChannel->collectFeatures(&features);
+        pChannelInfo->m_features = features;
+    }
+}
+
+void EngineMaster::setChannelWorkerCount(int numWorkers) {
+    if (numWorkers == channelWorkerCount()) {
+        return;
+    }
+    m_pChannelWorkerPool.reset();
+    if (numWorkers > 0) {
+        m_pChannelWorkerPool = std::make_unique<EngineChannelWorkerPool>(numWorkers);
+    }
+}
+
+int EngineMaster::channelWorkerCount() const {
+    return m_pChannelWorkerPool ? m_pChannelWorkerPool->numWorkers() : 0;
+}
+
 void EngineMaster::process(const int iBufferSize) {
     static bool haveSetName = false;
     if (!haveSetName) {
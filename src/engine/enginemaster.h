@@ -21,11 +21,14 @@
 #include <QObject>
 #include <QVarLengthArray>
 
+#include <memory>
+
 #include "preferences/usersettings.h"
 #include "control/controlobject.h"
 #include "control/controlpushbutton.h"
 #include "engine/engineobject.h"
 #include "engine/enginechannel.h"
+#include "engine/enginechannelworkerpool.h"
 #include "engine/channelhandle.h"
 #include "soundio/soundmanager.h"
 #include "soundio/soundmanagerutil.h"
@@ -89,6 +92,14 @@ class EngineMaster : public QObject, public AudioSource {
     // Add an EngineChannel to the mixing engine. This is not thread safe --
     // only call it before the engine has started mixing.
     void addChannel(EngineChannel* pChannel);
+
+    // Processes the channels on numWorkers worker threads in addition to
+    // the callback thread. Decks with sync enabled are always processed
+    // on the callback thread. 0 processes all channels serially on the
+    // callback thread, which is the default. This is not thread safe --
+    // only call it while the engine is not mixing.
+    void setChannelWorkerCount(int numWorkers);
+    int channelWorkerCount() const;
     EngineChannel* getChannel(const QString& group);
     static inline double gainForOrientation(EngineChannel::ChannelOrientation orientation,
                                             double leftGain,
@@ -270,6 +281,7 @@ class EngineMaster : public QObject, public AudioSource {
     // m_activeTalkoverChannels with each channel that is active for the
     // respective output.
     void processChannels(int iBufferSize);
+    void processChannel(ChannelInfo* pChannelInfo, int iBufferSize);
 
     ChannelHandleFactory* m_pChannelHandleFactory;
     void applyMasterEffects();
@@ -304,6 +316,9 @@ class EngineMaster : public QObject, public AudioSource {
     CSAMPLE* m_pSidechainMix;
 
     EngineWorkerScheduler* m_pWorkerScheduler;
+    // Only set if the channels are processed in parallel
+    std::unique_ptr<EngineChannelWorkerPool> m_pChannelWorkerPool;
+    QVarLengthArray<EngineChannelWorkerPool::Job, kPreallocatedChannels> m_channelJobs;
     EngineSync* m_pMasterSync;
 
     ControlObject* m_pMasterGain;
@@ -8,7 +8,7 @@
 #include "util/event.h"
 
 EngineWorkerScheduler::EngineWorkerScheduler(QObject* pParent)
-        : m_bWakeScheduler(false),
+        : m_bWakeScheduler(0),
           m_bQuit(false) {
     Q_UNUSED(pParent);
 }
@@ -20,7 +20,7 @@ EngineWorkerScheduler::~EngineWorkerScheduler() {
 }
 
 void EngineWorkerScheduler::workerReady() {
-    m_bWakeScheduler = true;
+    m_bWakeScheduler.storeRelease(1);
 }
 
 void EngineWorkerScheduler::addWorker(EngineWorker* pWorker) {
@@ -31,10 +31,10 @@ void EngineWorkerScheduler::addWorker(EngineWorker* pWorker) {
 
 void EngineWorkerScheduler::runWorkers() {
     // Wake the scheduler if we have written a worker-ready message to the
-    // scheduler. There is no race condition in accessing this boolean because
-    // both workerReady and runWorkers are called from the callback thread.
-    if (m_bWakeScheduler) {
-        m_bWakeScheduler = false;
+    // scheduler. workerReady is called from the callback thread or, if the
+    // channels are processed in parallel, from the channel workers. These
+    // have all finished when runWorkers is called from the callback thread.
+    if (m_bWakeScheduler.fetchAndStoreAcquire(0)) {
         m_waitCondition.wakeAll();
     }
 }
@@ -1,6 +1,7 @@
 #ifndef ENGINEWORKERSCHEDULER_H
 #define ENGINEWORKERSCHEDULER_H
 
+#include <QAtomicInt>
 #include <QMutex>
 #include <QThreadPool>
 #include <QWaitCondition>
@@ -28,8 +29,9 @@ class EngineWorkerScheduler : public QThread {
 
   private:
     // Indicates whether workerReady has been called since the last time
-    // runWorkers was run. This should only be touched from the engine callback.
-    bool m_bWakeScheduler;
+    // runWorkers was run. This should only be touched from the engine callback
+    // and the EngineChannelWorkerPool threads.
+    QAtomicInt m_bWakeScheduler;
 
     std::vector<EngineWorker*> m_workers;
 
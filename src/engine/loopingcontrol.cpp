@@ -10,6 +10,7 @@
 #include "engine/loopingcontrol.h"
 #include "engine/bpmcontrol.h"
 #include "engine/enginecontrol.h"
+#include "engine/readaheadmanager.h"
 #include "util/compatibility.h"
 #include "util/math.h"
 #include "util/sample.h"
@@ -423,7 +424,6 @@ double LoopingControl::nextTrigger(bool reverse,
 
 void LoopingControl::hintReader(HintVector* pHintList) {
     LoopSamples loopSamples = m_loopSamples.getValue();
-    Hint loop_hint;
     // If the loop is enabled, then this is high priority because we will loop
     // sometime potentially very soon! The current audio itself is priority 1,
     // but we will issue ourselves at priority 2.
@@ -433,23 +433,18 @@ void LoopingControl::hintReader(HintVector* pHintList) {
         // direction we're going in, but that this is much simpler, and hints
         // aren't that bad to make anyway.
         if (loopSamples.start >= 0) {
-            loop_hint.priority = 2;
-            loop_hint.frame = SampleUtil::floorPlayPosToFrame(loopSamples.start);
-            loop_hint.frameCount = Hint::kFrameCountForward;
-            pHintList->append(loop_hint);
+            ReadAheadManager::hintJumpTarget(
+                    loopSamples.start, false, 2, pHintList);
         }
         if (loopSamples.end >= 0) {
-            loop_hint.priority = 10;
-            loop_hint.frame = SampleUtil::ceilPlayPosToFrame(loopSamples.end);
-            loop_hint.frameCount = Hint::kFrameCountBackward;
-            pHintList->append(loop_hint);
+            ReadAheadManager::hintJumpTarget(
+                    loopSamples.end, true, Hint::kPriorityPrefetch, pHintList);
         }
     } else {
+        // The loop might be reenabled by reloop
         if (loopSamples.start >= 0) {
-            loop_hint.priority = 10;
-            loop_hint.frame = SampleUtil::floorPlayPosToFrame(loopSamples.start);
-            loop_hint.frameCount = Hint::kFrameCountForward;
-            pHintList->append(loop_hint);
+            ReadAheadManager::hintJumpTarget(
+                    loopSamples.start, false, Hint::kPriorityPrefetch, pHintList);
         }
     }
 }
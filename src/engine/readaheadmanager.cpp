@@ -12,6 +12,11 @@
 
 static const int kNumChannels = 2;
 
+// SoundTouch can read up to 2 chunks ahead. Always keep 2 chunks ahead in
+// cache.
+//static
+const SINT ReadAheadManager::kFrameCountToCache = 2 * CachingReaderChunk::kFrames;
+
 ReadAheadManager::ReadAheadManager()
         : m_pLoopingControl(NULL),
           m_pRateControl(NULL),
@@ -187,16 +192,13 @@ void ReadAheadManager::hintReader(double dRate, HintVector* pHintList) {
     bool in_reverse = dRate < 0;
     Hint current_position;
 
-    // SoundTouch can read up to 2 chunks ahead. Always keep 2 chunks ahead in
-    // cache.
-    SINT frameCountToCache = 2 * CachingReaderChunk::kFrames;
-    current_position.frameCount = frameCountToCache;
+    current_position.frameCount = kFrameCountToCache;
 
     // this called after the precious chunk was consumed
     if (in_reverse) {
         current_position.frame =
                 static_cast<SINT>(ceil(m_currentPosition / kNumChannels)) -
-                frameCountToCache;
+                kFrameCountToCache;
     } else {
         current_position.frame =
                 static_cast<SINT>(floor(m_currentPosition / kNumChannels));
@@ -211,10 +213,34 @@ void ReadAheadManager::hintReader(double dRate, HintVector* pHintList) {
     }
 
     // top priority, we need to read this data immediately
-    current_position.priority = 1;
+    current_position.priority = Hint::kPriorityImmediate;
     pHintList->append(current_position);
 }
 
+//static
+void ReadAheadManager::hintJumpTarget(double samplePosition, bool reverse,
+        int priority, HintVector* pHintList) {
+    Hint jump_target;
+    jump_target.frameCount = kFrameCountToCache;
+    if (reverse) {
+        jump_target.frame =
+                SampleUtil::ceilPlayPosToFrame(samplePosition) -
+                kFrameCountToCache;
+        if (jump_target.frame < 0) {
+            // Nothing to read before the start of the track
+            jump_target.frameCount += jump_target.frame;
+            jump_target.frame = 0;
+        }
+    } else {
+        jump_target.frame = SampleUtil::floorPlayPosToFrame(samplePosition);
+    }
+    if (jump_target.frameCount <= 0) {
+        return;
+    }
+    jump_target.priority = priority;
+    pHintList->append(jump_target);
+}
+
 // Not thread-save, call from engine thread only
 void ReadAheadManager::addReadLogEntry(double virtualPlaypositionStart,
                                        double virtualPlaypositionEndNonInclusive) {
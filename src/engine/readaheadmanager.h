@@ -56,6 +56,17 @@ class ReadAheadManager {
     // indicate that the given portion of a song is about to be read.
     virtual void hintReader(double dRate, HintVector* hintList);
 
+    // Appends a prefetch hint for a position the engine might jump to, e.g. a
+    // hotcue or a loop point. The hinted region covers the same read-ahead
+    // window as the hint for the current play position, so that the reads
+    // after a jump can be served from the cache until the reader has caught
+    // up with the new play position.
+    static void hintJumpTarget(double samplePosition, bool reverse,
+            int priority, HintVector* pHintList);
+
+    // The number of frames that are kept in the cache in playing direction
+    static const SINT kFrameCountToCache;
+
     virtual double getFilePlaypositionFromLog(double currentFilePlayposition,
                                                        double numConsumedSamples);
 
@@ -6,6 +6,7 @@
 #include "library/trackcollection.h"
 #include "library/searchqueryparser.h"
 #include "library/queryutil.h"
+#include "library/dao/trackschema.h"
 #include "track/keyutils.h"
 #include "track/globaltrackcache.h"
 #include "util/performancetimer.h"
@@ -29,6 +30,7 @@ BaseTrackCache::BaseTrackCache(TrackCollection* pTrackCollection,
           m_columnCache(columns),
           m_bIndexBuilt(false),
           m_bIsCaching(isCaching),
+          m_trackColumnStore(columns),
           m_trackDAO(pTrackCollection->getTrackDAO()),
           m_database(pTrackCollection->database()),
           m_pQueryParser(new SearchQueryParser(pTrackCollection)) {
@@ -97,7 +99,7 @@ void BaseTrackCache::slotTracksRemoved(QSet<TrackId> trackIds) {
         qDebug() << this << "slotTracksRemoved" << trackIds.size();
     }
     for (const auto& trackId : qAsConst(trackIds)) {
-        m_trackInfo.remove(trackId);
+        m_trackColumnStore.removeRecord(trackId);
         m_dirtyTracks.remove(trackId);
     }
 }
@@ -127,7 +129,7 @@ void BaseTrackCache::slotTrackClean(TrackId trackId) {
 }
 
 bool BaseTrackCache::isCached(TrackId trackId) const {
-    return m_trackInfo.contains(trackId);
+    return m_trackColumnStore.contains(trackId);
 }
 
 void BaseTrackCache::ensureCached(TrackId trackId) {
@@ -232,14 +234,18 @@ bool BaseTrackCache::updateIndexWithTrackpointer(TrackPointer pTrack) {
 
     TrackId trackId = pTrack->getId();
     if (trackId.isValid()) {
-        // m_trackInfo[id] will insert a QVector<QVariant> into the
-        // m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[trackId];
         // prealocate memory for all columns at once
-        record.resize(numColumns);
+        QVector<QVariant> record(numColumns);
         for (int i = 0; i < numColumns; ++i) {
             getTrackValueForColumn(pTrack, i, record[i]);
         }
+        const int locationColumn =
+                fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_NATIVELOCATION);
+        if (locationColumn >= 0) {
+            record[locationColumn] = QDir::fromNativeSeparators(
+                    record[locationColumn].toString());
+        }
+        m_trackColumnStore.setRecord(trackId, std::move(record));
         if (m_bIsCaching) {
             replaceRecentTrack(std::move(trackId), std::move(pTrack));
         }
@@ -280,22 +286,11 @@ bool BaseTrackCache::updateIndexWithQuery(const QString& queryString) {
     while (query.next()) {
         TrackId trackId(query.value(idColumn));
 
-        //m_trackInfo[id] will insert a QVector<QVariant> into the
-        //m_trackInfo HashTable with the key "id"
-        QVector<QVariant>& record = m_trackInfo[trackId];
-        record.resize(numColumns);
-
+        QVector<QVariant> record(numColumns);
         for (int i = 0; i < numColumns; ++i) {
-            if (fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_NATIVELOCATION) == i) {
-                // Database stores all locations with Qt separators: "/"
-                // Here we want to cache the display string with native separators.
-                QString location = query.value(i).toString();
-                record[i] = QDir::toNativeSeparators(location);
-            }
-            else {
-                record[i] = query.value(i);
-            }
+            record[i] = query.value(i);
         }
+        m_trackColumnStore.setRecord(trackId, std::move(record));
     }
 
     qDebug() << this << "updateIndexWithQuery took" << timer.elapsed().debugMillisWithUnit();
@@ -317,7 +312,7 @@ void BaseTrackCache::buildIndex() {
     // TODO(rryan) for very large tables, it probably makes more sense to NOT
     // clear the table, and keep track of what IDs we see, then delete the ones
     // we don't see.
-    m_trackInfo.clear();
+    m_trackColumnStore.clear();
 
     if (!updateIndexWithQuery(queryString)) {
         qDebug() << "buildIndex failed!";
@@ -452,11 +447,15 @@ QVariant BaseTrackCache::data(TrackId trackId, int column) const {
     // metadata. Currently the upper-levels will not delegate row-specific
     // columns to this method, but there should still be a check here I think.
     if (!result.isValid()) {
-        QHash<TrackId, QVector<QVariant> >::const_iterator it =
-                m_trackInfo.find(trackId);
-        if (it != m_trackInfo.end()) {
-            const QVector<QVariant>& fields = it.value();
-            result = fields.value(column, result);
+        const int row = m_trackColumnStore.row(trackId);
+        if (row >= 0) {
+            result = m_trackColumnStore.record(row).value(column, result);
+            if (!result.isNull() && column ==
+                    fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_NATIVELOCATION)) {
+                // Database stores all locations with Qt separators: "/"
+                // Here we want the display string with native separators.
+                result = QDir::toNativeSeparators(result.toString());
+            }
         }
     }
     return result;
@@ -478,60 +477,82 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
         buildIndex();
     }
 
-    QStringList idStrings;
     // TODO(rryan) consider making this the data passed in and a separate
     // QVector for output
     QSet<TrackId> dirtyTracks;
     for (const auto& trackId: trackIds) {
-        idStrings << trackId.toString();
         if (m_dirtyTracks.contains(trackId)) {
             dirtyTracks.insert(trackId);
         }
     }
 
-    std::unique_ptr<QueryNode> pQuery(parseQuery(
-        searchQuery, extraFilter, idStrings));
+    m_trackOrder.resize(0); // keeps allocated memory
 
-    QString filter = pQuery->toSql();
-    if (!filter.isEmpty()) {
-        filter.prepend("WHERE ");
+    // Searching and sorting the cached values is much faster than SQL, but
+    // an extra filter is only available as an SQL expression. Crate filters
+    // match the tracks by the column "id".
+    std::unique_ptr<QueryNode> pQuery;
+    if (extraFilter.isEmpty() && m_idColumn == LIBRARYTABLE_ID &&
+            !orderByClause.contains("RANDOM()")) {
+        pQuery = parseQuery(searchQuery, extraFilter, QStringList());
+        const QList<SortColumn> inMemorySortColumns =
+                orderByClause.isEmpty() ? QList<SortColumn>() : sortColumns;
+        if (!filterAndSortInMemory(trackIds, *pQuery,
+                    inMemorySortColumns, columnOffset)) {
+            pQuery.reset();
+        }
     }
 
-    QString queryString = QString("SELECT %1 FROM %2 %3 %4")
-            .arg(m_idColumn, m_tableName, filter, orderByClause);
+    if (!pQuery) {
+        QStringList idStrings;
+        for (const auto& trackId: trackIds) {
+            idStrings << trackId.toString();
+        }
 
-    if (sDebug) {
-        qDebug() << this << "select() executing:" << queryString;
-    }
+        pQuery = parseQuery(searchQuery, extraFilter, idStrings);
 
-    QSqlQuery query(m_database);
-    // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
-    // won't allocate a giant in-memory table that we won't use at all.
-    query.setForwardOnly(true);
-    query.prepare(queryString);
+        QString filter = pQuery->toSql();
+        if (!filter.isEmpty()) {
+            filter.prepend("WHERE ");
+        }
 
-    if (!query.exec()) {
-        LOG_FAILED_QUERY(query);
-    }
+        QString queryString = QString("SELECT %1 FROM %2 %3 %4")
+                .arg(m_idColumn, m_tableName, filter, orderByClause);
 
-    int idColumn = query.record().indexOf(m_idColumn);
-    int rows = query.size();
+        if (sDebug) {
+            qDebug() << this << "select() executing:" << queryString;
+        }
 
-    if (sDebug) {
-        qDebug() << "Rows returned:" << rows;
-    }
+        QSqlQuery query(m_database);
+        // This causes a memory savings since QSqlCachedResult (what QtSQLite uses)
+        // won't allocate a giant in-memory table that we won't use at all.
+        query.setForwardOnly(true);
+        query.prepare(queryString);
 
-    m_trackOrder.resize(0); // keeps allocated memory
-    trackToIndex->clear();
-    if (rows > 0) {
-        trackToIndex->reserve(rows);
-        m_trackOrder.reserve(rows);
+        if (!query.exec()) {
+            LOG_FAILED_QUERY(query);
+        }
+
+        int idColumn = query.record().indexOf(m_idColumn);
+        int rows = query.size();
+
+        if (sDebug) {
+            qDebug() << "Rows returned:" << rows;
+        }
+
+        if (rows > 0) {
+            m_trackOrder.reserve(rows);
+        }
+
+        while (query.next()) {
+            m_trackOrder.append(TrackId(query.value(idColumn)));
+        }
     }
 
-    while (query.next()) {
-        TrackId trackId(query.value(idColumn));
-        (*trackToIndex)[trackId] = m_trackOrder.size();
-        m_trackOrder.append(trackId);
+    trackToIndex->clear();
+    trackToIndex->reserve(m_trackOrder.size());
+    for (int i = 0; i < m_trackOrder.size(); ++i) {
+        (*trackToIndex)[m_trackOrder[i]] = i;
     }
 
     // At this point, the original set of tracks have been divided into two
@@ -609,6 +630,76 @@ void BaseTrackCache::filterAndSort(const QSet<TrackId>& trackIds,
     }
 }
 
+bool BaseTrackCache::filterAndSortInMemory(const QSet<TrackId>& trackIds,
+                                           const QueryNode& query,
+                                           const QList<SortColumn>& sortColumns,
+                                           const int columnOffset) {
+    PerformanceTimer timer;
+    timer.start();
+
+    // Sort by the same columns as the ORDER BY clause that
+    // BaseSqlTableModel::setSort() generates.
+    QList<TrackColumnStore::SortColumn> storeSortColumns;
+    for (const auto& sc: sortColumns) {
+        int column;
+        if (sc.m_column > columnOffset) {
+            column = sc.m_column - columnOffset;
+        } else if (sc.m_column == 0) {
+            // The id column
+            column = 0;
+        } else {
+            // Not a column of this cache
+            continue;
+        }
+        const ColumnCache::SortType sortType =
+                m_columnCache.columnSortTypeForFieldIndex(column);
+        if (sortType == ColumnCache::SORT_KEY) {
+            // Keys are sorted by their id
+            column = fieldIndex(ColumnCache::COLUMN_LIBRARYTABLE_KEY_ID);
+        }
+        if (column < 0 || column >= m_columnCount) {
+            return false;
+        }
+        storeSortColumns.append(TrackColumnStore::SortColumn(
+                column, sortType, sc.m_order));
+    }
+
+    if (!query.prepareStoreMatch(&m_trackColumnStore)) {
+        return false;
+    }
+
+    QVector<int> rows;
+    rows.reserve(trackIds.size());
+    for (const auto& trackId: trackIds) {
+        const int row = m_trackColumnStore.row(trackId);
+        // Tracks that are not in the table are never in the result
+        if (row < 0) {
+            continue;
+        }
+        const StoreMatch match = query.matchStore(m_trackColumnStore, row);
+        if (match == StoreMatch::Match || match == StoreMatch::Unconstrained) {
+            rows.append(row);
+        }
+    }
+
+    if (!storeSortColumns.isEmpty()) {
+        std::sort(rows.begin(), rows.end());
+        m_trackColumnStore.sortRows(&rows, storeSortColumns,
+                m_columnCache.keyNotation());
+    }
+
+    m_trackOrder.reserve(rows.size());
+    for (int row: qAsConst(rows)) {
+        m_trackOrder.append(m_trackColumnStore.trackId(row));
+    }
+
+    if (sDebug) {
+        qDebug() << this << "filterAndSortInMemory took"
+                 << timer.elapsed().debugMillisWithUnit();
+    }
+    return true;
+}
+
 std::unique_ptr<QueryNode> BaseTrackCache::parseQuery(QString query, QString extraFilter,
                                       QStringList idStrings) const {
     QStringList queryFragments;
@@ -655,7 +746,7 @@ int BaseTrackCache::findSortInsertionPoint(TrackPointer pTrack,
 
         // This should not happen, but it's a recoverable error so we should
         // only log it.
-        if (!m_trackInfo.contains(otherTrackId)) {
+        if (!m_trackColumnStore.contains(otherTrackId)) {
             qDebug() << "WARNING: track" << otherTrackId << "was not in index";
             //updateTrackInIndex(otherTrackId);
         }
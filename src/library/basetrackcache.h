@@ -15,6 +15,7 @@
 
 #include "library/dao/trackdao.h"
 #include "library/columncache.h"
+#include "library/trackcolumnstore.h"
 #include "track/track.h"
 #include "util/class.h"
 #include "util/memory.h"
@@ -101,6 +102,12 @@ class BaseTrackCache : public QObject {
 
     std::unique_ptr<QueryNode> parseQuery(QString query, QString extraFilter,
                           QStringList idStrings) const;
+    // Filters and sorts the tracks with m_trackColumnStore instead of SQL.
+    // Returns false if the query can only be evaluated in SQL.
+    bool filterAndSortInMemory(const QSet<TrackId>& trackIds,
+                               const QueryNode& query,
+                               const QList<SortColumn>& sortColumns,
+                               const int columnOffset);
     int findSortInsertionPoint(TrackPointer pTrack,
                                const QList<SortColumn>& sortColumns,
                                const int columnOffset,
@@ -143,7 +150,9 @@ class BaseTrackCache : public QObject {
 
     bool m_bIndexBuilt;
     bool m_bIsCaching;
-    QHash<TrackId, QVector<QVariant> > m_trackInfo;
+    // The values of all tracks in the table. Locations are stored with Qt
+    // separators like in the database.
+    TrackColumnStore m_trackColumnStore;
     TrackDAO& m_trackDAO;
     QSqlDatabase m_database;
     SearchQueryParser* m_pQueryParser;
@@ -4,6 +4,12 @@
 #include "library/dao/playlistdao.h"
 #include "track/key_preferences.h"
 
+namespace {
+
+const QString kSortInt("cast(%1 as integer)");
+const QString kSortNoCase("lower(%1)");
+
+} // anonymous namespace
 
  ColumnCache::ColumnCache(const QStringList& columns) {
     m_pKeyNotationCP = new ControlProxy("[Library]", "key_notation", this);
@@ -78,8 +84,8 @@ void ColumnCache::setColumns(const QStringList& columns) {
     m_columnIndexByEnum[COLUMN_PLAYLISTTRACKSTABLE_TITLE] = fieldIndex(PLAYLISTTRACKSTABLE_TITLE);
     m_columnIndexByEnum[COLUMN_PLAYLISTTRACKSTABLE_DATETIMEADDED] = fieldIndex(PLAYLISTTRACKSTABLE_DATETIMEADDED);
 
-    const QString sortInt("cast(%1 as integer)");
-    const QString sortNoCase("lower(%1)");
+    const QString& sortInt = kSortInt;
+    const QString& sortNoCase = kSortNoCase;
 
     m_columnSortByIndex.clear();
     // Add the columns that requires a special sort
@@ -103,6 +109,19 @@ void ColumnCache::setColumns(const QStringList& columns) {
     slotSetKeySortOrder(m_pKeyNotationCP->get());
 }
 
+ColumnCache::SortType ColumnCache::columnSortTypeForFieldIndex(int index) const {
+    if (index >= 0 && index == m_columnIndexByEnum[COLUMN_LIBRARYTABLE_KEY]) {
+        return SORT_KEY;
+    }
+    const QString format = m_columnSortByIndex.value(index);
+    if (format == kSortNoCase) {
+        return SORT_NOCASE;
+    } else if (format == kSortInt) {
+        return SORT_INTEGER;
+    }
+    return SORT_DEFAULT;
+}
+
 void ColumnCache::slotSetKeySortOrder(double notationValue) {
     if (m_columnIndexByEnum[COLUMN_LIBRARYTABLE_KEY] < 0) return;
 
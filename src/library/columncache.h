@@ -101,6 +101,18 @@ class ColumnCache : public QObject {
         return format.arg(columnNameForFieldIndex(index));
     }
 
+    // How the SQL expression of columnSortForFieldIndex() orders the values
+    enum SortType {
+        SORT_DEFAULT,
+        // lower(column)
+        SORT_NOCASE,
+        // cast(column as integer)
+        SORT_INTEGER,
+        // By the circle of fifths order of the key_id column
+        SORT_KEY,
+    };
+    SortType columnSortTypeForFieldIndex(int index) const;
+
     QStringList m_columnsByIndex;
     QMap<int, QString> m_columnSortByIndex;
     QMap<QString, int> m_columnIndexByName;
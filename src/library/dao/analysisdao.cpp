@@ -65,7 +65,6 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
         return analyses;
     }
 
-    int bytes = 0;
     QSqlRecord queryRecord = query->record();
     const int idColumn = queryRecord.indexOf("id");
     const int typeColumn = queryRecord.indexOf("type");
@@ -81,28 +80,31 @@ QList<AnalysisDao::AnalysisInfo> AnalysisDao::loadAnalysesFromQuery(TrackId trac
         info.type = static_cast<AnalysisType>(query->value(typeColumn).toInt());
         info.description = query->value(descriptionColumn).toString();
         info.version = query->value(versionColumn).toString();
-        int checksum = query->value(dataChecksumColumn).toInt();
-        QString dataPath = analysisPath.absoluteFilePath(
+        info.dataChecksum = query->value(dataChecksumColumn).toInt();
+        info.dataPath = analysisPath.absoluteFilePath(
             QString::number(info.analysisId));
-        QByteArray compressedData = loadDataFromFile(dataPath);
-        int file_checksum = qChecksum(compressedData.constData(),
-                                      compressedData.length());
-        if (checksum != file_checksum) {
-            qDebug() << "WARNING: Corrupt analysis loaded from" << dataPath
-                     << "length" << compressedData.length();
-            continue;
-        }
-        info.data = qUncompress(compressedData);
-        bytes += info.data.length();
         analyses.append(info);
     }
-    qDebug() << "AnalysisDAO fetched" << analyses.size() << "analyses,"
-             << bytes << "bytes for track"
+    qDebug() << "AnalysisDAO fetched" << analyses.size() << "analyses for track"
              << trackId << "in" << time.elapsed().debugMillisWithUnit();
     return analyses;
 }
 
-bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
+bool AnalysisDao::loadAnalysisData(AnalysisDao::AnalysisInfo* info) const {
+    QByteArray compressedData = loadDataFromFile(info->dataPath);
+    int file_checksum = qChecksum(compressedData.constData(),
+                                  compressedData.length());
+    if (info->dataChecksum != file_checksum) {
+        qDebug() << "WARNING: Corrupt analysis loaded from" << info->dataPath
+                 << "length" << compressedData.length();
+        return false;
+    }
+    info->data = qUncompress(compressedData);
+    return true;
+}
+
+bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info,
+        DataFormat format) {
     if (!m_db.isOpen() || info == NULL) {
         return false;
     }
@@ -114,7 +116,8 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
     PerformanceTimer time;
     time.start();
 
-    QByteArray compressedData = qCompress(info->data, kCompressionLevel);
+    QByteArray compressedData = format == DataFormat::Compressed ?
+            qCompress(info->data, kCompressionLevel) : info->data;
     int checksum = qChecksum(compressedData.constData(),
                              compressedData.length());
 
@@ -166,6 +169,8 @@ bool AnalysisDao::saveAnalysis(AnalysisDao::AnalysisInfo* info) {
         qDebug() << "WARNING: Couldn't save analysis data to file" << dataPath;
         return false;
     }
+    info->dataPath = dataPath;
+    info->dataChecksum = checksum;
 
     qDebug() << "AnalysisDAO saved analysis" << info->analysisId
              << QString("%1 (%2 compressed)").arg(QString::number(info->data.length()),
@@ -331,7 +336,7 @@ void AnalysisDao::saveTrackAnalyses(
     analysis.description = pWaveform->getDescription();
     analysis.version = pWaveform->getVersion();
     analysis.data = pWaveform->toByteArray();
-    bool success = saveAnalysis(&analysis);
+    bool success = saveAnalysis(&analysis, DataFormat::Uncompressed);
     if (success) {
         pWaveform->setSaveState(Waveform::SaveState::Saved);
     }
@@ -347,7 +352,7 @@ void AnalysisDao::saveTrackAnalyses(
     analysis.version = pWaveSummary->getVersion();
     analysis.data = pWaveSummary->toByteArray();
 
-    success = saveAnalysis(&analysis);
+    success = saveAnalysis(&analysis, DataFormat::Uncompressed);
     if (success) {
         pWaveSummary->setSaveState(Waveform::SaveState::Saved);
     }
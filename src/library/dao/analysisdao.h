@@ -20,16 +20,28 @@ class AnalysisDao : public DAO {
         TYPE_WAVESUMMARY
     };
 
+    enum class DataFormat {
+        // Compressed with qCompress(), read with loadAnalysisData()
+        Compressed,
+        // Stored as is for mapping the file into memory
+        Uncompressed
+    };
+
     struct AnalysisInfo {
         AnalysisInfo()
                 : analysisId(-1),
-                  type(TYPE_UNKNOWN) {
+                  type(TYPE_UNKNOWN),
+                  dataChecksum(0) {
         }
         int analysisId;
         TrackId trackId;
         AnalysisType type;
         QString description;
         QString version;
+        // The file that stores the data of a loaded analysis
+        QString dataPath;
+        int dataChecksum;
+        // Not filled when loading analyses, see loadAnalysisData()
         QByteArray data;
     };
 
@@ -50,9 +62,15 @@ class AnalysisDao : public DAO {
         m_db = database;
     }
 
+    // The data of the returned analyses is not read, the caller decides
+    // whether to read it with loadAnalysisData() or to map the file.
     QList<AnalysisInfo> getAnalysesForTrackByType(TrackId trackId, AnalysisType type);
     QList<AnalysisInfo> getAnalysesForTrack(TrackId trackId);
-    bool saveAnalysis(AnalysisInfo* analysis);
+    // Reads the data of an analysis that has been saved in the Compressed
+    // format. Returns false if the file is missing or corrupt.
+    bool loadAnalysisData(AnalysisInfo* analysis) const;
+    bool saveAnalysis(AnalysisInfo* analysis,
+            DataFormat format = DataFormat::Compressed);
     bool deleteAnalysis(const int analysisId);
     void deleteAnalyses(const QList<TrackId>& trackIds);
     bool deleteAnalysesForTrack(TrackId trackId);
@@ -7,11 +7,14 @@
 
 #include "libraryhashdao.h"
 #include "library/queryutil.h"
+#include "util/db/sqlstringformatter.h"
+#include "util/db/sqllikewildcards.h"
+#include "util/db/sqllikewildcardescaper.h"
 
-QHash<QString, int> LibraryHashDAO::getDirectoryHashes() {
+QHash<QString, qint64> LibraryHashDAO::getDirectoryHashes() {
     QSqlQuery query(m_database);
     query.prepare("SELECT hash, directory_path FROM LibraryHashes");
-    QHash<QString, int> hashes;
+    QHash<QString, qint64> hashes;
     if (!query.exec()) {
         LOG_FAILED_QUERY(query);
     }
@@ -20,15 +23,54 @@ QHash<QString, int> LibraryHashDAO::getDirectoryHashes() {
     int directoryPathColumn = query.record().indexOf("directory_path");
     while (query.next()) {
         hashes[query.value(directoryPathColumn).toString()] =
-                query.value(hashColumn).toInt();
+                query.value(hashColumn).toLongLong();
     }
 
     return hashes;
 }
 
-int LibraryHashDAO::getDirectoryHash(const QString& dirPath) {
+QHash<QString, qint64> LibraryHashDAO::getDirectoryHashes(
+        const QStringList& dirPaths) {
+    QHash<QString, qint64> hashes;
+    if (dirPaths.isEmpty()) {
+        return hashes;
+    }
+    // The direct subdirectories match 'dir/%' but not 'dir/%/%'
+    QStringList subdirectoryConditions;
+    for (const QString& dirPath : dirPaths) {
+        const QString escapedPath = SqlLikeWildcardEscaper::apply(
+                dirPath + "/", kSqlLikeMatchAll);
+        subdirectoryConditions << QString(
+                "(directory_path LIKE %1 ESCAPE '%2' AND "
+                "directory_path NOT LIKE %3 ESCAPE '%2')").arg(
+                        SqlStringFormatter::format(m_database,
+                                escapedPath + kSqlLikeMatchAll),
+                        kSqlLikeMatchAll,
+                        SqlStringFormatter::format(m_database,
+                                escapedPath + kSqlLikeMatchAll + "/" +
+                                kSqlLikeMatchAll));
+    }
+    QSqlQuery query(m_database);
+    query.prepare(QString("SELECT hash, directory_path FROM LibraryHashes "
+                          "WHERE directory_path IN (%1) OR %2").arg(
+                                  SqlStringFormatter::formatList(m_database, dirPaths),
+                                  subdirectoryConditions.join(" OR ")));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+
+    const int hashColumn = query.record().indexOf("hash");
+    const int directoryPathColumn = query.record().indexOf("directory_path");
+    while (query.next()) {
+        hashes[query.value(directoryPathColumn).toString()] =
+                query.value(hashColumn).toLongLong();
+    }
+    return hashes;
+}
+
+qint64 LibraryHashDAO::getDirectoryHash(const QString& dirPath) {
     //qDebug() << "LibraryHashDAO::getDirectoryHash" << QThread::currentThread() << m_database.connectionName();
-    int hash = -1;
+    qint64 hash = -1;
 
     QSqlQuery query(m_database);
     query.prepare("SELECT hash FROM LibraryHashes "
@@ -40,7 +82,7 @@ int LibraryHashDAO::getDirectoryHash(const QString& dirPath) {
     }
     //Grab a hash for this directory from the database, from the last time it was scanned.
     if (query.next()) {
-        hash = query.value(query.record().indexOf("hash")).toInt();
+        hash = query.value(query.record().indexOf("hash")).toLongLong();
         //qDebug() << "prev hash exists" << hash << dirPath;
     } else {
         //qDebug() << "prev hash does not exist" << dirPath;
@@ -49,10 +91,12 @@ int LibraryHashDAO::getDirectoryHash(const QString& dirPath) {
     return hash;
 }
 
-void LibraryHashDAO::saveDirectoryHash(const QString& dirPath, const int hash) {
+void LibraryHashDAO::saveDirectoryHash(const QString& dirPath, const qint64 hash) {
     //qDebug() << "LibraryHashDAO::saveDirectoryHash" << QThread::currentThread() << m_database.connectionName();
     QSqlQuery query(m_database);
-    query.prepare("INSERT INTO LibraryHashes (directory_path, hash, directory_deleted) "
+    // Replaces the hash of a directory that has been removed and restored in
+    // the meantime, see LibraryScanner::scanDirectories()
+    query.prepare("INSERT OR REPLACE INTO LibraryHashes (directory_path, hash, directory_deleted) "
                     "VALUES (:directory_path, :hash, :directory_deleted)");
     query.bindValue(":directory_path", dirPath);
     query.bindValue(":hash", hash);
@@ -65,7 +109,7 @@ void LibraryHashDAO::saveDirectoryHash(const QString& dirPath, const int hash) {
 }
 
 void LibraryHashDAO::updateDirectoryHash(const QString& dirPath,
-                                         const int newHash,
+                                         const qint64 newHash,
                                          const int dir_deleted) {
     //qDebug() << "LibraryHashDAO::updateDirectoryHash" << QThread::currentThread() << m_database.connectionName();
     QSqlQuery query(m_database);
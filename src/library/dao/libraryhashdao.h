@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QHash>
 #include <QString>
+#include <QStringList>
 #include <QSqlDatabase>
 
 #include "library/dao/dao.h"
@@ -16,10 +17,14 @@ class LibraryHashDAO : public DAO {
         m_database = database;
     };
 
-    QHash<QString, int> getDirectoryHashes();
-    int getDirectoryHash(const QString& dirPath);
-    void saveDirectoryHash(const QString& dirPath, const int hash);
-    void updateDirectoryHash(const QString& dirPath, const int newHash,
+    // The hashes are the DirectoryFingerprints of the directories
+    QHash<QString, qint64> getDirectoryHashes();
+    // Only the hashes of the given directories and their direct
+    // subdirectories
+    QHash<QString, qint64> getDirectoryHashes(const QStringList& dirPaths);
+    qint64 getDirectoryHash(const QString& dirPath);
+    void saveDirectoryHash(const QString& dirPath, const qint64 hash);
+    void updateDirectoryHash(const QString& dirPath, const qint64 newHash,
                              const int dir_deleted);
     void markAsExisting(const QString& dirPath);
     void invalidateAllDirectories();
@@ -180,6 +180,59 @@ QSet<QString> TrackDAO::getTrackLocations() {
     return locations;
 }
 
+namespace {
+
+QHash<QString, TrackFileStat> queryTrackFileStats(QSqlDatabase database,
+        const QString& whereClause) {
+    QHash<QString, TrackFileStat> fileStats;
+    QSqlQuery query(database);
+    query.prepare("SELECT track_locations.location, track_locations.filesize, "
+                  "track_locations.fs_modified FROM track_locations "
+                  "INNER JOIN library on library.location = track_locations.id" +
+                  whereClause);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+    }
+
+    const int locationColumn = query.record().indexOf("location");
+    const int filesizeColumn = query.record().indexOf("filesize");
+    const int modifiedColumn = query.record().indexOf("fs_modified");
+    while (query.next()) {
+        const QVariant modified = query.value(modifiedColumn);
+        fileStats.insert(query.value(locationColumn).toString(),
+                modified.isNull() ? TrackFileStat() : TrackFileStat(
+                        query.value(filesizeColumn).toLongLong(),
+                        modified.toLongLong()));
+    }
+    return fileStats;
+}
+
+} // anonymous namespace
+
+QHash<QString, TrackFileStat> TrackDAO::getTrackFileStats() {
+    return queryTrackFileStats(m_database, QString());
+}
+
+QHash<QString, TrackFileStat> TrackDAO::getTrackFileStats(
+        const QStringList& directories) {
+    return queryTrackFileStats(m_database,
+            QString(" WHERE track_locations.directory IN (%1)").arg(
+                    SqlStringFormatter::formatList(m_database, directories)));
+}
+
+bool TrackDAO::isTrackLocationInLibrary(const QString& location) {
+    QSqlQuery query(m_database);
+    query.prepare("SELECT library.id FROM library INNER JOIN track_locations "
+                  "ON library.location = track_locations.id "
+                  "WHERE track_locations.location=:location");
+    query.bindValue(":location", location);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return false;
+    }
+    return query.next();
+}
+
 // Some code (eg. drag and drop) needs to just get a track's location, and it's
 // not worth retrieving a whole Track.
 QString TrackDAO::getTrackLocation(TrackId trackId) {
@@ -318,9 +371,9 @@ void TrackDAO::addTracksPrepare() {
 
     m_pQueryTrackLocationInsert->prepare("INSERT INTO track_locations "
             "("
-            "location,directory,filename,filesize,fs_deleted,needs_verification"
+            "location,directory,filename,filesize,fs_modified,fs_deleted,needs_verification"
             ") VALUES ("
-            ":location,:directory,:filename,:filesize,:fs_deleted,:needs_verification"
+            ":location,:directory,:filename,:filesize,:fs_modified,:fs_deleted,:needs_verification"
             ")");
 
     m_pQueryTrackLocationSelect->prepare("SELECT id FROM track_locations WHERE location=:location");
@@ -379,6 +432,8 @@ namespace {
         pTrackLocationInsert->bindValue(":directory", track.getDirectory());
         pTrackLocationInsert->bindValue(":filename", track.getFileName());
         pTrackLocationInsert->bindValue(":filesize", track.getFileSize());
+        pTrackLocationInsert->bindValue(":fs_modified",
+                track.getFileModifiedTime().toMSecsSinceEpoch());
         pTrackLocationInsert->bindValue(":fs_deleted", 0);
         pTrackLocationInsert->bindValue(":needs_verification", 0);
         if (pTrackLocationInsert->exec()) {
@@ -615,7 +670,8 @@ TrackId TrackDAO::addTracksAddTrack(const TrackPointer& pTrack, bool unremove) {
     return trackId;
 }
 
-TrackPointer TrackDAO::addTracksAddFile(const QFileInfo& fileInfo, bool unremove) {
+TrackPointer TrackDAO::addTracksAddFile(const QFileInfo& fileInfo, bool unremove,
+        const TrackPointer& pImportedTrack) {
     // Check that track is a supported extension.
     // TODO(uklotzde): The following check can be skipped if
     // the track is already in the library. A refactoring is
@@ -647,7 +703,11 @@ TrackPointer TrackDAO::addTracksAddFile(const QFileInfo& fileInfo, bool unremove
 
     // Initially (re-)import the metadata for the newly created track
     // from the file.
-    SoundSourceProxy(pTrack).updateTrackFromSource();
+    if (pImportedTrack) {
+        SoundSourceProxy::updateTrackFromImportedTrack(pTrack.get(), *pImportedTrack);
+    } else {
+        SoundSourceProxy(pTrack).updateTrackFromSource();
+    }
     if (!pTrack->isMetadataSynchronized()) {
         qWarning() << "TrackDAO::addTracksAddFile:"
                 << "Failed to parse track metadata from file"
@@ -1474,6 +1534,20 @@ void TrackDAO::invalidateTrackLocationsInLibrary() {
     }
 }
 
+void TrackDAO::invalidateTrackLocationsInDirectories(
+        const QStringList& directories) {
+    QSqlQuery query(m_database);
+    query.prepare(QString("UPDATE track_locations "
+                          "SET needs_verification=1 "
+                          "WHERE directory IN (%1)").arg(
+                                  SqlStringFormatter::formatList(m_database, directories)));
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't mark tracks in" << directories.size()
+                << "directories as needing verification.";
+    }
+}
+
 void TrackDAO::markTrackLocationsAsVerified(const QStringList& locations) {
     //qDebug() << "TrackDAO::markTrackLocationsAsVerified" << QThread::currentThread() << m_database.connectionName();
 
@@ -1526,6 +1600,87 @@ void TrackDAO::markUnverifiedTracksAsDeleted() {
     }
 }
 
+TrackId TrackDAO::updateTrackFromChangedFile(const QString& location,
+        const TrackFileStat& fileStat,
+        const TrackPointer& pImportedTrack) {
+    QSqlQuery query(m_database);
+    query.prepare("UPDATE track_locations "
+                  "SET filesize=:filesize, fs_modified=:fs_modified "
+                  "WHERE location=:location");
+    query.bindValue(":filesize", fileStat.size());
+    query.bindValue(":fs_modified", fileStat.modified());
+    query.bindValue(":location", location);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't update the file of" << location;
+        return TrackId();
+    }
+
+    // Keep the metadata in the library if the file couldn't be read
+    if (!pImportedTrack || !pImportedTrack->isMetadataSynchronized()) {
+        return TrackId();
+    }
+
+    query.prepare("SELECT library.id FROM library INNER JOIN track_locations "
+                  "ON library.location=track_locations.id "
+                  "WHERE track_locations.location=:location");
+    query.bindValue(":location", location);
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query);
+        return TrackId();
+    }
+    if (!query.next()) {
+        return TrackId();
+    }
+    const TrackId trackId(query.value(0));
+
+    // Only the columns that are imported from the file. The analysis
+    // results and everything the user has entered in Mixxx are kept.
+    const Track& track = *pImportedTrack;
+    query.prepare("UPDATE library SET "
+            "artist=:artist,"
+            "title=:title,"
+            "album=:album,"
+            "album_artist=:album_artist,"
+            "year=:year,"
+            "genre=:genre,"
+            "composer=:composer,"
+            "grouping=:grouping,"
+            "tracknumber=:tracknumber,"
+            "tracktotal=:tracktotal,"
+            "filetype=:filetype,"
+            "comment=:comment,"
+            "duration=:duration,"
+            "bitrate=:bitrate,"
+            "samplerate=:samplerate,"
+            "channels=:channels,"
+            "header_parsed=1"
+            " WHERE id=:track_id");
+    query.bindValue(":artist", track.getArtist());
+    query.bindValue(":title", track.getTitle());
+    query.bindValue(":album", track.getAlbum());
+    query.bindValue(":album_artist", track.getAlbumArtist());
+    query.bindValue(":year", track.getYear());
+    query.bindValue(":genre", track.getGenre());
+    query.bindValue(":composer", track.getComposer());
+    query.bindValue(":grouping", track.getGrouping());
+    query.bindValue(":tracknumber", track.getTrackNumber());
+    query.bindValue(":tracktotal", track.getTrackTotal());
+    query.bindValue(":filetype", track.getType());
+    query.bindValue(":comment", track.getComment());
+    query.bindValue(":duration", track.getDuration());
+    query.bindValue(":bitrate", track.getBitrate());
+    query.bindValue(":samplerate", track.getSampleRate());
+    query.bindValue(":channels", track.getChannels());
+    query.bindValue(":track_id", trackId.toVariant());
+    if (!query.exec()) {
+        LOG_FAILED_QUERY(query)
+                << "Couldn't update the metadata of" << location;
+        return TrackId();
+    }
+    return trackId;
+}
+
 // Look for moved files. Look for files that have been marked as
 // "deleted on disk" and see if another "file" with the same name and
 // files size exists in the track_locations table. That means the file has
@@ -2,14 +2,17 @@
 #define TRACKDAO_H
 
 #include <QFileInfo>
+#include <QHash>
 #include <QObject>
 #include <QSet>
 #include <QList>
 #include <QSqlDatabase>
 #include <QString>
+#include <QStringList>
 
 #include "preferences/usersettings.h"
 #include "library/dao/dao.h"
+#include "library/dao/trackfilestat.h"
 #include "track/globaltrackcache.h"
 #include "util/class.h"
 #include "util/memory.h"
@@ -48,13 +51,25 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
 
     // Returns a set of all track locations in the library.
     QSet<QString> getTrackLocations();
+    // Returns the stored size and modification time of the files of all
+    // tracks in the library by location.
+    QHash<QString, TrackFileStat> getTrackFileStats();
+    // Only of the tracks in the given directories
+    QHash<QString, TrackFileStat> getTrackFileStats(
+            const QStringList& directories);
+    bool isTrackLocationInLibrary(const QString& location);
     QString getTrackLocation(TrackId trackId);
 
     TrackPointer addSingleTrack(const QFileInfo& fileInfo, bool unremove);
     QList<TrackId> addMultipleTracks(const QList<QFileInfo>& fileInfoList, bool unremove);
 
     void addTracksPrepare();
-    TrackPointer addTracksAddFile(const QFileInfo& fileInfo, bool unremove);
+    // The metadata of the file is taken from pImportedTrack if it is a
+    // temporary track that has already been imported from the file, see
+    // SoundSourceProxy::importTemporaryTrackOfNewFile(). Otherwise the file
+    // is read here.
+    TrackPointer addTracksAddFile(const QFileInfo& fileInfo, bool unremove,
+            const TrackPointer& pImportedTrack = TrackPointer());
     TrackId addTracksAddTrack(const TrackPointer& pTrack, bool unremove);
     void addTracksFinish(bool rollback = false);
 
@@ -89,12 +104,22 @@ class TrackDAO : public QObject, public virtual DAO, public virtual GlobalTrackC
     void markTrackLocationsAsVerified(const QStringList& locations);
     void markTracksInDirectoriesAsVerified(const QStringList& directories);
     void invalidateTrackLocationsInLibrary();
+    void invalidateTrackLocationsInDirectories(const QStringList& directories);
     void markUnverifiedTracksAsDeleted();
     bool detectMovedTracks(QSet<TrackId>* pTracksMovedSetOld,
                           QSet<TrackId>* pTracksMovedSetNew,
                           const QStringList& addedTracks,
                           volatile const bool* pCancel);
 
+    // Stores the new size and modification time of a file that has been
+    // modified since its tags were read. The metadata of the track is
+    // replaced with the metadata of pImportedTrack, a temporary track that
+    // has been imported from the file, if the import succeeded. Returns the
+    // id of the track if its metadata has been updated.
+    TrackId updateTrackFromChangedFile(const QString& location,
+            const TrackFileStat& fileStat,
+            const TrackPointer& pImportedTrack);
+
     bool verifyRemainingTracks(
             const QStringList& libraryRootDirs,
             volatile const bool* pCancel);
@@ -0,0 +1,56 @@
+#ifndef TRACKFILESTAT_H
+#define TRACKFILESTAT_H
+
+#include <QDateTime>
+#include <QFileInfo>
+
+// The size and the time of the last modification of a track's file, as
+// stored in track_locations when the tags were read. The library scanner
+// compares them with the file system to find files that have been changed
+// in place, without reading the files.
+class TrackFileStat {
+  public:
+    TrackFileStat()
+            : m_size(-1),
+              m_modified(-1) {
+    }
+    TrackFileStat(qint64 size, qint64 modified)
+            : m_size(size),
+              m_modified(modified) {
+    }
+
+    // Uses the cached values of fileInfo if it has been populated before
+    static TrackFileStat fromFileInfo(const QFileInfo& fileInfo) {
+        return TrackFileStat(fileInfo.size(),
+                fileInfo.lastModified().toMSecsSinceEpoch());
+    }
+
+    qint64 size() const {
+        return m_size;
+    }
+
+    // Milliseconds since the epoch
+    qint64 modified() const {
+        return m_modified;
+    }
+
+    // The time of the last modification is not known for tracks that have
+    // been added before it was stored.
+    bool isValid() const {
+        return m_modified >= 0;
+    }
+
+  private:
+    qint64 m_size;
+    qint64 m_modified;
+};
+
+inline bool operator==(const TrackFileStat& lhs, const TrackFileStat& rhs) {
+    return lhs.size() == rhs.size() && lhs.modified() == rhs.modified();
+}
+
+inline bool operator!=(const TrackFileStat& lhs, const TrackFileStat& rhs) {
+    return !(lhs == rhs);
+}
+
+#endif // TRACKFILESTAT_H
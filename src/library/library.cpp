@@ -28,6 +28,7 @@
 #include "library/traktor/traktorfeature.h"
 #include "library/librarycontrol.h"
 #include "library/setlogfeature.h"
+#include "library/scanner/librarywatcher.h"
 #include "util/db/dbconnectionpooled.h"
 #include "util/sandbox.h"
 #include "util/logger.h"
@@ -164,6 +165,11 @@ Library::Library(
         qDebug() << "Checking for access to" << directoryPath << ":" << hasAccess;
     }
 
+    // Keeps the library up to date between scans
+    if (m_pConfig->getValue(ConfigKey(kConfigGroup, "WatchDirectories"), false)) {
+        m_pWatcher.reset(new LibraryWatcher(&m_scanner));
+    }
+
     m_iTrackTableRowHeight = m_pConfig->getValue(
             ConfigKey(kConfigGroup, "RowHeight"), kDefaultRowHeightPx);
     QString fontStr = m_pConfig->getValueString(ConfigKey(kConfigGroup, "Font"));
@@ -368,6 +374,9 @@ void Library::slotRequestAddDir(QString dir) {
     if (m_pConfig->getValueString(PREF_LEGACY_LIBRARY_DIR).length() < 1) {
         m_pConfig->set(PREF_LEGACY_LIBRARY_DIR, dir);
     }
+    if (m_pWatcher) {
+        m_pWatcher->slotRefreshDirectories();
+    }
 }
 
 void Library::slotRequestRemoveDir(QString dir, RemovalType removalType) {
@@ -404,6 +413,9 @@ void Library::slotRequestRemoveDir(QString dir, RemovalType removalType) {
             m_pConfig->set(PREF_LEGACY_LIBRARY_DIR, QString());
         }
     }
+    if (m_pWatcher) {
+        m_pWatcher->slotRefreshDirectories();
+    }
 }
 
 void Library::slotRequestRelocateDir(QString oldDir, QString newDir) {
@@ -415,6 +427,9 @@ void Library::slotRequestRelocateDir(QString oldDir, QString newDir) {
     if (oldDir == conDir) {
         m_pConfig->set(PREF_LEGACY_LIBRARY_DIR, newDir);
     }
+    if (m_pWatcher) {
+        m_pWatcher->slotRefreshDirectories();
+    }
 }
 
 QStringList Library::getDirs() {
@@ -33,6 +33,7 @@ class MixxxLibraryFeature;
 class PlaylistFeature;
 class CrateFeature;
 class LibraryControl;
+class LibraryWatcher;
 class KeyboardEventFilter;
 class PlayerManagerInterface;
 
@@ -145,6 +146,8 @@ class Library: public QObject,
     CrateFeature* m_pCrateFeature;
     AnalysisFeature* m_pAnalysisFeature;
     LibraryScanner m_scanner;
+    // Only if enabled in the config
+    QScopedPointer<LibraryWatcher> m_pWatcher;
     QFont m_trackTableFont;
     int m_iTrackTableRowHeight;
     bool m_editMetadataSelectedClick;
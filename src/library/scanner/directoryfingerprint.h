@@ -0,0 +1,49 @@
+#ifndef DIRECTORYFINGERPRINT_H
+#define DIRECTORYFINGERPRINT_H
+
+#include <QString>
+
+#include "library/dao/trackfilestat.h"
+
+// A 64-bit fingerprint of the audio files in a directory that changes when
+// a file is added, removed, renamed or modified. Every file is hashed from
+// its name, size and modification time and the hashes are summed up, so
+// the result does not depend on the order of the directory entries and no
+// list of the files needs to be built.
+//
+// A fingerprint of 0 is a real fingerprint of a directory without files,
+// -1 is used for directories without a fingerprint in the database.
+class DirectoryFingerprint {
+  public:
+    DirectoryFingerprint()
+            : m_sum(0) {
+    }
+
+    void addFile(const QString& fileName, const TrackFileStat& fileStat) {
+        // FNV-1a over the UTF-16 code units of the name
+        quint64 hash = 14695981039346656037ULL;
+        const QChar* pChars = fileName.constData();
+        for (int i = 0; i < fileName.size(); ++i) {
+            hash = (hash ^ pChars[i].unicode()) * 1099511628211ULL;
+        }
+        hash = mix(hash ^ static_cast<quint64>(fileStat.size()));
+        hash = mix(hash ^ static_cast<quint64>(fileStat.modified()));
+        m_sum += hash;
+    }
+
+    qint64 value() const {
+        return static_cast<qint64>(m_sum);
+    }
+
+  private:
+    // The finalizer of SplitMix64, spreads every input bit over the result
+    static quint64 mix(quint64 x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    quint64 m_sum;
+};
+
+#endif // DIRECTORYFINGERPRINT_H
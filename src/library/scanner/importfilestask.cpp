@@ -1,20 +1,44 @@
 #include "library/scanner/importfilestask.h"
 
+#include <QDateTime>
+
 #include "library/scanner/libraryscanner.h"
+#include "sources/soundsourceproxy.h"
 #include "track/trackref.h"
 #include "util/timer.h"
 
+namespace {
+
+// Whether the file might still be written, e.g. while it is copied into the
+// library. Writing a file doesn't change its directory, so the watcher that
+// has triggered the scan doesn't know when it is done. The size or the time
+// of the last modification has changed since the directory was listed, or
+// the file has been modified within the quiet period.
+bool isBeingWritten(const QFileInfo& listedFileInfo, int quietMillis) {
+    const QFileInfo fileInfo(listedFileInfo.filePath());
+    const TrackFileStat fileStat = TrackFileStat::fromFileInfo(fileInfo);
+    if (fileStat != TrackFileStat::fromFileInfo(listedFileInfo)) {
+        return true;
+    }
+    const qint64 ageMillis =
+            QDateTime::currentMSecsSinceEpoch() - fileStat.modified();
+    // A clock that is off must not keep the file out of the library forever
+    return ageMillis >= 0 && ageMillis < quietMillis;
+}
+
+} // anonymous namespace
+
 ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
                                  const ScannerGlobalPointer scannerGlobal,
                                  const QString& dirPath,
-                                 const bool prevHashExists,
-                                 const int newHash,
+                                 const qint64 prevHash,
+                                 const qint64 newHash,
                                  const QLinkedList<QFileInfo>& filesToImport,
                                  const QLinkedList<QFileInfo>& possibleCovers,
                                  SecurityTokenPointer pToken)
         : ScannerTask(pScanner, scannerGlobal),
           m_dirPath(dirPath),
-          m_prevHashExists(prevHashExists),
+          m_prevHash(prevHash),
           m_newHash(newHash),
           m_filesToImport(filesToImport),
           m_possibleCovers(possibleCovers),
@@ -23,6 +47,8 @@ ImportFilesTask::ImportFilesTask(LibraryScanner* pScanner,
 
 void ImportFilesTask::run() {
     ScopedTimer timer("ImportFilesTask::run");
+    bool skippedFiles = false;
+    bool incomplete = false;
     for (const QFileInfo& fileInfo: m_filesToImport) {
         // If a flag was raised telling us to cancel the library scan then stop.
         if (m_scannerGlobal->shouldCancel()) {
@@ -33,6 +59,18 @@ void ImportFilesTask::run() {
         const QString trackLocation(TrackRef::location(fileInfo));
         //qDebug() << "ImportFilesTask::run" << trackLocation;
 
+        if (m_scannerGlobal->isIncremental() &&
+                isBeingWritten(fileInfo, m_scannerGlobal->quietMillis())) {
+            qDebug() << "Skipping track that is being written" << trackLocation;
+            if (m_scannerGlobal->trackExistsInDatabase(trackLocation)) {
+                // Not deleted, only its metadata is outdated
+                emit(trackExists(trackLocation));
+            }
+            skippedFiles = true;
+            incomplete = true;
+            continue;
+        }
+
         // If the file does not exist in the database then add it. If it
         // does then it is either in the user's library OR the user has
         // "removed" the track via "Right-Click -> Remove". These tracks
@@ -41,7 +79,32 @@ void ImportFilesTask::run() {
             // If the track is in the database, mark it as existing. This code gets
             // executed when other files in the same directory have changed (the
             // directory hash has changed).
-            emit(trackExists(trackLocation));
+            const TrackFileStat prevFileStat =
+                    m_scannerGlobal->trackFileStatInDatabase(trackLocation);
+            // Cached in fileInfo since the fingerprint of the directory
+            const TrackFileStat fileStat = TrackFileStat::fromFileInfo(fileInfo);
+            if (!prevFileStat.isValid()) {
+                // Added before the modification times were stored. Don't
+                // replace the metadata in the library, it might have been
+                // edited in Mixxx since.
+                emit(trackFileChanged(trackLocation, fileStat.size(),
+                        fileStat.modified(), TrackPointer()));
+            } else if (fileStat != prevFileStat) {
+                // Modified in place, the tags have to be read again
+                TrackPointer pImportedTrack =
+                        SoundSourceProxy::importTemporaryTrackUnlessCached(
+                                fileInfo, m_pToken);
+                if (pImportedTrack) {
+                    emit(trackFileChanged(trackLocation, fileStat.size(),
+                            fileStat.modified(), pImportedTrack));
+                } else {
+                    // The track is loaded, try again with the next scan
+                    emit(trackExists(trackLocation));
+                    skippedFiles = true;
+                }
+            } else {
+                emit(trackExists(trackLocation));
+            }
         } else {
             if (!fileInfo.exists()) {
                 qWarning() << "ImportFilesTask: Skipping inaccessible file"
@@ -50,10 +113,23 @@ void ImportFilesTask::run() {
             }
             qDebug() << "Importing track" << trackLocation;
 
-            emit(addNewTrack(trackLocation));
+            // The tags are read here, in parallel with the other tasks. The
+            // LibraryScanner thread only writes the track into the database.
+            TrackPointer pImportedTrack =
+                    SoundSourceProxy::importTemporaryTrackOfNewFile(
+                            fileInfo, m_pToken);
+            emit(addNewTrack(trackLocation, pImportedTrack));
         }
     }
-    // Insert or update the hash in the database.
-    emit(directoryHashedAndScanned(m_dirPath, !m_prevHashExists, m_newHash));
+    if (incomplete) {
+        // To be scanned again when the files have been written
+        m_scannerGlobal->directoryIncomplete(m_dirPath);
+    }
+    // Insert or update the hash in the database. The previous hash is kept
+    // if files have been skipped, so the directory still differs from the
+    // database on the next scan.
+    const bool newDirectory = m_prevHash == -1;
+    emit(directoryHashedAndScanned(m_dirPath, newDirectory,
+            skippedFiles ? m_prevHash : m_newHash));
     setSuccess(true);
 }
@@ -16,8 +16,8 @@ class ImportFilesTask : public ScannerTask {
     ImportFilesTask(LibraryScanner* pScanner,
                     const ScannerGlobalPointer scannerGlobal,
                     const QString& dirPath,
-                    const bool prevHashExists,
-                    const int newHash,
+                    const qint64 prevHash,
+                    const qint64 newHash,
                     const QLinkedList<QFileInfo>& filesToImport,
                     const QLinkedList<QFileInfo>& possibleCovers,
                     SecurityTokenPointer pToken);
@@ -27,8 +27,9 @@ class ImportFilesTask : public ScannerTask {
 
   private:
     const QString m_dirPath;
-    const bool m_prevHashExists;
-    const int m_newHash;
+    // -1 if the directory has not been hashed before
+    const qint64 m_prevHash;
+    const qint64 m_newHash;
     const QLinkedList<QFileInfo> m_filesToImport;
     const QLinkedList<QFileInfo> m_possibleCovers;
     SecurityTokenPointer m_pToken;
@@ -1,5 +1,8 @@
 #include "library/scanner/libraryscanner.h"
 
+#include <QDateTime>
+#include <QFileInfo>
+
 #include "sources/soundsourceproxy.h"
 #include "library/scanner/recursivescandirectorytask.h"
 #include "library/scanner/libraryscannerdlg.h"
@@ -10,6 +13,7 @@
 #include "util/logger.h"
 #include "util/trace.h"
 #include "util/file.h"
+#include "util/math.h"
 #include "util/timer.h"
 #include "library/scanner/scannerutil.h"
 #include "util/db/dbconnectionpooler.h"
@@ -17,13 +21,19 @@
 
 namespace {
 
-// TODO(rryan) make configurable
-const int kScannerThreadPoolSize = 1;
-
 mixxx::Logger kLogger("LibraryScanner");
 
 QAtomicInt s_instanceCounter(0);
 
+// -1 if the directory doesn't exist
+qint64 lastModifiedMillis(const QString& dirPath) {
+    const QFileInfo dirInfo(dirPath);
+    if (!dirInfo.isDir()) {
+        return -1;
+    }
+    return dirInfo.lastModified().toMSecsSinceEpoch();
+}
+
 } // anonymous namespace
 
 LibraryScanner::LibraryScanner(
@@ -44,15 +54,26 @@ LibraryScanner::LibraryScanner(
     moveToThread(this);
     m_pool.moveToThread(this);
 
+    // For directoriesPolled()
+    qRegisterMetaType<QHash<QString, qint64>>("QHash<QString,qint64>");
+
     const int instanceId = s_instanceCounter.fetchAndAddAcquire(1) + 1;
     setObjectName(QString("LibraryScanner %1").arg(instanceId));
 
-    m_pool.setMaxThreadCount(kScannerThreadPoolSize);
+    m_pool.setMaxThreadCount(math_max(1, pConfig->getValue(
+            ConfigKey("[Library]", "ScannerThreadCount"),
+            defaultThreadCount())));
 
     // Listen to signals from our public methods (invoked by other threads) and
     // connect them to our slots to run the command on the scanner thread.
     connect(this, SIGNAL(startScan()),
             this, SLOT(slotStartScan()));
+    connect(this, SIGNAL(startDirectoriesScan(QStringList, int)),
+            this, SLOT(slotStartDirectoriesScan(QStringList, int)));
+    connect(this, SIGNAL(startLoadWatchedDirectories()),
+            this, SLOT(slotLoadWatchedDirectories()));
+    connect(this, SIGNAL(startPollDirectories(QStringList)),
+            this, SLOT(slotPollDirectories(QStringList)));
 
     // Force the GUI thread's Track cache to be cleared when a library
     // scan is finished, because we might have modified the database directly
@@ -89,6 +110,13 @@ LibraryScanner::~LibraryScanner() {
     cancelAndQuit();
 }
 
+// static
+int LibraryScanner::defaultThreadCount() {
+    // Reading the tags mostly waits for the disk or the network, so all
+    // cores are used even though the analysis may be running
+    return math_max(1, QThread::idealThreadCount());
+}
+
 void LibraryScanner::run() {
     kLogger.debug() << "Entering thread";
     {
@@ -132,8 +160,8 @@ void LibraryScanner::slotStartScan() {
     }
     changeScannerState(SCANNING);
 
-    QSet<QString> trackLocations = m_trackDao.getTrackLocations();
-    QHash<QString, int> directoryHashes = m_libraryHashDao.getDirectoryHashes();
+    QHash<QString, TrackFileStat> trackFileStats = m_trackDao.getTrackFileStats();
+    QHash<QString, qint64> directoryHashes = m_libraryHashDao.getDirectoryHashes();
     QRegExp extensionFilter(SoundSourceProxy::getSupportedFileNamesRegex());
     QRegExp coverExtensionFilter =
             QRegExp(CoverArtUtils::supportedCoverArtExtensionsRegex(),
@@ -141,7 +169,7 @@ void LibraryScanner::slotStartScan() {
     QStringList directoryBlacklist = ScannerUtil::getDirectoryBlacklist();
 
     m_scannerGlobal = ScannerGlobalPointer(
-            new ScannerGlobal(trackLocations, directoryHashes, extensionFilter,
+            new ScannerGlobal(trackFileStats, directoryHashes, extensionFilter,
                               coverExtensionFilter, directoryBlacklist));
 
     m_scannerGlobal->startTimer();
@@ -193,6 +221,77 @@ void LibraryScanner::slotStartScan() {
     pWatcher->taskDone();
 }
 
+void LibraryScanner::slotStartDirectoriesScan(QStringList dirPaths,
+        int quietMillis) {
+    kLogger.debug() << "slotStartDirectoriesScan()" << dirPaths.size();
+    DEBUG_ASSERT(m_state == STARTING);
+
+    // Only the directories that are still in the library. The existence of
+    // the others is checked by cleanUpScan().
+    m_libraryRootDirs = m_directoryDao.getDirs();
+    QStringList libraryDirPaths;
+    QStringList existingDirPaths;
+    for (const QString& dirPath : dirPaths) {
+        for (const QString& rootDir : m_libraryRootDirs) {
+            if (dirPath == rootDir || dirPath.startsWith(rootDir + "/")) {
+                libraryDirPaths << dirPath;
+                if (QDir(dirPath).exists()) {
+                    existingDirPaths << dirPath;
+                }
+                break;
+            }
+        }
+    }
+    if (libraryDirPaths.isEmpty()) {
+        changeScannerState(IDLE);
+        return;
+    }
+    changeScannerState(SCANNING);
+
+    QHash<QString, TrackFileStat> trackFileStats =
+            m_trackDao.getTrackFileStats(libraryDirPaths);
+    QHash<QString, qint64> directoryHashes =
+            m_libraryHashDao.getDirectoryHashes(libraryDirPaths);
+    QRegExp extensionFilter(SoundSourceProxy::getSupportedFileNamesRegex());
+    QRegExp coverExtensionFilter =
+            QRegExp(CoverArtUtils::supportedCoverArtExtensionsRegex(),
+                    Qt::CaseInsensitive);
+    QStringList directoryBlacklist = ScannerUtil::getDirectoryBlacklist();
+
+    m_scannerGlobal = ScannerGlobalPointer(
+            new ScannerGlobal(trackFileStats, directoryHashes, extensionFilter,
+                              coverExtensionFilter, directoryBlacklist, true,
+                              quietMillis));
+
+    m_scannerGlobal->startTimer();
+
+    // No scanStarted(), the changes are picked up in the background without
+    // the progress dialog. Only the given directories and the tracks in them
+    // need to be verified.
+    m_libraryHashDao.updateDirectoryStatuses(libraryDirPaths, false, false);
+    m_trackDao.invalidateTrackLocationsInDirectories(libraryDirPaths);
+
+    m_trackDao.addTracksPrepare();
+
+    // A single stage, new directories are hashed right away. When all tasks
+    // are done, TaskWatcher will signal slotFinishUnhashedScan.
+    TaskWatcher* pWatcher = &m_scannerGlobal->getTaskWatcher();
+    pWatcher->watchTask();
+    connect(pWatcher, SIGNAL(allTasksDone()),
+            this, SLOT(slotFinishUnhashedScan()));
+
+    for (const QString& dirPath : existingDirPaths) {
+        MDir dir(dirPath);
+        if (!m_scannerGlobal->testAndMarkDirectoryScanned(dir.dir())) {
+            queueTask(new RecursiveScanDirectoryTask(this, m_scannerGlobal,
+                                                     dir.dir(),
+                                                     dir.token(),
+                                                     true));
+        }
+    }
+    pWatcher->taskDone();
+}
+
 // is called when all tasks of the first stage are done (threads are finished)
 void LibraryScanner::slotFinishHashedScan() {
     kLogger.debug() << "slotFinishHashedScan";
@@ -293,6 +392,13 @@ void LibraryScanner::cleanUpScan() {
 
     transaction.commit();
 
+    if (m_scannerGlobal->isIncremental()) {
+        // The search for covers goes through the whole library, it is left
+        // to the next full scan.
+        emit(tracksMoved(tracksMovedSetOld, tracksMovedSetNew));
+        return;
+    }
+
     kLogger.debug() << "Detecting cover art for unscanned files";
     QSet<TrackId> coverArtTracksChanged;
     m_trackDao.detectCoverArtForTracksWithoutCover(
@@ -322,8 +428,20 @@ void LibraryScanner::slotFinishUnhashedScan() {
 
     // Finish adding the tracks -- rollback the transaction if the scan did not
     // finish cleanly and the user did not cancel the transaction.
-    m_trackDao.addTracksFinish(!m_scannerGlobal->shouldCancel() &&
-                               !bScanFinishedCleanly);
+    const bool rollback = !m_scannerGlobal->shouldCancel() &&
+            !bScanFinishedCleanly;
+    m_trackDao.addTracksFinish(rollback);
+
+    if (!rollback && !m_scannerGlobal->changedTracks().isEmpty()) {
+        // Update BaseTrackCache via signals connected to the main TrackDAO.
+        emit(tracksChanged(m_scannerGlobal->changedTracks()));
+    }
+    if (!rollback && !m_scannerGlobal->addedDirectories().isEmpty()) {
+        emit(directoriesAdded(m_scannerGlobal->addedDirectories()));
+    }
+    if (!rollback && !m_scannerGlobal->incompleteDirectories().isEmpty()) {
+        emit(directoriesIncomplete(m_scannerGlobal->incompleteDirectories()));
+    }
 
     if (!m_scannerGlobal->shouldCancel() && bScanFinishedCleanly) {
         cleanUpScan();
@@ -354,6 +472,50 @@ void LibraryScanner::slotFinishUnhashedScan() {
     emit(scanFinished());
 }
 
+bool LibraryScanner::scanDirectories(const QStringList& dirPaths,
+        int quietMillis) {
+    if (changeScannerState(STARTING)) {
+        emit(startDirectoriesScan(dirPaths, quietMillis));
+        return true;
+    }
+    return false;
+}
+
+void LibraryScanner::loadWatchedDirectories() {
+    emit(startLoadWatchedDirectories());
+}
+
+void LibraryScanner::slotLoadWatchedDirectories() {
+    const QStringList rootDirs = m_directoryDao.getDirs();
+    QStringList dirPaths = rootDirs;
+    const QHash<QString, qint64> directoryHashes =
+            m_libraryHashDao.getDirectoryHashes();
+    for (auto it = directoryHashes.constBegin();
+            it != directoryHashes.constEnd(); ++it) {
+        // Directories of removed library directories are only removed from
+        // LibraryHashes by the next full scan.
+        for (const QString& rootDir : rootDirs) {
+            if (it.key().startsWith(rootDir + "/")) {
+                dirPaths << it.key();
+                break;
+            }
+        }
+    }
+    emit(watchedDirectoriesLoaded(dirPaths));
+}
+
+void LibraryScanner::pollDirectories(const QStringList& dirPaths) {
+    emit(startPollDirectories(dirPaths));
+}
+
+void LibraryScanner::slotPollDirectories(QStringList dirPaths) {
+    QHash<QString, qint64> modified;
+    for (const QString& dirPath : dirPaths) {
+        modified.insert(dirPath, lastModifiedMillis(dirPath));
+    }
+    emit(directoriesPolled(modified));
+}
+
 void LibraryScanner::scan() {
     if (changeScannerState(STARTING)) {
         emit(startScan());
@@ -409,14 +571,16 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
     m_scannerGlobal->getTaskWatcher().watchTask();
     connect(pTask, SIGNAL(queueTask(ScannerTask*)),
             this, SLOT(queueTask(ScannerTask*)));
-    connect(pTask, SIGNAL(directoryHashedAndScanned(QString, bool, int)),
-            this, SLOT(slotDirectoryHashedAndScanned(QString, bool, int)));
+    connect(pTask, SIGNAL(directoryHashedAndScanned(QString, bool, qint64)),
+            this, SLOT(slotDirectoryHashedAndScanned(QString, bool, qint64)));
     connect(pTask, SIGNAL(directoryUnchanged(QString)),
             this, SLOT(slotDirectoryUnchanged(QString)));
     connect(pTask, SIGNAL(trackExists(QString)),
             this, SLOT(slotTrackExists(QString)));
-    connect(pTask, SIGNAL(addNewTrack(QString)),
-            this, SLOT(slotAddNewTrack(QString)));
+    connect(pTask, SIGNAL(addNewTrack(QString, TrackPointer)),
+            this, SLOT(slotAddNewTrack(QString, TrackPointer)));
+    connect(pTask, SIGNAL(trackFileChanged(QString, qint64, qint64, TrackPointer)),
+            this, SLOT(slotTrackFileChanged(QString, qint64, qint64, TrackPointer)));
 
     // Progress signals.
     // Pass directly to the main thread
@@ -429,7 +593,7 @@ void LibraryScanner::queueTask(ScannerTask* pTask) {
 }
 
 void LibraryScanner::slotDirectoryHashedAndScanned(const QString& directoryPath,
-                                               bool newDirectory, int hash) {
+                                               bool newDirectory, qint64 hash) {
     ScopedTimer timer("LibraryScanner::slotDirectoryHashedAndScanned");
     //kLogger.debug() << "sloDirectoryHashedAndScanned" << directoryPath
     //          << newDirectory << hash;
@@ -441,6 +605,9 @@ void LibraryScanner::slotDirectoryHashedAndScanned(const QString& directoryPath,
     }
 
     if (newDirectory) {
+        if (m_scannerGlobal) {
+            m_scannerGlobal->directoryAdded(directoryPath);
+        }
         m_libraryHashDao.saveDirectoryHash(directoryPath, hash);
     } else {
         m_libraryHashDao.updateDirectoryHash(directoryPath, hash, 0);
@@ -465,11 +632,34 @@ void LibraryScanner::slotTrackExists(const QString& trackPath) {
     }
 }
 
-void LibraryScanner::slotAddNewTrack(const QString& trackPath) {
+void LibraryScanner::slotTrackFileChanged(const QString& trackPath,
+        qint64 fileSize, qint64 fileModified, TrackPointer pImportedTrack) {
+    //kLogger.debug() << "slotTrackFileChanged" << trackPath;
+    ScopedTimer timer("LibraryScanner::slotTrackFileChanged");
+    const TrackId trackId = m_trackDao.updateTrackFromChangedFile(trackPath,
+            TrackFileStat(fileSize, fileModified), pImportedTrack);
+    if (m_scannerGlobal) {
+        m_scannerGlobal->addVerifiedTrack(trackPath);
+        if (trackId.isValid()) {
+            m_scannerGlobal->trackChanged(trackId);
+        }
+    }
+}
+
+void LibraryScanner::slotAddNewTrack(const QString& trackPath,
+        TrackPointer pImportedTrack) {
     //kLogger.debug() << "slotAddNewTrack" << trackPath;
     ScopedTimer timer("LibraryScanner::addNewTrack");
+    if (m_scannerGlobal && m_scannerGlobal->isIncremental() &&
+            m_trackDao.isTrackLocationInLibrary(trackPath)) {
+        // In a new subdirectory of an incremental scan, the tracks in it
+        // have not been loaded. The directory has been removed and restored.
+        m_scannerGlobal->addVerifiedTrack(trackPath);
+        return;
+    }
     // For statistics tracking and to detect moved tracks
-    TrackPointer pTrack(m_trackDao.addTracksAddFile(trackPath, false));
+    TrackPointer pTrack(m_trackDao.addTracksAddFile(trackPath, false,
+            pImportedTrack));
     if (pTrack) {
         // The track's actual location might differ from the
         // given trackPath
@@ -34,6 +34,28 @@ class LibraryScanner : public QThread {
             const UserSettingsPointer& pConfig);
     ~LibraryScanner() override;
 
+    static int defaultThreadCount();
+
+    // Call from any thread to scan only the given directories of the
+    // library, e.g. after they have been changed. Files that have been
+    // added, modified or removed in these directories are found, new
+    // subdirectories are scanned recursively and the other subdirectories
+    // are skipped. Files that have been modified within the last quietMillis
+    // might still be written and are skipped, their directories are reported
+    // by directoriesIncomplete(). Returns false if a scan is already in
+    // progress.
+    bool scanDirectories(const QStringList& dirPaths, int quietMillis = 0);
+
+    // Call from any thread to load the directories that LibraryWatcher
+    // watches from the database in the scanner thread, i.e. the library
+    // directories and the directories below them that have been scanned.
+    // Emits watchedDirectoriesLoaded().
+    void loadWatchedDirectories();
+
+    // Call from any thread to read the modification times of the
+    // directories in the scanner thread. Emits directoriesPolled().
+    void pollDirectories(const QStringList& dirPaths);
+
   public slots:
     // Call from any thread to start a scan. Does nothing if a scan is already
     // in progress.
@@ -51,10 +73,24 @@ class LibraryScanner : public QThread {
     void trackAdded(TrackPointer pTrack);
     void tracksMoved(QSet<TrackId> oldTrackIds, QSet<TrackId> newTrackIds);
     void tracksChanged(QSet<TrackId> changedTrackIds);
+    // The directories that have been scanned for the first time
+    void directoriesAdded(QStringList dirPaths);
+    // The directories with files that have been skipped by
+    // scanDirectories(), because they are still being written
+    void directoriesIncomplete(QStringList dirPaths);
+    void watchedDirectoriesLoaded(QStringList dirPaths);
+    // The modification times of the directories in ms since the epoch, -1
+    // for directories that don't exist
+    void directoriesPolled(QHash<QString, qint64> modified);
 
     // Emitted by scan() to invoke slotStartScan in the scanner thread's event
     // loop.
     void startScan();
+    // Likewise for scanDirectories(), loadWatchedDirectories() and
+    // pollDirectories()
+    void startDirectoriesScan(QStringList dirPaths, int quietMillis);
+    void startLoadWatchedDirectories();
+    void startPollDirectories(QStringList dirPaths);
 
   protected:
     void run();
@@ -64,15 +100,20 @@ class LibraryScanner : public QThread {
 
   private slots:
     void slotStartScan();
+    void slotStartDirectoriesScan(QStringList dirPaths, int quietMillis);
+    void slotLoadWatchedDirectories();
+    void slotPollDirectories(QStringList dirPaths);
     void slotFinishHashedScan();
     void slotFinishUnhashedScan();
 
     // ScannerTask signal handlers.
     void slotDirectoryHashedAndScanned(const QString& directoryPath,
-                                   bool newDirectory, int hash);
+                                   bool newDirectory, qint64 hash);
     void slotDirectoryUnchanged(const QString& directoryPath);
     void slotTrackExists(const QString& trackPath);
-    void slotAddNewTrack(const QString& trackPath);
+    void slotAddNewTrack(const QString& trackPath, TrackPointer pImportedTrack);
+    void slotTrackFileChanged(const QString& trackPath, qint64 fileSize,
+                              qint64 fileModified, TrackPointer pImportedTrack);
 
   private:
     enum ScannerState {
@@ -104,7 +145,9 @@ class LibraryScanner : public QThread {
     // thread.
     TrackCollection* m_pTrackCollection;
 
-    // The pool of threads used for worker tasks.
+    // The pool of threads used for worker tasks. They walk the directories
+    // and read the tags of new files in parallel, all database writes are
+    // done by the LibraryScanner thread.
     QThreadPool m_pool;
 
     // The library scanner thread's DAOs.
@@ -0,0 +1,209 @@
+#include "library/scanner/librarywatcher.h"
+
+#include "library/scanner/libraryscanner.h"
+#include "util/logger.h"
+
+namespace {
+
+const mixxx::Logger kLogger("LibraryWatcher");
+
+// The modification time of a directory that has not been polled yet
+const qint64 kNotPolled = -2;
+
+} // anonymous namespace
+
+// static
+const int LibraryWatcher::kDefaultQuietMillis = 2000;
+// static
+const int LibraryWatcher::kMaxDelayMillis = 10000;
+// static
+const int LibraryWatcher::kPollIntervalMillis = 10000;
+
+LibraryWatcher::LibraryWatcher(LibraryScanner* pScanner,
+                               int quietMillis,
+                               QObject* parent)
+        : QObject(parent),
+          m_pScanner(pScanner),
+          m_quietMillis(quietMillis),
+          m_fullScan(false) {
+    connect(&m_watcher, SIGNAL(directoryChanged(QString)),
+            this, SLOT(slotDirectoryChanged(QString)));
+
+    m_pollTimer.setInterval(kPollIntervalMillis);
+    connect(&m_pollTimer, SIGNAL(timeout()),
+            this, SLOT(slotPoll()));
+
+    m_scanTimer.setSingleShot(true);
+    connect(&m_scanTimer, SIGNAL(timeout()),
+            this, SLOT(slotScanPending()));
+
+    // Only full scans are started with scanStarted()
+    connect(m_pScanner, SIGNAL(scanStarted()),
+            this, SLOT(slotScanStarted()));
+    connect(m_pScanner, SIGNAL(scanFinished()),
+            this, SLOT(slotScanFinished()));
+    connect(m_pScanner, SIGNAL(directoriesAdded(QStringList)),
+            this, SLOT(slotDirectoriesAdded(QStringList)));
+    connect(m_pScanner, SIGNAL(directoriesIncomplete(QStringList)),
+            this, SLOT(slotDirectoriesIncomplete(QStringList)));
+    // The database and the polled directories are read in the scanner thread
+    connect(m_pScanner, SIGNAL(watchedDirectoriesLoaded(QStringList)),
+            this, SLOT(slotWatchedDirectoriesLoaded(QStringList)));
+    connect(m_pScanner, SIGNAL(directoriesPolled(QHash<QString, qint64>)),
+            this, SLOT(slotDirectoriesPolled(QHash<QString, qint64>)));
+
+    slotRefreshDirectories();
+}
+
+LibraryWatcher::~LibraryWatcher() {
+}
+
+QStringList LibraryWatcher::watchedDirectories() const {
+    return m_watcher.directories();
+}
+
+QStringList LibraryWatcher::polledDirectories() const {
+    return m_polledDirectories.keys();
+}
+
+void LibraryWatcher::slotRefreshDirectories() {
+    m_pScanner->loadWatchedDirectories();
+}
+
+void LibraryWatcher::slotWatchedDirectoriesLoaded(QStringList dirPaths) {
+    const QSet<QString> loadedDirPaths = dirPaths.toSet();
+    QSet<QString> currentDirPaths = m_watcher.directories().toSet();
+    currentDirPaths.unite(m_polledDirectories.keys().toSet());
+    unwatchDirectories((currentDirPaths - loadedDirPaths).toList());
+    watchDirectories((loadedDirPaths - currentDirPaths).toList());
+    kLogger.debug() << "Watching" << m_watcher.directories().size()
+                    << "and polling" << m_polledDirectories.size()
+                    << "directories";
+    emit(directoriesRefreshed());
+}
+
+void LibraryWatcher::watchDirectories(const QStringList& dirPaths) {
+    if (dirPaths.isEmpty()) {
+        return;
+    }
+    const QStringList rejectedDirPaths = m_watcher.addPaths(dirPaths);
+    if (rejectedDirPaths.isEmpty()) {
+        return;
+    }
+    kLogger.info() << "Polling" << rejectedDirPaths.size()
+                   << "directories that can't be watched";
+    for (const QString& dirPath : rejectedDirPaths) {
+        m_polledDirectories.insert(dirPath, kNotPolled);
+    }
+    // Their modification times are compared from now on
+    m_pScanner->pollDirectories(rejectedDirPaths);
+    if (!m_pollTimer.isActive()) {
+        m_pollTimer.start();
+    }
+}
+
+void LibraryWatcher::unwatchDirectories(const QStringList& dirPaths) {
+    if (dirPaths.isEmpty()) {
+        return;
+    }
+    m_watcher.removePaths(dirPaths);
+    for (const QString& dirPath : dirPaths) {
+        m_polledDirectories.remove(dirPath);
+    }
+    if (m_polledDirectories.isEmpty()) {
+        m_pollTimer.stop();
+    }
+}
+
+void LibraryWatcher::slotDirectoryChanged(const QString& dirPath) {
+    // Removed directories are removed from m_watcher by Qt
+    m_pendingDirectories.insert(dirPath);
+    scheduleScan();
+}
+
+void LibraryWatcher::slotDirectoriesAdded(QStringList dirPaths) {
+    watchDirectories(dirPaths);
+    // Files that have been added to the new directories between their scan
+    // and now would be missed otherwise. Rescanning them costs no more than
+    // comparing their hashes if nothing has changed.
+    for (const QString& dirPath : dirPaths) {
+        m_pendingDirectories.insert(dirPath);
+    }
+    scheduleScan();
+}
+
+void LibraryWatcher::slotDirectoriesIncomplete(QStringList dirPaths) {
+    for (const QString& dirPath : dirPaths) {
+        m_pendingDirectories.insert(dirPath);
+    }
+    scheduleScan();
+}
+
+void LibraryWatcher::scheduleScan() {
+    if (!m_pendingTimer.isValid()) {
+        m_pendingTimer.start();
+    }
+    // Restarted by every change until the maximum delay is reached
+    const qint64 remainingMillis = kMaxDelayMillis - m_pendingTimer.elapsed();
+    m_scanTimer.start(static_cast<int>(
+            qBound<qint64>(0, remainingMillis, m_quietMillis)));
+}
+
+void LibraryWatcher::slotScanPending() {
+    if (m_pendingDirectories.isEmpty()) {
+        return;
+    }
+    if (!m_pScanner->scanDirectories(m_pendingDirectories.toList(),
+            m_quietMillis)) {
+        // A scan is in progress, slotScanFinished() tries again. Just in
+        // case the scanner has been busy without scanning:
+        m_scanTimer.start(kMaxDelayMillis);
+        return;
+    }
+    kLogger.debug() << "Scanning" << m_pendingDirectories.size()
+                    << "changed directories";
+    m_pendingDirectories.clear();
+    m_pendingTimer.invalidate();
+}
+
+void LibraryWatcher::slotPoll() {
+    m_pScanner->pollDirectories(m_polledDirectories.keys());
+}
+
+void LibraryWatcher::slotDirectoriesPolled(QHash<QString, qint64> modified) {
+    for (auto it = modified.constBegin(); it != modified.constEnd(); ++it) {
+        auto polled = m_polledDirectories.find(it.key());
+        if (polled == m_polledDirectories.end()) {
+            // Unwatched in the meantime
+            continue;
+        }
+        if (polled.value() != kNotPolled && polled.value() != it.value()) {
+            m_pendingDirectories.insert(it.key());
+        }
+        if (it.value() == -1) {
+            m_polledDirectories.erase(polled);
+        } else {
+            polled.value() = it.value();
+        }
+    }
+    if (m_polledDirectories.isEmpty()) {
+        m_pollTimer.stop();
+    }
+    if (!m_pendingDirectories.isEmpty()) {
+        scheduleScan();
+    }
+}
+
+void LibraryWatcher::slotScanStarted() {
+    m_fullScan = true;
+}
+
+void LibraryWatcher::slotScanFinished() {
+    if (m_fullScan) {
+        m_fullScan = false;
+        slotRefreshDirectories();
+    }
+    if (!m_pendingDirectories.isEmpty()) {
+        scheduleScan();
+    }
+}
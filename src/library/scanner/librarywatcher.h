@@ -0,0 +1,98 @@
+#ifndef MIXXX_LIBRARYWATCHER_H
+#define MIXXX_LIBRARYWATCHER_H
+
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+class LibraryScanner;
+
+// Keeps the library up to date without full scans. Watches the library
+// directories and all directories below them that are known to the scanner
+// for added, removed and renamed files and subdirectories, and lets the
+// LibraryScanner scan only the changed directories.
+//
+// The directories are watched with QFileSystemWatcher, i.e. with inotify on
+// Linux. Directories that can't be watched, e.g. when the limit of inotify
+// watches is reached, are polled by their modification time instead. The
+// database and the polled directories are read by the scanner thread, not
+// by the thread of the watcher.
+//
+// The changes are debounced: a batch is scanned when no directory has
+// changed for the quiet period, or at the latest kMaxDelayMillis after the
+// first change, so copying an album triggers one scan and not one per file.
+// Changes during a scan are collected for the next batch.
+//
+// Writing a file doesn't change its directory, so a file that is still
+// being copied when its directory is scanned is skipped and its directory is
+// scanned again after the quiet period. Files that are rewritten in place
+// without touching their directory are only found together with other
+// changes in the directory or by the next full scan.
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+  public:
+    static const int kDefaultQuietMillis;
+    static const int kMaxDelayMillis;
+    static const int kPollIntervalMillis;
+
+    LibraryWatcher(LibraryScanner* pScanner,
+                   int quietMillis = kDefaultQuietMillis,
+                   QObject* parent = nullptr);
+    ~LibraryWatcher() override;
+
+    QStringList watchedDirectories() const;
+    QStringList polledDirectories() const;
+
+  public slots:
+    // Watches the library directories and the directories below them that
+    // have been scanned. Call after the library directories have been
+    // changed. Emits directoriesRefreshed() when done.
+    void slotRefreshDirectories();
+
+  signals:
+    void directoriesRefreshed();
+
+  private slots:
+    void slotWatchedDirectoriesLoaded(QStringList dirPaths);
+    void slotDirectoryChanged(const QString& dirPath);
+    void slotDirectoriesAdded(QStringList dirPaths);
+    void slotDirectoriesIncomplete(QStringList dirPaths);
+    void slotScanPending();
+    void slotPoll();
+    void slotDirectoriesPolled(QHash<QString, qint64> modified);
+    void slotScanStarted();
+    void slotScanFinished();
+
+  private:
+    void watchDirectories(const QStringList& dirPaths);
+    void unwatchDirectories(const QStringList& dirPaths);
+    void scheduleScan();
+
+    LibraryScanner* m_pScanner;
+    const int m_quietMillis;
+
+    QFileSystemWatcher m_watcher;
+
+    // The directories that QFileSystemWatcher has rejected with their last
+    // modification time in ms since the epoch, or kNotPolled until they have
+    // been polled for the first time.
+    QHash<QString, qint64> m_polledDirectories;
+    QTimer m_pollTimer;
+
+    // The changed directories of the next batch
+    QSet<QString> m_pendingDirectories;
+    // Since the first change of the next batch
+    QElapsedTimer m_pendingTimer;
+    QTimer m_scanTimer;
+
+    // Whether the running scan is a full scan, after which the watched
+    // directories are refreshed.
+    bool m_fullScan;
+};
+
+#endif // MIXXX_LIBRARYWATCHER_H
@@ -4,6 +4,7 @@
 
 #include "library/scanner/libraryscanner.h"
 #include "library/scanner/importfilestask.h"
+#include "library/scanner/directoryfingerprint.h"
 #include "util/timer.h"
 
 RecursiveScanDirectoryTask::RecursiveScanDirectoryTask(
@@ -38,7 +39,7 @@ void RecursiveScanDirectoryTask::run() {
     QLinkedList<QFileInfo> filesToImport;
     QLinkedList<QFileInfo> possibleCovers;
     QLinkedList<QDir> dirsToScan;
-    QStringList newHashStr;
+    DirectoryFingerprint fingerprint;
 
     // TODO(rryan) benchmark QRegExp copy versus QMutex/QRegExp in ScannerGlobal
     // versus slicing the extension off and checking for set/list containment.
@@ -54,7 +55,8 @@ void RecursiveScanDirectoryTask::run() {
         if (currentFileInfo.isFile()) {
             const QString& fileName = currentFileInfo.fileName();
             if (supportedExtensionsRegex.indexIn(fileName) != -1) {
-                newHashStr.append(currentFile);
+                fingerprint.addFile(fileName,
+                        TrackFileStat::fromFileInfo(currentFileInfo));
                 filesToImport.append(currentFileInfo);
             } else if (supportedCoverExtensionsRegex.indexIn(fileName) != -1) {
                 possibleCovers.append(currentFileInfo);
@@ -72,13 +74,12 @@ void RecursiveScanDirectoryTask::run() {
     }
 
     // Note: A hash of "0" is a real hash if the directory contains no files!
-    // Calculate a hash of the directory's file list.
-    int newHash = qHash(newHashStr.join(""));
+    const qint64 newHash = fingerprint.value();
 
     QString dirPath = m_dir.path();
 
     // Try to retrieve a hash from the last time that directory was scanned.
-    int prevHash = m_scannerGlobal->directoryHashInDatabase(dirPath);
+    qint64 prevHash = m_scannerGlobal->directoryHashInDatabase(dirPath);
     bool prevHashExists = prevHash != -1;
 
     if (prevHashExists || m_scanUnhashed) {
@@ -90,7 +91,7 @@ void RecursiveScanDirectoryTask::run() {
             if (!filesToImport.isEmpty()) {
                 m_pScanner->queueTask(
                         new ImportFilesTask(m_pScanner, m_scannerGlobal, dirPath,
-                                            prevHashExists, newHash, filesToImport,
+                                            prevHash, newHash, filesToImport,
                                             possibleCovers, m_pToken));
             } else {
                 emit(directoryHashedAndScanned(dirPath, !prevHashExists, newHash));
@@ -104,6 +105,12 @@ void RecursiveScanDirectoryTask::run() {
 
     // Process all of the sub-directories.
     foreach (const QDir& nextDir, dirsToScan) {
+        // An incremental scan only descends into new directories, the others
+        // are scanned when they are changed themselves.
+        if (m_scannerGlobal->isIncremental() &&
+                m_scannerGlobal->directoryHashInDatabase(nextDir.path()) != -1) {
+            continue;
+        }
         // Atomically test and mark the directory as scanned to avoid
         // that the same directory is scanned multiple times by different
         // tasks.
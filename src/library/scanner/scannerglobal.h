@@ -9,6 +9,8 @@
 #include <QMutexLocker>
 #include <QSharedPointer>
 
+#include "library/dao/trackfilestat.h"
+#include "track/trackid.h"
 #include "util/task.h"
 #include "util/performancetimer.h"
 
@@ -36,16 +38,20 @@ class DirInfo {
 
 class ScannerGlobal {
   public:
-    ScannerGlobal(const QSet<QString>& trackLocations,
-                  const QHash<QString, int>& directoryHashes,
+    ScannerGlobal(const QHash<QString, TrackFileStat>& trackFileStats,
+                  const QHash<QString, qint64>& directoryHashes,
                   const QRegExp& supportedExtensionsMatcher,
                   const QRegExp& supportedCoverExtensionsMatcher,
-                  const QStringList& directoriesBlacklist)
-            : m_trackLocations(trackLocations),
+                  const QStringList& directoriesBlacklist,
+                  bool incremental = false,
+                  int quietMillis = 0)
+            : m_trackFileStats(trackFileStats),
               m_directoryHashes(directoryHashes),
               m_supportedExtensionsMatcher(supportedExtensionsMatcher),
               m_supportedCoverExtensionsMatcher(supportedCoverExtensionsMatcher),
               m_directoriesBlacklist(directoriesBlacklist),
+              m_incremental(incremental),
+              m_quietMillis(quietMillis),
               // Unless marked un-clean, we assume it will finish cleanly.
               m_scanFinishedCleanly(true),
               m_shouldCancel(false),
@@ -58,14 +64,35 @@ class ScannerGlobal {
 
     // Returns whether the track already exists in the database.
     inline bool trackExistsInDatabase(const QString& trackLocation) const {
-        return m_trackLocations.contains(trackLocation);
+        return m_trackFileStats.contains(trackLocation);
+    }
+
+    // Returns the size and modification time of the file when its tags were
+    // read, or an invalid TrackFileStat if they are not known.
+    inline TrackFileStat trackFileStatInDatabase(
+            const QString& trackLocation) const {
+        return m_trackFileStats.value(trackLocation);
     }
 
     // Returns the directory hash if it exists or -1 if it doesn't.
-    inline int directoryHashInDatabase(const QString& directoryPath) const {
+    inline qint64 directoryHashInDatabase(const QString& directoryPath) const {
         return m_directoryHashes.value(directoryPath, -1);
     }
 
+    // Whether only some directories are scanned, see
+    // LibraryScanner::scanDirectories(). The track file stats and directory
+    // hashes are only loaded for these directories, and the directory
+    // hashes for their direct subdirectories.
+    inline bool isIncremental() const {
+        return m_incremental;
+    }
+
+    // Files that have been modified within this period might still be
+    // written and are not imported by an incremental scan.
+    inline int quietMillis() const {
+        return m_quietMillis;
+    }
+
     inline bool directoryBlacklisted(const QString& directoryPath) const {
         return m_directoriesBlacklist.contains(directoryPath);
     }
@@ -133,6 +160,10 @@ class ScannerGlobal {
         m_scanFinishedCleanly = false;
     }
 
+    // The following bookkeeping is only done by the slots of LibraryScanner,
+    // which run in its thread. The ScannerTasks run in parallel in the
+    // thread pool and report to these slots with queued signals, they must
+    // not call these methods directly.
     void addVerifiedDirectory(const QString& directory) {
         m_verifiedDirectories << directory;
     }
@@ -165,6 +196,14 @@ class ScannerGlobal {
         m_addedTracks << trackLocation;
     }
 
+    // The tracks whose metadata has been re-imported from modified files
+    const QSet<TrackId>& changedTracks() const {
+        return m_changedTracks;
+    }
+    void trackChanged(TrackId trackId) {
+        m_changedTracks.insert(trackId);
+    }
+
     int numScannedDirectories() const {
         return m_numScannedDirectories;
     }
@@ -172,12 +211,28 @@ class ScannerGlobal {
         m_numScannedDirectories++;
     }
 
+    const QStringList& addedDirectories() const {
+        return m_addedDirectories;
+    }
+    void directoryAdded(const QString& directoryPath) {
+        m_addedDirectories << directoryPath;
+    }
+
+    // No need for locking, only used when the tasks are done
+    const QStringList& incompleteDirectories() const {
+        return m_incompleteDirectories;
+    }
+    void directoryIncomplete(const QString& directoryPath) {
+        QMutexLocker locker(&m_incompleteDirectoriesMutex);
+        m_incompleteDirectories << directoryPath;
+    }
+
 
   private:
     TaskWatcher m_watcher;
 
-    QSet<QString> m_trackLocations;
-    QHash<QString, int> m_directoryHashes;
+    QHash<QString, TrackFileStat> m_trackFileStats;
+    QHash<QString, qint64> m_directoryHashes;
 
     mutable QMutex m_supportedExtensionsMatcherMutex;
     QRegExp m_supportedExtensionsMatcher;
@@ -202,6 +257,9 @@ class ScannerGlobal {
     // this has never been investigated.
     QStringList m_directoriesBlacklist;
 
+    const bool m_incremental;
+    const int m_quietMillis;
+
     // The list of directories verified by the scan.
     QStringList m_verifiedDirectories;
 
@@ -211,6 +269,17 @@ class ScannerGlobal {
     // The list of tracks added by the scan.
     QStringList m_addedTracks;
 
+    // The tracks updated by the scan.
+    QSet<TrackId> m_changedTracks;
+
+    // The directories hashed for the first time by the scan.
+    QStringList m_addedDirectories;
+
+    // The directories with files that have been skipped by the scan because
+    // they are still being written.
+    mutable QMutex m_incompleteDirectoriesMutex;
+    QStringList m_incompleteDirectories;
+
     volatile bool m_scanFinishedCleanly;
     volatile bool m_shouldCancel;
 
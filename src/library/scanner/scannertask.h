@@ -22,10 +22,17 @@ class ScannerTask : public QObject, public QRunnable {
     void taskDone(bool success);
     void queueTask(ScannerTask* pTask);
     void directoryHashedAndScanned(const QString& directoryPath,
-                                   bool newDirectory, int hash);
+                                   bool newDirectory, qint64 hash);
     void directoryUnchanged(const QString& directoryPath);
     void trackExists(const QString& filePath);
-    void addNewTrack(const QString& filePath);
+    // pImportedTrack is a temporary track with the metadata of the file
+    void addNewTrack(const QString& filePath, TrackPointer pImportedTrack);
+    // The file has been modified since its tags were read, or it is not
+    // known when. pImportedTrack is a temporary track with the new metadata
+    // of the file, or null if only the size and modification time of the
+    // file are to be stored.
+    void trackFileChanged(const QString& filePath, qint64 fileSize,
+                          qint64 fileModified, TrackPointer pImportedTrack);
 
     // Feedback to GUI
     void progressLoading(const QString& fileName);
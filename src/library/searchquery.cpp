@@ -3,10 +3,73 @@
 #include "library/searchquery.h"
 
 #include "library/queryutil.h"
+#include "library/trackcolumnstore.h"
 #include "track/keyutils.h"
 #include "library/dao/trackschema.h"
 #include "util/db/sqllikewildcards.h"
 
+namespace {
+
+// Combines the results of the columns of a filter that are joined by OR
+StoreMatch orStoreMatch(StoreMatch first, StoreMatch second) {
+    if (first == StoreMatch::Match || second == StoreMatch::Match) {
+        return StoreMatch::Match;
+    } else if (first == StoreMatch::Unknown || second == StoreMatch::Unknown) {
+        return StoreMatch::Unknown;
+    } else if (first == StoreMatch::Mismatch || second == StoreMatch::Mismatch) {
+        return StoreMatch::Mismatch;
+    } else {
+        return StoreMatch::Unconstrained;
+    }
+}
+
+// Evaluates a filter of the form "<column 1> ... OR <column 2> ..." with
+// the matching value ids of each column.
+StoreMatch matchStoreColumns(const TrackColumnStore& store, int row,
+        const QVector<int>& columns,
+        const std::vector<std::vector<bool>>& matches) {
+    StoreMatch result = StoreMatch::Unconstrained;
+    for (int i = 0; i < columns.size(); ++i) {
+        const int valueId = store.valueId(columns[i], row);
+        if (valueId < 0) {
+            result = orStoreMatch(result, StoreMatch::Unknown);
+        } else if (matches[i][valueId]) {
+            return StoreMatch::Match;
+        } else {
+            result = orStoreMatch(result, StoreMatch::Mismatch);
+        }
+    }
+    return result;
+}
+
+// The value of a numeric literal in an SQL expression
+QVariant sqlLiteral(double number) {
+    const QString literal = QString::number(number);
+    if (literal.contains('.') || literal.contains('e')) {
+        return literal.toDouble();
+    }
+    return literal.toLongLong();
+}
+
+// Compares a column value with a numeric literal like SQLite. Columns with
+// TEXT affinity (e.g. year) contain texts that are compared with the text
+// of the literal, all other columns contain numbers.
+int compareWithSqlLiteral(const QVariant& value, const QVariant& literal) {
+    if (value.type() == QVariant::String) {
+        const int result = QString::compare(
+                value.toString(), TrackColumnStore::sqlText(literal));
+        return result < 0 ? -1 : (result > 0 ? 1 : 0);
+    }
+    const double number = value.toDouble();
+    const double literalNumber = literal.toDouble();
+    if (number < literalNumber) {
+        return -1;
+    }
+    return number > literalNumber ? 1 : 0;
+}
+
+} // anonymous namespace
+
 QVariant getTrackValueForColumn(const TrackPointer& pTrack, const QString& column) {
     if (column == LIBRARYTABLE_ARTIST) {
         return pTrack->getArtist();
@@ -73,6 +136,15 @@ QString QueryNode::concatSqlClauses(
     }
 }
 
+bool GroupNode::prepareStoreMatch(TrackColumnStore* pStore) const {
+    for (const auto& pNode: m_nodes) {
+        if (!pNode->prepareStoreMatch(pStore)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool AndNode::match(const TrackPointer& pTrack) const {
     for (const auto& pNode: m_nodes) {
         if (!pNode->match(pTrack)) {
@@ -96,6 +168,28 @@ QString AndNode::toSql() const {
     return concatSqlClauses(queryFragments, "AND");
 }
 
+StoreMatch AndNode::matchStore(const TrackColumnStore& store, int row) const {
+    StoreMatch result = StoreMatch::Unconstrained;
+    for (const auto& pNode: m_nodes) {
+        switch (pNode->matchStore(store, row)) {
+        case StoreMatch::Mismatch:
+            return StoreMatch::Mismatch;
+        case StoreMatch::Unknown:
+            result = StoreMatch::Unknown;
+            break;
+        case StoreMatch::Match:
+            if (result == StoreMatch::Unconstrained) {
+                result = StoreMatch::Match;
+            }
+            break;
+        case StoreMatch::Unconstrained:
+            // Not part of the SQL expression
+            break;
+        }
+    }
+    return result;
+}
+
 bool OrNode::match(const TrackPointer& pTrack) const {
     // An empty OR node would always evaluate to false
     // which is inconsistent with the generated SQL query!
@@ -125,6 +219,17 @@ QString OrNode::toSql() const {
     return concatSqlClauses(queryFragments, "OR");
 }
 
+StoreMatch OrNode::matchStore(const TrackColumnStore& store, int row) const {
+    StoreMatch result = StoreMatch::Unconstrained;
+    for (const auto& pNode: m_nodes) {
+        result = orStoreMatch(result, pNode->matchStore(store, row));
+        if (result == StoreMatch::Match) {
+            break;
+        }
+    }
+    return result;
+}
+
 bool NotNode::match(const TrackPointer& pTrack) const {
     return !m_pNode->match(pTrack);
 }
@@ -141,6 +246,23 @@ QString NotNode::toSql() const {
     }
 }
 
+bool NotNode::prepareStoreMatch(TrackColumnStore* pStore) const {
+    return m_pNode->prepareStoreMatch(pStore);
+}
+
+StoreMatch NotNode::matchStore(const TrackColumnStore& store, int row) const {
+    const StoreMatch result = m_pNode->matchStore(store, row);
+    switch (result) {
+    case StoreMatch::Match:
+        return StoreMatch::Mismatch;
+    case StoreMatch::Mismatch:
+        return StoreMatch::Match;
+    default:
+        // NOT NULL is NULL
+        return result;
+    }
+}
+
 bool TextFilterNode::match(const TrackPointer& pTrack) const {
     for (const auto& sqlColumn: m_sqlColumns) {
         QVariant value = getTrackValueForColumn(pTrack, sqlColumn);
@@ -166,6 +288,24 @@ QString TextFilterNode::toSql() const {
     return concatSqlClauses(searchClauses, "OR");
 }
 
+bool TextFilterNode::prepareStoreMatch(TrackColumnStore* pStore) const {
+    m_storeColumns.clear();
+    m_storeMatches.clear();
+    for (const auto& sqlColumn: m_sqlColumns) {
+        const int column = pStore->columnIndex(sqlColumn);
+        if (column < 0) {
+            return false;
+        }
+        m_storeColumns.append(column);
+        m_storeMatches.push_back(pStore->matchValuesLike(column, m_argument));
+    }
+    return true;
+}
+
+StoreMatch TextFilterNode::matchStore(const TrackColumnStore& store, int row) const {
+    return matchStoreColumns(store, row, m_storeColumns, m_storeMatches);
+}
+
 CrateFilterNode::CrateFilterNode(const CrateStorage* pCrateStorage,
                                  const QString& crateNameLike)
     : m_pCrateStorage(pCrateStorage),
@@ -173,7 +313,7 @@ CrateFilterNode::CrateFilterNode(const CrateStorage* pCrateStorage,
       m_matchInitialized(false) {
 }
 
-bool CrateFilterNode::match(const TrackPointer& pTrack) const {
+void CrateFilterNode::initMatchingTrackIds() const {
     if (!m_matchInitialized) {
         CrateTrackSelectResult crateTracks(
              m_pCrateStorage->selectTracksSortedByCrateNameLike(m_crateNameLike));
@@ -184,10 +324,24 @@ bool CrateFilterNode::match(const TrackPointer& pTrack) const {
 
         m_matchInitialized = true;
     }
+}
 
+bool CrateFilterNode::match(const TrackPointer& pTrack) const {
+    initMatchingTrackIds();
     return std::binary_search(m_matchingTrackIds.begin(), m_matchingTrackIds.end(), pTrack->getId());
 }
 
+bool CrateFilterNode::prepareStoreMatch(TrackColumnStore* pStore) const {
+    Q_UNUSED(pStore);
+    initMatchingTrackIds();
+    return true;
+}
+
+StoreMatch CrateFilterNode::matchStore(const TrackColumnStore& store, int row) const {
+    return std::binary_search(m_matchingTrackIds.begin(), m_matchingTrackIds.end(),
+            store.trackId(row)) ? StoreMatch::Match : StoreMatch::Mismatch;
+}
+
 QString CrateFilterNode::toSql() const {
     return QString("id IN (%1)").arg(
             m_pCrateStorage->formatQueryForTrackIdsByCrateNameLike(m_crateNameLike));
@@ -290,6 +444,48 @@ QString NumericFilterNode::toSql() const {
     return QString();
 }
 
+bool NumericFilterNode::prepareStoreMatch(TrackColumnStore* pStore) const {
+    m_storeColumns.clear();
+    m_storeMatches.clear();
+    if (!m_bOperatorQuery && !m_bRangeQuery) {
+        return true;
+    }
+    const QVariant operatorArgument = sqlLiteral(m_dOperatorArgument);
+    const QVariant rangeLow = sqlLiteral(m_dRangeLow);
+    const QVariant rangeHigh = sqlLiteral(m_dRangeHigh);
+    for (const auto& sqlColumn: m_sqlColumns) {
+        const int column = pStore->columnIndex(sqlColumn);
+        if (column < 0) {
+            return false;
+        }
+        const int valueCount = pStore->internColumn(column);
+        std::vector<bool> matches(valueCount);
+        for (int valueId = 0; valueId < valueCount; ++valueId) {
+            const QVariant& value = pStore->value(column, valueId);
+            if (m_bOperatorQuery) {
+                const int compare = compareWithSqlLiteral(value, operatorArgument);
+                matches[valueId] =
+                        (m_operator == "=" && compare == 0) ||
+                        (m_operator == "<" && compare < 0) ||
+                        (m_operator == ">" && compare > 0) ||
+                        (m_operator == "<=" && compare <= 0) ||
+                        (m_operator == ">=" && compare >= 0);
+            } else {
+                matches[valueId] =
+                        compareWithSqlLiteral(value, rangeLow) >= 0 &&
+                        compareWithSqlLiteral(value, rangeHigh) <= 0;
+            }
+        }
+        m_storeColumns.append(column);
+        m_storeMatches.push_back(std::move(matches));
+    }
+    return true;
+}
+
+StoreMatch NumericFilterNode::matchStore(const TrackColumnStore& store, int row) const {
+    return matchStoreColumns(store, row, m_storeColumns, m_storeMatches);
+}
+
 DurationFilterNode::DurationFilterNode(
         const QStringList& sqlColumns, const QString& argument)
         : NumericFilterNode(sqlColumns) {
@@ -329,7 +525,8 @@ double DurationFilterNode::parse(const QString& arg, bool* ok) {
 }
 
 KeyFilterNode::KeyFilterNode(mixxx::track::io::key::ChromaticKey key,
-                             bool fuzzy) {
+                             bool fuzzy)
+        : m_storeKeyColumn(-1) {
     if (fuzzy) {
         m_matchKeys = KeyUtils::getCompatibleKeys(key);
     } else {
@@ -348,3 +545,31 @@ QString KeyFilterNode::toSql() const {
     }
     return concatSqlClauses(searchClauses, "OR");
 }
+
+bool KeyFilterNode::prepareStoreMatch(TrackColumnStore* pStore) const {
+    m_storeKeyColumn = pStore->columnIndex(LIBRARYTABLE_KEY_ID);
+    if (m_storeKeyColumn < 0) {
+        return false;
+    }
+    const int valueCount = pStore->internColumn(m_storeKeyColumn);
+    m_storeMatches.assign(valueCount, false);
+    for (int valueId = 0; valueId < valueCount; ++valueId) {
+        const QVariant& value = pStore->value(m_storeKeyColumn, valueId);
+        bool ok = false;
+        const int key = value.toInt(&ok);
+        m_storeMatches[valueId] = ok && value.type() != QVariant::String &&
+                m_matchKeys.contains(
+                        static_cast<mixxx::track::io::key::ChromaticKey>(key));
+    }
+    return true;
+}
+
+StoreMatch KeyFilterNode::matchStore(const TrackColumnStore& store, int row) const {
+    if (m_matchKeys.isEmpty()) {
+        return StoreMatch::Unconstrained;
+    }
+    // "key_id IS <key>" is false and not NULL for NULL values
+    const int valueId = store.valueId(m_storeKeyColumn, row);
+    return valueId >= 0 && m_storeMatches[valueId] ?
+            StoreMatch::Match : StoreMatch::Mismatch;
+}
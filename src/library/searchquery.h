@@ -9,6 +9,7 @@
 #include <QRegExp>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
 #include "track/track.h"
 #include "proto/keys.pb.h"
@@ -16,8 +17,20 @@
 #include "util/memory.h"
 #include "library/crate/cratestorage.h"
 
+class TrackColumnStore;
+
 QVariant getTrackValueForColumn(const TrackPointer& pTrack, const QString& column);
 
+// The result of a query for a track in a TrackColumnStore. Like in SQL a
+// query can be neither true nor false for a track if it contains NULL
+// values. Queries without an SQL expression do not constrain the result.
+enum class StoreMatch {
+    Mismatch,
+    Match,
+    Unknown,
+    Unconstrained,
+};
+
 class QueryNode {
   public:
     QueryNode(const QueryNode&) = delete; // prevent copying
@@ -26,6 +39,20 @@ class QueryNode {
     virtual bool match(const TrackPointer& pTrack) const = 0;
     virtual QString toSql() const = 0;
 
+    // Prepares matchStore() for the tracks of the store. Returns false if
+    // the query can only be evaluated in SQL.
+    virtual bool prepareStoreMatch(TrackColumnStore* pStore) const {
+        Q_UNUSED(pStore);
+        return false;
+    }
+    // Evaluates the SQL expression of the query for the track in the row
+    // of the store.
+    virtual StoreMatch matchStore(const TrackColumnStore& store, int row) const {
+        Q_UNUSED(store);
+        Q_UNUSED(row);
+        return StoreMatch::Unknown;
+    }
+
   protected:
     QueryNode() {}
 
@@ -39,6 +66,8 @@ class GroupNode : public QueryNode {
         m_nodes.push_back(std::move(pNode));
     }
 
+    bool prepareStoreMatch(TrackColumnStore* pStore) const override;
+
   protected:
     // NOTE(uklotzde): std::vector is more suitable (efficiency)
     // than a QList for a private member. And QList from Qt 4
@@ -50,12 +79,14 @@ class OrNode : public GroupNode {
   public:
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    StoreMatch matchStore(const TrackColumnStore& store, int row) const override;
 };
 
 class AndNode : public GroupNode {
   public:
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    StoreMatch matchStore(const TrackColumnStore& store, int row) const override;
 };
 
 class NotNode : public QueryNode {
@@ -67,6 +98,8 @@ class NotNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool prepareStoreMatch(TrackColumnStore* pStore) const override;
+    StoreMatch matchStore(const TrackColumnStore& store, int row) const override;
 
   private:
     std::unique_ptr<QueryNode> m_pNode;
@@ -84,11 +117,18 @@ class TextFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool prepareStoreMatch(TrackColumnStore* pStore) const override;
+    StoreMatch matchStore(const TrackColumnStore& store, int row) const override;
 
   private:
     QSqlDatabase m_database;
     QStringList m_sqlColumns;
     QString m_argument;
+
+    // The store columns of m_sqlColumns and the value ids that match in
+    // each of them
+    mutable QVector<int> m_storeColumns;
+    mutable std::vector<std::vector<bool>> m_storeMatches;
 };
 
 class CrateFilterNode : public QueryNode {
@@ -98,8 +138,12 @@ class CrateFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool prepareStoreMatch(TrackColumnStore* pStore) const override;
+    StoreMatch matchStore(const TrackColumnStore& store, int row) const override;
 
   private:
+    void initMatchingTrackIds() const;
+
     const CrateStorage* m_pCrateStorage;
     QString m_crateNameLike;
     mutable bool m_matchInitialized;
@@ -112,6 +156,8 @@ class NumericFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool prepareStoreMatch(TrackColumnStore* pStore) const override;
+    StoreMatch matchStore(const TrackColumnStore& store, int row) const override;
 
   protected:
     // Single argument constructor for that does not call init()
@@ -133,6 +179,9 @@ class NumericFilterNode : public QueryNode {
     bool m_bRangeQuery;
     double m_dRangeLow;
     double m_dRangeHigh;
+
+    mutable QVector<int> m_storeColumns;
+    mutable std::vector<std::vector<bool>> m_storeMatches;
 };
 
 class DurationFilterNode : public NumericFilterNode {
@@ -149,9 +198,14 @@ class KeyFilterNode : public QueryNode {
 
     bool match(const TrackPointer& pTrack) const override;
     QString toSql() const override;
+    bool prepareStoreMatch(TrackColumnStore* pStore) const override;
+    StoreMatch matchStore(const TrackColumnStore& store, int row) const override;
 
   private:
     QList<mixxx::track::io::key::ChromaticKey> m_matchKeys;
+
+    mutable int m_storeKeyColumn;
+    mutable std::vector<bool> m_storeMatches;
 };
 
 class SqlNode : public QueryNode {
@@ -0,0 +1,505 @@
+#include "library/trackcolumnstore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "util/assert.h"
+#include "util/db/dbconnection.h"
+#include "util/db/sqllikewildcards.h"
+
+namespace {
+
+// The escape character of LIKE without an ESCAPE clause
+const QChar kSqlLikeEscapeDefault = '\0';
+
+// Only strings with at least this many characters are found through the
+// trigram index, shorter ones are compared with every value.
+const int kTrigramLength = 3;
+
+bool isIntegerValue(const QVariant& value) {
+    switch (static_cast<QMetaType::Type>(value.type())) {
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isRealValue(const QVariant& value) {
+    switch (static_cast<QMetaType::Type>(value.type())) {
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Values are interned by their storage class and value, e.g. the integer 5
+// and the text '5' are different values.
+QString valueKey(const QVariant& value) {
+    if (isIntegerValue(value)) {
+        return QChar('i') + QString::number(value.toLongLong());
+    } else if (isRealValue(value)) {
+        return QChar('r') + QString::number(value.toDouble(), 'g', 17);
+    } else {
+        return QChar('t') + value.toString();
+    }
+}
+
+quint64 trigramKey(const QChar* pChars) {
+    return (quint64(pChars[0].unicode()) << 32) |
+            (quint64(pChars[1].unicode()) << 16) |
+            quint64(pChars[2].unicode());
+}
+
+// Like SQLite's CAST(text AS INTEGER): the integer prefix of the text,
+// or 0 if there is none.
+qint64 castTextToInteger(const QString& text) {
+    int i = 0;
+    while (i < text.size() && text[i].isSpace()) {
+        ++i;
+    }
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        ++i;
+    }
+    qint64 result = 0;
+    while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+        result = result * 10 + (text[i].unicode() - '0');
+        ++i;
+    }
+    return negative ? -result : result;
+}
+
+} // anonymous namespace
+
+// A value as it is compared by ORDER BY in SQLite: NULL sorts first,
+// followed by all numbers and then all texts.
+struct TrackColumnStore::SortValue {
+    enum class Class {
+        Null,
+        Number,
+        Text,
+    };
+
+    SortValue()
+            : valueClass(Class::Null),
+              number(0.0) {
+    }
+    explicit SortValue(double number)
+            : valueClass(Class::Number),
+              number(number) {
+    }
+    explicit SortValue(const QString& text)
+            // The collation of mixxx::DbConnection compares the lower case
+            // texts with QString::localeAwareCompare()
+            : valueClass(Class::Text),
+              number(0.0),
+              lowerText(text.toLower()) {
+    }
+
+    static SortValue fromValue(const QVariant& value,
+            ColumnCache::SortType type,
+            KeyUtils::KeyNotation keyNotation) {
+        if (value.isNull()) {
+            return SortValue();
+        }
+        switch (type) {
+        case ColumnCache::SORT_NOCASE:
+            // lower() always returns a text
+            return SortValue(sqlText(value));
+        case ColumnCache::SORT_INTEGER:
+            if (isIntegerValue(value)) {
+                return SortValue(value.toDouble());
+            } else if (isRealValue(value)) {
+                return SortValue(std::trunc(value.toDouble()));
+            } else {
+                return SortValue(static_cast<double>(
+                        castTextToInteger(value.toString())));
+            }
+        case ColumnCache::SORT_KEY: {
+            // CASE key_id WHEN 0 THEN ... WHEN 24 THEN ... END
+            if (!isIntegerValue(value)) {
+                return SortValue();
+            }
+            const qint64 key = value.toLongLong();
+            if (key < 0 || key > 24) {
+                return SortValue();
+            }
+            return SortValue(KeyUtils::keyToCircleOfFifthsOrder(
+                    static_cast<mixxx::track::io::key::ChromaticKey>(key),
+                    keyNotation));
+        }
+        default:
+            if (isIntegerValue(value) || isRealValue(value)) {
+                return SortValue(value.toDouble());
+            }
+            return SortValue(sqlText(value));
+        }
+    }
+
+    static int compare(const SortValue& first, const SortValue& second) {
+        if (first.valueClass != second.valueClass) {
+            return first.valueClass < second.valueClass ? -1 : 1;
+        }
+        switch (first.valueClass) {
+        case Class::Number:
+            if (first.number < second.number) {
+                return -1;
+            }
+            return first.number > second.number ? 1 : 0;
+        case Class::Text:
+            return QString::localeAwareCompare(
+                    first.lowerText, second.lowerText);
+        default:
+            return 0;
+        }
+    }
+
+    Class valueClass;
+    double number;
+    QString lowerText;
+};
+
+struct TrackColumnStore::SortIndex {
+    SortIndex(ColumnCache::SortType type, KeyUtils::KeyNotation keyNotation)
+            : type(type),
+              keyNotation(keyNotation),
+              maxRank(0) {
+    }
+
+    const ColumnCache::SortType type;
+    const KeyUtils::KeyNotation keyNotation;
+
+    // The sort value of each value id that has been sorted
+    QVector<SortValue> sortValues;
+    // The value ids in sort order
+    QVector<int> sortedValueIds;
+    // Whether the value compares equal to the previous one in sort order.
+    // The first value is equal to its predecessor if it sorts like NULL.
+    QVector<bool> tiesWithPrevious;
+    // The position of each value id in sort order with equal values
+    // sharing their position. NULL has rank 0.
+    QVector<int> ranks;
+    int maxRank;
+};
+
+TrackColumnStore::TrackColumnStore(const QStringList& columns)
+        : m_columns(columns),
+          m_columnIndexes(columns.size()) {
+}
+
+TrackColumnStore::~TrackColumnStore() {
+}
+
+void TrackColumnStore::clear() {
+    m_records.clear();
+    m_trackIds.clear();
+    m_rowsByTrackId.clear();
+    m_freeRows.clear();
+    for (auto& pColumnIndex : m_columnIndexes) {
+        pColumnIndex.reset();
+    }
+}
+
+void TrackColumnStore::setRecord(TrackId trackId, QVector<QVariant> record) {
+    DEBUG_ASSERT(record.size() == m_columns.size());
+    int row = m_rowsByTrackId.value(trackId, -1);
+    if (row < 0) {
+        if (m_freeRows.isEmpty()) {
+            row = m_records.size();
+            m_records.append(QVector<QVariant>());
+            m_trackIds.append(trackId);
+            for (const auto& pColumnIndex : m_columnIndexes) {
+                if (pColumnIndex) {
+                    pColumnIndex->valueIds.append(-1);
+                }
+            }
+        } else {
+            row = m_freeRows.takeLast();
+            m_trackIds[row] = trackId;
+        }
+        m_rowsByTrackId.insert(trackId, row);
+    }
+    m_records[row] = std::move(record);
+
+    for (int column = 0; column < m_columns.size(); ++column) {
+        ColumnIndex* pColumnIndex = m_columnIndexes[column].get();
+        if (pColumnIndex) {
+            internValue(pColumnIndex, row, m_records[row][column]);
+        }
+    }
+}
+
+void TrackColumnStore::removeRecord(TrackId trackId) {
+    const int row = m_rowsByTrackId.value(trackId, -1);
+    if (row < 0) {
+        return;
+    }
+    m_rowsByTrackId.remove(trackId);
+    m_records[row].clear();
+    m_trackIds[row] = TrackId();
+    for (const auto& pColumnIndex : m_columnIndexes) {
+        if (pColumnIndex) {
+            pColumnIndex->valueIds[row] = -1;
+        }
+    }
+    m_freeRows.append(row);
+}
+
+TrackColumnStore::ColumnIndex& TrackColumnStore::columnIndex(int column) {
+    DEBUG_ASSERT(column >= 0 && column < m_columns.size());
+    std::unique_ptr<ColumnIndex>& pColumnIndex = m_columnIndexes[column];
+    if (!pColumnIndex) {
+        pColumnIndex = std::make_unique<ColumnIndex>();
+        pColumnIndex->valueIds.fill(-1, m_records.size());
+        for (int row = 0; row < m_records.size(); ++row) {
+            if (m_trackIds[row].isValid()) {
+                internValue(pColumnIndex.get(), row, m_records[row][column]);
+            }
+        }
+    }
+    return *pColumnIndex;
+}
+
+void TrackColumnStore::internValue(
+        ColumnIndex* pColumnIndex, int row, const QVariant& value) {
+    if (value.isNull()) {
+        pColumnIndex->valueIds[row] = -1;
+        return;
+    }
+    const QString key = valueKey(value);
+    auto it = pColumnIndex->valueIdsByKey.constFind(key);
+    if (it == pColumnIndex->valueIdsByKey.constEnd()) {
+        const int valueId = pColumnIndex->values.size();
+        pColumnIndex->values.append(value);
+        it = pColumnIndex->valueIdsByKey.insert(key, valueId);
+    }
+    pColumnIndex->valueIds[row] = it.value();
+}
+
+int TrackColumnStore::internColumn(int column) {
+    return columnIndex(column).values.size();
+}
+
+//static
+QString TrackColumnStore::sqlText(const QVariant& value) {
+    if (isIntegerValue(value)) {
+        return QString::number(value.toLongLong());
+    } else if (isRealValue(value)) {
+        // SQLite formats reals with "%!.15g", which always contains a
+        // decimal point.
+        QString text = QString::number(value.toDouble(), 'g', 15);
+        if (!text.contains('.') && !text.contains('n')) {
+            const int exponent = text.indexOf('e');
+            text.insert(exponent < 0 ? text.size() : exponent, ".0");
+        }
+        return text;
+    } else {
+        return value.toString();
+    }
+}
+
+void TrackColumnStore::updateSearchIndex(ColumnIndex* pColumnIndex) {
+    for (int valueId = pColumnIndex->searchTexts.size();
+            valueId < pColumnIndex->values.size();
+            ++valueId) {
+        const QString searchText = mixxx::DbConnection::latinLow(
+                sqlText(pColumnIndex->values[valueId]));
+        for (int i = 0; i + kTrigramLength <= searchText.size(); ++i) {
+            QVector<int>& valueIds = pColumnIndex->valueIdsByTrigram[
+                    trigramKey(searchText.constData() + i)];
+            if (valueIds.isEmpty() || valueIds.last() != valueId) {
+                valueIds.append(valueId);
+            }
+        }
+        pColumnIndex->searchTexts.append(searchText);
+    }
+}
+
+std::vector<bool> TrackColumnStore::matchValuesLike(
+        int column, const QString& argument) {
+    ColumnIndex& index = columnIndex(column);
+    std::vector<bool> matches(index.values.size(), false);
+
+    if (argument.contains(kSqlLikeMatchAll) ||
+            argument.contains(kSqlLikeMatchOne)) {
+        // Wildcards are rare, evaluate the pattern for each value
+        const QString pattern =
+                kSqlLikeMatchAll + argument + kSqlLikeMatchAll;
+        for (int valueId = 0; valueId < index.values.size(); ++valueId) {
+            QString valuePattern = pattern;
+            QString text = sqlText(index.values[valueId]);
+            matches[valueId] = mixxx::DbConnection::likeCompareLatinLow(
+                    &valuePattern, &text, kSqlLikeEscapeDefault);
+        }
+        return matches;
+    }
+
+    updateSearchIndex(&index);
+    const QString needle = mixxx::DbConnection::latinLow(argument);
+    if (needle.size() < kTrigramLength) {
+        for (int valueId = 0; valueId < index.searchTexts.size(); ++valueId) {
+            matches[valueId] = index.searchTexts[valueId].contains(needle);
+        }
+        return matches;
+    }
+
+    // Every value that contains the needle contains all of its trigrams.
+    // Verify the values of the least frequent trigram.
+    const QVector<int>* pCandidates = nullptr;
+    for (int i = 0; i + kTrigramLength <= needle.size(); ++i) {
+        const auto it = index.valueIdsByTrigram.constFind(
+                trigramKey(needle.constData() + i));
+        if (it == index.valueIdsByTrigram.constEnd()) {
+            return matches;
+        }
+        if (!pCandidates || it.value().size() < pCandidates->size()) {
+            pCandidates = &it.value();
+        }
+    }
+    for (int valueId : *pCandidates) {
+        matches[valueId] = index.searchTexts[valueId].contains(needle);
+    }
+    return matches;
+}
+
+TrackColumnStore::SortIndex& TrackColumnStore::sortIndex(
+        ColumnIndex* pColumnIndex,
+        ColumnCache::SortType type,
+        KeyUtils::KeyNotation keyNotation) {
+    SortIndex* pSortIndex = nullptr;
+    for (const auto& pExisting : pColumnIndex->sortIndexes) {
+        if (pExisting->type == type &&
+                (type != ColumnCache::SORT_KEY ||
+                        pExisting->keyNotation == keyNotation)) {
+            pSortIndex = pExisting.get();
+            break;
+        }
+    }
+    if (!pSortIndex) {
+        pColumnIndex->sortIndexes.push_back(
+                std::make_unique<SortIndex>(type, keyNotation));
+        pSortIndex = pColumnIndex->sortIndexes.back().get();
+    }
+    updateSortIndex(*pColumnIndex, pSortIndex);
+    return *pSortIndex;
+}
+
+void TrackColumnStore::updateSortIndex(
+        const ColumnIndex& columnIndex, SortIndex* pSortIndex) {
+    const int sortedCount = pSortIndex->sortValues.size();
+    const int valueCount = columnIndex.values.size();
+    if (sortedCount == valueCount) {
+        return;
+    }
+
+    QVector<SortValue>& sortValues = pSortIndex->sortValues;
+    sortValues.reserve(valueCount);
+    for (int valueId = sortedCount; valueId < valueCount; ++valueId) {
+        sortValues.append(SortValue::fromValue(columnIndex.values[valueId],
+                pSortIndex->type, pSortIndex->keyNotation));
+    }
+    auto compare = [&sortValues](int first, int second) {
+        return SortValue::compare(sortValues[first], sortValues[second]);
+    };
+
+    QVector<int> newValueIds(valueCount - sortedCount);
+    std::iota(newValueIds.begin(), newValueIds.end(), sortedCount);
+    std::stable_sort(newValueIds.begin(), newValueIds.end(),
+            [&compare](int first, int second) {
+                return compare(first, second) < 0;
+            });
+
+    // Merge the new values into the sorted values. Only values next to a
+    // new value need to be compared to find the ties, all others keep
+    // the ties they already had.
+    const QVector<int>& oldValueIds = pSortIndex->sortedValueIds;
+    const QVector<bool>& oldTies = pSortIndex->tiesWithPrevious;
+    QVector<int> mergedValueIds;
+    QVector<bool> mergedTies;
+    mergedValueIds.reserve(valueCount);
+    mergedTies.reserve(valueCount);
+    int oldPos = 0;
+    int newPos = 0;
+    bool previousIsOld = false;
+    while (oldPos < oldValueIds.size() || newPos < newValueIds.size()) {
+        const bool takeOld = newPos == newValueIds.size() ||
+                (oldPos < oldValueIds.size() &&
+                        compare(oldValueIds[oldPos], newValueIds[newPos]) <= 0);
+        int valueId;
+        bool tie;
+        if (takeOld) {
+            valueId = oldValueIds[oldPos];
+            if (mergedValueIds.isEmpty() || previousIsOld) {
+                // Same predecessor as before
+                tie = oldTies[oldPos];
+            } else {
+                tie = compare(mergedValueIds.last(), valueId) == 0;
+            }
+            ++oldPos;
+        } else {
+            valueId = newValueIds[newPos++];
+            if (mergedValueIds.isEmpty()) {
+                tie = sortValues[valueId].valueClass == SortValue::Class::Null;
+            } else {
+                tie = compare(mergedValueIds.last(), valueId) == 0;
+            }
+        }
+        previousIsOld = takeOld;
+        mergedValueIds.append(valueId);
+        mergedTies.append(tie);
+    }
+    pSortIndex->sortedValueIds = std::move(mergedValueIds);
+    pSortIndex->tiesWithPrevious = std::move(mergedTies);
+
+    pSortIndex->ranks.resize(valueCount);
+    int rank = 0;
+    for (int pos = 0; pos < valueCount; ++pos) {
+        if (!pSortIndex->tiesWithPrevious[pos]) {
+            ++rank;
+        }
+        pSortIndex->ranks[pSortIndex->sortedValueIds[pos]] = rank;
+    }
+    pSortIndex->maxRank = rank;
+}
+
+void TrackColumnStore::sortRows(QVector<int>* pRows,
+        const QList<SortColumn>& sortColumns,
+        KeyUtils::KeyNotation keyNotation) {
+    QVector<int> sortedRows(pRows->size());
+    QVector<int> rowRanks(pRows->size());
+    QVector<int> counts;
+    // A stable counting sort by each sort column, starting with the least
+    // significant one.
+    for (int i = sortColumns.size() - 1; i >= 0; --i) {
+        const SortColumn& sortColumn = sortColumns[i];
+        ColumnIndex& index = columnIndex(sortColumn.m_column);
+        const SortIndex& sortIndex = this->sortIndex(
+                &index, sortColumn.m_type, keyNotation);
+        const bool descending = sortColumn.m_order == Qt::DescendingOrder;
+
+        counts.fill(0, sortIndex.maxRank + 2);
+        for (int pos = 0; pos < pRows->size(); ++pos) {
+            const int valueId = index.valueIds[(*pRows)[pos]];
+            int rank = valueId < 0 ? 0 : sortIndex.ranks[valueId];
+            if (descending) {
+                rank = sortIndex.maxRank - rank;
+            }
+            rowRanks[pos] = rank;
+            ++counts[rank + 1];
+        }
+        std::partial_sum(counts.begin(), counts.end(), counts.begin());
+        for (int pos = 0; pos < pRows->size(); ++pos) {
+            sortedRows[counts[rowRanks[pos]]++] = (*pRows)[pos];
+        }
+        pRows->swap(sortedRows);
+    }
+}
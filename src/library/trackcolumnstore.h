@@ -0,0 +1,146 @@
+#ifndef MIXXX_TRACKCOLUMNSTORE_H
+#define MIXXX_TRACKCOLUMNSTORE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+#include "library/columncache.h"
+#include "track/keyutils.h"
+#include "track/trackid.h"
+
+// The records of a BaseTrackCache, indexed for searching and sorting them
+// in memory instead of in SQL.
+//
+// The values of each column are interned, i.e. a row only stores the ids
+// of its values and searches and sorts work on the distinct values of a
+// column, which are far fewer than the rows for most columns. Columns are
+// interned when they are first searched or sorted and kept up to date
+// incrementally from then on. For text searches each column has a trigram
+// index of its distinct values, and for each kind of sort the distinct
+// values are kept in order, so rows are sorted by an integer rank.
+//
+// Values that are no longer referenced by any row are kept until clear()
+// is called.
+//
+// Searches and sorts follow the semantics of SQLite with the collation and
+// LIKE function of mixxx::DbConnection, so the results are the same as
+// those of the SQL queries of BaseTrackCache.
+class TrackColumnStore {
+  public:
+    struct SortColumn {
+        SortColumn(int column, ColumnCache::SortType type, Qt::SortOrder order)
+                : m_column(column),
+                  m_type(type),
+                  m_order(order) {
+        }
+        // For SORT_KEY the column of the key id
+        int m_column;
+        ColumnCache::SortType m_type;
+        Qt::SortOrder m_order;
+    };
+
+    explicit TrackColumnStore(const QStringList& columns);
+    ~TrackColumnStore();
+
+    void clear();
+
+    int columnCount() const {
+        return m_columns.size();
+    }
+    // Returns -1 if there is no such column
+    int columnIndex(const QString& columnName) const {
+        return m_columns.indexOf(columnName);
+    }
+
+    bool contains(TrackId trackId) const {
+        return m_rowsByTrackId.contains(trackId);
+    }
+    // Returns -1 if the track is not stored
+    int row(TrackId trackId) const {
+        return m_rowsByTrackId.value(trackId, -1);
+    }
+    TrackId trackId(int row) const {
+        return m_trackIds[row];
+    }
+    const QVector<QVariant>& record(int row) const {
+        return m_records[row];
+    }
+
+    // Inserts or replaces the record of a track. The record must contain a
+    // value for each column.
+    void setRecord(TrackId trackId, QVector<QVariant> record);
+    void removeRecord(TrackId trackId);
+
+    // Interns the values of the column and returns the number of its
+    // distinct values. The value ids of a column are stable until clear()
+    // is called, new values get the next higher id.
+    int internColumn(int column);
+    // Returns the id of the value of the row, or -1 if the value is NULL.
+    // The column must have been interned before.
+    int valueId(int column, int row) const {
+        return m_columnIndexes[column]->valueIds[row];
+    }
+    const QVariant& value(int column, int valueId) const {
+        return m_columnIndexes[column]->values[valueId];
+    }
+
+    // Returns a bitmap over the value ids of the column of the values that
+    // are LIKE '%argument%'.
+    std::vector<bool> matchValuesLike(int column, const QString& argument);
+
+    // Sorts the rows like "ORDER BY <sortColumns>". Rows that compare equal
+    // keep their order.
+    void sortRows(QVector<int>* pRows,
+            const QList<SortColumn>& sortColumns,
+            KeyUtils::KeyNotation keyNotation);
+
+    // The text of a value as seen by SQL functions, e.g. LIKE.
+    static QString sqlText(const QVariant& value);
+
+  private:
+    struct SortValue;
+    struct SortIndex;
+
+    struct ColumnIndex {
+        // The value id of each row, -1 for NULL
+        QVector<int> valueIds;
+        QVector<QVariant> values;
+        QHash<QString, int> valueIdsByKey;
+
+        // The folded text of each value, for values that have already
+        // been added to the trigram index.
+        QVector<QString> searchTexts;
+        // The ids of the values whose folded text contains the trigram, in
+        // ascending order.
+        QHash<quint64, QVector<int>> valueIdsByTrigram;
+
+        std::vector<std::unique_ptr<SortIndex>> sortIndexes;
+    };
+
+    ColumnIndex& columnIndex(int column);
+    void internValue(ColumnIndex* pIndex, int row, const QVariant& value);
+    void updateSearchIndex(ColumnIndex* pIndex);
+    SortIndex& sortIndex(ColumnIndex* pIndex, ColumnCache::SortType type,
+            KeyUtils::KeyNotation keyNotation);
+    void updateSortIndex(const ColumnIndex& index, SortIndex* pSortIndex);
+
+    const QStringList m_columns;
+
+    QVector<QVector<QVariant>> m_records;
+    QVector<TrackId> m_trackIds;
+    QHash<TrackId, int> m_rowsByTrackId;
+    // Rows of removed tracks that are reused for new tracks
+    QVector<int> m_freeRows;
+
+    // Null for columns that have not been interned yet
+    std::vector<std::unique_ptr<ColumnIndex>> m_columnIndexes;
+};
+
+#endif // MIXXX_TRACKCOLUMNSTORE_H
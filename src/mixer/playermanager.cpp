@@ -9,6 +9,7 @@
 #include "control/controlobject.h"
 #include "effects/effectsmanager.h"
 #include "effects/effectrack.h"
+#include "engine/cachingreader.h"
 #include "engine/enginedeck.h"
 #include "engine/enginemaster.h"
 #include "library/library.h"
@@ -53,6 +54,9 @@ PlayerManager::PlayerManager(UserSettingsPointer pConfig,
                 ConfigKey("[Master]", "num_microphones"), true, true)),
         m_pCONumAuxiliaries(new ControlObject(
                 ConfigKey("[Master]", "num_auxiliaries"), true, true)) {
+    // The memory budget is shared by the readers of all players
+    CachingReader::setChunkBudgetFromConfig(m_pConfig);
+
     connect(m_pCONumDecks, SIGNAL(valueChanged(double)),
             this, SLOT(slotNumDecksControlChanged(double)),
             Qt::DirectConnection);
@@ -85,7 +89,7 @@ PlayerManager::PlayerManager(UserSettingsPointer pConfig,
             Qt::DirectConnection);
 
     // This is parented to the PlayerManager so does not need to be deleted
-    m_pSamplerBank = new SamplerBank(this);
+    m_pSamplerBank = new SamplerBank(m_pConfig, this);
 }
 
 PlayerManager::~PlayerManager() {
@@ -124,7 +128,13 @@ void PlayerManager::bindToLibrary(Library* pLibrary) {
     connect(this, SIGNAL(loadLocationToPlayer(QString, QString)),
             pLibrary, SLOT(slotLoadLocationToPlayer(QString, QString)));
 
-    m_pAnalyzerQueue = new AnalyzerQueue(pLibrary->dbConnectionPool(), m_pConfig);
+    // Tracks loaded into players are analysed one after another by a
+    // single worker to avoid competing with the engine for CPU time.
+    m_pAnalyzerQueue = new AnalyzerQueue(
+            pLibrary->dbConnectionPool(),
+            m_pConfig,
+            AnalyzerQueue::Mode::Default,
+            1);
 
     // Connect the player to the analyzer queue so that loaded tracks are
     // analysed.
@@ -431,6 +441,7 @@ void PlayerManager::addSamplerInner() {
 
     Sampler* pSampler = new Sampler(this, m_pConfig, m_pEngine,
                                     m_pEffectsManager, orientation, group);
+    m_pSamplerBank->initSampler(pSampler);
     if (m_pAnalyzerQueue) {
         connect(pSampler, SIGNAL(newTrackLoaded(TrackPointer)),
                 m_pAnalyzerQueue, SLOT(slotAnalyseTrack(TrackPointer)));
@@ -4,15 +4,45 @@
 #include <QMessageBox>
 
 #include "control/controlpushbutton.h"
+#include "engine/decodedsamplecache.h"
+#include "engine/enginebuffer.h"
+#include "engine/enginedeck.h"
 #include "mixer/playermanager.h"
 #include "mixer/sampler.h"
 #include "track/track.h"
 #include "util/assert.h"
 
-SamplerBank::SamplerBank(PlayerManager* pPlayerManager)
+namespace {
+
+// 20 s of stereo audio at 48 kHz take 7.3 MiB
+const int kDefaultDecodeToMemoryMaxSeconds = 20;
+const int kDefaultDecodeToMemoryBudgetMiB = 128;
+
+const ConfigKey kDecodeToMemoryMaxSecondsConfigKey(
+        "[Sampler]", "decode_to_memory_max_seconds");
+const ConfigKey kDecodeToMemoryBudgetConfigKey(
+        "[Sampler]", "decode_to_memory_budget_mb");
+
+} // anonymous namespace
+
+SamplerBank::SamplerBank(UserSettingsPointer pConfig,
+                         PlayerManager* pPlayerManager)
         : QObject(pPlayerManager),
           m_pPlayerManager(pPlayerManager) {
     DEBUG_ASSERT(m_pPlayerManager);
+
+    int maxSeconds = kDefaultDecodeToMemoryMaxSeconds;
+    int budgetMiB = kDefaultDecodeToMemoryBudgetMiB;
+    if (pConfig) {
+        maxSeconds = pConfig->getValue(
+                kDecodeToMemoryMaxSecondsConfigKey, maxSeconds);
+        budgetMiB = pConfig->getValue(
+                kDecodeToMemoryBudgetConfigKey, budgetMiB);
+    }
+    DecodedSampleCache::setMemoryBudget(static_cast<qint64>(budgetMiB) << 20);
+    // Samplers are added later and set up with initSampler()
+    m_decodeToMemoryMaxDuration = mixxx::Duration::fromSeconds(maxSeconds);
+
     m_pCOLoadBank = std::make_unique<ControlPushButton>(ConfigKey("[Sampler]", "LoadSamplerBank"), this);
     connect(m_pCOLoadBank.get(), SIGNAL(valueChanged(double)),
             this, SLOT(slotLoadSamplerBank(double)));
@@ -26,6 +56,12 @@ SamplerBank::SamplerBank(PlayerManager* pPlayerManager)
 SamplerBank::~SamplerBank() {
 }
 
+void SamplerBank::initSampler(Sampler* pSampler) const {
+    DEBUG_ASSERT(pSampler);
+    pSampler->getEngineDeck()->getEngineBuffer()->setDecodeToMemory(
+            m_decodeToMemoryMaxDuration);
+}
+
 void SamplerBank::slotSaveSamplerBank(double v) {
     if (v <= 0.0) {
         return;
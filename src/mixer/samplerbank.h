@@ -2,11 +2,14 @@
 #define MIXER_SAMPLERBANK_H
 
 #include <QObject>
+#include "preferences/usersettings.h"
+#include "util/duration.h"
 #include "util/memory.h"
 
 class ControlObject;
 class ControlProxy;
 class PlayerManager;
+class Sampler;
 
 // TODO(Be): Replace saving/loading an XML file with saving/loading to the database.
 //           That should be part of a larger project to implement
@@ -14,18 +17,25 @@ class PlayerManager;
 class SamplerBank : public QObject {
     Q_OBJECT
   public:
-    SamplerBank(PlayerManager* pPlayerManager);
+    SamplerBank(UserSettingsPointer pConfig, PlayerManager* pPlayerManager);
     virtual ~SamplerBank();
 
     bool saveSamplerBankToPath(const QString& samplerBankPath);
     bool loadSamplerBankFromPath(const QString& samplerBankPath);
 
+    // Applies the settings of the bank to a newly added sampler. Samples up
+    // to [Sampler],decode_to_memory_max_seconds are decoded completely into
+    // memory when they are loaded, so triggering them never waits for the
+    // disk. Samplers that load the same file share the decoded samples.
+    void initSampler(Sampler* pSampler) const;
+
   private slots:
     void slotSaveSamplerBank(double v);
     void slotLoadSamplerBank(double v);
 
   private:
     PlayerManager* m_pPlayerManager;
+    mixxx::Duration m_decodeToMemoryMaxDuration;
     std::unique_ptr<ControlObject> m_pCOLoadBank;
     std::unique_ptr<ControlObject> m_pCOSaveBank;
     ControlProxy* m_pCONumSamplers;
@@ -81,6 +81,10 @@
 #include "preferences/dialog/dlgprefmodplug.h"
 #endif
 
+#ifdef __MAD__
+#include "sources/mp3seekindexcache.h"
+#endif
+
 namespace {
 
 const mixxx::Logger kLogger("MixxxMainWindow");
@@ -173,6 +177,11 @@ void MixxxMainWindow::initialize(QApplication* pApp, const CmdlineArgs& args) {
 
     Sandbox::initialize(QDir(pConfig->getSettingsPath()).filePath("sandbox.cfg"));
 
+#ifdef __MAD__
+    mixxx::Mp3SeekIndexCache::setCachePath(
+            QDir(pConfig->getSettingsPath()).filePath("mp3seekindex"));
+#endif
+
     QString resourcePath = pConfig->getResourcePath();
 
     FontUtils::initializeFonts(resourcePath); // takes a long time
@@ -27,6 +27,8 @@
 #include "skin/colorschemeparser.h"
 #include "skin/skincontext.h"
 #include "skin/launchimage.h"
+#include "skin/skincache.h"
+#include "skin/skinimageprefetcher.h"
 
 #include "effects/effectsmanager.h"
 
@@ -36,6 +38,7 @@
 #include "widget/wbasewidget.h"
 #include "widget/wcoverart.h"
 #include "widget/wwidget.h"
+#include "widget/wimagestore.h"
 #include "widget/wknob.h"
 #include "widget/wknobcomposed.h"
 #include "widget/wslidercomposed.h"
@@ -303,12 +306,20 @@ Qt::MouseButton LegacySkinParser::parseButtonState(const QDomNode& node,
 }
 
 QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent) {
-    ScopedTimer timer("SkinLoader::parseSkin");
-    qDebug() << "LegacySkinParser loading skin:" << skinPath;
-
     m_pContext = std::make_unique<SkinContext>(m_pConfig, skinPath + "/skin.xml");
     m_pContext->setSkinBasePath(skinPath);
 
+    // On a warm start the images rasterized from the SVGs of the skin are
+    // read from the cache instead of being rendered again.
+    const bool warmStart = SkinCache::open(
+            QDir(m_pConfig->getSettingsPath()).filePath("skincache"),
+            skinPath,
+            m_pConfig->getValueString(ConfigKey("[Config]", "Scheme")),
+            m_pContext->getScaleFactor());
+
+    ScopedTimer timer("SkinLoader::parseSkin %1", warmStart ? "warm" : "cold");
+    qDebug() << "LegacySkinParser loading skin:" << skinPath;
+
     if (m_pParent) {
         qDebug() << "ERROR: Somehow a parent already exists -- you are probably re-using a LegacySkinParser which is not advisable!";
     }
@@ -386,7 +397,24 @@ QWidget* LegacySkinParser::parseSkin(const QString& skinPath, QWidget* pParent)
     // created parent so MixxxMainWindow can use it for nefarious purposes (
     // fullscreen mostly) --bkgood
     m_pParent = pParent;
+
+    // The images are loaded concurrently once the color scheme has set up the
+    // image loader. On a warm start the SVGs are read from the SkinCache.
+    QList<PixmapSource> imageSources = SkinImagePrefetcher::findImageSources(
+            skinPath, *m_pContext);
+    if (warmStart) {
+        QMutableListIterator<PixmapSource> it(imageSources);
+        while (it.hasNext()) {
+            if (it.next().isSVG()) {
+                it.remove();
+            }
+        }
+    }
+    SkinImagePrefetcher::prefetch(imageSources, m_pContext->getScaleFactor(),
+            WImageStore::getLoader());
+
     QList<QWidget*> widgets = parseNode(skinDocument);
+    SkinImagePrefetcher::clear();
 
     if (widgets.empty()) {
         SKIN_WARNING(skinDocument, *m_pContext) << "Skin produced no widgets!";
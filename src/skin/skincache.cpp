@@ -0,0 +1,251 @@
+#include "skin/skincache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QSaveFile>
+#include <QStringList>
+#include <QtDebug>
+
+#include <cstring>
+
+#include "util/counter.h"
+#include "util/version.h"
+
+namespace {
+
+// The header of a cached image, followed by its scan lines. All fields are
+// stored in the byte order of the writer, files in another byte order are
+// not read.
+struct ImageHeader {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 byteOrder;
+    quint32 width;
+    quint32 height;
+    // QImage::Format
+    quint32 format;
+    quint32 bytesPerLine;
+    char reserved[8];
+};
+
+static_assert(sizeof(ImageHeader) == 40,
+        "The cached image header must have a fixed size");
+
+const char kImageMagic[8] = {'M', 'X', 'S', 'K', 'I', 'M', 'G', '\0'};
+// Increment when changing the layout. Files in other versions are treated
+// as missing and are replaced.
+const quint32 kImageFormatVersion = 1;
+const quint32 kImageByteOrder = 0x01020304;
+const QString kImageSuffix = ".img";
+
+const QString kImageFileNamesFile = "imagefiles.txt";
+// The first line of the list of image file names, followed by one file name
+// per line
+const QByteArray kImageFileNamesHeader = "MXSKSRC 1";
+
+QString skinFingerprint(const QString& skinPath, const QString& colorScheme,
+        double scaleFactor) {
+    // Only stat the files, hashing their contents would take a good part of
+    // the time that the cache saves.
+    const QDir skinDir(skinPath);
+    QStringList files;
+    QDirIterator it(skinPath, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        files.append(QString("%1:%2:%3").arg(
+                skinDir.relativeFilePath(info.filePath()),
+                QString::number(info.size()),
+                QString::number(info.lastModified().toMSecsSinceEpoch())));
+    }
+    // The order of the iterator is not defined
+    files.sort();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(Version::version().toUtf8());
+    hash.addData(colorScheme.toUtf8());
+    hash.addData(QByteArray::number(scaleFactor));
+    for (const QString& file : files) {
+        hash.addData(file.toUtf8());
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+} // anonymous namespace
+
+// static
+QString SkinCache::s_directory;
+
+// static
+bool SkinCache::open(const QString& cachePath, const QString& skinPath,
+        const QString& colorScheme, double scaleFactor) {
+    close();
+
+    const QString skinName = QDir(skinPath).dirName();
+    const QString directoryName = skinName + "-" +
+            skinFingerprint(skinPath, colorScheme, scaleFactor);
+
+    QDir cacheDir(cachePath);
+    // Remove the previous caches of the skin, they have a fingerprint of the
+    // same length.
+    const QStringList entries = cacheDir.entryList(
+            QStringList(skinName + "-*"), QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        if (entry != directoryName && entry.size() == directoryName.size()) {
+            qDebug() << "SkinCache: removing outdated cache" << entry;
+            QDir(cacheDir.filePath(entry)).removeRecursively();
+        }
+    }
+
+    if (!cacheDir.mkpath(directoryName)) {
+        qWarning() << "SkinCache: could not create directory"
+                   << cacheDir.filePath(directoryName);
+        return false;
+    }
+    s_directory = cacheDir.filePath(directoryName);
+
+    return !QDir(s_directory).entryList(
+            QStringList("*" + kImageSuffix), QDir::Files).isEmpty();
+}
+
+// static
+void SkinCache::close() {
+    s_directory.clear();
+}
+
+// static
+bool SkinCache::isOpen() {
+    return !s_directory.isEmpty();
+}
+
+// static
+QString SkinCache::filePath(const QString& key) {
+    const QByteArray hash = QCryptographicHash::hash(
+            key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return s_directory + "/" + QString::fromLatin1(hash) + kImageSuffix;
+}
+
+// static
+QImage SkinCache::loadImage(const QString& key) {
+    if (!isOpen()) {
+        return QImage();
+    }
+
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        Counter("SkinCache misses").increment();
+        return QImage();
+    }
+
+    ImageHeader header;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) !=
+                    sizeof(header) ||
+            memcmp(header.magic, kImageMagic, sizeof(header.magic)) != 0 ||
+            header.formatVersion != kImageFormatVersion ||
+            header.byteOrder != kImageByteOrder ||
+            header.format == QImage::Format_Invalid ||
+            header.format >= QImage::NImageFormats) {
+        qWarning() << "SkinCache: ignoring invalid file" << file.fileName();
+        Counter("SkinCache misses").increment();
+        return QImage();
+    }
+
+    QImage image(header.width, header.height,
+            static_cast<QImage::Format>(header.format));
+    const qint64 byteCount = image.byteCount();
+    if (image.isNull() ||
+            static_cast<quint32>(image.bytesPerLine()) != header.bytesPerLine ||
+            file.read(reinterpret_cast<char*>(image.bits()), byteCount) !=
+                    byteCount) {
+        qWarning() << "SkinCache: ignoring invalid file" << file.fileName();
+        Counter("SkinCache misses").increment();
+        return QImage();
+    }
+
+    Counter("SkinCache hits").increment();
+    return image;
+}
+
+// static
+void SkinCache::storeImage(const QString& key, const QImage& image) {
+    // Images with a color table are not rasterized from SVGs
+    if (!isOpen() || image.isNull() || image.colorCount() > 0) {
+        return;
+    }
+
+    ImageHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kImageMagic, sizeof(header.magic));
+    header.formatVersion = kImageFormatVersion;
+    header.byteOrder = kImageByteOrder;
+    header.width = image.width();
+    header.height = image.height();
+    header.format = image.format();
+    header.bytesPerLine = image.bytesPerLine();
+
+    // Written to a temporary file that replaces the cached file on commit(),
+    // so a crash never leaves a truncated image behind.
+    QSaveFile file(filePath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "SkinCache: could not write" << file.fileName();
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(image.constBits()),
+            image.byteCount());
+    if (!file.commit()) {
+        qWarning() << "SkinCache: could not write" << file.fileName();
+    }
+}
+
+// static
+bool SkinCache::loadImageFileNames(QStringList* pFileNames) {
+    if (!isOpen()) {
+        return false;
+    }
+
+    QFile file(s_directory + "/" + kImageFileNamesFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    if (file.readLine().trimmed() != kImageFileNamesHeader) {
+        qWarning() << "SkinCache: ignoring invalid file" << file.fileName();
+        return false;
+    }
+    pFileNames->clear();
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        if (line.endsWith('\n')) {
+            line.chop(1);
+        }
+        if (!line.isEmpty()) {
+            pFileNames->append(QString::fromUtf8(line));
+        }
+    }
+    return true;
+}
+
+// static
+void SkinCache::storeImageFileNames(const QStringList& fileNames) {
+    if (!isOpen()) {
+        return;
+    }
+
+    QSaveFile file(s_directory + "/" + kImageFileNamesFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "SkinCache: could not write" << file.fileName();
+        return;
+    }
+    file.write(kImageFileNamesHeader + "\n");
+    for (const QString& fileName : fileNames) {
+        // Image file names never contain a line break, see
+        // SkinImagePrefetcher
+        file.write(fileName.toUtf8() + "\n");
+    }
+    if (!file.commit()) {
+        qWarning() << "SkinCache: could not write" << file.fileName();
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SKINCACHE_H
+#define SKINCACHE_H
+
+#include <QImage>
+#include <QString>
+#include <QStringList>
+
+// A persistent cache of the images that are rasterized from the SVGs of the
+// skin. Rasterizing all SVGs of a skin for a 4K screen takes several seconds,
+// so the images are stored on disk on the first start and read back on the
+// following ones.
+//
+// The cache of a skin is a directory named after a fingerprint of the size
+// and modification time of every file of the skin, the color scheme, the
+// scale factor and the Mixxx version. Any change of them starts a new
+// directory and the previous directory of the skin is removed.
+class SkinCache {
+  public:
+    // Opens the cache for the skin in a subdirectory of cachePath. Returns
+    // true if it holds the images of a previous start.
+    static bool open(const QString& cachePath, const QString& skinPath,
+            const QString& colorScheme, double scaleFactor);
+    static void close();
+    static bool isOpen();
+
+    // The key identifies the source of the image and how it has been
+    // rasterized. Returns a null image if it is not cached.
+    static QImage loadImage(const QString& key);
+    static void storeImage(const QString& key, const QImage& image);
+
+    // The file names of the images that are referenced by the XML files of
+    // the skin, see SkinImagePrefetcher::findImageSources(). They are only
+    // valid as long as the skin files are unchanged, which the directory
+    // fingerprint ensures. Returns false if they are not cached.
+    static bool loadImageFileNames(QStringList* pFileNames);
+    static void storeImageFileNames(const QStringList& fileNames);
+
+  private:
+    static QString filePath(const QString& key);
+
+    static QString s_directory;
+};
+
+#endif /* SKINCACHE_H */
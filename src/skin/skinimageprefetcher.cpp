@@ -0,0 +1,189 @@
+#include "skin/skinimageprefetcher.h"
+
+#include <QDirIterator>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QPainter>
+#include <QSet>
+#include <QStringList>
+#include <QSvgRenderer>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include "skin/skincache.h"
+#include "skin/skincontext.h"
+#include "util/counter.h"
+#include "util/timer.h"
+
+namespace {
+
+struct PrefetchItem {
+    PixmapSource source;
+    double scaleFactor;
+    QSharedPointer<ImgSource> pLoader;
+    QImage image;
+};
+
+// Runs on a thread of the global thread pool. QSvgRenderer and QPainter on a
+// QImage may be used outside of the GUI thread.
+void loadItem(PrefetchItem& item) {
+    if (item.source.isSVG()) {
+        item.image = SkinImagePrefetcher::renderSvg(item.source, item.scaleFactor);
+    } else {
+        QImage* pImage = item.pLoader->getImage(
+                item.source.getPath(), item.scaleFactor);
+        if (pImage) {
+            item.image = *pImage;
+            delete pImage;
+        }
+    }
+}
+
+bool isImageFileName(const QString& text,
+        const QList<QByteArray>& supportedFormats) {
+    const int dot = text.lastIndexOf('.');
+    if (dot < 0 || text.contains('\n')) {
+        return false;
+    }
+    const QByteArray suffix = text.mid(dot + 1).toLower().toLatin1();
+    return suffix == "svg" || supportedFormats.contains(suffix);
+}
+
+void findImageFileNames(const QDomElement& element,
+        const QList<QByteArray>& supportedFormats, QSet<QString>* pFileNames) {
+    // Only elements with a plain text, the text of elements with <Variable>
+    // children is only known while the skin is parsed.
+    const QDomNode firstChild = element.firstChild();
+    if (firstChild.isText() && firstChild.nextSibling().isNull()) {
+        const QString text = firstChild.nodeValue().trimmed();
+        if (isImageFileName(text, supportedFormats)) {
+            pFileNames->insert(text);
+        }
+        return;
+    }
+    for (QDomElement child = element.firstChildElement(); !child.isNull();
+            child = child.nextSiblingElement()) {
+        // Inline SVGs are built by the SvgParser of the skin
+        if (child.tagName() != "svg") {
+            findImageFileNames(child, supportedFormats, pFileNames);
+        }
+    }
+}
+
+QStringList parseImageFileNames(const QString& skinPath) {
+    const QList<QByteArray> supportedFormats =
+            QImageReader::supportedImageFormats();
+
+    // The templates are included by file name, so all XML files of the skin
+    // are scanned instead of following the <Template> nodes.
+    QSet<QString> fileNames;
+    QDirIterator it(skinPath, QStringList("*.xml"), QDir::Files,
+            QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        QDomDocument document;
+        if (!file.open(QIODevice::ReadOnly) || !document.setContent(&file)) {
+            continue;
+        }
+        findImageFileNames(document.documentElement(), supportedFormats,
+                &fileNames);
+    }
+    return fileNames.toList();
+}
+
+} // anonymous namespace
+
+// static
+QHash<QString, QImage> SkinImagePrefetcher::s_images;
+
+// static
+QList<PixmapSource> SkinImagePrefetcher::findImageSources(
+        const QString& skinPath, const SkinContext& context) {
+    QStringList fileNames;
+    if (!SkinCache::loadImageFileNames(&fileNames)) {
+        fileNames = parseImageFileNames(skinPath);
+        SkinCache::storeImageFileNames(fileNames);
+    }
+
+    QList<PixmapSource> sources;
+    for (const QString& fileName : fileNames) {
+        PixmapSource source = context.getPixmapSource(fileName);
+        // Skips texts that only look like a file name
+        if (!source.isEmpty() && QFileInfo(source.getPath()).isFile()) {
+            sources.append(source);
+        }
+    }
+    return sources;
+}
+
+// static
+void SkinImagePrefetcher::prefetch(const QList<PixmapSource>& sources,
+        double scaleFactor, const QSharedPointer<ImgSource>& pLoader) {
+    ScopedTimer timer("SkinImagePrefetcher::prefetch");
+
+    QVector<PrefetchItem> items;
+    items.reserve(sources.size());
+    for (const PixmapSource& source : sources) {
+        if (!s_images.contains(imageKey(source, scaleFactor))) {
+            items.append(PrefetchItem{source, scaleFactor, pLoader, QImage()});
+        }
+    }
+
+    QtConcurrent::blockingMap(items, loadItem);
+
+    for (const PrefetchItem& item : items) {
+        if (!item.image.isNull()) {
+            s_images.insert(imageKey(item.source, scaleFactor), item.image);
+        }
+    }
+    Counter("SkinImagePrefetcher images").increment(items.size());
+}
+
+// static
+void SkinImagePrefetcher::clear() {
+    s_images.clear();
+}
+
+// static
+QImage SkinImagePrefetcher::getImage(const PixmapSource& source,
+        double scaleFactor) {
+    if (source.isEmpty() || s_images.isEmpty()) {
+        return QImage();
+    }
+    return s_images.value(imageKey(source, scaleFactor));
+}
+
+// static
+QImage SkinImagePrefetcher::renderSvg(const PixmapSource& source,
+        double scaleFactor) {
+    QSvgRenderer renderer;
+    if (!source.getSvgSourceData().isEmpty()) {
+        // Call here the different overload for svg content
+        if (!renderer.load(source.getSvgSourceData())) {
+            // The above line already logs a warning
+            return QImage();
+        }
+    } else if (!source.getPath().isEmpty()) {
+        if (!renderer.load(source.getPath())) {
+            // The above line already logs a warning
+            return QImage();
+        }
+    } else {
+        return QImage();
+    }
+
+    QImage image(renderer.defaultSize() * scaleFactor, QImage::Format_ARGB32);
+    image.fill(0x00000000);  // Transparent black.
+    QPainter painter(&image);
+    renderer.render(&painter);
+    painter.end();
+    return image;
+}
+
+// static
+QString SkinImagePrefetcher::imageKey(const PixmapSource& source,
+        double scaleFactor) {
+    return source.getId() + ":" + QString::number(scaleFactor);
+}
@@ -0,0 +1,50 @@
+#ifndef SKINIMAGEPREFETCHER_H
+#define SKINIMAGEPREFETCHER_H
+
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+#include "skin/imgsource.h"
+#include "skin/pixmapsource.h"
+
+class SkinContext;
+
+// Rasterizes the SVGs and decodes the bitmaps of a skin concurrently before
+// its widgets are created. The images are independent of each other, so a
+// skin with hundreds of them loads in a fraction of the time it takes to
+// render them one by one on the GUI thread.
+//
+// WImageStore, WPixmapStore and Paintable take the prefetched images instead
+// of loading them. Sources that are not prefetched, like inline SVGs or paths
+// built from skin variables, are still loaded when the widget is created.
+class SkinImagePrefetcher {
+  public:
+    // Returns the image files referenced by the XML files of the skin. The
+    // file names are stored in the SkinCache if it is open, so the XML files
+    // are only parsed again after the skin has been changed.
+    static QList<PixmapSource> findImageSources(const QString& skinPath,
+            const SkinContext& context);
+
+    // Loads the sources on the global thread pool and blocks until all of
+    // them are ready. The SVGs are rendered without color correction, the
+    // bitmaps are loaded with pLoader.
+    static void prefetch(const QList<PixmapSource>& sources,
+            double scaleFactor, const QSharedPointer<ImgSource>& pLoader);
+    static void clear();
+
+    // Returns a null image if the source has not been prefetched.
+    static QImage getImage(const PixmapSource& source, double scaleFactor);
+
+    // Renders the SVG at its default size multiplied by scaleFactor.
+    static QImage renderSvg(const PixmapSource& source, double scaleFactor);
+
+  private:
+    static QString imageKey(const PixmapSource& source, double scaleFactor);
+
+    static QHash<QString, QImage> s_images;
+};
+
+#endif /* SKINIMAGEPREFETCHER_H */
@@ -0,0 +1,231 @@
+#include "sources/mp3seekindexcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include <cstring>
+#include <limits>
+
+#include "util/logger.h"
+
+namespace mixxx {
+
+namespace {
+
+const Logger kLogger("Mp3SeekIndexCache");
+
+// The header of a cached index, followed by the distances of the seek
+// frames in sample frames (quint16) and in bytes (quint32), each from the
+// previous seek frame. The distances of the first seek frame are from the
+// start of the stream and of the file.
+struct IndexHeader {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 byteOrder;
+    // Of the MP3 file
+    qint64 fileSize;
+    qint64 fileModified;
+    quint32 sampleRate;
+    quint32 channelCount;
+    quint32 bitrate;
+    quint32 seekFrameCount;
+    qint64 frameLength;
+};
+
+static_assert(sizeof(IndexHeader) == 56,
+        "The cached index header must have a fixed size");
+
+const char kIndexMagic[8] = {'M', 'X', 'X', 'M', 'P', '3', 'S', 'I'};
+// Increment when changing the layout. Files in other versions are treated
+// as missing and are replaced.
+const quint32 kIndexFormatVersion = 1;
+const quint32 kIndexByteOrder = 0x01020304;
+
+// Guards s_cachePath
+QMutex s_mutex;
+QString s_cachePath;
+
+qint64 fileModifiedMillis(const QFileInfo& fileInfo) {
+    return fileInfo.lastModified().toMSecsSinceEpoch();
+}
+
+} // anonymous namespace
+
+// static
+void Mp3SeekIndexCache::setCachePath(const QString& cachePath) {
+    QMutexLocker locker(&s_mutex);
+    s_cachePath = cachePath;
+}
+
+// static
+QString Mp3SeekIndexCache::cachePath() {
+    QMutexLocker locker(&s_mutex);
+    return s_cachePath;
+}
+
+// static
+QString Mp3SeekIndexCache::filePath(const QString& cachePath,
+        const QString& fileName) {
+    const QByteArray hash = QCryptographicHash::hash(
+            QFileInfo(fileName).absoluteFilePath().toUtf8(),
+            QCryptographicHash::Sha1);
+    return QDir(cachePath).filePath(
+            QString::fromLatin1(hash.toHex()) + ".mp3index");
+}
+
+// static
+bool Mp3SeekIndexCache::load(const QString& fileName, Mp3SeekIndex* pIndex) {
+    const QString path = cachePath();
+    if (path.isEmpty()) {
+        return false;
+    }
+    QFile file(filePath(path, fileName));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    IndexHeader header;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) !=
+            static_cast<qint64>(sizeof(header)) ||
+            memcmp(header.magic, kIndexMagic, sizeof(header.magic)) != 0 ||
+            header.formatVersion != kIndexFormatVersion ||
+            header.byteOrder != kIndexByteOrder) {
+        kLogger.warning() << "Ignoring invalid file" << file.fileName();
+        return false;
+    }
+
+    const QFileInfo fileInfo(fileName);
+    if (header.fileSize != fileInfo.size() ||
+            header.fileModified != fileModifiedMillis(fileInfo)) {
+        // The MP3 file has been changed
+        return false;
+    }
+
+    const SINT count = header.seekFrameCount;
+    const qint64 frameDistancesSize = count * sizeof(quint16);
+    const qint64 byteDistancesSize = count * sizeof(quint32);
+    if (count == 0 ||
+            file.size() != static_cast<qint64>(sizeof(header)) +
+                    frameDistancesSize + byteDistancesSize) {
+        kLogger.warning() << "Ignoring invalid file" << file.fileName();
+        return false;
+    }
+    std::vector<quint16> frameDistances(count);
+    std::vector<quint32> byteDistances(count);
+    if (file.read(reinterpret_cast<char*>(frameDistances.data()),
+                    frameDistancesSize) != frameDistancesSize ||
+            file.read(reinterpret_cast<char*>(byteDistances.data()),
+                    byteDistancesSize) != byteDistancesSize ||
+            header.sampleRate == 0 ||
+            header.channelCount == 0 || header.channelCount > 2) {
+        kLogger.warning() << "Ignoring invalid file" << file.fileName();
+        return false;
+    }
+
+    pIndex->sampleRate = header.sampleRate;
+    pIndex->channelCount = header.channelCount;
+    pIndex->bitrate = header.bitrate;
+    pIndex->frameLength = header.frameLength;
+    pIndex->seekFrames.resize(count);
+    SINT frameIndex = 0;
+    SINT byteOffset = 0;
+    for (SINT i = 0; i < count; ++i) {
+        // Only the first seek frame starts with the stream
+        if ((i == 0) != (frameDistances[i] == 0) ||
+                (i > 0 && byteDistances[i] == 0)) {
+            kLogger.warning() << "Ignoring invalid file" << file.fileName();
+            return false;
+        }
+        frameIndex += frameDistances[i];
+        byteOffset += byteDistances[i];
+        pIndex->seekFrames[i].frameIndex = frameIndex;
+        pIndex->seekFrames[i].byteOffset = byteOffset;
+    }
+    if (frameIndex >= pIndex->frameLength || byteOffset >= header.fileSize) {
+        kLogger.warning() << "Ignoring invalid file" << file.fileName();
+        return false;
+    }
+    return true;
+}
+
+// static
+void Mp3SeekIndexCache::store(const QString& fileName,
+        const Mp3SeekIndex& index) {
+    const QString path = cachePath();
+    if (path.isEmpty() || index.seekFrames.empty()) {
+        return;
+    }
+
+    const SINT count = index.seekFrames.size();
+    std::vector<quint16> frameDistances(count);
+    std::vector<quint32> byteDistances(count);
+    SINT frameIndex = 0;
+    SINT byteOffset = 0;
+    for (SINT i = 0; i < count; ++i) {
+        const SINT frameDistance = index.seekFrames[i].frameIndex - frameIndex;
+        const SINT byteDistance = index.seekFrames[i].byteOffset - byteOffset;
+        if (frameDistance < 0 ||
+                frameDistance > std::numeric_limits<quint16>::max() ||
+                byteDistance < 0 ||
+                static_cast<qint64>(byteDistance) >
+                        static_cast<qint64>(std::numeric_limits<quint32>::max())) {
+            // Doesn't fit, the file is scanned on every open
+            kLogger.debug() << "Not caching the index of" << fileName;
+            return;
+        }
+        frameDistances[i] = frameDistance;
+        byteDistances[i] = byteDistance;
+        frameIndex = index.seekFrames[i].frameIndex;
+        byteOffset = index.seekFrames[i].byteOffset;
+    }
+
+    const QFileInfo fileInfo(fileName);
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kIndexMagic, sizeof(header.magic));
+    header.formatVersion = kIndexFormatVersion;
+    header.byteOrder = kIndexByteOrder;
+    header.fileSize = fileInfo.size();
+    header.fileModified = fileModifiedMillis(fileInfo);
+    header.sampleRate = index.sampleRate;
+    header.channelCount = index.channelCount;
+    header.bitrate = index.bitrate;
+    header.seekFrameCount = count;
+    header.frameLength = index.frameLength;
+
+    if (!QDir().mkpath(path)) {
+        kLogger.warning() << "Could not create directory" << path;
+        return;
+    }
+    // Written to a temporary file that replaces the cached file on commit(),
+    // so other threads that open the same file never read a partial index.
+    QSaveFile file(filePath(path, fileName));
+    if (!file.open(QIODevice::WriteOnly)) {
+        kLogger.warning() << "Could not write" << file.fileName();
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(frameDistances.data()),
+            count * sizeof(quint16));
+    file.write(reinterpret_cast<const char*>(byteDistances.data()),
+            count * sizeof(quint32));
+    if (!file.commit()) {
+        kLogger.warning() << "Could not write" << file.fileName();
+    }
+}
+
+// static
+void Mp3SeekIndexCache::remove(const QString& fileName) {
+    const QString path = cachePath();
+    if (!path.isEmpty()) {
+        QFile::remove(filePath(path, fileName));
+    }
+}
+
+} // namespace mixxx
@@ -0,0 +1,68 @@
+#ifndef MIXXX_MP3SEEKINDEXCACHE_H
+#define MIXXX_MP3SEEKINDEXCACHE_H
+
+#include <QString>
+
+#include <vector>
+
+#include "util/types.h"
+
+namespace mixxx {
+
+// The result of scanning the frame headers of an MP3 file, which is needed
+// before the file can be decoded with precise seeking.
+struct Mp3SeekIndex {
+    struct SeekFrame {
+        // The index of the first sample frame decoded from the MP3 frame
+        SINT frameIndex;
+        // The position of the MP3 frame in the file
+        SINT byteOffset;
+    };
+
+    Mp3SeekIndex()
+        : sampleRate(0),
+          channelCount(0),
+          bitrate(0),
+          frameLength(0) {
+    }
+
+    SINT sampleRate;
+    SINT channelCount;
+    // The average in kbit/s
+    SINT bitrate;
+    // The number of sample frames of the whole stream
+    SINT frameLength;
+    // Ordered by frameIndex and byteOffset
+    std::vector<SeekFrame> seekFrames;
+};
+
+// A persistent cache of the seek indexes of MP3 files, so opening a file
+// doesn't need to read the whole file again. Scanning the headers of a long
+// mix on a slow disk takes seconds, and every deck load and every analysis
+// of the file would do it again.
+//
+// The index of a file is stored in a file in the cache directory that is
+// named after the path of the MP3 file. It holds the size and modification
+// time of the MP3 file it was built from, the audio properties and the
+// lengths and sizes of the MP3 frames, 6 bytes per frame. Indexes of files
+// that have been changed are ignored and replaced. The seek frames are only
+// checked for being ordered and in bounds here, SoundSourceMp3 checks the
+// frame headers when seeking and calls remove() if they don't match.
+class Mp3SeekIndexCache {
+  public:
+    // Thread-safe. Caching is disabled until the cache directory is set.
+    static void setCachePath(const QString& cachePath);
+    static QString cachePath();
+
+    // Returns false if there is no valid index of the file in its current
+    // state.
+    static bool load(const QString& fileName, Mp3SeekIndex* pIndex);
+    static void store(const QString& fileName, const Mp3SeekIndex& index);
+    static void remove(const QString& fileName);
+
+    static QString filePath(const QString& cachePath, const QString& fileName);
+};
+
+} // namespace mixxx
+
+#endif // MIXXX_MP3SEEKINDEXCACHE_H
@@ -1,5 +1,6 @@
 #include "sources/soundsourcemp3.h"
 #include "sources/mp3decoding.h"
+#include "sources/mp3seekindexcache.h"
 
 #include "util/math.h"
 #include "util/logger.h"
@@ -157,6 +158,25 @@ bool decodeFrameHeader(
     return true;
 }
 
+// Whether an MP3 frame with the sample rate starts at pFrame
+bool isFrameHeaderAt(
+        const unsigned char* pFrame,
+        const unsigned char* pEnd,
+        unsigned int sampleRate) {
+    mad_stream madStream;
+    mad_stream_init(&madStream);
+    mad_stream_options(&madStream, MAD_OPTION_IGNORECRC);
+    mad_stream_buffer(&madStream, pFrame, pEnd - pFrame);
+    mad_header madHeader;
+    mad_header_init(&madHeader);
+    const bool result = (0 == mad_header_decode(&madHeader, &madStream)) &&
+            (pFrame == madStream.this_frame) &&
+            (sampleRate == madHeader.samplerate);
+    mad_header_finish(&madHeader);
+    mad_stream_finish(&madStream);
+    return result;
+}
+
 } // anonymous namespace
 
 SoundSourceMp3::SoundSourceMp3(const QUrl& url)
@@ -165,6 +185,7 @@ SoundSourceMp3::SoundSourceMp3(const QUrl& url)
           m_fileSize(0),
           m_pFileData(nullptr),
           m_avgSeekFrameCount(0),
+          m_seekFramesCached(false),
           m_curFrameIndex(0),
           m_madSynthCount(0),
           m_leftoverBuffer(kMaxBytesPerMp3Frame + MAD_BUFFER_GUARD) {
@@ -220,6 +241,30 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     DEBUG_ASSERT(m_seekFrameList.empty());
     m_avgSeekFrameCount = 0;
     m_curFrameIndex = 0;
+    if (!restoreSeekFrames()) {
+        const OpenResult scanResult = scanSeekFrames();
+        if (scanResult != OpenResult::Succeeded) {
+            return scanResult;
+        }
+    }
+
+    // Restart decoding at the beginning of the audio stream
+    restartDecoding(m_seekFrameList.front());
+
+    if (m_curFrameIndex != frameIndexMin()) {
+        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
+        // Abort
+        return OpenResult::Failed;
+    }
+
+    if (!m_seekFramesCached) {
+        storeSeekFrames();
+    }
+
+    return OpenResult::Succeeded;
+}
+
+SoundSource::OpenResult SoundSourceMp3::scanSeekFrames() {
     int headerPerSampleRate[kSampleRateCount];
     for (int i = 0; i < kSampleRateCount; ++i) {
         headerPerSampleRate[i] = 0;
@@ -362,16 +407,64 @@ SoundSource::OpenResult SoundSourceMp3::tryOpen(
     addSeekFrame(m_curFrameIndex, 0);
     DEBUG_ASSERT(m_seekFrameList.back().frameIndex == frameIndexMax());
 
-    // Restart decoding at the beginning of the audio stream
-    restartDecoding(m_seekFrameList.front());
+    return OpenResult::Succeeded;
+}
 
-    if (m_curFrameIndex != frameIndexMin()) {
-        kLogger.warning() << "Failed to start decoding:" << m_file.fileName();
-        // Abort
-        return OpenResult::Failed;
+bool SoundSourceMp3::restoreSeekFrames() {
+    Mp3SeekIndex seekIndex;
+    if (!m_pFileData ||
+            !Mp3SeekIndexCache::load(m_file.fileName(), &seekIndex)) {
+        return false;
+    }
+    // Only a few frame headers are checked here, the others are checked
+    // by restartDecoding() when seeking to them.
+    const unsigned char* pFileEnd = m_pFileData + m_fileSize;
+    const SINT seekFrameCount = seekIndex.seekFrames.size();
+    for (SINT i : {SINT(0), seekFrameCount / 2, seekFrameCount - 1}) {
+        if (!isFrameHeaderAt(
+                m_pFileData + seekIndex.seekFrames[i].byteOffset, pFileEnd,
+                seekIndex.sampleRate)) {
+            kLogger.warning() << "Ignoring cached seek frames that don't match:"
+                    << m_file.fileName();
+            Mp3SeekIndexCache::remove(m_file.fileName());
+            return false;
+        }
     }
 
-    return OpenResult::Succeeded;
+    for (const auto& seekFrame : seekIndex.seekFrames) {
+        addSeekFrame(seekFrame.frameIndex,
+                m_pFileData + seekFrame.byteOffset);
+    }
+    setSampleRate(SampleRate(seekIndex.sampleRate));
+    setChannelCount(ChannelCount(seekIndex.channelCount));
+    initFrameIndexRangeOnce(IndexRange::forward(0, seekIndex.frameLength));
+    m_avgSeekFrameCount = frameLength() / m_seekFrameList.size();
+    initBitrateOnce(seekIndex.bitrate);
+    m_curFrameIndex = frameIndexMax();
+
+    // Terminate m_seekFrameList
+    addSeekFrame(m_curFrameIndex, 0);
+    DEBUG_ASSERT(m_seekFrameList.back().frameIndex == frameIndexMax());
+    m_seekFramesCached = true;
+    return true;
+}
+
+void SoundSourceMp3::storeSeekFrames() const {
+    Mp3SeekIndex seekIndex;
+    seekIndex.sampleRate = sampleRate();
+    seekIndex.channelCount = channelCount();
+    seekIndex.bitrate = bitrate();
+    seekIndex.frameLength = frameLength();
+    // Without the terminating seek frame
+    seekIndex.seekFrames.reserve(m_seekFrameList.size() - 1);
+    for (auto it = m_seekFrameList.begin();
+            it + 1 != m_seekFrameList.end(); ++it) {
+        Mp3SeekIndex::SeekFrame seekFrame;
+        seekFrame.frameIndex = it->frameIndex;
+        seekFrame.byteOffset = it->pInputData - m_pFileData;
+        seekIndex.seekFrames.push_back(seekFrame);
+    }
+    Mp3SeekIndexCache::store(m_file.fileName(), seekIndex);
 }
 
 void SoundSourceMp3::close() {
@@ -385,6 +478,7 @@ void SoundSourceMp3::close() {
     m_file.close();
 
     m_seekFrameList.clear();
+    m_seekFramesCached = false;
 
     // Re-init the decoder, because the SoundSource might be reopened and
     // the destructor calls finishDecoding() after close().
@@ -429,6 +523,14 @@ void SoundSourceMp3::restartDecoding(
             && isStreamValid(m_madStream)) {
         m_curFrameIndex = seekFrame.frameIndex;
     } else {
+        if (m_seekFramesCached) {
+            // The file has been modified without changing its size and
+            // modification time. It is scanned again on the next open.
+            kLogger.warning() << "Removing cached seek frames that don't match:"
+                    << m_file.fileName();
+            Mp3SeekIndexCache::remove(m_file.fileName());
+            m_seekFramesCached = false;
+        }
         // Failure -> Seek to EOF
         m_curFrameIndex = frameIndexMax();
     }
@@ -33,6 +33,14 @@ class SoundSourceMp3: public SoundSource {
             OpenMode mode,
             const OpenParams& params) override;
 
+    // Decodes all the frame headers to build m_seekFrameList and to
+    // calculate the audio properties.
+    OpenResult scanSeekFrames();
+    // Instead of scanning, see Mp3SeekIndexCache. Returns false if there
+    // is no valid cached index of the file.
+    bool restoreSeekFrames();
+    void storeSeekFrames() const;
+
     QFile m_file;
     quint64 m_fileSize;
     unsigned char* m_pFileData;
@@ -51,6 +59,8 @@ class SoundSourceMp3: public SoundSource {
     typedef std::vector<SeekFrameType> SeekFrameList;
     SeekFrameList m_seekFrameList; // ordered-by frameIndex
     SINT m_avgSeekFrameCount; // avg. sample frames per MP3 frame
+    // Whether m_seekFrameList has been restored from the cache
+    bool m_seekFramesCached;
 
     void addSeekFrame(SINT frameIndex, const unsigned char* pInputData);
 
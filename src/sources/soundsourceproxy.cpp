@@ -212,6 +212,38 @@ TrackPointer SoundSourceProxy::importTemporaryTrack(
     return pTrack;
 }
 
+//static
+TrackPointer SoundSourceProxy::importTemporaryTrackOfNewFile(
+        QFileInfo fileInfo,
+        SecurityTokenPointer pSecurityToken) {
+    const TrackRef trackRef = TrackRef::fromFileInfo(fileInfo);
+    if (GlobalTrackCacheLocker().lookupTrackByRef(trackRef)) {
+        return TrackPointer();
+    }
+    TrackPointer pTrack = Track::newTemporary(std::move(fileInfo), std::move(pSecurityToken));
+    SoundSourceProxy(pTrack).updateTrackFromSource();
+    // The track might have been loaded and added to the library while
+    // reading, then the tags that have been read are not reliable.
+    if (GlobalTrackCacheLocker().lookupTrackByRef(trackRef)) {
+        return TrackPointer();
+    }
+    return pTrack;
+}
+
+//static
+TrackPointer SoundSourceProxy::importTemporaryTrackUnlessCached(
+        QFileInfo fileInfo,
+        SecurityTokenPointer pSecurityToken) {
+    // Locked while reading like in importTemporaryTrack()
+    GlobalTrackCacheLocker locker;
+    if (locker.lookupTrackByRef(TrackRef::fromFileInfo(fileInfo))) {
+        return TrackPointer();
+    }
+    TrackPointer pTrack = Track::newTemporary(std::move(fileInfo), std::move(pSecurityToken));
+    SoundSourceProxy(pTrack).updateTrackFromSource();
+    return pTrack;
+}
+
 //static
 QImage SoundSourceProxy::importTemporaryCoverImage(
         QFileInfo fileInfo,
@@ -391,13 +423,7 @@ void SoundSourceProxy::updateTrackFromSource(
     QImage coverImg;
     DEBUG_ASSERT(coverImg.isNull());
     QImage* pCoverImg; // pointer is also used as a flag
-    const CoverInfoRelative coverInfoOld = m_pTrack->getCoverInfo();
-    // Only re-import cover art if it is save to update, e.g. never
-    // discard a users's custom choice! We are using a whitelisting
-    // filter here that explicitly checks all valid preconditions
-    // when it is permissible to update/replace existing cover art.
-    if (((coverInfoOld.source == CoverInfo::UNKNOWN) || (coverInfoOld.source == CoverInfo::GUESSED)) &&
-            ((coverInfoOld.type == CoverInfo::NONE) || (coverInfoOld.type == CoverInfo::METADATA))) {
+    if (canReplaceCoverInfo(m_pTrack->getCoverInfo())) {
         // Should import and update embedded cover art
         pCoverImg = &coverImg;
     } else {
@@ -494,6 +520,51 @@ void SoundSourceProxy::updateTrackFromSource(
     }
 }
 
+//static
+void SoundSourceProxy::updateTrackFromImportedTrack(
+        Track* pTrack,
+        const Track& importedTrack,
+        ImportTrackMetadataMode importTrackMetadataMode) {
+    DEBUG_ASSERT(pTrack);
+    // The type is only set if there has been a SoundSource for the file,
+    // otherwise nothing has been imported
+    const QString type = importedTrack.getType();
+    if (type.isEmpty()) {
+        return; // abort
+    }
+    pTrack->setType(type);
+
+    mixxx::TrackMetadata trackMetadata;
+    bool metadataSynchronized = false;
+    pTrack->getTrackMetadata(&trackMetadata, &metadataSynchronized);
+    if (metadataSynchronized &&
+        (importTrackMetadataMode == ImportTrackMetadataMode::Once)) {
+        return; // abort
+    }
+    bool importedMetadataSynchronized = false;
+    importedTrack.getTrackMetadata(&trackMetadata, &importedMetadataSynchronized);
+    if (metadataSynchronized && !importedMetadataSynchronized) {
+        // Preserve the existing data, see updateTrackFromSource()
+        return; // abort
+    }
+    pTrack->setTrackMetadata(trackMetadata,
+            importedMetadataSynchronized ? QDateTime::currentDateTimeUtc() : QDateTime());
+
+    if (canReplaceCoverInfo(pTrack->getCoverInfo())) {
+        pTrack->setCoverInfo(importedTrack.getCoverInfo());
+    }
+}
+
+//static
+bool SoundSourceProxy::canReplaceCoverInfo(const CoverInfoRelative& coverInfo) {
+    // Only re-import cover art if it is save to update, e.g. never
+    // discard a users's custom choice! We are using a whitelisting
+    // filter here that explicitly checks all valid preconditions
+    // when it is permissible to update/replace existing cover art.
+    return ((coverInfo.source == CoverInfo::UNKNOWN) || (coverInfo.source == CoverInfo::GUESSED)) &&
+            ((coverInfo.type == CoverInfo::NONE) || (coverInfo.type == CoverInfo::METADATA));
+}
+
 mixxx::MetadataSource::ImportResult SoundSourceProxy::importTrackMetadata(mixxx::TrackMetadata* pTrackMetadata) const {
     if (m_pSoundSource) {
         return m_pSoundSource->importTrackMetadataAndCoverImage(pTrackMetadata, nullptr).first;
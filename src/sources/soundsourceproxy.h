@@ -39,6 +39,22 @@ class SoundSourceProxy {
             QFileInfo fileInfo,
             SecurityTokenPointer pSecurityToken = SecurityTokenPointer());
 
+    // Like importTemporaryTrack(), but without locking the track cache while
+    // reading so that multiple threads may read files at the same time. Only
+    // for files that are not in the library yet, because Mixxx never writes
+    // the tags of those. Returns a null pointer if the track is cached before
+    // or after reading, because then it might have been added to the library
+    // and its tags might be written concurrently.
+    static TrackPointer importTemporaryTrackOfNewFile(
+            QFileInfo fileInfo,
+            SecurityTokenPointer pSecurityToken = SecurityTokenPointer());
+    // Like importTemporaryTrack(), but returns a null pointer without
+    // reading the file if the track is currently cached. The metadata of a
+    // loaded track must not be replaced behind its back.
+    static TrackPointer importTemporaryTrackUnlessCached(
+            QFileInfo fileInfo,
+            SecurityTokenPointer pSecurityToken = SecurityTokenPointer());
+
     explicit SoundSourceProxy(
             TrackPointer pTrack);
 
@@ -91,6 +107,15 @@ class SoundSourceProxy {
     void updateTrackFromSource(
             ImportTrackMetadataMode importTrackMetadataMode = ImportTrackMetadataMode::Default) const;
 
+    // Updates the track object like updateTrackFromSource() with what has
+    // already been imported into a temporary track by one of the import
+    // functions above, e.g. in another thread. The metadata is marked as
+    // synchronized at the time when it is taken over.
+    static void updateTrackFromImportedTrack(
+            Track* pTrack,
+            const Track& importedTrack,
+            ImportTrackMetadataMode importTrackMetadataMode = ImportTrackMetadataMode::Default);
+
     // Parse only the metadata from the file without modifying
     // the referenced track.
     mixxx::MetadataSource::ImportResult importTrackMetadata(mixxx::TrackMetadata* pTrackMetadata) const;
@@ -116,6 +141,11 @@ class SoundSourceProxy {
     explicit SoundSourceProxy(
             const QUrl& url);
 
+    // Whether cover art that has been imported from the file may replace
+    // the current cover art of a track. A custom choice of the user is
+    // never discarded.
+    static bool canReplaceCoverInfo(const CoverInfoRelative& coverInfo);
+
     // Parse only the cover image from the file without modifying
     // the referenced track.
     QImage importCoverImage() const;
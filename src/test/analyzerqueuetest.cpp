@@ -0,0 +1,439 @@
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QTest>
+
+#include <vector>
+
+#include "analyzer/analyzer.h"
+#include "analyzer/analyzerqueue.h"
+#include "analyzer/analyzerstoragewriter.h"
+#include "analyzer/analyzerworker.h"
+#include "library/dao/analysisdao.h"
+#include "mixer/playerinfo.h"
+#include "test/librarytest.h"
+#include "test/mixxxtest.h"
+#include "track/track.h"
+#include "util/memory.h"
+#include "waveform/waveform.h"
+
+namespace {
+
+const QString kTrackLocation(
+        QDir::current().absoluteFilePath("src/test/sine-30.wav"));
+
+// Waiting for the analyzer threads fails the test after this time
+const qint64 kTimeoutMillis = 30000;
+
+// Delivers the queued signals of the analyzer threads until the
+// condition is met
+template<typename Condition>
+bool processEventsUntil(Condition condition) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition()) {
+        if (timer.hasExpired(kTimeoutMillis)) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        QTest::qSleep(1); // millis
+    }
+    return true;
+}
+
+// What the analyzers of the test have seen. Shared by all analyzers of
+// all workers.
+class AnalysisRecorder {
+  public:
+    struct TrackAnalysis {
+        TrackAnalysis()
+                : totalSamples(0),
+                  processedSamples(0),
+                  checksum(0.0),
+                  finalized(false) {
+        }
+        int totalSamples;
+        int processedSamples;
+        double checksum;
+        // The buffers of the processed blocks in order
+        std::vector<const CSAMPLE*> blocks;
+        bool finalized;
+    };
+
+    void initialized(TrackPointer pTrack) {
+        QMutexLocker locked(&m_mutex);
+        m_initializedTracks.append(pTrack);
+    }
+
+    void finished(int analyzer, TrackPointer pTrack,
+            const TrackAnalysis& analysis) {
+        QMutexLocker locked(&m_mutex);
+        m_analyses[pTrack.get()][analyzer] = analysis;
+    }
+
+    QList<TrackPointer> initializedTracks() const {
+        QMutexLocker locked(&m_mutex);
+        return m_initializedTracks;
+    }
+
+    QMap<int, TrackAnalysis> analyses(const TrackPointer& pTrack) const {
+        QMutexLocker locked(&m_mutex);
+        return m_analyses.value(pTrack.get());
+    }
+
+  private:
+    mutable QMutex m_mutex;
+    QList<TrackPointer> m_initializedTracks;
+    QMap<Track*, QMap<int, TrackAnalysis>> m_analyses;
+};
+
+class RecordingAnalyzer : public Analyzer {
+  public:
+    RecordingAnalyzer(AnalysisRecorder* pRecorder, int id,
+            unsigned long sleepMillisPerBlock = 0)
+            : m_pRecorder(pRecorder),
+              m_id(id),
+              m_sleepMillisPerBlock(sleepMillisPerBlock) {
+    }
+
+    bool initialize(TrackPointer tio, int sampleRate, int totalSamples) override {
+        Q_UNUSED(sampleRate);
+        m_analysis = AnalysisRecorder::TrackAnalysis();
+        m_analysis.totalSamples = totalSamples;
+        m_pRecorder->initialized(tio);
+        return true;
+    }
+
+    bool isDisabledOrLoadStoredSuccess(TrackPointer tio) const override {
+        Q_UNUSED(tio);
+        return false;
+    }
+
+    void process(const CSAMPLE* pIn, const int iLen) override {
+        m_analysis.processedSamples += iLen;
+        for (int i = 0; i < iLen; ++i) {
+            m_analysis.checksum += pIn[i];
+        }
+        m_analysis.blocks.push_back(pIn);
+        if (m_sleepMillisPerBlock > 0) {
+            QTest::qSleep(m_sleepMillisPerBlock);
+        }
+    }
+
+    void cleanup(TrackPointer tio) override {
+        Q_UNUSED(tio);
+    }
+
+    void finalize(TrackPointer tio) override {
+        m_analysis.finalized = true;
+        m_pRecorder->finished(m_id, tio, m_analysis);
+    }
+
+  private:
+    AnalysisRecorder* const m_pRecorder;
+    const int m_id;
+    const unsigned long m_sleepMillisPerBlock;
+    AnalysisRecorder::TrackAnalysis m_analysis;
+};
+
+// Pretends that the analyses of some tracks have already been stored
+class StoredAnalysisLoader : public Analyzer {
+  public:
+    explicit StoredAnalysisLoader(const QSet<Track*>& analysedTracks)
+            : m_analysedTracks(analysedTracks) {
+    }
+
+    bool initialize(TrackPointer tio, int sampleRate, int totalSamples) override {
+        Q_UNUSED(tio);
+        Q_UNUSED(sampleRate);
+        Q_UNUSED(totalSamples);
+        ADD_FAILURE() << "The loader must not analyze any track";
+        return false;
+    }
+
+    bool isDisabledOrLoadStoredSuccess(TrackPointer tio) const override {
+        return m_analysedTracks.contains(tio.get());
+    }
+
+    void process(const CSAMPLE* pIn, const int iLen) override {
+        Q_UNUSED(pIn);
+        Q_UNUSED(iLen);
+    }
+
+    void cleanup(TrackPointer tio) override {
+        Q_UNUSED(tio);
+    }
+
+    void finalize(TrackPointer tio) override {
+        Q_UNUSED(tio);
+    }
+
+  private:
+    const QSet<Track*> m_analysedTracks;
+};
+
+class TestAnalyzerWorker : public AnalyzerWorker {
+  public:
+    explicit TestAnalyzerWorker(AnalyzerQueue* pQueue)
+            : AnalyzerWorker(pQueue) {
+    }
+
+    using AnalyzerWorker::addAnalyzer;
+};
+
+class TestAnalyzerQueue : public AnalyzerQueue {
+  public:
+    void addWorker(AnalysisRecorder* pRecorder, int analyzerCount,
+            unsigned long sleepMillisPerBlock = 0) {
+        auto pWorker = std::make_unique<TestAnalyzerWorker>(this);
+        for (int i = 0; i < analyzerCount; ++i) {
+            pWorker->addAnalyzer(
+                    std::make_unique<RecordingAnalyzer>(
+                            pRecorder, i, sleepMillisPerBlock),
+                    QString("Recording %1").arg(i));
+        }
+        AnalyzerQueue::addWorker(std::move(pWorker));
+    }
+
+    using AnalyzerQueue::addStoredAnalysisLoader;
+};
+
+class AnalyzerQueueTest : public MixxxTest {
+  protected:
+    AnalyzerQueueTest()
+            : m_finishedCount(0) {
+    }
+
+    void TearDown() override {
+        PlayerInfo::instance().setTrackInfo("[Channel1]", TrackPointer());
+    }
+
+    // Creates the queue after the recorder, so that the analyzer
+    // threads have stopped before the recorder is destroyed.
+    TestAnalyzerQueue* createQueue() {
+        m_pQueue = std::make_unique<TestAnalyzerQueue>();
+        QObject::connect(m_pQueue.get(), &AnalyzerQueue::trackProgress,
+                [this](int progress) {
+                    m_progress.append(progress);
+                });
+        QObject::connect(m_pQueue.get(), &AnalyzerQueue::trackFinished,
+                [this](int size) {
+                    ++m_finishedCount;
+                    m_finishedSizes.append(size);
+                    // Marks the start of the progress of the next track
+                    m_progress.append(-1);
+                });
+        return m_pQueue.get();
+    }
+
+    static QList<TrackPointer> newTracks(int count) {
+        QList<TrackPointer> tracks;
+        for (int i = 0; i < count; ++i) {
+            tracks.append(Track::newTemporary(kTrackLocation));
+        }
+        return tracks;
+    }
+
+    static bool isAnalysed(const TrackPointer& pTrack) {
+        return pTrack->getAnalyzerProgress() == 1000;
+    }
+
+    AnalysisRecorder m_recorder;
+    std::unique_ptr<TestAnalyzerQueue> m_pQueue;
+    QList<int> m_progress;
+    QList<int> m_finishedSizes;
+    int m_finishedCount;
+};
+
+TEST_F(AnalyzerQueueTest, DecodeOnceForAllAnalyzers) {
+    const int kAnalyzerCount = 3;
+    TestAnalyzerQueue* pQueue = createQueue();
+    pQueue->addWorker(&m_recorder, kAnalyzerCount);
+    pQueue->start();
+
+    const TrackPointer pTrack = Track::newTemporary(kTrackLocation);
+    pQueue->queueAnalyseTrack(pTrack);
+    ASSERT_TRUE(processEventsUntil([this] { return m_finishedCount == 1; }));
+    EXPECT_TRUE(isAnalysed(pTrack));
+    EXPECT_EQ(0, m_finishedSizes.last());
+
+    // Every analyzer has been initialized once and has received all
+    // samples of the track in the very same blocks.
+    EXPECT_EQ(kAnalyzerCount, m_recorder.initializedTracks().size());
+    const auto analyses = m_recorder.analyses(pTrack);
+    ASSERT_EQ(kAnalyzerCount, analyses.size());
+    const auto& first = analyses.first();
+    EXPECT_TRUE(first.finalized);
+    EXPECT_GT(first.totalSamples, 0);
+    EXPECT_EQ(first.totalSamples, first.processedSamples);
+    for (const auto& analysis: analyses) {
+        EXPECT_TRUE(analysis.finalized);
+        EXPECT_EQ(first.processedSamples, analysis.processedSamples);
+        EXPECT_EQ(first.checksum, analysis.checksum);
+        EXPECT_EQ(first.blocks, analysis.blocks);
+    }
+}
+
+TEST_F(AnalyzerQueueTest, LoadedTrackIsAnalysedFirst) {
+    TestAnalyzerQueue* pQueue = createQueue();
+    // Slow enough that the loaded track is queued while both workers are
+    // busy with the first tracks
+    pQueue->addWorker(&m_recorder, 1, 2);
+    pQueue->addWorker(&m_recorder, 1, 2);
+    pQueue->start();
+
+    const QList<TrackPointer> tracks = newTracks(4);
+    for (const auto& pTrack: tracks) {
+        pQueue->queueAnalyseTrack(pTrack);
+    }
+    ASSERT_TRUE(processEventsUntil([this] {
+        return m_recorder.initializedTracks().size() >= 2;
+    }));
+
+    const TrackPointer pLoadedTrack = Track::newTemporary(kTrackLocation);
+    PlayerInfo::instance().setTrackInfo("[Channel1]", pLoadedTrack);
+    pQueue->slotAnalyseTrack(pLoadedTrack);
+
+    ASSERT_TRUE(processEventsUntil([this] { return m_finishedCount == 5; }));
+    for (const auto& pTrack: tracks) {
+        EXPECT_TRUE(isAnalysed(pTrack));
+    }
+    EXPECT_TRUE(isAnalysed(pLoadedTrack));
+
+    // One of the workers has been interrupted and continued with the
+    // loaded track instead of the next queued one
+    const QList<TrackPointer> initializedTracks = m_recorder.initializedTracks();
+    ASSERT_GE(initializedTracks.size(), 3);
+    EXPECT_EQ(pLoadedTrack, initializedTracks[2]);
+    EXPECT_LT(initializedTracks.indexOf(pLoadedTrack),
+            initializedTracks.indexOf(tracks[2]));
+}
+
+TEST_F(AnalyzerQueueTest, ProgressFollowsOneTrack) {
+    TestAnalyzerQueue* pQueue = createQueue();
+    pQueue->addWorker(&m_recorder, 1, 1);
+    pQueue->addWorker(&m_recorder, 1, 1);
+    pQueue->start();
+
+    const QList<TrackPointer> tracks = newTracks(4);
+    for (const auto& pTrack: tracks) {
+        pQueue->queueAnalyseTrack(pTrack);
+    }
+    ASSERT_TRUE(processEventsUntil([this] { return m_finishedCount == 4; }));
+
+    // Each track is finished once. The number of remaining tracks
+    // depends on how the two workers overlap.
+    ASSERT_EQ(4, m_finishedSizes.size());
+    for (int size: m_finishedSizes) {
+        EXPECT_LE(0, size);
+        EXPECT_GE(3, size);
+    }
+
+    // Although two tracks are analysed at the same time the progress
+    // never jumps back until the track has been finished.
+    int lastProgress = 0;
+    for (int progress: m_progress) {
+        if (progress < 0) {
+            lastProgress = 0;
+            continue;
+        }
+        EXPECT_GE(progress, lastProgress);
+        lastProgress = progress;
+    }
+}
+
+TEST_F(AnalyzerQueueTest, AnalysedTracksAreNotDecodedAgain) {
+    const QList<TrackPointer> tracks = newTracks(2);
+    const TrackPointer pAnalysedTrack = tracks[0];
+    const TrackPointer pNewTrack = tracks[1];
+
+    TestAnalyzerQueue* pQueue = createQueue();
+    pQueue->addStoredAnalysisLoader(std::make_unique<StoredAnalysisLoader>(
+            QSet<Track*>() << pAnalysedTrack.get()));
+    pQueue->addWorker(&m_recorder, 1);
+    pQueue->start();
+
+    for (const auto& pTrack: tracks) {
+        pQueue->queueAnalyseTrack(pTrack);
+    }
+    ASSERT_TRUE(processEventsUntil([this] { return m_finishedCount == 2; }));
+    EXPECT_TRUE(isAnalysed(pAnalysedTrack));
+    EXPECT_TRUE(isAnalysed(pNewTrack));
+
+    // Only the new track has reached the worker
+    EXPECT_EQ(QList<TrackPointer>() << pNewTrack, m_recorder.initializedTracks());
+}
+
+class AnalyzerStorageWriterTest : public LibraryTest {
+  protected:
+    // The writer opens its own connection to the database
+    AnalyzerStorageWriterTest()
+            : LibraryTest(false) {
+    }
+
+    TrackPointer newTrackWithWaveforms() {
+        TrackPointer pTrack = Track::newTemporary(
+                QDir::tempPath() + QString("/track%1.mp3").arg(m_tracks.size()));
+        pTrack->setDuration(30);
+        TrackDAO& trackDAO = collection()->getTrackDAO();
+        trackDAO.addTracksPrepare();
+        trackDAO.addTracksAddTrack(pTrack, false);
+        trackDAO.addTracksFinish(false);
+        EXPECT_TRUE(pTrack->getId().isValid());
+
+        WaveformPointer pWaveform(new Waveform(44100, 44100 * 2, 441, -1));
+        pWaveform->setSaveState(Waveform::SaveState::SavePending);
+        pTrack->setWaveform(pWaveform);
+        WaveformPointer pSummary(new Waveform(44100, 44100 * 2, 44100, 1800));
+        pSummary->setSaveState(Waveform::SaveState::SavePending);
+        pTrack->setWaveformSummary(pSummary);
+
+        m_tracks.append(pTrack);
+        return pTrack;
+    }
+
+    QList<TrackPointer> m_tracks;
+};
+
+TEST_F(AnalyzerStorageWriterTest, AnalysesAreWrittenInBatches) {
+    // More than fit into a single batch
+    const int kTrackCount = 70;
+    for (int i = 0; i < kTrackCount; ++i) {
+        newTrackWithWaveforms();
+    }
+
+    QMutex mutex;
+    QList<int> batches;
+    {
+        AnalyzerStorageWriter writer(dbConnectionPool(), config());
+        QObject::connect(&writer, &AnalyzerStorageWriter::batchWritten,
+                [&mutex, &batches](int trackCount) {
+                    QMutexLocker locked(&mutex);
+                    batches.append(trackCount);
+                },
+                Qt::DirectConnection);
+        for (const auto& pTrack: m_tracks) {
+            writer.saveTrackAnalyses(pTrack);
+        }
+        // The pending tracks are written before the thread exits
+    }
+
+    // The first batch is written as soon as it is full, the rest when
+    // the writer is stopped.
+    EXPECT_EQ(QList<int>() << 64 << kTrackCount - 64, batches);
+
+    AnalysisDao analysisDao(config());
+    analysisDao.initialize(dbConnection());
+    for (const auto& pTrack: m_tracks) {
+        EXPECT_EQ(2, analysisDao.getAnalysesForTrack(pTrack->getId()).size());
+        EXPECT_EQ(Waveform::SaveState::Saved, pTrack->getWaveform()->saveState());
+    }
+}
+
+}  // anonymous namespace
@@ -39,7 +39,7 @@ class MockEffectProcessor : public EffectProcessor {
                                   const mixxx::EngineParameters& bufferParameters));
     MOCK_METHOD1(createState, EffectState*(const mixxx::EngineParameters& bufferParameters));
     MOCK_METHOD2(loadStatesForInputChannel, bool(const ChannelHandle* inputChannel,
-          const EffectStatesMap* pStatesMap));
+          EffectStatesMap* pStatesMap));
     MOCK_METHOD1(deleteStatesForInputChannel, void(const ChannelHandle* inputChannel));
     MOCK_METHOD7(process, void(const ChannelHandle& inputHandle,
                                const ChannelHandle& outputHandle,
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <QHash>
+#include <vector>
+
+#include "engine/cachingreaderchunkindex.h"
+#include "util/memory.h"
+
+namespace {
+
+const int kMaxSize = 64;
+
+class CachingReaderChunkIndexTest : public testing::Test {
+  protected:
+    CachingReaderChunkIndexTest()
+            : m_sampleBuffer(CachingReaderChunk::kSamples * kMaxSize),
+              m_index(kMaxSize) {
+        for (int i = 0; i < kMaxSize; ++i) {
+            m_chunks.push_back(std::make_unique<CachingReaderChunkForOwner>(
+                    mixxx::SampleBuffer::WritableSlice(
+                            m_sampleBuffer,
+                            CachingReaderChunk::kSamples * i,
+                            CachingReaderChunk::kSamples)));
+        }
+    }
+
+    CachingReaderChunkForOwner* chunk(int i) {
+        return m_chunks[i].get();
+    }
+
+    mixxx::SampleBuffer m_sampleBuffer;
+    std::vector<std::unique_ptr<CachingReaderChunkForOwner>> m_chunks;
+    CachingReaderChunkIndex m_index;
+};
+
+TEST_F(CachingReaderChunkIndexTest, insertLookupRemove) {
+    EXPECT_TRUE(m_index.isEmpty());
+    EXPECT_EQ(nullptr, m_index.value(0));
+
+    m_index.insert(3, chunk(0));
+    m_index.insert(4, chunk(1));
+    EXPECT_EQ(2, m_index.size());
+    EXPECT_EQ(chunk(0), m_index.value(3));
+    EXPECT_EQ(chunk(1), m_index.value(4));
+    EXPECT_EQ(nullptr, m_index.value(5));
+
+    EXPECT_EQ(1, m_index.remove(3));
+    EXPECT_EQ(0, m_index.remove(3));
+    EXPECT_EQ(1, m_index.size());
+    EXPECT_EQ(nullptr, m_index.value(3));
+    EXPECT_EQ(chunk(1), m_index.value(4));
+
+    m_index.clear();
+    EXPECT_TRUE(m_index.isEmpty());
+    EXPECT_EQ(nullptr, m_index.value(4));
+}
+
+TEST_F(CachingReaderChunkIndexTest, compareWithQHash) {
+    // Simulate a sliding window of chunks with colliding chunk
+    // indices and compare the results with a QHash
+    QHash<SINT, CachingReaderChunkForOwner*> reference;
+    std::vector<CachingReaderChunkForOwner*> freeChunks;
+    for (int i = 0; i < kMaxSize; ++i) {
+        freeChunks.push_back(chunk(i));
+    }
+    for (SINT chunkIndex = 0; chunkIndex < 10000; chunkIndex += 7) {
+        const SINT expiredIndex = chunkIndex - 7 * kMaxSize;
+        if (reference.contains(expiredIndex)) {
+            freeChunks.push_back(reference.take(expiredIndex));
+            EXPECT_EQ(1, m_index.remove(expiredIndex));
+        }
+        ASSERT_FALSE(freeChunks.empty());
+        CachingReaderChunkForOwner* pChunk = freeChunks.back();
+        freeChunks.pop_back();
+        reference.insert(chunkIndex, pChunk);
+        m_index.insert(chunkIndex, pChunk);
+
+        ASSERT_EQ(reference.size(), m_index.size());
+        for (SINT i = chunkIndex - 7 * kMaxSize; i <= chunkIndex + 7; ++i) {
+            EXPECT_EQ(reference.value(i, nullptr), m_index.value(i));
+        }
+    }
+}
+
+} // anonymous namespace
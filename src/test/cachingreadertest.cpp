@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include <QAtomicInt>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QList>
+#include <QTest>
+
+#include <algorithm>
+
+#include "engine/cachingreader.h"
+#include "engine/engineworkerscheduler.h"
+#include "engine/readaheadmanager.h"
+#include "test/mixxxtest.h"
+#include "track/track.h"
+#include "util/memory.h"
+
+namespace {
+
+// 30 s at 44.1 kHz, i.e. 162 chunks
+const QString kTrackLocation(
+        QDir::current().absoluteFilePath("src/test/sine-30.wav"));
+
+// Waiting for the worker thread fails the test after this time
+const qint64 kTimeoutMillis = 10000;
+
+} // anonymous namespace
+
+// Checks which chunks the reader requests from its worker for the hints of a
+// callback. The requested chunks are allocated in the engine thread before
+// the worker is woken up, so they are known without waiting for the worker.
+class CachingReaderTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_scheduler.start(QThread::HighPriority);
+        m_pReader = std::make_unique<CachingReader>("[Channel1]", config());
+        m_pReader->setScheduler(&m_scheduler);
+
+        QAtomicInt loaded(0);
+        auto connection = QObject::connect(m_pReader.get(),
+                &CachingReader::trackLoaded,
+                [&loaded](TrackPointer, int, int) {
+                    loaded.storeRelease(1);
+                });
+        m_pReader->newTrack(Track::newTemporary(kTrackLocation));
+        m_scheduler.runWorkers();
+        QElapsedTimer timer;
+        timer.start();
+        while (!loaded.loadAcquire() && !timer.hasExpired(kTimeoutMillis)) {
+            QTest::qSleep(1); // millis
+        }
+        QObject::disconnect(connection);
+        ASSERT_TRUE(loaded.loadAcquire()) << "Timeout while loading the track";
+        m_pReader->process();
+    }
+
+    void TearDown() override {
+        m_pReader.reset();
+    }
+
+    bool isRequested(SINT chunkIndex) const {
+        return m_pReader->lookupChunk(chunkIndex) != nullptr;
+    }
+
+    int requestedChunkCount() const {
+        return m_pReader->m_allocatedCachingReaderChunks.size();
+    }
+
+    QList<SINT> requestedChunks() const {
+        QList<SINT> chunkIndices;
+        for (const CachingReaderChunkForOwner* pChunk : m_pReader->m_chunks) {
+            if (pChunk->getState() != CachingReaderChunkForOwner::FREE) {
+                chunkIndices.append(pChunk->getIndex());
+            }
+        }
+        std::sort(chunkIndices.begin(), chunkIndices.end());
+        return chunkIndices;
+    }
+
+    // Lets the worker read all requested chunks
+    void readRequestedChunks() {
+        m_scheduler.runWorkers();
+        QElapsedTimer timer;
+        timer.start();
+        while (true) {
+            m_pReader->process();
+            bool pending = false;
+            for (const CachingReaderChunkForOwner* pChunk : m_pReader->m_chunks) {
+                if (pChunk->getState() == CachingReaderChunkForOwner::READ_PENDING) {
+                    pending = true;
+                }
+            }
+            if (!pending) {
+                return;
+            }
+            ASSERT_FALSE(timer.hasExpired(kTimeoutMillis))
+                    << "Timeout while reading chunks";
+            QTest::qSleep(1); // millis
+        }
+    }
+
+    // The read-ahead hint of a deck that plays forward from frameIndex
+    static Hint playPositionHint(SINT frameIndex) {
+        Hint hint;
+        hint.frame = frameIndex;
+        hint.frameCount = ReadAheadManager::kFrameCountToCache;
+        hint.priority = Hint::kPriorityImmediate;
+        return hint;
+    }
+
+    EngineWorkerScheduler m_scheduler;
+    std::unique_ptr<CachingReader> m_pReader;
+};
+
+TEST_F(CachingReaderTest, JumpTargetRequestsReadAheadWindow) {
+    // A hotcue close to the start of a chunk, its read-ahead window reaches
+    // into the third chunk
+    const SINT hotcueFrame = 20 * CachingReaderChunk::kFrames + 100;
+    HintVector hints;
+    ReadAheadManager::hintJumpTarget(
+            CachingReaderChunk::frames2samples(hotcueFrame), false,
+            Hint::kPriorityPrefetch, &hints);
+    m_pReader->hintAndMaybeWake(hints);
+
+    EXPECT_FALSE(isRequested(19));
+    EXPECT_TRUE(isRequested(20));
+    EXPECT_TRUE(isRequested(21));
+    EXPECT_TRUE(isRequested(22));
+    EXPECT_FALSE(isRequested(23));
+}
+
+TEST_F(CachingReaderTest, ReverseJumpTargetRequestsReadAheadWindow) {
+    // A loop out point close to the end of a chunk
+    const SINT loopOutFrame = 20 * CachingReaderChunk::kFrames - 100;
+    HintVector hints;
+    ReadAheadManager::hintJumpTarget(
+            CachingReaderChunk::frames2samples(loopOutFrame), true,
+            Hint::kPriorityPrefetch, &hints);
+    m_pReader->hintAndMaybeWake(hints);
+
+    EXPECT_FALSE(isRequested(16));
+    EXPECT_TRUE(isRequested(17));
+    EXPECT_TRUE(isRequested(18));
+    EXPECT_TRUE(isRequested(19));
+    EXPECT_FALSE(isRequested(20));
+}
+
+TEST_F(CachingReaderTest, PrefetchHintsDontEnlargeCache) {
+    // An idle deck with more hotcues than fit into its cache
+    HintVector hints;
+    hints.append(playPositionHint(100));
+    for (int i = 0; i < 30; ++i) {
+        ReadAheadManager::hintJumpTarget(
+                CachingReaderChunk::frames2samples(
+                        (10 + 5 * i) * CachingReaderChunk::kFrames),
+                false, Hint::kPriorityPrefetch, &hints);
+    }
+    const SINT targetChunkCount = m_pReader->getTargetChunkCount();
+
+    // Every callback hints the same chunks, the cache stays at its size
+    for (int callback = 0; callback < 3; ++callback) {
+        m_pReader->hintAndMaybeWake(hints);
+        EXPECT_EQ(targetChunkCount, m_pReader->getTargetChunkCount());
+        EXPECT_EQ(targetChunkCount, requestedChunkCount());
+    }
+    // The read-ahead window of the play position and the first hotcues
+    EXPECT_TRUE(isRequested(0));
+    EXPECT_TRUE(isRequested(1));
+    EXPECT_TRUE(isRequested(2));
+    EXPECT_TRUE(isRequested(10));
+    EXPECT_TRUE(isRequested(11));
+    EXPECT_TRUE(isRequested(15));
+    // The last hotcues don't fit into the cache anymore
+    EXPECT_FALSE(isRequested(10 + 5 * 29));
+}
+
+TEST_F(CachingReaderTest, PrefetchHintsDontEvictReadAheadChunks) {
+    HintVector prefetchHints;
+    for (int i = 0; i < 30; ++i) {
+        ReadAheadManager::hintJumpTarget(
+                CachingReaderChunk::frames2samples(
+                        (10 + 5 * i) * CachingReaderChunk::kFrames),
+                false, Hint::kPriorityPrefetch, &prefetchHints);
+    }
+    m_pReader->hintAndMaybeWake(prefetchHints);
+    const SINT targetChunkCount = m_pReader->getTargetChunkCount();
+    EXPECT_EQ(targetChunkCount, requestedChunkCount());
+    readRequestedChunks();
+
+    // The deck starts to play. The read-ahead chunks replace prefetched
+    // chunks, which are not requested again in the same callback.
+    HintVector hints;
+    hints.append(playPositionHint(100));
+    hints.append(prefetchHints.constData(), prefetchHints.size());
+    m_pReader->hintAndMaybeWake(hints);
+    EXPECT_TRUE(isRequested(0));
+    EXPECT_TRUE(isRequested(1));
+    EXPECT_TRUE(isRequested(2));
+    EXPECT_EQ(targetChunkCount, requestedChunkCount());
+    const QList<SINT> chunks = requestedChunks();
+    readRequestedChunks();
+
+    // No more chunks are replaced in the following callbacks
+    m_pReader->hintAndMaybeWake(hints);
+    EXPECT_EQ(chunks, requestedChunks());
+}
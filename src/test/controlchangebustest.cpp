@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <QSignalSpy>
+#include <QtDebug>
+
+#include "control/control.h"
+#include "control/controlobject.h"
+#include "control/controlproxy.h"
+#include "test/mixxxtest.h"
+#include "util/memory.h"
+
+namespace {
+
+class ControlChangeBusTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pChangeBus = ControlDoublePrivate::changeBus();
+        m_pChangeBus->setEnabled(true);
+        m_pSource = std::make_unique<ControlObject>(ConfigKey("[Test]", "source"));
+        m_pMirror = std::make_unique<ControlObject>(ConfigKey("[Test]", "mirror"));
+        m_pMirrorProxy = std::make_unique<ControlProxy>(m_pMirror->getKey());
+    }
+
+    void TearDown() override {
+        m_pChangeBus->deliverChanges();
+        m_pChangeBus->setEnabled(false);
+    }
+
+    ControlChangeBus* m_pChangeBus;
+    std::unique_ptr<ControlObject> m_pSource;
+    std::unique_ptr<ControlObject> m_pMirror;
+    // Receives the values of the source control
+    std::unique_ptr<ControlProxy> m_pMirrorProxy;
+};
+
+TEST_F(ControlChangeBusTest, DeliversLatestValueOnce) {
+    ControlProxy source(m_pSource->getKey());
+    ASSERT_TRUE(source.connectValueChangedCoalesced(
+            m_pMirrorProxy.get(), SLOT(slotSet(double))));
+    QSignalSpy spy(&source, SIGNAL(valueChanged(double)));
+
+    for (int i = 1; i <= 100; ++i) {
+        m_pSource->set(i);
+    }
+    EXPECT_EQ(0, spy.count());
+    EXPECT_DOUBLE_EQ(0.0, m_pMirror->get());
+
+    EXPECT_EQ(1, m_pChangeBus->deliverChanges());
+    EXPECT_EQ(1, spy.count());
+    EXPECT_DOUBLE_EQ(100.0, m_pMirror->get());
+
+    // Nothing has changed since
+    EXPECT_EQ(0, m_pChangeBus->deliverChanges());
+    EXPECT_EQ(1, spy.count());
+}
+
+TEST_F(ControlChangeBusTest, DeliversChangesOfOwnProxy) {
+    ControlProxy source(m_pSource->getKey());
+    ASSERT_TRUE(source.connectValueChangedCoalesced(
+            m_pMirrorProxy.get(), SLOT(slotSet(double))));
+
+    source.set(3.0);
+    EXPECT_EQ(1, m_pChangeBus->deliverChanges());
+    EXPECT_DOUBLE_EQ(3.0, m_pMirror->get());
+}
+
+TEST_F(ControlChangeBusTest, FallsBackToSignalsWhenDisabled) {
+    m_pChangeBus->setEnabled(false);
+    ControlProxy source(m_pSource->getKey());
+    ASSERT_TRUE(source.connectValueChangedCoalesced(
+            m_pMirrorProxy.get(), SLOT(slotSet(double))));
+
+    m_pSource->set(5.0);
+    EXPECT_DOUBLE_EQ(5.0, m_pMirror->get());
+    EXPECT_EQ(0, m_pChangeBus->deliverChanges());
+}
+
+TEST_F(ControlChangeBusTest, SkipsDeletedControls) {
+    {
+        ControlObject temporary(ConfigKey("[Test]", "temporary"));
+        ControlProxy proxy(temporary.getKey());
+        ASSERT_TRUE(proxy.connectValueChangedCoalesced(
+                m_pMirrorProxy.get(), SLOT(slotSet(double))));
+        temporary.set(1.0);
+    }
+    EXPECT_EQ(0, m_pChangeBus->deliverChanges());
+    EXPECT_DOUBLE_EQ(0.0, m_pMirror->get());
+}
+
+}  // namespace
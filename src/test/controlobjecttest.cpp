@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
+#include <benchmark/benchmark.h>
 #include <QtDebug>
 
+#include <vector>
+
 #include "control/controlobject.h"
+#include "control/controlproxy.h"
 #include "util/memory.h"
 #include "test/mixxxtest.h"
 
@@ -49,6 +53,28 @@ TEST_F(ControlObjectTest, AliasRetrieval) {
     EXPECT_EQ(ControlObject::getControl(ckAlias), co.get());
 }
 
+TEST_F(ControlObjectTest, getControlAfterRecreation) {
+    // Enough controls for the registry to publish new lookup snapshots
+    // while the controls come and go.
+    std::vector<std::unique_ptr<ControlObject>> controls;
+    for (int i = 0; i < 1000; ++i) {
+        ConfigKey key("[Test]", QString("control%1").arg(i));
+        controls.push_back(std::make_unique<ControlObject>(key));
+        EXPECT_EQ(ControlObject::getControl(key), controls.back().get());
+    }
+    for (int i = 0; i < 1000; i += 2) {
+        controls[i].reset();
+    }
+    for (int i = 0; i < 1000; ++i) {
+        ConfigKey key("[Test]", QString("control%1").arg(i));
+        EXPECT_EQ(ControlObject::getControl(key, false), controls[i].get());
+        if (!controls[i]) {
+            controls[i] = std::make_unique<ControlObject>(key);
+            EXPECT_EQ(ControlObject::getControl(key), controls[i].get());
+        }
+    }
+}
+
 TEST_F(ControlObjectTest, Persistence_NotPresent) {
     ConfigKey ck("[Test]", "persist");
     ASSERT_FALSE(m_pConfig->exists(ck));
@@ -84,4 +110,59 @@ TEST_F(ControlObjectTest, Persistence_ValidValue) {
     EXPECT_DOUBLE_EQ(5.0, co.get());
 }
 
+const int kNumBenchmarkControls = 5000;
+std::vector<std::unique_ptr<ControlObject>> s_benchmarkControls;
+std::vector<ConfigKey> s_benchmarkKeys;
+
+void createBenchmarkControls() {
+    for (int i = 0; i < kNumBenchmarkControls; ++i) {
+        ConfigKey key(QString("[Channel%1]").arg(i % 8 + 1),
+                QString("control%1").arg(i));
+        s_benchmarkControls.push_back(std::make_unique<ControlObject>(key));
+        s_benchmarkKeys.push_back(key);
+    }
+}
+
+void deleteBenchmarkControls() {
+    s_benchmarkControls.clear();
+    s_benchmarkKeys.clear();
+}
+
+// Looks up existing controls from several threads, like widgets and
+// controllers do when a skin or mapping is loaded. Run with:
+// mixxx-test --benchmark --benchmark_filter=BM_Control
+static void BM_ControlLookup(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        createBenchmarkControls();
+    }
+    int i = state.thread_index;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(ControlObject::getControl(
+                s_benchmarkKeys[i % kNumBenchmarkControls]));
+        i += 7;
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index == 0) {
+        deleteBenchmarkControls();
+    }
+}
+BENCHMARK(BM_ControlLookup)->ThreadRange(1, 8);
+
+static void BM_ControlProxyCreation(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        createBenchmarkControls();
+    }
+    int i = state.thread_index;
+    while (state.KeepRunning()) {
+        ControlProxy proxy(s_benchmarkKeys[i % kNumBenchmarkControls]);
+        benchmark::DoNotOptimize(proxy.get());
+        i += 7;
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index == 0) {
+        deleteBenchmarkControls();
+    }
+}
+BENCHMARK(BM_ControlProxyCreation)->ThreadRange(1, 8);
+
 }
@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <vector>
+
+#include "engine/cachingreader.h"
+#include "engine/decodedsamplecache.h"
+#include "engine/engineworkerscheduler.h"
+#include "test/mixxxtest.h"
+#include "track/track.h"
+#include "util/memory.h"
+
+namespace {
+
+const QString kTrackLocation(
+        QDir::current().absoluteFilePath("src/test/sine-30.wav"));
+
+// One callback of 1024 frames at 44.1 kHz
+const SINT kCallbackFrames = 1024;
+// Waiting for the worker thread fails the test after this time
+const qint64 kTimeoutMillis = 10000;
+
+class DecodedSampleCacheTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_fileDir.isValid());
+        DecodedSampleCache::setMemoryBudget(2 * sampleSizeInBytes());
+    }
+
+    void TearDown() override {
+        DecodedSampleCache::setMemoryBudget(0);
+    }
+
+    static qint64 sampleSizeInBytes() {
+        return CachingReaderChunk::frames2samples(kCallbackFrames) *
+                sizeof(CSAMPLE);
+    }
+
+    QString writeFile(const QString& name, const QByteArray& content = "x") {
+        const QString fileName = QDir(m_fileDir.path()).filePath(name);
+        QFile file(fileName);
+        EXPECT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(content);
+        return fileName;
+    }
+
+    static const DecodedSample* insert(const QString& fileName) {
+        const QFileInfo fileInfo(fileName);
+        return DecodedSampleCache::insert(std::make_unique<DecodedSample>(
+                fileName,
+                fileInfo.size(),
+                fileInfo.lastModified().toMSecsSinceEpoch(),
+                mixxx::IndexRange::forward(0, kCallbackFrames)));
+    }
+
+    QTemporaryDir m_fileDir;
+};
+
+TEST_F(DecodedSampleCacheTest, SamplersShareSamplesOfSameFile) {
+    const QString fileName = writeFile("a.wav");
+    EXPECT_EQ(nullptr, DecodedSampleCache::acquire(fileName));
+
+    const DecodedSample* pInserted = insert(fileName);
+    ASSERT_NE(nullptr, pInserted);
+    const DecodedSample* pAcquired = DecodedSampleCache::acquire(fileName);
+    EXPECT_EQ(pInserted, pAcquired);
+    // Decoded concurrently by another sampler
+    EXPECT_EQ(pInserted, insert(fileName));
+    EXPECT_EQ(sampleSizeInBytes(), DecodedSampleCache::memoryUsage());
+
+    pInserted->unpin();
+    pInserted->unpin();
+    EXPECT_TRUE(pAcquired->isPinned());
+    pAcquired->unpin();
+    EXPECT_FALSE(pAcquired->isPinned());
+}
+
+TEST_F(DecodedSampleCacheTest, EvictsLeastRecentlyUsedSamples) {
+    const QString fileNameA = writeFile("a.wav");
+    const QString fileNameB = writeFile("b.wav");
+    const QString fileNameC = writeFile("c.wav");
+    insert(fileNameA)->unpin();
+    insert(fileNameB)->unpin();
+    // A is used more recently than B now
+    DecodedSampleCache::acquire(fileNameA)->unpin();
+
+    const DecodedSample* pSampleC = insert(fileNameC);
+    ASSERT_NE(nullptr, pSampleC);
+    pSampleC->unpin();
+    EXPECT_EQ(2 * sampleSizeInBytes(), DecodedSampleCache::memoryUsage());
+    EXPECT_EQ(nullptr, DecodedSampleCache::acquire(fileNameB));
+    const DecodedSample* pSampleA = DecodedSampleCache::acquire(fileNameA);
+    ASSERT_NE(nullptr, pSampleA);
+    pSampleA->unpin();
+}
+
+TEST_F(DecodedSampleCacheTest, PinnedSamplesAreNotEvicted) {
+    const QString fileNameA = writeFile("a.wav");
+    const QString fileNameB = writeFile("b.wav");
+    DecodedSampleCache::setMemoryBudget(sampleSizeInBytes());
+    const DecodedSample* pSampleA = insert(fileNameA);
+    ASSERT_NE(nullptr, pSampleA);
+
+    EXPECT_FALSE(DecodedSampleCache::fitsIntoMemoryBudget(sampleSizeInBytes()));
+    EXPECT_EQ(nullptr, insert(fileNameB));
+    EXPECT_EQ(pSampleA, DecodedSampleCache::acquire(fileNameA));
+    pSampleA->unpin();
+
+    pSampleA->unpin();
+    EXPECT_TRUE(DecodedSampleCache::fitsIntoMemoryBudget(sampleSizeInBytes()));
+    const DecodedSample* pSampleB = insert(fileNameB);
+    ASSERT_NE(nullptr, pSampleB);
+    pSampleB->unpin();
+    EXPECT_EQ(nullptr, DecodedSampleCache::acquire(fileNameA));
+}
+
+TEST_F(DecodedSampleCacheTest, ModifiedFileIsDecodedAgain) {
+    const QString fileName = writeFile("a.wav");
+    insert(fileName)->unpin();
+
+    writeFile("a.wav", "modified");
+    EXPECT_EQ(nullptr, DecodedSampleCache::acquire(fileName));
+    const DecodedSample* pSample = insert(fileName);
+    ASSERT_NE(nullptr, pSample);
+    pSample->unpin();
+    // The outdated samples have been replaced
+    EXPECT_EQ(sampleSizeInBytes(), DecodedSampleCache::memoryUsage());
+}
+
+class DecodedSampleReaderTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        DecodedSampleCache::setMemoryBudget(64 << 20);
+        m_scheduler.start(QThread::HighPriority);
+    }
+
+    void TearDown() override {
+        m_readers.clear();
+        DecodedSampleCache::setMemoryBudget(0);
+    }
+
+    CachingReader* createReader(mixxx::Duration decodeToMemoryMaxDuration) {
+        auto pReader = std::make_unique<CachingReader>(
+                QString("[Sampler%1]").arg(m_readers.size() + 1), config());
+        pReader->setScheduler(&m_scheduler);
+        pReader->setDecodeToMemory(decodeToMemoryMaxDuration);
+        m_readers.push_back(std::move(pReader));
+        return m_readers.back().get();
+    }
+
+    void loadTrack(CachingReader* pReader) {
+        QAtomicInt loaded(0);
+        auto connection = QObject::connect(pReader, &CachingReader::trackLoaded,
+                [&loaded](TrackPointer, int, int) {
+                    loaded.storeRelease(1);
+                });
+        pReader->newTrack(Track::newTemporary(kTrackLocation));
+        m_scheduler.runWorkers();
+        QElapsedTimer timer;
+        timer.start();
+        while (!loaded.loadAcquire() && !timer.hasExpired(kTimeoutMillis)) {
+            QTest::qSleep(1); // millis
+        }
+        QObject::disconnect(connection);
+        ASSERT_TRUE(loaded.loadAcquire()) << "Timeout while loading the track";
+        pReader->process();
+    }
+
+    // Reads one callback at frameIndex like the engine does after a hotcue
+    // of a sampler has been triggered.
+    static CachingReader::ReadResult read(CachingReader* pReader,
+            SINT frameIndex, std::vector<CSAMPLE>* pOutput) {
+        pOutput->resize(CachingReaderChunk::frames2samples(kCallbackFrames));
+        return pReader->read(
+                CachingReaderChunk::frames2samples(frameIndex),
+                pOutput->size(),
+                false,
+                pOutput->data());
+    }
+
+    // Hints frameIndex and wakes the worker until the reader delivers audio
+    void readWhenAvailable(CachingReader* pReader, SINT frameIndex,
+            std::vector<CSAMPLE>* pOutput) {
+        HintVector hints;
+        Hint hint;
+        hint.frame = frameIndex;
+        hint.frameCount = kCallbackFrames;
+        hint.priority = Hint::kPriorityImmediate;
+        hints.append(hint);
+
+        QElapsedTimer timer;
+        timer.start();
+        while (read(pReader, frameIndex, pOutput) ==
+                CachingReader::ReadResult::UNAVAILABLE) {
+            ASSERT_FALSE(timer.hasExpired(kTimeoutMillis))
+                    << "Timeout while reading frame " << frameIndex;
+            pReader->hintAndMaybeWake(hints);
+            m_scheduler.runWorkers();
+            QTest::qSleep(1); // millis
+        }
+    }
+
+    EngineWorkerScheduler m_scheduler;
+    std::vector<std::unique_ptr<CachingReader>> m_readers;
+};
+
+TEST_F(DecodedSampleReaderTest, TriggerIsReadWithoutWaitingForWorker) {
+    CachingReader* pChunkReader = createReader(mixxx::Duration::empty());
+    CachingReader* pMemoryReader =
+            createReader(mixxx::Duration::fromSeconds(60));
+    loadTrack(pChunkReader);
+    loadTrack(pMemoryReader);
+    ASSERT_FALSE(pChunkReader->isDecodedToMemory());
+    ASSERT_TRUE(pMemoryReader->isDecodedToMemory());
+
+    // A cue point in the middle of the track that has not been hinted
+    const SINT frameIndex = 15 * 44100;
+    std::vector<CSAMPLE> chunkOutput;
+    EXPECT_EQ(CachingReader::ReadResult::UNAVAILABLE,
+            read(pChunkReader, frameIndex, &chunkOutput));
+    // Audio from the first callback, the worker is never woken up
+    std::vector<CSAMPLE> memoryOutput;
+    EXPECT_EQ(CachingReader::ReadResult::AVAILABLE,
+            read(pMemoryReader, frameIndex, &memoryOutput));
+
+    readWhenAvailable(pChunkReader, frameIndex, &chunkOutput);
+    EXPECT_EQ(chunkOutput, memoryOutput);
+}
+
+TEST_F(DecodedSampleReaderTest, ReadsInReverse) {
+    CachingReader* pChunkReader = createReader(mixxx::Duration::empty());
+    CachingReader* pMemoryReader =
+            createReader(mixxx::Duration::fromSeconds(60));
+    loadTrack(pChunkReader);
+    loadTrack(pMemoryReader);
+
+    // Across the start of the track into the preroll
+    const SINT sampleIndex = CachingReaderChunk::frames2samples(100);
+    std::vector<CSAMPLE> chunkOutput;
+    readWhenAvailable(pChunkReader, 0, &chunkOutput);
+    std::vector<CSAMPLE> memoryOutput(chunkOutput.size());
+    ASSERT_NE(CachingReader::ReadResult::UNAVAILABLE, pChunkReader->read(
+            sampleIndex, chunkOutput.size(), true, chunkOutput.data()));
+    EXPECT_EQ(CachingReader::ReadResult::PARTIALLY_AVAILABLE,
+            pMemoryReader->read(
+                    sampleIndex, memoryOutput.size(), true, memoryOutput.data()));
+    EXPECT_EQ(chunkOutput, memoryOutput);
+}
+
+TEST_F(DecodedSampleReaderTest, SamplersShareDecodedTrack) {
+    CachingReader* pReader1 = createReader(mixxx::Duration::fromSeconds(60));
+    CachingReader* pReader2 = createReader(mixxx::Duration::fromSeconds(60));
+    loadTrack(pReader1);
+    const qint64 memoryUsage = DecodedSampleCache::memoryUsage();
+    EXPECT_LT(0, memoryUsage);
+    loadTrack(pReader2);
+    EXPECT_TRUE(pReader1->isDecodedToMemory());
+    EXPECT_TRUE(pReader2->isDecodedToMemory());
+    EXPECT_EQ(memoryUsage, DecodedSampleCache::memoryUsage());
+}
+
+TEST_F(DecodedSampleReaderTest, LongTrackIsReadFromChunks) {
+    CachingReader* pReader = createReader(mixxx::Duration::fromSeconds(10));
+    loadTrack(pReader);
+    EXPECT_FALSE(pReader->isDecodedToMemory());
+}
+
+TEST_F(DecodedSampleReaderTest, TrackAboveBudgetIsReadFromChunks) {
+    DecodedSampleCache::setMemoryBudget(1 << 20);
+    CachingReader* pReader = createReader(mixxx::Duration::fromSeconds(60));
+    loadTrack(pReader);
+    EXPECT_FALSE(pReader->isDecodedToMemory());
+    EXPECT_EQ(0, DecodedSampleCache::memoryUsage());
+}
+
+}  // namespace
@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "effects/builtin/echoeffect.h"
+#include "effects/effectchain.h"
+#include "effects/effectchainslot.h"
+#include "effects/effectrack.h"
+#include "effects/effectsmanager.h"
+#include "engine/effects/engineeffectsmanager.h"
+#include "engine/effects/groupfeaturestate.h"
+#include "test/baseeffecttest.h"
+#include "util/samplebuffer.h"
+
+// The test binary replaces the global operator new and delete to count the
+// heap operations of the thread while it runs engine callbacks. With glibc
+// malloc, calloc, realloc and free are wrapped as well, which also catches
+// the allocations inside of Qt, e.g. when a QHash or QList grows. The
+// sanitizers intercept these functions themselves, so they are only
+// wrapped without them.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define ENGINE_EFFECTS_TEST_WRAP_MALLOC
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+#undef ENGINE_EFFECTS_TEST_WRAP_MALLOC
+#endif
+#endif
+#endif
+
+namespace {
+
+// Set while the test thread runs engine callbacks
+thread_local bool t_inEngineCallback = false;
+std::atomic<int> s_engineHeapOperations(0);
+
+inline void countHeapOperation() {
+    if (t_inEngineCallback) {
+        s_engineHeapOperations.fetch_add(1);
+    }
+}
+
+}  // anonymous namespace
+
+#if defined(ENGINE_EFFECTS_TEST_WRAP_MALLOC)
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+    countHeapOperation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    countHeapOperation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    countHeapOperation();
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (ptr) {
+        countHeapOperation();
+    }
+    __libc_free(ptr);
+}
+
+}  // extern "C"
+
+namespace {
+
+// operator new and delete are counted once and not again by malloc and free
+inline void* allocate(size_t size) {
+    return __libc_malloc(size ? size : 1);
+}
+
+inline void deallocate(void* ptr) {
+    __libc_free(ptr);
+}
+
+}  // anonymous namespace
+
+#else
+
+namespace {
+
+inline void* allocate(size_t size) {
+    return std::malloc(size ? size : 1);
+}
+
+inline void deallocate(void* ptr) {
+    std::free(ptr);
+}
+
+}  // anonymous namespace
+
+#endif  // ENGINE_EFFECTS_TEST_WRAP_MALLOC
+
+void* operator new(size_t size) {
+    countHeapOperation();
+    void* ptr = allocate(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    countHeapOperation();
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    countHeapOperation();
+    return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr) {
+        countHeapOperation();
+    }
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+
+const unsigned int kSampleRate = 44100;
+const unsigned int kNumSamples = 256;
+
+class EngineEffectsManagerTest : public BaseEffectTest {
+  protected:
+    EngineEffectsManagerTest()
+            : m_master(m_factory.getOrCreateHandle("[Master]"), "[Master]"),
+              m_channel1(m_factory.getOrCreateHandle("[Channel1]"), "[Channel1]"),
+              m_buffer(kNumSamples) {
+        m_buffer.fill(0.1f);
+    }
+
+    void SetUp() override {
+        registerTestBackend();
+        m_pEffectsManager->registerInputChannel(m_channel1);
+        m_pEffectsManager->registerOutputChannel(m_master);
+        m_pTestBackend->registerEffect(EchoEffect::getId(),
+                EchoEffect::getManifest(),
+                EffectInstantiatorPointer(
+                        new EffectProcessorInstantiator<EchoEffect>()));
+    }
+
+    // Runs engine callbacks with the pending requests, like EngineMaster
+    // does for the post-fader effects of a channel. Returns the number of
+    // heap operations of the callbacks.
+    int processCallbacks(int callbacks) {
+        EngineEffectsManager* pEngineEffectsManager =
+                m_pEffectsManager->getEngineEffectsManager();
+        const GroupFeatureState featureState;
+        s_engineHeapOperations = 0;
+        t_inEngineCallback = true;
+        for (int i = 0; i < callbacks; ++i) {
+            pEngineEffectsManager->onCallbackStart();
+            pEngineEffectsManager->processPostFaderInPlace(
+                    m_channel1.handle(), m_master.handle(),
+                    m_buffer.data(), kNumSamples, kSampleRate,
+                    featureState);
+        }
+        t_inEngineCallback = false;
+        return s_engineHeapOperations;
+    }
+
+    ChannelHandleFactory m_factory;
+    ChannelHandleAndGroup m_master;
+    ChannelHandleAndGroup m_channel1;
+    mixxx::SampleBuffer m_buffer;
+};
+
+TEST_F(EngineEffectsManagerTest, EnablingAndSwappingEffectsDoesNotUseHeap) {
+    StandardEffectRackPointer pRack = m_pEffectsManager->addStandardEffectRack();
+    EffectChainSlotPointer pChainSlot = pRack->getEffectChainSlot(0);
+    EffectChainPointer pChain(new EffectChain(m_pEffectsManager.data(),
+                                              "org.mixxx.test.chain1"));
+    pChainSlot->loadEffectChainToSlot(pChain);
+    pChain->setEnabled(true);
+    pChain->setMix(1.0);
+    EXPECT_EQ(0, processCallbacks(2));
+
+    // Loading an effect
+    EffectPointer pEffect = m_pEffectsManager->instantiateEffect(
+            EchoEffect::getId());
+    ASSERT_FALSE(pEffect.isNull());
+    pChain->addEffect(pEffect);
+    pEffect->setEnabled(true);
+    EXPECT_EQ(0, processCallbacks(2));
+
+    // Enabling the chain for the channel hands over new states
+    pChain->enableForInputChannel(m_channel1);
+    EXPECT_EQ(0, processCallbacks(4));
+
+    // Swapping the effect while the channel is enabled
+    EffectPointer pOtherEffect = m_pEffectsManager->instantiateEffect(
+            EchoEffect::getId());
+    ASSERT_FALSE(pOtherEffect.isNull());
+    pChain->replaceEffect(0, pOtherEffect);
+    pOtherEffect->setEnabled(true);
+    EXPECT_EQ(0, processCallbacks(4));
+
+    // Disabling and enabling the channel again
+    pChain->disableForInputChannel(m_channel1);
+    EXPECT_EQ(0, processCallbacks(2));
+    pChain->enableForInputChannel(m_channel1);
+    EXPECT_EQ(0, processCallbacks(4));
+}
+
+}  // namespace
@@ -1,9 +1,112 @@
 #include <gtest/gtest.h>
+#include <benchmark/benchmark.h>
 
+#include <cmath>
+
+#include "engine/enginefilterbessel8.h"
 #include "engine/enginefilterbiquad1.h"
+#include "engine/enginefilterlinkwitzriley8.h"
+#include "util/sample.h"
 
 namespace {
 
+const int kSampleRate = 44100;
+
+// Processes the channels one after the other through the scalar sections of
+// the filter, like EngineFilterIIR did before both channels were processed
+// in lanes. This includes the cross fade after the coefficients have changed.
+template<class Filter>
+class ScalarReferenceFilter : public Filter {
+  public:
+    using Filter::Filter;
+
+    void processScalar(const CSAMPLE* pIn, CSAMPLE* pOutput,
+            const int iBufferSize) {
+        if (!this->m_doRamping) {
+            for (int i = 0; i < iBufferSize; i += 2) {
+                pOutput[i] = static_cast<CSAMPLE>(
+                        processChannel(this->m_coef, this->m_buf1, pIn[i]));
+                pOutput[i + 1] = static_cast<CSAMPLE>(
+                        processChannel(this->m_coef, this->m_buf2, pIn[i + 1]));
+            }
+            return;
+        }
+        double cross_mix = 0.0;
+        double cross_inc = 4.0 / static_cast<double>(iBufferSize);
+        for (int i = 0; i < iBufferSize; i += 2) {
+            double old1 = 0;
+            double old2 = 0;
+            if (!this->m_doStart) {
+                old1 = processChannel(this->m_oldCoef, this->m_oldBuf1, pIn[i]);
+                old2 = processChannel(this->m_oldCoef, this->m_oldBuf2, pIn[i + 1]);
+            } else if (this->m_startFromDry) {
+                old1 = pIn[i];
+                old2 = pIn[i + 1];
+            }
+            const double new1 = processChannel(this->m_coef, this->m_buf1, pIn[i]);
+            const double new2 = processChannel(this->m_coef, this->m_buf2, pIn[i + 1]);
+            if (i < iBufferSize / 2) {
+                pOutput[i] = static_cast<CSAMPLE>(old1);
+                pOutput[i + 1] = static_cast<CSAMPLE>(old2);
+            } else {
+                pOutput[i] = static_cast<CSAMPLE>(
+                        new1 * cross_mix + old1 * (1.0 - cross_mix));
+                pOutput[i + 1] = static_cast<CSAMPLE>(
+                        new2 * cross_mix + old2 * (1.0 - cross_mix));
+                cross_mix += cross_inc;
+            }
+        }
+        this->m_doRamping = false;
+        this->m_doStart = false;
+    }
+
+  private:
+    double processChannel(const double* coef, double* buf, CSAMPLE in) {
+        return this->processSample(coef, buf, static_cast<double>(in));
+    }
+};
+
+void fillTestSignal(CSAMPLE* pBuffer, int iBufferSize, int offset) {
+    for (int i = 0; i < iBufferSize; i += 2) {
+        const double t = static_cast<double>(offset + i / 2) / kSampleRate;
+        pBuffer[i] = static_cast<CSAMPLE>(
+                0.5 * sin(2 * M_PI * 110 * t) + 0.3 * sin(2 * M_PI * 3520 * t));
+        pBuffer[i + 1] = static_cast<CSAMPLE>(
+                0.4 * sin(2 * M_PI * 440 * t) - 0.3 * sin(2 * M_PI * 9000 * t));
+    }
+}
+
+const int kBufferSize = 512;
+
+// Processes the blocks [firstBlock, firstBlock + blockCount) of the test
+// signal through both filters, which must be in the same state.
+template<class Filter>
+void processAndCompare(Filter* pFilter,
+        ScalarReferenceFilter<Filter>* pReference,
+        int firstBlock, int blockCount) {
+    CSAMPLE input[kBufferSize];
+    CSAMPLE output[kBufferSize];
+    CSAMPLE expected[kBufferSize];
+    for (int block = firstBlock; block < firstBlock + blockCount; ++block) {
+        fillTestSignal(input, kBufferSize, block * kBufferSize / 2);
+        pFilter->process(input, output, kBufferSize);
+        pReference->processScalar(input, expected, kBufferSize);
+        for (int i = 0; i < kBufferSize; ++i) {
+            ASSERT_NEAR(expected[i], output[i], 1e-6)
+                    << "block " << block << " sample " << i;
+        }
+    }
+}
+
+// Both filters must be constructed with the same parameters.
+template<class Filter>
+void expectMatchesScalarReference(Filter* pFilter,
+        ScalarReferenceFilter<Filter>* pReference) {
+    pFilter->assumeSettled();
+    pReference->assumeSettled();
+    processAndCompare(pFilter, pReference, 0, 8);
+}
+
 class EngineFilterBiquadTest : public testing::Test {
 };
 
@@ -19,4 +122,145 @@ TEST_F(EngineFilterBiquadTest, fidspecLengthIsLongEnough) {
     ASSERT_TRUE(FIDSPEC_LENGTH > strlen("LsBq/1.2200000000/-12.0000000000"));
 }
 
+TEST_F(EngineFilterBiquadTest, Bessel8LowMatchesScalarFilter) {
+    EngineFilterBessel8Low filter(kSampleRate, 246);
+    ScalarReferenceFilter<EngineFilterBessel8Low> reference(kSampleRate, 246);
+    expectMatchesScalarReference(&filter, &reference);
+}
+
+TEST_F(EngineFilterBiquadTest, Bessel8BandMatchesScalarFilter) {
+    EngineFilterBessel8Band filter(kSampleRate, 246, 2484);
+    ScalarReferenceFilter<EngineFilterBessel8Band> reference(
+            kSampleRate, 246, 2484);
+    expectMatchesScalarReference(&filter, &reference);
+}
+
+TEST_F(EngineFilterBiquadTest, LinkwitzRiley8MatchesScalarFilter) {
+    EngineFilterLinkwitzRiley8Low low(kSampleRate, 2484);
+    ScalarReferenceFilter<EngineFilterLinkwitzRiley8Low> lowReference(
+            kSampleRate, 2484);
+    expectMatchesScalarReference(&low, &lowReference);
+
+    EngineFilterLinkwitzRiley8High high(kSampleRate, 246);
+    ScalarReferenceFilter<EngineFilterLinkwitzRiley8High> highReference(
+            kSampleRate, 246);
+    expectMatchesScalarReference(&high, &highReference);
+}
+
+TEST_F(EngineFilterBiquadTest, Biquad1PeakingMatchesScalarFilter) {
+    EngineFilterBiquad1Peaking filter(kSampleRate, 1000, 1.75);
+    ScalarReferenceFilter<EngineFilterBiquad1Peaking> reference(
+            kSampleRate, 1000, 1.75);
+    filter.setFrequencyCorners(kSampleRate, 1000, 1.75, 6);
+    reference.setFrequencyCorners(kSampleRate, 1000, 1.75, 6);
+    expectMatchesScalarReference(&filter, &reference);
+}
+
+TEST_F(EngineFilterBiquadTest, Bessel8LowCoefficientChangeMatchesScalarFilter) {
+    EngineFilterBessel8Low filter(kSampleRate, 246);
+    ScalarReferenceFilter<EngineFilterBessel8Low> reference(kSampleRate, 246);
+    filter.assumeSettled();
+    reference.assumeSettled();
+    processAndCompare(&filter, &reference, 0, 4);
+
+    // Like turning the knob of a filter effect while playing. The first
+    // block after each change cross fades from the old to the new filter.
+    filter.setFrequencyCorners(kSampleRate, 1000);
+    reference.setFrequencyCorners(kSampleRate, 1000);
+    processAndCompare(&filter, &reference, 4, 3);
+    filter.setFrequencyCorners(kSampleRate, 80);
+    reference.setFrequencyCorners(kSampleRate, 80);
+    processAndCompare(&filter, &reference, 7, 1);
+    filter.setFrequencyCorners(kSampleRate, 5000);
+    reference.setFrequencyCorners(kSampleRate, 5000);
+    processAndCompare(&filter, &reference, 8, 3);
+}
+
+TEST_F(EngineFilterBiquadTest, Biquad1PeakingGainChangeMatchesScalarFilter) {
+    EngineFilterBiquad1Peaking filter(kSampleRate, 1000, 1.75);
+    ScalarReferenceFilter<EngineFilterBiquad1Peaking> reference(
+            kSampleRate, 1000, 1.75);
+    filter.setFrequencyCorners(kSampleRate, 1000, 1.75, 6);
+    reference.setFrequencyCorners(kSampleRate, 1000, 1.75, 6);
+    filter.assumeSettled();
+    reference.assumeSettled();
+    processAndCompare(&filter, &reference, 0, 4);
+
+    filter.setFrequencyCorners(kSampleRate, 1000, 1.75, -12);
+    reference.setFrequencyCorners(kSampleRate, 1000, 1.75, -12);
+    processAndCompare(&filter, &reference, 4, 4);
+}
+
+TEST_F(EngineFilterBiquadTest, LinkwitzRiley8StartFromDryMatchesScalarFilter) {
+    // Not settled, the first block fades in from the dry signal
+    EngineFilterLinkwitzRiley8Low filter(kSampleRate, 2484);
+    ScalarReferenceFilter<EngineFilterLinkwitzRiley8Low> reference(
+            kSampleRate, 2484);
+    filter.setStartFromDry(true);
+    reference.setStartFromDry(true);
+    processAndCompare(&filter, &reference, 0, 4);
+
+    // Paused and started again with new coefficients
+    filter.pauseFilter();
+    reference.pauseFilter();
+    filter.setFrequencyCorners(kSampleRate, 500);
+    reference.setFrequencyCorners(kSampleRate, 500);
+    processAndCompare(&filter, &reference, 4, 4);
+}
+
+CSAMPLE* allocBenchmarkBuffer(int size) {
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    fillTestSignal(buffer, size, 0);
+    return buffer;
+}
+
+static void BM_EngineFilterBessel8LowProcess(benchmark::State& state) {
+    const int size = state.range_x();
+    CSAMPLE* buffer = allocBenchmarkBuffer(size);
+    EngineFilterBessel8Low filter(kSampleRate, 246);
+    filter.assumeSettled();
+    while (state.KeepRunning()) {
+        filter.process(buffer, buffer, size);
+    }
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_EngineFilterBessel8LowProcess)->Range(64, 4096);
+
+static void BM_EngineFilterBessel8LowProcessScalar(benchmark::State& state) {
+    const int size = state.range_x();
+    CSAMPLE* buffer = allocBenchmarkBuffer(size);
+    ScalarReferenceFilter<EngineFilterBessel8Low> filter(kSampleRate, 246);
+    filter.assumeSettled();
+    while (state.KeepRunning()) {
+        filter.processScalar(buffer, buffer, size);
+    }
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_EngineFilterBessel8LowProcessScalar)->Range(64, 4096);
+
+static void BM_EngineFilterBessel8BandProcess(benchmark::State& state) {
+    const int size = state.range_x();
+    CSAMPLE* buffer = allocBenchmarkBuffer(size);
+    EngineFilterBessel8Band filter(kSampleRate, 246, 2484);
+    filter.assumeSettled();
+    while (state.KeepRunning()) {
+        filter.process(buffer, buffer, size);
+    }
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_EngineFilterBessel8BandProcess)->Range(64, 4096);
+
+static void BM_EngineFilterBessel8BandProcessScalar(benchmark::State& state) {
+    const int size = state.range_x();
+    CSAMPLE* buffer = allocBenchmarkBuffer(size);
+    ScalarReferenceFilter<EngineFilterBessel8Band> filter(
+            kSampleRate, 246, 2484);
+    filter.assumeSettled();
+    while (state.KeepRunning()) {
+        filter.processScalar(buffer, buffer, size);
+    }
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_EngineFilterBessel8BandProcessScalar)->Range(64, 4096);
+
 }
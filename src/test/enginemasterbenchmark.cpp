@@ -0,0 +1,200 @@
+#include <benchmark/benchmark.h>
+
+#include <QtDebug>
+#include <QTest>
+
+#include "control/controlobject.h"
+#include "effects/builtin/builtinbackend.h"
+#include "effects/effectrack.h"
+#include "effects/effectsmanager.h"
+#include "engine/enginebuffer.h"
+#include "engine/enginedeck.h"
+#include "engine/enginemicrophone.h"
+#include "engine/enginetalkoverducking.h"
+#include "mixer/deck.h"
+#include "mixer/playermanager.h"
+#include "mixer/sampler.h"
+#include "soundio/soundmanagerutil.h"
+#include "test/signalpathtest.h"
+#include "util/math.h"
+#include "util/memory.h"
+#include "util/performancetimer.h"
+#include "util/samplebuffer.h"
+#include "waveform/guitick.h"
+
+// Benchmarks a complete EngineMaster::process() callback. The engine is set
+// up like in MixxxMainWindow, only without any sound devices:
+//
+//  - all decks and samplers play a looping track that is decoded by their
+//    CachingReader worker threads
+//  - the first effect unit is enabled for all decks
+//  - the first deck is routed to the headphones (PFL)
+//  - a microphone receives a synthetic signal with talkover enabled and
+//    talkover ducking in auto mode
+//
+// Run with: mixxx-test --benchmark --benchmark_filter=BM_EngineMaster
+//
+// The label of each result contains the worst-case callback time, which
+// is what causes xruns on a real sound card.
+
+namespace {
+
+const int kNumSamplers = 4;
+const int kMicrophoneFrames = 2048;
+// Callbacks to process before measuring, so the CachingReaders have read
+// the first chunks and the effects have been set up in the engine.
+const int kWarmUpCallbacks = 200;
+const int kLoadBufferSize = 1024;
+
+// Derives from MixxxTest only for the test config and for the cleanup of
+// the leaked controls when the benchmark iteration is done.
+class EngineMasterBenchmarkSetup : public MixxxTest {
+  public:
+    explicit EngineMasterBenchmarkSetup(int numDecks) {
+        m_pGuiTick = std::make_unique<GuiTick>();
+        m_pChannelHandleFactory = new ChannelHandleFactory();
+        m_pNumDecks = new ControlObject(ConfigKey("[Master]", "num_decks"));
+        m_pEffectsManager = new EffectsManager(NULL, config(), m_pChannelHandleFactory);
+        m_pEngineMaster = new TestEngineMaster(m_pConfig, "[Master]",
+                m_pEffectsManager, m_pChannelHandleFactory, false);
+
+        // Same order as in MixxxMainWindow
+        m_pEffectsManager->addEffectsBackend(new BuiltInBackend(m_pEffectsManager));
+        m_pEffectsManager->setup();
+
+        for (int i = 0; i < numDecks; ++i) {
+            Deck* pDeck = new Deck(NULL, m_pConfig, m_pEngineMaster,
+                    m_pEffectsManager, EngineChannel::CENTER,
+                    PlayerManager::groupForDeck(i));
+            pDeck->setupEqControls();
+            m_players.push_back(pDeck);
+            m_pNumDecks->set(m_pNumDecks->get() + 1);
+        }
+        for (int i = 0; i < kNumSamplers; ++i) {
+            m_players.push_back(new Sampler(NULL, m_pConfig, m_pEngineMaster,
+                    m_pEffectsManager, EngineChannel::CENTER,
+                    PlayerManager::groupForSampler(i)));
+        }
+
+        setupMicrophone();
+        setupEffects(numDecks);
+
+        ControlObject::set(ConfigKey(PlayerManager::groupForDeck(0), "pfl"), 1.0);
+        ControlObject::set(ConfigKey("[Master]", "talkoverDucking"),
+                EngineTalkoverDucking::AUTO);
+
+        const QString trackLocation = QDir::currentPath() + "/src/test/sine-30.wav";
+        for (BaseTrackPlayerImpl* pPlayer : m_players) {
+            loadAndPlayTrack(pPlayer, Track::newTemporary(trackLocation));
+        }
+    }
+
+    ~EngineMasterBenchmarkSetup() override {
+        for (BaseTrackPlayerImpl* pPlayer : m_players) {
+            delete pPlayer;
+        }
+        // Deletes all EngineChannels added to it, including the microphone.
+        delete m_pEngineMaster;
+        delete m_pEffectsManager;
+        delete m_pNumDecks;
+    }
+
+    void TestBody() override {
+    }
+
+    void process(int iBufferSize) {
+        // The sound card delivers a new microphone buffer before each callback
+        m_pMicrophone->receiveBuffer(m_microphoneInput,
+                m_microphoneBuffer.data(), iBufferSize / 2);
+        m_pEngineMaster->process(iBufferSize);
+    }
+
+  private:
+    void setupMicrophone() {
+        const QString group = PlayerManager::groupForMicrophone(0);
+        m_pMicrophone = new EngineMicrophone(
+                m_pEngineMaster->registerChannelGroup(group), m_pEffectsManager);
+        m_pEngineMaster->addChannel(m_pMicrophone);
+        m_microphoneInput = AudioInput(AudioPath::MICROPHONE, 0, 2);
+        m_pMicrophone->onInputConfigured(m_microphoneInput);
+
+        // A 441 Hz sine, loud enough to trigger the ducking
+        m_microphoneBuffer = mixxx::SampleBuffer(kMicrophoneFrames * 2);
+        for (int i = 0; i < kMicrophoneFrames; ++i) {
+            const CSAMPLE sample = 0.5f * static_cast<CSAMPLE>(
+                    sin(2 * M_PI * 441 * i / 44100.0));
+            m_microphoneBuffer[i * 2] = sample;
+            m_microphoneBuffer[i * 2 + 1] = sample;
+        }
+        ControlObject::set(ConfigKey(group, "talkover"), 1.0);
+    }
+
+    void setupEffects(int numDecks) {
+        // Loads the first available effect chain into the first unit.
+        const QString group =
+                StandardEffectRack::formatEffectChainSlotGroupString(0, 0);
+        ControlObject::set(ConfigKey(group, "next_chain"), 1.0);
+        ControlObject::set(ConfigKey(group, "mix"), 1.0);
+        ControlObject::set(ConfigKey(group, "enabled"), 1.0);
+        for (int i = 0; i < numDecks; ++i) {
+            ControlObject::set(ConfigKey(group, QString("group_%1_enable")
+                    .arg(PlayerManager::groupForDeck(i))), 1.0);
+        }
+    }
+
+    void loadAndPlayTrack(BaseTrackPlayerImpl* pPlayer, TrackPointer pTrack) {
+        ControlObject::set(ConfigKey(pPlayer->getGroup(), "repeat"), 1.0);
+        pPlayer->slotLoadTrack(pTrack, true);
+        EngineDeck* pEngineDeck = pPlayer->getEngineDeck();
+        while (!pEngineDeck->getEngineBuffer()->isTrackLoaded()) {
+            m_pEngineMaster->process(kLoadBufferSize);
+            QTest::qSleep(1); // millis
+        }
+    }
+
+    std::unique_ptr<GuiTick> m_pGuiTick;
+    ChannelHandleFactory* m_pChannelHandleFactory;
+    ControlObject* m_pNumDecks;
+    EffectsManager* m_pEffectsManager;
+    TestEngineMaster* m_pEngineMaster;
+    std::vector<BaseTrackPlayerImpl*> m_players;
+    EngineMicrophone* m_pMicrophone;
+    AudioInput m_microphoneInput;
+    mixxx::SampleBuffer m_microphoneBuffer;
+};
+
+// The first argument is the number of decks, the second one the number of
+// frames per callback.
+void EngineMasterArguments(benchmark::internal::Benchmark* b) {
+    for (int numDecks = 2; numDecks <= 4; numDecks += 2) {
+        for (int frames = 64; frames <= 2048; frames *= 2) {
+            b->ArgPair(numDecks, frames);
+        }
+    }
+}
+
+static void BM_EngineMasterProcess(benchmark::State& state) {
+    const int iBufferSize = state.range_y() * 2;
+    EngineMasterBenchmarkSetup setup(state.range_x());
+    for (int i = 0; i < kWarmUpCallbacks; ++i) {
+        setup.process(iBufferSize);
+    }
+
+    PerformanceTimer timer;
+    mixxx::Duration worstCallback;
+    while (state.KeepRunning()) {
+        timer.start();
+        setup.process(iBufferSize);
+        const mixxx::Duration elapsed = timer.elapsed();
+        if (worstCallback < elapsed) {
+            worstCallback = elapsed;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range_y());
+    state.SetLabel(QString("worst %1").arg(
+            worstCallback.formatMicrosWithUnit()).toStdString());
+}
+BENCHMARK(BM_EngineMasterProcess)->Apply(EngineMasterArguments);
+
+}  // namespace
@@ -2,6 +2,10 @@
 #include <gmock/gmock.h>
 
 #include <QtDebug>
+#include <QSet>
+#include <QThread>
+
+#include <vector>
 
 #include "control/controlproxy.h"
 #include "engine/enginechannel.h"
@@ -39,6 +43,57 @@ class EngineChannelMock : public EngineChannel {
     MOCK_METHOD1(postProcess, void(const int iBufferSize));
 };
 
+// A channel that renders a deterministic signal and remembers the threads
+// it has been processed on.
+class EngineChannelSignal : public EngineChannel {
+  public:
+    EngineChannelSignal(const QString& group,
+                        ChannelOrientation defaultOrientation,
+                        EngineMaster* pMaster,
+                        double frequency)
+            : EngineChannel(pMaster->registerChannelGroup(group),
+                            defaultOrientation),
+              m_frequency(frequency),
+              m_frame(0) {
+        setMaster(true);
+    }
+
+    bool isActive() override {
+        return true;
+    }
+
+    void process(CSAMPLE* pOut, const int iBufferSize) override {
+        for (int i = 0; i < iBufferSize / 2; ++i) {
+            const CSAMPLE sample = 0.2f * static_cast<CSAMPLE>(
+                    sin(m_frequency * m_frame++));
+            pOut[i * 2] = sample;
+            pOut[i * 2 + 1] = -sample;
+        }
+        m_threads.insert(QThread::currentThread());
+    }
+
+    void collectFeatures(GroupFeatureState* pGroupFeatures) const override {
+        Q_UNUSED(pGroupFeatures);
+    }
+
+    void postProcess(const int iBufferSize) override {
+        Q_UNUSED(iBufferSize);
+    }
+
+    void rewind() {
+        m_frame = 0;
+    }
+
+    const QSet<QThread*>& threads() const {
+        return m_threads;
+    }
+
+  private:
+    const double m_frequency;
+    int m_frame;
+    QSet<QThread*> m_threads;
+};
+
 class EngineMasterTest : public BaseSignalPathTest {
   protected:
     void assertMasterBufferMatchesGolden(const QString& testName) {
@@ -392,4 +447,62 @@ TEST_F(EngineMasterTest, ThreeChannelPFLOutputWorks) {
     assertHeadphoneBufferMatchesGolden(testName);
 }
 
+TEST_F(EngineMasterTest, ParallelChannelProcessingMatchesSerial) {
+    const int kNumChannels = 7;
+    const int kBufferSize = 1024;
+    const int kNumBuffers = 8;
+
+    std::vector<EngineChannelSignal*> channels;
+    for (int i = 0; i < kNumChannels; ++i) {
+        EngineChannelSignal* pChannel = new EngineChannelSignal(
+                QString("[Test%1]").arg(i + 1),
+                static_cast<EngineChannel::ChannelOrientation>(i % 3),
+                m_pEngineMaster, 0.01 * (i + 1));
+        pChannel->setPfl(i % 2 == 0);
+        m_pEngineMaster->addChannel(pChannel);
+        channels.push_back(pChannel);
+    }
+
+    auto render = [&](std::vector<CSAMPLE>* pMaster,
+                      std::vector<CSAMPLE>* pHeadphone) {
+        for (EngineChannelSignal* pChannel : channels) {
+            pChannel->rewind();
+        }
+        for (int i = 0; i < kNumBuffers; ++i) {
+            m_pEngineMaster->process(kBufferSize);
+            const CSAMPLE* pMasterBuffer = m_pEngineMaster->getMasterBuffer();
+            pMaster->insert(pMaster->end(), pMasterBuffer, pMasterBuffer + kBufferSize);
+            const CSAMPLE* pHeadphoneBuffer = m_pEngineMaster->getHeadphoneBuffer();
+            pHeadphone->insert(pHeadphone->end(), pHeadphoneBuffer, pHeadphoneBuffer + kBufferSize);
+        }
+    };
+
+    // The first callback ramps the channel gains up from zero.
+    m_pEngineMaster->process(kBufferSize);
+
+    std::vector<CSAMPLE> serialMaster, serialHeadphone;
+    render(&serialMaster, &serialHeadphone);
+
+    m_pEngineMaster->setChannelWorkerCount(3);
+    EXPECT_EQ(3, m_pEngineMaster->channelWorkerCount());
+    std::vector<CSAMPLE> parallelMaster, parallelHeadphone;
+    render(&parallelMaster, &parallelHeadphone);
+    m_pEngineMaster->setChannelWorkerCount(0);
+
+    // The results must be sample identical, not just close.
+    EXPECT_TRUE(serialMaster == parallelMaster);
+    EXPECT_TRUE(serialHeadphone == parallelHeadphone);
+
+    // Make sure that the workers did their share.
+    bool processedByWorker = false;
+    for (EngineChannelSignal* pChannel : channels) {
+        for (QThread* pThread : pChannel->threads()) {
+            if (pThread != QThread::currentThread()) {
+                processedByWorker = true;
+            }
+        }
+    }
+    EXPECT_TRUE(processedByWorker);
+}
+
 }  // namespace
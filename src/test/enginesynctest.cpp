@@ -1546,3 +1546,57 @@ TEST_F(EngineSyncTest, QuantizeHotCueActivate) {
 }
 
 
+
+TEST_F(EngineSyncTest, ParallelChannelProcessingKeepsFollowersInSync) {
+    auto pFileBpm1 = std::make_unique<ControlProxy>(m_sGroup1, "file_bpm");
+    pFileBpm1->set(128.0);
+    BeatsPointer pBeats1 = BeatFactory::makeBeatGrid(*m_pTrack1, 128, 0.0);
+    m_pTrack1->setBeats(pBeats1);
+    auto pFileBpm2 = std::make_unique<ControlProxy>(m_sGroup2, "file_bpm");
+    pFileBpm2->set(120.0);
+    BeatsPointer pBeats2 = BeatFactory::makeBeatGrid(*m_pTrack2, 120, 0.0);
+    m_pTrack2->setBeats(pBeats2);
+    auto pFileBpm3 = std::make_unique<ControlProxy>(m_sGroup3, "file_bpm");
+    pFileBpm3->set(124.0);
+    BeatsPointer pBeats3 = BeatFactory::makeBeatGrid(*m_pTrack3, 124, 0.0);
+    m_pTrack3->setBeats(pBeats3);
+
+    // Make Channel2 master to weed out any channel ordering issues.
+    ControlObject::set(ConfigKey(m_sGroup2, "sync_mode"), SYNC_MASTER);
+    ControlObject::set(ConfigKey(m_sGroup1, "sync_mode"), SYNC_FOLLOWER);
+    ControlObject::set(ConfigKey(m_sGroup2, "rate"), getRateSliderValue(1.05));
+
+    m_pEngineMaster->setChannelWorkerCount(2);
+
+    ControlObject::set(ConfigKey(m_sGroup1, "play"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup2, "play"), 1.0);
+    ControlObject::set(ConfigKey(m_sGroup3, "play"), 1.0);
+
+    for (int i = 0; i < 20; ++i) {
+        ProcessBuffer();
+        EXPECT_FLOAT_EQ(126.0, ControlObject::get(ConfigKey(m_sGroup1, "bpm")));
+        EXPECT_FLOAT_EQ(
+                m_pChannel2->getEngineBuffer()->m_pSyncControl->getBeatDistance(),
+                m_pChannel1->getEngineBuffer()->m_pSyncControl->getBeatDistance());
+        // The deck without sync is processed in parallel and keeps its tempo
+        EXPECT_FLOAT_EQ(124.0, ControlObject::get(ConfigKey(m_sGroup3, "bpm")));
+    }
+    EXPECT_GT(ControlObject::get(ConfigKey(m_sGroup1, "beat_distance")), 0.0);
+
+    // Enabling sync while playing queues a request that is processed on
+    // the engine thread with the next callback.
+    ControlObject::set(ConfigKey(m_sGroup3, "sync_enabled"), 1.0);
+    ProcessBuffer();
+    assertIsFollower(m_sGroup3);
+    assertIsMaster(m_sGroup2);
+
+    for (int i = 0; i < 20; ++i) {
+        ProcessBuffer();
+        EXPECT_FLOAT_EQ(126.0, ControlObject::get(ConfigKey(m_sGroup3, "bpm")));
+        EXPECT_FLOAT_EQ(
+                m_pChannel2->getEngineBuffer()->m_pSyncControl->getBeatDistance(),
+                m_pChannel3->getEngineBuffer()->m_pSyncControl->getBeatDistance());
+    }
+
+    m_pEngineMaster->setChannelWorkerCount(0);
+}
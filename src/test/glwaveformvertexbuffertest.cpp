@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <QGLFramebufferObject>
+#include <QGLWidget>
+
+#include <vector>
+
+#include "test/mixxxtest.h"
+#include "test/waveformtestutil.h"
+#include "util/memory.h"
+#include "waveform/renderers/glwaveformvertexbuffer.h"
+#include "waveform/waveform.h"
+
+// Checks the maxima that GLWaveformVertexBuffer uploads for the lines and
+// how many levels it keeps on the GPU. The tests need an OpenGL context
+// with instancing and are skipped if there is none. The bundled gtest
+// can't skip tests, so they fail instead of passing without checking
+// anything. Without a GPU they can be run on Mesa's software rasterizer,
+// e.g. with LIBGL_ALWAYS_SOFTWARE=1 in xvfb-run.
+
+#ifdef GTEST_SKIP
+#define SKIP_WITHOUT_GL(message) GTEST_SKIP() << message
+#else
+#define SKIP_WITHOUT_GL(message) FAIL() << message
+#endif
+
+class GLWaveformVertexBufferTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        Waveform* pWaveform = new Waveform(
+                kSampleRate, kAudioSamples, kVisualSampleRate, -1);
+        fillWaveform(pWaveform);
+        m_pWaveform = ConstWaveformPointer(pWaveform);
+        m_frames = pWaveform->getDataSize() / ChannelCount;
+
+        if (!QGLFormat::hasOpenGL()) {
+            SKIP_WITHOUT_GL("OpenGL is not available");
+        }
+        m_pGLWidget = std::make_unique<QGLWidget>();
+        m_pGLWidget->makeCurrent();
+        m_pFramebuffer = std::make_unique<QGLFramebufferObject>(100, 100);
+        m_pFramebuffer->bind();
+        if (!m_vertexBuffer.init()) {
+            SKIP_WITHOUT_GL("Vertex buffers with instancing are not supported");
+        }
+    }
+
+    void TearDown() override {
+        if (m_pFramebuffer) {
+            m_pFramebuffer->release();
+        }
+    }
+
+    // Sets the completion of the waveform that is being analyzed
+    void setCompletedFrames(int frames) {
+        const_cast<Waveform*>(m_pWaveform.data())->setCompletion(
+                frames * ChannelCount);
+    }
+
+    void drawLines(int frameStep) {
+        m_vertexBuffer.update(m_pWaveform);
+        m_vertexBuffer.program()->bind();
+        m_vertexBuffer.drawLines(0, m_frames, frameStep, Left);
+        m_vertexBuffer.drawLines(0, m_frames, frameStep, Right);
+        m_vertexBuffer.program()->release();
+    }
+
+    bool isResident(int level) const {
+        return m_vertexBuffer.m_levels[level].resident;
+    }
+
+    int levelBytes(int level) const {
+        return m_vertexBuffer.numBlocks(level) * ChannelCount *
+                sizeof(WaveformData);
+    }
+
+    // Compares the uploaded maxima of the completed blocks of a level with
+    // Waveform::getMax()
+    void expectUploadedMaxima(int level, int completedFrames) {
+        ASSERT_TRUE(isResident(level));
+        const int blocks = ((completedFrames - 1) >> level) + 1;
+        std::vector<WaveformData> uploaded(blocks * ChannelCount);
+        QGLBuffer& buffer = m_vertexBuffer.m_levels[level].buffer;
+        buffer.bind();
+        ASSERT_TRUE(buffer.read(0, uploaded.data(),
+                uploaded.size() * sizeof(WaveformData)));
+        buffer.release();
+        for (int block = 0; block < blocks; ++block) {
+            const int frame = block << level;
+            ASSERT_EQ(m_pWaveform->getMax(frame, frame + (1 << level), Left).bands.m_i,
+                    uploaded[block * ChannelCount].m_i) << "at block " << block;
+            ASSERT_EQ(m_pWaveform->getMax(frame, frame + (1 << level), Right).bands.m_i,
+                    uploaded[block * ChannelCount + 1].m_i) << "at block " << block;
+        }
+    }
+
+    ConstWaveformPointer m_pWaveform;
+    int m_frames;
+    std::unique_ptr<QGLWidget> m_pGLWidget;
+    std::unique_ptr<QGLFramebufferObject> m_pFramebuffer;
+    GLWaveformVertexBuffer m_vertexBuffer;
+};
+
+namespace {
+
+TEST_F(GLWaveformVertexBufferTest, UploadsDrawnLevel) {
+    setCompletedFrames(m_frames);
+
+    drawLines(4);
+    EXPECT_FALSE(isResident(0));
+    EXPECT_FALSE(isResident(1));
+    EXPECT_TRUE(isResident(2));
+    EXPECT_FALSE(isResident(3));
+    EXPECT_EQ(levelBytes(2), m_vertexBuffer.residentBytes());
+    expectUploadedMaxima(2, m_frames);
+}
+
+TEST_F(GLWaveformVertexBufferTest, UploadsFramesAsTheyAreAnalyzed) {
+    // Not at the end of a block
+    const int completedFrames = m_frames / 3 + 1;
+    setCompletedFrames(completedFrames);
+    drawLines(1);
+    drawLines(2);
+    expectUploadedMaxima(0, completedFrames);
+    expectUploadedMaxima(1, completedFrames);
+
+    // The resident levels are updated without drawing them
+    setCompletedFrames(m_frames);
+    m_vertexBuffer.update(m_pWaveform);
+    expectUploadedMaxima(0, m_frames);
+    expectUploadedMaxima(1, m_frames);
+}
+
+TEST_F(GLWaveformVertexBufferTest, BoundsResidentLevels) {
+    setCompletedFrames(m_frames);
+
+    // Zooming out
+    drawLines(1);
+    drawLines(2);
+    drawLines(4);
+    drawLines(8);
+    EXPECT_FALSE(isResident(0));
+    EXPECT_FALSE(isResident(1));
+    EXPECT_EQ(levelBytes(2) + levelBytes(3), m_vertexBuffer.residentBytes());
+
+    // Zooming in again releases the least recently drawn level
+    drawLines(8);
+    drawLines(1);
+    EXPECT_TRUE(isResident(0));
+    EXPECT_FALSE(isResident(2));
+    EXPECT_TRUE(isResident(3));
+    EXPECT_EQ(levelBytes(0) + levelBytes(3), m_vertexBuffer.residentBytes());
+    expectUploadedMaxima(0, m_frames);
+}
+
+TEST_F(GLWaveformVertexBufferTest, NewWaveformReleasesLevels) {
+    setCompletedFrames(m_frames);
+    drawLines(1);
+
+    Waveform* pWaveform = new Waveform(
+            kSampleRate, kAudioSamples / 2, kVisualSampleRate, -1);
+    pWaveform->setCompletion(pWaveform->getDataSize());
+    m_vertexBuffer.update(ConstWaveformPointer(pWaveform));
+    EXPECT_EQ(0, m_vertexBuffer.residentBytes());
+}
+
+}  // namespace
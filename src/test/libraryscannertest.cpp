@@ -1,9 +1,80 @@
+#include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include <memory>
+
 #include "test/librarytest.h"
 
+#include "library/scanner/directoryfingerprint.h"
 #include "library/scanner/libraryscanner.h"
+#include "library/scanner/librarywatcher.h"
+#include "sources/soundsourceproxy.h"
+#include "track/trackref.h"
+
+namespace {
+
+const int kScanTimeoutMillis = 60 * 1000;
+
+const char* const kTestFiles[] = {
+    "artist.mp3",
+    "cover-test-png.mp3",
+    "cover-test.flac",
+    "cover-test.ogg",
+    "cover-test.wav",
+};
+
+// Copies the test files into numDirs directories below rootDir, every
+// second one nested in the previous one. Returns the locations.
+QStringList createLibrary(const QDir& rootDir, int numDirs) {
+    const QDir testDataDir(QDir::currentPath() + "/src/test/id3-test-data");
+    QStringList locations;
+    QString dirPath = rootDir.path();
+    for (int i = 0; i < numDirs; ++i) {
+        if (i % 2 == 0) {
+            dirPath = rootDir.path();
+        }
+        dirPath += QString("/dir%1").arg(i);
+        QDir().mkpath(dirPath);
+        for (const char* fileName : kTestFiles) {
+            const QString location = dirPath + "/" + fileName;
+            QFile::copy(testDataDir.filePath(fileName), location);
+            locations.append(TrackRef::location(QFileInfo(location)));
+        }
+    }
+    return locations;
+}
+
+// Returns false if the signal hasn't been emitted in time
+bool waitForSignal(const QObject* pSender, const char* signal) {
+    QEventLoop loop;
+    QTimer timeout;
+    timeout.setSingleShot(true);
+    QObject::connect(pSender, signal, &loop, SLOT(quit()));
+    QObject::connect(&timeout, SIGNAL(timeout()), &loop, SLOT(quit()));
+    timeout.start(kScanTimeoutMillis);
+    loop.exec();
+    return timeout.isActive();
+}
+
+// Returns false if the scan didn't finish in time
+bool waitForScanFinished(LibraryScanner* pScanner) {
+    return waitForSignal(pScanner, SIGNAL(scanFinished()));
+}
+
+bool scanAndWait(LibraryScanner* pScanner) {
+    pScanner->scan();
+    return waitForScanFinished(pScanner);
+}
+
+} // anonymous namespace
 
 class LibraryScannerTest : public LibraryTest {
   protected:
@@ -52,3 +123,399 @@ TEST_F(LibraryScannerTest, ScannerRoundtrip) {
     m_libraryScanner.changeScannerState(LibraryScanner::IDLE);
     EXPECT_EQ(m_libraryScanner.m_state, LibraryScanner::IDLE);
 }
+
+// Scans real files with the scanner thread, which needs its own connection
+// to the database file.
+class LibraryScannerScanTest : public LibraryTest {
+  protected:
+    LibraryScannerScanTest()
+        : LibraryTest(false) {
+        qRegisterMetaType<TrackPointer>("TrackPointer");
+    }
+
+    void SetUp() override {
+        ASSERT_TRUE(m_libraryDir.isValid());
+        collection()->getDirectoryDAO().addDirectory(m_libraryDir.path());
+    }
+
+    void setThreadCount(int threadCount) {
+        config()->setValue(ConfigKey("[Library]", "ScannerThreadCount"),
+                threadCount);
+    }
+
+    // Returns -1 if the location is not in the library
+    int fsDeleted(const QString& location) {
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT fs_deleted FROM track_locations "
+                "WHERE location=:location");
+        query.bindValue(":location", location);
+        if (!query.exec() || !query.next()) {
+            return -1;
+        }
+        return query.value(0).toInt();
+    }
+
+    int countLocations() {
+        QSqlQuery query(dbConnection());
+        if (!query.exec("SELECT COUNT(*) FROM track_locations") ||
+                !query.next()) {
+            return -1;
+        }
+        return query.value(0).toInt();
+    }
+
+    QString artistInLibrary(const QString& location) {
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT library.artist FROM library "
+                "INNER JOIN track_locations "
+                "ON library.location=track_locations.id "
+                "WHERE track_locations.location=:location");
+        query.bindValue(":location", location);
+        if (!query.exec() || !query.next()) {
+            return QString();
+        }
+        return query.value(0).toString();
+    }
+
+    // The metadata that was read by the worker threads must be the same as
+    // when importing the file directly.
+    void expectImportedMetadata(const QString& location) {
+        QSqlQuery query(dbConnection());
+        query.prepare("SELECT library.artist, library.title, "
+                "library.filetype FROM library INNER JOIN track_locations "
+                "ON library.location=track_locations.id "
+                "WHERE track_locations.location=:location");
+        query.bindValue(":location", location);
+        ASSERT_TRUE(query.exec());
+        ASSERT_TRUE(query.next()) << location.toStdString();
+        TrackPointer pTrack = SoundSourceProxy::importTemporaryTrack(
+                QFileInfo(location));
+        ASSERT_TRUE(pTrack);
+        EXPECT_EQ(pTrack->getArtist(), query.value(0).toString());
+        EXPECT_EQ(pTrack->getTitle(), query.value(1).toString());
+        EXPECT_EQ(pTrack->getType(), query.value(2).toString());
+    }
+
+    // A file that is still being written when the watcher scans its
+    // directory is imported by one of the following scans.
+    bool waitForTrackAdded(LibraryScanner* pScanner, const QString& location) {
+        for (int i = 0; i < 10; ++i) {
+            if (!waitForScanFinished(pScanner)) {
+                return false;
+            }
+            if (fsDeleted(location) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    QTemporaryDir m_libraryDir;
+};
+
+TEST_F(LibraryScannerScanTest, ParallelScanAddsAllFiles) {
+    const QStringList locations = createLibrary(m_libraryDir.path(), 8);
+    setThreadCount(4);
+    LibraryScanner scanner(dbConnectionPool(), collection(), config());
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    EXPECT_EQ(locations.size(), countLocations());
+    for (const QString& location : locations) {
+        EXPECT_EQ(0, fsDeleted(location));
+        expectImportedMetadata(location);
+    }
+}
+
+TEST_F(LibraryScannerScanTest, RescanFindsChanges) {
+    QStringList locations = createLibrary(m_libraryDir.path(), 4);
+    setThreadCount(4);
+    LibraryScanner scanner(dbConnectionPool(), collection(), config());
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    // Unchanged
+    ASSERT_TRUE(scanAndWait(&scanner));
+    EXPECT_EQ(locations.size(), countLocations());
+    for (const QString& location : locations) {
+        EXPECT_EQ(0, fsDeleted(location));
+    }
+
+    const QString deletedLocation = locations.takeFirst();
+    ASSERT_TRUE(QFile::remove(deletedLocation));
+    const QString addedLocation = QFileInfo(locations.first()).dir()
+            .filePath("added.mp3");
+    ASSERT_TRUE(QFile::copy(locations.first(), addedLocation));
+    locations.append(TrackRef::location(QFileInfo(addedLocation)));
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    EXPECT_EQ(1, fsDeleted(deletedLocation));
+    EXPECT_EQ(locations.size() + 1, countLocations());
+    for (const QString& location : locations) {
+        EXPECT_EQ(0, fsDeleted(location));
+    }
+    expectImportedMetadata(locations.last());
+}
+
+TEST_F(LibraryScannerScanTest, CanceledScanDeletesNothing) {
+    const QStringList locations = createLibrary(m_libraryDir.path(), 8);
+    setThreadCount(4);
+    LibraryScanner scanner(dbConnectionPool(), collection(), config());
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    // Files that have not been verified when the scan is canceled must not
+    // be marked as deleted.
+    ASSERT_TRUE(QFile::copy(locations.first(),
+            QDir(m_libraryDir.path()).filePath("dir0/added.mp3")));
+    scanner.scan();
+    scanner.slotCancel();
+    ASSERT_TRUE(waitForScanFinished(&scanner));
+
+    for (const QString& location : locations) {
+        EXPECT_EQ(0, fsDeleted(location));
+    }
+}
+
+TEST_F(LibraryScannerScanTest, RescanReimportsModifiedFiles) {
+    const QStringList locations = createLibrary(m_libraryDir.path(), 2);
+    LibraryScanner scanner(dbConnectionPool(), collection(), config());
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    // Replace the file with a file with other tags
+    const QString location = locations.first();
+    const QString otherLocation = locations.at(1);
+    const QString artist = artistInLibrary(location);
+    const QString otherArtist = artistInLibrary(otherLocation);
+    ASSERT_NE(artist, otherArtist);
+    ASSERT_TRUE(QFile::remove(location));
+    ASSERT_TRUE(QFile::copy(otherLocation, location));
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    EXPECT_EQ(otherArtist, artistInLibrary(location));
+    expectImportedMetadata(location);
+    EXPECT_EQ(locations.size(), countLocations());
+    for (const QString& unchangedLocation : locations) {
+        EXPECT_EQ(0, fsDeleted(unchangedLocation));
+    }
+}
+
+TEST_F(LibraryScannerScanTest, RescanRetriesModifiedFileOfLoadedTrack) {
+    const QStringList locations = createLibrary(m_libraryDir.path(), 2);
+    LibraryScanner scanner(dbConnectionPool(), collection(), config());
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    const QString location = locations.first();
+    const QString otherLocation = locations.at(1);
+    const QString artist = artistInLibrary(location);
+    const QString otherArtist = artistInLibrary(otherLocation);
+    ASSERT_NE(artist, otherArtist);
+    TrackDAO& trackDao = collection()->getTrackDAO();
+    TrackPointer pLoadedTrack = trackDao.getTrack(trackDao.getTrackId(location));
+    ASSERT_TRUE(pLoadedTrack);
+
+    // The tags of a loaded track are not read again
+    ASSERT_TRUE(QFile::remove(location));
+    ASSERT_TRUE(QFile::copy(otherLocation, location));
+    ASSERT_TRUE(scanAndWait(&scanner));
+    EXPECT_EQ(artist, artistInLibrary(location));
+
+    // The directory is still changed for the next scan after unloading
+    pLoadedTrack.reset();
+    ASSERT_TRUE(scanAndWait(&scanner));
+    EXPECT_EQ(otherArtist, artistInLibrary(location));
+}
+
+TEST_F(LibraryScannerScanTest, RescanKeepsMetadataOfUnknownFiles) {
+    const QStringList locations = createLibrary(m_libraryDir.path(), 1);
+    LibraryScanner scanner(dbConnectionPool(), collection(), config());
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    // Like a library that was scanned before the modification times were
+    // stored, with a hash that doesn't match and metadata edited in Mixxx
+    QSqlQuery query(dbConnection());
+    ASSERT_TRUE(query.exec("UPDATE track_locations SET fs_modified=NULL"));
+    ASSERT_TRUE(query.exec("UPDATE LibraryHashes SET hash=1"));
+    ASSERT_TRUE(query.exec("UPDATE library SET artist='Edited'"));
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    for (const QString& location : locations) {
+        EXPECT_EQ("Edited", artistInLibrary(location));
+        EXPECT_EQ(0, fsDeleted(location));
+    }
+    ASSERT_TRUE(query.exec(
+            "SELECT COUNT(*) FROM track_locations WHERE fs_modified IS NULL"));
+    ASSERT_TRUE(query.next());
+    EXPECT_EQ(0, query.value(0).toInt());
+}
+
+TEST_F(LibraryScannerScanTest, ScanDirectoriesFindsChanges) {
+    // dir0, dir0/dir1, dir2 and dir2/dir3
+    QStringList locations = createLibrary(m_libraryDir.path(), 4);
+    LibraryScanner scanner(dbConnectionPool(), collection(), config());
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    const QDir libraryDir(m_libraryDir.path());
+    const QString deletedLocation = locations.takeFirst();
+    ASSERT_TRUE(QFile::remove(deletedLocation));
+    const QString addedLocation = libraryDir.filePath("dir2/added.mp3");
+    ASSERT_TRUE(QFile::copy(locations.last(), addedLocation));
+    ASSERT_TRUE(libraryDir.mkpath("dir2/new"));
+    const QString newDirLocation = libraryDir.filePath("dir2/new/new.mp3");
+    ASSERT_TRUE(QFile::copy(locations.last(), newDirLocation));
+    // Not in the scanned directories
+    const QString unscannedLocation =
+            libraryDir.filePath("dir0/dir1/unscanned.mp3");
+    ASSERT_TRUE(QFile::copy(locations.last(), unscannedLocation));
+
+    ASSERT_TRUE(scanner.scanDirectories(QStringList()
+            << libraryDir.filePath("dir0") << libraryDir.filePath("dir2")));
+    ASSERT_TRUE(waitForScanFinished(&scanner));
+
+    EXPECT_EQ(1, fsDeleted(deletedLocation));
+    EXPECT_EQ(0, fsDeleted(TrackRef::location(QFileInfo(addedLocation))));
+    expectImportedMetadata(TrackRef::location(QFileInfo(addedLocation)));
+    EXPECT_EQ(0, fsDeleted(TrackRef::location(QFileInfo(newDirLocation))));
+    EXPECT_EQ(-1, fsDeleted(TrackRef::location(QFileInfo(unscannedLocation))));
+    for (const QString& location : locations) {
+        EXPECT_EQ(0, fsDeleted(location));
+    }
+
+    // The skipped directory is scanned by the next full scan
+    ASSERT_TRUE(scanAndWait(&scanner));
+    EXPECT_EQ(0, fsDeleted(TrackRef::location(QFileInfo(newDirLocation))));
+    EXPECT_EQ(0, fsDeleted(TrackRef::location(QFileInfo(unscannedLocation))));
+}
+
+TEST_F(LibraryScannerScanTest, ScanDirectoriesSkipsFilesBeingWritten) {
+    const QStringList locations = createLibrary(m_libraryDir.path(), 2);
+    LibraryScanner scanner(dbConnectionPool(), collection(), config());
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    const QDir libraryDir(m_libraryDir.path());
+    const QString dirPath = libraryDir.filePath("dir0");
+    const QString addedLocation = libraryDir.filePath("dir0/added.mp3");
+    ASSERT_TRUE(QFile::copy(locations.first(), addedLocation));
+    QStringList incompleteDirPaths;
+    QObject::connect(&scanner, &LibraryScanner::directoriesIncomplete,
+            [&incompleteDirPaths](QStringList dirPaths) {
+                incompleteDirPaths = dirPaths;
+            });
+
+    // The file has just been written
+    ASSERT_TRUE(scanner.scanDirectories(QStringList() << dirPath,
+            kScanTimeoutMillis));
+    ASSERT_TRUE(waitForScanFinished(&scanner));
+    EXPECT_EQ(-1, fsDeleted(TrackRef::location(QFileInfo(addedLocation))));
+    EXPECT_EQ(QStringList() << dirPath, incompleteDirPaths);
+    for (const QString& location : locations) {
+        EXPECT_EQ(0, fsDeleted(location));
+    }
+
+    // The hash of the directory has not been updated
+    incompleteDirPaths.clear();
+    ASSERT_TRUE(scanner.scanDirectories(QStringList() << dirPath));
+    ASSERT_TRUE(waitForScanFinished(&scanner));
+    EXPECT_EQ(0, fsDeleted(TrackRef::location(QFileInfo(addedLocation))));
+    EXPECT_TRUE(incompleteDirPaths.isEmpty());
+}
+
+TEST_F(LibraryScannerScanTest, WatcherScansChangedDirectories) {
+    const QStringList locations = createLibrary(m_libraryDir.path(), 4);
+    LibraryScanner scanner(dbConnectionPool(), collection(), config());
+    ASSERT_TRUE(scanAndWait(&scanner));
+
+    LibraryWatcher watcher(&scanner, 100);
+    ASSERT_TRUE(waitForSignal(&watcher, SIGNAL(directoriesRefreshed())));
+    // The library directory and the 4 directories below it
+    EXPECT_EQ(5, watcher.watchedDirectories().size() +
+            watcher.polledDirectories().size());
+
+    const QDir libraryDir(m_libraryDir.path());
+    const QString addedLocation =
+            libraryDir.filePath("dir0/dir1/added.mp3");
+    ASSERT_TRUE(QFile::copy(locations.first(), addedLocation));
+    ASSERT_TRUE(QFile::remove(locations.last()));
+    ASSERT_TRUE(waitForTrackAdded(&scanner,
+            TrackRef::location(QFileInfo(addedLocation))));
+    EXPECT_EQ(1, fsDeleted(locations.last()));
+
+    // New directories are watched after they have been scanned
+    ASSERT_TRUE(libraryDir.mkpath("dir2/new"));
+    const QString newDirLocation = libraryDir.filePath("dir2/new/new.mp3");
+    ASSERT_TRUE(QFile::copy(locations.first(), newDirLocation));
+    ASSERT_TRUE(waitForTrackAdded(&scanner,
+            TrackRef::location(QFileInfo(newDirLocation))));
+    EXPECT_EQ(6, watcher.watchedDirectories().size() +
+            watcher.polledDirectories().size());
+}
+
+TEST(DirectoryFingerprintTest, DependsOnFilesButNotOnTheirOrder) {
+    const TrackFileStat stat1(1000, 1500000000000LL);
+    const TrackFileStat stat2(2000, 1500000000000LL);
+
+    EXPECT_EQ(0, DirectoryFingerprint().value());
+
+    DirectoryFingerprint fingerprint;
+    fingerprint.addFile("a.mp3", stat1);
+    fingerprint.addFile("b.mp3", stat2);
+    DirectoryFingerprint reversed;
+    reversed.addFile("b.mp3", stat2);
+    reversed.addFile("a.mp3", stat1);
+    EXPECT_EQ(fingerprint.value(), reversed.value());
+
+    // Swapped sizes
+    DirectoryFingerprint swapped;
+    swapped.addFile("a.mp3", stat2);
+    swapped.addFile("b.mp3", stat1);
+    EXPECT_NE(fingerprint.value(), swapped.value());
+
+    DirectoryFingerprint modified;
+    modified.addFile("a.mp3", TrackFileStat(1000, 1500000000001LL));
+    modified.addFile("b.mp3", stat2);
+    EXPECT_NE(fingerprint.value(), modified.value());
+
+    DirectoryFingerprint renamed;
+    renamed.addFile("c.mp3", stat1);
+    renamed.addFile("b.mp3", stat2);
+    EXPECT_NE(fingerprint.value(), renamed.value());
+
+    DirectoryFingerprint removed;
+    removed.addFile("b.mp3", stat2);
+    EXPECT_NE(fingerprint.value(), removed.value());
+}
+
+class LibraryScannerBenchmark : public LibraryTest {
+  public:
+    LibraryScannerBenchmark()
+        : LibraryTest(false) {
+        qRegisterMetaType<TrackPointer>("TrackPointer");
+    }
+
+    void TestBody() override {
+    }
+
+    void scan(const QString& libraryPath, int threadCount) {
+        collection()->getDirectoryDAO().addDirectory(libraryPath);
+        config()->setValue(ConfigKey("[Library]", "ScannerThreadCount"),
+                threadCount);
+        LibraryScanner scanner(dbConnectionPool(), collection(), config());
+        scanAndWait(&scanner);
+    }
+};
+
+// The time of the first scan of a library with 250 files, which is
+// dominated by reading the tags.
+static void BM_LibraryScannerScan(benchmark::State& state) {
+    const int threadCount = state.range_x();
+    QTemporaryDir libraryDir;
+    createLibrary(libraryDir.path(), 50);
+
+    std::unique_ptr<LibraryScannerBenchmark> pBenchmark;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        // A new empty database for every scan
+        pBenchmark.reset();
+        pBenchmark.reset(new LibraryScannerBenchmark());
+        state.ResumeTiming();
+        pBenchmark->scan(libraryDir.path(), threadCount);
+    }
+}
+BENCHMARK(BM_LibraryScannerScan)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
@@ -23,8 +23,11 @@ class LibraryTest : public MixxxTest,
     }
 
   protected:
-    LibraryTest()
-        : m_mixxxDb(config(), kInMemoryDbConnection),
+    // Tests with multiple connections need a database file, each in-memory
+    // connection has its own database. The file is removed with the test
+    // data directory.
+    explicit LibraryTest(bool inMemoryDbConnection = kInMemoryDbConnection)
+        : m_mixxxDb(config(), inMemoryDbConnection),
           m_dbConnectionPooler(m_mixxxDb.connectionPool()),
           m_dbConnection(mixxx::DbConnectionPooled(m_mixxxDb.connectionPool())),
           m_trackCollection(config()) {
@@ -0,0 +1,224 @@
+#ifdef __MAD__
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QUrl>
+
+#include <id3tag.h>
+
+#include <memory>
+#include <vector>
+
+#include "sources/mp3seekindexcache.h"
+#include "sources/soundsourcemp3.h"
+#include "util/samplebuffer.h"
+
+using mixxx::Mp3SeekIndex;
+using mixxx::Mp3SeekIndexCache;
+using mixxx::SoundSourceMp3;
+
+namespace {
+
+const QDir kTestDir(QDir::current().absoluteFilePath("src/test/id3-test-data"));
+
+// The MP3 frames of a test file without its tags, so they can be repeated
+// to make longer files.
+QByteArray readMp3Frames(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QByteArray data = file.readAll();
+    const long tagSize = id3_tag_query(
+            reinterpret_cast<const id3_byte_t*>(data.constData()),
+            data.size());
+    if (tagSize > 0) {
+        data.remove(0, tagSize);
+    }
+    if (data.size() >= 128 && data.mid(data.size() - 128, 3) == "TAG") {
+        data.chop(128);
+    }
+    return data;
+}
+
+bool writeMp3File(const QString& fileName, int repetitions) {
+    const QByteArray frames =
+            readMp3Frames(kTestDir.filePath("cover-test-png.mp3"));
+    QFile file(fileName);
+    if (frames.isEmpty() || !file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    for (int i = 0; i < repetitions; ++i) {
+        file.write(frames);
+    }
+    return true;
+}
+
+std::unique_ptr<SoundSourceMp3> openMp3(const QString& fileName) {
+    std::unique_ptr<SoundSourceMp3> pSource(
+            new SoundSourceMp3(QUrl::fromLocalFile(fileName)));
+    if (pSource->open(mixxx::AudioSource::OpenMode::Strict) !=
+            mixxx::AudioSource::OpenResult::Succeeded) {
+        pSource.reset();
+    }
+    return pSource;
+}
+
+std::vector<CSAMPLE> readFrames(SoundSourceMp3* pSource,
+        mixxx::IndexRange frameIndexRange) {
+    mixxx::SampleBuffer buffer(
+            pSource->frames2samples(frameIndexRange.length()));
+    const auto sampleFrames = pSource->readSampleFrames(
+            mixxx::WritableSampleFrames(frameIndexRange,
+                    mixxx::SampleBuffer::WritableSlice(buffer)));
+    EXPECT_EQ(frameIndexRange, sampleFrames.frameIndexRange());
+    return std::vector<CSAMPLE>(buffer.data(),
+            buffer.data() + buffer.size());
+}
+
+class Mp3SeekIndexCacheTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_cacheDir.isValid());
+        ASSERT_TRUE(m_fileDir.isValid());
+        Mp3SeekIndexCache::setCachePath(m_cacheDir.path());
+        m_fileName = QDir(m_fileDir.path()).filePath("test.mp3");
+    }
+
+    void TearDown() override {
+        Mp3SeekIndexCache::setCachePath(QString());
+    }
+
+    QString indexFilePath() const {
+        return Mp3SeekIndexCache::filePath(m_cacheDir.path(), m_fileName);
+    }
+
+    QTemporaryDir m_cacheDir;
+    QTemporaryDir m_fileDir;
+    QString m_fileName;
+};
+
+TEST_F(Mp3SeekIndexCacheTest, CachedIndexMatchesScan) {
+    ASSERT_TRUE(writeMp3File(m_fileName, 3));
+    Mp3SeekIndex index;
+    EXPECT_FALSE(Mp3SeekIndexCache::load(m_fileName, &index));
+
+    std::unique_ptr<SoundSourceMp3> pScanned = openMp3(m_fileName);
+    ASSERT_TRUE(pScanned);
+    ASSERT_TRUE(QFile::exists(indexFilePath()));
+    ASSERT_TRUE(Mp3SeekIndexCache::load(m_fileName, &index));
+    EXPECT_EQ(pScanned->sampleRate(), index.sampleRate);
+    EXPECT_EQ(pScanned->channelCount(), index.channelCount);
+    EXPECT_EQ(pScanned->bitrate(), index.bitrate);
+    EXPECT_EQ(pScanned->frameLength(), index.frameLength);
+    EXPECT_EQ(0, index.seekFrames.front().frameIndex);
+
+    std::unique_ptr<SoundSourceMp3> pCached = openMp3(m_fileName);
+    ASSERT_TRUE(pCached);
+    EXPECT_EQ(pScanned->frameIndexRange(), pCached->frameIndexRange());
+    EXPECT_EQ(pScanned->sampleRate(), pCached->sampleRate());
+    EXPECT_EQ(pScanned->channelCount(), pCached->channelCount());
+    EXPECT_EQ(pScanned->bitrate(), pCached->bitrate());
+
+    // Backwards to seek every time
+    const SINT frameLength = pScanned->frameLength();
+    for (int i = 6; i >= 0; --i) {
+        const auto range = mixxx::IndexRange::forward(
+                frameLength * i / 7, 1000);
+        ASSERT_EQ(readFrames(pScanned.get(), range),
+                readFrames(pCached.get(), range));
+    }
+}
+
+TEST_F(Mp3SeekIndexCacheTest, ModifiedFileIsScannedAgain) {
+    ASSERT_TRUE(writeMp3File(m_fileName, 2));
+    SINT frameLength;
+    {
+        std::unique_ptr<SoundSourceMp3> pSource = openMp3(m_fileName);
+        ASSERT_TRUE(pSource);
+        frameLength = pSource->frameLength();
+    }
+
+    ASSERT_TRUE(writeMp3File(m_fileName, 4));
+    Mp3SeekIndex index;
+    EXPECT_FALSE(Mp3SeekIndexCache::load(m_fileName, &index));
+    std::unique_ptr<SoundSourceMp3> pSource = openMp3(m_fileName);
+    ASSERT_TRUE(pSource);
+    EXPECT_EQ(2 * frameLength, pSource->frameLength());
+    ASSERT_TRUE(Mp3SeekIndexCache::load(m_fileName, &index));
+    EXPECT_EQ(2 * frameLength, index.frameLength);
+}
+
+TEST_F(Mp3SeekIndexCacheTest, InvalidIndexIsReplaced) {
+    ASSERT_TRUE(writeMp3File(m_fileName, 1));
+    ASSERT_TRUE(openMp3(m_fileName));
+    {
+        QFile file(indexFilePath());
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        file.write(QByteArray(16, 'x'));
+    }
+    Mp3SeekIndex index;
+    EXPECT_FALSE(Mp3SeekIndexCache::load(m_fileName, &index));
+
+    ASSERT_TRUE(openMp3(m_fileName));
+    EXPECT_TRUE(Mp3SeekIndexCache::load(m_fileName, &index));
+}
+
+TEST_F(Mp3SeekIndexCacheTest, MismatchingIndexIsReplaced) {
+    ASSERT_TRUE(writeMp3File(m_fileName, 1));
+    ASSERT_TRUE(openMp3(m_fileName));
+    Mp3SeekIndex index;
+    ASSERT_TRUE(Mp3SeekIndexCache::load(m_fileName, &index));
+
+    // Like a file that has been changed without changing its size and
+    // modification time
+    Mp3SeekIndex shiftedIndex = index;
+    for (auto& seekFrame : shiftedIndex.seekFrames) {
+        seekFrame.byteOffset += 1;
+    }
+    Mp3SeekIndexCache::store(m_fileName, shiftedIndex);
+
+    std::unique_ptr<SoundSourceMp3> pSource = openMp3(m_fileName);
+    ASSERT_TRUE(pSource);
+    EXPECT_EQ(index.frameLength, pSource->frameLength());
+    Mp3SeekIndex storedIndex;
+    ASSERT_TRUE(Mp3SeekIndexCache::load(m_fileName, &storedIndex));
+    ASSERT_EQ(index.seekFrames.size(), storedIndex.seekFrames.size());
+    for (size_t i = 0; i < index.seekFrames.size(); ++i) {
+        EXPECT_EQ(index.seekFrames[i].byteOffset,
+                storedIndex.seekFrames[i].byteOffset);
+    }
+}
+
+// The time until a long file can be played, without and with a cached
+// index. The file is in the page cache, so on a slow disk the difference is
+// much larger.
+static void BM_SoundSourceMp3Open(benchmark::State& state) {
+    const bool warm = state.range_x();
+    QTemporaryDir cacheDir;
+    QTemporaryDir fileDir;
+    const QString fileName = QDir(fileDir.path()).filePath("mix.mp3");
+    writeMp3File(fileName, 100);
+    Mp3SeekIndexCache::setCachePath(cacheDir.path());
+    openMp3(fileName);
+
+    while (state.KeepRunning()) {
+        if (!warm) {
+            state.PauseTiming();
+            QFile::remove(Mp3SeekIndexCache::filePath(cacheDir.path(),
+                    fileName));
+            state.ResumeTiming();
+        }
+        benchmark::DoNotOptimize(openMp3(fileName));
+    }
+    Mp3SeekIndexCache::setCachePath(QString());
+}
+BENCHMARK(BM_SoundSourceMp3Open)->Arg(0)->Arg(1);
+
+}  // namespace
+
+#endif // __MAD__
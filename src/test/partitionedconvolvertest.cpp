@@ -0,0 +1,263 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <QSemaphore>
+
+#include "effects/builtin/convolutionreverbeffect.h"
+#include "effects/builtin/convolutionworker.h"
+#include "effects/builtin/partitionedconvolver.h"
+#include "util/fft.h"
+
+namespace {
+
+const int kSampleRate = 44100;
+
+std::vector<CSAMPLE> makeNoise(SINT size, quint32 seed) {
+    std::vector<CSAMPLE> noise(size);
+    for (CSAMPLE& sample : noise) {
+        seed = seed * 1664525 + 1013904223;
+        sample = static_cast<CSAMPLE>(seed) / 4294967296.0f - 0.5f;
+    }
+    return noise;
+}
+
+// Signals the test after each pass of the worker
+class TailClient : public ConvolutionWorker::Client {
+  public:
+    explicit TailClient(PartitionedConvolver* pConvolver)
+            : m_pConvolver(pConvolver) {
+    }
+
+    void processConvolutionWork() override {
+        m_pConvolver->processTail();
+        m_semaProcessed.release();
+    }
+
+    bool waitUntilProcessed() {
+        return m_semaProcessed.tryAcquire(1, 10000); // millis
+    }
+
+  private:
+    PartitionedConvolver* m_pConvolver;
+    QSemaphore m_semaProcessed;
+};
+
+class PartitionedConvolverTest : public testing::Test {
+  protected:
+    enum class Tail {
+        // The tail is never computed and all tail blocks are dropped
+        NONE,
+        // processTail() is called between the callbacks
+        BETWEEN_CALLBACKS,
+        // The ConvolutionWorker computes the tail between the callbacks
+        WORKER,
+    };
+
+    // Convolves frames of stereo noise in buffers of bufferFrames and
+    // compares the result with the direct convolution.
+    void expectMatchesDirectConvolution(SINT impulseFrames, SINT bufferFrames,
+            Tail tail) {
+        const std::vector<CSAMPLE> impulseLeft = makeNoise(impulseFrames, 1);
+        const std::vector<CSAMPLE> impulseRight = makeNoise(impulseFrames, 2);
+        PartitionedConvolver convolver(impulseLeft, impulseRight, bufferFrames);
+        EXPECT_EQ(impulseFrames, convolver.impulseFrames());
+
+        const SINT frames = impulseFrames + 3000;
+        const std::vector<CSAMPLE> input = makeNoise(frames * 2, 3);
+        std::vector<CSAMPLE> output(frames * 2);
+
+        std::shared_ptr<ConvolutionWorker> pWorker;
+        TailClient client(&convolver);
+        if (tail == Tail::WORKER) {
+            pWorker = ConvolutionWorker::acquireTailWorker();
+            pWorker->addClient(&client);
+        }
+        for (SINT frame = 0; frame < frames; frame += bufferFrames) {
+            const SINT numFrames = std::min(bufferFrames, frames - frame);
+            // In place like in the effect
+            std::copy(&input[frame * 2], &input[(frame + numFrames) * 2],
+                    &output[frame * 2]);
+            if (!convolver.process(&output[frame * 2], &output[frame * 2],
+                    numFrames)) {
+                continue;
+            }
+            if (tail == Tail::BETWEEN_CALLBACKS) {
+                convolver.processTail();
+            } else if (tail == Tail::WORKER) {
+                pWorker->wake();
+                ASSERT_TRUE(client.waitUntilProcessed());
+            }
+        }
+        if (pWorker) {
+            pWorker->removeClient(&client);
+        }
+
+        // Without the tail only the head of the impulse response is applied
+        SINT appliedFrames = impulseFrames;
+        if (tail == Tail::NONE) {
+            appliedFrames = std::min(impulseFrames,
+                    PartitionedConvolver::kPartitionFrames *
+                            convolver.enginePartitions());
+            if (appliedFrames < impulseFrames) {
+                EXPECT_LT(0, convolver.droppedTailBlocks());
+            }
+        } else {
+            EXPECT_EQ(0, convolver.droppedTailBlocks());
+        }
+
+        // Spot checks, the direct convolution is slow
+        for (SINT frame = 0; frame < frames; frame += 97) {
+            double left = 0;
+            double right = 0;
+            for (SINT i = 0; i < appliedFrames && i <= frame; ++i) {
+                left += impulseLeft[i] * input[(frame - i) * 2];
+                right += impulseRight[i] * input[(frame - i) * 2 + 1];
+            }
+            ASSERT_NEAR(left, output[frame * 2], 1e-4) << "frame " << frame;
+            ASSERT_NEAR(right, output[frame * 2 + 1], 1e-4) << "frame " << frame;
+        }
+    }
+};
+
+TEST_F(PartitionedConvolverTest, FftMatchesDft) {
+    for (int size : {4, 16, 256}) {
+        mixxx::RealFft fft(size);
+        ASSERT_EQ(size / 2 + 1, fft.bins());
+        const std::vector<CSAMPLE> signal = makeNoise(size, size);
+        std::vector<CSAMPLE> real(fft.bins());
+        std::vector<CSAMPLE> imag(fft.bins());
+        fft.forward(signal.data(), real.data(), imag.data());
+        for (int bin = 0; bin < fft.bins(); ++bin) {
+            double expectedReal = 0;
+            double expectedImag = 0;
+            for (int i = 0; i < size; ++i) {
+                expectedReal += signal[i] * cos(-2 * M_PI * bin * i / size);
+                expectedImag += signal[i] * sin(-2 * M_PI * bin * i / size);
+            }
+            EXPECT_NEAR(expectedReal, real[bin], 1e-5);
+            EXPECT_NEAR(expectedImag, imag[bin], 1e-5);
+        }
+
+        std::vector<CSAMPLE> roundTrip(size);
+        fft.inverse(real.data(), imag.data(), roundTrip.data());
+        for (int i = 0; i < size; ++i) {
+            EXPECT_NEAR(signal[i], roundTrip[i], 1e-6);
+        }
+    }
+}
+
+TEST_F(PartitionedConvolverTest, ShortImpulseResponse) {
+    // Only the direct convolution of the first partition
+    expectMatchesDirectConvolution(1, 64, Tail::NONE);
+    expectMatchesDirectConvolution(100, 1024, Tail::NONE);
+}
+
+TEST_F(PartitionedConvolverTest, ImpulseResponseWithoutTail) {
+    const SINT head = PartitionedConvolver::kPartitionFrames *
+            PartitionedConvolver::kMinEnginePartitions;
+    expectMatchesDirectConvolution(129, 300, Tail::NONE);
+    expectMatchesDirectConvolution(head, 1, Tail::NONE);
+    expectMatchesDirectConvolution(head, 1024, Tail::NONE);
+}
+
+TEST_F(PartitionedConvolverTest, LateTailBlocksAreDropped) {
+    const SINT head = PartitionedConvolver::kPartitionFrames *
+            PartitionedConvolver::kMinEnginePartitions;
+    expectMatchesDirectConvolution(head + 1, 1024, Tail::NONE);
+    expectMatchesDirectConvolution(3 * head + 50, 256, Tail::NONE);
+}
+
+TEST_F(PartitionedConvolverTest, TailComputedBetweenCallbacks) {
+    const SINT head = PartitionedConvolver::kPartitionFrames *
+            PartitionedConvolver::kMinEnginePartitions;
+    expectMatchesDirectConvolution(3 * head + 50, 1, Tail::BETWEEN_CALLBACKS);
+    expectMatchesDirectConvolution(3 * head + 50, 256, Tail::BETWEEN_CALLBACKS);
+    // Buffers that are larger than the minimum head
+    expectMatchesDirectConvolution(3 * head + 50, 5000, Tail::BETWEEN_CALLBACKS);
+    expectMatchesDirectConvolution(3 * head + 50, 8192, Tail::BETWEEN_CALLBACKS);
+}
+
+TEST_F(PartitionedConvolverTest, TailComputedByWorker) {
+    const SINT head = PartitionedConvolver::kPartitionFrames *
+            PartitionedConvolver::kMinEnginePartitions;
+    expectMatchesDirectConvolution(3 * head + 50, 64, Tail::WORKER);
+    expectMatchesDirectConvolution(3 * head + 50, 1024, Tail::WORKER);
+    expectMatchesDirectConvolution(3 * head + 50, 5000, Tail::WORKER);
+}
+
+TEST_F(PartitionedConvolverTest, ImpulseResponseDecays) {
+    const std::vector<CSAMPLE> impulse =
+            ConvolutionReverbEffect::makeImpulseResponse(2.0, 0.5, kSampleRate, 1);
+    ASSERT_EQ(2 * kSampleRate, static_cast<int>(impulse.size()));
+    double energy = 0;
+    double lastTenthEnergy = 0;
+    for (size_t i = 0; i < impulse.size(); ++i) {
+        energy += impulse[i] * impulse[i];
+        if (i >= impulse.size() * 9 / 10) {
+            lastTenthEnergy += impulse[i] * impulse[i];
+        }
+    }
+    EXPECT_NEAR(1.0, energy, 1e-3);
+    // The last tenth has decayed by more than 50 dB
+    EXPECT_LT(lastTenthEnergy, 1e-5);
+}
+
+// The CPU time of the engine thread per callback, with the tail computed
+// in time by the worker. The tail is computed outside of the timing here.
+// Buffers larger than the minimum head make the head longer.
+static void BM_ConvolutionReverbCallback(benchmark::State& state) {
+    const double impulseLength = state.range_x() / 1000.0;
+    const SINT bufferFrames = state.range_y();
+    PartitionedConvolver convolver(
+            ConvolutionReverbEffect::makeImpulseResponse(
+                    impulseLength, 0.5, kSampleRate, 1),
+            ConvolutionReverbEffect::makeImpulseResponse(
+                    impulseLength, 0.5, kSampleRate, 2),
+            bufferFrames);
+    const std::vector<CSAMPLE> input = makeNoise(bufferFrames * 2, 3);
+    std::vector<CSAMPLE> output(bufferFrames * 2);
+
+    while (state.KeepRunning()) {
+        convolver.process(input.data(), output.data(), bufferFrames);
+        state.PauseTiming();
+        convolver.processTail();
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_ConvolutionReverbCallback)
+        ->ArgPair(500, 256)->ArgPair(1000, 256)->ArgPair(2000, 256)
+        ->ArgPair(5000, 256)->ArgPair(10000, 256)
+        ->ArgPair(500, 1024)->ArgPair(1000, 1024)->ArgPair(2000, 1024)
+        ->ArgPair(5000, 1024)->ArgPair(10000, 1024)
+        ->ArgPair(2000, 8192)->ArgPair(10000, 8192);
+
+// The CPU time of the worker per callback, which grows with the length of
+// the impulse response.
+static void BM_ConvolutionReverbWorker(benchmark::State& state) {
+    const double impulseLength = state.range_x() / 1000.0;
+    const SINT bufferFrames = state.range_y();
+    PartitionedConvolver convolver(
+            ConvolutionReverbEffect::makeImpulseResponse(
+                    impulseLength, 0.5, kSampleRate, 1),
+            ConvolutionReverbEffect::makeImpulseResponse(
+                    impulseLength, 0.5, kSampleRate, 2),
+            bufferFrames);
+    const std::vector<CSAMPLE> input = makeNoise(bufferFrames * 2, 3);
+    std::vector<CSAMPLE> output(bufferFrames * 2);
+
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        convolver.process(input.data(), output.data(), bufferFrames);
+        state.ResumeTiming();
+        convolver.processTail();
+    }
+}
+BENCHMARK(BM_ConvolutionReverbWorker)
+        ->ArgPair(500, 1024)->ArgPair(1000, 1024)->ArgPair(2000, 1024)
+        ->ArgPair(5000, 1024)->ArgPair(10000, 1024);
+
+}  // namespace
@@ -0,0 +1,403 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "util/sample.h"
+#include "util/samplekernels.h"
+
+namespace {
+
+const SampleKernels::Isa kVectorIsas[] = {
+    SampleKernels::Isa::SSE2,
+    SampleKernels::Isa::AVX2,
+    SampleKernels::Isa::AVX512,
+    SampleKernels::Isa::NEON,
+};
+
+// Covers the vector loops as well as the scalar tails of all vector widths
+const SINT kTestSizes[] = {
+    0, 2, 4, 6, 8, 14, 16, 18, 30, 32, 34, 62, 64, 66, 1022, 1024, 1026,
+};
+
+class SampleKernelsTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        m_pScalar = SampleKernels::forIsa(SampleKernels::Isa::Scalar);
+        ASSERT_NE(nullptr, m_pScalar);
+        for (SampleKernels::Isa isa: kVectorIsas) {
+            const SampleKernels* pKernels = SampleKernels::forIsa(isa);
+            if (pKernels) {
+                m_vectorKernels.push_back(pKernels);
+            }
+        }
+    }
+
+    // Includes samples outside of [-1, 1] for the clamping and clipping
+    // kernels.
+    static std::vector<CSAMPLE> makeSignal(SINT size, int seed) {
+        std::vector<CSAMPLE> signal(size);
+        for (SINT i = 0; i < size; ++i) {
+            signal[i] = static_cast<CSAMPLE>(((i * 37 + seed * 11) % 101) - 50) / 40.0f;
+        }
+        return signal;
+    }
+
+    // The compiler may contract a multiplication and an addition into a
+    // fused multiply-add for the instruction sets that support it. The
+    // results may differ in the last bits, which is significant for
+    // samples close to zero.
+    static void expectEqual(const std::vector<CSAMPLE>& expected,
+            const std::vector<CSAMPLE>& actual, const SampleKernels* pKernels) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_NEAR(expected[i], actual[i], 1e-5)
+                    << pKernels->name << " at index " << i
+                    << " of " << expected.size();
+        }
+    }
+
+    const SampleKernels* m_pScalar;
+    std::vector<const SampleKernels*> m_vectorKernels;
+};
+
+TEST_F(SampleKernelsTest, activeIsAvailable) {
+    const SampleKernels& active = SampleKernels::active();
+    EXPECT_EQ(&active, SampleKernels::forIsa(active.isa));
+}
+
+TEST_F(SampleKernelsTest, applyRampingGain) {
+    for (const SampleKernels* pKernels: m_vectorKernels) {
+        for (SINT size: kTestSizes) {
+            std::vector<CSAMPLE> expected = makeSignal(size, 1);
+            std::vector<CSAMPLE> actual = expected;
+            const CSAMPLE_GAIN delta = size > 0 ? 0.7f / (size / 2) : 0.0f;
+            m_pScalar->applyRampingGain(expected.data(), 0.2f, delta, size);
+            pKernels->applyRampingGain(actual.data(), 0.2f, delta, size);
+            expectEqual(expected, actual, pKernels);
+        }
+    }
+}
+
+TEST_F(SampleKernelsTest, addWithRampingGain) {
+    for (const SampleKernels* pKernels: m_vectorKernels) {
+        for (SINT size: kTestSizes) {
+            const std::vector<CSAMPLE> src = makeSignal(size, 2);
+            std::vector<CSAMPLE> expected = makeSignal(size, 3);
+            std::vector<CSAMPLE> actual = expected;
+            const CSAMPLE_GAIN delta = size > 0 ? -0.5f / (size / 2) : 0.0f;
+            m_pScalar->addWithRampingGain(expected.data(), src.data(), 1.0f, delta, size);
+            pKernels->addWithRampingGain(actual.data(), src.data(), 1.0f, delta, size);
+            expectEqual(expected, actual, pKernels);
+        }
+    }
+}
+
+TEST_F(SampleKernelsTest, copyWithGain) {
+    for (const SampleKernels* pKernels: m_vectorKernels) {
+        for (int channels = SampleKernels::kMinCopyChannels;
+                channels <= SampleKernels::kMaxCopyChannels; ++channels) {
+            for (SINT size: kTestSizes) {
+                std::vector<std::vector<CSAMPLE>> signals;
+                std::vector<const CSAMPLE*> pSrc;
+                std::vector<CSAMPLE_GAIN> gain;
+                for (int c = 0; c < channels; ++c) {
+                    signals.push_back(makeSignal(size, c));
+                    gain.push_back(0.1f * (c + 1));
+                }
+                for (int c = 0; c < channels; ++c) {
+                    pSrc.push_back(signals[c].data());
+                }
+                std::vector<CSAMPLE> expected(size);
+                std::vector<CSAMPLE> actual(size);
+                m_pScalar->copyWithGain[channels](
+                        expected.data(), pSrc.data(), gain.data(), size);
+                pKernels->copyWithGain[channels](
+                        actual.data(), pSrc.data(), gain.data(), size);
+                expectEqual(expected, actual, pKernels);
+            }
+        }
+    }
+}
+
+TEST_F(SampleKernelsTest, copyWithRampingGain) {
+    for (const SampleKernels* pKernels: m_vectorKernels) {
+        for (int channels = SampleKernels::kMinCopyChannels;
+                channels <= SampleKernels::kMaxCopyChannels; ++channels) {
+            for (SINT size: kTestSizes) {
+                std::vector<std::vector<CSAMPLE>> signals;
+                std::vector<const CSAMPLE*> pSrc;
+                std::vector<CSAMPLE_GAIN> startGain;
+                std::vector<CSAMPLE_GAIN> gainDelta;
+                for (int c = 0; c < channels; ++c) {
+                    signals.push_back(makeSignal(size, c));
+                    startGain.push_back(0.1f * (c + 1));
+                    gainDelta.push_back(size > 0 ? 0.05f * c / (size / 2) : 0.0f);
+                }
+                for (int c = 0; c < channels; ++c) {
+                    pSrc.push_back(signals[c].data());
+                }
+                std::vector<CSAMPLE> expected(size);
+                std::vector<CSAMPLE> actual(size);
+                m_pScalar->copyWithRampingGain[channels](expected.data(),
+                        pSrc.data(), startGain.data(), gainDelta.data(), size);
+                pKernels->copyWithRampingGain[channels](actual.data(),
+                        pSrc.data(), startGain.data(), gainDelta.data(), size);
+                expectEqual(expected, actual, pKernels);
+            }
+        }
+    }
+}
+
+TEST_F(SampleKernelsTest, sumAbsPerChannel) {
+    for (const SampleKernels* pKernels: m_vectorKernels) {
+        for (SINT size: kTestSizes) {
+            std::vector<CSAMPLE> signal = makeSignal(size, 4);
+            // Only the left channel clips
+            for (SINT i = 1; i < size; i += 2) {
+                signal[i] *= 0.5f;
+            }
+            CSAMPLE expectedL, expectedR, actualL, actualR;
+            const int expectedClipped = m_pScalar->sumAbsPerChannel(
+                    &expectedL, &expectedR, signal.data(), size);
+            const int actualClipped = pKernels->sumAbsPerChannel(
+                    &actualL, &actualR, signal.data(), size);
+            EXPECT_EQ(expectedClipped, actualClipped) << pKernels->name;
+            // The summation order differs
+            EXPECT_NEAR(expectedL, actualL, 1e-3) << pKernels->name;
+            EXPECT_NEAR(expectedR, actualR, 1e-3) << pKernels->name;
+        }
+    }
+}
+
+TEST_F(SampleKernelsTest, copyClampBuffer) {
+    for (const SampleKernels* pKernels: m_vectorKernels) {
+        for (SINT size = 0; size < 70; ++size) {
+            const std::vector<CSAMPLE> src = makeSignal(size, 5);
+            std::vector<CSAMPLE> expected(size);
+            std::vector<CSAMPLE> actual(size);
+            m_pScalar->copyClampBuffer(expected.data(), src.data(), size);
+            pKernels->copyClampBuffer(actual.data(), src.data(), size);
+            expectEqual(expected, actual, pKernels);
+        }
+    }
+}
+
+TEST_F(SampleKernelsTest, interleaveAndDeinterleave) {
+    for (const SampleKernels* pKernels: m_vectorKernels) {
+        for (SINT frames = 0; frames < 70; ++frames) {
+            const std::vector<CSAMPLE> left = makeSignal(frames, 6);
+            const std::vector<CSAMPLE> right = makeSignal(frames, 7);
+            std::vector<CSAMPLE> expected(frames * 2);
+            std::vector<CSAMPLE> actual(frames * 2);
+            m_pScalar->interleaveBuffer(
+                    expected.data(), left.data(), right.data(), frames);
+            pKernels->interleaveBuffer(
+                    actual.data(), left.data(), right.data(), frames);
+            expectEqual(expected, actual, pKernels);
+
+            std::vector<CSAMPLE> actualLeft(frames);
+            std::vector<CSAMPLE> actualRight(frames);
+            pKernels->deinterleaveBuffer(
+                    actualLeft.data(), actualRight.data(), actual.data(), frames);
+            expectEqual(left, actualLeft, pKernels);
+            expectEqual(right, actualRight, pKernels);
+        }
+    }
+}
+
+TEST_F(SampleKernelsTest, convertS16ToFloat32) {
+    for (const SampleKernels* pKernels: m_vectorKernels) {
+        for (SINT size = 0; size < 70; ++size) {
+            std::vector<SAMPLE> src(size);
+            for (SINT i = 0; i < size; ++i) {
+                src[i] = static_cast<SAMPLE>((i * 4099) % 65536 - 32768);
+            }
+            std::vector<CSAMPLE> expected(size);
+            std::vector<CSAMPLE> actual(size);
+            m_pScalar->convertS16ToFloat32(expected.data(), src.data(), size);
+            pKernels->convertS16ToFloat32(actual.data(), src.data(), size);
+            expectEqual(expected, actual, pKernels);
+        }
+    }
+}
+
+// The benchmarks compare the instruction sets against each other. The
+// first argument is the SampleKernels::Isa, the second one the number
+// of samples.
+void SampleKernelsArguments(benchmark::internal::Benchmark* b) {
+    const SampleKernels::Isa isas[] = {
+        SampleKernels::Isa::Scalar,
+        SampleKernels::Isa::SSE2,
+        SampleKernels::Isa::AVX2,
+        SampleKernels::Isa::AVX512,
+        SampleKernels::Isa::NEON,
+    };
+    for (SampleKernels::Isa isa: isas) {
+        if (!SampleKernels::forIsa(isa)) {
+            continue;
+        }
+        for (int size = 32; size <= 4096; size *= 2) {
+            b->ArgPair(static_cast<int>(isa), size);
+        }
+    }
+}
+
+const SampleKernels& benchmarkKernels(benchmark::State& state) {
+    const SampleKernels* pKernels = SampleKernels::forIsa(
+            static_cast<SampleKernels::Isa>(state.range_x()));
+    state.SetLabel(pKernels->name);
+    return *pKernels;
+}
+
+static void BM_ApplyRampingGain(benchmark::State& state) {
+    const SampleKernels& kernels = benchmarkKernels(state);
+    SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.5f, size);
+
+    while (state.KeepRunning()) {
+        kernels.applyRampingGain(buffer, 1.0f, -0.0001f, size);
+    }
+
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_ApplyRampingGain)->Apply(SampleKernelsArguments);
+
+static void BM_AddWithRampingGain(benchmark::State& state) {
+    const SampleKernels& kernels = benchmarkKernels(state);
+    SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 0.5f, size);
+
+    while (state.KeepRunning()) {
+        kernels.addWithRampingGain(buffer, buffer2, 1.0f, -0.0001f, size);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+}
+BENCHMARK(BM_AddWithRampingGain)->Apply(SampleKernelsArguments);
+
+template<int N, bool ramping>
+static void BM_CopyNWithGain(benchmark::State& state) {
+    const SampleKernels& kernels = benchmarkKernels(state);
+    SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffers[N];
+    CSAMPLE_GAIN gain[N];
+    CSAMPLE_GAIN gainDelta[N];
+    for (int i = 0; i < N; ++i) {
+        buffers[i] = SampleUtil::alloc(size);
+        SampleUtil::fill(buffers[i], 0.5f, size);
+        gain[i] = 1.1f;
+        gainDelta[i] = 0.0001f;
+    }
+
+    while (state.KeepRunning()) {
+        if (ramping) {
+            kernels.copyWithRampingGain[N](buffer, buffers, gain, gainDelta, size);
+        } else {
+            kernels.copyWithGain[N](buffer, buffers, gain, size);
+        }
+    }
+
+    SampleUtil::free(buffer);
+    for (int i = 0; i < N; ++i) {
+        SampleUtil::free(buffers[i]);
+    }
+}
+BENCHMARK_TEMPLATE2(BM_CopyNWithGain, 4, false)->Apply(SampleKernelsArguments);
+BENCHMARK_TEMPLATE2(BM_CopyNWithGain, 8, false)->Apply(SampleKernelsArguments);
+BENCHMARK_TEMPLATE2(BM_CopyNWithGain, 4, true)->Apply(SampleKernelsArguments);
+BENCHMARK_TEMPLATE2(BM_CopyNWithGain, 8, true)->Apply(SampleKernelsArguments);
+
+static void BM_SumAbsPerChannel(benchmark::State& state) {
+    const SampleKernels& kernels = benchmarkKernels(state);
+    SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.5f, size);
+    CSAMPLE fAbsL, fAbsR;
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+                kernels.sumAbsPerChannel(&fAbsL, &fAbsR, buffer, size));
+    }
+
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_SumAbsPerChannel)->Apply(SampleKernelsArguments);
+
+static void BM_CopyClampBuffer(benchmark::State& state) {
+    const SampleKernels& kernels = benchmarkKernels(state);
+    SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer, 0.0f, size);
+    CSAMPLE* buffer2 = SampleUtil::alloc(size);
+    SampleUtil::fill(buffer2, 1.5f, size);
+
+    while (state.KeepRunning()) {
+        kernels.copyClampBuffer(buffer, buffer2, size);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(buffer2);
+}
+BENCHMARK(BM_CopyClampBuffer)->Apply(SampleKernelsArguments);
+
+static void BM_InterleaveBuffer(benchmark::State& state) {
+    const SampleKernels& kernels = benchmarkKernels(state);
+    SINT frames = state.range_y() / 2;
+    CSAMPLE* buffer = SampleUtil::alloc(frames * 2);
+    SampleUtil::fill(buffer, 0.0f, frames * 2);
+    CSAMPLE* left = SampleUtil::alloc(frames);
+    SampleUtil::fill(left, 0.5f, frames);
+    CSAMPLE* right = SampleUtil::alloc(frames);
+    SampleUtil::fill(right, -0.5f, frames);
+
+    while (state.KeepRunning()) {
+        kernels.interleaveBuffer(buffer, left, right, frames);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(left);
+    SampleUtil::free(right);
+}
+BENCHMARK(BM_InterleaveBuffer)->Apply(SampleKernelsArguments);
+
+static void BM_DeinterleaveBuffer(benchmark::State& state) {
+    const SampleKernels& kernels = benchmarkKernels(state);
+    SINT frames = state.range_y() / 2;
+    CSAMPLE* buffer = SampleUtil::alloc(frames * 2);
+    SampleUtil::fill(buffer, 0.5f, frames * 2);
+    CSAMPLE* left = SampleUtil::alloc(frames);
+    CSAMPLE* right = SampleUtil::alloc(frames);
+
+    while (state.KeepRunning()) {
+        kernels.deinterleaveBuffer(left, right, buffer, frames);
+    }
+
+    SampleUtil::free(buffer);
+    SampleUtil::free(left);
+    SampleUtil::free(right);
+}
+BENCHMARK(BM_DeinterleaveBuffer)->Apply(SampleKernelsArguments);
+
+static void BM_ConvertS16ToFloat32(benchmark::State& state) {
+    const SampleKernels& kernels = benchmarkKernels(state);
+    SINT size = state.range_y();
+    CSAMPLE* buffer = SampleUtil::alloc(size);
+    std::vector<SAMPLE> src(size, 12345);
+
+    while (state.KeepRunning()) {
+        kernels.convertS16ToFloat32(buffer, src.data(), size);
+    }
+
+    SampleUtil::free(buffer);
+}
+BENCHMARK(BM_ConvertS16ToFloat32)->Apply(SampleKernelsArguments);
+
+}  // namespace
@@ -5,7 +5,10 @@
 #include "test/librarytest.h"
 
 #include "library/searchqueryparser.h"
+#include "library/trackcolumnstore.h"
+#include "track/keyutils.h"
 #include "util/assert.h"
+#include "util/db/dbconnection.h"
 
 class SearchQueryParserTest : public LibraryTest {
   protected:
@@ -21,7 +24,156 @@ class SearchQueryParserTest : public LibraryTest {
         return pTrack ? pTrack->getId() : TrackId();
     }
 
+    // A table with the columns of m_storeColumns for comparing the
+    // evaluation of queries in a TrackColumnStore with SQL
+    void createStoreTable() {
+        m_storeColumns << "id" << "artist" << "title" << "year" << "bpm" << "key_id";
+        QSqlQuery query(dbConnection());
+        ASSERT_TRUE(query.exec(
+                "CREATE TEMPORARY TABLE store_tracks (id INTEGER PRIMARY KEY, "
+                "artist TEXT, title TEXT, year varchar(16), bpm float, "
+                "key_id INTEGER)"));
+    }
+
+    void setStoreTrack(TrackColumnStore* pStore, int id,
+            QVariant artist, QVariant title, QVariant year, QVariant bpm,
+            QVariant keyId) {
+        QSqlQuery query(dbConnection());
+        query.prepare("INSERT OR REPLACE INTO store_tracks "
+                "VALUES (:id, :artist, :title, :year, :bpm, :key_id)");
+        query.bindValue(":id", id);
+        query.bindValue(":artist", artist);
+        query.bindValue(":title", title);
+        query.bindValue(":year", year);
+        query.bindValue(":bpm", bpm);
+        query.bindValue(":key_id", keyId);
+        ASSERT_TRUE(query.exec());
+
+        // Store the values as they are read by BaseTrackCache
+        ASSERT_TRUE(query.exec(QString(
+                "SELECT %1 FROM store_tracks WHERE id=%2").arg(
+                        m_storeColumns.join(","), QString::number(id))));
+        ASSERT_TRUE(query.next());
+        QVector<QVariant> record(m_storeColumns.size());
+        for (int i = 0; i < record.size(); ++i) {
+            record[i] = query.value(i);
+        }
+        pStore->setRecord(TrackId(id), record);
+    }
+
+    void removeStoreTrack(TrackColumnStore* pStore, int id) {
+        QSqlQuery query(dbConnection());
+        ASSERT_TRUE(query.exec(QString(
+                "DELETE FROM store_tracks WHERE id=%1").arg(id)));
+        pStore->removeRecord(TrackId(id));
+    }
+
+    QList<TrackId> selectFromSql(const QueryNode& query, const QString& orderBy) {
+        QString filter = query.toSql();
+        if (!filter.isEmpty()) {
+            filter.prepend("WHERE ");
+        }
+        QSqlQuery sqlQuery(dbConnection());
+        EXPECT_TRUE(sqlQuery.exec(QString("SELECT id FROM store_tracks %1 %2")
+                .arg(filter, orderBy)));
+        QList<TrackId> trackIds;
+        while (sqlQuery.next()) {
+            trackIds << TrackId(sqlQuery.value(0));
+        }
+        return trackIds;
+    }
+
+    QList<TrackId> selectFromStore(TrackColumnStore* pStore, const QueryNode& query,
+            const QList<TrackColumnStore::SortColumn>& sortColumns) {
+        EXPECT_TRUE(query.prepareStoreMatch(pStore));
+        // Rows in the order of the ids like the table scan of SQLite
+        QVector<int> rows;
+        for (int id = 1; id <= kMaxStoreTrackId; ++id) {
+            const int row = pStore->row(TrackId(id));
+            if (row < 0) {
+                continue;
+            }
+            const StoreMatch match = query.matchStore(*pStore, row);
+            if (match == StoreMatch::Match || match == StoreMatch::Unconstrained) {
+                rows.append(row);
+            }
+        }
+        pStore->sortRows(&rows, sortColumns, KeyUtils::OPEN_KEY);
+        QList<TrackId> trackIds;
+        for (int row: rows) {
+            trackIds << pStore->trackId(row);
+        }
+        return trackIds;
+    }
+
+    void expectStoreMatchesSql(TrackColumnStore* pStore) {
+        QStringList searchColumns;
+        searchColumns << "artist" << "title";
+        const QStringList searches = QStringList()
+                << "" << "bey" << "BEY" << "-bey" << "beyonce" << "ce" << "e"
+                << "-ce" << "50%" << "a_c" << "%" << "élan" << "zzzz"
+                << "ce crazy" << "title:love" << "artist:\"daft punk\""
+                << "year:>2000" << "year:<2000" << "year:1990-2000"
+                << "-year:2000" << "bpm:>=120" << "-bpm:<100" << "bpm:120-130"
+                << "key:Am" << "-key:Am" << "~key:Am" << "bey -year:2008";
+        for (const auto& search: searches) {
+            auto pQuery(m_parser.parseQuery(search, searchColumns, ""));
+            EXPECT_EQ(selectFromSql(*pQuery, ""),
+                      selectFromStore(pStore, *pQuery,
+                              QList<TrackColumnStore::SortColumn>()))
+                    << search.toStdString();
+        }
+
+        QString keySort("CASE key_id ");
+        for (int key = 0; key <= 24; ++key) {
+            keySort.append(QString("WHEN %1 THEN %2 ").arg(
+                    QString::number(key),
+                    QString::number(KeyUtils::keyToCircleOfFifthsOrder(
+                            static_cast<mixxx::track::io::key::ChromaticKey>(key),
+                            KeyUtils::OPEN_KEY))));
+        }
+        keySort.append("END");
+
+        typedef TrackColumnStore::SortColumn SortColumn;
+        const int id = m_storeColumns.indexOf("id");
+        const QList<QPair<QStringList, QList<SortColumn>>> sorts = {
+            {{"lower(title)"}, {SortColumn(m_storeColumns.indexOf("title"),
+                    ColumnCache::SORT_NOCASE, Qt::AscendingOrder)}},
+            {{"artist DESC"}, {SortColumn(m_storeColumns.indexOf("artist"),
+                    ColumnCache::SORT_DEFAULT, Qt::DescendingOrder)}},
+            {{"cast(year as integer) DESC"}, {SortColumn(m_storeColumns.indexOf("year"),
+                    ColumnCache::SORT_INTEGER, Qt::DescendingOrder)}},
+            {{"year"}, {SortColumn(m_storeColumns.indexOf("year"),
+                    ColumnCache::SORT_DEFAULT, Qt::AscendingOrder)}},
+            {{"bpm", "lower(artist) DESC"}, {
+                    SortColumn(m_storeColumns.indexOf("bpm"),
+                            ColumnCache::SORT_DEFAULT, Qt::AscendingOrder),
+                    SortColumn(m_storeColumns.indexOf("artist"),
+                            ColumnCache::SORT_NOCASE, Qt::DescendingOrder)}},
+            {{keySort}, {SortColumn(m_storeColumns.indexOf("key_id"),
+                    ColumnCache::SORT_KEY, Qt::AscendingOrder)}},
+        };
+        auto pQuery(m_parser.parseQuery("", searchColumns, ""));
+        for (const auto& sort: sorts) {
+            // Break ties by id for a well-defined order
+            QStringList orderBy;
+            for (const auto& field: sort.first) {
+                orderBy << mixxx::DbConnection::collateLexicographically(field);
+            }
+            orderBy << "id";
+            QList<SortColumn> sortColumns = sort.second;
+            sortColumns << SortColumn(id, ColumnCache::SORT_DEFAULT, Qt::AscendingOrder);
+
+            EXPECT_EQ(selectFromSql(*pQuery, "ORDER BY " + orderBy.join(", ")),
+                      selectFromStore(pStore, *pQuery, sortColumns))
+                    << orderBy.join(", ").toStdString();
+        }
+    }
+
+    static const int kMaxStoreTrackId = 20;
+
     SearchQueryParser m_parser;
+    QStringList m_storeColumns;
 
     // The expected query to be returned by CrateFilterNode
     const QString m_crateFilterQuery =
@@ -919,3 +1071,55 @@ TEST_F(SearchQueryParserTest, CrateFilterWithCrateFilterAndNegation){
                             ") AND (NOT (" + m_crateFilterQuery.arg(searchTermB) + "))"),
                  qPrintable(pQueryB->toSql()));
 }
+
+TEST_F(SearchQueryParserTest, StoreMatchesSql) {
+    createStoreTable();
+    TrackColumnStore store(m_storeColumns);
+    using namespace mixxx::track::io::key;
+    setStoreTrack(&store, 1, "Beyoncé", "Halo", "2008", 80.0, C_MAJOR);
+    setStoreTrack(&store, 2, "Daft Punk", "One More Time", "2000", 123.0, C_MAJOR);
+    setStoreTrack(&store, 3, QVariant(), "Untitled", QVariant(), QVariant(), QVariant());
+    setStoreTrack(&store, 4, "beyonce", "Crazy in Love", "2003", 99.0, A_MINOR);
+    setStoreTrack(&store, 5, "Aphex Twin", "Xtal", "1992", 120.0, E_MINOR);
+    setStoreTrack(&store, 6, "50% Off", "a_c", "999", 120.5, INVALID);
+    setStoreTrack(&store, 7, "", "", "", 0.0, INVALID);
+    setStoreTrack(&store, 8, "ÉLAN", "élan vital", "1999", 140.0, A_MINOR);
+    setStoreTrack(&store, 9, "Daft Punk", "Around the World", "1997", 121.0, 30);
+    expectStoreMatchesSql(&store);
+
+    // The indexes built above are updated incrementally
+    setStoreTrack(&store, 2, "Daft Punk", "One More Time", "2001", 123.0, A_MINOR);
+    setStoreTrack(&store, 3, "Crazy Frog", QVariant(), "2005", 140.0, QVariant());
+    removeStoreTrack(&store, 5);
+    setStoreTrack(&store, 10, "Zebra", "Bey", "2000", 60.0, E_MINOR);
+    setStoreTrack(&store, 11, "Beyoncé", "Halo", "2008", 80.0, C_MAJOR);
+    expectStoreMatchesSql(&store);
+}
+
+TEST_F(SearchQueryParserTest, StoreMatchNullValues) {
+    createStoreTable();
+    TrackColumnStore store(m_storeColumns);
+    setStoreTrack(&store, 1, QVariant(), "Title", QVariant(), QVariant(), QVariant());
+    const int row = store.row(TrackId(1));
+
+    QStringList searchColumns;
+    searchColumns << "artist";
+    // NULL LIKE '%a%' is neither true nor false and so is its negation
+    auto pQuery(m_parser.parseQuery("a", searchColumns, ""));
+    ASSERT_TRUE(pQuery->prepareStoreMatch(&store));
+    EXPECT_EQ(StoreMatch::Unknown, pQuery->matchStore(store, row));
+    pQuery = m_parser.parseQuery("-a", searchColumns, "");
+    ASSERT_TRUE(pQuery->prepareStoreMatch(&store));
+    EXPECT_EQ(StoreMatch::Unknown, pQuery->matchStore(store, row));
+
+    // key_id IS <key> is false for NULL
+    pQuery = m_parser.parseQuery("-key:Am", searchColumns, "");
+    ASSERT_TRUE(pQuery->prepareStoreMatch(&store));
+    EXPECT_EQ(StoreMatch::Match, pQuery->matchStore(store, row));
+
+    // Columns that are not in the store and SQL filters need SQL
+    pQuery = m_parser.parseQuery("genre:rock", searchColumns, "");
+    EXPECT_FALSE(pQuery->prepareStoreMatch(&store));
+    pQuery = m_parser.parseQuery("a", searchColumns, "id > 0");
+    EXPECT_FALSE(pQuery->prepareStoreMatch(&store));
+}
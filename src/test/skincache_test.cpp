@@ -0,0 +1,108 @@
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+
+#include "test/mixxxtest.h"
+#include "skin/skincache.h"
+
+namespace {
+
+class SkinCacheTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_cacheDir.isValid());
+        ASSERT_TRUE(m_skinDir.isValid());
+        writeSkinFile("skin.xml", "<skin></skin>");
+    }
+
+    void TearDown() override {
+        SkinCache::close();
+    }
+
+    void writeSkinFile(const QString& name, const QByteArray& contents) {
+        QFile file(QDir(m_skinDir.path()).filePath(name));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(contents);
+    }
+
+    bool openCache(const QString& colorScheme, double scaleFactor) {
+        return SkinCache::open(m_cacheDir.path(), m_skinDir.path(),
+                colorScheme, scaleFactor);
+    }
+
+    static QImage testImage() {
+        QImage image(7, 5, QImage::Format_ARGB32);
+        for (int y = 0; y < image.height(); ++y) {
+            for (int x = 0; x < image.width(); ++x) {
+                image.setPixel(x, y, qRgba(x * 30, y * 50, x + y, 255 - x));
+            }
+        }
+        return image;
+    }
+
+    QTemporaryDir m_cacheDir;
+    QTemporaryDir m_skinDir;
+};
+
+TEST_F(SkinCacheTest, ClosedCacheIgnoresImages) {
+    SkinCache::storeImage("image", testImage());
+    EXPECT_TRUE(SkinCache::loadImage("image").isNull());
+}
+
+TEST_F(SkinCacheTest, StoredImageIsLoadedOnWarmStart) {
+    EXPECT_FALSE(openCache("Scheme", 1.0));
+    EXPECT_TRUE(SkinCache::loadImage("image").isNull());
+    SkinCache::storeImage("image", testImage());
+
+    EXPECT_TRUE(openCache("Scheme", 1.0));
+    QImage image = SkinCache::loadImage("image");
+    EXPECT_EQ(testImage(), image);
+    EXPECT_TRUE(SkinCache::loadImage("other image").isNull());
+}
+
+TEST_F(SkinCacheTest, ChangedSkinStartsCold) {
+    EXPECT_FALSE(openCache("Scheme", 1.0));
+    SkinCache::storeImage("image", testImage());
+
+    writeSkinFile("style.qss", "WWidget {}");
+    EXPECT_FALSE(openCache("Scheme", 1.0));
+    EXPECT_TRUE(SkinCache::loadImage("image").isNull());
+
+    // Only the cache of the current skin files is kept
+    EXPECT_EQ(1, QDir(m_cacheDir.path()).entryList(
+            QDir::Dirs | QDir::NoDotAndDotDot).size());
+}
+
+TEST_F(SkinCacheTest, ColorSchemeAndScaleFactorAreKeys) {
+    EXPECT_FALSE(openCache("Scheme", 1.0));
+    SkinCache::storeImage("image", testImage());
+
+    EXPECT_FALSE(openCache("Other scheme", 1.0));
+    EXPECT_TRUE(SkinCache::loadImage("image").isNull());
+    EXPECT_FALSE(openCache("Scheme", 2.0));
+    EXPECT_TRUE(SkinCache::loadImage("image").isNull());
+}
+
+TEST_F(SkinCacheTest, InvalidFileIsIgnored) {
+    EXPECT_FALSE(openCache("Scheme", 1.0));
+    SkinCache::storeImage("image", testImage());
+    QDir cacheDir(m_cacheDir.path());
+    const QString directory = cacheDir.entryList(
+            QDir::Dirs | QDir::NoDotAndDotDot).first();
+    QDir imageDir(cacheDir.filePath(directory));
+    const QString imagePath = imageDir.filePath(imageDir.entryList(QDir::Files).first());
+
+    // Truncate the scan lines
+    QFile file(imagePath);
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(file.resize(file.size() - 1));
+    file.close();
+    EXPECT_TRUE(SkinCache::loadImage("image").isNull());
+
+    // An image that is stored again replaces the invalid file
+    SkinCache::storeImage("image", testImage());
+    EXPECT_EQ(testImage(), SkinCache::loadImage("image"));
+}
+
+}  // namespace
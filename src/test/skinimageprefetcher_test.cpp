@@ -0,0 +1,171 @@
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+
+#include <benchmark/benchmark.h>
+
+#include "test/mixxxtest.h"
+#include "skin/imgloader.h"
+#include "skin/skincache.h"
+#include "skin/skincontext.h"
+#include "skin/skinimageprefetcher.h"
+#include "util/memory.h"
+
+namespace {
+
+const QByteArray kSvg =
+        "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"8\" height=\"6\">"
+        "<rect x=\"1\" y=\"1\" width=\"4\" height=\"3\" fill=\"#ff8000\"/>"
+        "</svg>";
+
+class SkinImagePrefetcherTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_skinDir.isValid());
+        m_pContext = std::make_unique<SkinContext>(config(),
+                QDir(m_skinDir.path()).filePath("skin.xml"));
+        m_pContext->setSkinBasePath(m_skinDir.path());
+    }
+
+    void TearDown() override {
+        SkinCache::close();
+        SkinImagePrefetcher::clear();
+    }
+
+    void writeSkinFile(const QString& name, const QByteArray& contents) {
+        QFile file(QDir(m_skinDir.path()).filePath(name));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(contents);
+    }
+
+    QStringList findImagePaths() {
+        QStringList paths;
+        for (const PixmapSource& source :
+                SkinImagePrefetcher::findImageSources(
+                        m_skinDir.path(), *m_pContext)) {
+            paths.append(source.getPath());
+        }
+        paths.sort();
+        return paths;
+    }
+
+    bool openCache() {
+        return SkinCache::open(m_cacheDir.path(), m_skinDir.path(),
+                "Scheme", 1.0);
+    }
+
+    QTemporaryDir m_cacheDir;
+    QTemporaryDir m_skinDir;
+    std::unique_ptr<SkinContext> m_pContext;
+};
+
+TEST_F(SkinImagePrefetcherTest, FindsImagesOfSkinAndTemplates) {
+    writeSkinFile("knob.svg", kSvg);
+    writeSkinFile("button.svg", kSvg);
+    writeSkinFile("skin.xml",
+            "<skin><Knob><Pixmap>knob.svg</Pixmap>"
+            "<Background><Path> knob.svg </Path></Background></Knob>"
+            "<Template src=\"skin:deck.xml\"/></skin>");
+    writeSkinFile("deck.xml",
+            "<Template><PushButton><State>"
+            "<Pressed>button.svg</Pressed>"
+            "<Unpressed><Variable name=\"image\"/>.svg</Unpressed>"
+            "<Unpressed>missing.svg</Unpressed>"
+            "</State></PushButton></Template>");
+
+    EXPECT_EQ(QStringList() << "skin:button.svg" << "skin:knob.svg",
+            findImagePaths());
+}
+
+TEST_F(SkinImagePrefetcherTest, CachedImageFileNamesAreNotParsedAgain) {
+    writeSkinFile("knob.svg", kSvg);
+    writeSkinFile("button.svg", kSvg);
+    writeSkinFile("skin.xml", "<skin><Pixmap>knob.svg</Pixmap></skin>");
+    openCache();
+    EXPECT_EQ(QStringList() << "skin:knob.svg", findImagePaths());
+
+    // Still the cached file names while the cache of the previous skin
+    // files is open
+    writeSkinFile("skin.xml", "<skin><Pixmap>button.svg</Pixmap></skin>");
+    EXPECT_EQ(QStringList() << "skin:knob.svg", findImagePaths());
+
+    // The changed skin file is part of the fingerprint of the cache
+    openCache();
+    EXPECT_EQ(QStringList() << "skin:button.svg", findImagePaths());
+}
+
+TEST_F(SkinImagePrefetcherTest, PrefetchedSvgMatchesRenderedSvg) {
+    writeSkinFile("knob.svg", kSvg);
+    const PixmapSource source(m_pContext->makeSkinPath("knob.svg"));
+    EXPECT_TRUE(SkinImagePrefetcher::getImage(source, 2.0).isNull());
+
+    SkinImagePrefetcher::prefetch(QList<PixmapSource>() << source, 2.0,
+            QSharedPointer<ImgSource>(new ImgLoader()));
+    const QImage image = SkinImagePrefetcher::getImage(source, 2.0);
+    EXPECT_EQ(QSize(16, 12), image.size());
+    EXPECT_EQ(SkinImagePrefetcher::renderSvg(source, 2.0), image);
+
+    // Only the prefetched scale factor is available
+    EXPECT_TRUE(SkinImagePrefetcher::getImage(source, 1.0).isNull());
+
+    SkinImagePrefetcher::clear();
+    EXPECT_TRUE(SkinImagePrefetcher::getImage(source, 2.0).isNull());
+}
+
+TEST_F(SkinImagePrefetcherTest, PrefetchesBitmapsWithLoader) {
+    QImage bitmap(4, 3, QImage::Format_ARGB32);
+    bitmap.fill(qRgba(10, 20, 30, 255));
+    ASSERT_TRUE(bitmap.save(QDir(m_skinDir.path()).filePath("led.png")));
+    const PixmapSource source(m_pContext->makeSkinPath("led.png"));
+
+    SkinImagePrefetcher::prefetch(QList<PixmapSource>() << source, 1.0,
+            QSharedPointer<ImgSource>(new ImgLoader()));
+    const QImage image = SkinImagePrefetcher::getImage(source, 1.0);
+    EXPECT_EQ(bitmap.size(), image.size());
+    EXPECT_EQ(qRgba(10, 20, 30, 255), image.pixel(2, 1));
+}
+
+class SkinImagePrefetcherBenchmark : public SkinImagePrefetcherTest {
+  public:
+    void TestBody() override {
+    }
+
+    void createSkin(int fileCount) {
+        SetUp();
+        for (int i = 0; i < fileCount; ++i) {
+            QByteArray xml = "<Template>";
+            for (int j = 0; j < 20; ++j) {
+                const QByteArray image =
+                        QString("image%1.svg").arg(i * 20 + j).toLatin1();
+                writeSkinFile(image, kSvg);
+                xml += "<PushButton><State><Number>0</Number><Pressed>" +
+                        image + "</Pressed></State></PushButton>";
+            }
+            xml += "</Template>";
+            writeSkinFile(QString("template%1.xml").arg(i), xml);
+        }
+    }
+
+    using SkinImagePrefetcherTest::findImagePaths;
+    using SkinImagePrefetcherTest::openCache;
+};
+
+// The time to find the images of a skin with 50 templates, without and with
+// the file names from the SkinCache of a previous start.
+static void BM_SkinImagePrefetcherFindImageSources(benchmark::State& state) {
+    const bool warm = state.range_x();
+    SkinImagePrefetcherBenchmark skin;
+    skin.createSkin(50);
+    if (warm) {
+        skin.openCache();
+    }
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(skin.findImagePaths());
+    }
+    SkinCache::close();
+}
+BENCHMARK(BM_SkinImagePrefetcherFindImageSources)->Arg(0)->Arg(1);
+
+}  // namespace
@@ -0,0 +1,274 @@
+#ifdef __VINYLCONTROL__
+
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "vinylcontrol/timecodelutcache.h"
+
+namespace {
+
+const unsigned int kSampleRate = 44100;
+
+// Synthesizes the stereo signal of a timecode record that is played
+// forwards at reference speed. The secondary channel (left) is a sine, the
+// primary channel (right) lags it by 90 degrees and carries one bit of the
+// LFSR sequence per cycle in the height of its positive peak. Only
+// definitions without flags, like the Serato records, are supported.
+class TimecodeSignal {
+  public:
+    TimecodeSignal(const timecode_def* pDef, unsigned int sampleRate)
+            : m_pDef(pDef),
+              m_phaseIncrement(static_cast<double>(pDef->resolution) / sampleRate),
+              m_phase(0.0),
+              m_cycle(0),
+              m_code(pDef->seed) {
+    }
+
+    void generate(short* pPcm, size_t nFrames) {
+        for (size_t i = 0; i < nFrames; ++i) {
+            // The bit of the next code enters the bitstream of xwax at
+            // the most significant bit.
+            const bool bit = (m_code >> (m_pDef->bits - 1)) & 0x1;
+            const double primaryPeak = bit ? 16000.0 : 10000.0;
+            pPcm[i * 2] = static_cast<short>(
+                    16000.0 * sin(2 * M_PI * m_phase));
+            pPcm[i * 2 + 1] = static_cast<short>(
+                    primaryPeak * cos(2 * M_PI * m_phase));
+            m_phase += m_phaseIncrement;
+            if (m_phase >= 1.0) {
+                m_phase -= 1.0;
+                ++m_cycle;
+                m_code = next(m_code);
+            }
+        }
+    }
+
+    // The position on the record in cycles
+    unsigned int cycle() const {
+        return m_cycle;
+    }
+
+  private:
+    // Like fwd() in timecoder.c
+    bits_t next(bits_t code) const {
+        bits_t taken = code & (m_pDef->taps | 0x1);
+        bits_t parity = 0;
+        while (taken != 0) {
+            parity ^= taken & 0x1;
+            taken >>= 1;
+        }
+        return (code >> 1) | (parity << (m_pDef->bits - 1));
+    }
+
+    const timecode_def* m_pDef;
+    const double m_phaseIncrement;
+    double m_phase;
+    unsigned int m_cycle;
+    bits_t m_code;
+};
+
+// Feeds the signal in buffers of bufferFrames to a new timecoder until it
+// reports a position. Returns the number of frames that were needed, or -1.
+int framesUntilLock(timecode_def* pDef, size_t bufferFrames,
+        int* pPosition) {
+    timecoder timecoder;
+    timecoder_init(&timecoder, pDef, 1.0, kSampleRate, false);
+    TimecodeSignal signal(pDef, kSampleRate);
+    std::vector<short> pcm(bufferFrames * TIMECODER_CHANNELS);
+    int frames = 0;
+    int position = -1;
+    // Give up after 2 seconds
+    while (position == -1 && frames < 2 * static_cast<int>(kSampleRate)) {
+        signal.generate(pcm.data(), bufferFrames);
+        timecoder_submit(&timecoder, pcm.data(), bufferFrames);
+        frames += bufferFrames;
+        position = timecoder_get_position(&timecoder, NULL);
+    }
+    if (pPosition) {
+        // In milliseconds like the position, the last bit may not be
+        // complete yet.
+        EXPECT_NEAR(signal.cycle() * 1000.0 / pDef->resolution, position,
+                1000.0 / pDef->resolution + 1);
+        *pPosition = position;
+    }
+    timecoder_clear(&timecoder);
+    return position == -1 ? -1 : frames;
+}
+
+class TimecodeLutCacheTest : public testing::Test {
+  protected:
+    void SetUp() override {
+        ASSERT_TRUE(m_cacheDir.isValid());
+        TimecodeLutCache::clear();
+    }
+
+    void TearDown() override {
+        TimecodeLutCache::clear();
+    }
+
+    QString lutFilePath(const char* name) const {
+        return TimecodeLutCache::filePath(m_cacheDir.path(), name);
+    }
+
+    QTemporaryDir m_cacheDir;
+};
+
+TEST_F(TimecodeLutCacheTest, UnknownDefinition) {
+    EXPECT_TRUE(TimecodeLutCache::getDefinition(m_cacheDir.path(), "lp") == NULL);
+    EXPECT_FALSE(QFile::exists(lutFilePath("lp")));
+}
+
+TEST_F(TimecodeLutCacheTest, MappedTableMatchesBuiltTable) {
+    for (const char* name : {"serato_2a", "traktor_a", "mixvibes_v2"}) {
+        timecode_def* pDef = TimecodeLutCache::getDefinition(
+                m_cacheDir.path(), name);
+        ASSERT_TRUE(pDef != NULL);
+        ASSERT_TRUE(pDef->lookup);
+        ASSERT_FALSE(pDef->lut.shared);
+        ASSERT_TRUE(QFile::exists(lutFilePath(name)));
+        const std::vector<slot_no_t> builtTable(pDef->lut.table,
+                pDef->lut.table + (1 << LUT_HASH_BITS));
+        std::vector<bits_t> builtTimecodes;
+        std::vector<slot_no_t> builtNext;
+        for (unsigned int i = 0; i < pDef->length; ++i) {
+            builtTimecodes.push_back(pDef->lut.slot[i].timecode);
+            builtNext.push_back(pDef->lut.slot[i].next);
+        }
+
+        TimecodeLutCache::clear();
+        EXPECT_FALSE(pDef->lookup);
+
+        EXPECT_EQ(pDef, TimecodeLutCache::getDefinition(
+                m_cacheDir.path(), name));
+        ASSERT_TRUE(pDef->lookup);
+        EXPECT_TRUE(pDef->lut.shared);
+        EXPECT_EQ(pDef->length, pDef->lut.avail);
+        for (unsigned int hash = 0; hash < builtTable.size(); ++hash) {
+            ASSERT_EQ(builtTable[hash], pDef->lut.table[hash]);
+        }
+        for (unsigned int i = 0; i < pDef->length; ++i) {
+            ASSERT_EQ(builtTimecodes[i], pDef->lut.slot[i].timecode);
+            ASSERT_EQ(builtNext[i], pDef->lut.slot[i].next);
+        }
+    }
+}
+
+TEST_F(TimecodeLutCacheTest, InvalidFileIsRebuilt) {
+    ASSERT_TRUE(QDir().mkpath(m_cacheDir.path()));
+    const QString path = lutFilePath("serato_2b");
+    {
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(1024, 'x'));
+    }
+
+    timecode_def* pDef = TimecodeLutCache::getDefinition(
+            m_cacheDir.path(), "serato_2b");
+    ASSERT_TRUE(pDef != NULL);
+    EXPECT_FALSE(pDef->lut.shared);
+    const qint64 size = QFileInfo(path).size();
+    EXPECT_LT(1024, size);
+
+    // A table with a chain that doesn't terminate
+    TimecodeLutCache::clear();
+    {
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        file.seek(size - sizeof(slot) + offsetof(slot, next));
+        const slot_no_t loop = pDef->length - 1;
+        file.write(reinterpret_cast<const char*>(&loop), sizeof(loop));
+    }
+    pDef = TimecodeLutCache::getDefinition(m_cacheDir.path(), "serato_2b");
+    ASSERT_TRUE(pDef != NULL);
+    EXPECT_FALSE(pDef->lut.shared);
+
+    TimecodeLutCache::clear();
+    pDef = TimecodeLutCache::getDefinition(m_cacheDir.path(), "serato_2b");
+    ASSERT_TRUE(pDef != NULL);
+    EXPECT_TRUE(pDef->lut.shared);
+}
+
+TEST_F(TimecodeLutCacheTest, SynthesizedTimecodeLocksWithMappedTable) {
+    ASSERT_TRUE(TimecodeLutCache::getDefinition(
+            m_cacheDir.path(), "serato_2a") != NULL);
+    TimecodeLutCache::clear();
+    timecode_def* pDef = TimecodeLutCache::getDefinition(
+            m_cacheDir.path(), "serato_2a");
+    ASSERT_TRUE(pDef != NULL);
+    ASSERT_TRUE(pDef->lut.shared);
+
+    int position = -1;
+    const int frames = framesUntilLock(pDef, 256, &position);
+    EXPECT_LT(0, frames);
+    EXPECT_LT(0, position);
+    // The reference level of xwax settles within a few hundred cycles
+    EXPECT_LT(frames, static_cast<int>(kSampleRate) / 2);
+}
+
+// The time from enabling a deck until the first position is known. Cold
+// builds the lookup table, warm maps the table that a previous run stored.
+static void BM_TimecodeFirstLock(benchmark::State& state) {
+    const bool warm = state.range_x();
+    QTemporaryDir cacheDir;
+    TimecodeLutCache::clear();
+    if (warm) {
+        TimecodeLutCache::getDefinition(cacheDir.path(), "serato_2a");
+    }
+
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        TimecodeLutCache::clear();
+        if (!warm) {
+            QFile::remove(TimecodeLutCache::filePath(
+                    cacheDir.path(), "serato_2a"));
+        }
+        state.ResumeTiming();
+
+        timecode_def* pDef = TimecodeLutCache::getDefinition(
+                cacheDir.path(), "serato_2a");
+        framesUntilLock(pDef, 256, NULL);
+    }
+    TimecodeLutCache::clear();
+}
+BENCHMARK(BM_TimecodeFirstLock)->Arg(0)->Arg(1);
+
+// The CPU time of the decoder per buffer of the sound card
+static void BM_TimecoderSubmit(benchmark::State& state) {
+    const size_t bufferFrames = state.range_x();
+    QTemporaryDir cacheDir;
+    timecode_def* pDef = TimecodeLutCache::getDefinition(
+            cacheDir.path(), "serato_2a");
+    timecoder timecoder;
+    timecoder_init(&timecoder, pDef, 1.0, kSampleRate, false);
+    TimecodeSignal signal(pDef, kSampleRate);
+    // Ten seconds of signal, so the decoder sees new codes all the time
+    std::vector<short> pcm(10 * kSampleRate * TIMECODER_CHANNELS);
+    signal.generate(pcm.data(), pcm.size() / TIMECODER_CHANNELS);
+
+    size_t frame = 0;
+    while (state.KeepRunning()) {
+        if ((frame + bufferFrames) * TIMECODER_CHANNELS > pcm.size()) {
+            frame = 0;
+        }
+        timecoder_submit(&timecoder, &pcm[frame * TIMECODER_CHANNELS],
+                bufferFrames);
+        benchmark::DoNotOptimize(timecoder_get_position(&timecoder, NULL));
+        frame += bufferFrames;
+    }
+    timecoder_clear(&timecoder);
+    TimecodeLutCache::clear();
+}
+BENCHMARK(BM_TimecoderSubmit)->Range(64, 4096);
+
+}  // namespace
+
+#endif // __VINYLCONTROL__
@@ -0,0 +1,178 @@
+#include <benchmark/benchmark.h>
+
+#include <QSqlDatabase>
+#include <QtDebug>
+
+#include "library/searchquery.h"
+#include "library/trackcolumnstore.h"
+#include "util/memory.h"
+
+// Benchmarks searching and sorting a library of 250k tracks like
+// BaseTrackCache::filterAndSort() does for each keystroke in the search box.
+// The query is evaluated for all tracks and the result is sorted by artist,
+// album and title.
+//
+// Run with: mixxx-test --benchmark --benchmark_filter=BM_TrackColumnStore
+
+namespace {
+
+const int kNumTracks = 250000;
+
+const char* const kSyllables[] = {
+    "la", "mi", "ko", "ra", "ve", "to", "su", "ne", "di", "ba",
+    "lo", "ze", "qui", "hau", "ment", "ric", "ov", "é", "ß", "ar",
+};
+const int kNumSyllables = sizeof(kSyllables) / sizeof(kSyllables[0]);
+
+// The texts of consecutive keystrokes
+const char* const kSearches[] = {
+    "l", "lo", "lov", "lovera", "lovera mi",
+};
+
+QStringList storeColumns() {
+    QStringList columns;
+    columns << "id" << "artist" << "album" << "album_artist" << "location"
+            << "grouping" << "comment" << "title" << "genre" << "year"
+            << "bpm" << "key_id";
+    return columns;
+}
+
+QStringList searchColumns() {
+    QStringList columns;
+    columns << "artist" << "album" << "album_artist" << "location"
+            << "grouping" << "comment" << "title" << "genre";
+    return columns;
+}
+
+class Words {
+  public:
+    Words()
+            : m_state(12345) {
+    }
+
+    QString next(int syllables) {
+        QString word;
+        for (int i = 0; i < syllables; ++i) {
+            m_state = m_state * 1103515245 + 12345;
+            word += QString::fromUtf8(kSyllables[(m_state >> 16) % kNumSyllables]);
+        }
+        return word;
+    }
+
+    QString next(int words, int syllables) {
+        QStringList result;
+        for (int i = 0; i < words; ++i) {
+            result << next(syllables);
+        }
+        return result.join(" ");
+    }
+
+  private:
+    quint32 m_state;
+};
+
+TrackColumnStore* libraryStore() {
+    static TrackColumnStore* s_pStore = nullptr;
+    if (s_pStore) {
+        return s_pStore;
+    }
+    s_pStore = new TrackColumnStore(storeColumns());
+    Words words;
+    QStringList artists;
+    for (int i = 0; i < 5000; ++i) {
+        artists << words.next(2, 2);
+    }
+    QStringList genres;
+    for (int i = 0; i < 100; ++i) {
+        genres << words.next(1, 3);
+    }
+    for (int id = 1; id <= kNumTracks; ++id) {
+        const QString& artist = artists[(id * 7919) % artists.size()];
+        const QString album = words.next(2, 3);
+        QVector<QVariant> record;
+        record << id
+               << artist
+               << album
+               << (id % 5 == 0 ? QVariant() : QVariant(artist))
+               << QString("/music/%1/%2/%3.mp3").arg(artist, album, QString::number(id))
+               << QVariant()
+               << (id % 3 == 0 ? words.next(4, 2) : QString())
+               << words.next(3, 2)
+               << genres[id % genres.size()]
+               << QString::number(1960 + id % 60)
+               << 80.0 + (id % 900) / 10.0
+               << id % 25;
+        s_pStore->setRecord(TrackId(id), record);
+    }
+    return s_pStore;
+}
+
+std::unique_ptr<QueryNode> parseSearch(const QString& search) {
+    // Like SearchQueryParser without crates, which are not part of the
+    // store
+    auto pQuery = std::make_unique<AndNode>();
+    for (const auto& token: search.split(" ")) {
+        pQuery->addNode(std::make_unique<TextFilterNode>(
+                QSqlDatabase(), searchColumns(), token));
+    }
+    return std::move(pQuery);
+}
+
+int searchAndSort(TrackColumnStore* pStore, const QString& search,
+        QVector<int>* pRows) {
+    const QStringList columns = storeColumns();
+    QList<TrackColumnStore::SortColumn> sortColumns;
+    sortColumns << TrackColumnStore::SortColumn(columns.indexOf("artist"),
+                    ColumnCache::SORT_NOCASE, Qt::AscendingOrder)
+                << TrackColumnStore::SortColumn(columns.indexOf("album"),
+                    ColumnCache::SORT_NOCASE, Qt::AscendingOrder)
+                << TrackColumnStore::SortColumn(columns.indexOf("title"),
+                    ColumnCache::SORT_NOCASE, Qt::AscendingOrder);
+
+    std::unique_ptr<QueryNode> pQuery = parseSearch(search);
+    pQuery->prepareStoreMatch(pStore);
+    pRows->resize(0);
+    for (int id = 1; id <= kNumTracks; ++id) {
+        const int row = pStore->row(TrackId(id));
+        if (pQuery->matchStore(*pStore, row) == StoreMatch::Match) {
+            pRows->append(row);
+        }
+    }
+    pStore->sortRows(pRows, sortColumns, KeyUtils::OPEN_KEY);
+    return pRows->size();
+}
+
+static void BM_TrackColumnStoreSearch(benchmark::State& state) {
+    TrackColumnStore* pStore = libraryStore();
+    const QString search = QString::fromUtf8(kSearches[state.range_x()]);
+    QVector<int> rows;
+    // Build the indexes of the columns before measuring
+    searchAndSort(pStore, search, &rows);
+    state.SetLabel(QString("\"%1\": %2 tracks").arg(
+            search, QString::number(rows.size())).toStdString());
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(searchAndSort(pStore, search, &rows));
+    }
+}
+BENCHMARK(BM_TrackColumnStoreSearch)
+        ->DenseRange(0, sizeof(kSearches) / sizeof(kSearches[0]) - 1);
+
+// Editing a track adds new values to the indexes of the columns, which are
+// merged into the sort order on the next search.
+static void BM_TrackColumnStoreUpdate(benchmark::State& state) {
+    TrackColumnStore* pStore = libraryStore();
+    QVector<int> rows;
+    searchAndSort(pStore, "lo", &rows);
+    Words words;
+    int id = 1;
+    while (state.KeepRunning()) {
+        QVector<QVariant> record = pStore->record(pStore->row(TrackId(id)));
+        record[storeColumns().indexOf("title")] = words.next(3, 2);
+        pStore->setRecord(TrackId(id), record);
+        benchmark::DoNotOptimize(searchAndSort(pStore, "lo", &rows));
+        id = id % kNumTracks + 1;
+    }
+}
+BENCHMARK(BM_TrackColumnStoreUpdate);
+
+}  // namespace
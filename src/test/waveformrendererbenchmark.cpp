@@ -0,0 +1,170 @@
+#include <benchmark/benchmark.h>
+
+#include <QGLFramebufferObject>
+#include <QGLWidget>
+#include <QImage>
+#include <QPainter>
+#include <QtDebug>
+
+#include "test/waveformtestutil.h"
+#include "track/track.h"
+#include "util/memory.h"
+#include "waveform/renderers/glwaveformrendererrgb.h"
+#include "waveform/renderers/waveformrendererrgb.h"
+#include "waveform/renderers/waveformwidgetrenderer.h"
+#include "waveform/waveform.h"
+#include "waveform/waveformwidgetfactory.h"
+
+// Benchmarks drawing a frame of the scrolling waveform of a deck with the
+// software and the GL RGB renderers at several zoom levels. The argument is
+// the number of visual samples per pixel, 1-10 is the range of the zoom
+// control and larger values show how the frame time scales when zooming out
+// further.
+//
+// The GL benchmarks need an OpenGL context. Without a GPU they can be run on
+// Mesa's software rasterizer, e.g. with LIBGL_ALWAYS_SOFTWARE=1 in xvfb-run.
+//
+// Run with: mixxx-test --benchmark --benchmark_filter=WaveformRendererRGB
+
+namespace {
+
+const int kWidth = 1000;
+const int kHeight = 100;
+
+// Sets the state that WaveformWidgetRenderer::onPreRender() and setup()
+// would take from the controls and the skin.
+class BenchmarkWidgetRenderer : public WaveformWidgetRenderer {
+  public:
+    BenchmarkWidgetRenderer()
+            : WaveformWidgetRenderer("[Channel1]") {
+    }
+
+    void setTrack(TrackPointer pTrack) {
+        m_pTrack = pTrack;
+    }
+
+    void setVisualSamplePerPixel(double visualSamplePerPixel,
+            int dataSize) {
+        m_visualSamplePerPixel = visualSamplePerPixel;
+        const double displayedFraction =
+                visualSamplePerPixel * getLength() / dataSize;
+        m_firstDisplayedPosition = 0.5 - displayedFraction / 2;
+        m_lastDisplayedPosition = 0.5 + displayedFraction / 2;
+    }
+};
+
+// Sets the colors that setup() would take from the skin
+template<typename Renderer>
+class BenchmarkRenderer : public Renderer {
+  public:
+    explicit BenchmarkRenderer(WaveformWidgetRenderer* pWidgetRenderer)
+            : Renderer(pWidgetRenderer) {
+        this->m_pColors = this->m_waveformRenderer->getWaveformSignalColors();
+        this->m_rgbLowColor_r = 1.0;
+        this->m_rgbMidColor_g = 1.0;
+        this->m_rgbHighColor_b = 1.0;
+    }
+};
+
+// Skips creating the vertex buffers to measure the fallback that sends the
+// lines with glBegin()
+class ImmediateRendererRGB : public GLWaveformRendererRGB {
+  public:
+    explicit ImmediateRendererRGB(WaveformWidgetRenderer* pWidgetRenderer)
+            : GLWaveformRendererRGB(pWidgetRenderer) {
+    }
+
+    bool onInit() override {
+        return true;
+    }
+};
+
+TrackPointer benchmarkTrack() {
+    // The renderers read the visual gains from the factory
+    WaveformWidgetFactory::createInstance();
+
+    auto pWaveform = new Waveform(
+            kSampleRate, kAudioSamples, kVisualSampleRate, -1);
+    fillWaveform(pWaveform);
+    pWaveform->setCompletion(pWaveform->getDataSize());
+    TrackPointer pTrack = Track::newTemporary();
+    pTrack->setWaveform(ConstWaveformPointer(pWaveform));
+    return pTrack;
+}
+
+template<typename Renderer>
+Renderer* addRenderer(BenchmarkWidgetRenderer* pWidgetRenderer,
+        TrackPointer pTrack, int visualSamplePerPixel) {
+    Renderer* pRenderer = pWidgetRenderer->addRenderer<Renderer>();
+    pWidgetRenderer->init();
+    pWidgetRenderer->resize(kWidth, kHeight, 1.0f);
+    pWidgetRenderer->setTrack(pTrack);
+    pWidgetRenderer->setVisualSamplePerPixel(visualSamplePerPixel,
+            pTrack->getWaveform()->getDataSize());
+    return pRenderer;
+}
+
+static void BM_WaveformRendererRGB(benchmark::State& state) {
+    BenchmarkWidgetRenderer widgetRenderer;
+    WaveformRendererAbstract* pRenderer =
+            addRenderer<BenchmarkRenderer<WaveformRendererRGB>>(
+                    &widgetRenderer, benchmarkTrack(), state.range_x());
+
+    QImage image(kWidth, kHeight, QImage::Format_ARGB32_Premultiplied);
+    while (state.KeepRunning()) {
+        QPainter painter(&image);
+        pRenderer->draw(&painter, nullptr);
+    }
+    state.SetLabel(QString("%1 visual samples per pixel").arg(
+            state.range_x()).toStdString());
+}
+BENCHMARK(BM_WaveformRendererRGB)
+        ->Arg(1)->Arg(3)->Arg(10)->Arg(64)->Arg(256);
+
+// The second argument selects the renderer, 0 sends the lines of each frame
+// with glBegin() and 1 draws them from the vertex buffers. The first frame
+// uploads the waveform to the vertex buffers and is not measured. glFinish()
+// waits until the frame has been drawn.
+static void BM_GLWaveformRendererRGB(benchmark::State& state) {
+    if (!QGLFormat::hasOpenGL()) {
+        state.SetLabel("OpenGL is not available");
+        while (state.KeepRunning()) {
+        }
+        return;
+    }
+    QGLWidget glWidget;
+    glWidget.makeCurrent();
+    QGLFramebufferObject framebuffer(kWidth, kHeight);
+
+    const bool vertexBuffers = state.range_y() != 0;
+    BenchmarkWidgetRenderer widgetRenderer;
+    WaveformRendererAbstract* pRenderer;
+    if (vertexBuffers) {
+        pRenderer = addRenderer<BenchmarkRenderer<GLWaveformRendererRGB>>(
+                &widgetRenderer, benchmarkTrack(), state.range_x());
+    } else {
+        pRenderer = addRenderer<BenchmarkRenderer<ImmediateRendererRGB>>(
+                &widgetRenderer, benchmarkTrack(), state.range_x());
+    }
+
+    {
+        QPainter painter(&framebuffer);
+        pRenderer->draw(&painter, nullptr);
+    }
+    glFinish();
+    while (state.KeepRunning()) {
+        QPainter painter(&framebuffer);
+        pRenderer->draw(&painter, nullptr);
+        painter.end();
+        glFinish();
+    }
+    state.SetLabel(QString("%1 visual samples per pixel, %2").arg(
+            QString::number(state.range_x()),
+            vertexBuffers ? "vertex buffers" : "glBegin").toStdString());
+}
+BENCHMARK(BM_GLWaveformRendererRGB)
+        ->ArgPair(1, 0)->ArgPair(1, 1)
+        ->ArgPair(10, 0)->ArgPair(10, 1)
+        ->ArgPair(256, 0)->ArgPair(256, 1);
+
+}  // namespace
@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+#include <benchmark/benchmark.h>
+
+#include <QTemporaryFile>
+#include <QtDebug>
+
+#include <algorithm>
+
+#include "test/mixxxtest.h"
+#include "test/waveformtestutil.h"
+#include "waveform/waveform.h"
+#include "waveform/waveformfactory.h"
+
+namespace {
+
+const int kSummarySamples = 2 * 1920;
+
+// The size of the pyramid of maxima of the compact format, blocks of 16
+// frames and pairs of blocks thereof with both channels
+int pyramidBytes(const Waveform& waveform) {
+    int size = 0;
+    int blocks = (waveform.getDataSize() / 2 + 15) / 16;
+    while (blocks > 0) {
+        size += 2 * blocks;
+        if (blocks == 1) {
+            break;
+        }
+        blocks = (blocks + 1) / 2;
+    }
+    return size * sizeof(WaveformMaxData);
+}
+
+WaveformMaxData computeMax(const Waveform& waveform, int beginFrame,
+        int endFrame, ChannelIndex channel) {
+    WaveformMaxData max;
+    for (int frame = beginFrame; frame < endFrame; ++frame) {
+        max.merge(waveform.get(2 * frame + channel));
+    }
+    return max;
+}
+
+void expectSameMax(const WaveformMaxData& expected,
+        const WaveformMaxData& actual) {
+    EXPECT_EQ(expected.bands.m_i, actual.bands.m_i);
+    EXPECT_EQ(expected.energy, actual.energy);
+}
+
+QTemporaryFile* writeTemporaryFile(const QByteArray& data) {
+    QTemporaryFile* pFile = new QTemporaryFile();
+    pFile->open();
+    pFile->write(data);
+    pFile->close();
+    return pFile;
+}
+
+void expectSameWaveform(const Waveform& expected, const Waveform& actual) {
+    ASSERT_TRUE(actual.isValid());
+    ASSERT_EQ(expected.getDataSize(), actual.getDataSize());
+    EXPECT_DOUBLE_EQ(expected.getAudioVisualRatio(),
+            actual.getAudioVisualRatio());
+    EXPECT_EQ(expected.getTextureStride(), actual.getTextureStride());
+    EXPECT_EQ(expected.getTextureSize(), actual.getTextureSize());
+    EXPECT_EQ(actual.getDataSize(), actual.getCompletion());
+    for (int i = 0; i < expected.getDataSize(); ++i) {
+        ASSERT_EQ(expected.get(i).m_i, actual.get(i).m_i) << "at " << i;
+    }
+}
+
+class WaveformTest : public MixxxTest {
+  protected:
+    void SetUp() override {
+        m_pWaveform = std::make_unique<Waveform>(
+                kSampleRate, kAudioSamples, kVisualSampleRate, -1);
+        fillWaveform(m_pWaveform.get());
+    }
+
+    std::unique_ptr<Waveform> m_pWaveform;
+};
+
+TEST_F(WaveformTest, MapCompactFormat) {
+    const QByteArray data = m_pWaveform->toByteArray();
+    EXPECT_EQ(64 + m_pWaveform->getDataSize() * 4 + pyramidBytes(*m_pWaveform),
+            data.size());
+
+    ScopedTemporaryFile pFile(writeTemporaryFile(data));
+    std::unique_ptr<Waveform> pMapped(
+            Waveform::fromMappedFile(pFile->fileName()));
+    EXPECT_TRUE(pMapped->isMapped());
+    EXPECT_EQ(Waveform::SaveState::Saved, pMapped->saveState());
+    expectSameWaveform(*m_pWaveform, *pMapped);
+    EXPECT_EQ(data, pMapped->toByteArray());
+}
+
+TEST_F(WaveformTest, MapPyramid) {
+    ScopedTemporaryFile pFile(writeTemporaryFile(m_pWaveform->toByteArray()));
+    std::unique_ptr<Waveform> pMapped(
+            Waveform::fromMappedFile(pFile->fileName()));
+    ASSERT_TRUE(pMapped->isMapped());
+
+    // The maxima are read from the pyramid in the file
+    const int frames = m_pWaveform->getDataSize() / 2;
+    const int ranges[][2] = {
+        {0, frames},
+        {5, 21},
+        {16, 4096},
+        {1000, 70001},
+        {frames - 100, frames + 100},
+    };
+    for (const auto& range : ranges) {
+        SCOPED_TRACE(QString("[%1, %2)").arg(range[0]).arg(range[1])
+                .toStdString());
+        const int endFrame = std::min(range[1], frames);
+        expectSameMax(computeMax(*m_pWaveform, range[0], endFrame, Left),
+                pMapped->getMax(range[0], range[1], Left));
+        expectSameMax(computeMax(*m_pWaveform, range[0], endFrame, Right),
+                pMapped->getMax(range[0], range[1], Right));
+    }
+}
+
+TEST_F(WaveformTest, GetMaxIgnoresFramesBeyondCompletion) {
+    const int frames = m_pWaveform->getDataSize() / 2;
+    // Not at the end of a block of the pyramid
+    const int completedFrames = frames / 2 + 5;
+    m_pWaveform->setCompletion(2 * completedFrames);
+
+    expectSameMax(computeMax(*m_pWaveform, 0, completedFrames, Left),
+            m_pWaveform->getMax(0, frames, Left));
+    expectSameMax(computeMax(*m_pWaveform, 100, completedFrames, Right),
+            m_pWaveform->getMax(100, frames, Right));
+    expectSameMax(WaveformMaxData(),
+            m_pWaveform->getMax(completedFrames, frames, Left));
+
+    m_pWaveform->setCompletion(m_pWaveform->getDataSize());
+    expectSameMax(computeMax(*m_pWaveform, 0, frames, Left),
+            m_pWaveform->getMax(0, frames, Left));
+}
+
+TEST_F(WaveformTest, MapSummary) {
+    Waveform summary(kSampleRate, kAudioSamples, kVisualSampleRate,
+            kSummarySamples);
+    fillWaveform(&summary);
+
+    ScopedTemporaryFile pFile(writeTemporaryFile(summary.toByteArray()));
+    std::unique_ptr<Waveform> pMapped(
+            Waveform::fromMappedFile(pFile->fileName()));
+    expectSameWaveform(summary, *pMapped);
+}
+
+TEST_F(WaveformTest, MapInvalidFiles) {
+    const QByteArray data = m_pWaveform->toByteArray();
+
+    std::unique_ptr<Waveform> pMissing(
+            Waveform::fromMappedFile("/nonexistent/waveform"));
+    EXPECT_FALSE(pMissing->isValid());
+    EXPECT_FALSE(pMissing->isMapped());
+
+    // Truncated data
+    ScopedTemporaryFile pTruncatedFile(writeTemporaryFile(
+            data.left(data.size() - 4)));
+    std::unique_ptr<Waveform> pTruncated(
+            Waveform::fromMappedFile(pTruncatedFile->fileName()));
+    EXPECT_FALSE(pTruncated->isValid());
+    EXPECT_FALSE(pTruncated->isMapped());
+
+    // Another format version
+    QByteArray otherVersion = data;
+    otherVersion[8] = otherVersion[8] + 1;
+    ScopedTemporaryFile pOtherVersionFile(writeTemporaryFile(otherVersion));
+    std::unique_ptr<Waveform> pOtherVersion(
+            Waveform::fromMappedFile(pOtherVersionFile->fileName()));
+    EXPECT_FALSE(pOtherVersion->isValid());
+
+    // A protobuf waveform
+    ScopedTemporaryFile pProtobufFile(writeTemporaryFile(
+            m_pWaveform->toProtobuf()));
+    std::unique_ptr<Waveform> pProtobuf(
+            Waveform::fromMappedFile(pProtobufFile->fileName()));
+    EXPECT_FALSE(pProtobuf->isValid());
+}
+
+TEST_F(WaveformTest, MigrateProtobuf) {
+    AnalysisDao::AnalysisInfo analysis;
+    analysis.analysisId = 42;
+    analysis.type = AnalysisDao::TYPE_WAVEFORM;
+    analysis.version = WAVEFORM_5_VERSION;
+    analysis.description = WAVEFORM_5_DESCRIPTION;
+    analysis.data = m_pWaveform->toProtobuf();
+    EXPECT_EQ(WaveformFactory::VC_MIGRATE,
+            WaveformFactory::waveformVersionToVersionClass(analysis.version));
+
+    std::unique_ptr<Waveform> pLoaded(
+            WaveformFactory::loadWaveformFromAnalysis(analysis));
+    EXPECT_FALSE(pLoaded->isMapped());
+    expectSameWaveform(*m_pWaveform, *pLoaded);
+
+    AnalysisDao::AnalysisInfo migrated =
+            WaveformFactory::migrateWaveformAnalysis(analysis, *pLoaded);
+    EXPECT_EQ(42, migrated.analysisId);
+    EXPECT_EQ(WaveformFactory::currentWaveformVersion(), migrated.version);
+    EXPECT_EQ(WaveformFactory::VC_USE,
+            WaveformFactory::waveformVersionToVersionClass(migrated.version));
+
+    ScopedTemporaryFile pFile(writeTemporaryFile(migrated.data));
+    migrated.dataPath = pFile->fileName();
+    std::unique_ptr<Waveform> pMapped(
+            WaveformFactory::loadWaveformFromAnalysis(migrated));
+    EXPECT_TRUE(pMapped->isMapped());
+    EXPECT_EQ(42, pMapped->getId());
+    expectSameWaveform(*m_pWaveform, *pMapped);
+}
+
+// Loading the waveform of a deck from the protobuf format of Waveform-5.0,
+// as stored by AnalysisDao, compared to mapping the compact format. The label
+// shows the heap memory that the loaded waveform keeps. The parse
+// temporarily needs about as much again for the inflated protobuf message.
+//
+// Run with: mixxx-test --benchmark --benchmark_filter=BM_WaveformLoad
+
+static void BM_WaveformLoadProtobuf(benchmark::State& state) {
+    Waveform waveform(kSampleRate, kAudioSamples, kVisualSampleRate, -1);
+    fillWaveform(&waveform);
+    const QByteArray compressed = qCompress(waveform.toProtobuf());
+    size_t heapBytes = 0;
+    while (state.KeepRunning()) {
+        Waveform loaded(qUncompress(compressed));
+        heapBytes = loaded.getTextureSize() * sizeof(WaveformData);
+        benchmark::DoNotOptimize(loaded.getAll(loaded.getDataSize() - 1));
+    }
+    state.SetLabel(QString("heap: %1 KiB, file: %2 KiB").arg(
+            QString::number(heapBytes / 1024),
+            QString::number(compressed.size() / 1024)).toStdString());
+}
+BENCHMARK(BM_WaveformLoadProtobuf);
+
+// The data is only read from the file when it is accessed. The benchmark
+// touches each page once like the GLSL renderer does when uploading the
+// waveform, which is served from the page cache here.
+static void BM_WaveformLoadMapped(benchmark::State& state) {
+    Waveform waveform(kSampleRate, kAudioSamples, kVisualSampleRate, -1);
+    fillWaveform(&waveform);
+    const QByteArray data = waveform.toByteArray();
+    ScopedTemporaryFile pFile(writeTemporaryFile(data));
+    const int touchStride = state.range_x() ? 1024 : 0;
+    while (state.KeepRunning()) {
+        std::unique_ptr<Waveform> pLoaded(
+                Waveform::fromMappedFile(pFile->fileName()));
+        int sum = pLoaded->getAll(pLoaded->getDataSize() - 1);
+        for (int i = 0; touchStride > 0 && i < pLoaded->getDataSize();
+                i += touchStride) {
+            sum += pLoaded->getAll(i);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetLabel(QString("heap: 0 KiB, file: %1 KiB, %2").arg(
+            QString::number(data.size() / 1024),
+            touchStride ? "all pages touched" : "untouched").toStdString());
+}
+BENCHMARK(BM_WaveformLoadMapped)->Arg(0)->Arg(1);
+
+}  // namespace
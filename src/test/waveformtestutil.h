@@ -0,0 +1,29 @@
+#ifndef WAVEFORMTESTUTIL_H
+#define WAVEFORMTESTUTIL_H
+
+#include "waveform/waveform.h"
+
+// The waveform of a track that is shared by the waveform tests and
+// benchmarks
+namespace {
+
+// About 6 minutes of audio
+const int kSampleRate = 44100;
+const int kAudioSamples = 2 * kSampleRate * 360;
+const int kVisualSampleRate = 441;
+
+// Fills all bands with different patterns. The completion of the waveform
+// is not changed.
+void fillWaveform(Waveform* pWaveform) {
+    WaveformData* pData = pWaveform->data();
+    for (int i = 0; i < pWaveform->getDataSize(); ++i) {
+        pData[i].filtered.low = static_cast<unsigned char>(i * 3);
+        pData[i].filtered.mid = static_cast<unsigned char>(i * 5 + 1);
+        pData[i].filtered.high = static_cast<unsigned char>(i * 7 + 2);
+        pData[i].filtered.all = static_cast<unsigned char>(i / 11);
+    }
+}
+
+} // anonymous namespace
+
+#endif /* WAVEFORMTESTUTIL_H */
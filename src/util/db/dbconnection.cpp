@@ -363,6 +363,12 @@ QString DbConnection::collateLexicographically(const QString& orderByQuery) {
 #endif //  __SQLITE3__
 }
 
+//static
+QString DbConnection::latinLow(QString string) {
+    makeLatinLow(string.data(), string.length());
+    return string;
+}
+
 //static
 int DbConnection::likeCompareLatinLow(
         QString* pattern,
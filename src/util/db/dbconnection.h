@@ -22,6 +22,11 @@ class DbConnection final {
         QString* string,
         QChar esc);
 
+    // Returns the string as it is compared by likeCompareLatinLow(), i.e.
+    // lower case and without diacritics. A string is LIKE '%pattern%' if
+    // its folded version contains the folded pattern.
+    static QString latinLow(QString string);
+
     struct Params {
         QString type;
         QString hostName;
@@ -0,0 +1,133 @@
+#include "util/fft.h"
+
+#include <cmath>
+
+#include "util/assert.h"
+#include "util/math.h"
+
+namespace mixxx {
+
+// The real signal of size samples is packed into a complex signal of
+// size / 2 points, with the even samples as the real and the odd samples
+// as the imaginary parts. The spectrum of the real signal is then split
+// from the spectrum of the packed signal, which halves the work of a
+// complex FFT of the full size.
+RealFft::RealFft(int size)
+        : m_size(size),
+          m_bitReversed(size / 2),
+          m_cos(size / 4),
+          m_sin(size / 4),
+          m_splitCos(size / 2 + 1),
+          m_splitSin(size / 2 + 1),
+          m_real(size / 2),
+          m_imag(size / 2) {
+    VERIFY_OR_DEBUG_ASSERT(size >= 4 && (size & (size - 1)) == 0) {
+        return;
+    }
+    const int points = size / 2;
+    int bits = 0;
+    while ((1 << bits) < points) {
+        ++bits;
+    }
+    for (int i = 0; i < points; ++i) {
+        int reversed = 0;
+        for (int bit = 0; bit < bits; ++bit) {
+            if (i & (1 << bit)) {
+                reversed |= 1 << (bits - 1 - bit);
+            }
+        }
+        m_bitReversed[i] = reversed;
+    }
+    for (int i = 0; i < points / 2; ++i) {
+        const double phase = -2 * M_PI * i / points;
+        m_cos[i] = static_cast<CSAMPLE>(cos(phase));
+        m_sin[i] = static_cast<CSAMPLE>(sin(phase));
+    }
+    for (int i = 0; i <= points; ++i) {
+        const double phase = -2 * M_PI * i / size;
+        m_splitCos[i] = static_cast<CSAMPLE>(cos(phase));
+        m_splitSin[i] = static_cast<CSAMPLE>(sin(phase));
+    }
+}
+
+void RealFft::transform(CSAMPLE* pReal, CSAMPLE* pImag, bool inverse) {
+    const int points = m_size / 2;
+    for (int i = 0; i < points; ++i) {
+        const int j = m_bitReversed[i];
+        if (i < j) {
+            std::swap(pReal[i], pReal[j]);
+            std::swap(pImag[i], pImag[j]);
+        }
+    }
+    const CSAMPLE sign = inverse ? -1.0f : 1.0f;
+    for (int length = 2; length <= points; length *= 2) {
+        const int half = length / 2;
+        const int stride = points / length;
+        for (int start = 0; start < points; start += length) {
+            for (int i = 0; i < half; ++i) {
+                const CSAMPLE wr = m_cos[i * stride];
+                const CSAMPLE wi = sign * m_sin[i * stride];
+                const int a = start + i;
+                const int b = a + half;
+                const CSAMPLE tr = pReal[b] * wr - pImag[b] * wi;
+                const CSAMPLE ti = pReal[b] * wi + pImag[b] * wr;
+                pReal[b] = pReal[a] - tr;
+                pImag[b] = pImag[a] - ti;
+                pReal[a] += tr;
+                pImag[a] += ti;
+            }
+        }
+    }
+}
+
+void RealFft::forward(const CSAMPLE* pInput, CSAMPLE* pReal, CSAMPLE* pImag) {
+    const int points = m_size / 2;
+    for (int i = 0; i < points; ++i) {
+        m_real[i] = pInput[2 * i];
+        m_imag[i] = pInput[2 * i + 1];
+    }
+    transform(m_real.data(), m_imag.data(), false);
+
+    for (int k = 0; k <= points; ++k) {
+        // The bins k and points - k of the packed spectrum hold the even
+        // and the odd part of the bin k of the real spectrum.
+        const int j = k % points;
+        const int c = (points - k) % points;
+        const CSAMPLE evenReal = 0.5f * (m_real[j] + m_real[c]);
+        const CSAMPLE evenImag = 0.5f * (m_imag[j] - m_imag[c]);
+        const CSAMPLE oddReal = 0.5f * (m_imag[j] + m_imag[c]);
+        const CSAMPLE oddImag = -0.5f * (m_real[j] - m_real[c]);
+        const CSAMPLE wr = m_splitCos[k];
+        const CSAMPLE wi = m_splitSin[k];
+        pReal[k] = evenReal + oddReal * wr - oddImag * wi;
+        pImag[k] = evenImag + oddReal * wi + oddImag * wr;
+    }
+}
+
+void RealFft::inverse(const CSAMPLE* pReal, const CSAMPLE* pImag,
+        CSAMPLE* pOutput) {
+    const int points = m_size / 2;
+    for (int k = 0; k < points; ++k) {
+        const int c = points - k;
+        const CSAMPLE evenReal = 0.5f * (pReal[k] + pReal[c]);
+        const CSAMPLE evenImag = 0.5f * (pImag[k] - pImag[c]);
+        const CSAMPLE diffReal = 0.5f * (pReal[k] - pReal[c]);
+        const CSAMPLE diffImag = 0.5f * (pImag[k] + pImag[c]);
+        // Undo the twiddle factor of the odd part
+        const CSAMPLE wr = m_splitCos[k];
+        const CSAMPLE wi = -m_splitSin[k];
+        const CSAMPLE oddReal = diffReal * wr - diffImag * wi;
+        const CSAMPLE oddImag = diffReal * wi + diffImag * wr;
+        m_real[k] = evenReal - oddImag;
+        m_imag[k] = evenImag + oddReal;
+    }
+    transform(m_real.data(), m_imag.data(), true);
+
+    const CSAMPLE scale = 1.0f / points;
+    for (int i = 0; i < points; ++i) {
+        pOutput[2 * i] = m_real[i] * scale;
+        pOutput[2 * i + 1] = m_imag[i] * scale;
+    }
+}
+
+} // namespace mixxx
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include "util/types.h"
+
+namespace mixxx {
+
+// A radix-2 FFT of real signals with a fixed power of two size. The
+// spectrum of size real samples has size / 2 + 1 bins, which are stored
+// as separate arrays of real and imaginary parts so that loops over the
+// bins vectorize.
+//
+// All tables are allocated by the constructor, transforming a signal
+// doesn't allocate and may be done in the engine thread.
+class RealFft {
+  public:
+    explicit RealFft(int size);
+
+    int size() const {
+        return m_size;
+    }
+    int bins() const {
+        return m_size / 2 + 1;
+    }
+
+    // Transforms size samples of pInput into bins() bins.
+    void forward(const CSAMPLE* pInput, CSAMPLE* pReal, CSAMPLE* pImag);
+    // Transforms bins() bins back into size samples. The result is scaled
+    // by 1 / size, so that inverse(forward(x)) == x.
+    void inverse(const CSAMPLE* pReal, const CSAMPLE* pImag, CSAMPLE* pOutput);
+
+  private:
+    // An in-place complex FFT of size / 2 points.
+    void transform(CSAMPLE* pReal, CSAMPLE* pImag, bool inverse);
+
+    const int m_size;
+    std::vector<int> m_bitReversed;
+    // Twiddle factors of the complex FFT
+    std::vector<CSAMPLE> m_cos;
+    std::vector<CSAMPLE> m_sin;
+    // Twiddle factors for splitting the spectrum of the packed signal
+    std::vector<CSAMPLE> m_splitCos;
+    std::vector<CSAMPLE> m_splitSin;
+    // Scratch buffers of size / 2 points
+    std::vector<CSAMPLE> m_real;
+    std::vector<CSAMPLE> m_imag;
+};
+
+} // namespace mixxx
@@ -93,12 +93,9 @@ static inline void copy3WithGain(CSAMPLE* M_RESTRICT pDest,
         copy2WithGain(pDest, pSrc0, gain0, pSrc1, gain1, iNumSamples);
         return;
     }
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples; ++i) {
-        pDest[i] = pSrc0[i] * gain0 +
-                   pSrc1[i] * gain1 +
-                   pSrc2[i] * gain2;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2};
+    const CSAMPLE_GAIN gain[] = {gain0, gain1, gain2};
+    SampleKernels::active().copyWithGain[3](pDest, pSrc, gain, iNumSamples);
 }
 static inline void copy3WithRampingGain(CSAMPLE* M_RESTRICT pDest,
                                         const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0in, CSAMPLE_GAIN gain0out,
@@ -123,18 +120,10 @@ static inline void copy3WithRampingGain(CSAMPLE* M_RESTRICT pDest,
     const CSAMPLE_GAIN start_gain1 = gain1in + gain_delta1;
     const CSAMPLE_GAIN gain_delta2 = (gain2out - gain2in) / (iNumSamples / 2);
     const CSAMPLE_GAIN start_gain2 = gain2in + gain_delta2;
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples / 2; ++i) {
-        const CSAMPLE_GAIN gain0 = start_gain0 + gain_delta0 * i;
-        const CSAMPLE_GAIN gain1 = start_gain1 + gain_delta1 * i;
-        const CSAMPLE_GAIN gain2 = start_gain2 + gain_delta2 * i;
-        pDest[i * 2] = pSrc0[i * 2] * gain0 +
-                       pSrc1[i * 2] * gain1 +
-                       pSrc2[i * 2] * gain2;
-        pDest[i * 2 + 1] = pSrc0[i * 2 + 1] * gain0 +
-                           pSrc1[i * 2 + 1] * gain1 +
-                           pSrc2[i * 2 + 1] * gain2;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2};
+    const CSAMPLE_GAIN startGain[] = {start_gain0, start_gain1, start_gain2};
+    const CSAMPLE_GAIN gainDelta[] = {gain_delta0, gain_delta1, gain_delta2};
+    SampleKernels::active().copyWithRampingGain[3](pDest, pSrc, startGain, gainDelta, iNumSamples);
 }
 static inline void copy4WithGain(CSAMPLE* M_RESTRICT pDest,
                                  const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0,
@@ -158,13 +147,9 @@ static inline void copy4WithGain(CSAMPLE* M_RESTRICT pDest,
         copy3WithGain(pDest, pSrc0, gain0, pSrc1, gain1, pSrc2, gain2, iNumSamples);
         return;
     }
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples; ++i) {
-        pDest[i] = pSrc0[i] * gain0 +
-                   pSrc1[i] * gain1 +
-                   pSrc2[i] * gain2 +
-                   pSrc3[i] * gain3;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2, pSrc3};
+    const CSAMPLE_GAIN gain[] = {gain0, gain1, gain2, gain3};
+    SampleKernels::active().copyWithGain[4](pDest, pSrc, gain, iNumSamples);
 }
 static inline void copy4WithRampingGain(CSAMPLE* M_RESTRICT pDest,
                                         const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0in, CSAMPLE_GAIN gain0out,
@@ -196,21 +181,10 @@ static inline void copy4WithRampingGain(CSAMPLE* M_RESTRICT pDest,
     const CSAMPLE_GAIN start_gain2 = gain2in + gain_delta2;
     const CSAMPLE_GAIN gain_delta3 = (gain3out - gain3in) / (iNumSamples / 2);
     const CSAMPLE_GAIN start_gain3 = gain3in + gain_delta3;
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples / 2; ++i) {
-        const CSAMPLE_GAIN gain0 = start_gain0 + gain_delta0 * i;
-        const CSAMPLE_GAIN gain1 = start_gain1 + gain_delta1 * i;
-        const CSAMPLE_GAIN gain2 = start_gain2 + gain_delta2 * i;
-        const CSAMPLE_GAIN gain3 = start_gain3 + gain_delta3 * i;
-        pDest[i * 2] = pSrc0[i * 2] * gain0 +
-                       pSrc1[i * 2] * gain1 +
-                       pSrc2[i * 2] * gain2 +
-                       pSrc3[i * 2] * gain3;
-        pDest[i * 2 + 1] = pSrc0[i * 2 + 1] * gain0 +
-                           pSrc1[i * 2 + 1] * gain1 +
-                           pSrc2[i * 2 + 1] * gain2 +
-                           pSrc3[i * 2 + 1] * gain3;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2, pSrc3};
+    const CSAMPLE_GAIN startGain[] = {start_gain0, start_gain1, start_gain2, start_gain3};
+    const CSAMPLE_GAIN gainDelta[] = {gain_delta0, gain_delta1, gain_delta2, gain_delta3};
+    SampleKernels::active().copyWithRampingGain[4](pDest, pSrc, startGain, gainDelta, iNumSamples);
 }
 static inline void copy5WithGain(CSAMPLE* M_RESTRICT pDest,
                                  const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0,
@@ -239,14 +213,9 @@ static inline void copy5WithGain(CSAMPLE* M_RESTRICT pDest,
         copy4WithGain(pDest, pSrc0, gain0, pSrc1, gain1, pSrc2, gain2, pSrc3, gain3, iNumSamples);
         return;
     }
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples; ++i) {
-        pDest[i] = pSrc0[i] * gain0 +
-                   pSrc1[i] * gain1 +
-                   pSrc2[i] * gain2 +
-                   pSrc3[i] * gain3 +
-                   pSrc4[i] * gain4;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2, pSrc3, pSrc4};
+    const CSAMPLE_GAIN gain[] = {gain0, gain1, gain2, gain3, gain4};
+    SampleKernels::active().copyWithGain[5](pDest, pSrc, gain, iNumSamples);
 }
 static inline void copy5WithRampingGain(CSAMPLE* M_RESTRICT pDest,
                                         const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0in, CSAMPLE_GAIN gain0out,
@@ -285,24 +254,10 @@ static inline void copy5WithRampingGain(CSAMPLE* M_RESTRICT pDest,
     const CSAMPLE_GAIN start_gain3 = gain3in + gain_delta3;
     const CSAMPLE_GAIN gain_delta4 = (gain4out - gain4in) / (iNumSamples / 2);
     const CSAMPLE_GAIN start_gain4 = gain4in + gain_delta4;
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples / 2; ++i) {
-        const CSAMPLE_GAIN gain0 = start_gain0 + gain_delta0 * i;
-        const CSAMPLE_GAIN gain1 = start_gain1 + gain_delta1 * i;
-        const CSAMPLE_GAIN gain2 = start_gain2 + gain_delta2 * i;
-        const CSAMPLE_GAIN gain3 = start_gain3 + gain_delta3 * i;
-        const CSAMPLE_GAIN gain4 = start_gain4 + gain_delta4 * i;
-        pDest[i * 2] = pSrc0[i * 2] * gain0 +
-                       pSrc1[i * 2] * gain1 +
-                       pSrc2[i * 2] * gain2 +
-                       pSrc3[i * 2] * gain3 +
-                       pSrc4[i * 2] * gain4;
-        pDest[i * 2 + 1] = pSrc0[i * 2 + 1] * gain0 +
-                           pSrc1[i * 2 + 1] * gain1 +
-                           pSrc2[i * 2 + 1] * gain2 +
-                           pSrc3[i * 2 + 1] * gain3 +
-                           pSrc4[i * 2 + 1] * gain4;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2, pSrc3, pSrc4};
+    const CSAMPLE_GAIN startGain[] = {start_gain0, start_gain1, start_gain2, start_gain3, start_gain4};
+    const CSAMPLE_GAIN gainDelta[] = {gain_delta0, gain_delta1, gain_delta2, gain_delta3, gain_delta4};
+    SampleKernels::active().copyWithRampingGain[5](pDest, pSrc, startGain, gainDelta, iNumSamples);
 }
 static inline void copy6WithGain(CSAMPLE* M_RESTRICT pDest,
                                  const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0,
@@ -336,15 +291,9 @@ static inline void copy6WithGain(CSAMPLE* M_RESTRICT pDest,
         copy5WithGain(pDest, pSrc0, gain0, pSrc1, gain1, pSrc2, gain2, pSrc3, gain3, pSrc4, gain4, iNumSamples);
         return;
     }
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples; ++i) {
-        pDest[i] = pSrc0[i] * gain0 +
-                   pSrc1[i] * gain1 +
-                   pSrc2[i] * gain2 +
-                   pSrc3[i] * gain3 +
-                   pSrc4[i] * gain4 +
-                   pSrc5[i] * gain5;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2, pSrc3, pSrc4, pSrc5};
+    const CSAMPLE_GAIN gain[] = {gain0, gain1, gain2, gain3, gain4, gain5};
+    SampleKernels::active().copyWithGain[6](pDest, pSrc, gain, iNumSamples);
 }
 static inline void copy6WithRampingGain(CSAMPLE* M_RESTRICT pDest,
                                         const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0in, CSAMPLE_GAIN gain0out,
@@ -390,27 +339,10 @@ static inline void copy6WithRampingGain(CSAMPLE* M_RESTRICT pDest,
     const CSAMPLE_GAIN start_gain4 = gain4in + gain_delta4;
     const CSAMPLE_GAIN gain_delta5 = (gain5out - gain5in) / (iNumSamples / 2);
     const CSAMPLE_GAIN start_gain5 = gain5in + gain_delta5;
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples / 2; ++i) {
-        const CSAMPLE_GAIN gain0 = start_gain0 + gain_delta0 * i;
-        const CSAMPLE_GAIN gain1 = start_gain1 + gain_delta1 * i;
-        const CSAMPLE_GAIN gain2 = start_gain2 + gain_delta2 * i;
-        const CSAMPLE_GAIN gain3 = start_gain3 + gain_delta3 * i;
-        const CSAMPLE_GAIN gain4 = start_gain4 + gain_delta4 * i;
-        const CSAMPLE_GAIN gain5 = start_gain5 + gain_delta5 * i;
-        pDest[i * 2] = pSrc0[i * 2] * gain0 +
-                       pSrc1[i * 2] * gain1 +
-                       pSrc2[i * 2] * gain2 +
-                       pSrc3[i * 2] * gain3 +
-                       pSrc4[i * 2] * gain4 +
-                       pSrc5[i * 2] * gain5;
-        pDest[i * 2 + 1] = pSrc0[i * 2 + 1] * gain0 +
-                           pSrc1[i * 2 + 1] * gain1 +
-                           pSrc2[i * 2 + 1] * gain2 +
-                           pSrc3[i * 2 + 1] * gain3 +
-                           pSrc4[i * 2 + 1] * gain4 +
-                           pSrc5[i * 2 + 1] * gain5;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2, pSrc3, pSrc4, pSrc5};
+    const CSAMPLE_GAIN startGain[] = {start_gain0, start_gain1, start_gain2, start_gain3, start_gain4, start_gain5};
+    const CSAMPLE_GAIN gainDelta[] = {gain_delta0, gain_delta1, gain_delta2, gain_delta3, gain_delta4, gain_delta5};
+    SampleKernels::active().copyWithRampingGain[6](pDest, pSrc, startGain, gainDelta, iNumSamples);
 }
 static inline void copy7WithGain(CSAMPLE* M_RESTRICT pDest,
                                  const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0,
@@ -449,16 +381,9 @@ static inline void copy7WithGain(CSAMPLE* M_RESTRICT pDest,
         copy6WithGain(pDest, pSrc0, gain0, pSrc1, gain1, pSrc2, gain2, pSrc3, gain3, pSrc4, gain4, pSrc5, gain5, iNumSamples);
         return;
     }
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples; ++i) {
-        pDest[i] = pSrc0[i] * gain0 +
-                   pSrc1[i] * gain1 +
-                   pSrc2[i] * gain2 +
-                   pSrc3[i] * gain3 +
-                   pSrc4[i] * gain4 +
-                   pSrc5[i] * gain5 +
-                   pSrc6[i] * gain6;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2, pSrc3, pSrc4, pSrc5, pSrc6};
+    const CSAMPLE_GAIN gain[] = {gain0, gain1, gain2, gain3, gain4, gain5, gain6};
+    SampleKernels::active().copyWithGain[7](pDest, pSrc, gain, iNumSamples);
 }
 static inline void copy7WithRampingGain(CSAMPLE* M_RESTRICT pDest,
                                         const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0in, CSAMPLE_GAIN gain0out,
@@ -511,30 +436,10 @@ static inline void copy7WithRampingGain(CSAMPLE* M_RESTRICT pDest,
     const CSAMPLE_GAIN start_gain5 = gain5in + gain_delta5;
     const CSAMPLE_GAIN gain_delta6 = (gain6out - gain6in) / (iNumSamples / 2);
     const CSAMPLE_GAIN start_gain6 = gain6in + gain_delta6;
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples / 2; ++i) {
-        const CSAMPLE_GAIN gain0 = start_gain0 + gain_delta0 * i;
-        const CSAMPLE_GAIN gain1 = start_gain1 + gain_delta1 * i;
-        const CSAMPLE_GAIN gain2 = start_gain2 + gain_delta2 * i;
-        const CSAMPLE_GAIN gain3 = start_gain3 + gain_delta3 * i;
-        const CSAMPLE_GAIN gain4 = start_gain4 + gain_delta4 * i;
-        const CSAMPLE_GAIN gain5 = start_gain5 + gain_delta5 * i;
-        const CSAMPLE_GAIN gain6 = start_gain6 + gain_delta6 * i;
-        pDest[i * 2] = pSrc0[i * 2] * gain0 +
-                       pSrc1[i * 2] * gain1 +
-                       pSrc2[i * 2] * gain2 +
-                       pSrc3[i * 2] * gain3 +
-                       pSrc4[i * 2] * gain4 +
-                       pSrc5[i * 2] * gain5 +
-                       pSrc6[i * 2] * gain6;
-        pDest[i * 2 + 1] = pSrc0[i * 2 + 1] * gain0 +
-                           pSrc1[i * 2 + 1] * gain1 +
-                           pSrc2[i * 2 + 1] * gain2 +
-                           pSrc3[i * 2 + 1] * gain3 +
-                           pSrc4[i * 2 + 1] * gain4 +
-                           pSrc5[i * 2 + 1] * gain5 +
-                           pSrc6[i * 2 + 1] * gain6;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2, pSrc3, pSrc4, pSrc5, pSrc6};
+    const CSAMPLE_GAIN startGain[] = {start_gain0, start_gain1, start_gain2, start_gain3, start_gain4, start_gain5, start_gain6};
+    const CSAMPLE_GAIN gainDelta[] = {gain_delta0, gain_delta1, gain_delta2, gain_delta3, gain_delta4, gain_delta5, gain_delta6};
+    SampleKernels::active().copyWithRampingGain[7](pDest, pSrc, startGain, gainDelta, iNumSamples);
 }
 static inline void copy8WithGain(CSAMPLE* M_RESTRICT pDest,
                                  const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0,
@@ -578,17 +483,9 @@ static inline void copy8WithGain(CSAMPLE* M_RESTRICT pDest,
         copy7WithGain(pDest, pSrc0, gain0, pSrc1, gain1, pSrc2, gain2, pSrc3, gain3, pSrc4, gain4, pSrc5, gain5, pSrc6, gain6, iNumSamples);
         return;
     }
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples; ++i) {
-        pDest[i] = pSrc0[i] * gain0 +
-                   pSrc1[i] * gain1 +
-                   pSrc2[i] * gain2 +
-                   pSrc3[i] * gain3 +
-                   pSrc4[i] * gain4 +
-                   pSrc5[i] * gain5 +
-                   pSrc6[i] * gain6 +
-                   pSrc7[i] * gain7;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2, pSrc3, pSrc4, pSrc5, pSrc6, pSrc7};
+    const CSAMPLE_GAIN gain[] = {gain0, gain1, gain2, gain3, gain4, gain5, gain6, gain7};
+    SampleKernels::active().copyWithGain[8](pDest, pSrc, gain, iNumSamples);
 }
 static inline void copy8WithRampingGain(CSAMPLE* M_RESTRICT pDest,
                                         const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0in, CSAMPLE_GAIN gain0out,
@@ -648,33 +545,10 @@ static inline void copy8WithRampingGain(CSAMPLE* M_RESTRICT pDest,
     const CSAMPLE_GAIN start_gain6 = gain6in + gain_delta6;
     const CSAMPLE_GAIN gain_delta7 = (gain7out - gain7in) / (iNumSamples / 2);
     const CSAMPLE_GAIN start_gain7 = gain7in + gain_delta7;
-    // note: LOOP VECTORIZED.
-    for (int i = 0; i < iNumSamples / 2; ++i) {
-        const CSAMPLE_GAIN gain0 = start_gain0 + gain_delta0 * i;
-        const CSAMPLE_GAIN gain1 = start_gain1 + gain_delta1 * i;
-        const CSAMPLE_GAIN gain2 = start_gain2 + gain_delta2 * i;
-        const CSAMPLE_GAIN gain3 = start_gain3 + gain_delta3 * i;
-        const CSAMPLE_GAIN gain4 = start_gain4 + gain_delta4 * i;
-        const CSAMPLE_GAIN gain5 = start_gain5 + gain_delta5 * i;
-        const CSAMPLE_GAIN gain6 = start_gain6 + gain_delta6 * i;
-        const CSAMPLE_GAIN gain7 = start_gain7 + gain_delta7 * i;
-        pDest[i * 2] = pSrc0[i * 2] * gain0 +
-                       pSrc1[i * 2] * gain1 +
-                       pSrc2[i * 2] * gain2 +
-                       pSrc3[i * 2] * gain3 +
-                       pSrc4[i * 2] * gain4 +
-                       pSrc5[i * 2] * gain5 +
-                       pSrc6[i * 2] * gain6 +
-                       pSrc7[i * 2] * gain7;
-        pDest[i * 2 + 1] = pSrc0[i * 2 + 1] * gain0 +
-                           pSrc1[i * 2 + 1] * gain1 +
-                           pSrc2[i * 2 + 1] * gain2 +
-                           pSrc3[i * 2 + 1] * gain3 +
-                           pSrc4[i * 2 + 1] * gain4 +
-                           pSrc5[i * 2 + 1] * gain5 +
-                           pSrc6[i * 2 + 1] * gain6 +
-                           pSrc7[i * 2 + 1] * gain7;
-    }
+    const CSAMPLE* const pSrc[] = {pSrc0, pSrc1, pSrc2, pSrc3, pSrc4, pSrc5, pSrc6, pSrc7};
+    const CSAMPLE_GAIN startGain[] = {start_gain0, start_gain1, start_gain2, start_gain3, start_gain4, start_gain5, start_gain6, start_gain7};
+    const CSAMPLE_GAIN gainDelta[] = {gain_delta0, gain_delta1, gain_delta2, gain_delta3, gain_delta4, gain_delta5, gain_delta6, gain_delta7};
+    SampleKernels::active().copyWithRampingGain[8](pDest, pSrc, startGain, gainDelta, iNumSamples);
 }
 static inline void copy9WithGain(CSAMPLE* M_RESTRICT pDest,
                                  const CSAMPLE* M_RESTRICT pSrc0, CSAMPLE_GAIN gain0,
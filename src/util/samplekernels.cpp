@@ -0,0 +1,207 @@
+#include "util/samplekernels.h"
+
+#include <cmath>
+
+#include "util/samplekernels_impl.h"
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+namespace {
+
+void applyRampingGainScalar(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    tail::applyRampingGain(pBuffer, startGain, gainDelta, 0, numSamples / 2);
+}
+
+void addWithRampingGainScalar(CSAMPLE* pDest, const CSAMPLE* pSrc,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT numSamples) {
+    tail::addWithRampingGain(pDest, pSrc, startGain, gainDelta, 0, numSamples / 2);
+}
+
+template<int N>
+void copyWithGainScalar(CSAMPLE* pDest,
+        const CSAMPLE* const* pSrc, const CSAMPLE_GAIN* gain,
+        SINT numSamples) {
+    tail::copyWithGain<N>(pDest, pSrc, gain, 0, numSamples);
+}
+
+template<int N>
+void copyWithRampingGainScalar(CSAMPLE* pDest,
+        const CSAMPLE* const* pSrc,
+        const CSAMPLE_GAIN* startGain, const CSAMPLE_GAIN* gainDelta,
+        SINT numSamples) {
+    tail::copyWithRampingGain<N>(pDest, pSrc, startGain, gainDelta, 0, numSamples / 2);
+}
+
+int sumAbsPerChannelScalar(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
+        const CSAMPLE* pBuffer, SINT numSamples) {
+    CSAMPLE fAbsL = CSAMPLE_ZERO;
+    CSAMPLE fAbsR = CSAMPLE_ZERO;
+    CSAMPLE clippedL = 0;
+    CSAMPLE clippedR = 0;
+    for (SINT i = 0; i < numSamples / 2; ++i) {
+        CSAMPLE absl = fabs(pBuffer[i * 2]);
+        fAbsL += absl;
+        clippedL += absl > CSAMPLE_PEAK ? 1 : 0;
+        CSAMPLE absr = fabs(pBuffer[i * 2 + 1]);
+        fAbsR += absr;
+        clippedR += absr > CSAMPLE_PEAK ? 1 : 0;
+    }
+    *pfAbsL = fAbsL;
+    *pfAbsR = fAbsR;
+    return (clippedL > 0 ? 1 : 0) | (clippedR > 0 ? 2 : 0);
+}
+
+void copyClampBufferScalar(CSAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT numSamples) {
+    tail::copyClampBuffer(pDest, pSrc, 0, numSamples);
+}
+
+void interleaveBufferScalar(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1, const CSAMPLE* pSrc2, SINT numFrames) {
+    tail::interleaveBuffer(pDest, pSrc1, pSrc2, 0, numFrames);
+}
+
+void deinterleaveBufferScalar(CSAMPLE* pDest1, CSAMPLE* pDest2,
+        const CSAMPLE* pSrc, SINT numFrames) {
+    tail::deinterleaveBuffer(pDest1, pDest2, pSrc, 0, numFrames);
+}
+
+void convertS16ToFloat32Scalar(CSAMPLE* pDest, const SAMPLE* pSrc,
+        SINT numSamples) {
+    tail::convertS16ToFloat32(pDest, pSrc, 0, numSamples);
+}
+
+SampleKernels makeScalarKernels() {
+    SampleKernels kernels = {};
+    kernels.isa = SampleKernels::Isa::Scalar;
+    kernels.name = "scalar";
+    kernels.applyRampingGain = &applyRampingGainScalar;
+    kernels.addWithRampingGain = &addWithRampingGainScalar;
+    kernels.copyWithGain[3] = &copyWithGainScalar<3>;
+    kernels.copyWithGain[4] = &copyWithGainScalar<4>;
+    kernels.copyWithGain[5] = &copyWithGainScalar<5>;
+    kernels.copyWithGain[6] = &copyWithGainScalar<6>;
+    kernels.copyWithGain[7] = &copyWithGainScalar<7>;
+    kernels.copyWithGain[8] = &copyWithGainScalar<8>;
+    kernels.copyWithRampingGain[3] = &copyWithRampingGainScalar<3>;
+    kernels.copyWithRampingGain[4] = &copyWithRampingGainScalar<4>;
+    kernels.copyWithRampingGain[5] = &copyWithRampingGainScalar<5>;
+    kernels.copyWithRampingGain[6] = &copyWithRampingGainScalar<6>;
+    kernels.copyWithRampingGain[7] = &copyWithRampingGainScalar<7>;
+    kernels.copyWithRampingGain[8] = &copyWithRampingGainScalar<8>;
+    kernels.sumAbsPerChannel = &sumAbsPerChannelScalar;
+    kernels.copyClampBuffer = &copyClampBufferScalar;
+    kernels.interleaveBuffer = &interleaveBufferScalar;
+    kernels.deinterleaveBuffer = &deinterleaveBufferScalar;
+    kernels.convertS16ToFloat32 = &convertS16ToFloat32Scalar;
+    return kernels;
+}
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define MIXXX_SAMPLEKERNELS_X86
+
+bool cpuSupportsAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
+        return false;
+    }
+    // The OS must save the YMM registers on context switches
+    if ((_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool cpuSupportsAvx512() {
+#if defined(_MSC_VER)
+    if (!cpuSupportsAvx2()) {
+        return false;
+    }
+    // The OS must also save the opmask and ZMM registers
+    if ((_xgetbv(0) & 0xe6) != 0xe6) {
+        return false;
+    }
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 16)) != 0;
+#else
+    return __builtin_cpu_supports("avx512f");
+#endif
+}
+
+#endif
+
+} // anonymous namespace
+
+const SampleKernels* sampleKernelsScalar() {
+    static const SampleKernels kernels = makeScalarKernels();
+    return &kernels;
+}
+
+// static
+const SampleKernels* SampleKernels::forIsa(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar:
+        return sampleKernelsScalar();
+    case Isa::SSE2:
+        return sampleKernelsSse2();
+    case Isa::AVX2:
+#ifdef MIXXX_SAMPLEKERNELS_X86
+        if (cpuSupportsAvx2()) {
+            return sampleKernelsAvx2();
+        }
+#endif
+        return nullptr;
+    case Isa::AVX512:
+#ifdef MIXXX_SAMPLEKERNELS_X86
+        if (cpuSupportsAvx512()) {
+            return sampleKernelsAvx512();
+        }
+#endif
+        return nullptr;
+    case Isa::NEON:
+        return sampleKernelsNeon();
+    }
+    return nullptr;
+}
+
+// static
+const SampleKernels& SampleKernels::detect() {
+    static const SampleKernels* pKernels = [] {
+        // Ordered from the fastest to the slowest
+        const Isa isas[] = {
+            Isa::AVX512,
+            Isa::AVX2,
+            Isa::SSE2,
+            Isa::NEON,
+        };
+        for (Isa isa: isas) {
+            const SampleKernels* pCandidate = forIsa(isa);
+            if (pCandidate) {
+                return pCandidate;
+            }
+        }
+        return sampleKernelsScalar();
+    }();
+    return *pKernels;
+}
+
+// Selected once during static initialization
+const SampleKernels* SampleKernels::s_pActive = &SampleKernels::detect();
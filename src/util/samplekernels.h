@@ -0,0 +1,100 @@
+#ifndef MIXXX_UTIL_SAMPLEKERNELS_H
+#define MIXXX_UTIL_SAMPLEKERNELS_H
+
+#include "util/types.h"
+
+// The hot inner loops of SampleUtil, implemented once for each supported
+// instruction set. The fastest implementation that is supported by the
+// CPU is selected once at startup. The scalar implementation serves as
+// the reference and as the fallback for all other platforms.
+//
+// The kernels don't check for special gain values. All shortcuts like
+// skipping the processing for a gain of zero are handled by SampleUtil
+// before calling into a kernel. The ramping kernels expect interleaved
+// stereo samples and apply startGain + gainDelta * i to frame i, which
+// gives the same results as the scalar loops in SampleUtil.
+struct SampleKernels {
+    enum class Isa {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512,
+        NEON,
+    };
+
+    // copyWithGain and copyWithRampingGain are provided for
+    // kMinCopyChannels up to kMaxCopyChannels source buffers.
+    static constexpr int kMinCopyChannels = 3;
+    static constexpr int kMaxCopyChannels = 8;
+
+    typedef void (*ApplyRampingGainFunc)(CSAMPLE* pBuffer,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+            SINT numSamples);
+    typedef void (*AddWithRampingGainFunc)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+            SINT numSamples);
+    typedef void (*CopyWithGainFunc)(CSAMPLE* pDest,
+            const CSAMPLE* const* pSrc, const CSAMPLE_GAIN* gain,
+            SINT numSamples);
+    typedef void (*CopyWithRampingGainFunc)(CSAMPLE* pDest,
+            const CSAMPLE* const* pSrc,
+            const CSAMPLE_GAIN* startGain, const CSAMPLE_GAIN* gainDelta,
+            SINT numSamples);
+    // Returns a combination of SampleUtil::CLIP_FLAG
+    typedef int (*SumAbsPerChannelFunc)(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
+            const CSAMPLE* pBuffer, SINT numSamples);
+    typedef void (*CopyClampBufferFunc)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc, SINT numSamples);
+    typedef void (*InterleaveBufferFunc)(CSAMPLE* pDest,
+            const CSAMPLE* pSrc1, const CSAMPLE* pSrc2, SINT numFrames);
+    typedef void (*DeinterleaveBufferFunc)(CSAMPLE* pDest1, CSAMPLE* pDest2,
+            const CSAMPLE* pSrc, SINT numFrames);
+    typedef void (*ConvertS16ToFloat32Func)(CSAMPLE* pDest,
+            const SAMPLE* pSrc, SINT numSamples);
+
+    Isa isa;
+    const char* name;
+
+    ApplyRampingGainFunc applyRampingGain;
+    AddWithRampingGainFunc addWithRampingGain;
+    // Indexed by the number of source buffers. Entries below
+    // kMinCopyChannels are null.
+    CopyWithGainFunc copyWithGain[kMaxCopyChannels + 1];
+    CopyWithRampingGainFunc copyWithRampingGain[kMaxCopyChannels + 1];
+    SumAbsPerChannelFunc sumAbsPerChannel;
+    CopyClampBufferFunc copyClampBuffer;
+    InterleaveBufferFunc interleaveBuffer;
+    DeinterleaveBufferFunc deinterleaveBuffer;
+    ConvertS16ToFloat32Func convertS16ToFloat32;
+
+    // The kernels for the CPU we are running on.
+    static const SampleKernels& active() {
+        if (s_pActive) {
+            return *s_pActive;
+        }
+        // Only reached if used during static initialization
+        return detect();
+    }
+
+    // Returns null if the instruction set has not been compiled in or
+    // is not supported by the CPU.
+    static const SampleKernels* forIsa(Isa isa);
+
+  private:
+    static const SampleKernels& detect();
+
+    static const SampleKernels* s_pActive;
+};
+
+// The tables of the different instruction sets. Each of them is defined in
+// a separate translation unit that is compiled with the corresponding
+// compiler flags. They return null if the instruction set is not available
+// on the target platform.
+const SampleKernels* sampleKernelsScalar();
+const SampleKernels* sampleKernelsSse2();
+const SampleKernels* sampleKernelsAvx2();
+const SampleKernels* sampleKernelsAvx512();
+const SampleKernels* sampleKernelsNeon();
+
+#endif // MIXXX_UTIL_SAMPLEKERNELS_H
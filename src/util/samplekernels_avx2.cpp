@@ -0,0 +1,80 @@
+#include "util/samplekernels.h"
+
+// This file is compiled with AVX2 enabled, see build/depends.py. The
+// kernels must only be called after checking the CPU features.
+#if defined(__AVX2__) || (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64)))
+#define MIXXX_SAMPLEKERNELS_AVX2
+
+#include <immintrin.h>
+
+#include "util/samplekernels_impl.h"
+
+namespace {
+
+struct Avx2Ops {
+    typedef __m256 Vec;
+    static constexpr int kWidth = 8;
+
+    static Vec load(const float* p) {
+        return _mm256_loadu_ps(p);
+    }
+    static void store(float* p, Vec v) {
+        _mm256_storeu_ps(p, v);
+    }
+    static Vec set1(float x) {
+        return _mm256_set1_ps(x);
+    }
+    static Vec add(Vec a, Vec b) {
+        return _mm256_add_ps(a, b);
+    }
+    static Vec mul(Vec a, Vec b) {
+        return _mm256_mul_ps(a, b);
+    }
+    static Vec min(Vec a, Vec b) {
+        return _mm256_min_ps(a, b);
+    }
+    static Vec max(Vec a, Vec b) {
+        return _mm256_max_ps(a, b);
+    }
+    static Vec abs(Vec v) {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+    }
+    static Vec frameRamp() {
+        return _mm256_setr_ps(0, 0, 1, 1, 2, 2, 3, 3);
+    }
+    static void interleave(Vec a, Vec b, Vec* pLo, Vec* pHi) {
+        // The unpack instructions operate on each 128 bit lane separately
+        const Vec lo = _mm256_unpacklo_ps(a, b);
+        const Vec hi = _mm256_unpackhi_ps(a, b);
+        *pLo = _mm256_permute2f128_ps(lo, hi, 0x20);
+        *pHi = _mm256_permute2f128_ps(lo, hi, 0x31);
+    }
+    static void deinterleave(Vec x, Vec y, Vec* pEvens, Vec* pOdds) {
+        // The shuffles operate on each 128 bit lane separately. The
+        // results are put in order by permuting pairs of floats.
+        const Vec evens = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        const Vec odds = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1));
+        *pEvens = _mm256_castpd_ps(_mm256_permute4x64_pd(
+                _mm256_castps_pd(evens), _MM_SHUFFLE(3, 1, 2, 0)));
+        *pOdds = _mm256_castpd_ps(_mm256_permute4x64_pd(
+                _mm256_castps_pd(odds), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    static Vec loadS16(const SAMPLE* p) {
+        const __m128i s16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(s16));
+    }
+};
+
+} // anonymous namespace
+
+#endif
+
+const SampleKernels* sampleKernelsAvx2() {
+#ifdef MIXXX_SAMPLEKERNELS_AVX2
+    static const SampleKernels kernels =
+            Kernels<Avx2Ops>::table(SampleKernels::Isa::AVX2, "AVX2");
+    return &kernels;
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,83 @@
+#include "util/samplekernels.h"
+
+// This file is compiled with AVX-512F enabled, see build/depends.py. The
+// kernels must only be called after checking the CPU features.
+#if defined(__AVX512F__) || (defined(_MSC_VER) && _MSC_VER >= 1911 && defined(_M_X64))
+#define MIXXX_SAMPLEKERNELS_AVX512
+
+#include <immintrin.h>
+
+#include "util/samplekernels_impl.h"
+
+namespace {
+
+struct Avx512Ops {
+    typedef __m512 Vec;
+    static constexpr int kWidth = 16;
+
+    static Vec load(const float* p) {
+        return _mm512_loadu_ps(p);
+    }
+    static void store(float* p, Vec v) {
+        _mm512_storeu_ps(p, v);
+    }
+    static Vec set1(float x) {
+        return _mm512_set1_ps(x);
+    }
+    static Vec add(Vec a, Vec b) {
+        return _mm512_add_ps(a, b);
+    }
+    static Vec mul(Vec a, Vec b) {
+        return _mm512_mul_ps(a, b);
+    }
+    static Vec min(Vec a, Vec b) {
+        return _mm512_min_ps(a, b);
+    }
+    static Vec max(Vec a, Vec b) {
+        return _mm512_max_ps(a, b);
+    }
+    static Vec abs(Vec v) {
+        // _mm512_andnot_ps requires AVX512DQ
+        return _mm512_castsi512_ps(_mm512_and_si512(
+                _mm512_castps_si512(v), _mm512_set1_epi32(0x7fffffff)));
+    }
+    static Vec frameRamp() {
+        return _mm512_setr_ps(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+    }
+    static void interleave(Vec a, Vec b, Vec* pLo, Vec* pHi) {
+        // Indices >= 16 select from b
+        const __m512i lo = _mm512_setr_epi32(
+                0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+        const __m512i hi = _mm512_setr_epi32(
+                8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+        *pLo = _mm512_permutex2var_ps(a, lo, b);
+        *pHi = _mm512_permutex2var_ps(a, hi, b);
+    }
+    static void deinterleave(Vec x, Vec y, Vec* pEvens, Vec* pOdds) {
+        // Indices >= 16 select from y
+        const __m512i evens = _mm512_setr_epi32(
+                0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        const __m512i odds = _mm512_setr_epi32(
+                1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+        *pEvens = _mm512_permutex2var_ps(x, evens, y);
+        *pOdds = _mm512_permutex2var_ps(x, odds, y);
+    }
+    static Vec loadS16(const SAMPLE* p) {
+        const __m256i s16 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        return _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(s16));
+    }
+};
+
+} // anonymous namespace
+
+#endif
+
+const SampleKernels* sampleKernelsAvx512() {
+#ifdef MIXXX_SAMPLEKERNELS_AVX512
+    static const SampleKernels kernels =
+            Kernels<Avx512Ops>::table(SampleKernels::Isa::AVX512, "AVX-512");
+    return &kernels;
+#else
+    return nullptr;
+#endif
+}
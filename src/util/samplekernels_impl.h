@@ -0,0 +1,338 @@
+#ifndef MIXXX_UTIL_SAMPLEKERNELS_IMPL_H
+#define MIXXX_UTIL_SAMPLEKERNELS_IMPL_H
+
+// The generic implementation of the SampleKernels. Each translation unit
+// that includes this file provides a struct with the vector operations of
+// one instruction set and instantiates the kernels with it.
+//
+// Everything is defined in an anonymous namespace: The kernels are compiled
+// with different compiler flags in each translation unit and must never be
+// merged by the linker. For the same reason no inline functions from other
+// headers must be called here.
+//
+// An Ops struct provides:
+//   Vec                       the vector type
+//   kWidth                    the number of floats in a vector
+//   load(p), store(p, v)      unaligned load and store
+//   set1(x), add(a, b), mul(a, b), min(a, b), max(a, b), abs(v)
+//   frameRamp()               {0, 0, 1, 1, 2, 2, ...}, the frame index
+//                             of each lane of an interleaved stereo vector
+//   interleave(a, b, &lo, &hi)
+//   deinterleave(x, y, &evens, &odds)
+//   loadS16(p)                converts kWidth SAMPLEs to floats
+
+#include "util/samplekernels.h"
+
+namespace {
+
+// Kernel variants without vector operations, also used for the
+// remaining samples after the last complete vector.
+namespace tail {
+
+inline void applyRampingGain(CSAMPLE* pBuffer,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT startFrame, SINT numFrames) {
+    for (SINT i = startFrame; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pBuffer[i * 2] *= gain;
+        pBuffer[i * 2 + 1] *= gain;
+    }
+}
+
+inline void addWithRampingGain(CSAMPLE* pDest, const CSAMPLE* pSrc,
+        CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+        SINT startFrame, SINT numFrames) {
+    for (SINT i = startFrame; i < numFrames; ++i) {
+        const CSAMPLE_GAIN gain = startGain + gainDelta * i;
+        pDest[i * 2] += pSrc[i * 2] * gain;
+        pDest[i * 2 + 1] += pSrc[i * 2 + 1] * gain;
+    }
+}
+
+template<int N>
+inline void copyWithGain(CSAMPLE* pDest,
+        const CSAMPLE* const* pSrc, const CSAMPLE_GAIN* gain,
+        SINT start, SINT numSamples) {
+    for (SINT i = start; i < numSamples; ++i) {
+        CSAMPLE sum = pSrc[0][i] * gain[0];
+        for (int k = 1; k < N; ++k) {
+            sum += pSrc[k][i] * gain[k];
+        }
+        pDest[i] = sum;
+    }
+}
+
+template<int N>
+inline void copyWithRampingGain(CSAMPLE* pDest,
+        const CSAMPLE* const* pSrc,
+        const CSAMPLE_GAIN* startGain, const CSAMPLE_GAIN* gainDelta,
+        SINT startFrame, SINT numFrames) {
+    for (SINT i = startFrame; i < numFrames; ++i) {
+        CSAMPLE_GAIN gain[N];
+        for (int k = 0; k < N; ++k) {
+            gain[k] = startGain[k] + gainDelta[k] * i;
+        }
+        CSAMPLE sumL = pSrc[0][i * 2] * gain[0];
+        CSAMPLE sumR = pSrc[0][i * 2 + 1] * gain[0];
+        for (int k = 1; k < N; ++k) {
+            sumL += pSrc[k][i * 2] * gain[k];
+            sumR += pSrc[k][i * 2 + 1] * gain[k];
+        }
+        pDest[i * 2] = sumL;
+        pDest[i * 2 + 1] = sumR;
+    }
+}
+
+inline void copyClampBuffer(CSAMPLE* pDest, const CSAMPLE* pSrc,
+        SINT start, SINT numSamples) {
+    // Not using CSAMPLE_clamp(), because no inline functions from other
+    // headers may be called here, see the top of this file. The comparisons
+    // match min(a, b) and max(a, b) of the vector kernels.
+    for (SINT i = start; i < numSamples; ++i) {
+        const CSAMPLE sample = pSrc[i] < CSAMPLE_PEAK ? pSrc[i] : CSAMPLE_PEAK;
+        pDest[i] = sample > -CSAMPLE_PEAK ? sample : -CSAMPLE_PEAK;
+    }
+}
+
+inline void interleaveBuffer(CSAMPLE* pDest,
+        const CSAMPLE* pSrc1, const CSAMPLE* pSrc2,
+        SINT startFrame, SINT numFrames) {
+    for (SINT i = startFrame; i < numFrames; ++i) {
+        pDest[2 * i] = pSrc1[i];
+        pDest[2 * i + 1] = pSrc2[i];
+    }
+}
+
+inline void deinterleaveBuffer(CSAMPLE* pDest1, CSAMPLE* pDest2,
+        const CSAMPLE* pSrc,
+        SINT startFrame, SINT numFrames) {
+    for (SINT i = startFrame; i < numFrames; ++i) {
+        pDest1[i] = pSrc[i * 2];
+        pDest2[i] = pSrc[i * 2 + 1];
+    }
+}
+
+inline void convertS16ToFloat32(CSAMPLE* pDest, const SAMPLE* pSrc,
+        SINT start, SINT numSamples) {
+    // -SAMPLE_MIN is a power of two, so the multiplication gives
+    // exactly the same results as the division in SampleUtil
+    const CSAMPLE kConversionFactor = CSAMPLE_ONE / -SAMPLE_MIN;
+    for (SINT i = start; i < numSamples; ++i) {
+        pDest[i] = CSAMPLE(pSrc[i]) * kConversionFactor;
+    }
+}
+
+} // namespace tail
+
+template<typename Ops>
+struct Kernels {
+    typedef typename Ops::Vec Vec;
+    static constexpr int kWidth = Ops::kWidth;
+    static constexpr int kFramesPerVec = Ops::kWidth / 2;
+
+    static void applyRampingGain(CSAMPLE* pBuffer,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+            SINT numSamples) {
+        const SINT numFrames = numSamples / 2;
+        const SINT numVecFrames = numFrames - numFrames % kFramesPerVec;
+        const Vec vStartGain = Ops::set1(startGain);
+        const Vec vGainDelta = Ops::set1(gainDelta);
+        const Vec vFrameStep = Ops::set1(static_cast<float>(kFramesPerVec));
+        Vec vFrame = Ops::frameRamp();
+        for (SINT i = 0; i < numVecFrames; i += kFramesPerVec) {
+            const Vec vGain = Ops::add(vStartGain, Ops::mul(vGainDelta, vFrame));
+            CSAMPLE* p = pBuffer + i * 2;
+            Ops::store(p, Ops::mul(Ops::load(p), vGain));
+            vFrame = Ops::add(vFrame, vFrameStep);
+        }
+        tail::applyRampingGain(pBuffer, startGain, gainDelta,
+                numVecFrames, numFrames);
+    }
+
+    static void addWithRampingGain(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            CSAMPLE_GAIN startGain, CSAMPLE_GAIN gainDelta,
+            SINT numSamples) {
+        const SINT numFrames = numSamples / 2;
+        const SINT numVecFrames = numFrames - numFrames % kFramesPerVec;
+        const Vec vStartGain = Ops::set1(startGain);
+        const Vec vGainDelta = Ops::set1(gainDelta);
+        const Vec vFrameStep = Ops::set1(static_cast<float>(kFramesPerVec));
+        Vec vFrame = Ops::frameRamp();
+        for (SINT i = 0; i < numVecFrames; i += kFramesPerVec) {
+            const Vec vGain = Ops::add(vStartGain, Ops::mul(vGainDelta, vFrame));
+            CSAMPLE* p = pDest + i * 2;
+            Ops::store(p, Ops::add(Ops::load(p),
+                    Ops::mul(Ops::load(pSrc + i * 2), vGain)));
+            vFrame = Ops::add(vFrame, vFrameStep);
+        }
+        tail::addWithRampingGain(pDest, pSrc, startGain, gainDelta,
+                numVecFrames, numFrames);
+    }
+
+    template<int N>
+    static void copyWithGain(CSAMPLE* pDest,
+            const CSAMPLE* const* pSrc, const CSAMPLE_GAIN* gain,
+            SINT numSamples) {
+        const SINT numVecSamples = numSamples - numSamples % kWidth;
+        Vec vGain[N];
+        for (int k = 0; k < N; ++k) {
+            vGain[k] = Ops::set1(gain[k]);
+        }
+        for (SINT i = 0; i < numVecSamples; i += kWidth) {
+            Vec vSum = Ops::mul(Ops::load(pSrc[0] + i), vGain[0]);
+            for (int k = 1; k < N; ++k) {
+                vSum = Ops::add(vSum, Ops::mul(Ops::load(pSrc[k] + i), vGain[k]));
+            }
+            Ops::store(pDest + i, vSum);
+        }
+        tail::copyWithGain<N>(pDest, pSrc, gain, numVecSamples, numSamples);
+    }
+
+    template<int N>
+    static void copyWithRampingGain(CSAMPLE* pDest,
+            const CSAMPLE* const* pSrc,
+            const CSAMPLE_GAIN* startGain, const CSAMPLE_GAIN* gainDelta,
+            SINT numSamples) {
+        const SINT numFrames = numSamples / 2;
+        const SINT numVecFrames = numFrames - numFrames % kFramesPerVec;
+        Vec vStartGain[N];
+        Vec vGainDelta[N];
+        for (int k = 0; k < N; ++k) {
+            vStartGain[k] = Ops::set1(startGain[k]);
+            vGainDelta[k] = Ops::set1(gainDelta[k]);
+        }
+        const Vec vFrameStep = Ops::set1(static_cast<float>(kFramesPerVec));
+        Vec vFrame = Ops::frameRamp();
+        for (SINT i = 0; i < numVecFrames; i += kFramesPerVec) {
+            Vec vSum = Ops::mul(Ops::load(pSrc[0] + i * 2),
+                    Ops::add(vStartGain[0], Ops::mul(vGainDelta[0], vFrame)));
+            for (int k = 1; k < N; ++k) {
+                const Vec vGain = Ops::add(vStartGain[k],
+                        Ops::mul(vGainDelta[k], vFrame));
+                vSum = Ops::add(vSum, Ops::mul(Ops::load(pSrc[k] + i * 2), vGain));
+            }
+            Ops::store(pDest + i * 2, vSum);
+            vFrame = Ops::add(vFrame, vFrameStep);
+        }
+        tail::copyWithRampingGain<N>(pDest, pSrc, startGain, gainDelta,
+                numVecFrames, numFrames);
+    }
+
+    static int sumAbsPerChannel(CSAMPLE* pfAbsL, CSAMPLE* pfAbsR,
+            const CSAMPLE* pBuffer, SINT numSamples) {
+        const SINT numFrames = numSamples / 2;
+        const SINT numVecFrames = numFrames - numFrames % kFramesPerVec;
+        Vec vSum = Ops::set1(CSAMPLE_ZERO);
+        Vec vMax = Ops::set1(CSAMPLE_ZERO);
+        for (SINT i = 0; i < numVecFrames; i += kFramesPerVec) {
+            const Vec vAbs = Ops::abs(Ops::load(pBuffer + i * 2));
+            vSum = Ops::add(vSum, vAbs);
+            vMax = Ops::max(vMax, vAbs);
+        }
+        CSAMPLE sum[kWidth];
+        CSAMPLE max[kWidth];
+        Ops::store(sum, vSum);
+        Ops::store(max, vMax);
+        CSAMPLE fAbsL = CSAMPLE_ZERO;
+        CSAMPLE fAbsR = CSAMPLE_ZERO;
+        CSAMPLE maxL = CSAMPLE_ZERO;
+        CSAMPLE maxR = CSAMPLE_ZERO;
+        for (int k = 0; k < kWidth; k += 2) {
+            fAbsL += sum[k];
+            fAbsR += sum[k + 1];
+            maxL = max[k] > maxL ? max[k] : maxL;
+            maxR = max[k + 1] > maxR ? max[k + 1] : maxR;
+        }
+        for (SINT i = numVecFrames; i < numFrames; ++i) {
+            const CSAMPLE absl = pBuffer[i * 2] < 0 ? -pBuffer[i * 2] : pBuffer[i * 2];
+            const CSAMPLE absr = pBuffer[i * 2 + 1] < 0 ? -pBuffer[i * 2 + 1] : pBuffer[i * 2 + 1];
+            fAbsL += absl;
+            fAbsR += absr;
+            maxL = absl > maxL ? absl : maxL;
+            maxR = absr > maxR ? absr : maxR;
+        }
+        *pfAbsL = fAbsL;
+        *pfAbsR = fAbsR;
+        // Same values as SampleUtil::CLIP_FLAG
+        return (maxL > CSAMPLE_PEAK ? 1 : 0) | (maxR > CSAMPLE_PEAK ? 2 : 0);
+    }
+
+    static void copyClampBuffer(CSAMPLE* pDest, const CSAMPLE* pSrc,
+            SINT numSamples) {
+        const SINT numVecSamples = numSamples - numSamples % kWidth;
+        const Vec vMin = Ops::set1(-CSAMPLE_PEAK);
+        const Vec vMax = Ops::set1(CSAMPLE_PEAK);
+        for (SINT i = 0; i < numVecSamples; i += kWidth) {
+            Ops::store(pDest + i,
+                    Ops::max(vMin, Ops::min(Ops::load(pSrc + i), vMax)));
+        }
+        tail::copyClampBuffer(pDest, pSrc, numVecSamples, numSamples);
+    }
+
+    static void interleaveBuffer(CSAMPLE* pDest,
+            const CSAMPLE* pSrc1, const CSAMPLE* pSrc2, SINT numFrames) {
+        const SINT numVecFrames = numFrames - numFrames % kWidth;
+        for (SINT i = 0; i < numVecFrames; i += kWidth) {
+            Vec lo;
+            Vec hi;
+            Ops::interleave(Ops::load(pSrc1 + i), Ops::load(pSrc2 + i), &lo, &hi);
+            Ops::store(pDest + i * 2, lo);
+            Ops::store(pDest + i * 2 + kWidth, hi);
+        }
+        tail::interleaveBuffer(pDest, pSrc1, pSrc2, numVecFrames, numFrames);
+    }
+
+    static void deinterleaveBuffer(CSAMPLE* pDest1, CSAMPLE* pDest2,
+            const CSAMPLE* pSrc, SINT numFrames) {
+        const SINT numVecFrames = numFrames - numFrames % kWidth;
+        for (SINT i = 0; i < numVecFrames; i += kWidth) {
+            Vec evens;
+            Vec odds;
+            Ops::deinterleave(Ops::load(pSrc + i * 2),
+                    Ops::load(pSrc + i * 2 + kWidth), &evens, &odds);
+            Ops::store(pDest1 + i, evens);
+            Ops::store(pDest2 + i, odds);
+        }
+        tail::deinterleaveBuffer(pDest1, pDest2, pSrc, numVecFrames, numFrames);
+    }
+
+    static void convertS16ToFloat32(CSAMPLE* pDest, const SAMPLE* pSrc,
+            SINT numSamples) {
+        const SINT numVecSamples = numSamples - numSamples % kWidth;
+        const Vec vConversionFactor = Ops::set1(CSAMPLE_ONE / -SAMPLE_MIN);
+        for (SINT i = 0; i < numVecSamples; i += kWidth) {
+            Ops::store(pDest + i, Ops::mul(Ops::loadS16(pSrc + i), vConversionFactor));
+        }
+        tail::convertS16ToFloat32(pDest, pSrc, numVecSamples, numSamples);
+    }
+
+    static SampleKernels table(SampleKernels::Isa isa, const char* name) {
+        SampleKernels kernels = {};
+        kernels.isa = isa;
+        kernels.name = name;
+        kernels.applyRampingGain = &applyRampingGain;
+        kernels.addWithRampingGain = &addWithRampingGain;
+        kernels.copyWithGain[3] = &copyWithGain<3>;
+        kernels.copyWithGain[4] = &copyWithGain<4>;
+        kernels.copyWithGain[5] = &copyWithGain<5>;
+        kernels.copyWithGain[6] = &copyWithGain<6>;
+        kernels.copyWithGain[7] = &copyWithGain<7>;
+        kernels.copyWithGain[8] = &copyWithGain<8>;
+        kernels.copyWithRampingGain[3] = &copyWithRampingGain<3>;
+        kernels.copyWithRampingGain[4] = &copyWithRampingGain<4>;
+        kernels.copyWithRampingGain[5] = &copyWithRampingGain<5>;
+        kernels.copyWithRampingGain[6] = &copyWithRampingGain<6>;
+        kernels.copyWithRampingGain[7] = &copyWithRampingGain<7>;
+        kernels.copyWithRampingGain[8] = &copyWithRampingGain<8>;
+        kernels.sumAbsPerChannel = &sumAbsPerChannel;
+        kernels.copyClampBuffer = &copyClampBuffer;
+        kernels.interleaveBuffer = &interleaveBuffer;
+        kernels.deinterleaveBuffer = &deinterleaveBuffer;
+        kernels.convertS16ToFloat32 = &convertS16ToFloat32;
+        return kernels;
+    }
+};
+
+} // anonymous namespace
+
+#endif // MIXXX_UTIL_SAMPLEKERNELS_IMPL_H
@@ -0,0 +1,73 @@
+#include "util/samplekernels.h"
+
+// ARM builds are compiled with -mfpu=neon, see build/features.py.
+// NEON is mandatory on AArch64.
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MIXXX_SAMPLEKERNELS_NEON
+
+#include <arm_neon.h>
+
+#include "util/samplekernels_impl.h"
+
+namespace {
+
+struct NeonOps {
+    typedef float32x4_t Vec;
+    static constexpr int kWidth = 4;
+
+    static Vec load(const float* p) {
+        return vld1q_f32(p);
+    }
+    static void store(float* p, Vec v) {
+        vst1q_f32(p, v);
+    }
+    static Vec set1(float x) {
+        return vdupq_n_f32(x);
+    }
+    static Vec add(Vec a, Vec b) {
+        return vaddq_f32(a, b);
+    }
+    static Vec mul(Vec a, Vec b) {
+        return vmulq_f32(a, b);
+    }
+    static Vec min(Vec a, Vec b) {
+        return vminq_f32(a, b);
+    }
+    static Vec max(Vec a, Vec b) {
+        return vmaxq_f32(a, b);
+    }
+    static Vec abs(Vec v) {
+        return vabsq_f32(v);
+    }
+    static Vec frameRamp() {
+        const float ramp[kWidth] = {0, 0, 1, 1};
+        return vld1q_f32(ramp);
+    }
+    static void interleave(Vec a, Vec b, Vec* pLo, Vec* pHi) {
+        const float32x4x2_t zipped = vzipq_f32(a, b);
+        *pLo = zipped.val[0];
+        *pHi = zipped.val[1];
+    }
+    static void deinterleave(Vec x, Vec y, Vec* pEvens, Vec* pOdds) {
+        const float32x4x2_t unzipped = vuzpq_f32(x, y);
+        *pEvens = unzipped.val[0];
+        *pOdds = unzipped.val[1];
+    }
+    static Vec loadS16(const SAMPLE* p) {
+        return vcvtq_f32_s32(vmovl_s16(vld1_s16(p)));
+    }
+};
+
+} // anonymous namespace
+
+#endif
+
+const SampleKernels* sampleKernelsNeon() {
+#ifdef MIXXX_SAMPLEKERNELS_NEON
+    static const SampleKernels kernels =
+            Kernels<NeonOps>::table(SampleKernels::Isa::NEON, "NEON");
+    return &kernels;
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,72 @@
+#include "util/samplekernels.h"
+
+// SSE2 is part of every x86-64 CPU and of the portable 32-bit builds
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIXXX_SAMPLEKERNELS_SSE2
+
+#include <emmintrin.h>
+
+#include "util/samplekernels_impl.h"
+
+namespace {
+
+struct Sse2Ops {
+    typedef __m128 Vec;
+    static constexpr int kWidth = 4;
+
+    static Vec load(const float* p) {
+        return _mm_loadu_ps(p);
+    }
+    static void store(float* p, Vec v) {
+        _mm_storeu_ps(p, v);
+    }
+    static Vec set1(float x) {
+        return _mm_set1_ps(x);
+    }
+    static Vec add(Vec a, Vec b) {
+        return _mm_add_ps(a, b);
+    }
+    static Vec mul(Vec a, Vec b) {
+        return _mm_mul_ps(a, b);
+    }
+    static Vec min(Vec a, Vec b) {
+        return _mm_min_ps(a, b);
+    }
+    static Vec max(Vec a, Vec b) {
+        return _mm_max_ps(a, b);
+    }
+    static Vec abs(Vec v) {
+        return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+    }
+    static Vec frameRamp() {
+        return _mm_setr_ps(0, 0, 1, 1);
+    }
+    static void interleave(Vec a, Vec b, Vec* pLo, Vec* pHi) {
+        *pLo = _mm_unpacklo_ps(a, b);
+        *pHi = _mm_unpackhi_ps(a, b);
+    }
+    static void deinterleave(Vec x, Vec y, Vec* pEvens, Vec* pOdds) {
+        *pEvens = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        *pOdds = _mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+    static Vec loadS16(const SAMPLE* p) {
+        const __m128i s16 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        // Sign extension by placing the samples in the upper halves
+        const __m128i s32 = _mm_srai_epi32(_mm_unpacklo_epi16(s16, s16), 16);
+        return _mm_cvtepi32_ps(s32);
+    }
+};
+
+} // anonymous namespace
+
+#endif
+
+const SampleKernels* sampleKernelsSse2() {
+#ifdef MIXXX_SAMPLEKERNELS_SSE2
+    static const SampleKernels kernels =
+            Kernels<Sse2Ops>::table(SampleKernels::Isa::SSE2, "SSE2");
+    return &kernels;
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,191 @@
+#include "vinylcontrol/timecodelutcache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QtDebug>
+
+#include <cstring>
+
+#include "util/counter.h"
+
+namespace {
+
+// The header of a cached lookup table, followed by the hash table and the
+// slots as they are used by lut_lookup().
+struct LutHeader {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 byteOrder;
+    quint32 hashBits;
+    quint32 slotSize;
+    // The parameters of the timecode definition
+    quint32 bits;
+    quint32 seed;
+    quint32 taps;
+    quint32 length;
+};
+
+static_assert(sizeof(LutHeader) == 40,
+        "The cached lookup table header must have a fixed size");
+
+const char kLutMagic[8] = {'M', 'X', 'X', 'W', 'L', 'U', 'T', '\0'};
+// Increment when changing the layout. Files in other versions are treated
+// as missing and are replaced.
+const quint32 kLutFormatVersion = 1;
+const quint32 kLutByteOrder = 0x01020304;
+const quint32 kLutHashes = 1 << LUT_HASH_BITS;
+
+// Guards the definitions of xwax and s_mappedFiles
+QMutex s_mutex;
+// The files of the lookup tables that are in use, mapped until clear()
+QList<QFile*> s_mappedFiles;
+
+qint64 lutFileSize(const timecode_def* pDef) {
+    return sizeof(LutHeader) +
+            static_cast<qint64>(kLutHashes) * sizeof(slot_no_t) +
+            static_cast<qint64>(pDef->length) * sizeof(slot);
+}
+
+LutHeader makeHeader(const timecode_def* pDef) {
+    LutHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kLutMagic, sizeof(header.magic));
+    header.formatVersion = kLutFormatVersion;
+    header.byteOrder = kLutByteOrder;
+    header.hashBits = LUT_HASH_BITS;
+    header.slotSize = sizeof(slot);
+    header.bits = pDef->bits;
+    header.seed = pDef->seed;
+    header.taps = pDef->taps;
+    header.length = pDef->length;
+    return header;
+}
+
+// Checks that lut_lookup() stays in bounds and terminates with the mapped
+// tables. Every slot is chained to a slot that was pushed before it.
+bool isValidLut(const timecode_def* pDef, const slot_no_t* pTable,
+        const slot* pSlots) {
+    for (quint32 hash = 0; hash < kLutHashes; ++hash) {
+        if (pTable[hash] != LUT_NO_SLOT && pTable[hash] >= pDef->length) {
+            return false;
+        }
+    }
+    for (slot_no_t slotNo = 0; slotNo < pDef->length; ++slotNo) {
+        if (pSlots[slotNo].next != LUT_NO_SLOT &&
+                pSlots[slotNo].next >= slotNo) {
+            return false;
+        }
+    }
+    return pDef->length > 0 && pSlots[0].timecode == pDef->seed;
+}
+
+// Maps the cached table of the definition. Returns the file, which has to
+// stay open while the table is used, or NULL if there is no valid table.
+QFile* mapLut(timecode_def* pDef, const QString& path) {
+    QFile* pFile = new QFile(path);
+    if (!pFile->open(QIODevice::ReadOnly)) {
+        delete pFile;
+        return NULL;
+    }
+
+    const LutHeader expected = makeHeader(pDef);
+    uchar* pData = NULL;
+    if (pFile->size() == lutFileSize(pDef)) {
+        pData = pFile->map(0, pFile->size());
+    }
+    if (pData == NULL ||
+            memcmp(pData, &expected, sizeof(expected)) != 0) {
+        qWarning() << "TimecodeLutCache: ignoring invalid file" << path;
+        delete pFile;
+        return NULL;
+    }
+
+    slot_no_t* pTable = reinterpret_cast<slot_no_t*>(
+            pData + sizeof(LutHeader));
+    slot* pSlots = reinterpret_cast<slot*>(pTable + kLutHashes);
+    if (!isValidLut(pDef, pTable, pSlots)) {
+        qWarning() << "TimecodeLutCache: ignoring invalid file" << path;
+        delete pFile;
+        return NULL;
+    }
+
+    // The mapping is read-only, xwax never writes to a shared table
+    timecoder_share_lookup(pDef, pSlots, pTable);
+    return pFile;
+}
+
+void storeLut(const timecode_def* pDef, const QString& path) {
+    const LutHeader header = makeHeader(pDef);
+
+    // Written to a temporary file that replaces the cached file on commit(),
+    // so a crash never leaves a truncated table behind.
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "TimecodeLutCache: could not write" << path;
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(pDef->lut.table),
+            kLutHashes * sizeof(slot_no_t));
+    file.write(reinterpret_cast<const char*>(pDef->lut.slot),
+            static_cast<qint64>(pDef->length) * sizeof(slot));
+    if (!file.commit()) {
+        qWarning() << "TimecodeLutCache: could not write" << path;
+    }
+}
+
+} // anonymous namespace
+
+// static
+timecode_def* TimecodeLutCache::getDefinition(const QString& cachePath,
+        const char* name) {
+    QMutexLocker locker(&s_mutex);
+
+    timecode_def* pDef = timecoder_match_definition(name);
+    if (pDef == NULL || pDef->lookup) {
+        return pDef;
+    }
+
+    const QString path = filePath(cachePath, name);
+    QFile* pFile = mapLut(pDef, path);
+    if (pFile) {
+        s_mappedFiles.append(pFile);
+        Counter("TimecodeLutCache hits").increment();
+        return pDef;
+    }
+
+    Counter("TimecodeLutCache misses").increment();
+    // Built on the heap and kept there for this run
+    pDef = timecoder_find_definition(name);
+    if (pDef == NULL) {
+        return NULL;
+    }
+
+    if (QDir().mkpath(cachePath)) {
+        storeLut(pDef, path);
+    } else {
+        qWarning() << "TimecodeLutCache: could not create directory"
+                   << cachePath;
+    }
+    return pDef;
+}
+
+// static
+void TimecodeLutCache::clear() {
+    QMutexLocker locker(&s_mutex);
+    // Resets the definitions, but only frees the tables that were built on
+    // the heap
+    timecoder_free_lookup();
+    qDeleteAll(s_mappedFiles);
+    s_mappedFiles.clear();
+}
+
+// static
+QString TimecodeLutCache::filePath(const QString& cachePath,
+        const char* name) {
+    return QDir(cachePath).filePath(QString::fromLatin1(name) + ".lut");
+}
@@ -0,0 +1,40 @@
+#ifndef TIMECODELUTCACHE_H
+#define TIMECODELUTCACHE_H
+
+#include <QString>
+
+#ifdef _MSC_VER
+#include "timecoder.h"
+#else
+extern "C" {
+#include "timecoder.h"
+}
+#endif
+
+// A persistent cache of the xwax lookup tables that map the bits of a
+// timecode to the position on the record. Building the table of a Traktor
+// record takes seconds and needs tens of MB, so the table of each timecode
+// definition is built once, saved to a file in the cache directory and
+// memory-mapped read-only on the following starts. All decks that use a
+// definition share its table.
+//
+// A file is named after the definition and holds a header with the LFSR
+// parameters it was built from, the hash table and the slots, in the byte
+// order of the writer. Files that don't match are rebuilt.
+class TimecodeLutCache {
+  public:
+    // Returns the definition with the given xwax name with its lookup table,
+    // or NULL if there is no such definition or the table could not be
+    // built. Thread-safe, callers for the same definition wait for the
+    // first one to build the table.
+    static timecode_def* getDefinition(const QString& cachePath,
+            const char* name);
+
+    // Frees the tables and unmaps the files. The definitions must not be used
+    // by any timecoder anymore.
+    static void clear();
+
+    static QString filePath(const QString& cachePath, const char* name);
+};
+
+#endif /* TIMECODELUTCACHE_H */
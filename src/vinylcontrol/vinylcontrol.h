@@ -16,7 +16,12 @@ class VinylControl : public QObject {
 
     virtual void toggleVinylControl(bool enable);
     virtual bool isEnabled();
-    virtual void analyzeSamples(CSAMPLE* pSamples, size_t nFrames) = 0;
+    // Called from the VinylControlProcessor thread with the samples in the
+    // pipe from the engine callback, they must not be modified. The frames
+    // of pSamples2 follow those of pSamples1, they are split where the
+    // samples wrap around the end of the pipe.
+    virtual void analyzeSamples(const CSAMPLE* pSamples1, size_t nFrames1,
+            const CSAMPLE* pSamples2, size_t nFrames2) = 0;
     virtual bool writeQualityReport(VinylSignalQualityReport* qualityReportFifo) = 0;
 
   protected:
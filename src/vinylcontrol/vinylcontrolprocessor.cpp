@@ -5,9 +5,10 @@
 #include "control/controlpushbutton.h"
 #include "util/defs.h"
 #include "util/event.h"
-#include "util/sample.h"
+#include "util/math.h"
 #include "util/timer.h"
 #include "vinylcontrol/defs_vinylcontrol.h"
+#include "vinylcontrol/timecodelutcache.h"
 #include "vinylcontrol/vinylcontrol.h"
 #include "vinylcontrol/vinylcontrolxwax.h"
 
@@ -18,7 +19,6 @@ VinylControlProcessor::VinylControlProcessor(QObject* pParent, UserSettingsPoint
         : QThread(pParent),
           m_pConfig(pConfig),
           m_pToggle(new ControlPushButton(ConfigKey(VINYL_PREF_KEY, "Toggle"))),
-          m_pWorkBuffer(SampleUtil::alloc(MAX_BUFFER_LEN)),
           m_processorsLock(QMutex::Recursive),
           m_processors(kMaximumVinylControlInputs, NULL),
           m_signalQualityFifo(SIGNAL_QUALITY_FIFO_SIZE),
@@ -42,7 +42,6 @@ VinylControlProcessor::~VinylControlProcessor() {
     wait();
 
     delete m_pToggle;
-    SampleUtil::free(m_pWorkBuffer);
 
     {
         QMutexLocker locker(&m_processorsLock);
@@ -58,7 +57,7 @@ VinylControlProcessor::~VinylControlProcessor() {
 
     // xwax has a global LUT that we need to free after we've shut down our
     // vinyl control threads because it's not thread-safe.
-    VinylControlXwax::freeLUTs();
+    TimecodeLutCache::clear();
 }
 
 void VinylControlProcessor::setSignalQualityReporting(bool enable) {
@@ -93,20 +92,39 @@ void VinylControlProcessor::run() {
             FIFO<CSAMPLE>* pSamplePipe = m_samplePipes[i];
 
             if (pSamplePipe->readAvailable() > 0) {
-                int samplesRead = pSamplePipe->read(m_pWorkBuffer, MAX_BUFFER_LEN);
-
+                // The samples are analyzed where the engine callback has
+                // written them. They are in two regions if they wrap around
+                // the end of the pipe, which holds whole frames because its
+                // size is a power of two.
+                CSAMPLE* pRegion1;
+                ring_buffer_size_t samples1;
+                CSAMPLE* pRegion2;
+                ring_buffer_size_t samples2;
+                const int samplesAcquired = pSamplePipe->aquireReadRegions(
+                        MAX_BUFFER_LEN,
+                        &pRegion1, &samples1, &pRegion2, &samples2);
+
+                int samplesRead = samplesAcquired;
                 if (samplesRead % 2 != 0) {
                     qWarning() << "VinylControlProcessor received non-even number of samples via sample FIFO.";
+                    // The incomplete frame at the end is dropped
                     samplesRead--;
                 }
-                int framesRead = samplesRead / 2;
-
-                if (pProcessor) {
-                    pProcessor->analyzeSamples(m_pWorkBuffer, framesRead);
+                const int framesRead = samplesRead / 2;
+                const int frames1 = math_min(static_cast<int>(samples1 / 2), framesRead);
+
+                if (framesRead == 0) {
+                    // Nothing but the dropped sample, the processor needs
+                    // at least one frame
+                } else if (pProcessor) {
+                    pProcessor->analyzeSamples(pRegion1, frames1,
+                            pRegion2, framesRead - frames1);
                 } else {
                     // Samples are being written to a non-existent processor. Warning?
                     qWarning() << "Samples written to non-existent VinylControl processor:" << i;
                 }
+                // Only now the engine callback may overwrite the regions
+                pSamplePipe->releaseReadRegions(samplesAcquired);
             }
 
             // TODO(rryan) define a time-based update rate. This will update way
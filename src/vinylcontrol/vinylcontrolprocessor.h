@@ -69,9 +69,9 @@ class VinylControlProcessor : public QThread, public AudioDestination {
     ControlPushButton* m_pToggle;
     // A pre-allocated array of FIFOs for writing samples from the engine
     // callback to the processor thread. There is a maximum of
-    // kMaximumVinylControlInputs pipes.
+    // kMaximumVinylControlInputs pipes. The samples are copied once into a
+    // pipe and analyzed in place by the processor thread.
     FIFO<CSAMPLE>* m_samplePipes[kMaximumVinylControlInputs];
-    CSAMPLE* m_pWorkBuffer;
     QWaitCondition m_samplesAvailableSignal;
     QMutex m_waitForSampleMutex;
     QMutex m_processorsLock;
@@ -19,6 +19,7 @@
 *                                                                         *
 ***************************************************************************/
 
+#include <QDir>
 #include <QtDebug>
 #include <limits.h>
 
@@ -28,6 +29,7 @@
 #include "control/controlobject.h"
 #include "util/math.h"
 #include "util/defs.h"
+#include "vinylcontrol/timecodelutcache.h"
 
 /****** TODO *******
    Stuff to maybe implement here
@@ -41,8 +43,25 @@
 // Sample threshold below which we consider there to be no signal.
 const double kMinSignal = 75.0 / SAMPLE_MAX;
 
-bool VinylControlXwax::s_bLUTInitialized = false;
-QMutex VinylControlXwax::s_xwaxLUTMutex;
+namespace {
+
+// Converts CSAMPLE samples to shorts, preventing overflow.
+void convertToShorts(short* pDest, const CSAMPLE* pSrc, size_t samplesSize,
+        CSAMPLE gain) {
+    for (size_t i = 0; i < samplesSize; ++i) {
+        CSAMPLE sample = pSrc[i] * gain * SAMPLE_MAX;
+
+        if (sample > SAMPLE_MAX) {
+            pDest[i] = SAMPLE_MAX;
+        } else if (sample < SAMPLE_MIN) {
+            pDest[i] = SAMPLE_MIN;
+        } else {
+            pDest[i] = static_cast<short>(sample);
+        }
+    }
+}
+
+} // anonymous namespace
 
 VinylControlXwax::VinylControlXwax(UserSettingsPointer pConfig, QString group)
         : VinylControl(pConfig, group),
@@ -122,11 +141,15 @@ VinylControlXwax::VinylControlXwax(UserSettingsPointer pConfig, QString group)
     }
 
 
-    timecode_def* tc_def = timecoder_find_definition(timecode);
+    // The lookup tables are shared by all VinylControlXwax instances and
+    // cached on disk, so they are only built on the first start.
+    const QString lutCachePath =
+            QDir(m_pConfig->getSettingsPath()).filePath("timecodelutcache");
+    timecode_def* tc_def = TimecodeLutCache::getDefinition(lutCachePath, timecode);
     if (tc_def == NULL) {
         qDebug() << "Error finding timecode definition for " << timecode << ", defaulting to serato_2a";
         timecode = (char*)"serato_2a";
-        tc_def = timecoder_find_definition(timecode);
+        tc_def = TimecodeLutCache::getDefinition(lutCachePath, timecode);
     }
 
     double speed = 1.0;
@@ -152,20 +175,13 @@ VinylControlXwax::VinylControlXwax(UserSettingsPointer pConfig, QString group)
     m_pPitchRing = new double[m_iPitchRingSize];
 
     qDebug() << "Xwax Vinyl control starting with a sample rate of:" << iSampleRate;
-    qDebug() << "Building timecode lookup tables for" << strVinylType << "with speed" << strVinylSpeed;
-
-    // Initialize the timecoder structure. Use the static mutex so that we only
-    // do this once across the VinylControlXwax instances.
-    s_xwaxLUTMutex.lock();
+    qDebug() << "Using timecode" << strVinylType << "with speed" << strVinylSpeed;
 
+    // Initialize the timecoder structure. The lookup table of the definition
+    // is read-only from here on.
     timecoder_init(&timecoder, tc_def, speed, iSampleRate, /* phono */ false);
     timecoder_monitor_init(&timecoder, MIXXX_VINYL_SCOPE_SIZE);
-    //Note that timecoder_init will not double-malloc the LUTs, and after this we are guaranteed
-    //that the LUT has been generated unless we ran out of memory.
-    s_bLUTInitialized = true;
     m_uiSafeZone = timecoder_get_safe(&timecoder);
-    //}
-    s_xwaxLUTMutex.unlock();
 
     qDebug() << "Starting vinyl control xwax thread";
 }
@@ -180,24 +196,9 @@ VinylControlXwax::~VinylControlXwax() {
     timecoder_monitor_clear(&timecoder);
     timecoder_clear(&timecoder);
 
-    // TODO(rryan): This looks wrong. freeLUTs is called later by
-    // VinylControlProcessor so we are probably leaking the LUTs.
-    s_bLUTInitialized = false;
-
     m_pVCRate->set(0.0);
 }
 
-//static
-void VinylControlXwax::freeLUTs() {
-    s_xwaxLUTMutex.lock(); //Static mutex! We don't want two threads doing this!
-    if (s_bLUTInitialized) {
-        timecoder_free_lookup(); //Frees all the LUTs in xwax.
-        s_bLUTInitialized = false;
-    }
-    s_xwaxLUTMutex.unlock();
-}
-
-
 bool VinylControlXwax::writeQualityReport(VinylSignalQualityReport* pReport) {
     if (pReport) {
         pReport->timecode_quality = m_fTimecodeQuality;
@@ -209,7 +210,14 @@ bool VinylControlXwax::writeQualityReport(VinylSignalQualityReport* pReport) {
 }
 
 
-void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
+void VinylControlXwax::analyzeSamples(const CSAMPLE* pSamples1, size_t nFrames1,
+        const CSAMPLE* pSamples2, size_t nFrames2) {
+    const size_t nFrames = nFrames1 + nFrames2;
+    if (nFrames == 0) {
+        // The signal is checked with the first frame below, which must exist
+        return;
+    }
+
     ScopedTimer t("VinylControlXwax::analyzeSamples");
     CSAMPLE gain = m_pVinylControlInputGain->get();
     const int kChannels = 2;
@@ -227,23 +235,18 @@ void VinylControlXwax::analyzeSamples(CSAMPLE* pSamples, size_t nFrames) {
         m_workBufferSize = samplesSize;
     }
 
-    // Convert CSAMPLE samples to shorts, preventing overflow.
-    for (int i = 0; i < static_cast<int>(samplesSize); ++i) {
-        CSAMPLE sample = pSamples[i] * gain * SAMPLE_MAX;
-
-        if (sample > SAMPLE_MAX) {
-            m_pWorkBuffer[i] = SAMPLE_MAX;
-        } else if (sample < SAMPLE_MIN) {
-            m_pWorkBuffer[i] = SAMPLE_MIN;
-        } else {
-            m_pWorkBuffer[i] = static_cast<short>(sample);
-        }
-    }
+    // Both regions are converted into the work buffer, so the timecoder and
+    // the controls below are updated once for all frames.
+    const size_t samplesSize1 = nFrames1 * kChannels;
+    convertToShorts(m_pWorkBuffer, pSamples1, samplesSize1, gain);
+    convertToShorts(m_pWorkBuffer + samplesSize1, pSamples2,
+            samplesSize - samplesSize1, gain);
 
     // Submit the samples to the xwax timecode processor. The size argument is
     // in stereo frames.
     timecoder_submit(&timecoder, m_pWorkBuffer, nFrames);
 
+    const CSAMPLE* pSamples = nFrames1 > 0 ? pSamples1 : pSamples2;
     bool bHaveSignal = fabs(pSamples[0]) + fabs(pSamples[1]) > kMinSignal;
     //qDebug() << "signal?" << bHaveSignal;
 
@@ -25,8 +25,8 @@ class VinylControlXwax : public VinylControl {
     VinylControlXwax(UserSettingsPointer pConfig, QString group);
     virtual ~VinylControlXwax();
 
-    static void freeLUTs();
-    void analyzeSamples(CSAMPLE* pSamples, size_t nFrames);
+    void analyzeSamples(const CSAMPLE* pSamples1, size_t nFrames1,
+            const CSAMPLE* pSamples2, size_t nFrames2);
 
     virtual bool writeQualityReport(VinylSignalQualityReport* qualityReportFifo);
 
@@ -136,9 +136,6 @@ class VinylControlXwax : public VinylControl {
     // Contains information that xwax's code needs internally about the timecode
     // and how to process it.
     struct timecoder timecoder;
-    // Static mutex that protects our creation/destruction of the xwax LUTs
-    static QMutex s_xwaxLUTMutex;
-    static bool s_bLUTInitialized;
 };
 
 #endif
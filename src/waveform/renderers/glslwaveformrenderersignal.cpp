@@ -116,8 +116,22 @@ bool GLSLWaveformRendererSignal::loadTexture() {
         int textureWidth = waveform->getTextureStride();
         int textureHeight = waveform->getTextureSize() / waveform->getTextureStride();
 
+        // Only the rows that hold data are uploaded. The shaders never
+        // sample beyond waveformLength, and the data of mapped waveforms is
+        // not padded to the size of the texture.
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureHeight, 0,
-                     GL_RGBA, GL_UNSIGNED_BYTE, data);
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        const int fullRows = dataSize / textureWidth;
+        if (fullRows > 0) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureWidth, fullRows,
+                            GL_RGBA, GL_UNSIGNED_BYTE, data);
+        }
+        const int lastRowSize = dataSize % textureWidth;
+        if (lastRowSize > 0) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, fullRows, lastRowSize, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE,
+                            data + fullRows * textureWidth);
+        }
         int error = glGetError();
         if (error) {
             qDebug() << "GLSLWaveformRendererSignal::loadTexture - glTexImage2D error" << error;
@@ -19,10 +19,51 @@ GLWaveformRendererFilteredSignal::~GLWaveformRendererFilteredSignal() {
 
 }
 
+bool GLWaveformRendererFilteredSignal::onInit() {
+    if (!m_vertexBuffer.init()) {
+        qDebug() << "GLWaveformRendererFilteredSignal: Drawing without vertex buffers";
+    }
+    return true;
+}
+
 void GLWaveformRendererFilteredSignal::onSetup(const QDomNode& /*node*/) {
 
 }
 
+void GLWaveformRendererFilteredSignal::onSetTrack() {
+    m_vertexBuffer.clear();
+}
+
+void GLWaveformRendererFilteredSignal::setVertexBufferUniforms(float lowGain,
+        float midGain, float highGain, bool mergeChannels) {
+    QGLShaderProgram* pProgram = m_vertexBuffer.program();
+    pProgram->bind();
+    pProgram->setUniformValue("bandGains",
+            QVector3D(lowGain, midGain, highGain));
+    pProgram->setUniformValue("lowColor", QVector4D(
+            m_lowColor_r, m_lowColor_g, m_lowColor_b, 1.0));
+    pProgram->setUniformValue("midColor", QVector4D(
+            m_midColor_r, m_midColor_g, m_midColor_b, 1.0));
+    pProgram->setUniformValue("highColor", QVector4D(
+            m_highColor_r, m_highColor_g, m_highColor_b, 1.0));
+    pProgram->setUniformValue("mergeChannels", mergeChannels);
+}
+
+void GLWaveformRendererFilteredSignal::drawVertexBufferBand(int firstFrame,
+        int lastFrame, int frameStep, FilterIndex band, float alpha,
+        bool bothChannels) {
+    QGLShaderProgram* pProgram = m_vertexBuffer.program();
+    pProgram->setUniformValue("alpha", alpha);
+    pProgram->setUniformValue("bandMask", QVector3D(
+            band == Low ? 1.0 : 0.0,
+            band == Mid ? 1.0 : 0.0,
+            band == High ? 1.0 : 0.0));
+    m_vertexBuffer.drawLines(firstFrame, lastFrame, frameStep, Left);
+    if (bothChannels) {
+        m_vertexBuffer.drawLines(firstFrame, lastFrame, frameStep, Right);
+    }
+}
+
 void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*event*/) {
 
     TrackPointer pTrack = m_waveformRenderer->getTrackInfo();
@@ -58,6 +99,9 @@ void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*ev
     // Reset device for native painting
     painter->beginNativePainting();
 
+    // Only uploads the frames that have been analyzed since the last frame
+    m_vertexBuffer.update(waveform);
+
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -65,6 +109,17 @@ void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*ev
     float allGain(1.0), lowGain(1.0), midGain(1.0), highGain(1.0);
     getGains(&allGain, &lowGain, &midGain, &highGain);
 
+    // The vertex buffers have a line for each block of frameStep frames,
+    // which keeps the number of lines at about the number of pixels.
+    int frameStep = 1;
+    const double framesPerPixel = m_waveformRenderer->getVisualSamplePerPixel() / 2.0;
+    while (frameStep * 2 <= framesPerPixel) {
+        frameStep *= 2;
+    }
+    int firstFrame = math_max(static_cast<int>(firstVisualIndex), 0) / 2;
+    const int lastFrame = math_min(static_cast<int>(lastVisualIndex), dataSize) / 2;
+    firstFrame -= firstFrame % frameStep;
+
 #ifndef __OPENGLES__
 
     if (m_alignment == Qt::AlignCenter) {
@@ -98,48 +153,56 @@ void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*ev
         glLineWidth(lineWidth);
         glEnable(GL_LINE_SMOOTH);
 
-        glBegin(GL_LINES); {
-
-            int firstIndex = math_max(static_cast<int>(firstVisualIndex), 0);
-            int lastIndex = math_min(static_cast<int>(lastVisualIndex), dataSize);
-
-            glColor4f(m_lowColor_r, m_lowColor_g, m_lowColor_b, 0.8);
-            for (int visualIndex = firstIndex;
-                    visualIndex < lastIndex;
-                    visualIndex += 2) {
-
-                GLfloat maxLow0 = data[visualIndex].filtered.low;
-                GLfloat maxLow1 = data[visualIndex+1].filtered.low;
-
-                glVertex2f(visualIndex,lowGain*maxLow0);
-                glVertex2f(visualIndex,-1.f*lowGain*maxLow1);
-            }
-
-            glColor4f(m_midColor_r, m_midColor_g, m_midColor_b, 0.85);
-            for (int visualIndex = firstIndex;
-                    visualIndex < lastIndex;
-                    visualIndex += 2) {
-
-                GLfloat maxMid0 = data[visualIndex].filtered.mid;
-                GLfloat maxMid1 = data[visualIndex+1].filtered.mid;
-
-                glVertex2f(visualIndex, midGain * maxMid0);
-                glVertex2f(visualIndex,-1.f * midGain * maxMid1);
-            }
-
-            glColor4f(m_highColor_r, m_highColor_g, m_highColor_b, 0.9);
-            for (int visualIndex = firstIndex;
-                    visualIndex < lastIndex;
-                    visualIndex += 2) {
-
-                GLfloat maxHigh0 = data[visualIndex].filtered.high;
-                GLfloat maxHigh1 = data[visualIndex + 1].filtered.high;
-
-                glVertex2f(visualIndex, highGain * maxHigh0);
-                glVertex2f(visualIndex, -1.f * highGain * maxHigh1);
+        if (m_vertexBuffer.isValid()) {
+            setVertexBufferUniforms(lowGain, midGain, highGain, false);
+            drawVertexBufferBand(firstFrame, lastFrame, frameStep, Low, 0.8f, true);
+            drawVertexBufferBand(firstFrame, lastFrame, frameStep, Mid, 0.85f, true);
+            drawVertexBufferBand(firstFrame, lastFrame, frameStep, High, 0.9f, true);
+            m_vertexBuffer.program()->release();
+        } else {
+            glBegin(GL_LINES); {
+
+                int firstIndex = math_max(static_cast<int>(firstVisualIndex), 0);
+                int lastIndex = math_min(static_cast<int>(lastVisualIndex), dataSize);
+
+                glColor4f(m_lowColor_r, m_lowColor_g, m_lowColor_b, 0.8);
+                for (int visualIndex = firstIndex;
+                        visualIndex < lastIndex;
+                        visualIndex += 2) {
+
+                    GLfloat maxLow0 = data[visualIndex].filtered.low;
+                    GLfloat maxLow1 = data[visualIndex+1].filtered.low;
+
+                    glVertex2f(visualIndex,lowGain*maxLow0);
+                    glVertex2f(visualIndex,-1.f*lowGain*maxLow1);
+                }
+
+                glColor4f(m_midColor_r, m_midColor_g, m_midColor_b, 0.85);
+                for (int visualIndex = firstIndex;
+                        visualIndex < lastIndex;
+                        visualIndex += 2) {
+
+                    GLfloat maxMid0 = data[visualIndex].filtered.mid;
+                    GLfloat maxMid1 = data[visualIndex+1].filtered.mid;
+
+                    glVertex2f(visualIndex, midGain * maxMid0);
+                    glVertex2f(visualIndex,-1.f * midGain * maxMid1);
+                }
+
+                glColor4f(m_highColor_r, m_highColor_g, m_highColor_b, 0.9);
+                for (int visualIndex = firstIndex;
+                        visualIndex < lastIndex;
+                        visualIndex += 2) {
+
+                    GLfloat maxHigh0 = data[visualIndex].filtered.high;
+                    GLfloat maxHigh1 = data[visualIndex + 1].filtered.high;
+
+                    glVertex2f(visualIndex, highGain * maxHigh0);
+                    glVertex2f(visualIndex, -1.f * highGain * maxHigh1);
+                }
             }
+            glEnd();
         }
-        glEnd();
     } else { //top || bottom
         glMatrixMode(GL_PROJECTION);
         glPushMatrix();
@@ -162,51 +225,60 @@ void GLWaveformRendererFilteredSignal::draw(QPainter* painter, QPaintEvent* /*ev
         glLineWidth(lineWidth);
         glEnable(GL_LINE_SMOOTH);
 
-        glBegin(GL_LINES); {
-
-            int firstIndex = math_max(static_cast<int>(firstVisualIndex), 0);
-            int lastIndex = math_min(static_cast<int>(lastVisualIndex), dataSize);
-
-            glColor4f(m_lowColor_r, m_lowColor_g, m_lowColor_b, 0.8);
-            for (int visualIndex = firstIndex;
-                    visualIndex < lastIndex;
-                    visualIndex += 2) {
-
-                GLfloat maxLow = math_max(
-                        data[visualIndex].filtered.low,
-                        data[visualIndex+1].filtered.low);
-
-                glVertex2f(visualIndex, 0);
-                glVertex2f(visualIndex, lowGain * maxLow);
-            }
-
-            glColor4f(m_midColor_r, m_midColor_g, m_midColor_b, 0.85);
-            for (int visualIndex = firstIndex;
-                    visualIndex < lastIndex;
-                    visualIndex += 2) {
-
-                GLfloat maxMid = math_max(
-                        data[visualIndex].filtered.mid,
-                        data[visualIndex+1].filtered.mid);
-
-                glVertex2f(visualIndex, 0.f);
-                glVertex2f(visualIndex, midGain * maxMid);
-            }
-
-            glColor4f(m_highColor_r, m_highColor_g, m_highColor_b, 0.9);
-            for (int visualIndex = firstIndex;
-                    visualIndex < lastIndex;
-                    visualIndex += 2) {
-
-                GLfloat maxHigh = math_max(
-                        data[visualIndex].filtered.high,
-                        data[visualIndex + 1].filtered.high);
-
-                glVertex2f(visualIndex, 0.f);
-                glVertex2f(visualIndex, highGain * maxHigh);
+        if (m_vertexBuffer.isValid()) {
+            // The lines of the left channel with the maxima of both channels
+            setVertexBufferUniforms(lowGain, midGain, highGain, true);
+            drawVertexBufferBand(firstFrame, lastFrame, frameStep, Low, 0.8f, false);
+            drawVertexBufferBand(firstFrame, lastFrame, frameStep, Mid, 0.85f, false);
+            drawVertexBufferBand(firstFrame, lastFrame, frameStep, High, 0.9f, false);
+            m_vertexBuffer.program()->release();
+        } else {
+            glBegin(GL_LINES); {
+
+                int firstIndex = math_max(static_cast<int>(firstVisualIndex), 0);
+                int lastIndex = math_min(static_cast<int>(lastVisualIndex), dataSize);
+
+                glColor4f(m_lowColor_r, m_lowColor_g, m_lowColor_b, 0.8);
+                for (int visualIndex = firstIndex;
+                        visualIndex < lastIndex;
+                        visualIndex += 2) {
+
+                    GLfloat maxLow = math_max(
+                            data[visualIndex].filtered.low,
+                            data[visualIndex+1].filtered.low);
+
+                    glVertex2f(visualIndex, 0);
+                    glVertex2f(visualIndex, lowGain * maxLow);
+                }
+
+                glColor4f(m_midColor_r, m_midColor_g, m_midColor_b, 0.85);
+                for (int visualIndex = firstIndex;
+                        visualIndex < lastIndex;
+                        visualIndex += 2) {
+
+                    GLfloat maxMid = math_max(
+                            data[visualIndex].filtered.mid,
+                            data[visualIndex+1].filtered.mid);
+
+                    glVertex2f(visualIndex, 0.f);
+                    glVertex2f(visualIndex, midGain * maxMid);
+                }
+
+                glColor4f(m_highColor_r, m_highColor_g, m_highColor_b, 0.9);
+                for (int visualIndex = firstIndex;
+                        visualIndex < lastIndex;
+                        visualIndex += 2) {
+
+                    GLfloat maxHigh = math_max(
+                            data[visualIndex].filtered.high,
+                            data[visualIndex + 1].filtered.high);
+
+                    glVertex2f(visualIndex, 0.f);
+                    glVertex2f(visualIndex, highGain * maxHigh);
+                }
             }
+            glEnd();
         }
-        glEnd();
     }
 
     //DEBUG
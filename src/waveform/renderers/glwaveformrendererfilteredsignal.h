@@ -1,6 +1,7 @@
 #ifndef GLWAVEFROMRENDERERFILTEREDSIGNAL_H
 #define GLWAVEFROMRENDERERFILTEREDSIGNAL_H
 
+#include "waveform/renderers/glwaveformvertexbuffer.h"
 #include "waveformrenderersignalbase.h"
 
 class ControlObject;
@@ -10,8 +11,21 @@ class GLWaveformRendererFilteredSignal : public WaveformRendererSignalBase {
     explicit GLWaveformRendererFilteredSignal(WaveformWidgetRenderer* waveformWidgetRenderer);
     virtual ~GLWaveformRendererFilteredSignal();
 
+    virtual bool onInit();
     virtual void onSetup(const QDomNode &node);
     virtual void draw(QPainter* painter, QPaintEvent* event);
+
+    virtual void onSetTrack();
+
+  private:
+    void setVertexBufferUniforms(float lowGain, float midGain, float highGain,
+            bool mergeChannels);
+    void drawVertexBufferBand(int firstFrame, int lastFrame, int frameStep,
+            FilterIndex band, float alpha, bool bothChannels);
+
+    // Invalid if vertex buffers are not supported, then draw() sends the
+    // lines with glBegin()
+    GLWaveformVertexBuffer m_vertexBuffer;
 };
 
 #endif // GLWAVEFROMRENDERERFILTEREDSIGNAL_H
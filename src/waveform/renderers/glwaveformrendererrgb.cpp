@@ -17,9 +17,37 @@ GLWaveformRendererRGB::GLWaveformRendererRGB(
 GLWaveformRendererRGB::~GLWaveformRendererRGB() {
 }
 
+bool GLWaveformRendererRGB::onInit() {
+    if (!m_vertexBuffer.init()) {
+        qDebug() << "GLWaveformRendererRGB: Drawing without vertex buffers";
+    }
+    return true;
+}
+
 void GLWaveformRendererRGB::onSetup(const QDomNode& /* node */) {
 }
 
+void GLWaveformRendererRGB::onSetTrack() {
+    m_vertexBuffer.clear();
+}
+
+void GLWaveformRendererRGB::setVertexBufferUniforms(float lowGain,
+        float midGain, float highGain, float alpha, bool mergeChannels) {
+    QGLShaderProgram* pProgram = m_vertexBuffer.program();
+    pProgram->bind();
+    pProgram->setUniformValue("bandGains",
+            QVector3D(lowGain, midGain, highGain));
+    pProgram->setUniformValue("lowColor", QVector4D(
+            m_rgbLowColor_r, m_rgbLowColor_g, m_rgbLowColor_b, 1.0));
+    pProgram->setUniformValue("midColor", QVector4D(
+            m_rgbMidColor_r, m_rgbMidColor_g, m_rgbMidColor_b, 1.0));
+    pProgram->setUniformValue("highColor", QVector4D(
+            m_rgbHighColor_r, m_rgbHighColor_g, m_rgbHighColor_b, 1.0));
+    pProgram->setUniformValue("alpha", alpha);
+    pProgram->setUniformValue("mergeChannels", mergeChannels);
+    pProgram->setUniformValue("bandMask", QVector3D(0.0, 0.0, 0.0));
+}
+
 void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
     TrackPointer pTrack = m_waveformRenderer->getTrackInfo();
     if (!pTrack) {
@@ -54,6 +82,9 @@ void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
     // Reset device for native painting
     painter->beginNativePainting();
 
+    // Only uploads the frames that have been analyzed since the last frame
+    m_vertexBuffer.update(waveform);
+
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -63,6 +94,20 @@ void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
 
     const float kHeightScaleFactor = 255.0 / sqrtf(255 * 255 * 3);
 
+    // Draw a line for each block of frameStep frames instead of for each
+    // frame when a pixel covers several frames. The maxima of the blocks are
+    // precomputed, so this keeps the number of lines at about the number of
+    // pixels at every zoom level.
+    int frameStep = 1;
+    const double framesPerPixel = m_waveformRenderer->getVisualSamplePerPixel() / 2.0;
+    while (frameStep * 2 <= framesPerPixel) {
+        frameStep *= 2;
+    }
+
+    int firstFrame = math_max(static_cast<int>(firstVisualIndex), 0) / 2;
+    const int lastFrame = math_min(static_cast<int>(lastVisualIndex), dataSize) / 2;
+    firstFrame -= firstFrame % frameStep;
+
 #ifndef __OPENGLES__
 
     if (m_alignment == Qt::AlignCenter) {
@@ -95,46 +140,52 @@ void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
         glLineWidth(lineWidth);
         glEnable(GL_LINE_SMOOTH);
 
-        glBegin(GL_LINES); {
-
-            int firstIndex = math_max(static_cast<int>(firstVisualIndex), 0);
-            int lastIndex = math_min(static_cast<int>(lastVisualIndex), dataSize);
-
-            for (int visualIndex = firstIndex;
-                    visualIndex < lastIndex;
-                    visualIndex += 2) {
-
-                float left_low    = lowGain  * (float) data[visualIndex].filtered.low;
-                float left_mid    = midGain  * (float) data[visualIndex].filtered.mid;
-                float left_high   = highGain * (float) data[visualIndex].filtered.high;
-                float left_all    = sqrtf(left_low * left_low + left_mid * left_mid + left_high * left_high) * kHeightScaleFactor;
-                float left_red    = left_low  * m_rgbLowColor_r + left_mid  * m_rgbMidColor_r + left_high  * m_rgbHighColor_r;
-                float left_green  = left_low  * m_rgbLowColor_g + left_mid  * m_rgbMidColor_g + left_high  * m_rgbHighColor_g;
-                float left_blue   = left_low  * m_rgbLowColor_b + left_mid  * m_rgbMidColor_b + left_high  * m_rgbHighColor_b;
-                float left_max    = math_max3(left_red, left_green, left_blue);
-                if (left_max > 0.0f) {  // Prevent division by zero
-                    glColor4f(left_red / left_max, left_green / left_max, left_blue / left_max, 0.8f);
-                    glVertex2f(visualIndex, 0.0f);
-                    glVertex2f(visualIndex, left_all);
-                }
-
-                float right_low   = lowGain  * (float) data[visualIndex+1].filtered.low;
-                float right_mid   = midGain  * (float) data[visualIndex+1].filtered.mid;
-                float right_high  = highGain * (float) data[visualIndex+1].filtered.high;
-                float right_all   = sqrtf(right_low * right_low + right_mid * right_mid + right_high * right_high) * kHeightScaleFactor;
-                float right_red   = right_low * m_rgbLowColor_r + right_mid * m_rgbMidColor_r + right_high * m_rgbHighColor_r;
-                float right_green = right_low * m_rgbLowColor_g + right_mid * m_rgbMidColor_g + right_high * m_rgbHighColor_g;
-                float right_blue  = right_low * m_rgbLowColor_b + right_mid * m_rgbMidColor_b + right_high * m_rgbHighColor_b;
-                float right_max   = math_max3(right_red, right_green, right_blue);
-                if (right_max > 0.0f) {  // Prevent division by zero
-                    glColor4f(right_red / right_max, right_green / right_max, right_blue / right_max, 0.8f);
-                    glVertex2f(visualIndex, 0.0f);
-                    glVertex2f(visualIndex, -1.0f * right_all);
+        if (m_vertexBuffer.isValid()) {
+            setVertexBufferUniforms(lowGain, midGain, highGain, 0.8f, false);
+            m_vertexBuffer.drawLines(firstFrame, lastFrame, frameStep, Left);
+            m_vertexBuffer.drawLines(firstFrame, lastFrame, frameStep, Right);
+            m_vertexBuffer.program()->release();
+        } else {
+            glBegin(GL_LINES); {
+                for (int frame = firstFrame; frame < lastFrame; frame += frameStep) {
+                    const int visualIndex = frame * 2;
+                    const WaveformMaxData maxLeft =
+                            waveform->getMax(frame, frame + frameStep, Left);
+                    const WaveformMaxData maxRight =
+                            waveform->getMax(frame, frame + frameStep, Right);
+
+                    float left_low    = lowGain  * (float) maxLeft.bands.filtered.low;
+                    float left_mid    = midGain  * (float) maxLeft.bands.filtered.mid;
+                    float left_high   = highGain * (float) maxLeft.bands.filtered.high;
+                    float left_all    = sqrtf(maxLeft.weightedEnergy(lowGain, midGain, highGain)) * kHeightScaleFactor;
+                    float left_red    = left_low  * m_rgbLowColor_r + left_mid  * m_rgbMidColor_r + left_high  * m_rgbHighColor_r;
+                    float left_green  = left_low  * m_rgbLowColor_g + left_mid  * m_rgbMidColor_g + left_high  * m_rgbHighColor_g;
+                    float left_blue   = left_low  * m_rgbLowColor_b + left_mid  * m_rgbMidColor_b + left_high  * m_rgbHighColor_b;
+                    float left_max    = math_max3(left_red, left_green, left_blue);
+                    if (left_max > 0.0f) {  // Prevent division by zero
+                        glColor4f(left_red / left_max, left_green / left_max, left_blue / left_max, 0.8f);
+                        glVertex2f(visualIndex, 0.0f);
+                        glVertex2f(visualIndex, left_all);
+                    }
+
+                    float right_low   = lowGain  * (float) maxRight.bands.filtered.low;
+                    float right_mid   = midGain  * (float) maxRight.bands.filtered.mid;
+                    float right_high  = highGain * (float) maxRight.bands.filtered.high;
+                    float right_all   = sqrtf(maxRight.weightedEnergy(lowGain, midGain, highGain)) * kHeightScaleFactor;
+                    float right_red   = right_low * m_rgbLowColor_r + right_mid * m_rgbMidColor_r + right_high * m_rgbHighColor_r;
+                    float right_green = right_low * m_rgbLowColor_g + right_mid * m_rgbMidColor_g + right_high * m_rgbHighColor_g;
+                    float right_blue  = right_low * m_rgbLowColor_b + right_mid * m_rgbMidColor_b + right_high * m_rgbHighColor_b;
+                    float right_max   = math_max3(right_red, right_green, right_blue);
+                    if (right_max > 0.0f) {  // Prevent division by zero
+                        glColor4f(right_red / right_max, right_green / right_max, right_blue / right_max, 0.8f);
+                        glVertex2f(visualIndex, 0.0f);
+                        glVertex2f(visualIndex, -1.0f * right_all);
+                    }
                 }
             }
-        }
 
-        glEnd();
+            glEnd();
+        }
 
     } else {  // top || bottom
         glMatrixMode(GL_PROJECTION);
@@ -159,35 +210,40 @@ void GLWaveformRendererRGB::draw(QPainter* painter, QPaintEvent* /*event*/) {
         glLineWidth(lineWidth);
         glEnable(GL_LINE_SMOOTH);
 
-        glBegin(GL_LINES); {
-
-            int firstIndex = math_max(static_cast<int>(firstVisualIndex), 0);
-            int lastIndex = math_min(static_cast<int>(lastVisualIndex), dataSize);
-
-            for (int visualIndex = firstIndex;
-                    visualIndex < lastIndex;
-                    visualIndex += 2) {
-
-                float low  = lowGain  * (float) math_max(data[visualIndex].filtered.low,  data[visualIndex+1].filtered.low);
-                float mid  = midGain  * (float) math_max(data[visualIndex].filtered.mid,  data[visualIndex+1].filtered.mid);
-                float high = highGain * (float) math_max(data[visualIndex].filtered.high, data[visualIndex+1].filtered.high);
-
-                float all = sqrtf(low * low + mid * mid + high * high) * kHeightScaleFactor;
-
-                float red   = low * m_rgbLowColor_r + mid * m_rgbMidColor_r + high * m_rgbHighColor_r;
-                float green = low * m_rgbLowColor_g + mid * m_rgbMidColor_g + high * m_rgbHighColor_g;
-                float blue  = low * m_rgbLowColor_b + mid * m_rgbMidColor_b + high * m_rgbHighColor_b;
-
-                float max = math_max3(red, green, blue);
-                if (max > 0.0f) {  // Prevent division by zero
-                    glColor4f(red / max, green / max, blue / max, 0.9f);
-                    glVertex2f(float(visualIndex), 0.0f);
-                    glVertex2f(float(visualIndex), all);
+        if (m_vertexBuffer.isValid()) {
+            // The lines of the left channel with the maxima of both channels
+            setVertexBufferUniforms(lowGain, midGain, highGain, 0.9f, true);
+            m_vertexBuffer.drawLines(firstFrame, lastFrame, frameStep, Left);
+            m_vertexBuffer.program()->release();
+        } else {
+            glBegin(GL_LINES); {
+                for (int frame = firstFrame; frame < lastFrame; frame += frameStep) {
+                    const int visualIndex = frame * 2;
+                    WaveformMaxData maxFrames =
+                            waveform->getMax(frame, frame + frameStep, Left);
+                    maxFrames.merge(waveform->getMax(frame, frame + frameStep, Right));
+
+                    float low  = lowGain  * (float) maxFrames.bands.filtered.low;
+                    float mid  = midGain  * (float) maxFrames.bands.filtered.mid;
+                    float high = highGain * (float) maxFrames.bands.filtered.high;
+
+                    float all = sqrtf(low * low + mid * mid + high * high) * kHeightScaleFactor;
+
+                    float red   = low * m_rgbLowColor_r + mid * m_rgbMidColor_r + high * m_rgbHighColor_r;
+                    float green = low * m_rgbLowColor_g + mid * m_rgbMidColor_g + high * m_rgbHighColor_g;
+                    float blue  = low * m_rgbLowColor_b + mid * m_rgbMidColor_b + high * m_rgbHighColor_b;
+
+                    float max = math_max3(red, green, blue);
+                    if (max > 0.0f) {  // Prevent division by zero
+                        glColor4f(red / max, green / max, blue / max, 0.9f);
+                        glVertex2f(float(visualIndex), 0.0f);
+                        glVertex2f(float(visualIndex), all);
+                    }
                 }
             }
-        }
 
-        glEnd();
+            glEnd();
+        }
     }
 
     glPopMatrix();
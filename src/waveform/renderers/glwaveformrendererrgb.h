@@ -1,6 +1,7 @@
 #ifndef GLWAVEFORMRENDERERRGB_H
 #define GLWAVEFORMRENDERERRGB_H
 
+#include "waveform/renderers/glwaveformvertexbuffer.h"
 #include "waveformrenderersignalbase.h"
 
 class ControlObject;
@@ -10,10 +11,20 @@ class GLWaveformRendererRGB : public WaveformRendererSignalBase {
     explicit GLWaveformRendererRGB(WaveformWidgetRenderer* waveformWidgetRenderer);
     virtual ~GLWaveformRendererRGB();
 
+    virtual bool onInit();
     virtual void onSetup(const QDomNode& node);
     virtual void draw(QPainter* painter, QPaintEvent* event);
 
+    virtual void onSetTrack();
+
   private:
+    void setVertexBufferUniforms(float lowGain, float midGain, float highGain,
+            float alpha, bool mergeChannels);
+
+    // Invalid if vertex buffers are not supported, then draw() sends the
+    // lines with glBegin()
+    GLWaveformVertexBuffer m_vertexBuffer;
+
     DISALLOW_COPY_AND_ASSIGN(GLWaveformRendererRGB);
 };
 
@@ -0,0 +1,264 @@
+#include "waveform/renderers/glwaveformvertexbuffer.h"
+
+#include <vector>
+
+#include <QtDebug>
+
+#include "util/math.h"
+
+GLWaveformVertexBuffer::GLWaveformVertexBuffer()
+        : m_valid(false),
+          m_bandsLocation(-1),
+          m_otherBandsLocation(-1),
+          m_vertexAttribDivisor(nullptr),
+          m_drawArraysInstanced(nullptr),
+          m_completedFrames(0),
+          m_numFrames(0),
+          m_drawCount(0) {
+}
+
+GLWaveformVertexBuffer::~GLWaveformVertexBuffer() {
+}
+
+bool GLWaveformVertexBuffer::init() {
+    m_valid = false;
+#ifdef __OPENGLES__
+    // The shaders use the matrices of the fixed function pipeline
+    return false;
+#else
+    if (!QGLShaderProgram::hasOpenGLShaderPrograms()) {
+        qDebug() << "GLWaveformVertexBuffer::init - no shader support";
+        return false;
+    }
+
+    // From GL_ARB_instanced_arrays and GL_ARB_draw_instanced
+    const QGLContext* pContext = QGLContext::currentContext();
+    if (pContext == nullptr) {
+        return false;
+    }
+    m_vertexAttribDivisor = reinterpret_cast<VertexAttribDivisor>(
+            pContext->getProcAddress("glVertexAttribDivisorARB"));
+    m_drawArraysInstanced = reinterpret_cast<DrawArraysInstanced>(
+            pContext->getProcAddress("glDrawArraysInstancedARB"));
+    if (m_vertexAttribDivisor == nullptr || m_drawArraysInstanced == nullptr) {
+        qDebug() << "GLWaveformVertexBuffer::init - no instancing support";
+        return false;
+    }
+
+    m_pProgram = std::make_unique<QGLShaderProgram>();
+    if (!m_pProgram->addShaderFromSourceFile(
+            QGLShader::Vertex, ":shaders/waveformlines.vert") ||
+            !m_pProgram->addShaderFromSourceFile(
+            QGLShader::Fragment, ":shaders/waveformlines.frag") ||
+            !m_pProgram->link()) {
+        qDebug() << "GLWaveformVertexBuffer::init - "
+                 << m_pProgram->log();
+        return false;
+    }
+    m_bandsLocation = m_pProgram->attributeLocation("bands");
+    m_otherBandsLocation = m_pProgram->attributeLocation("otherBands");
+
+    m_lineBuffer = QGLBuffer(QGLBuffer::VertexBuffer);
+    m_lineBuffer.setUsagePattern(QGLBuffer::StaticDraw);
+    if (!m_lineBuffer.create()) {
+        qDebug() << "GLWaveformVertexBuffer::init - no vertex buffers";
+        return false;
+    }
+    const GLfloat extents[2] = {0.0f, 1.0f};
+    m_lineBuffer.bind();
+    m_lineBuffer.allocate(extents, sizeof(extents));
+    m_lineBuffer.release();
+
+    for (int level = 0; level < kNumLevels; ++level) {
+        m_levels[level].buffer = QGLBuffer(QGLBuffer::VertexBuffer);
+        m_levels[level].buffer.setUsagePattern(QGLBuffer::StaticDraw);
+    }
+
+    clear();
+    m_valid = true;
+    return true;
+#endif
+}
+
+void GLWaveformVertexBuffer::clear() {
+    m_pWaveform.clear();
+    m_completedFrames = 0;
+    m_numFrames = 0;
+}
+
+int GLWaveformVertexBuffer::residentBytes() const {
+    int bytes = 0;
+    for (int level = 0; level < kNumLevels; ++level) {
+        if (m_levels[level].resident) {
+            bytes += m_levels[level].buffer.size();
+        }
+    }
+    return bytes;
+}
+
+void GLWaveformVertexBuffer::update(ConstWaveformPointer pWaveform) {
+    if (!m_valid || pWaveform.isNull()) {
+        return;
+    }
+
+    if (pWaveform != m_pWaveform) {
+        m_pWaveform = pWaveform;
+        m_completedFrames = 0;
+        m_numFrames = pWaveform->getDataSize() / ChannelCount;
+        // The levels are uploaded again when they are drawn
+        for (int level = 0; level < kNumLevels; ++level) {
+            if (m_levels[level].resident) {
+                m_levels[level].buffer.destroy();
+                m_levels[level].resident = false;
+            }
+            m_levels[level].uploadedFrames = 0;
+        }
+    }
+
+    const int completedFrames = math_min(
+            pWaveform->getCompletion(), pWaveform->getDataSize()) / ChannelCount;
+    if (completedFrames <= m_completedFrames) {
+        return;
+    }
+    m_completedFrames = completedFrames;
+    for (int level = 0; level < kNumLevels; ++level) {
+        if (m_levels[level].resident) {
+            uploadBlocks(level, m_levels[level].uploadedFrames, completedFrames);
+        }
+    }
+}
+
+void GLWaveformVertexBuffer::makeResident(int level) {
+    int residentLevels = 0;
+    int leastRecentlyDrawn = -1;
+    for (int i = 0; i < kNumLevels; ++i) {
+        if (!m_levels[i].resident) {
+            continue;
+        }
+        ++residentLevels;
+        if (leastRecentlyDrawn < 0 ||
+                m_levels[i].lastDrawn < m_levels[leastRecentlyDrawn].lastDrawn) {
+            leastRecentlyDrawn = i;
+        }
+    }
+    if (residentLevels >= kMaxResidentLevels) {
+        m_levels[leastRecentlyDrawn].buffer.destroy();
+        m_levels[leastRecentlyDrawn].resident = false;
+        m_levels[leastRecentlyDrawn].uploadedFrames = 0;
+    }
+
+    Level& newLevel = m_levels[level];
+    if (!newLevel.buffer.create()) {
+        qDebug() << "GLWaveformVertexBuffer::makeResident - no vertex buffers";
+        return;
+    }
+    newLevel.buffer.bind();
+    newLevel.buffer.allocate(
+            numBlocks(level) * ChannelCount * sizeof(WaveformData));
+    newLevel.buffer.release();
+    newLevel.resident = true;
+    newLevel.uploadedFrames = 0;
+    uploadBlocks(level, 0, m_completedFrames);
+}
+
+void GLWaveformVertexBuffer::uploadBlocks(int level, int beginFrame,
+        int endFrame) {
+    if (beginFrame >= endFrame) {
+        return;
+    }
+    // A partially analyzed block from the last update is uploaded again
+    const int beginBlock = beginFrame >> level;
+    const int endBlock = ((endFrame - 1) >> level) + 1;
+    const int byteOffset = beginBlock * ChannelCount * sizeof(WaveformData);
+    const int byteCount =
+            (endBlock - beginBlock) * ChannelCount * sizeof(WaveformData);
+
+    Level& uploadLevel = m_levels[level];
+    uploadLevel.buffer.bind();
+    if (level == 0) {
+        // The blocks of a single frame are the data of the waveform
+        uploadLevel.buffer.write(byteOffset,
+                m_pWaveform->data() + beginBlock * ChannelCount, byteCount);
+    } else {
+        std::vector<WaveformData> blocks;
+        blocks.reserve((endBlock - beginBlock) * ChannelCount);
+        for (int block = beginBlock; block < endBlock; ++block) {
+            const int frame = block << level;
+            blocks.push_back(
+                    m_pWaveform->getMax(frame, frame + (1 << level), Left).bands);
+            blocks.push_back(
+                    m_pWaveform->getMax(frame, frame + (1 << level), Right).bands);
+        }
+        uploadLevel.buffer.write(byteOffset, blocks.data(), byteCount);
+    }
+    uploadLevel.buffer.release();
+    uploadLevel.uploadedFrames = endFrame;
+}
+
+void GLWaveformVertexBuffer::drawLines(int firstFrame, int lastFrame,
+        int frameStep, ChannelIndex channel) {
+    if (!m_valid || m_completedFrames == 0) {
+        return;
+    }
+
+    // Steps beyond the coarsest level draw more than one line per pixel,
+    // which is still cheap since nothing is uploaded.
+    int level = 0;
+    while (level + 1 < kNumLevels && (2 << level) <= frameStep) {
+        ++level;
+    }
+    const int beginBlock = math_max(firstFrame, 0) >> level;
+    const int endBlock = math_min(
+            ((lastFrame - 1) >> level) + 1,
+            ((m_completedFrames - 1) >> level) + 1);
+    if (beginBlock >= endBlock) {
+        return;
+    }
+
+    Level& drawLevel = m_levels[level];
+    if (!drawLevel.resident) {
+        makeResident(level);
+        if (!drawLevel.resident) {
+            return;
+        }
+    }
+    drawLevel.lastDrawn = ++m_drawCount;
+
+    m_pProgram->setUniformValue("firstX",
+            GLfloat((beginBlock << level) * ChannelCount));
+    m_pProgram->setUniformValue("blockWidth",
+            GLfloat((1 << level) * ChannelCount));
+    m_pProgram->setUniformValue("direction",
+            GLfloat(channel == Left ? 1.0 : -1.0));
+
+    m_lineBuffer.bind();
+    m_pProgram->enableAttributeArray("extent");
+    m_pProgram->setAttributeBuffer("extent", GL_FLOAT, 0, 1);
+    m_lineBuffer.release();
+
+    // The bands are normalized to [0, 1] by the attribute pointer and
+    // advance once per line
+    const int blockOffset = beginBlock * ChannelCount * sizeof(WaveformData);
+    const int channelOffset = sizeof(WaveformData);
+    const int stride = ChannelCount * sizeof(WaveformData);
+    drawLevel.buffer.bind();
+    m_pProgram->enableAttributeArray(m_bandsLocation);
+    m_pProgram->enableAttributeArray(m_otherBandsLocation);
+    m_pProgram->setAttributeBuffer(m_bandsLocation, GL_UNSIGNED_BYTE,
+            blockOffset + (channel == Left ? 0 : channelOffset), 4, stride);
+    m_pProgram->setAttributeBuffer(m_otherBandsLocation, GL_UNSIGNED_BYTE,
+            blockOffset + (channel == Left ? channelOffset : 0), 4, stride);
+    m_vertexAttribDivisor(m_bandsLocation, 1);
+    m_vertexAttribDivisor(m_otherBandsLocation, 1);
+    drawLevel.buffer.release();
+
+    m_drawArraysInstanced(GL_LINES, 0, 2, endBlock - beginBlock);
+
+    // The divisors are not part of the state of the program, so they must
+    // not leak into other draw calls
+    m_vertexAttribDivisor(m_bandsLocation, 0);
+    m_vertexAttribDivisor(m_otherBandsLocation, 0);
+    m_pProgram->disableAttributeArray("extent");
+    m_pProgram->disableAttributeArray(m_bandsLocation);
+    m_pProgram->disableAttributeArray(m_otherBandsLocation);
+}
@@ -0,0 +1,121 @@
+#ifndef GLWAVEFORMVERTEXBUFFER_H
+#define GLWAVEFORMVERTEXBUFFER_H
+
+#include <QGLBuffer>
+#include <QGLShaderProgram>
+#include <qgl.h>
+
+#include "util/class.h"
+#include "util/memory.h"
+#include "waveform/waveform.h"
+
+// Not defined by the GL headers of every platform
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+// Keeps the lines of a waveform in vertex buffers on the GPU for the GL
+// renderers. The frames of the waveform are uploaded once when they have been
+// analyzed. Drawing a frame of the scrolling waveform only sets the uniforms
+// of the shader program and the projection, the height and color of each
+// line are computed by the vertex shader.
+//
+// The buffers hold the maxima of the bands of each block of 1, 2, 4 and 8
+// frames, see Waveform::getMax(), stored like the data of the waveform with
+// 4 bytes for each channel of a block. The lines are drawn with instancing:
+// The two vertices of a line are the geometry of each instance, the maxima
+// of a block are per-instance attributes and the position of the line is
+// computed from the instance ID. Only the levels that are drawn are
+// uploaded and at most kMaxResidentLevels are kept on the GPU, which are at most
+// 36 MiB for the waveform of a 2 hour mix.
+//
+// All methods except clear() must be called with the GL context of the
+// renderer current.
+class GLWaveformVertexBuffer {
+  public:
+    GLWaveformVertexBuffer();
+    ~GLWaveformVertexBuffer();
+
+    // Compiles the shaders and creates the buffers. Returns false if this is
+    // not supported by the GL implementation, then the renderer has to draw
+    // the lines itself.
+    bool init();
+    bool isValid() const {
+        return m_valid;
+    }
+
+    // Forgets the uploaded waveform, e.g. when the track is unloaded.
+    void clear();
+
+    // Uploads the frames that have been analyzed since the last call. A
+    // different waveform replaces the contents of the buffers.
+    void update(ConstWaveformPointer pWaveform);
+
+    // The program has to be bound and its uniforms set before calling
+    // drawLines(). See res/shaders/waveformlines.vert for the uniforms.
+    QGLShaderProgram* program() {
+        return m_pProgram.get();
+    }
+
+    // Draws the lines of the channel for the frames [firstFrame, lastFrame)
+    // with a line for each block of frameStep frames, which is a power of
+    // two. Uploads the level of the blocks first if it is not resident.
+    void drawLines(int firstFrame, int lastFrame, int frameStep,
+            ChannelIndex channel);
+
+    // The number of bytes of the buffers on the GPU
+    int residentBytes() const;
+
+  private:
+    friend class GLWaveformVertexBufferTest;
+
+    typedef void (APIENTRY *VertexAttribDivisor)(GLuint index,
+            GLuint divisor);
+    typedef void (APIENTRY *DrawArraysInstanced)(GLenum mode, GLint first,
+            GLsizei count, GLsizei primcount);
+
+    struct Level {
+        Level()
+                : resident(false),
+                  uploadedFrames(0),
+                  lastDrawn(0) {
+        }
+        // The WaveformData of the left and right channel of each block
+        QGLBuffer buffer;
+        bool resident;
+        int uploadedFrames;
+        // The value of m_drawCount when the level has been drawn
+        int lastDrawn;
+    };
+
+    static const int kNumLevels = 4;
+    static const int kMaxResidentLevels = 2;
+
+    int numBlocks(int level) const {
+        return ((m_numFrames - 1) >> level) + 1;
+    }
+    // Allocates the buffer of the level and uploads the analyzed frames,
+    // releasing the buffer of the least recently drawn level if too many are
+    // resident.
+    void makeResident(int level);
+    void uploadBlocks(int level, int beginFrame, int endFrame);
+
+    bool m_valid;
+    std::unique_ptr<QGLShaderProgram> m_pProgram;
+    int m_bandsLocation;
+    int m_otherBandsLocation;
+    VertexAttribDivisor m_vertexAttribDivisor;
+    DrawArraysInstanced m_drawArraysInstanced;
+    // The extent of the two vertices of a line: 0 on the axis and 1 at the
+    // tip
+    QGLBuffer m_lineBuffer;
+    Level m_levels[kNumLevels];
+    ConstWaveformPointer m_pWaveform;
+    int m_completedFrames;
+    int m_numFrames;
+    int m_drawCount;
+
+    DISALLOW_COPY_AND_ASSIGN(GLWaveformVertexBuffer);
+};
+
+#endif // GLWAVEFORMVERTEXBUFFER_H
@@ -123,9 +123,6 @@ void WaveformRendererFilteredSignal::draw(QPainter* painter,
         visualFrameStart = math_clamp(visualFrameStart, 0, lastVisualFrame);
         visualFrameStop = math_clamp(visualFrameStop, 0, lastVisualFrame);
 
-        int visualIndexStart = visualFrameStart * 2;
-        int visualIndexStop = visualFrameStop * 2;
-
         // if (x == m_waveformRenderer->getLength() / 2) {
         //     qDebug() << "audioVisualRatio" << waveform->getAudioVisualRatio();
         //     qDebug() << "visualSampleRate" << waveform->getVisualSampleRate();
@@ -134,24 +131,21 @@ void WaveformRendererFilteredSignal::draw(QPainter* painter,
         //     qDebug() << "xSampleWidth" << xSampleWidth;
         //     qDebug() << "xVisualSampleIndex" << xVisualSampleIndex;
         //     qDebug() << "maxSamplingRange" << maxSamplingRange;;
-        //     qDebug() << "Sampling pixel " << x << "over [" << visualIndexStart << visualIndexStop << "]";
+        //     qDebug() << "Sampling pixel " << x << "over [" << visualFrameStart << visualFrameStop << ")";
         // }
 
-        unsigned char maxLow[2] = {0, 0};
-        unsigned char maxMid[2] = {0, 0};
-        unsigned char maxHigh[2] = {0, 0};
-
-        for (int i = visualIndexStart;
-             i >= 0 && i + 1 < dataSize && i + 1 <= visualIndexStop; i += 2) {
-            const WaveformData& waveformData = *(data + i);
-            const WaveformData& waveformDataNext = *(data + i + 1);
-            maxLow[0] = math_max(maxLow[0], waveformData.filtered.low);
-            maxLow[1] = math_max(maxLow[1], waveformDataNext.filtered.low);
-            maxMid[0] = math_max(maxMid[0], waveformData.filtered.mid);
-            maxMid[1] = math_max(maxMid[1], waveformDataNext.filtered.mid);
-            maxHigh[0] = math_max(maxHigh[0], waveformData.filtered.high);
-            maxHigh[1] = math_max(maxHigh[1], waveformDataNext.filtered.high);
-        }
+        // The maxima of the frames [visualFrameStart, visualFrameStop)
+        const WaveformMaxData maxLeft =
+                waveform->getMax(visualFrameStart, visualFrameStop, Left);
+        const WaveformMaxData maxRight =
+                waveform->getMax(visualFrameStart, visualFrameStop, Right);
+
+        const unsigned char maxLow[2] = {
+                maxLeft.bands.filtered.low, maxRight.bands.filtered.low};
+        const unsigned char maxMid[2] = {
+                maxLeft.bands.filtered.mid, maxRight.bands.filtered.mid};
+        const unsigned char maxHigh[2] = {
+                maxLeft.bands.filtered.high, maxRight.bands.filtered.high};
 
         if (maxLow[0] && maxLow[1]) {
             switch (m_alignment) {
@@ -119,27 +119,16 @@ void WaveformRendererHSV::draw(QPainter* painter,
         visualFrameStart = math_clamp(visualFrameStart, 0, lastVisualFrame);
         visualFrameStop = math_clamp(visualFrameStop, 0, lastVisualFrame);
 
-        int visualIndexStart = visualFrameStart * 2;
-        int visualIndexStop = visualFrameStop * 2;
-
-        int maxLow[2] = {0, 0};
-        int maxHigh[2] = {0, 0};
-        int maxMid[2] = {0, 0};
-        int maxAll[2] = {0, 0};
-
-        for (int i = visualIndexStart;
-             i >= 0 && i + 1 < dataSize && i + 1 <= visualIndexStop; i += 2) {
-            const WaveformData& waveformData = *(data + i);
-            const WaveformData& waveformDataNext = *(data + i + 1);
-            maxLow[0] = math_max(maxLow[0], (int)waveformData.filtered.low);
-            maxLow[1] = math_max(maxLow[1], (int)waveformDataNext.filtered.low);
-            maxMid[0] = math_max(maxMid[0], (int)waveformData.filtered.mid);
-            maxMid[1] = math_max(maxMid[1], (int)waveformDataNext.filtered.mid);
-            maxHigh[0] = math_max(maxHigh[0], (int)waveformData.filtered.high);
-            maxHigh[1] = math_max(maxHigh[1], (int)waveformDataNext.filtered.high);
-            maxAll[0] = math_max(maxAll[0], (int)waveformData.filtered.all);
-            maxAll[1] = math_max(maxAll[1], (int)waveformDataNext.filtered.all);
-        }
+        // The maxima of the frames [visualFrameStart, visualFrameStop)
+        const WaveformMaxData maxLeft =
+                waveform->getMax(visualFrameStart, visualFrameStop, Left);
+        const WaveformMaxData maxRight =
+                waveform->getMax(visualFrameStart, visualFrameStop, Right);
+
+        const int maxLow[2] = {maxLeft.bands.filtered.low, maxRight.bands.filtered.low};
+        const int maxHigh[2] = {maxLeft.bands.filtered.high, maxRight.bands.filtered.high};
+        const int maxMid[2] = {maxLeft.bands.filtered.mid, maxRight.bands.filtered.mid};
+        const int maxAll[2] = {maxLeft.bands.filtered.all, maxRight.bands.filtered.all};
 
         if (maxAll[0] && maxAll[1]) {
             // Calculate sum, to normalize
@@ -110,32 +110,20 @@ void WaveformRendererRGB::draw(QPainter* painter,
         visualFrameStart = math_clamp(visualFrameStart, 0, lastVisualFrame);
         visualFrameStop = math_clamp(visualFrameStop, 0, lastVisualFrame);
 
-        int visualIndexStart = visualFrameStart * 2;
-        int visualIndexStop  = visualFrameStop * 2;
-
-        unsigned char maxLow  = 0;
-        unsigned char maxMid  = 0;
-        unsigned char maxHigh = 0;
-        float maxAll = 0.;
-        float maxAllNext = 0.;
-
-        for (int i = visualIndexStart;
-             i >= 0 && i + 1 < dataSize && i + 1 <= visualIndexStop; i += 2) {
-            const WaveformData& waveformData = data[i];
-            const WaveformData& waveformDataNext = data[i + 1];
-
-            maxLow  = math_max3(maxLow,  waveformData.filtered.low,  waveformDataNext.filtered.low);
-            maxMid  = math_max3(maxMid,  waveformData.filtered.mid,  waveformDataNext.filtered.mid);
-            maxHigh = math_max3(maxHigh, waveformData.filtered.high, waveformDataNext.filtered.high);
-            float all = pow(waveformData.filtered.low * lowGain, 2) +
-                pow(waveformData.filtered.mid * midGain, 2) +
-                pow(waveformData.filtered.high * highGain, 2);
-            maxAll = math_max(maxAll, all);
-            float allNext = pow(waveformDataNext.filtered.low * lowGain, 2) +
-                pow(waveformDataNext.filtered.mid * midGain, 2) +
-                pow(waveformDataNext.filtered.high * highGain, 2);
-            maxAllNext = math_max(maxAllNext, allNext);
-        }
+        // The maxima of the frames [visualFrameStart, visualFrameStop)
+        const WaveformMaxData maxLeft =
+                waveform->getMax(visualFrameStart, visualFrameStop, Left);
+        const WaveformMaxData maxRight =
+                waveform->getMax(visualFrameStart, visualFrameStop, Right);
+
+        const unsigned char maxLow = math_max(
+                maxLeft.bands.filtered.low, maxRight.bands.filtered.low);
+        const unsigned char maxMid = math_max(
+                maxLeft.bands.filtered.mid, maxRight.bands.filtered.mid);
+        const unsigned char maxHigh = math_max(
+                maxLeft.bands.filtered.high, maxRight.bands.filtered.high);
+        const float maxAll = maxLeft.weightedEnergy(lowGain, midGain, highGain);
+        const float maxAllNext = maxRight.weightedEnergy(lowGain, midGain, highGain);
 
         qreal maxLowF = maxLow * lowGain;
         qreal maxMidF = maxMid * midGain;
@@ -95,6 +95,9 @@ void WaveformRenderMark::onSetTrack() {
 }
 
 void WaveformRenderMark::slotCuesUpdated() {
+    // The marks may be drawn on the render thread
+    QMutexLocker locker(m_waveformRenderer->renderMutex());
+
     TrackPointer trackInfo = m_waveformRenderer->getTrackInfo();
     if (!trackInfo){
         return;
@@ -45,7 +45,8 @@ WaveformWidgetRenderer::WaveformWidgetRenderer(const char* group)
       m_pTrackSamplesControlObject(NULL),
       m_trackSamples(0.0),
       m_scaleFactor(1.0),
-      m_playMarkerPosition(s_defaultPlayMarkerPosition) {
+      m_playMarkerPosition(s_defaultPlayMarkerPosition),
+      m_renderMutex(QMutex::Recursive) {
 
     //qDebug() << "WaveformWidgetRenderer";
 
@@ -105,7 +106,8 @@ bool WaveformWidgetRenderer::init() {
     return true;
 }
 
-void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
+void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread,
+        int extraSyncIntervals) {
     // For a valid track to render we need
     m_trackSamples = m_pTrackSamplesControlObject->get();
     if (m_trackSamples <= 0.0) {
@@ -140,7 +142,8 @@ void WaveformWidgetRenderer::onPreRender(VSyncThread* vsyncThread) {
     }
 
 
-    double truePlayPos = m_visualPlayPosition->getAtNextVSync(vsyncThread);
+    double truePlayPos = m_visualPlayPosition->getAtNextVSync(
+            vsyncThread, extraSyncIntervals);
     // m_playPos = -1 happens, when a new track is in buffer but m_visualPlayPosition was not updated
 
     if (m_audioSamplePerPixel && truePlayPos != -1) {
@@ -262,6 +265,7 @@ void WaveformWidgetRenderer::draw(QPainter* painter, QPaintEvent* event) {
 }
 
 void WaveformWidgetRenderer::resize(int width, int height, float devicePixelRatio) {
+    QMutexLocker locker(&m_renderMutex);
     m_width = width;
     m_height = height;
     m_devicePixelRatio = devicePixelRatio;
@@ -273,6 +277,7 @@ void WaveformWidgetRenderer::resize(int width, int height, float devicePixelRati
 
 void WaveformWidgetRenderer::setup(
         const QDomNode& node, const SkinContext& context) {
+    QMutexLocker locker(&m_renderMutex);
     m_scaleFactor = context.getScaleFactor();
     QString orientationString = context.selectString(node, "Orientation").toLower();
     if (orientationString == "vertical") {
@@ -290,14 +295,17 @@ void WaveformWidgetRenderer::setup(
 
 void WaveformWidgetRenderer::setZoom(int zoom) {
     //qDebug() << "WaveformWidgetRenderer::setZoom" << zoom;
+    QMutexLocker locker(&m_renderMutex);
     m_zoomFactor = math_clamp<double>(zoom, s_waveformMinZoom, s_waveformMaxZoom);
 }
 
 void WaveformWidgetRenderer::setDisplayBeatGridAlpha(int alpha) {
+    QMutexLocker locker(&m_renderMutex);
     m_alphaBeatGrid = alpha;
 }
 
 void WaveformWidgetRenderer::setTrack(TrackPointer track) {
+    QMutexLocker locker(&m_renderMutex);
     m_pTrack = track;
     //used to postpone first display until track sample is actually available
     m_trackSamples = -1.0;
@@ -1,6 +1,7 @@
 #ifndef WAVEFORMWIDGETRENDERER_H
 #define WAVEFORMWIDGETRENDERER_H
 
+#include <QMutex>
 #include <QPainter>
 #include <QTime>
 #include <QVector>
@@ -34,7 +35,9 @@ class WaveformWidgetRenderer {
     virtual bool onInit() {return true;}
 
     void setup(const QDomNode& node, const SkinContext& context);
-    void onPreRender(VSyncThread* vsyncThread);
+    // extraSyncIntervals predicts the play position for a frame that is
+    // displayed that many sync intervals after the next one.
+    void onPreRender(VSyncThread* vsyncThread, int extraSyncIntervals = 0);
     void draw(QPainter* painter, QPaintEvent* event);
 
     inline const char* getGroup() const { return m_group;}
@@ -103,9 +106,16 @@ class WaveformWidgetRenderer {
         VERIFY_OR_DEBUG_ASSERT(newPos >= 0.0 && newPos <= 1.0) {
             newPos = math_clamp(newPos, 0.0, 1.0);
         }
+        QMutexLocker locker(&m_renderMutex);
         m_playMarkerPosition = newPos;
     }
 
+    // Held while a frame is rendered on the WaveformRenderThread. The GUI
+    // thread holds it while it changes the state of the renderers.
+    QMutex* renderMutex() {
+        return &m_renderMutex;
+    }
+
   protected:
     const char* m_group;
     TrackPointer m_pTrack;
@@ -144,6 +154,7 @@ class WaveformWidgetRenderer {
     int m_trackSamples;
     double m_scaleFactor;
     double m_playMarkerPosition;   // 0.0 - left, 0.5 - center, 1.0 - right
+    QMutex m_renderMutex;
 
 #ifdef WAVEFORMWIDGETRENDERER_DEBUG
     PerformanceTimer* m_timer;
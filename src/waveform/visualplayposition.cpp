@@ -50,16 +50,22 @@ void VisualPlayPosition::set(double playPos, double rate,
     m_valid = true;
 }
 
-double VisualPlayPosition::getAtNextVSync(VSyncThread* vsyncThread) {
+double VisualPlayPosition::getAtNextVSync(VSyncThread* vsyncThread,
+        int extraSyncIntervals) {
     //static double testPos = 0;
     //testPos += 0.000017759; //0.000016608; //  1.46257e-05;
     //return testPos;
 
     if (m_valid) {
         VisualPlayPositionData data = m_data.getValue();
-        int refToVSync = vsyncThread->fromTimerToNextSyncMicros(data.m_referenceTime);
+        const int extraMicros =
+                extraSyncIntervals * vsyncThread->syncIntervalTimeMicros();
+        int refToVSync = vsyncThread->fromTimerToNextSyncMicros(data.m_referenceTime)
+                + extraMicros;
         int offset = refToVSync - data.m_callbackEntrytoDac;
-        offset = math_min(offset, m_audioBufferMicros * kMaxOffsetBufferCnt);
+        // The frames displayed later are predicted further ahead
+        offset = math_min(offset,
+                m_audioBufferMicros * kMaxOffsetBufferCnt + extraMicros);
         double playPos = data.m_enginePlayPos;  // load playPos for the first sample in Buffer
         // add the offset for the position of the sample that will be transferred to the DAC
         // When the next display frame is displayed
@@ -46,7 +46,9 @@ class VisualPlayPosition : public QObject {
     // WARNING: Not thread safe. This function must be called only from the
     // engine thread.
     void set(double playPos, double rate, double positionStep, double pSlipPosition);
-    double getAtNextVSync(VSyncThread* vsyncThread);
+    // Thread safe. extraSyncIntervals returns the position for a frame that
+    // is displayed that many sync intervals after the next one.
+    double getAtNextVSync(VSyncThread* vsyncThread, int extraSyncIntervals = 0);
     void getPlaySlipAt(int usFromNow, double* playPosition, double* slipPosition);
     double getEnginePlayPos();
 
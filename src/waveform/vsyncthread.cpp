@@ -152,6 +152,10 @@ void VSyncThread::setSyncIntervalTimeMicros(int syncTime) {
     m_vSyncPerRendering = round(m_displayFrameRate * m_syncIntervalTimeMicros / 1000);
 }
 
+int VSyncThread::syncIntervalTimeMicros() const {
+    return m_syncIntervalTimeMicros;
+}
+
 void VSyncThread::setVSyncType(int type) {
     if (type >= (int)VSyncThread::ST_COUNT) {
         type = VSyncThread::ST_TIMER;
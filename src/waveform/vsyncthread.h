@@ -54,6 +54,7 @@ class VSyncThread : public QThread {
     int elapsed();
     int toNextSyncMicros();
     void setSyncIntervalTimeMicros(int usSyncTimer);
+    int syncIntervalTimeMicros() const;
     void setVSyncType(int mode);
     int droppedFrames();
     void setSwapWait(int sw);
@@ -1,12 +1,150 @@
+#include <QFile>
 #include <QtDebug>
 
+#include <cstring>
+
 #include "waveform/waveform.h"
 #include "proto/waveform.pb.h"
+#include "util/math.h"
 
 using namespace mixxx::track;
 
 const int kNumChannels = 2;
 
+namespace {
+
+// The header of the compact format, see Waveform::toByteArray(). All fields
+// are stored in the byte order of the writer, which is recorded in
+// byteOrder. The data starts at headerSize bytes from the start of the
+// file, which is a multiple of sizeof(WaveformData) so it is aligned when
+// the file is mapped into memory.
+struct CompactHeader {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 byteOrder;
+    quint32 headerSize;
+    // The number of WaveformData elements
+    quint32 dataSize;
+    quint32 channels;
+    // The number of bytes of each WaveformData element: low, mid, high, all
+    quint32 bands;
+    double visualSampleRate;
+    double audioVisualRatio;
+    // The pyramid of maxima for Waveform::getMax() follows the data
+    quint32 pyramidBlockFrames;
+    // The number of WaveformMaxData elements of the pyramid
+    quint32 pyramidSize;
+    char reserved[8];
+};
+
+static_assert(sizeof(CompactHeader) == 64,
+        "The compact waveform header must have a fixed size");
+static_assert(sizeof(WaveformData) == 4,
+        "WaveformData must be packed into 4 bytes");
+static_assert(sizeof(WaveformMaxData) == 8,
+        "WaveformMaxData must be packed into 8 bytes");
+
+const char kCompactMagic[8] = {'M', 'X', 'W', 'A', 'V', 'E', '\0', '\0'};
+// Increment when changing the layout. Files in other versions are treated
+// as invalid and are recreated by the analyzer.
+const quint32 kCompactFormatVersion = 2;
+const quint32 kCompactByteOrder = 0x01020304;
+const quint32 kCompactBands = 4;
+
+// The number of frames of the blocks of level 0 of the pyramid of maxima.
+// Shorter ranges are read from the data, which keeps the pyramid at 1/4 of
+// the size of the data.
+const int kPyramidBlockFrames = 16;
+
+// The offsets of the levels of the pyramid in the WaveformMaxData of both
+// channels, followed by the total size.
+std::vector<int> pyramidLevelOffsets(int frames) {
+    std::vector<int> offsets;
+    offsets.push_back(0);
+    int blocks = (frames + kPyramidBlockFrames - 1) / kPyramidBlockFrames;
+    while (blocks > 0) {
+        offsets.push_back(offsets.back() + blocks * kNumChannels);
+        if (blocks == 1) {
+            break;
+        }
+        blocks = (blocks + 1) / 2;
+    }
+    return offsets;
+}
+
+// Updates the blocks of the pyramid that contain the frames
+// [beginFrame, endFrame).
+void updatePyramidBlocks(const WaveformData* pData, int frames,
+        const std::vector<int>& levelOffsets, WaveformMaxData* pPyramid,
+        int beginFrame, int endFrame) {
+    int beginBlock = beginFrame / kPyramidBlockFrames;
+    int endBlock = (endFrame + kPyramidBlockFrames - 1) / kPyramidBlockFrames;
+
+    WaveformMaxData* pBaseBlocks = pPyramid + levelOffsets[0];
+    for (int block = beginBlock; block < endBlock; ++block) {
+        const int blockEndFrame = math_min((block + 1) * kPyramidBlockFrames, frames);
+        for (int channel = 0; channel < kNumChannels; ++channel) {
+            WaveformMaxData max;
+            for (int frame = block * kPyramidBlockFrames;
+                    frame < blockEndFrame; ++frame) {
+                max.merge(pData[frame * kNumChannels + channel]);
+            }
+            pBaseBlocks[block * kNumChannels + channel] = max;
+        }
+    }
+
+    for (size_t level = 1; level + 1 < levelOffsets.size(); ++level) {
+        const WaveformMaxData* pLowerBlocks = pPyramid + levelOffsets[level - 1];
+        const int lowerSize = levelOffsets[level] - levelOffsets[level - 1];
+        WaveformMaxData* pBlocks = pPyramid + levelOffsets[level];
+        beginBlock /= 2;
+        endBlock = (endBlock + 1) / 2;
+        for (int block = beginBlock; block < endBlock; ++block) {
+            const int lower = 2 * block * kNumChannels;
+            for (int channel = 0; channel < kNumChannels; ++channel) {
+                WaveformMaxData max = pLowerBlocks[lower + channel];
+                if (lower + kNumChannels < lowerSize) {
+                    max.merge(pLowerBlocks[lower + kNumChannels + channel]);
+                }
+                pBlocks[block * kNumChannels + channel] = max;
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+void WaveformMaxData::merge(const WaveformMaxData& other) {
+    bands.filtered.low = math_max(bands.filtered.low, other.bands.filtered.low);
+    bands.filtered.mid = math_max(bands.filtered.mid, other.bands.filtered.mid);
+    bands.filtered.high = math_max(bands.filtered.high, other.bands.filtered.high);
+    bands.filtered.all = math_max(bands.filtered.all, other.bands.filtered.all);
+    energy = math_max(energy, other.energy);
+}
+
+void WaveformMaxData::merge(const WaveformData& data) {
+    bands.filtered.low = math_max(bands.filtered.low, data.filtered.low);
+    bands.filtered.mid = math_max(bands.filtered.mid, data.filtered.mid);
+    bands.filtered.high = math_max(bands.filtered.high, data.filtered.high);
+    bands.filtered.all = math_max(bands.filtered.all, data.filtered.all);
+    const unsigned int low = data.filtered.low;
+    const unsigned int mid = data.filtered.mid;
+    const unsigned int high = data.filtered.high;
+    energy = math_max(energy, low * low + mid * mid + high * high);
+}
+
+float WaveformMaxData::weightedEnergy(
+        float lowGain, float midGain, float highGain) const {
+    // The bands may have their maxima at different samples, so this is only
+    // exact for a single sample.
+    const float low = bands.filtered.low * lowGain;
+    const float mid = bands.filtered.mid * midGain;
+    const float high = bands.filtered.high * highGain;
+    const float maxGain = math_max3(lowGain, midGain, highGain);
+    return math_min(low * low + mid * mid + high * high,
+            maxGain * maxGain * energy);
+}
+
 // Return the smallest power of 2 which is greater than the desired size when
 // squared.
 int computeTextureStride(int size) {
@@ -21,9 +159,14 @@ Waveform::Waveform(const QByteArray data)
         : m_id(-1),
           m_saveState(SaveState::NotSaved),
           m_dataSize(0),
+          m_pData(nullptr),
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(computeTextureStride(0)),
+          m_textureSize(0),
+          m_pPyramid(nullptr),
+          m_pyramidLevelOffsets(1, 0),
+          m_pyramidFrames(0),
           m_completion(-1) {
     readByteArray(data);
 }
@@ -33,9 +176,14 @@ Waveform::Waveform(int audioSampleRate, int audioSamples,
         : m_id(-1),
           m_saveState(SaveState::NotSaved),
           m_dataSize(0),
+          m_pData(nullptr),
           m_visualSampleRate(0),
           m_audioVisualRatio(0),
           m_textureStride(1024),
+          m_textureSize(0),
+          m_pPyramid(nullptr),
+          m_pyramidLevelOffsets(1, 0),
+          m_pyramidFrames(0),
           m_completion(-1) {
     int numberOfVisualSamples = 0;
     if (audioSampleRate > 0) {
@@ -67,7 +215,60 @@ Waveform::Waveform(int audioSampleRate, int audioSamples,
 Waveform::~Waveform() {
 }
 
+//static
+Waveform* Waveform::fromMappedFile(const QString& fileName) {
+    Waveform* pWaveform = new Waveform();
+    auto pFile = std::make_unique<QFile>(fileName);
+    if (!pFile->open(QIODevice::ReadOnly)) {
+        qDebug() << "ERROR: Could not open waveform file" << fileName;
+        return pWaveform;
+    }
+    if (!pWaveform->mapFile(std::move(pFile))) {
+        qDebug() << "ERROR: Could not map waveform file" << fileName;
+    }
+    return pWaveform;
+}
+
 QByteArray Waveform::toByteArray() const {
+    const int dataSize = getDataSize();
+
+    CompactHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kCompactMagic, sizeof(header.magic));
+    header.formatVersion = kCompactFormatVersion;
+    header.byteOrder = kCompactByteOrder;
+    header.headerSize = sizeof(header);
+    header.dataSize = dataSize;
+    header.channels = kNumChannels;
+    header.bands = kCompactBands;
+    header.visualSampleRate = m_visualSampleRate;
+    header.audioVisualRatio = m_audioVisualRatio;
+    header.pyramidBlockFrames = kPyramidBlockFrames;
+    header.pyramidSize = m_pyramidLevelOffsets.back();
+
+    // The pyramid is only complete if the waveform is
+    const WaveformMaxData* pPyramid = m_pPyramid;
+    std::vector<WaveformMaxData> pyramid;
+    const int frames = dataSize / kNumChannels;
+    if (!isMapped() && m_pyramidFrames < frames) {
+        pyramid.resize(header.pyramidSize);
+        updatePyramidBlocks(m_pData, frames, m_pyramidLevelOffsets,
+                pyramid.data(), 0, frames);
+        pPyramid = pyramid.data();
+    }
+
+    QByteArray output;
+    output.reserve(sizeof(header) + dataSize * sizeof(WaveformData) +
+            header.pyramidSize * sizeof(WaveformMaxData));
+    output.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.append(reinterpret_cast<const char*>(m_pData),
+            dataSize * sizeof(WaveformData));
+    output.append(reinterpret_cast<const char*>(pPyramid),
+            header.pyramidSize * sizeof(WaveformMaxData));
+    return output;
+}
+
+QByteArray Waveform::toProtobuf() const {
     io::Waveform waveform;
     waveform.set_visual_sample_rate(m_visualSampleRate);
     waveform.set_audio_visual_ratio(m_audioVisualRatio);
@@ -108,7 +309,7 @@ QByteArray Waveform::toByteArray() const {
 
     int dataSize = getDataSize();
     for (int i = 0; i < dataSize; ++i) {
-        const WaveformData& datum = m_data.at(i);
+        const WaveformData& datum = m_pData[i];
         all->add_value(datum.filtered.all);
         low->add_value(datum.filtered.low);
         mid->add_value(datum.filtered.mid);
@@ -185,35 +386,173 @@ void Waveform::readByteArray(const QByteArray& data) {
     bool mid_valid = mid.units() == io::Waveform::RMS;
     bool high_valid = high.units() == io::Waveform::RMS;
     for (int i = 0; i < dataSize; ++i) {
-        m_data[i].filtered.all = static_cast<unsigned char>(all.value(i));
+        m_pData[i].filtered.all = static_cast<unsigned char>(all.value(i));
         bool use_low = low_valid && i < low.value_size();
         bool use_mid = mid_valid && i < mid.value_size();
         bool use_high = high_valid && i < high.value_size();
-        m_data[i].filtered.low = use_low ? static_cast<unsigned char>(low.value(i)) : 0;
-        m_data[i].filtered.mid = use_mid ? static_cast<unsigned char>(mid.value(i)) : 0;
-        m_data[i].filtered.high = use_high ? static_cast<unsigned char>(high.value(i)) : 0;
+        m_pData[i].filtered.low = use_low ? static_cast<unsigned char>(low.value(i)) : 0;
+        m_pData[i].filtered.mid = use_mid ? static_cast<unsigned char>(mid.value(i)) : 0;
+        m_pData[i].filtered.high = use_high ? static_cast<unsigned char>(high.value(i)) : 0;
     }
+    updatePyramid(dataSize);
     m_completion = dataSize;
     m_saveState = SaveState::Saved;
 }
 
+bool Waveform::mapFile(std::unique_ptr<QFile> pFile) {
+    const qint64 fileSize = pFile->size();
+    if (fileSize < static_cast<qint64>(sizeof(CompactHeader))) {
+        return false;
+    }
+    uchar* pMapped = pFile->map(0, fileSize);
+    if (pMapped == nullptr) {
+        return false;
+    }
+
+    CompactHeader header;
+    memcpy(&header, pMapped, sizeof(header));
+    if (memcmp(header.magic, kCompactMagic, sizeof(header.magic)) != 0 ||
+            header.formatVersion != kCompactFormatVersion ||
+            header.byteOrder != kCompactByteOrder) {
+        qDebug() << "ERROR: Waveform file has an unknown format. Skipping.";
+        return false;
+    }
+    if (header.headerSize < sizeof(header) ||
+            header.headerSize % sizeof(WaveformData) != 0 ||
+            header.channels != kNumChannels ||
+            header.bands != kCompactBands ||
+            header.dataSize == 0 ||
+            header.dataSize > static_cast<quint32>(
+                    (fileSize - header.headerSize) / sizeof(WaveformData)) ||
+            !(header.visualSampleRate > 0) ||
+            !(header.audioVisualRatio > 0) ||
+            header.pyramidBlockFrames != kPyramidBlockFrames) {
+        qDebug() << "ERROR: Waveform file is corrupt. Skipping.";
+        return false;
+    }
+    std::vector<int> levelOffsets =
+            pyramidLevelOffsets(header.dataSize / kNumChannels);
+    const qint64 pyramidOffset =
+            header.headerSize + header.dataSize * sizeof(WaveformData);
+    if (header.pyramidSize != static_cast<quint32>(levelOffsets.back()) ||
+            fileSize - pyramidOffset <
+                    header.pyramidSize * static_cast<qint64>(sizeof(WaveformMaxData))) {
+        qDebug() << "ERROR: Waveform file is corrupt. Skipping.";
+        return false;
+    }
+
+    m_dataSize = header.dataSize;
+    m_textureStride = computeTextureStride(m_dataSize);
+    m_textureSize = m_textureStride * m_textureStride;
+    m_pData = reinterpret_cast<WaveformData*>(pMapped + header.headerSize);
+    m_pMappedFile = std::move(pFile);
+    m_visualSampleRate = header.visualSampleRate;
+    m_audioVisualRatio = header.audioVisualRatio;
+    // The pyramid is stored with the data, so like the data its pages are
+    // only read when they are accessed.
+    m_pyramidLevelOffsets = std::move(levelOffsets);
+    m_pPyramid = reinterpret_cast<const WaveformMaxData*>(
+            pMapped + pyramidOffset);
+    m_pyramidFrames = m_dataSize / kNumChannels;
+    m_completion = m_dataSize;
+    m_saveState = SaveState::Saved;
+    return true;
+}
+
 void Waveform::resize(int size) {
     m_dataSize = size;
     m_textureStride = computeTextureStride(size);
-    m_data.resize(m_textureStride * m_textureStride);
+    m_textureSize = m_textureStride * m_textureStride;
+    m_data.resize(m_textureSize);
+    m_pData = m_data.data();
+    initPyramid();
 }
 
 void Waveform::assign(int size, int value) {
     m_dataSize = size;
     m_textureStride = computeTextureStride(size);
-    m_data.assign(m_textureStride * m_textureStride, value);
+    m_textureSize = m_textureStride * m_textureStride;
+    m_data.assign(m_textureSize, value);
+    m_pData = m_data.data();
+    initPyramid();
     m_saveState = SaveState::SavePending;
 }
 
+void Waveform::initPyramid() {
+    m_pyramidLevelOffsets = pyramidLevelOffsets(m_dataSize / kNumChannels);
+    m_pyramidData.assign(m_pyramidLevelOffsets.back(), WaveformMaxData());
+    m_pPyramid = m_pyramidData.data();
+    m_pyramidFrames = 0;
+}
+
+void Waveform::updatePyramid(int completion) {
+    const int frames = m_dataSize / kNumChannels;
+    const int endFrame = math_min(completion / kNumChannels, frames);
+    // Wait until a block is complete unless the waveform is complete. The
+    // last block that has been updated may be incomplete, so it is updated
+    // again.
+    if (endFrame <= m_pyramidFrames ||
+            (endFrame / kPyramidBlockFrames == m_pyramidFrames / kPyramidBlockFrames &&
+                    endFrame < frames)) {
+        return;
+    }
+    updatePyramidBlocks(m_pData, frames, m_pyramidLevelOffsets,
+            m_pyramidData.data(), m_pyramidFrames, endFrame);
+    m_pyramidFrames = endFrame;
+}
+
+WaveformMaxData Waveform::getMax(int beginFrame, int endFrame,
+        ChannelIndex channel) const {
+    WaveformMaxData max;
+    beginFrame = math_max(beginFrame, 0);
+    // The pyramid blocks that are completely below the completion are up
+    // to date, see updatePyramid()
+    endFrame = math_min(math_min(endFrame, m_dataSize / kNumChannels),
+            getCompletion() / kNumChannels);
+    if (beginFrame >= endFrame) {
+        return max;
+    }
+
+    // The blocks of level 0 that are completely within the range
+    int beginBlock = (beginFrame + kPyramidBlockFrames - 1) / kPyramidBlockFrames;
+    int endBlock = endFrame / kPyramidBlockFrames;
+    if (beginBlock >= endBlock) {
+        for (int frame = beginFrame; frame < endFrame; ++frame) {
+            max.merge(m_pData[frame * kNumChannels + channel]);
+        }
+        return max;
+    }
+    for (int frame = beginFrame;
+            frame < beginBlock * kPyramidBlockFrames; ++frame) {
+        max.merge(m_pData[frame * kNumChannels + channel]);
+    }
+    for (int frame = endBlock * kPyramidBlockFrames;
+            frame < endFrame; ++frame) {
+        max.merge(m_pData[frame * kNumChannels + channel]);
+    }
+
+    // Take the largest blocks that fit into the range, from both ends
+    for (size_t level = 0; beginBlock < endBlock; ++level) {
+        const WaveformMaxData* blocks = m_pPyramid + m_pyramidLevelOffsets[level];
+        if (beginBlock % 2 != 0) {
+            max.merge(blocks[beginBlock * kNumChannels + channel]);
+            ++beginBlock;
+        }
+        if (endBlock % 2 != 0) {
+            --endBlock;
+            max.merge(blocks[endBlock * kNumChannels + channel]);
+        }
+        beginBlock /= 2;
+        endBlock /= 2;
+    }
+    return max;
+}
+
 void Waveform::dump() const {
     qDebug() << "Waveform" << this
              << "size("+QString::number(getDataSize())+")"
              << "textureStride("+QString::number(m_textureStride)+")"
+             << "mapped("+QString(isMapped() ? "yes" : "no")+")"
              << "completion("+QString::number(getCompletion())+")"
              << "visualSampleRate("+QString::number(m_visualSampleRate)+")"
              << "audioVisualRatio("+QString::number(m_audioVisualRatio)+")";
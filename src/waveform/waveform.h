@@ -10,8 +10,12 @@
 #include <QSharedPointer>
 #include <QMutexLocker>
 
+#include "util/assert.h"
 #include "util/class.h"
 #include "util/compatibility.h"
+#include "util/memory.h"
+
+class QFile;
 
 enum FilterIndex { Low = 0, Mid = 1, High = 2, FilterCount = 3};
 enum ChannelIndex { Left = 0, Right = 1, ChannelCount = 2};
@@ -29,6 +33,28 @@ union WaveformData {
     WaveformData(int i) { m_i = i;}
 };
 
+// The maxima of a range of visual samples of one channel, see
+// Waveform::getMax().
+struct WaveformMaxData {
+    WaveformMaxData()
+            : bands(0),
+              energy(0) {
+    }
+
+    void merge(const WaveformMaxData& other);
+    void merge(const WaveformData& data);
+
+    // The maximum of (low * lowGain)^2 + (mid * midGain)^2 +
+    // (high * highGain)^2 over the visual samples. It is exact for a single
+    // sample and if the gains are equal, otherwise it is an upper bound.
+    float weightedEnergy(float lowGain, float midGain, float highGain) const;
+
+    // The maximum of each band
+    WaveformData bands;
+    // The maximum of low^2 + mid^2 + high^2 of a single visual sample
+    unsigned int energy;
+};
+
 class Waveform {
   public:
     enum class SaveState {
@@ -37,12 +63,20 @@ class Waveform {
         Saved
     };
 
+    // Reads a waveform in the protobuf format of Waveform-5.0 and before,
+    // see toProtobuf().
     explicit Waveform(const QByteArray pData = QByteArray());
     Waveform(int audioSampleRate, int audioSamples,
              int desiredVisualSampleRate, int maxVisualSamples);
 
     virtual ~Waveform();
 
+    // Maps a file in the compact format of toByteArray() into memory. The
+    // data is used in place and only read from disk when it is accessed.
+    // The returned waveform is read-only. Returns an invalid waveform if the
+    // file is missing or not in the compact format.
+    static Waveform* fromMappedFile(const QString& fileName);
+
     int getId() const {
         QMutexLocker locker(&m_mutex);
         return m_id;
@@ -73,7 +107,20 @@ class Waveform {
         m_description = description;
     }
 
+    // Serializes the waveform in the compact format. The format has a fixed
+    // layout that is mapped into memory by fromMappedFile(): a header
+    // followed by the WaveformData of the visual samples in the order of
+    // data(), i.e. the bands of each sample packed into 4 bytes and the
+    // samples of the left and right channel alternating, followed by the
+    // pyramid of maxima of getMax(), so mapping a file doesn't read it.
     QByteArray toByteArray() const;
+    // Serializes the waveform in the protobuf format of Waveform-5.0.
+    QByteArray toProtobuf() const;
+
+    // True if the data is mapped from a file, see fromMappedFile()
+    bool isMapped() const {
+        return m_pMappedFile != nullptr;
+    }
 
     // We do not lock the mutex since m_dataSize and m_visualSampleRate are not
     // changed after the constructor runs.
@@ -102,7 +149,10 @@ class Waveform {
     int getCompletion() const {
         return load_atomic(m_completion);
     }
+    // Also updates the maxima of getMax() for the visual samples up to the
+    // completion. Must only be called by the thread that writes the data.
     void setCompletion(int completion) {
+        updatePyramid(completion);
         m_completion = completion;
     }
 
@@ -110,41 +160,58 @@ class Waveform {
     // the constructor runs.
     inline int getTextureStride() const { return m_textureStride; }
 
-    // We do not lock the mutex since m_data is not resized after the
-    // constructor runs.
-    inline int getTextureSize() const { return m_data.size(); }
+    // We do not lock the mutex since m_textureSize is not changed after the
+    // constructor runs. Only the first getDataSize() elements of data() are
+    // valid, mapped waveforms are not padded to the texture size.
+    inline int getTextureSize() const { return m_textureSize; }
 
     // Atomically get the number of data elements in this Waveform. We do not
     // lock the mutex since m_dataSize is not changed after the constructor
     // runs.
     inline int getDataSize() const { return m_dataSize; }
 
-    inline const WaveformData& get(int i) const { return m_data[i];}
-    inline unsigned char getLow(int i) const { return m_data[i].filtered.low;}
-    inline unsigned char getMid(int i) const { return m_data[i].filtered.mid;}
-    inline unsigned char getHigh(int i) const { return m_data[i].filtered.high;}
-    inline unsigned char getAll(int i) const { return m_data[i].filtered.all;}
+    inline const WaveformData& get(int i) const { return m_pData[i];}
+    inline unsigned char getLow(int i) const { return m_pData[i].filtered.low;}
+    inline unsigned char getMid(int i) const { return m_pData[i].filtered.mid;}
+    inline unsigned char getHigh(int i) const { return m_pData[i].filtered.high;}
+    inline unsigned char getAll(int i) const { return m_pData[i].filtered.all;}
+
+    // We do not lock the mutex since m_pData is not changed after the
+    // constructor runs. Must not be called for mapped waveforms, which are
+    // read-only.
+    WaveformData* data() {
+        DEBUG_ASSERT(!isMapped());
+        return m_pData;
+    }
 
-    // We do not lock the mutex since m_data is not resized after the
+    // We do not lock the mutex since m_pData is not changed after the
     // constructor runs.
-    WaveformData* data() { return &m_data[0];}
+    const WaveformData* data() const { return m_pData;}
 
-    // We do not lock the mutex since m_data is not resized after the
-    // constructor runs.
-    const WaveformData* data() const { return &m_data[0];}
+    // The maxima of the visual frames [beginFrame, endFrame) of a channel,
+    // where visual frame i is the visual samples 2 * i and 2 * i + 1. Frames
+    // outside of the waveform are ignored. The maxima are read from a
+    // pyramid of precomputed maxima of blocks of frames, so the cost only
+    // grows with the logarithm of the number of frames. Frames beyond the
+    // completion are ignored.
+    WaveformMaxData getMax(int beginFrame, int endFrame,
+            ChannelIndex channel) const;
 
     void dump() const;
 
   private:
     void readByteArray(const QByteArray& data);
+    bool mapFile(std::unique_ptr<QFile> pFile);
     void resize(int size);
     void assign(int size, int value = 0);
-
-    inline WaveformData& at(int i) { return m_data[i];}
-    inline unsigned char& low(int i) { return m_data[i].filtered.low;}
-    inline unsigned char& mid(int i) { return m_data[i].filtered.mid;}
-    inline unsigned char& high(int i) { return m_data[i].filtered.high;}
-    inline unsigned char& all(int i) { return m_data[i].filtered.all;}
+    void initPyramid();
+    void updatePyramid(int completion);
+
+    inline WaveformData& at(int i) { return m_pData[i];}
+    inline unsigned char& low(int i) { return m_pData[i].filtered.low;}
+    inline unsigned char& mid(int i) { return m_pData[i].filtered.mid;}
+    inline unsigned char& high(int i) { return m_pData[i].filtered.high;}
+    inline unsigned char& all(int i) { return m_pData[i].filtered.all;}
     double getVisualSampleRate() const { return m_visualSampleRate; }
 
     // If stored in the database, the ID of the waveform.
@@ -165,6 +232,12 @@ class Waveform {
     // TODO(XXX): In the future we should switch to QVector and use the raw data
     // pointer when performance matters.
     std::vector<WaveformData> m_data;
+    // The file that the data is mapped from, if any, see fromMappedFile().
+    // The mapping is released when the file is destroyed.
+    std::unique_ptr<QFile> m_pMappedFile;
+    // Either the data of m_data or of the mapped file. Not allowed to change
+    // after the constructor runs.
+    WaveformData* m_pData;
     // Not allowed to change after the constructor runs.
     double m_visualSampleRate;
     // Not allowed to change after the constructor runs.
@@ -173,6 +246,25 @@ class Waveform {
     // We create an NxN texture out of m_data's buffer in the GLSL renderer. The
     // stride is N. Not allowed to change after the constructor runs.
     int m_textureStride;
+    // N * N. Not allowed to change after the constructor runs.
+    int m_textureSize;
+
+    // The maxima of the visual frames for getMax(). Level 0 holds the maxima
+    // of blocks of kPyramidBlockFrames frames and each further level the
+    // maxima of pairs of blocks of the level below, down to a single block.
+    // The maxima of both channels of a block are stored next to each other
+    // like in m_data and the levels are stored one after another. The
+    // pyramid of a mapped file is stored in the file and complete, otherwise
+    // m_pyramidData is allocated by the constructor and its contents are
+    // updated by setCompletion().
+    std::vector<WaveformMaxData> m_pyramidData;
+    // Either the data of m_pyramidData or of the mapped file
+    const WaveformMaxData* m_pPyramid;
+    // The offset of each level in m_pPyramid, followed by its size
+    std::vector<int> m_pyramidLevelOffsets;
+    // The number of frames that have been added to the pyramid. Only
+    // accessed by the thread that writes the data.
+    int m_pyramidFrames;
 
     // For performance, completion is shared as a QAtomicInt and does not lock
     // the mutex. The completion of the waveform calculation.
@@ -6,13 +6,35 @@
 // static
 Waveform* WaveformFactory::loadWaveformFromAnalysis(
         const AnalysisDao::AnalysisInfo& analysis) {
-    Waveform* pWaveform = new Waveform(analysis.data);
+    Waveform* pWaveform;
+    if (analysis.version == WAVEFORM_CURRENT_VERSION ||
+            analysis.version == WAVEFORMSUMMARY_CURRENT_VERSION) {
+        pWaveform = Waveform::fromMappedFile(analysis.dataPath);
+    } else {
+        pWaveform = new Waveform(analysis.data);
+    }
     pWaveform->setId(analysis.analysisId);
     pWaveform->setVersion(analysis.version);
     pWaveform->setDescription(analysis.description);
     return pWaveform;
 }
 
+// static
+AnalysisDao::AnalysisInfo WaveformFactory::migrateWaveformAnalysis(
+        const AnalysisDao::AnalysisInfo& analysis,
+        const Waveform& waveform) {
+    AnalysisDao::AnalysisInfo migrated = analysis;
+    if (analysis.type == AnalysisDao::TYPE_WAVESUMMARY) {
+        migrated.version = currentWaveformSummaryVersion();
+        migrated.description = currentWaveformSummaryDescription();
+    } else {
+        migrated.version = currentWaveformVersion();
+        migrated.description = currentWaveformDescription();
+    }
+    migrated.data = waveform.toByteArray();
+    return migrated;
+}
+
 // static
 WaveformFactory::VersionClass WaveformFactory::waveformVersionToVersionClass(const QString& version) {
     if (version == WAVEFORM_CURRENT_VERSION) {
@@ -20,6 +42,11 @@ WaveformFactory::VersionClass WaveformFactory::waveformVersionToVersionClass(con
         return VC_USE;
     }
 
+    if (version == WAVEFORM_5_VERSION) {
+        // Used up to Mixxx 2.2, protobuf format
+        return VC_MIGRATE;
+    }
+
     if (version == WAVEFORM_4_VERSION) {
         // Used in Mixxx 1.12 beta, suffers Bug lp:1406389
         return VC_REMOVE;
@@ -46,6 +73,11 @@ WaveformFactory::VersionClass WaveformFactory::waveformSummaryVersionToVersionCl
         return VC_USE;
     }
 
+    if (version == WAVEFORMSUMMARY_5_VERSION) {
+        // Used up to Mixxx 2.2, protobuf format
+        return VC_MIGRATE;
+    }
+
     if (version == WAVEFORMSUMMARY_4_VERSION) {
         // Used in Mixxx 1.12 beta, suffers Bug lp:1406389
         return VC_REMOVE;
@@ -28,22 +28,38 @@ class Waveform;
 #define WAVEFORM_5_DESCRIPTION "Waveform 5.0"
 #define WAVEFORMSUMMARY_5_DESCRIPTION "WaveformSummary 5.0"
 
-#define WAVEFORM_CURRENT_VERSION WAVEFORM_5_VERSION
-#define WAVEFORMSUMMARY_CURRENT_VERSION WAVEFORMSUMMARY_5_VERSION
-#define WAVEFORM_CURRENT_DESCRIPTION WAVEFORM_5_DESCRIPTION
-#define WAVEFORMSUMMARY_CURRENT_DESCRIPTION WAVEFORMSUMMARY_5_DESCRIPTION
+// Used from Mixxx 2.3 alpha, the compact format of Waveform::toByteArray()
+#define WAVEFORM_6_VERSION "Waveform-6.0"
+#define WAVEFORMSUMMARY_6_VERSION "WaveformSummary-6.0"
+#define WAVEFORM_6_DESCRIPTION "Waveform 6.0"
+#define WAVEFORMSUMMARY_6_DESCRIPTION "WaveformSummary 6.0"
+
+#define WAVEFORM_CURRENT_VERSION WAVEFORM_6_VERSION
+#define WAVEFORMSUMMARY_CURRENT_VERSION WAVEFORMSUMMARY_6_VERSION
+#define WAVEFORM_CURRENT_DESCRIPTION WAVEFORM_6_DESCRIPTION
+#define WAVEFORMSUMMARY_CURRENT_DESCRIPTION WAVEFORMSUMMARY_6_DESCRIPTION
 
 
 class WaveformFactory {
   public:
     enum VersionClass {
         VC_USE,
+        // Use, but save again in the current version
+        VC_MIGRATE,
         VC_KEEP,
         VC_REMOVE
     };
 
+    // Analyses in the current version are mapped from their data file.
+    // The data of analyses in older versions must have been loaded with
+    // AnalysisDao::loadAnalysisData() before.
     static Waveform* loadWaveformFromAnalysis(
             const AnalysisDao::AnalysisInfo& analysis);
+    // Returns the analysis of the waveform in the current version for
+    // saving it with AnalysisDao::saveAnalysis().
+    static AnalysisDao::AnalysisInfo migrateWaveformAnalysis(
+            const AnalysisDao::AnalysisInfo& analysis,
+            const Waveform& waveform);
     static VersionClass waveformVersionToVersionClass(const QString& version);
     static VersionClass waveformSummaryVersionToVersionClass(const QString& version);
     static QString currentWaveformVersion();
@@ -0,0 +1,71 @@
+#include "waveform/waveformrenderthread.h"
+
+#include "util/event.h"
+#include "waveform/widgets/waveformwidgetabstract.h"
+
+WaveformRenderThread::WaveformRenderThread(QObject* pParent)
+        : QThread(pParent),
+          m_bDoRendering(true),
+          m_frameInProgress(0),
+          m_droppedFrames(0),
+          m_pVSyncThread(nullptr),
+          m_droppedFramesCounter("WaveformRenderThread dropped frames"),
+          m_frameLatency("WaveformRenderThread frame latency") {
+}
+
+WaveformRenderThread::~WaveformRenderThread() {
+    m_bDoRendering = false;
+    m_semaFrameRequest.release();
+    wait();
+}
+
+void WaveformRenderThread::run() {
+    QThread::currentThread()->setObjectName("WaveformRenderThread");
+
+    while (true) {
+        m_semaFrameRequest.acquire();
+        if (!m_bDoRendering) {
+            break;
+        }
+
+        Event::start("WaveformRenderThread render");
+        {
+            QMutexLocker locker(&m_widgetsMutex);
+            for (WaveformWidgetAbstract* pWidget : m_widgets) {
+                pWidget->renderOffscreen(m_pVSyncThread);
+            }
+        }
+        Event::end("WaveformRenderThread render");
+
+        m_frameLatency.elapsed(true);
+        m_frameInProgress.storeRelease(0);
+    }
+}
+
+void WaveformRenderThread::addWidget(WaveformWidgetAbstract* pWidget) {
+    QMutexLocker locker(&m_widgetsMutex);
+    m_widgets.append(pWidget);
+}
+
+void WaveformRenderThread::removeWidget(WaveformWidgetAbstract* pWidget) {
+    QMutexLocker locker(&m_widgetsMutex);
+    m_widgets.removeAll(pWidget);
+}
+
+void WaveformRenderThread::requestFrame(VSyncThread* pVSyncThread) {
+    if (!m_frameInProgress.testAndSetAcquire(0, 1)) {
+        m_droppedFrames.ref();
+        m_droppedFramesCounter.increment(1);
+        return;
+    }
+    m_droppedFramesCounter.increment(0);
+
+    // Handed over to the render thread by the semaphore
+    m_pVSyncThread = pVSyncThread;
+    m_frameLatency.start();
+    m_semaFrameRequest.release();
+}
+
+int WaveformRenderThread::droppedFrames() const {
+    return m_droppedFrames.loadAcquire();
+}
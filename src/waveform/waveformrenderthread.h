@@ -0,0 +1,63 @@
+#ifndef WAVEFORMRENDERTHREAD_H
+#define WAVEFORMRENDERTHREAD_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+
+#include "util/counter.h"
+#include "util/timer.h"
+
+class VSyncThread;
+class WaveformWidgetAbstract;
+
+// Renders the waveform widgets that paint with a QPainter into offscreen
+// images, see WaveformWidgetAbstract::renderOffscreen(). The GUI thread
+// requests a frame on each render tick of the VSyncThread and only composites
+// the images finished since the previous tick, so a GUI thread that is busy
+// with e.g. the library or skin repaints no longer delays the rendering.
+//
+// The GL widgets are still rendered on the GUI thread, their contexts are
+// bound to it.
+class WaveformRenderThread : public QThread {
+    Q_OBJECT
+  public:
+    explicit WaveformRenderThread(QObject* pParent);
+    ~WaveformRenderThread();
+
+    void run();
+
+    // Called from the GUI thread. removeWidget() waits until a frame that is
+    // being rendered has been finished, so the widget can be deleted
+    // afterwards.
+    void addWidget(WaveformWidgetAbstract* pWidget);
+    void removeWidget(WaveformWidgetAbstract* pWidget);
+
+    // Called from the GUI thread on each render tick. Starts rendering the
+    // next frame of all widgets. If the previous frame is still being
+    // rendered the request is dropped.
+    void requestFrame(VSyncThread* pVSyncThread);
+
+    int droppedFrames() const;
+
+  private:
+    volatile bool m_bDoRendering;
+    QSemaphore m_semaFrameRequest;
+    // 1 from a request until all images of the frame are finished
+    QAtomicInt m_frameInProgress;
+    QAtomicInt m_droppedFrames;
+    VSyncThread* m_pVSyncThread;
+
+    // Tracks 1 for each dropped and 0 for each rendered frame, so the
+    // average is the rate of dropped frames.
+    Counter m_droppedFramesCounter;
+    // From the request until all images of the frame are finished
+    Timer m_frameLatency;
+
+    QMutex m_widgetsMutex;
+    QList<WaveformWidgetAbstract*> m_widgets;
+};
+
+#endif // WAVEFORMRENDERTHREAD_H
@@ -10,6 +10,7 @@
 
 #include "waveform/waveformwidgetfactory.h"
 
+#include "control/control.h"
 #include "control/controlpotmeter.h"
 #include "waveform/widgets/emptywaveformwidget.h"
 #include "waveform/widgets/softwarewaveformwidget.h"
@@ -26,6 +27,7 @@
 #include "widget/wwaveformviewer.h"
 #include "waveform/guitick.h"
 #include "waveform/vsyncthread.h"
+#include "waveform/waveformrenderthread.h"
 #include "util/cmdlineargs.h"
 #include "util/performancetimer.h"
 #include "util/timer.h"
@@ -71,6 +73,8 @@ WaveformWidgetFactory::WaveformWidgetFactory() :
         m_openGLShaderAvailable(false),
         m_beatGridAlpha(90),
         m_vsyncThread(NULL),
+        m_renderThread(NULL),
+        m_renderOffscreen(true),
         m_frameCnt(0),
         m_actualFrameRate(0),
         m_vSyncType(0),
@@ -184,9 +188,13 @@ WaveformWidgetFactory::WaveformWidgetFactory() :
 }
 
 WaveformWidgetFactory::~WaveformWidgetFactory() {
+    ControlDoublePrivate::changeBus()->setEnabled(false);
     if (m_vsyncThread) {
         delete m_vsyncThread;
     }
+    if (m_renderThread) {
+        delete m_renderThread;
+    }
 }
 
 bool WaveformWidgetFactory::setConfig(UserSettingsPointer config) {
@@ -215,6 +223,10 @@ bool WaveformWidgetFactory::setConfig(UserSettingsPointer config) {
     int vsync = m_config->getValue(ConfigKey("[Waveform]","VSync"), 0);
     setVSyncType(vsync);
 
+    // Takes effect for the widgets created from now on
+    m_renderOffscreen = m_config->getValue(
+            ConfigKey("[Waveform]", "OffscreenRendering"), m_renderOffscreen);
+
     int defaultZoom = m_config->getValueString(ConfigKey("[Waveform]","DefaultZoom")).toInt(&ok);
     if (ok) {
         setDefaultZoom(defaultZoom);
@@ -297,6 +309,7 @@ bool WaveformWidgetFactory::setWaveformWidget(WWaveformViewer* viewer,
     WaveformWidgetAbstract* waveformWidget = createWaveformWidget(m_type, viewer);
     viewer->setWaveformWidget(waveformWidget);
     viewer->setup(node, context);
+    startRenderingOffscreen(waveformWidget);
 
     // create new holder
     if (index == -1) {
@@ -407,6 +420,7 @@ bool WaveformWidgetFactory::setWidgetTypeFromHandle(int handleIndex) {
         holder.m_waveformWidget = widget;
         viewer->setWaveformWidget(widget);
         viewer->setup(holder.m_skinNodeCache, holder.m_skinContextCache);
+        startRenderingOffscreen(widget);
         viewer->setZoom(previousZoom);
         viewer->setPlayMarkerPosition(previousPlayMarkerPosition);
         // resize() doesn't seem to get called on the widget. I think Qt skips
@@ -513,12 +527,20 @@ void WaveformWidgetFactory::render() {
     //int paintersSetupTime0 = 0;
     //int paintersSetupTime1 = 0;
 
+    // Update the widgets that subscribed to the coalesced control changes
+    // before anything is rendered.
+    ControlDoublePrivate::changeBus()->deliverChanges();
+
     if (!m_skipRender) {
         if (m_type) {   // no regular updates for an empty waveform
             // next rendered frame is displayed after next buffer swap and than after VSync
             for (int i = 0; i < m_waveformWidgetHolders.size(); i++) {
-                // Calculate play position for the new Frame in following run
-                m_waveformWidgetHolders[i].m_waveformWidget->preRender(m_vsyncThread);
+                WaveformWidgetAbstract* pWaveformWidget = m_waveformWidgetHolders[i].m_waveformWidget;
+                // Calculate play position for the new Frame in following run,
+                // the render thread does this for the offscreen widgets
+                if (!pWaveformWidget->isRenderedOffscreen()) {
+                    pWaveformWidget->preRender(m_vsyncThread);
+                }
             }
             //qDebug() << "prerender" << m_vsyncThread->elapsed();
 
@@ -533,6 +555,13 @@ void WaveformWidgetFactory::render() {
                 }
                 //qDebug() << "render" << i << m_vsyncThread->elapsed();
             }
+
+            // The offscreen widgets have painted the frames finished since
+            // the last run, render the next ones while the GUI thread is busy
+            // with everything else.
+            if (m_renderThread) {
+                m_renderThread->requestFrame(m_vsyncThread);
+            }
         }
 
         // Notify all other waveform-like widgets (e.g. WSpinny's) that they should
@@ -546,7 +575,11 @@ void WaveformWidgetFactory::render() {
         if (timeCnt > mixxx::Duration::fromSeconds(1)) {
             m_time.start();
             m_frameCnt = m_frameCnt * 1000 / timeCnt.toIntegerMillis(); // latency correction
-            emit(waveformMeasured(m_frameCnt, m_vsyncThread->droppedFrames()));
+            int droppedFrames = m_vsyncThread->droppedFrames();
+            if (m_renderThread) {
+                droppedFrames += m_renderThread->droppedFrames();
+            }
+            emit(waveformMeasured(m_frameCnt, droppedFrames));
             m_frameCnt = 0.0;
         }
     }
@@ -777,6 +810,14 @@ WaveformWidgetAbstract* WaveformWidgetFactory::createWaveformWidget(
     return widget;
 }
 
+void WaveformWidgetFactory::startRenderingOffscreen(
+        WaveformWidgetAbstract* pWidget) {
+    if (m_renderThread && m_renderOffscreen &&
+            pWidget && pWidget->canRenderOffscreen()) {
+        pWidget->setRenderThread(m_renderThread);
+    }
+}
+
 int WaveformWidgetFactory::findIndexOf(WWaveformViewer* viewer) const {
     for (int i = 0; i < (int)m_waveformWidgetHolders.size(); i++) {
         if (m_waveformWidgetHolders[i].m_waveformViewer == viewer) {
@@ -794,6 +835,12 @@ void WaveformWidgetFactory::startVSync(GuiTick* pGuiTick) {
             this, SLOT(render()));
     connect(m_vsyncThread, SIGNAL(vsyncSwap()),
             this, SLOT(swap()));
+
+    m_renderThread = new WaveformRenderThread(this);
+    m_renderThread->start(QThread::NormalPriority);
+
+    // render() is called once per frame from now on
+    ControlDoublePrivate::changeBus()->setEnabled(true);
 }
 
 void WaveformWidgetFactory::getAvailableVSyncTypes(QList<QPair<int, QString > >* pList) {
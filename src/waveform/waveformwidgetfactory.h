@@ -16,6 +16,7 @@ class WWaveformViewer;
 class WaveformWidgetAbstract;
 class QTimer;
 class VSyncThread;
+class WaveformRenderThread;
 class GuiTick;
 
 class WaveformWidgetAbstractHandle {
@@ -135,6 +136,7 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
   private:
     void evaluateWidgets();
     WaveformWidgetAbstract* createWaveformWidget(WaveformWidgetType::Type type, WWaveformViewer* viewer);
+    void startRenderingOffscreen(WaveformWidgetAbstract* pWidget);
     int findIndexOf(WWaveformViewer* viewer) const;
 
     //All type of available widgets
@@ -162,6 +164,8 @@ class WaveformWidgetFactory : public QObject, public Singleton<WaveformWidgetFac
     int m_beatGridAlpha;
 
     VSyncThread* m_vsyncThread;
+    WaveformRenderThread* m_renderThread;
+    bool m_renderOffscreen;
 
     //Debug
     PerformanceTimer m_time;
@@ -37,5 +37,7 @@ void HSVWaveformWidget::castToQWidget() {
 
 void HSVWaveformWidget::paintEvent(QPaintEvent* event) {
     QPainter painter(this);
-    draw(&painter,event);
+    if (!drawOffscreenFrame(&painter)) {
+        draw(&painter, event);
+    }
 }
@@ -11,6 +11,7 @@ class HSVWaveformWidget : public QWidget, public WaveformWidgetAbstract {
     virtual ~HSVWaveformWidget();
 
     virtual WaveformWidgetType::Type getType() const { return WaveformWidgetType::HSVWaveform; }
+    virtual bool canRenderOffscreen() const { return true; }
 
     static inline QString getWaveformWidgetName() { return tr("HSV"); }
     static inline bool useOpenGl() { return false; }
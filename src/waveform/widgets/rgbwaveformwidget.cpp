@@ -37,5 +37,7 @@ void RGBWaveformWidget::castToQWidget() {
 
 void RGBWaveformWidget::paintEvent(QPaintEvent* event) {
     QPainter painter(this);
-    draw(&painter,event);
+    if (!drawOffscreenFrame(&painter)) {
+        draw(&painter, event);
+    }
 }
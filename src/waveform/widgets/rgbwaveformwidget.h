@@ -11,6 +11,7 @@ class RGBWaveformWidget : public QWidget, public WaveformWidgetAbstract {
     virtual ~RGBWaveformWidget();
 
     virtual WaveformWidgetType::Type getType() const { return WaveformWidgetType::RGBWaveform; }
+    virtual bool canRenderOffscreen() const { return true; }
 
     static inline QString getWaveformWidgetName() { return tr("RGB"); }
     static inline bool useOpenGl() { return false; }
@@ -37,5 +37,7 @@ void SoftwareWaveformWidget::castToQWidget() {
 
 void SoftwareWaveformWidget::paintEvent(QPaintEvent* event) {
     QPainter painter(this);
-    draw(&painter, event);
+    if (!drawOffscreenFrame(&painter)) {
+        draw(&painter, event);
+    }
 }
@@ -11,6 +11,7 @@ class SoftwareWaveformWidget : public QWidget, public WaveformWidgetAbstract {
     virtual ~SoftwareWaveformWidget();
 
     virtual WaveformWidgetType::Type getType() const { return WaveformWidgetType::SoftwareWaveform; }
+    virtual bool canRenderOffscreen() const { return true; }
 
     static inline QString getWaveformWidgetName() { return tr("Filtered") + " - " + tr("Software"); }
     static inline bool useOpenGl() { return false; }
@@ -1,17 +1,31 @@
 #include "waveformwidgetabstract.h"
 #include "waveform/renderers/waveformwidgetrenderer.h"
+#include "waveform/waveformrenderthread.h"
 
+#include <QPainter>
 #include <QtDebug>
 #include <QWidget>
 
+namespace {
+const int kFrameIndexMask = 0x3;
+const int kNewFrame = 0x4;
+} // anonymous namespace
 
 WaveformWidgetAbstract::WaveformWidgetAbstract(const char* group)
     : WaveformWidgetRenderer(group),
-      m_initSuccess(false) {
+      m_initSuccess(false),
+      m_pRenderThread(nullptr),
+      m_backFrame(0),
+      m_frontFrame(1),
+      m_pendingFrame(2) {
     m_widget = NULL;
 }
 
 WaveformWidgetAbstract::~WaveformWidgetAbstract() {
+    if (m_pRenderThread) {
+        // Waits for a frame that is being rendered
+        m_pRenderThread->removeWidget(this);
+    }
 }
 
 void WaveformWidgetAbstract::hold() {
@@ -44,3 +58,58 @@ void WaveformWidgetAbstract::resize(int width, int height, float devicePixelRati
     }
     WaveformWidgetRenderer::resize(width, height, devicePixelRatio);
 }
+
+void WaveformWidgetAbstract::setRenderThread(
+        WaveformRenderThread* pRenderThread) {
+    DEBUG_ASSERT(canRenderOffscreen());
+    DEBUG_ASSERT(!m_pRenderThread);
+    m_pRenderThread = pRenderThread;
+    m_pRenderThread->addWidget(this);
+}
+
+void WaveformWidgetAbstract::renderOffscreen(VSyncThread* vsyncThread) {
+    {
+        QMutexLocker locker(renderMutex());
+        const QSize size(getWidth() * getDevicePixelRatio(),
+                getHeight() * getDevicePixelRatio());
+        if (size.isEmpty()) {
+            return;
+        }
+
+        QImage& frame = m_offscreenFrames[m_backFrame];
+        if (frame.size() != size) {
+            frame = QImage(size, QImage::Format_ARGB32_Premultiplied);
+            frame.setDevicePixelRatio(getDevicePixelRatio());
+        }
+
+        // The frame is painted on the next render tick, one sync interval
+        // after a frame rendered on the GUI thread.
+        onPreRender(vsyncThread, 1);
+        QPainter painter(&frame);
+        draw(&painter, nullptr);
+    }
+
+    m_backFrame = m_pendingFrame.fetchAndStoreOrdered(
+            m_backFrame | kNewFrame) & kFrameIndexMask;
+}
+
+bool WaveformWidgetAbstract::drawOffscreenFrame(QPainter* painter) {
+    if (!m_pRenderThread) {
+        return false;
+    }
+
+    if (m_pendingFrame.loadAcquire() & kNewFrame) {
+        m_frontFrame = m_pendingFrame.fetchAndStoreOrdered(
+                m_frontFrame) & kFrameIndexMask;
+    }
+
+    const QImage& frame = m_offscreenFrames[m_frontFrame];
+    if (frame.isNull()) {
+        // Nothing has been rendered yet
+        painter->fillRect(0, 0, getWidth(), getHeight(),
+                getWaveformSignalColors()->getBgColor());
+    } else {
+        painter->drawImage(QPoint(0, 0), frame);
+    }
+    return true;
+}
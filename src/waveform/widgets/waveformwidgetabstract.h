@@ -1,6 +1,8 @@
 #ifndef WAVEFORMWIDGETABSTRACT_H
 #define WAVEFORMWIDGETABSTRACT_H
 
+#include <QAtomicInt>
+#include <QImage>
 #include <QWidget>
 #include <QString>
 
@@ -10,6 +12,7 @@
 #include "util/duration.h"
 
 class VSyncThread;
+class WaveformRenderThread;
 
 // NOTE(vRince) This class represent objects the waveformwidgetfactory can
 // holds, IMPORTANT all WaveformWidgetAbstract MUST inherist QWidget too !!  we
@@ -34,13 +37,44 @@ class WaveformWidgetAbstract : public WaveformWidgetRenderer {
     virtual mixxx::Duration render();
     virtual void resize(int width, int height, float devicePixelRatio) override;
 
+    // Widgets that paint with a QPainter can be rendered into offscreen
+    // images on the WaveformRenderThread. The GL widgets render on the GUI
+    // thread.
+    virtual bool canRenderOffscreen() const { return false; }
+    // Adds the widget to the render thread. It is removed again when the
+    // widget is deleted.
+    void setRenderThread(WaveformRenderThread* pRenderThread);
+    bool isRenderedOffscreen() const { return m_pRenderThread != nullptr; }
+
+    // Called from the render thread. Renders the next frame into an offscreen
+    // image, which is painted on the next render tick of the GUI thread.
+    void renderOffscreen(VSyncThread* vsyncThread);
+
   protected:
     QWidget* m_widget;
     bool m_initSuccess;
 
+    // Called from paintEvent(). Paints the last frame finished by the render
+    // thread and returns true, or returns false if the widget is rendered on
+    // the GUI thread.
+    bool drawOffscreenFrame(QPainter* painter);
+
     //this is the factory resposability to trigger QWidget casting after constructor
     virtual void castToQWidget() = 0;
 
+  private:
+    WaveformRenderThread* m_pRenderThread;
+
+    // Triple buffer of the offscreen frames. The render thread draws into
+    // the back frame and the GUI thread paints the front frame, the pending
+    // frame is exchanged with either of them. Only the index of the pending
+    // frame is shared, with kNewFrame set when it has been finished by the
+    // render thread but not yet painted.
+    QImage m_offscreenFrames[3];
+    int m_backFrame;
+    int m_frontFrame;
+    QAtomicInt m_pendingFrame;
+
     friend class WaveformWidgetFactory;
 };
 
@@ -8,6 +8,8 @@
 #include "util/math.h"
 #include "util/memory.h"
 #include "skin/imgloader.h"
+#include "skin/skincache.h"
+#include "skin/skinimageprefetcher.h"
 
 // static
 Paintable::DrawMode Paintable::DrawModeFromString(const QString& str) {
@@ -51,6 +53,41 @@ Paintable::Paintable(const PixmapSource& source, DrawMode mode, double scaleFact
     if (!source.isSVG()) {
         m_pPixmap.reset(WPixmapStore::getPixmapNoCache(source.getPath(), scaleFactor));
     } else {
+#ifdef __APPLE__
+        // Apple does Retina scaling behind the sceens, so we also pass a
+        // Paintable::FIXED image. On the other targets, it is better to
+        // cache the pixmap. We do not do this for TILE and color schemas.
+        // which can result in a correct but possibly blurry picture at a
+        // Retina display. This can be fixed when switching to QT5
+        const bool rasterize = mode == TILE || WPixmapStore::willCorrectColors();
+#else
+        const bool rasterize = mode == TILE || mode == Paintable::FIXED ||
+                WPixmapStore::willCorrectColors();
+#endif
+        // The pixmap does not need the SVG renderer, so a pixmap that has
+        // been rasterized on a previous start skips loading the SVG.
+        const QString cacheKey = QString("Paintable:%1:%2").arg(
+                source.getId(), QString::number(scaleFactor));
+        if (rasterize) {
+            QImage cachedImage = SkinCache::loadImage(cacheKey);
+            if (!cachedImage.isNull()) {
+                m_pPixmap.reset(new QPixmap(cachedImage.size()));
+                m_pPixmap->convertFromImage(cachedImage);
+                return;
+            }
+
+            // Rasterized concurrently with the other images of the skin
+            QImage prefetchedImage = SkinImagePrefetcher::getImage(
+                    source, scaleFactor);
+            if (!prefetchedImage.isNull()) {
+                WPixmapStore::correctImageColors(&prefetchedImage);
+                SkinCache::storeImage(cacheKey, prefetchedImage);
+                m_pPixmap.reset(new QPixmap(prefetchedImage.size()));
+                m_pPixmap->convertFromImage(prefetchedImage);
+                return;
+            }
+        }
+
         auto pSvg = std::make_unique<QSvgRenderer>();
         if (!source.getSvgSourceData().isEmpty()) {
             // Call here the different overload for svg content
@@ -67,23 +104,16 @@ Paintable::Paintable(const PixmapSource& source, DrawMode mode, double scaleFact
             return;
         }
         m_pSvg.reset(pSvg.release());
-#ifdef __APPLE__
-        // Apple does Retina scaling behind the sceens, so we also pass a
-        // Paintable::FIXED image. On the other targets, it is better to
-        // cache the pixmap. We do not do this for TILE and color schemas.
-        // which can result in a correct but possibly blurry picture at a
-        // Retina display. This can be fixed when switching to QT5
-        if (mode == TILE || WPixmapStore::willCorrectColors()) {
-#else
-        if (mode == TILE || mode == Paintable::FIXED || WPixmapStore::willCorrectColors()) {
-#endif
+        if (rasterize) {
             // The SVG renderer doesn't directly support tiling, so we render
             // it to a pixmap which will then get tiled.
             QImage copy_buffer(m_pSvg->defaultSize() * scaleFactor, QImage::Format_ARGB32);
             copy_buffer.fill(0x00000000);  // Transparent black.
             QPainter painter(&copy_buffer);
             m_pSvg->render(&painter);
+            painter.end();
             WPixmapStore::correctImageColors(&copy_buffer);
+            SkinCache::storeImage(cacheKey, copy_buffer);
 
             m_pPixmap.reset(new QPixmap(copy_buffer.size()));
             m_pPixmap->convertFromImage(copy_buffer);
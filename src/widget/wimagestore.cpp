@@ -1,10 +1,10 @@
 #include "widget/wimagestore.h"
 
 #include <QtDebug>
-#include <QSvgRenderer>
-#include <QPainter>
 
 #include "skin/imgloader.h"
+#include "skin/skincache.h"
+#include "skin/skinimageprefetcher.h"
 #include "util/assert.h"
 
 
@@ -58,30 +58,30 @@ std::shared_ptr<QImage> WImageStore::getImage(const PixmapSource& source, double
 // static
 QImage* WImageStore::getImageNoCache(const PixmapSource& source, double scaleFactor) {
     if (source.isSVG()) {
-        QSvgRenderer renderer;
+        // Skips loading the SVG if it has been rasterized on a previous start
+        const QString cacheKey = QString("WImageStore:%1:%2").arg(
+                source.getId(), QString::number(scaleFactor));
+        QImage cachedImage = SkinCache::loadImage(cacheKey);
+        if (!cachedImage.isNull()) {
+            return new QImage(cachedImage);
+        }
 
-        if (!source.getSvgSourceData().isEmpty()) {
-            // Call here the different overload for svg content
-            if (!renderer.load(source.getSvgSourceData())) {
-                // The above line already logs a warning
-                return nullptr;
-            }
-        } else if (!source.getPath().isEmpty()) {
-            if (!renderer.load(source.getPath())) {
-                // The above line already logs a warning
+        // Rasterized concurrently with the other images of the skin
+        QImage image = SkinImagePrefetcher::getImage(source, scaleFactor);
+        if (image.isNull()) {
+            image = SkinImagePrefetcher::renderSvg(source, scaleFactor);
+            if (image.isNull()) {
                 return nullptr;
             }
-        } else {
-            return nullptr;
         }
-
-        auto pImage = new QImage(renderer.defaultSize() * scaleFactor,
-                            QImage::Format_ARGB32);
-        pImage->fill(0x00000000);  // Transparent black.
-        QPainter painter(pImage);
-        renderer.render(&painter);
+        auto pImage = new QImage(image);
+        SkinCache::storeImage(cacheKey, *pImage);
         return pImage;
     } else {
+        QImage image = SkinImagePrefetcher::getImage(source, scaleFactor);
+        if (!image.isNull()) {
+            return new QImage(image);
+        }
         return m_loader->getImage(source.getPath(), scaleFactor);
     }
 }
@@ -107,6 +107,11 @@ bool WImageStore::willCorrectColors() {
     return m_loader->willCorrectColors();
 };
 
+// static
+QSharedPointer<ImgSource> WImageStore::getLoader() {
+    return m_loader;
+}
+
 // static
 void WImageStore::setLoader(QSharedPointer<ImgSource> ld) {
     m_loader = ld;
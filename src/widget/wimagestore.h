@@ -18,6 +18,7 @@ class WImageStore {
     static QImage* getImageNoCache(const QString& fileName, double scaleFactor);
     static std::shared_ptr<QImage> getImage(const PixmapSource& source, double scaleFactor);
     static QImage* getImageNoCache(const PixmapSource& source, double scaleFactor);
+    static QSharedPointer<ImgSource> getLoader();
     static void setLoader(QSharedPointer<ImgSource> ld);
     // For external owned images like software generated ones.
     static void correctImageColors(QImage* p);
@@ -6,6 +6,7 @@
 
 #include "util/math.h"
 #include "skin/imgloader.h"
+#include "skin/skinimageprefetcher.h"
 
 // static
 QHash<QString, WeakPaintablePointer> WPixmapStore::m_paintableCache;
@@ -40,7 +41,15 @@ QPixmap* WPixmapStore::getPixmapNoCache(
         const QString& fileName,
         double scaleFactor) {
     QPixmap* pPixmap = nullptr;
-    QImage* img = m_loader->getImage(fileName, scaleFactor);
+    QImage* img;
+    // Decoded concurrently with the other images of the skin
+    QImage prefetchedImage = SkinImagePrefetcher::getImage(
+            PixmapSource(fileName), scaleFactor);
+    if (!prefetchedImage.isNull()) {
+        img = new QImage(prefetchedImage);
+    } else {
+        img = m_loader->getImage(fileName, scaleFactor);
+    }
 #if QT_VERSION >= 0x040700
     pPixmap = new QPixmap();
     pPixmap->convertFromImage(*img);